@@ -0,0 +1,160 @@
+#pragma region Apache License 2.0
+/*
+Nuclex Frame Fixer
+Copyright (C) 2024 Markus Ewald / Nuclex Development Labs
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#pragma endregion // Apache License 2.0
+
+// If the application is compiled as a DLL, this ensures symbols are exported
+#define NUCLEX_FRAMEFIXER_SOURCE 1
+
+#include "../../Source/Algorithm/Averager.h"
+#include "../../Source/Rendering/FrameBuffer.h"
+#include "../../Source/Platform/CpuFeatures.h"
+
+#include <algorithm> // for std::copy_n()
+#include <cstdint> // for std::uint16_t, std::uint32_t
+#include <vector> // for std::vector
+
+#include <celero/Celero.h>
+
+namespace {
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Width of the frames that are averaged in the benchmarks</summary>
+  const int FrameWidth = 1920;
+  /// <summary>Height of the frames that are averaged in the benchmarks</summary>
+  const int FrameHeight = 1080;
+  /// <summary>Number of frames in the averaging run</summary>
+  const std::size_t FrameCount = 5;
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Frames of an averaging run filled with noise</summary>
+  struct AveragingRun {
+
+    /// <summary>Creates the frames and fills them with noise</summary>
+    public: AveragingRun() :
+      FirstFrame(
+        FrameWidth, FrameHeight, Nuclex::FrameFixer::Rendering::FramePixelFormat::Rgba64
+      ),
+      Result(
+        FrameWidth, FrameHeight, Nuclex::FrameFixer::Rendering::FramePixelFormat::Rgba64
+      ) {
+      std::uint32_t noise = 12345;
+      fillWithNoise(this->FirstFrame, noise);
+      for(std::size_t index = 1; index < FrameCount; ++index) {
+        this->OtherFrames.emplace_back(
+          FrameWidth, FrameHeight, Nuclex::FrameFixer::Rendering::FramePixelFormat::Rgba64
+        );
+        fillWithNoise(this->OtherFrames.back(), noise);
+      }
+    }
+
+    /// <summary>Fills a frame with noise</summary>
+    /// <param name="frame">Frame that will be filled</param>
+    /// <param name="noise">Noise generator state, will be advanced</param>
+    private: static void fillWithNoise(
+      Nuclex::FrameFixer::Rendering::FrameBuffer &frame, std::uint32_t &noise
+    ) {
+      std::size_t channelCount = frame.GetRowLength() / sizeof(std::uint16_t);
+      for(int y = 0; y < FrameHeight; ++y) {
+        std::uint16_t *row = reinterpret_cast<std::uint16_t *>(frame.GetRow(y));
+        for(std::size_t index = 0; index < channelCount; ++index) {
+          noise = noise * 1664525U + 1013904223U;
+          row[index] = static_cast<std::uint16_t>(noise >> 16);
+        }
+      }
+    }
+
+    /// <summary>First frame of the run, left untouched</summary>
+    public: Nuclex::FrameFixer::Rendering::FrameBuffer FirstFrame;
+    /// <summary>Remaining frames of the run</summary>
+    public: std::vector<Nuclex::FrameFixer::Rendering::FrameBuffer> OtherFrames;
+    /// <summary>Receives a copy of the first frame that is then averaged</summary>
+    public: Nuclex::FrameFixer::Rendering::FrameBuffer Result;
+
+  };
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Returns the frames the benchmarks average</summary>
+  /// <returns>The frames, which are created when they are requested for the first time</returns>
+  AveragingRun &getAveragingRun() {
+    static AveragingRun run;
+    return run;
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Averages the run's frames on a single thread</summary>
+  /// <param name="mode">Whether to use the mean, median or trimmed mean</param>
+  /// <param name="useAvx2">Whether the AVX2 code path may be used</param>
+  void averageFrames(Nuclex::FrameFixer::AverageMode mode, bool useAvx2) {
+    using Nuclex::FrameFixer::Platform::CpuFeatures;
+
+    // The first frame receives the result, so each run starts from a fresh copy
+    AveragingRun &run = getAveragingRun();
+    for(int y = 0; y < FrameHeight; ++y) {
+      std::copy_n(run.FirstFrame.GetRow(y), run.FirstFrame.GetRowLength(), run.Result.GetRow(y));
+    }
+
+    CpuFeatures::SetAvx2Enabled(useAvx2);
+    Nuclex::FrameFixer::Averager::Average(run.Result, run.OtherFrames, mode);
+    CpuFeatures::SetAvx2Enabled(true);
+
+    celero::DoNotOptimizeAway(run.Result.GetRow(0)[0]);
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+} // anonymous namespace
+
+namespace Nuclex::FrameFixer {
+
+  // ------------------------------------------------------------------------------------------- //
+
+  BASELINE(AverageFiveFrames, Mean, 10, 5) {
+    averageFrames(AverageMode::Mean, true);
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  BENCHMARK(AverageFiveFrames, MedianSse2, 10, 5) {
+    averageFrames(AverageMode::Median, false);
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  BENCHMARK(AverageFiveFrames, MedianAvx2, 10, 5) {
+    averageFrames(AverageMode::Median, true);
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  BENCHMARK(AverageFiveFrames, TrimmedMeanSse2, 10, 5) {
+    averageFrames(AverageMode::TrimmedMean, false);
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  BENCHMARK(AverageFiveFrames, TrimmedMeanAvx2, 10, 5) {
+    averageFrames(AverageMode::TrimmedMean, true);
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+} // namespace Nuclex::FrameFixer
@@ -0,0 +1,160 @@
+#pragma region Apache License 2.0
+/*
+Nuclex Frame Fixer
+Copyright (C) 2024 Markus Ewald / Nuclex Development Labs
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#pragma endregion // Apache License 2.0
+
+// If the application is compiled as a DLL, this ensures symbols are exported
+#define NUCLEX_FRAMEFIXER_SOURCE 1
+
+#include "../../../Source/Rendering/ImageFormats/PngImageEncoder.h"
+#include "../../../Source/Rendering/ImageFormats/QoiImageEncoder.h"
+#include "../../../Source/Rendering/ImageFormats/TiffImageEncoder.h"
+
+#include <QBuffer>
+
+#include <cstdint> // for std::uint16_t, std::uint32_t
+
+#include <celero/Celero.h>
+
+namespace {
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Width of the frame that is encoded in the benchmarks</summary>
+  const int FrameWidth = 1920;
+  /// <summary>Height of the frame that is encoded in the benchmarks</summary>
+  const int FrameHeight = 1080;
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Creates a 16 bit frame that compresses about as well as a movie frame</summary>
+  /// <returns>A 1080p frame with smooth gradients and some film grain</returns>
+  QImage createFrame() {
+    QImage frame(FrameWidth, FrameHeight, QImage::Format_RGBX64);
+
+    // Pure noise would not compress at all and flat colors would compress far too well,
+    // so this uses gradients with a little noise in the low bits, like grain on film
+    std::uint32_t noise = 12345;
+    for(int y = 0; y < FrameHeight; ++y) {
+      QRgba64 *row = reinterpret_cast<QRgba64 *>(frame.scanLine(y));
+      for(int x = 0; x < FrameWidth; ++x) {
+        noise = noise * 1664525U + 1013904223U;
+        std::uint16_t grain = static_cast<std::uint16_t>((noise >> 16) & 0x3FF);
+
+        row[x] = QRgba64::fromRgba64(
+          static_cast<std::uint16_t>(x * 30 + grain),
+          static_cast<std::uint16_t>(y * 50 + grain),
+          static_cast<std::uint16_t>((x + y) * 16 + grain),
+          0xFFFF
+        );
+      }
+    }
+
+    return frame;
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Returns the frame that is encoded in the benchmarks</summary>
+  /// <returns>The frame, which is created when it is requested for the first time</returns>
+  const QImage &getFrame() {
+    static const QImage frame = createFrame();
+    return frame;
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Encodes the benchmark frame with the specified encoder</summary>
+  /// <param name="encoder">Encoder that will be used to encode the frame</param>
+  void encodeFrame(
+    const Nuclex::FrameFixer::Rendering::ImageFormats::ImageEncoder &encoder
+  ) {
+    celero::DoNotOptimizeAway(encoder.Encode(getFrame()));
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+} // anonymous namespace
+
+namespace Nuclex::FrameFixer::Rendering::ImageFormats {
+
+  // ------------------------------------------------------------------------------------------- //
+
+  BASELINE(ImageEncoding, QImagePng, 10, 1) {
+    QByteArray contents;
+    QBuffer buffer(&contents);
+    buffer.open(QIODevice::WriteOnly);
+    celero::DoNotOptimizeAway(getFrame().save(&buffer, u8"PNG"));
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  BENCHMARK(ImageEncoding, PngLevel6Adaptive, 10, 1) {
+    encodeFrame(PngImageEncoder(6, PngFilter::Adaptive));
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  BENCHMARK(ImageEncoding, PngLevel1Adaptive, 10, 1) {
+    encodeFrame(PngImageEncoder(1, PngFilter::Adaptive));
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  BENCHMARK(ImageEncoding, PngLevel1None, 10, 1) {
+    encodeFrame(PngImageEncoder(1, PngFilter::None));
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  BENCHMARK(ImageEncoding, PngLevel1Sub, 10, 1) {
+    encodeFrame(PngImageEncoder(1, PngFilter::Sub));
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  BENCHMARK(ImageEncoding, PngLevel1Up, 10, 1) {
+    encodeFrame(PngImageEncoder(1, PngFilter::Up));
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  BENCHMARK(ImageEncoding, PngLevel1Paeth, 10, 1) {
+    encodeFrame(PngImageEncoder(1, PngFilter::Paeth));
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  BENCHMARK(ImageEncoding, PngLevel0None, 10, 1) {
+    encodeFrame(PngImageEncoder(0, PngFilter::None));
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  BENCHMARK(ImageEncoding, Tiff, 10, 1) {
+    encodeFrame(TiffImageEncoder());
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  BENCHMARK(ImageEncoding, Qoi, 10, 1) {
+    encodeFrame(QoiImageEncoder());
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+} // namespace Nuclex::FrameFixer::Rendering::ImageFormats
@@ -0,0 +1,148 @@
+#pragma region Apache License 2.0
+/*
+Nuclex Frame Fixer
+Copyright (C) 2024 Markus Ewald / Nuclex Development Labs
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#pragma endregion // Apache License 2.0
+
+// If the application is compiled as a DLL, this ensures symbols are exported
+#define NUCLEX_FRAMEFIXER_SOURCE 1
+
+#include "../../../Source/Rendering/ImageFormats/PngImageDecoder.h"
+#include "../../../Source/Rendering/ImageFormats/PngImageEncoder.h"
+
+#include <cstdint> // for std::uint8_t, std::uint16_t, std::uint32_t
+#include <vector> // for std::vector
+
+#include <celero/Celero.h>
+
+namespace {
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Width of the frame that is decoded in the benchmarks</summary>
+  const int FrameWidth = 1920;
+  /// <summary>Height of the frame that is decoded in the benchmarks</summary>
+  const int FrameHeight = 1080;
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Encodes a 16 bit frame that compresses about as well as a movie frame</summary>
+  /// <param name="compressionLevel">zlib compression level the frame is encoded with</param>
+  /// <param name="filter">Filter applied to each row of the frame</param>
+  /// <returns>The contents of a PNG file holding the frame</returns>
+  std::vector<std::uint8_t> encodeFrame(
+    int compressionLevel, Nuclex::FrameFixer::Rendering::ImageFormats::PngFilter filter
+  ) {
+    QImage frame(FrameWidth, FrameHeight, QImage::Format_RGBX64);
+
+    // Gradients with a little noise in the low bits, like grain on film
+    std::uint32_t noise = 12345;
+    for(int y = 0; y < FrameHeight; ++y) {
+      QRgba64 *row = reinterpret_cast<QRgba64 *>(frame.scanLine(y));
+      for(int x = 0; x < FrameWidth; ++x) {
+        noise = noise * 1664525U + 1013904223U;
+        std::uint16_t grain = static_cast<std::uint16_t>((noise >> 16) & 0x3FF);
+
+        row[x] = QRgba64::fromRgba64(
+          static_cast<std::uint16_t>(x * 30 + grain),
+          static_cast<std::uint16_t>(y * 50 + grain),
+          static_cast<std::uint16_t>((x + y) * 16 + grain),
+          0xFFFF
+        );
+      }
+    }
+
+    using Nuclex::FrameFixer::Rendering::ImageFormats::PngImageEncoder;
+    return PngImageEncoder(compressionLevel, filter).Encode(frame);
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Returns a frame encoded with zlib's default level and adaptive filtering</summary>
+  /// <returns>The contents of the PNG file, created when first requested</returns>
+  const std::vector<std::uint8_t> &getDefaultPng() {
+    using Nuclex::FrameFixer::Rendering::ImageFormats::PngFilter;
+    static const std::vector<std::uint8_t> contents = encodeFrame(6, PngFilter::Adaptive);
+    return contents;
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Returns a frame encoded the way the fast PNG output format writes it</summary>
+  /// <returns>The contents of the PNG file, created when first requested</returns>
+  const std::vector<std::uint8_t> &getFastPng() {
+    using Nuclex::FrameFixer::Rendering::ImageFormats::PngFilter;
+    static const std::vector<std::uint8_t> contents = encodeFrame(1, PngFilter::Up);
+    return contents;
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Decodes a PNG file the way frames were loaded before the decoder existed</summary>
+  /// <param name="contents">Contents of the PNG file that will be decoded</param>
+  void decodeThroughQImage(const std::vector<std::uint8_t> &contents) {
+    QImage image;
+    image.loadFromData(contents.data(), static_cast<int>(contents.size()), u8"PNG");
+    celero::DoNotOptimizeAway(image.convertToFormat(QImage::Format_RGBX64));
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Decodes a PNG file with a decoder and image that are reused between runs</summary>
+  /// <param name="contents">Contents of the PNG file that will be decoded</param>
+  void decodeThroughDecoder(const std::vector<std::uint8_t> &contents) {
+    using Nuclex::FrameFixer::Rendering::ImageFormats::PngImageDecoder;
+
+    // The renderer keeps one decoder per thread and decodes into recycled images,
+    // so the buffers are only allocated during the first run
+    static PngImageDecoder decoder;
+    static QImage image;
+    celero::DoNotOptimizeAway(decoder.TryDecode(contents.data(), contents.size(), image));
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+} // anonymous namespace
+
+namespace Nuclex::FrameFixer::Rendering::ImageFormats {
+
+  // ------------------------------------------------------------------------------------------- //
+
+  BASELINE(PngDecoding, QImageDefaultPng, 10, 1) {
+    decodeThroughQImage(getDefaultPng());
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  BENCHMARK(PngDecoding, DecoderDefaultPng, 10, 1) {
+    decodeThroughDecoder(getDefaultPng());
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  BENCHMARK(PngDecoding, QImageFastPng, 10, 1) {
+    decodeThroughQImage(getFastPng());
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  BENCHMARK(PngDecoding, DecoderFastPng, 10, 1) {
+    decodeThroughDecoder(getFastPng());
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+} // namespace Nuclex::FrameFixer::Rendering::ImageFormats
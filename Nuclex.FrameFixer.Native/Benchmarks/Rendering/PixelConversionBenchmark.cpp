@@ -0,0 +1,202 @@
+#pragma region Apache License 2.0
+/*
+Nuclex Frame Fixer
+Copyright (C) 2024 Markus Ewald / Nuclex Development Labs
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#pragma endregion // Apache License 2.0
+
+// If the application is compiled as a DLL, this ensures symbols are exported
+#define NUCLEX_FRAMEFIXER_SOURCE 1
+
+#include "../../Source/Rendering/PixelConversion.h"
+#include "../../Source/Platform/CpuFeatures.h"
+
+#include <cstdint> // for std::uint16_t, std::uint32_t
+#include <vector> // for std::vector
+
+#include <celero/Celero.h>
+
+namespace {
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Width of the frame that is converted in the benchmarks</summary>
+  const std::size_t FrameWidth = 1920;
+  /// <summary>Height of the frame that is converted in the benchmarks</summary>
+  const std::size_t FrameHeight = 1080;
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Buffers holding a 1080p frame in all layouts the benchmarks convert</summary>
+  struct FrameBuffers {
+
+    /// <summary>Fills the frame with noise</summary>
+    public: FrameBuffers() :
+      Rgba64(FrameWidth * FrameHeight * 4),
+      Yuv444p16(FrameWidth * FrameHeight * 3),
+      Argb32(FrameWidth * FrameHeight) {
+      std::uint32_t noise = 12345;
+      for(std::uint16_t &channel : this->Rgba64) {
+        noise = noise * 1664525U + 1013904223U;
+        channel = static_cast<std::uint16_t>(noise >> 16);
+      }
+      for(std::uint16_t &channel : this->Yuv444p16) {
+        noise = noise * 1664525U + 1013904223U;
+        channel = static_cast<std::uint16_t>(noise >> 16);
+      }
+    }
+
+    /// <summary>Pixels with four 16 bit channels each</summary>
+    public: std::vector<std::uint16_t> Rgba64;
+    /// <summary>Planar 16 bit luma, Cb and Cr values, one full frame per plane</summary>
+    public: std::vector<std::uint16_t> Yuv444p16;
+    /// <summary>Pixels as 0xAARRGGBB integers</summary>
+    public: std::vector<std::uint32_t> Argb32;
+
+  };
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Returns the buffers the benchmarks convert between</summary>
+  /// <returns>The buffers, which are created when they are requested for the first time</returns>
+  FrameBuffers &getFrameBuffers() {
+    static FrameBuffers buffers;
+    return buffers;
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Converts the frame from RGBA to YUV, one row at a time</summary>
+  /// <param name="useAvx2">Whether the AVX2 code path may be used</param>
+  void convertRgba64ToYuv444p16(bool useAvx2) {
+    using Nuclex::FrameFixer::Platform::CpuFeatures;
+    using Nuclex::FrameFixer::Rendering::PixelConversion;
+
+    FrameBuffers &buffers = getFrameBuffers();
+    std::uint16_t *luma = buffers.Yuv444p16.data();
+    std::uint16_t *blueDifference = luma + FrameWidth * FrameHeight;
+    std::uint16_t *redDifference = blueDifference + FrameWidth * FrameHeight;
+
+    CpuFeatures::SetAvx2Enabled(useAvx2);
+    for(std::size_t y = 0; y < FrameHeight; ++y) {
+      PixelConversion::Rgba64ToYuv444p16(
+        buffers.Rgba64.data() + y * FrameWidth * 4,
+        luma + y * FrameWidth,
+        blueDifference + y * FrameWidth,
+        redDifference + y * FrameWidth,
+        FrameWidth
+      );
+    }
+    CpuFeatures::SetAvx2Enabled(true);
+
+    celero::DoNotOptimizeAway(luma[0]);
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Converts the frame from YUV to RGBA, one row at a time</summary>
+  /// <param name="useAvx2">Whether the AVX2 code path may be used</param>
+  void convertYuv444p16ToRgba64(bool useAvx2) {
+    using Nuclex::FrameFixer::Platform::CpuFeatures;
+    using Nuclex::FrameFixer::Rendering::PixelConversion;
+
+    FrameBuffers &buffers = getFrameBuffers();
+    const std::uint16_t *luma = buffers.Yuv444p16.data();
+    const std::uint16_t *blueDifference = luma + FrameWidth * FrameHeight;
+    const std::uint16_t *redDifference = blueDifference + FrameWidth * FrameHeight;
+
+    CpuFeatures::SetAvx2Enabled(useAvx2);
+    for(std::size_t y = 0; y < FrameHeight; ++y) {
+      PixelConversion::Yuv444p16ToRgba64(
+        luma + y * FrameWidth,
+        blueDifference + y * FrameWidth,
+        redDifference + y * FrameWidth,
+        buffers.Rgba64.data() + y * FrameWidth * 4,
+        FrameWidth
+      );
+    }
+    CpuFeatures::SetAvx2Enabled(true);
+
+    celero::DoNotOptimizeAway(buffers.Rgba64[0]);
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Reduces the frame from 16 bit RGBA to 8 bit QRgb, one row at a time</summary>
+  /// <param name="useAvx2">Whether the AVX2 code path may be used</param>
+  void convertRgba64ToArgb32(bool useAvx2) {
+    using Nuclex::FrameFixer::Platform::CpuFeatures;
+    using Nuclex::FrameFixer::Rendering::PixelConversion;
+
+    FrameBuffers &buffers = getFrameBuffers();
+
+    CpuFeatures::SetAvx2Enabled(useAvx2);
+    for(std::size_t y = 0; y < FrameHeight; ++y) {
+      PixelConversion::Rgba64ToArgb32(
+        buffers.Rgba64.data() + y * FrameWidth * 4,
+        buffers.Argb32.data() + y * FrameWidth,
+        FrameWidth
+      );
+    }
+    CpuFeatures::SetAvx2Enabled(true);
+
+    celero::DoNotOptimizeAway(buffers.Argb32[0]);
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+} // anonymous namespace
+
+namespace Nuclex::FrameFixer::Rendering {
+
+  // ------------------------------------------------------------------------------------------- //
+
+  BASELINE(Rgba64ToYuv444p16, Sse2, 30, 10) {
+    convertRgba64ToYuv444p16(false);
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  BENCHMARK(Rgba64ToYuv444p16, Avx2, 30, 10) {
+    convertRgba64ToYuv444p16(true);
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  BASELINE(Yuv444p16ToRgba64, Sse2, 30, 10) {
+    convertYuv444p16ToRgba64(false);
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  BENCHMARK(Yuv444p16ToRgba64, Avx2, 30, 10) {
+    convertYuv444p16ToRgba64(true);
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  BASELINE(Rgba64ToArgb32, Sse2, 30, 10) {
+    convertRgba64ToArgb32(false);
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  BENCHMARK(Rgba64ToArgb32, Avx2, 30, 10) {
+    convertRgba64ToArgb32(true);
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+} // namespace Nuclex::FrameFixer::Rendering
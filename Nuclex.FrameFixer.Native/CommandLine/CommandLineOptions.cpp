@@ -0,0 +1,313 @@
+#pragma region Apache License 2.0
+/*
+Nuclex Frame Fixer
+Copyright (C) 2024 Markus Ewald / Nuclex Development Labs
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#pragma endregion // Apache License 2.0
+
+
+// If the application is compiled as a DLL, this ensures symbols are exported
+#define NUCLEX_FRAMEFIXER_SOURCE 1
+
+#include "./CommandLineOptions.h"
+
+#include <cstdlib> // for std::strtoull()
+#include <stdexcept> // for std::runtime_error
+
+namespace {
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Parses a non-negative integer given as the value of an option</summary>
+  /// <param name="option">Option the value was given for, used in error messages</param>
+  /// <param name="value">Text that will be parsed as an integer</param>
+  /// <returns>The integer the text contains</returns>
+  std::size_t parseNumber(const std::string &option, const std::string &value) {
+    const char *start = value.c_str();
+    char *end = nullptr;
+    unsigned long long number = std::strtoull(start, &end, 10);
+    if(value.empty() || (value[0] == '-') || (end == start) || (*end != 0)) {
+      std::string message(u8"Invalid number '", 16);
+      message.append(value);
+      message.append(u8"' given for ", 12);
+      message.append(option);
+      throw std::runtime_error(message);
+    }
+
+    return static_cast<std::size_t>(number);
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Parses a range of frames given as the value of an option</summary>
+  /// <param name="option">Option the value was given for, used in error messages</param>
+  /// <param name="value">Text in the form start-end that will be parsed</param>
+  /// <returns>The start and end of the range</returns>
+  std::pair<std::size_t, std::size_t> parseRange(
+    const std::string &option, const std::string &value
+  ) {
+    std::string::size_type separatorIndex = value.find('-');
+    if(separatorIndex == std::string::npos) {
+      std::string message(u8"Invalid range '", 15);
+      message.append(value);
+      message.append(u8"' given for ", 12);
+      message.append(option);
+      message.append(u8", expected <start>-<end>", 24);
+      throw std::runtime_error(message);
+    }
+
+    std::pair<std::size_t, std::size_t> range(
+      parseNumber(option, value.substr(0, separatorIndex)),
+      parseNumber(option, value.substr(separatorIndex + 1))
+    );
+    if(range.second < range.first) {
+      std::string message(u8"Range '", 7);
+      message.append(value);
+      message.append(u8"' given for ", 12);
+      message.append(option);
+      message.append(u8" ends before it starts", 22);
+      throw std::runtime_error(message);
+    }
+
+    return range;
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+} // anonymous namespace
+
+namespace Nuclex::FrameFixer::CommandLine {
+
+  // ------------------------------------------------------------------------------------------- //
+
+  CommandLineOptions::CommandLineOptions() :
+    Action(Command::Render),
+    FrameDirectory(),
+    TargetDirectory(),
+    DeinterlacerName(),
+    InterpolatorName(),
+    InputFrameRange(),
+    OutputFrameRange(),
+    AverageMode(u8"mean"),
+    FlipFields(false),
+    Incremental(true),
+    Format(u8"png"),
+    VideoQuality(18),
+    ThreadCount(0),
+    ReadAheadDepth(8),
+    IoThreadCount(2),
+    ProgressInterval(1000),
+    UseCacheFile(false),
+    MemoryBudget(0),
+    Shard(false),
+    ChunkSize(250),
+    LeaseTimeout(120),
+    WorkerName(),
+    TracePath() {}
+
+  // ------------------------------------------------------------------------------------------- //
+
+  CommandLineOptions CommandLineOptions::Parse(int argumentCount, char *arguments[]) {
+    CommandLineOptions options;
+
+    std::size_t positionalArgumentCount = 0;
+    for(int index = 1; index < argumentCount; ++index) {
+      std::string argument(arguments[index]);
+
+      // Options that stand on their own
+      if((argument == u8"--help") || (argument == u8"-h")) {
+        options.Action = Command::ShowHelp;
+        return options;
+      } else if(argument == u8"--list") {
+        options.Action = Command::ListAlgorithms;
+        continue;
+      } else if(argument == u8"--analyze") {
+        options.Action = Command::Analyze;
+        continue;
+      } else if(argument == u8"--flip-fields") {
+        options.FlipFields = true;
+        continue;
+      } else if(argument == u8"--full") {
+        options.Incremental = false;
+        continue;
+      } else if(argument == u8"--shard") {
+        options.Shard = true;
+        continue;
+      } else if(argument == u8"--cache-file") {
+        options.UseCacheFile = true;
+        continue;
+      }
+
+      // Options that are followed by a value
+      bool takesValue = (
+        (argument == u8"--deinterlacer") ||
+        (argument == u8"--interpolator") ||
+        (argument == u8"--input-range") ||
+        (argument == u8"--output-range") ||
+        (argument == u8"--average") ||
+        (argument == u8"--format") ||
+        (argument == u8"--quality") ||
+        (argument == u8"--threads") ||
+        (argument == u8"--read-ahead") ||
+        (argument == u8"--io-threads") ||
+        (argument == u8"--progress-interval") ||
+        (argument == u8"--memory-budget") ||
+        (argument == u8"--chunk-size") ||
+        (argument == u8"--lease-timeout") ||
+        (argument == u8"--worker-name") ||
+        (argument == u8"--trace")
+      );
+      if(takesValue) {
+        if(index + 1 >= argumentCount) {
+          throw std::runtime_error(u8"Option " + argument + u8" requires a value");
+        }
+
+        std::string value(arguments[++index]);
+        if(argument == u8"--deinterlacer") {
+          options.DeinterlacerName = value;
+        } else if(argument == u8"--interpolator") {
+          options.InterpolatorName = value;
+        } else if(argument == u8"--input-range") {
+          options.InputFrameRange = parseRange(argument, value);
+        } else if(argument == u8"--output-range") {
+          options.OutputFrameRange = parseRange(argument, value);
+        } else if(argument == u8"--average") {
+          options.AverageMode = value;
+        } else if(argument == u8"--format") {
+          options.Format = value;
+        } else if(argument == u8"--quality") {
+          options.VideoQuality = static_cast<int>(parseNumber(argument, value));
+        } else if(argument == u8"--threads") {
+          options.ThreadCount = parseNumber(argument, value);
+        } else if(argument == u8"--read-ahead") {
+          options.ReadAheadDepth = parseNumber(argument, value);
+        } else if(argument == u8"--io-threads") {
+          options.IoThreadCount = parseNumber(argument, value);
+        } else if(argument == u8"--memory-budget") {
+          options.MemoryBudget = parseNumber(argument, value);
+        } else if(argument == u8"--chunk-size") {
+          options.ChunkSize = parseNumber(argument, value);
+        } else if(argument == u8"--lease-timeout") {
+          options.LeaseTimeout = parseNumber(argument, value);
+        } else if(argument == u8"--worker-name") {
+          options.WorkerName = value;
+        } else if(argument == u8"--trace") {
+          options.TracePath = value;
+        } else {
+          options.ProgressInterval = parseNumber(argument, value);
+        }
+        continue;
+      }
+
+      if((argument.length() >= 1) && (argument[0] == '-')) {
+        throw std::runtime_error(u8"Unknown option " + argument);
+      }
+
+      // Anything else is the frame directory (or video) followed by the target directory
+      if(positionalArgumentCount == 0) {
+        options.FrameDirectory = argument;
+      } else if(positionalArgumentCount == 1) {
+        options.TargetDirectory = argument;
+      } else {
+        throw std::runtime_error(u8"Unexpected argument " + argument);
+      }
+      ++positionalArgumentCount;
+    }
+
+    // Check that the directories required by the chosen command were specified
+    if(options.Action == Command::Analyze) {
+      if(options.FrameDirectory.empty()) {
+        throw std::runtime_error(u8"No frame directory specified");
+      }
+    } else if(options.Action == Command::Render) {
+      if(positionalArgumentCount == 0) {
+        options.Action = Command::ShowHelp;
+      } else if(options.TargetDirectory.empty()) {
+        throw std::runtime_error(u8"No target directory specified");
+      }
+    }
+
+    // Sharded rendering hands out output frames in chunks, so there must be some
+    if(options.Shard) {
+      if(options.UseCacheFile) {
+        throw std::runtime_error(u8"The frame cache file can not be shared by several workers");
+      }
+      if(options.ChunkSize < 1) {
+        throw std::runtime_error(u8"Chunk size must be at least one frame");
+      }
+      if(options.LeaseTimeout < 10) {
+        throw std::runtime_error(u8"Lease timeout must be at least 10 seconds");
+      }
+    }
+
+    return options;
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  std::string CommandLineOptions::GetUsage(const std::string &executableName) {
+    std::string usage(u8"Usage: ", 7);
+    usage.append(executableName);
+    usage.append(
+      u8" [options] <frame directory or video> [<target directory>]\n"
+      u8"\n"
+      u8"Renders the frames in a directory or video file according to the actions\n"
+      u8"stored in its .frames.txt file, without a user interface. Video files can\n"
+      u8"only be read if the application was built with libav.\n"
+      u8"\n"
+      u8"Commands (rendering is the default):\n"
+      u8"  --help                        Show these usage instructions\n"
+      u8"  --list                        List the available deinterlacers and interpolators\n"
+      u8"  --analyze                     Print statistics about the movie and its output\n"
+      u8"\n"
+      u8"Options:\n"
+      u8"  --deinterlacer <name>         Deinterlacer to use (default: basic)\n"
+      u8"  --interpolator <name>         Interpolator to use (default: none)\n"
+      u8"  --input-range <start>-<end>   Only render frames produced by these input frames\n"
+      u8"  --output-range <start>-<end>  Only render these output frames\n"
+      u8"  --average <mode>              Combine averaged frames by mean, median or trimmed\n"
+      u8"                                mean (default: mean, others keep runs in memory)\n"
+      u8"  --flip-fields                 Swap the top and bottom fields\n"
+      u8"  --full                        Render all frames, even those that are up to date\n"
+      u8"  --format <format>             png, png-fast, tiff, qoi, ffv1, h264 or h265\n"
+      u8"                                (default: png, videos require libav)\n"
+      u8"  --quality <crf>               Quality of h264 and h265 videos (default: 18)\n"
+      u8"  --threads <count>             Threads to use, 0 for one per core (default: 0)\n"
+      u8"  --read-ahead <frames>         Input frames decoded ahead (default: 8)\n"
+      u8"  --io-threads <count>          Threads reading input frames ahead (default: 2)\n"
+      u8"  --progress-interval <ms>      Time between progress reports (default: 1000)\n"
+      u8"  --cache-file                  Keep decoded input frames in a memory-mapped file\n"
+      u8"                                next to the .frames.txt file (8 bytes per pixel)\n"
+      u8"  --memory-budget <MiB>         Memory frames in flight may take up, including\n"
+      u8"                                the frame cache (default: 0, unlimited)\n"
+      u8"  --trace <path>                Record a Chrome / Perfetto trace of the render\n"
+      u8"\n"
+      u8"Sharded rendering (image formats only):\n"
+      u8"  --shard                       Share the output frames with other workers started\n"
+      u8"                                on the same target directory\n"
+      u8"  --chunk-size <frames>         Output frames leased at a time (default: 250)\n"
+      u8"  --lease-timeout <seconds>     Time after which a silent worker's frames are\n"
+      u8"                                taken over by others (default: 120)\n"
+      u8"  --worker-name <name>          Name of this worker (default: <host>:<pid>)\n"
+      u8"\n"
+      u8"Names of deinterlacers and interpolators can be abbreviated. Progress and\n"
+      u8"results are written to stdout as one JSON object per line.\n"
+    );
+    return usage;
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+} // namespace Nuclex::FrameFixer::CommandLine
@@ -0,0 +1,133 @@
+#pragma region Apache License 2.0
+/*
+Nuclex Frame Fixer
+Copyright (C) 2024 Markus Ewald / Nuclex Development Labs
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#pragma endregion // Apache License 2.0
+
+#ifndef NUCLEX_FRAMEFIXER_COMMANDLINE_COMMANDLINEOPTIONS_H
+#define NUCLEX_FRAMEFIXER_COMMANDLINE_COMMANDLINEOPTIONS_H
+
+#include "Nuclex/FrameFixer/Config.h"
+
+#include <cstddef> // for std::size_t
+#include <optional> // for std::optional
+#include <string> // for std::string
+#include <utility> // for std::pair
+
+namespace Nuclex::FrameFixer::CommandLine {
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>What the command-line renderer has been asked to do</summary>
+  enum class Command {
+
+    /// <summary>Print the usage instructions</summary>
+    ShowHelp,
+    /// <summary>List the available deinterlacers and interpolators</summary>
+    ListAlgorithms,
+    /// <summary>Print statistics about a movie and the output frames it will produce</summary>
+    Analyze,
+    /// <summary>Render a movie's output frames</summary>
+    Render
+
+  };
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Settings passed to the command-line renderer</summary>
+  /// <remarks>
+  ///   Names of deinterlacers and interpolators are matched without regard to case and
+  ///   may be abbreviated as long as they remain unique, so "basic" selects the deinterlacer
+  ///   called "Basic: copy or interpolate missing fields".
+  /// </remarks>
+  struct CommandLineOptions {
+
+    /// <summary>Initializes a new set of options with the default settings</summary>
+    public: CommandLineOptions();
+
+    /// <summary>Parses the arguments the application was launched with</summary>
+    /// <param name="argumentCount">Number of arguments, including the executable</param>
+    /// <param name="arguments">All arguments, starting with the executable</param>
+    /// <returns>The options specified by the arguments</returns>
+    /// <remarks>
+    ///   Throws an exception describing the problem if the arguments are invalid.
+    /// </remarks>
+    public: static CommandLineOptions Parse(int argumentCount, char *arguments[]);
+
+    /// <summary>Returns the usage instructions for the command-line renderer</summary>
+    /// <param name="executableName">Name of the executable as it was invoked</param>
+    /// <returns>A text explaining the arguments the renderer accepts</returns>
+    public: static std::string GetUsage(const std::string &executableName);
+
+    /// <summary>What the command-line renderer should do</summary>
+    public: Command Action;
+    /// <summary>Directory or video file holding the input frames</summary>
+    public: std::string FrameDirectory;
+    /// <summary>Directory into which the output frames will be written</summary>
+    public: std::string TargetDirectory;
+    /// <summary>Name of the deinterlacer to use, empty for the basic deinterlacer</summary>
+    public: std::string DeinterlacerName;
+    /// <summary>Name of the interpolator to use, empty for none</summary>
+    public: std::string InterpolatorName;
+    /// <summary>Range of input frames that will be rendered, if restricted</summary>
+    public: std::optional<std::pair<std::size_t, std::size_t>> InputFrameRange;
+    /// <summary>Range of output frames that will be rendered, if restricted</summary>
+    public: std::optional<std::pair<std::size_t, std::size_t>> OutputFrameRange;
+    /// <summary>How averaging runs are combined: mean, median or trimmed</summary>
+    public: std::string AverageMode;
+    /// <summary>Whether the top and bottom fields will be flipped</summary>
+    public: bool FlipFields;
+    /// <summary>Whether output frames that are still up to date will be skipped</summary>
+    public: bool Incremental;
+    /// <summary>Format of the output, either an image format or a video codec</summary>
+    public: std::string Format;
+    /// <summary>Quality (CRF) used for lossy video codecs</summary>
+    public: int VideoQuality;
+    /// <summary>Number of threads that will be used, 0 for one per CPU core</summary>
+    public: std::size_t ThreadCount;
+    /// <summary>Number of input frames that will be decoded ahead</summary>
+    public: std::size_t ReadAheadDepth;
+    /// <summary>Number of threads that will read and decode input frames ahead</summary>
+    public: std::size_t IoThreadCount;
+    /// <summary>Milliseconds between progress reports</summary>
+    public: std::size_t ProgressInterval;
+    /// <summary>Whether decoded frames will be kept in a frame cache file</summary>
+    public: bool UseCacheFile;
+    /// <summary>Mebibytes the frames in flight may take up, 0 for no limit</summary>
+    public: std::size_t MemoryBudget;
+    /// <summary>Whether to render as one of several workers sharing the output frames</summary>
+    /// <remarks>
+    ///   Workers coordinate through a lease file in the target directory, so any number
+    ///   of processes, on one machine or several sharing the target directory, can be
+    ///   started on the same movie and will each pick up chunks that are still open.
+    /// </remarks>
+    public: bool Shard;
+    /// <summary>Number of output frames each worker leases at a time</summary>
+    public: std::size_t ChunkSize;
+    /// <summary>Seconds after which a lease from an unresponsive worker is reclaimed</summary>
+    public: std::size_t LeaseTimeout;
+    /// <summary>Name identifying this worker in the lease file, empty for host:pid</summary>
+    public: std::string WorkerName;
+    /// <summary>Path of a trace event file to record the render into, empty for none</summary>
+    public: std::string TracePath;
+
+  };
+
+  // ------------------------------------------------------------------------------------------- //
+
+} // namespace Nuclex::FrameFixer::CommandLine
+
+#endif // NUCLEX_FRAMEFIXER_COMMANDLINE_COMMANDLINEOPTIONS_H
@@ -0,0 +1,892 @@
+#pragma region Apache License 2.0
+/*
+Nuclex Frame Fixer
+Copyright (C) 2024 Markus Ewald / Nuclex Development Labs
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#pragma endregion // Apache License 2.0
+
+
+// If the application is compiled as a DLL, this ensures symbols are exported
+#define NUCLEX_FRAMEFIXER_SOURCE 1
+
+#include "Nuclex/FrameFixer/Config.h"
+#include "./CommandLineOptions.h"
+
+#include "../Source/Services/ServicesRoot.h"
+#include "../Source/Services/DeinterlacerRepository.h"
+#include "../Source/Services/InterpolatorRepository.h"
+#include "../Source/Algorithm/Deinterlacing/Deinterlacer.h"
+#include "../Source/Algorithm/Interpolation/FrameInterpolator.h"
+#include "../Source/Model/Movie.h"
+#include "../Source/Rendering/RenderPlan.h"
+#include "../Source/Rendering/ImageFormats/PngImageEncoder.h"
+#include "../Source/Rendering/ImageFormats/TiffImageEncoder.h"
+#include "../Source/Rendering/ImageFormats/QoiImageEncoder.h"
+#include "../Source/Rendering/RenderLeaseFile.h"
+#include "../Source/Rendering/FrameMemoryBudget.h"
+#include "../Source/Renderer.h"
+#include "../Source/Diagnostics/TraceRecorder.h"
+
+#include <QCoreApplication>
+
+#include <Nuclex/Platform/Tasks/CancellationTrigger.h> // for CancellationTrigger
+#include <Nuclex/Support/Errors/CanceledError.h> // for CanceledError
+#include <Nuclex/Support/Text/LexicalAppend.h> // for lexical_append()
+
+#include <algorithm> // for std::max()
+#include <atomic> // for std::atomic
+#include <cctype> // for std::tolower()
+#include <chrono> // for std::chrono::steady_clock
+#include <csignal> // for std::signal()
+#include <cstdio> // for std::fwrite(), std::fflush()
+#include <exception> // for std::exception_ptr
+#include <functional> // for std::function
+#include <map> // for std::map
+#include <stdexcept> // for std::runtime_error
+#include <thread> // for std::thread
+
+namespace {
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Set by the signal handler when the user asks the renderer to stop</summary>
+  volatile std::sig_atomic_t cancellationRequested = 0;
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Called when the process receives SIGINT or SIGTERM</summary>
+  /// <param name="signalNumber">Number of the signal that was received</param>
+  void requestCancellation(int signalNumber) {
+    (void)signalNumber;
+    cancellationRequested = 1;
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Appends a string to a JSON document, quoting and escaping it</summary>
+  /// <param name="target">JSON document the string will be appended to</param>
+  /// <param name="text">String that will be appended</param>
+  void appendJsonString(std::string &target, const std::string &text) {
+    static const char hexDigits[] = "0123456789abcdef";
+
+    target.push_back('"');
+    for(char character : text) {
+      switch(character) {
+        case '"': { target.append(u8"\\\"", 2); break; }
+        case '\\': { target.append(u8"\\\\", 2); break; }
+        case '\n': { target.append(u8"\\n", 2); break; }
+        case '\r': { target.append(u8"\\r", 2); break; }
+        case '\t': { target.append(u8"\\t", 2); break; }
+        default: {
+          if(static_cast<unsigned char>(character) < 0x20) {
+            target.append(u8"\\u00", 4);
+            target.push_back(hexDigits[(character >> 4) & 0xF]);
+            target.push_back(hexDigits[character & 0xF]);
+          } else {
+            target.push_back(character);
+          }
+          break;
+        }
+      }
+    }
+    target.push_back('"');
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Writes a line to stdout and makes sure it is delivered right away</summary>
+  /// <param name="line">Line that will be written, without the line break</param>
+  void writeLine(std::string line) {
+    line.push_back('\n');
+    std::fwrite(line.data(), 1, line.length(), stdout);
+    std::fflush(stdout);
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Reports an error as a JSON line on stdout and in plain text on stderr</summary>
+  /// <param name="message">Message describing the error</param>
+  void reportError(const std::string &message) {
+    std::string line(u8"{\"event\":\"error\",\"message\":", 27);
+    appendJsonString(line, message);
+    line.push_back('}');
+    writeLine(line);
+
+    std::fprintf(stderr, "%s\n", message.c_str());
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Converts a string to lowercase</summary>
+  /// <param name="text">String that will be converted</param>
+  /// <returns>The lowercase version of the string</returns>
+  std::string toLowercase(std::string text) {
+    for(char &character : text) {
+      character = static_cast<char>(std::tolower(static_cast<unsigned char>(character)));
+    }
+    return text;
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Looks up a deinterlacer or interpolator by its (abbreviated) name</summary>
+  /// <typeparam name="TAlgorithm">Type of algorithm that will be looked up</typeparam>
+  /// <param name="algorithms">All registered algorithms of the requested type</param>
+  /// <param name="name">Full name or unique beginning of the name to look for</param>
+  /// <param name="kind">Kind of algorithm, used in error messages</param>
+  /// <returns>The algorithm with the specified name</returns>
+  template<typename TAlgorithm>
+  std::shared_ptr<TAlgorithm> findAlgorithmByName(
+    const std::vector<std::shared_ptr<TAlgorithm>> &algorithms,
+    const std::string &name,
+    const std::string &kind
+  ) {
+    std::string lowercaseName = toLowercase(name);
+
+    std::shared_ptr<TAlgorithm> match;
+    std::size_t matchCount = 0;
+    for(const std::shared_ptr<TAlgorithm> &algorithm : algorithms) {
+      std::string algorithmName = toLowercase(algorithm->GetName());
+      if(algorithmName == lowercaseName) {
+        return algorithm; // Exact matches win even if they are a prefix of another name
+      }
+      if(algorithmName.compare(0, lowercaseName.length(), lowercaseName) == 0) {
+        match = algorithm;
+        ++matchCount;
+      }
+    }
+
+    if(matchCount == 1) {
+      return match;
+    }
+
+    std::string message = (matchCount == 0) ? u8"No " : u8"More than one ";
+    message.append(kind);
+    message.append(u8" matches the name '", 19);
+    message.append(name);
+    message.append(u8"', use --list to see all choices", 32);
+    throw std::runtime_error(message);
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Returns the name under which a frame action is reported</summary>
+  /// <param name="action">Action whose name will be returned</param>
+  /// <returns>A short name for the action</returns>
+  std::string getActionName(Nuclex::FrameFixer::FrameAction action) {
+    using Nuclex::FrameFixer::FrameAction;
+
+    switch(action) {
+      case FrameAction::Discard: { return u8"discard"; }
+      case FrameAction::Average: { return u8"average"; }
+      case FrameAction::Duplicate: { return u8"duplicate"; }
+      case FrameAction::Triplicate: { return u8"triplicate"; }
+      case FrameAction::Replace: { return u8"replace"; }
+      case FrameAction::Deblend: { return u8"deblend"; }
+      case FrameAction::Interpolate: { return u8"interpolate"; }
+      case FrameAction::TopFieldFirst:
+      case FrameAction::BottomFieldFirst:
+      case FrameAction::TopFieldOnly:
+      case FrameAction::BottomFieldOnly: { return u8"deinterlace"; }
+      default: { return u8"keep"; }
+    }
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Sets up the service container with all available algorithms</summary>
+  /// <returns>The new service container</returns>
+  std::shared_ptr<Nuclex::FrameFixer::Services::ServicesRoot> createServicesRoot() {
+    using Nuclex::FrameFixer::Services::ServicesRoot;
+
+    std::shared_ptr<ServicesRoot> servicesRoot = std::make_shared<ServicesRoot>();
+    servicesRoot->Deinterlacers()->RegisterBuiltInDeinterlacers();
+#if defined(NUCLEX_FRAMEFIXER_ENABLE_LIBAV)
+    servicesRoot->Deinterlacers()->RegisterLibAvDeinterlacers();
+#endif
+    servicesRoot->Interpolators()->RegisterBuiltInInterpolators();
+#if defined(NUCLEX_FRAMEFIXER_ENABLE_CLI_INTERPOLATORS)
+    servicesRoot->Interpolators()->RegisterCliInterpolators();
+#endif
+
+    return servicesRoot;
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Opens the movie the command-line options point to</summary>
+  /// <param name="options">Options the renderer was launched with</param>
+  /// <returns>The movie with the frame states restored from its .frames.txt file</returns>
+  std::shared_ptr<Nuclex::FrameFixer::Movie> openMovie(
+    const Nuclex::FrameFixer::CommandLine::CommandLineOptions &options
+  ) {
+    using Nuclex::FrameFixer::Movie;
+
+    std::shared_ptr<Movie> movie = Movie::Open(options.FrameDirectory);
+    if(options.UseCacheFile) {
+      movie->EnableCacheFile();
+    }
+
+    return movie;
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Sets up a renderer as described by the command-line options</summary>
+  /// <param name="options">Options the renderer was launched with</param>
+  /// <param name="servicesRoot">Service container providing the algorithms</param>
+  /// <returns>A renderer ready to render the movie</returns>
+  std::shared_ptr<Nuclex::FrameFixer::Renderer> createRenderer(
+    const Nuclex::FrameFixer::CommandLine::CommandLineOptions &options,
+    const std::shared_ptr<Nuclex::FrameFixer::Services::ServicesRoot> &servicesRoot
+  ) {
+    using Nuclex::FrameFixer::Renderer;
+    namespace ImageFormats = Nuclex::FrameFixer::Rendering::ImageFormats;
+
+    std::shared_ptr<Renderer> renderer = std::make_shared<Renderer>();
+
+    if(options.DeinterlacerName.empty()) {
+      renderer->SetDeinterlacer(servicesRoot->Deinterlacers()->GetBasicDeinterlacer());
+    } else {
+      renderer->SetDeinterlacer(
+        findAlgorithmByName(
+          servicesRoot->Deinterlacers()->GetDeinterlacers(),
+          options.DeinterlacerName,
+          u8"deinterlacer"
+        )
+      );
+    }
+    if(options.InterpolatorName.empty()) {
+      renderer->SetInterpolator(servicesRoot->Interpolators()->GetNullInterpolator());
+    } else {
+      renderer->SetInterpolator(
+        findAlgorithmByName(
+          servicesRoot->Interpolators()->GetInterpolators(),
+          options.InterpolatorName,
+          u8"interpolator"
+        )
+      );
+    }
+
+    std::size_t threadCount = options.ThreadCount;
+    if(threadCount == 0) {
+      threadCount = std::max<std::size_t>(std::thread::hardware_concurrency(), 1);
+    }
+
+    renderer->SetFrameCache(servicesRoot->DecodedFrames());
+    renderer->SetFrameMemoryBudget(options.MemoryBudget * 1024 * 1024);
+    renderer->EnablePipelining();
+    renderer->SetEncoderThreadCount(threadCount);
+    renderer->SetProcessingThreadCount(threadCount);
+    renderer->SetReadAheadDepth(options.ReadAheadDepth);
+    renderer->SetReadAheadThreadCount(options.IoThreadCount);
+    renderer->EnableIncrementalRendering(options.Incremental);
+    renderer->FlipTopAndBottomField(options.FlipFields);
+
+    std::string averageMode = toLowercase(options.AverageMode);
+    if(averageMode == u8"mean") {
+      renderer->SetAverageMode(Nuclex::FrameFixer::AverageMode::Mean);
+    } else if(averageMode == u8"median") {
+      renderer->SetAverageMode(Nuclex::FrameFixer::AverageMode::Median);
+    } else if((averageMode == u8"trimmed") || (averageMode == u8"trimmed-mean")) {
+      renderer->SetAverageMode(Nuclex::FrameFixer::AverageMode::TrimmedMean);
+    } else {
+      throw std::runtime_error(
+        u8"Unknown average mode '" + options.AverageMode + u8"', use mean, median or trimmed"
+      );
+    }
+
+    if(options.InputFrameRange.has_value()) {
+      renderer->RestrictRangeOfInputFrames(
+        options.InputFrameRange.value().first, options.InputFrameRange.value().second
+      );
+    }
+    if(options.OutputFrameRange.has_value()) {
+      renderer->RestrictRangeOfOutputFrames(
+        options.OutputFrameRange.value().first, options.OutputFrameRange.value().second
+      );
+    }
+
+    // Output format, either one of the image formats or a video codec
+    std::string format = toLowercase(options.Format);
+    if(format == u8"png") {
+      renderer->SetImageEncoder(std::make_shared<ImageFormats::PngImageEncoder>());
+    } else if(format == u8"png-fast") {
+      renderer->SetImageEncoder(
+        std::make_shared<ImageFormats::PngImageEncoder>(1, ImageFormats::PngFilter::Up)
+      );
+    } else if(format == u8"tiff") {
+      renderer->SetImageEncoder(std::make_shared<ImageFormats::TiffImageEncoder>());
+    } else if(format == u8"qoi") {
+      renderer->SetImageEncoder(std::make_shared<ImageFormats::QoiImageEncoder>());
+    } else {
+      Nuclex::FrameFixer::Rendering::VideoSettings videoSettings;
+      videoSettings.Quality = options.VideoQuality;
+      videoSettings.FrameRateNumerator = 24000;
+      videoSettings.FrameRateDenominator = 1001;
+      if(format == u8"ffv1") {
+        videoSettings.Codec = Nuclex::FrameFixer::Rendering::VideoCodec::Ffv1;
+      } else if(format == u8"h264") {
+        videoSettings.Codec = Nuclex::FrameFixer::Rendering::VideoCodec::H264;
+      } else if(format == u8"h265") {
+        videoSettings.Codec = Nuclex::FrameFixer::Rendering::VideoCodec::H265;
+      } else {
+        throw std::runtime_error(u8"Unknown output format '" + options.Format + u8"'");
+      }
+      renderer->SetVideoOutput(videoSettings);
+    }
+
+    return renderer;
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Prints the names of all available deinterlacers and interpolators</summary>
+  /// <param name="servicesRoot">Service container providing the algorithms</param>
+  /// <returns>The exit code the application should terminate with</returns>
+  int listAlgorithms(
+    const std::shared_ptr<Nuclex::FrameFixer::Services::ServicesRoot> &servicesRoot
+  ) {
+    std::string line;
+
+    const auto &deinterlacers = servicesRoot->Deinterlacers()->GetDeinterlacers();
+    for(std::size_t index = 0; index < deinterlacers.size(); ++index) {
+      line.assign(u8"{\"event\":\"deinterlacer\",\"name\":", 31);
+      appendJsonString(line, deinterlacers[index]->GetName());
+      line.push_back('}');
+      writeLine(line);
+    }
+
+    const auto &interpolators = servicesRoot->Interpolators()->GetInterpolators();
+    for(std::size_t index = 0; index < interpolators.size(); ++index) {
+      line.assign(u8"{\"event\":\"interpolator\",\"name\":", 31);
+      appendJsonString(line, interpolators[index]->GetName());
+      line.push_back('}');
+      writeLine(line);
+    }
+
+    return 0;
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Prints statistics about a movie and the output frames it will produce</summary>
+  /// <param name="options">Options the renderer was launched with</param>
+  /// <param name="servicesRoot">Service container providing the algorithms</param>
+  /// <returns>The exit code the application should terminate with</returns>
+  int analyze(
+    const Nuclex::FrameFixer::CommandLine::CommandLineOptions &options,
+    const std::shared_ptr<Nuclex::FrameFixer::Services::ServicesRoot> &servicesRoot
+  ) {
+    using Nuclex::FrameFixer::Movie;
+    using Nuclex::FrameFixer::Frame;
+
+    std::shared_ptr<Movie> movie = openMovie(options);
+    std::shared_ptr<Nuclex::FrameFixer::Renderer> renderer = createRenderer(
+      options, servicesRoot
+    );
+
+    std::map<std::string, std::size_t> actionCounts;
+    std::size_t insertedInterpolatedFrameCount = 0;
+    for(const Frame &frame : movie->Frames) {
+      ++actionCounts[
+        getActionName(
+          Nuclex::FrameFixer::Rendering::RenderPlan::GetFrameAction(frame, options.FlipFields)
+        )
+      ];
+      if(frame.AlsoInsertInterpolatedAfter.has_value()) {
+        if(frame.AlsoInsertInterpolatedAfter.value()) {
+          ++insertedInterpolatedFrameCount;
+        }
+      }
+    }
+
+    std::string line(u8"{\"event\":\"analysis\",\"inputFrames\":", 34);
+    Nuclex::Support::Text::lexical_append(line, movie->Frames.size());
+    line.append(u8",\"outputFrames\":", 16);
+    Nuclex::Support::Text::lexical_append(line, renderer->GetTotalFrameCount(movie));
+    line.append(u8",\"insertedInterpolatedFrames\":", 30);
+    Nuclex::Support::Text::lexical_append(line, insertedInterpolatedFrameCount);
+    line.append(u8",\"actions\":{", 12);
+    bool isFirst = true;
+    for(const std::pair<const std::string, std::size_t> &actionCount : actionCounts) {
+      if(!isFirst) {
+        line.push_back(',');
+      }
+      appendJsonString(line, actionCount.first);
+      line.push_back(':');
+      Nuclex::Support::Text::lexical_append(line, actionCount.second);
+      isFirst = false;
+    }
+    line.append(u8"}}", 2);
+    writeLine(line);
+
+    return 0;
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Appends the frame counters of a progress report to a JSON line</summary>
+  /// <param name="line">Line the frame counters will be appended to</param>
+  /// <param name="completedFrameCount">Number of frames rendered so far</param>
+  /// <param name="totalFrameCount">Number of frames that will be rendered in total</param>
+  /// <param name="elapsedSeconds">Time that has passed since rendering began</param>
+  void appendProgress(
+    std::string &line,
+    std::size_t completedFrameCount, std::size_t totalFrameCount, double elapsedSeconds
+  ) {
+    line.append(u8",\"completedFrames\":", 19);
+    Nuclex::Support::Text::lexical_append(line, completedFrameCount);
+    line.append(u8",\"totalFrames\":", 15);
+    Nuclex::Support::Text::lexical_append(line, totalFrameCount);
+    line.append(u8",\"elapsedSeconds\":", 18);
+    Nuclex::Support::Text::lexical_append(line, elapsedSeconds);
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Appends the memory taken up by frames in flight to a JSON line</summary>
+  /// <param name="line">Line the memory usage will be appended to</param>
+  /// <param name="renderer">Renderer whose memory usage will be appended</param>
+  void appendMemoryUsage(std::string &line, const Nuclex::FrameFixer::Renderer &renderer) {
+    std::shared_ptr<const Nuclex::FrameFixer::Rendering::FrameMemoryBudget> memoryBudget = (
+      renderer.GetFrameMemoryBudget()
+    );
+    line.append(u8",\"memoryBytes\":", 15);
+    Nuclex::Support::Text::lexical_append(line, memoryBudget->GetCurrentUsage());
+    line.append(u8",\"peakMemoryBytes\":", 19);
+    Nuclex::Support::Text::lexical_append(line, memoryBudget->GetPeakUsage());
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Checks whether the output format is an image format</summary>
+  /// <param name="format">Output format as specified on the command line</param>
+  /// <returns>True if the output is written as individual image files</returns>
+  bool isImageFormat(const std::string &format) {
+    std::string lowercaseFormat = toLowercase(format);
+    return (
+      (lowercaseFormat == u8"png") ||
+      (lowercaseFormat == u8"png-fast") ||
+      (lowercaseFormat == u8"tiff") ||
+      (lowercaseFormat == u8"qoi")
+    );
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Runs a render in a background thread while polling in the calling thread</summary>
+  /// <param name="renderer">Renderer that will render the movie</param>
+  /// <param name="movie">Movie that will be rendered</param>
+  /// <param name="targetDirectory">Directory the output frames will be written to</param>
+  /// <param name="poll">
+  ///   Called in regular intervals while the render is running, returns false to cancel it
+  /// </param>
+  /// <param name="canceled">Receives whether the render was canceled</param>
+  /// <returns>The error that ended the render, empty if it finished or was canceled</returns>
+  std::exception_ptr renderInBackground(
+    const std::shared_ptr<Nuclex::FrameFixer::Renderer> &renderer,
+    const std::shared_ptr<Nuclex::FrameFixer::Movie> &movie,
+    const std::string &targetDirectory,
+    const std::function<bool()> &poll,
+    bool &canceled
+  ) {
+    using Nuclex::Platform::Tasks::CancellationTrigger;
+
+    std::shared_ptr<CancellationTrigger> cancelTrigger = CancellationTrigger::Create();
+    std::exception_ptr renderError;
+    std::atomic<bool> finished(false);
+
+    canceled = false;
+    std::thread renderThread(
+      [&]() {
+        Nuclex::FrameFixer::Diagnostics::TraceRecorder::NameCurrentThread(u8"Renderer");
+        try {
+          renderer->Render(movie, targetDirectory, cancelTrigger->GetWatcher());
+        }
+        catch(const Nuclex::Support::Errors::CanceledError &) {
+          canceled = true;
+        }
+        catch(const std::exception &) {
+          renderError = std::current_exception();
+        }
+        finished.store(true, std::memory_order_release);
+      }
+    );
+
+    // The poll callback must not throw, otherwise the render thread would be left running
+    const std::chrono::milliseconds pollInterval(50);
+    bool cancellationForwarded = false;
+    while(!finished.load(std::memory_order_acquire)) {
+      std::this_thread::sleep_for(pollInterval);
+
+      bool keepRendering = poll();
+      if(!keepRendering && !cancellationForwarded) {
+        cancelTrigger->Cancel();
+        cancellationForwarded = true;
+      }
+    }
+    renderThread.join();
+
+    return renderError;
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Renders a movie while reporting the progress on stdout</summary>
+  /// <param name="options">Options the renderer was launched with</param>
+  /// <param name="servicesRoot">Service container providing the algorithms</param>
+  /// <returns>The exit code the application should terminate with</returns>
+  int render(
+    const Nuclex::FrameFixer::CommandLine::CommandLineOptions &options,
+    const std::shared_ptr<Nuclex::FrameFixer::Services::ServicesRoot> &servicesRoot
+  ) {
+    using Nuclex::FrameFixer::Movie;
+
+    std::shared_ptr<Movie> movie = openMovie(options);
+    std::shared_ptr<Nuclex::FrameFixer::Renderer> renderer = createRenderer(
+      options, servicesRoot
+    );
+    std::size_t totalFrameCount = renderer->GetTotalFrameCount(movie);
+
+    std::string line(u8"{\"event\":\"start\",\"inputFrames\":", 31);
+    Nuclex::Support::Text::lexical_append(line, movie->Frames.size());
+    line.append(u8",\"totalFrames\":", 15);
+    Nuclex::Support::Text::lexical_append(line, totalFrameCount);
+    line.push_back('}');
+    writeLine(line);
+
+    std::signal(SIGINT, &requestCancellation);
+    std::signal(SIGTERM, &requestCancellation);
+
+    // Render in a background thread so the main thread is free to report progress
+    std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+    std::chrono::milliseconds progressInterval(options.ProgressInterval);
+    std::chrono::steady_clock::time_point nextReportTime = startTime + progressInterval;
+    bool canceled;
+    std::exception_ptr renderError = renderInBackground(
+      renderer, movie, options.TargetDirectory,
+      [&]() {
+        std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+        if(now >= nextReportTime) {
+          nextReportTime = now + progressInterval;
+
+          line.assign(u8"{\"event\":\"progress\"", 19);
+          appendProgress(
+            line,
+            renderer->GetCompletedFrameCount(),
+            totalFrameCount,
+            std::chrono::duration<double>(now - startTime).count()
+          );
+          appendMemoryUsage(line, *renderer);
+          line.push_back('}');
+          writeLine(line);
+        }
+
+        return (cancellationRequested == 0);
+      },
+      canceled
+    );
+
+    double elapsedSeconds = std::chrono::duration<double>(
+      std::chrono::steady_clock::now() - startTime
+    ).count();
+
+    if(static_cast<bool>(renderError)) {
+      try {
+        std::rethrow_exception(renderError);
+      }
+      catch(const std::exception &error) {
+        reportError(error.what());
+      }
+      return 1;
+    }
+
+    line.assign(canceled ? u8"{\"event\":\"canceled\"" : u8"{\"event\":\"finished\"");
+    appendProgress(line, renderer->GetCompletedFrameCount(), totalFrameCount, elapsedSeconds);
+    appendMemoryUsage(line, *renderer);
+    line.push_back('}');
+    writeLine(line);
+
+    return canceled ? 130 : 0;
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Appends the output frame range of a lease to a JSON line</summary>
+  /// <param name="line">Line the output frame range will be appended to</param>
+  /// <param name="lease">Lease whose output frame range will be appended</param>
+  void appendLease(std::string &line, const Nuclex::FrameFixer::Rendering::RenderLease &lease) {
+    line.append(u8",\"startFrame\":", 14);
+    Nuclex::Support::Text::lexical_append(line, lease.StartOutputFrameIndex);
+    line.append(u8",\"endFrame\":", 12);
+    Nuclex::Support::Text::lexical_append(line, lease.EndOutputFrameIndex);
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Renders chunks of a movie's output frames shared with other workers</summary>
+  /// <param name="options">Options the renderer was launched with</param>
+  /// <param name="servicesRoot">Service container providing the algorithms</param>
+  /// <returns>The exit code the application should terminate with</returns>
+  /// <remarks>
+  ///   <para>
+  ///     Every worker started on the same target directory leases chunks of output frames
+  ///     from a lease file, renders them and marks them as done. Workers that finish early
+  ///     keep taking chunks until none are left, so faster machines end up rendering more.
+  ///   </para>
+  ///   <para>
+  ///     While rendering, a worker renews its lease in regular intervals. If a worker crashes
+  ///     or hangs, its lease runs out and another worker takes over the chunk. A worker that
+  ///     finds it has lost its lease stops rendering the chunk and moves on.
+  ///   </para>
+  /// </remarks>
+  int renderShard(
+    const Nuclex::FrameFixer::CommandLine::CommandLineOptions &options,
+    const std::shared_ptr<Nuclex::FrameFixer::Services::ServicesRoot> &servicesRoot
+  ) {
+    using Nuclex::FrameFixer::Movie;
+    using Nuclex::FrameFixer::Rendering::RenderLease;
+    using Nuclex::FrameFixer::Rendering::RenderLeaseFile;
+
+    // Videos and pipes need their frames in order, so only image files can be split up
+    if(!isImageFormat(options.Format)) {
+      throw std::runtime_error(
+        u8"Sharded rendering only works with image formats, not '" + options.Format + u8"'"
+      );
+    }
+
+    std::shared_ptr<Movie> movie = openMovie(options);
+    std::shared_ptr<Nuclex::FrameFixer::Renderer> renderer = createRenderer(
+      options, servicesRoot
+    );
+
+    // The render manifest and statistics are rewritten by each render, so several workers
+    // would overwrite each other's files. The lease file tracks finished chunks instead.
+    renderer->EnableIncrementalRendering(false);
+    renderer->EnableStatisticsFile(false);
+
+    std::string workerName = options.WorkerName;
+    if(workerName.empty()) {
+      workerName = RenderLeaseFile::GetDefaultWorkerName();
+    }
+    std::chrono::seconds leaseDuration(options.LeaseTimeout);
+    RenderLeaseFile leases(options.TargetDirectory, workerName, leaseDuration);
+
+    std::pair<std::size_t, std::size_t> outputFrameRange = renderer->GetOutputFrameRange(movie);
+    std::size_t totalFrameCount = outputFrameRange.second - outputFrameRange.first;
+    leases.Prepare(outputFrameRange.first, outputFrameRange.second, options.ChunkSize);
+
+    std::string line(u8"{\"event\":\"start\",\"worker\":", 26);
+    appendJsonString(line, workerName);
+    line.append(u8",\"inputFrames\":", 15);
+    Nuclex::Support::Text::lexical_append(line, movie->Frames.size());
+    line.append(u8",\"totalFrames\":", 15);
+    Nuclex::Support::Text::lexical_append(line, totalFrameCount);
+    line.push_back('}');
+    writeLine(line);
+
+    std::signal(SIGINT, &requestCancellation);
+    std::signal(SIGTERM, &requestCancellation);
+
+    std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+    std::chrono::milliseconds progressInterval(options.ProgressInterval);
+    std::chrono::steady_clock::time_point nextReportTime = startTime + progressInterval;
+    std::size_t renderedChunkCount = 0;
+    bool canceled = false;
+    while(cancellationRequested == 0) {
+      std::optional<RenderLease> lease = leases.Acquire();
+
+      // If no chunk is open, either all are done or other workers are busy with them.
+      // Keep checking in case one of them dies and its lease needs to be taken over.
+      if(!lease.has_value()) {
+        if(leases.IsFinished()) {
+          break;
+        }
+        for(std::size_t step = 0; (step < 20) && (cancellationRequested == 0); ++step) {
+          std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        }
+        continue;
+      }
+
+      line.assign(u8"{\"event\":\"lease\"", 16);
+      appendLease(line, lease.value());
+      line.push_back('}');
+      writeLine(line);
+
+      // Render the chunk in the background and keep the lease alive meanwhile
+      renderer->RestrictRangeOfOutputFrames(
+        lease.value().StartOutputFrameIndex, lease.value().EndOutputFrameIndex
+      );
+      std::size_t previouslyCompletedFrameCount = leases.CountCompletedFrames();
+      std::chrono::steady_clock::duration renewInterval = leaseDuration / 4;
+      std::chrono::steady_clock::time_point nextRenewTime = (
+        std::chrono::steady_clock::now() + renewInterval
+      );
+      bool leaseLost = false;
+      std::exception_ptr renderError = renderInBackground(
+        renderer, movie, options.TargetDirectory,
+        [&]() {
+          std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+          if(now >= nextRenewTime) {
+            nextRenewTime = now + renewInterval;
+
+            // A failure to access the lease file may be temporary (network share),
+            // the next attempt or the lease expiring will sort it out either way.
+            try {
+              leaseLost = !leases.Renew(lease.value());
+            }
+            catch(const std::exception &) {}
+          }
+          if(now >= nextReportTime) {
+            nextReportTime = now + progressInterval;
+
+            line.assign(u8"{\"event\":\"progress\"", 19);
+            appendProgress(
+              line,
+              previouslyCompletedFrameCount + renderer->GetCompletedFrameCount(),
+              totalFrameCount,
+              std::chrono::duration<double>(now - startTime).count()
+            );
+            appendMemoryUsage(line, *renderer);
+            line.push_back('}');
+            writeLine(line);
+          }
+
+          return (cancellationRequested == 0) && !leaseLost;
+        },
+        canceled
+      );
+
+      if(static_cast<bool>(renderError)) {
+        leases.Release(lease.value());
+        try {
+          std::rethrow_exception(renderError);
+        }
+        catch(const std::exception &error) {
+          reportError(error.what());
+        }
+        return 1;
+      }
+
+      if(leaseLost) {
+        line.assign(u8"{\"event\":\"leaseLost\"", 20);
+        appendLease(line, lease.value());
+        line.push_back('}');
+        writeLine(line);
+        canceled = false;
+      } else if(canceled) {
+        leases.Release(lease.value());
+        break;
+      } else {
+        leases.Complete(lease.value());
+        ++renderedChunkCount;
+
+        line.assign(u8"{\"event\":\"chunkFinished\"", 24);
+        appendLease(line, lease.value());
+        line.push_back('}');
+        writeLine(line);
+      }
+    }
+
+    canceled |= (cancellationRequested != 0);
+
+    double elapsedSeconds = std::chrono::duration<double>(
+      std::chrono::steady_clock::now() - startTime
+    ).count();
+
+    line.assign(canceled ? u8"{\"event\":\"canceled\"" : u8"{\"event\":\"finished\"");
+    appendProgress(line, leases.CountCompletedFrames(), totalFrameCount, elapsedSeconds);
+    line.append(u8",\"renderedChunks\":", 18);
+    Nuclex::Support::Text::lexical_append(line, renderedChunkCount);
+    line.push_back('}');
+    writeLine(line);
+
+    return canceled ? 130 : 0;
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+} // anonymous namespace
+
+// --------------------------------------------------------------------------------------------- //
+
+/// <summary>Entry point for the command-line renderer</summary>
+/// <param name="argc">The number of command line arguments provided</param>
+/// <param name="argv">The values of all command line arguments</param>
+/// <returns>The exit code the application has terminated with</returns>
+/// <remarks>
+///   Only a QCoreApplication is created, so this runs without a display and without
+///   Qt Widgets, for example on headless render nodes.
+/// </remarks>
+int main(int argc, char *argv[]) {
+  using Nuclex::FrameFixer::CommandLine::CommandLineOptions;
+  using Nuclex::FrameFixer::CommandLine::Command;
+
+  QCoreApplication application(argc, argv);
+
+  CommandLineOptions options;
+  try {
+    options = CommandLineOptions::Parse(argc, argv);
+  }
+  catch(const std::exception &error) {
+    std::string usage = CommandLineOptions::GetUsage(argv[0]);
+    std::fprintf(stderr, "%s\n\n%s", error.what(), usage.c_str());
+    return 2;
+  }
+
+  if(options.Action == Command::ShowHelp) {
+    std::string usage = CommandLineOptions::GetUsage(argv[0]);
+    std::fwrite(usage.data(), 1, usage.length(), stdout);
+    return 0;
+  }
+
+  try {
+    std::shared_ptr<Nuclex::FrameFixer::Services::ServicesRoot> servicesRoot = (
+      createServicesRoot()
+    );
+    switch(options.Action) {
+      case Command::ListAlgorithms: { return listAlgorithms(servicesRoot); }
+      case Command::Analyze: { return analyze(options, servicesRoot); }
+      default: {
+        using Nuclex::FrameFixer::Diagnostics::TraceRecorder;
+
+        bool isTracing = !options.TracePath.empty();
+        if(isTracing) {
+          TraceRecorder::Start();
+        }
+
+        int exitCode;
+        if(options.Shard) {
+          exitCode = renderShard(options, servicesRoot);
+        } else {
+          exitCode = render(options, servicesRoot);
+        }
+
+        if(isTracing) {
+          TraceRecorder::Stop();
+          TraceRecorder::Save(options.TracePath);
+        }
+        return exitCode;
+      }
+    }
+  }
+  catch(const std::exception &error) {
+    reportError(error.what());
+    return 1;
+  }
+}
+
+// --------------------------------------------------------------------------------------------- //
@@ -0,0 +1,530 @@
+#pragma region Apache License 2.0
+/*
+Nuclex Frame Fixer
+Copyright (C) 2024 Markus Ewald / Nuclex Development Labs
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#pragma endregion // Apache License 2.0
+
+// If the application is compiled as a DLL, this ensures symbols are exported
+#define NUCLEX_FRAMEFIXER_SOURCE 1
+
+#include "./AverageAccumulator.h"
+#include "./ParallelBands.h"
+#include "../Platform/CpuFeatures.h"
+
+#include <algorithm> // for std::min()
+#include <cmath> // for std::lrint()
+#include <stdexcept> // for std::invalid_argument, std::runtime_error
+
+#if defined(NUCLEX_FRAMEFIXER_HAVE_SSE2)
+  #include <emmintrin.h> // for SSE2 intrinsics
+#endif
+#if defined(NUCLEX_FRAMEFIXER_HAVE_AVX2)
+  #include <immintrin.h> // for AVX2 intrinsics
+#endif
+
+namespace {
+
+  // ------------------------------------------------------------------------------------------- //
+
+#if defined(NUCLEX_FRAMEFIXER_HAVE_AVX2)
+  /// <summary>Adds a row of 8 bit channels to their running sums using AVX2</summary>
+  /// <param name="values">Channel values that will be added</param>
+  /// <param name="sums">Running sums of the channels, aligned to 32 bytes</param>
+  /// <param name="count">Number of channels in the row</param>
+  /// <param name="weight">Factor by which the channel values will be multiplied</param>
+  /// <returns>The number of channels that have been added</returns>
+  NUCLEX_FRAMEFIXER_AVX2_FUNCTION std::size_t accumulateRowAvx2(
+    const std::uint8_t *values, std::uint32_t *sums, std::size_t count, std::uint32_t weight
+  ) {
+    const __m256i weights = _mm256_set1_epi32(static_cast<int>(weight));
+
+    std::size_t index = 0;
+    for(; index + 16 <= count; index += 16) {
+      __m128i packed = _mm_loadu_si128(reinterpret_cast<const __m128i *>(values + index));
+      __m256i low = _mm256_mullo_epi32(_mm256_cvtepu8_epi32(packed), weights);
+      __m256i high = _mm256_mullo_epi32(
+        _mm256_cvtepu8_epi32(_mm_srli_si128(packed, 8)), weights
+      );
+
+      __m256i *target = reinterpret_cast<__m256i *>(sums + index);
+      _mm256_store_si256(target, _mm256_add_epi32(_mm256_load_si256(target), low));
+      _mm256_store_si256(target + 1, _mm256_add_epi32(_mm256_load_si256(target + 1), high));
+    }
+
+    return index;
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Adds a row of 16 bit channels to their running sums using AVX2</summary>
+  /// <param name="values">Channel values that will be added</param>
+  /// <param name="sums">Running sums of the channels, aligned to 32 bytes</param>
+  /// <param name="count">Number of channels in the row</param>
+  /// <param name="weight">Factor by which the channel values will be multiplied</param>
+  /// <returns>The number of channels that have been added</returns>
+  NUCLEX_FRAMEFIXER_AVX2_FUNCTION std::size_t accumulateRowAvx2(
+    const std::uint16_t *values, std::uint32_t *sums, std::size_t count, std::uint32_t weight
+  ) {
+    const __m256i weights = _mm256_set1_epi32(static_cast<int>(weight));
+
+    std::size_t index = 0;
+    for(; index + 16 <= count; index += 16) {
+      const __m128i *source = reinterpret_cast<const __m128i *>(values + index);
+      __m256i low = _mm256_mullo_epi32(_mm256_cvtepu16_epi32(_mm_loadu_si128(source)), weights);
+      __m256i high = _mm256_mullo_epi32(
+        _mm256_cvtepu16_epi32(_mm_loadu_si128(source + 1)), weights
+      );
+
+      __m256i *target = reinterpret_cast<__m256i *>(sums + index);
+      _mm256_store_si256(target, _mm256_add_epi32(_mm256_load_si256(target), low));
+      _mm256_store_si256(target + 1, _mm256_add_epi32(_mm256_load_si256(target + 1), high));
+    }
+
+    return index;
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Divides a row of channel sums into 8 bit channels using AVX2</summary>
+  /// <param name="sums">Running sums of the channels, aligned to 32 bytes</param>
+  /// <param name="values">Receives the averaged channel values</param>
+  /// <param name="count">Number of channels in the row</param>
+  /// <param name="reciprocal">Reciprocal of the number of frames summed</param>
+  /// <returns>The number of channels that have been stored</returns>
+  NUCLEX_FRAMEFIXER_AVX2_FUNCTION std::size_t resolveRowAvx2(
+    const std::uint32_t *sums, std::uint8_t *values, std::size_t count, float reciprocal
+  ) {
+    const __m256 factor = _mm256_set1_ps(reciprocal);
+
+    std::size_t index = 0;
+    for(; index + 16 <= count; index += 16) {
+      const __m256i *source = reinterpret_cast<const __m256i *>(sums + index);
+      __m256i low = _mm256_cvtps_epi32(
+        _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_load_si256(source)), factor)
+      );
+      __m256i high = _mm256_cvtps_epi32(
+        _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_load_si256(source + 1)), factor)
+      );
+
+      // Packing works within each 128 bit lane, so put the quadwords back in order
+      __m256i words = _mm256_permute4x64_epi64(_mm256_packs_epi32(low, high), 0xD8);
+      _mm_storeu_si128(
+        reinterpret_cast<__m128i *>(values + index),
+        _mm_packus_epi16(_mm256_castsi256_si128(words), _mm256_extracti128_si256(words, 1))
+      );
+    }
+
+    return index;
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Divides a row of channel sums into 16 bit channels using AVX2</summary>
+  /// <param name="sums">Running sums of the channels, aligned to 32 bytes</param>
+  /// <param name="values">Receives the averaged channel values</param>
+  /// <param name="count">Number of channels in the row</param>
+  /// <param name="reciprocal">Reciprocal of the number of frames summed</param>
+  /// <returns>The number of channels that have been stored</returns>
+  NUCLEX_FRAMEFIXER_AVX2_FUNCTION std::size_t resolveRowAvx2(
+    const std::uint32_t *sums, std::uint16_t *values, std::size_t count, float reciprocal
+  ) {
+    const __m256 factor = _mm256_set1_ps(reciprocal);
+
+    std::size_t index = 0;
+    for(; index + 16 <= count; index += 16) {
+      const __m256i *source = reinterpret_cast<const __m256i *>(sums + index);
+      __m256i low = _mm256_cvtps_epi32(
+        _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_load_si256(source)), factor)
+      );
+      __m256i high = _mm256_cvtps_epi32(
+        _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_load_si256(source + 1)), factor)
+      );
+
+      // Packing works within each 128 bit lane, so put the quadwords back in order
+      _mm256_storeu_si256(
+        reinterpret_cast<__m256i *>(values + index),
+        _mm256_permute4x64_epi64(_mm256_packus_epi32(low, high), 0xD8)
+      );
+    }
+
+    return index;
+  }
+#endif // defined(NUCLEX_FRAMEFIXER_HAVE_AVX2)
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Adds a row of 8 bit channels to their running sums</summary>
+  /// <param name="values">Channel values that will be added</param>
+  /// <param name="sums">Running sums of the channels, aligned to 32 bytes</param>
+  /// <param name="count">Number of channels in the row</param>
+  /// <param name="weight">Factor by which the channel values will be multiplied</param>
+  void accumulateRow(
+    const std::uint8_t *values, std::uint32_t *sums, std::size_t count, std::uint32_t weight
+  ) {
+    std::size_t index = 0;
+
+#if defined(NUCLEX_FRAMEFIXER_HAVE_AVX2)
+    if(Nuclex::FrameFixer::Platform::CpuFeatures::HasAvx2()) {
+      index = accumulateRowAvx2(values, sums, count, weight);
+    }
+#endif
+
+    // SSE2 has no 32 bit multiplication, so weighted frames are left to the scalar loop
+#if defined(NUCLEX_FRAMEFIXER_HAVE_SSE2)
+    if(weight == 1) {
+      const __m128i zero = _mm_setzero_si128();
+      for(; index + 16 <= count; index += 16) {
+        __m128i packed = _mm_loadu_si128(reinterpret_cast<const __m128i *>(values + index));
+        __m128i low = _mm_unpacklo_epi8(packed, zero);
+        __m128i high = _mm_unpackhi_epi8(packed, zero);
+
+        __m128i *target = reinterpret_cast<__m128i *>(sums + index);
+        _mm_store_si128(
+          target, _mm_add_epi32(_mm_load_si128(target), _mm_unpacklo_epi16(low, zero))
+        );
+        _mm_store_si128(
+          target + 1, _mm_add_epi32(_mm_load_si128(target + 1), _mm_unpackhi_epi16(low, zero))
+        );
+        _mm_store_si128(
+          target + 2, _mm_add_epi32(_mm_load_si128(target + 2), _mm_unpacklo_epi16(high, zero))
+        );
+        _mm_store_si128(
+          target + 3, _mm_add_epi32(_mm_load_si128(target + 3), _mm_unpackhi_epi16(high, zero))
+        );
+      }
+    }
+#endif
+
+    for(; index < count; ++index) {
+      sums[index] += static_cast<std::uint32_t>(values[index]) * weight;
+    }
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Adds a row of 16 bit channels to their running sums</summary>
+  /// <param name="values">Channel values that will be added</param>
+  /// <param name="sums">Running sums of the channels, aligned to 32 bytes</param>
+  /// <param name="count">Number of channels in the row</param>
+  /// <param name="weight">Factor by which the channel values will be multiplied</param>
+  void accumulateRow(
+    const std::uint16_t *values, std::uint32_t *sums, std::size_t count, std::uint32_t weight
+  ) {
+    std::size_t index = 0;
+
+#if defined(NUCLEX_FRAMEFIXER_HAVE_AVX2)
+    if(Nuclex::FrameFixer::Platform::CpuFeatures::HasAvx2()) {
+      index = accumulateRowAvx2(values, sums, count, weight);
+    }
+#endif
+
+    // SSE2 has no 32 bit multiplication, so weighted frames are left to the scalar loop
+#if defined(NUCLEX_FRAMEFIXER_HAVE_SSE2)
+    if(weight == 1) {
+      const __m128i zero = _mm_setzero_si128();
+      for(; index + 8 <= count; index += 8) {
+        __m128i packed = _mm_loadu_si128(reinterpret_cast<const __m128i *>(values + index));
+
+        __m128i *target = reinterpret_cast<__m128i *>(sums + index);
+        _mm_store_si128(
+          target, _mm_add_epi32(_mm_load_si128(target), _mm_unpacklo_epi16(packed, zero))
+        );
+        _mm_store_si128(
+          target + 1, _mm_add_epi32(_mm_load_si128(target + 1), _mm_unpackhi_epi16(packed, zero))
+        );
+      }
+    }
+#endif
+
+    for(; index < count; ++index) {
+      sums[index] += static_cast<std::uint32_t>(values[index]) * weight;
+    }
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Divides a row of channel sums into 8 bit channels</summary>
+  /// <param name="sums">Running sums of the channels, aligned to 32 bytes</param>
+  /// <param name="values">Receives the averaged channel values</param>
+  /// <param name="count">Number of channels in the row</param>
+  /// <param name="reciprocal">Reciprocal of the number of frames summed</param>
+  void resolveRow(
+    const std::uint32_t *sums, std::uint8_t *values, std::size_t count, float reciprocal
+  ) {
+    std::size_t index = 0;
+
+#if defined(NUCLEX_FRAMEFIXER_HAVE_AVX2)
+    if(Nuclex::FrameFixer::Platform::CpuFeatures::HasAvx2()) {
+      index = resolveRowAvx2(sums, values, count, reciprocal);
+    }
+#endif
+
+#if defined(NUCLEX_FRAMEFIXER_HAVE_SSE2)
+    const __m128 factor = _mm_set1_ps(reciprocal);
+    for(; index + 16 <= count; index += 16) {
+      const __m128i *source = reinterpret_cast<const __m128i *>(sums + index);
+      __m128i averages[4];
+      for(std::size_t part = 0; part < 4; ++part) {
+        averages[part] = _mm_cvtps_epi32(
+          _mm_mul_ps(_mm_cvtepi32_ps(_mm_load_si128(source + part)), factor)
+        );
+      }
+
+      _mm_storeu_si128(
+        reinterpret_cast<__m128i *>(values + index),
+        _mm_packus_epi16(
+          _mm_packs_epi32(averages[0], averages[1]), _mm_packs_epi32(averages[2], averages[3])
+        )
+      );
+    }
+#endif
+
+    for(; index < count; ++index) {
+      long average = std::lrint(static_cast<float>(sums[index]) * reciprocal);
+      values[index] = static_cast<std::uint8_t>(std::min<long>(average, 0xFF));
+    }
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Divides a row of channel sums into 16 bit channels</summary>
+  /// <param name="sums">Running sums of the channels, aligned to 32 bytes</param>
+  /// <param name="values">Receives the averaged channel values</param>
+  /// <param name="count">Number of channels in the row</param>
+  /// <param name="reciprocal">Reciprocal of the number of frames summed</param>
+  void resolveRow(
+    const std::uint32_t *sums, std::uint16_t *values, std::size_t count, float reciprocal
+  ) {
+    std::size_t index = 0;
+
+#if defined(NUCLEX_FRAMEFIXER_HAVE_AVX2)
+    if(Nuclex::FrameFixer::Platform::CpuFeatures::HasAvx2()) {
+      index = resolveRowAvx2(sums, values, count, reciprocal);
+    }
+#endif
+
+    // SSE2 can only pack into signed 16 bit integers, so shift the range before packing
+#if defined(NUCLEX_FRAMEFIXER_HAVE_SSE2)
+    const __m128 factor = _mm_set1_ps(reciprocal);
+    const __m128i bias32 = _mm_set1_epi32(0x8000);
+    const __m128i bias16 = _mm_set1_epi16(static_cast<short>(0x8000));
+    for(; index + 8 <= count; index += 8) {
+      const __m128i *source = reinterpret_cast<const __m128i *>(sums + index);
+      __m128i low = _mm_cvtps_epi32(_mm_mul_ps(_mm_cvtepi32_ps(_mm_load_si128(source)), factor));
+      __m128i high = _mm_cvtps_epi32(
+        _mm_mul_ps(_mm_cvtepi32_ps(_mm_load_si128(source + 1)), factor)
+      );
+
+      __m128i packed = _mm_packs_epi32(_mm_sub_epi32(low, bias32), _mm_sub_epi32(high, bias32));
+      _mm_storeu_si128(
+        reinterpret_cast<__m128i *>(values + index), _mm_xor_si128(packed, bias16)
+      );
+    }
+#endif
+
+    for(; index < count; ++index) {
+      long average = std::lrint(static_cast<float>(sums[index]) * reciprocal);
+      values[index] = static_cast<std::uint16_t>(std::min<long>(average, 0xFFFF));
+    }
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+} // anonymous namespace
+
+namespace Nuclex::FrameFixer {
+
+  // ------------------------------------------------------------------------------------------- //
+
+  const std::size_t AverageAccumulator::MaximumFrameCount = 32768;
+
+  // ------------------------------------------------------------------------------------------- //
+
+  AverageAccumulator::AverageAccumulator() :
+    threadCount(1),
+    frameCount(0),
+    width(0),
+    height(0),
+    sixteenBitChannels(false),
+    layout(Rendering::FrameLayout::Interleaved),
+    sums() {}
+
+  // ------------------------------------------------------------------------------------------- //
+
+  AverageAccumulator::~AverageAccumulator() {}
+
+  // ------------------------------------------------------------------------------------------- //
+
+  void AverageAccumulator::SetThreadCount(std::size_t threadCount) {
+    this->threadCount = std::max<std::size_t>(threadCount, 1);
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  std::size_t AverageAccumulator::GetByteCount() const {
+    if(!static_cast<bool>(this->sums)) {
+      return 0;
+    }
+
+    return (
+      this->sums->GetStride() * this->sums->GetHeight() * this->sums->GetPlaneCount() *
+      sizeof(std::uint32_t)
+    );
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  void AverageAccumulator::Reset() {
+    if(static_cast<bool>(this->sums) && (this->frameCount != 0)) {
+      this->sums->Fill(0);
+    }
+    this->frameCount = 0;
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  void AverageAccumulator::Add(const Rendering::FrameBuffer &frame, std::size_t weight /* = 1 */) {
+    if(weight == 0) {
+      return;
+    }
+
+    // The first frame decides the size and layout of the sums. Interleaved frames
+    // are summed as one plane with four values per pixel, planar ones plane by plane.
+    if(this->frameCount == 0) {
+      bool isPlanar = (frame.GetLayout() == Rendering::FrameLayout::Planar);
+      std::size_t columnCount = static_cast<std::size_t>(frame.GetWidth()) * (isPlanar ? 1 : 4);
+      std::size_t rowCount = static_cast<std::size_t>(frame.GetHeight());
+      std::size_t planeCount = isPlanar ? 4 : 1;
+
+      bool canReuseSums = (
+        static_cast<bool>(this->sums) &&
+        (this->sums->GetWidth() == columnCount) &&
+        (this->sums->GetHeight() == rowCount) &&
+        (this->sums->GetPlaneCount() == planeCount)
+      );
+      if(!canReuseSums) {
+        this->sums.reset(); // Free the old sums before allocating new ones
+        this->sums = std::make_unique<Algorithm::Matrix2D<std::uint32_t>>(
+          columnCount, rowCount, planeCount
+        );
+      }
+
+      this->width = frame.GetWidth();
+      this->height = frame.GetHeight();
+      this->sixteenBitChannels = frame.HasSixteenBitChannels();
+      this->layout = frame.GetLayout();
+    } else {
+      requireMatchingFrame(frame);
+    }
+
+    if(weight > MaximumFrameCount - this->frameCount) {
+      throw std::runtime_error(u8"Too many frames to average, sums would overflow");
+    }
+
+    std::uint32_t frameWeight = static_cast<std::uint32_t>(weight);
+    std::size_t columnCount = this->sums->GetWidth();
+    std::size_t planeCount = this->sums->GetPlaneCount();
+    Algorithm::Matrix2D<std::uint32_t> &sums = *this->sums;
+    Algorithm::ParallelBands::Process(
+      static_cast<std::size_t>(this->height),
+      static_cast<std::size_t>(this->width),
+      this->threadCount,
+      [&](std::size_t startLineIndex, std::size_t endLineIndex) {
+        for(std::size_t planeIndex = 0; planeIndex < planeCount; ++planeIndex) {
+          for(std::size_t lineIndex = startLineIndex; lineIndex < endLineIndex; ++lineIndex) {
+            const std::uint8_t *row = frame.GetRow(lineIndex, planeIndex);
+            if(this->sixteenBitChannels) {
+              accumulateRow(
+                reinterpret_cast<const std::uint16_t *>(row),
+                sums.GetRow(lineIndex, planeIndex), columnCount, frameWeight
+              );
+            } else {
+              accumulateRow(row, sums.GetRow(lineIndex, planeIndex), columnCount, frameWeight);
+            }
+          }
+        }
+      }
+    );
+
+    this->frameCount += weight;
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  void AverageAccumulator::Add(const QImage &image, std::size_t weight /* = 1 */) {
+    Add(Rendering::FrameBuffer::WrapReadOnly(image), weight);
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  void AverageAccumulator::Resolve(Rendering::FrameBuffer &target) const {
+    if(this->frameCount == 0) {
+      throw std::runtime_error(u8"Can't resolve an average before any frames have been added");
+    }
+    requireMatchingFrame(target);
+
+    float reciprocal = 1.0f / static_cast<float>(this->frameCount);
+    std::size_t columnCount = this->sums->GetWidth();
+    std::size_t planeCount = this->sums->GetPlaneCount();
+    const Algorithm::Matrix2D<std::uint32_t> &sums = *this->sums;
+    Algorithm::ParallelBands::Process(
+      static_cast<std::size_t>(this->height),
+      static_cast<std::size_t>(this->width),
+      this->threadCount,
+      [&](std::size_t startLineIndex, std::size_t endLineIndex) {
+        for(std::size_t planeIndex = 0; planeIndex < planeCount; ++planeIndex) {
+          for(std::size_t lineIndex = startLineIndex; lineIndex < endLineIndex; ++lineIndex) {
+            std::uint8_t *row = target.GetRow(lineIndex, planeIndex);
+            if(this->sixteenBitChannels) {
+              resolveRow(
+                sums.GetRow(lineIndex, planeIndex),
+                reinterpret_cast<std::uint16_t *>(row), columnCount, reciprocal
+              );
+            } else {
+              resolveRow(sums.GetRow(lineIndex, planeIndex), row, columnCount, reciprocal);
+            }
+          }
+        }
+      }
+    );
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  void AverageAccumulator::Resolve(QImage &target) const {
+    Rendering::FrameBuffer targetBuffer = Rendering::FrameBuffer::Wrap(target);
+    Resolve(targetBuffer);
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  void AverageAccumulator::requireMatchingFrame(const Rendering::FrameBuffer &frame) const {
+    bool isMatching = (
+      (frame.GetWidth() == this->width) &&
+      (frame.GetHeight() == this->height) &&
+      (frame.HasSixteenBitChannels() == this->sixteenBitChannels) &&
+      (frame.GetLayout() == this->layout)
+    );
+    if(!isMatching) {
+      throw std::invalid_argument(
+        u8"Frame must have the same size, channel size and layout as the averaged frames"
+      );
+    }
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+} // namespace Nuclex::FrameFixer
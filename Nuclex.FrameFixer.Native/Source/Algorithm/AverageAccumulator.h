@@ -0,0 +1,131 @@
+#pragma region Apache License 2.0
+/*
+Nuclex Frame Fixer
+Copyright (C) 2024 Markus Ewald / Nuclex Development Labs
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#pragma endregion // Apache License 2.0
+
+
+#ifndef NUCLEX_FRAMEFIXER_AVERAGEACCUMULATOR_H
+#define NUCLEX_FRAMEFIXER_AVERAGEACCUMULATOR_H
+
+#include "Nuclex/FrameFixer/Config.h"
+#include "../Rendering/FrameBuffer.h"
+#include "./Matrix2D.h"
+
+#include <cstddef> // for std::size_t
+#include <cstdint> // for std::uint32_t
+#include <memory> // for std::unique_ptr
+#include <QImage>
+
+namespace Nuclex::FrameFixer {
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Averages any number of frames while only holding their running sum</summary>
+  /// <remarks>
+  ///   <para>
+  ///     Frames are added one at a time, as they are decoded, so averaging a long run of
+  ///     frames needs no more memory than averaging two of them. The sums are kept as
+  ///     32 bit integers per channel, which takes twice the memory of a frame with
+  ///     16 bits per channel (or four times that of one with 8 bits per channel).
+  ///   </para>
+  ///   <para>
+  ///     Channels are summed in the order they are stored in, so the accumulator works
+  ///     the same for all pixel formats and layouts, but all frames added to it must
+  ///     have the same size, pixel format and layout. Large frames are split into
+  ///     horizontal bands that are summed by several threads in parallel.
+  ///   </para>
+  /// </remarks>
+  class AverageAccumulator {
+
+    /// <summary>Highest total weight of the frames that can be summed</summary>
+    /// <remarks>
+    ///   Sums of 16 bit channels stay within the positive range of a 32 bit integer
+    ///   up to this number of frames, which is what the conversion back needs.
+    /// </remarks>
+    public: static const std::size_t MaximumFrameCount;
+
+    /// <summary>Initializes a new, empty average accumulator</summary>
+    public: AverageAccumulator();
+    /// <summary>Frees all memory used by the average accumulator</summary>
+    public: ~AverageAccumulator();
+
+    /// <summary>Sets the number of threads that sum up bands of large frames</summary>
+    /// <param name="threadCount">Number of threads to use, including the calling thread</param>
+    public: void SetThreadCount(std::size_t threadCount);
+
+    /// <summary>Returns the total weight of the frames summed so far</summary>
+    /// <returns>The number of frames that have been added</returns>
+    public: std::size_t GetFrameCount() const { return this->frameCount; }
+
+    /// <summary>Returns the number of bytes the sums of the channels take up</summary>
+    /// <returns>The size of the running sum in bytes, 0 before a frame was added</returns>
+    public: std::size_t GetByteCount() const;
+
+    /// <summary>Forgets all frames that have been added</summary>
+    /// <remarks>
+    ///   The memory for the sums is kept for the next frames if they are of the same size.
+    /// </remarks>
+    public: void Reset();
+
+    /// <summary>Adds a frame to the running sum</summary>
+    /// <param name="frame">Frame that will be added</param>
+    /// <param name="weight">Number of frames the added frame stands for</param>
+    public: void Add(const Rendering::FrameBuffer &frame, std::size_t weight = 1);
+
+    /// <summary>Adds an image to the running sum</summary>
+    /// <param name="image">Image that will be added</param>
+    /// <param name="weight">Number of frames the added image stands for</param>
+    public: void Add(const QImage &image, std::size_t weight = 1);
+
+    /// <summary>Stores the average of all frames added so far in a frame</summary>
+    /// <param name="target">
+    ///   Frame that receives the average, must match the frames that were added
+    /// </param>
+    public: void Resolve(Rendering::FrameBuffer &target) const;
+
+    /// <summary>Stores the average of all images added so far in an image</summary>
+    /// <param name="target">
+    ///   Image that receives the average, must match the images that were added
+    /// </param>
+    public: void Resolve(QImage &target) const;
+
+    /// <summary>Throws an exception if a frame does not match the summed frames</summary>
+    /// <param name="frame">Frame that will be checked</param>
+    private: void requireMatchingFrame(const Rendering::FrameBuffer &frame) const;
+
+    /// <summary>Number of threads that sum up bands of large frames</summary>
+    private: std::size_t threadCount;
+    /// <summary>Total weight of the frames summed so far</summary>
+    private: std::size_t frameCount;
+    /// <summary>Width of the summed frames in pixels</summary>
+    private: int width;
+    /// <summary>Height of the summed frames in pixels</summary>
+    private: int height;
+    /// <summary>Whether the summed frames had 16 bits per channel</summary>
+    private: bool sixteenBitChannels;
+    /// <summary>Whether the summed frames were interleaved or planar</summary>
+    private: Rendering::FrameLayout layout;
+    /// <summary>Sum of each channel, in the same order as in the frames</summary>
+    private: std::unique_ptr<Algorithm::Matrix2D<std::uint32_t>> sums;
+
+  };
+
+  // ------------------------------------------------------------------------------------------- //
+
+} // namespace Nuclex::FrameFixer
+
+#endif // NUCLEX_FRAMEFIXER_AVERAGEACCUMULATOR_H
@@ -0,0 +1,61 @@
+#pragma region Apache License 2.0
+/*
+Nuclex Frame Fixer
+Copyright (C) 2024 Markus Ewald / Nuclex Development Labs
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#pragma endregion // Apache License 2.0
+
+
+#ifndef NUCLEX_FRAMEFIXER_AVERAGEMODE_H
+#define NUCLEX_FRAMEFIXER_AVERAGEMODE_H
+
+#include "Nuclex/FrameFixer/Config.h"
+
+namespace Nuclex::FrameFixer {
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Ways in which the frames of an averaging run can be combined</summary>
+  enum class AverageMode {
+
+    /// <summary>Each pixel becomes the mean of the pixels in all frames</summary>
+    /// <remarks>
+    ///   The fastest mode and the only one that doesn't need to hold all frames of
+    ///   the run in memory, but a dropout or sparkle in any frame will show through.
+    /// </remarks>
+    Mean,
+
+    /// <summary>Each pixel becomes the median of the pixels in all frames</summary>
+    /// <remarks>
+    ///   Ignores any outliers as long as they occur in less than half of the frames.
+    ///   For an even number of frames, the two middle values are averaged.
+    /// </remarks>
+    Median,
+
+    /// <summary>Each pixel becomes the mean of the pixels without the extremes</summary>
+    /// <remarks>
+    ///   Discards the highest and lowest quarter of the values of each pixel (at least
+    ///   one of each from three frames on) and averages the rest. This rejects outliers
+    ///   like the median does while still reducing noise like the mean does.
+    /// </remarks>
+    TrimmedMean
+
+  };
+
+  // ------------------------------------------------------------------------------------------- //
+
+} // namespace Nuclex::FrameFixer
+
+#endif // NUCLEX_FRAMEFIXER_AVERAGEMODE_H
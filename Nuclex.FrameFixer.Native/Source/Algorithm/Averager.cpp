@@ -21,11 +21,406 @@ limitations under the License.
 #define NUCLEX_FRAMEFIXER_SOURCE 1
 
 #include "./Averager.h"
+#include "./AverageAccumulator.h"
+#include "./Matrix2D.h"
+#include "./ParallelBands.h"
+#include "../Rendering/FrameBuffer.h"
+#include "../Platform/CpuFeatures.h"
+
+#include <algorithm> // for std::nth_element(), std::reverse()
+#include <atomic> // for std::atomic
+#include <cmath> // for std::lrint()
+#include <stdexcept> // for std::invalid_argument, std::runtime_error
+#include <utility> // for std::pair
+
+#if defined(NUCLEX_FRAMEFIXER_HAVE_SSE2)
+  #include <emmintrin.h> // for SSE2 intrinsics
+#endif
+#if defined(NUCLEX_FRAMEFIXER_HAVE_AVX2)
+  #include <immintrin.h> // for AVX2 intrinsics
+#endif
 
 namespace {
 
   // ------------------------------------------------------------------------------------------- //
 
+  /// <summary>Swaps the values on two wires of a sorting network if they're out of order</summary>
+  /// <remarks>
+  ///   The first index is always the lower one, it receives the smaller value.
+  /// </remarks>
+  typedef std::pair<std::size_t, std::size_t> Comparator;
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Describes how the values of a channel in all frames are combined</summary>
+  /// <remarks>
+  ///   The values of a channel in all frames are put on the wires of a sorting network,
+  ///   the comparators move the values the mode is interested in onto the wires from
+  ///   the first to the end index (in any order) and the mean of those is the result.
+  /// </remarks>
+  struct Selection {
+
+    /// <summary>Comparators that bring the selected values into place</summary>
+    public: std::vector<Comparator> Comparators;
+    /// <summary>Index of the first wire whose value is part of the result</summary>
+    public: std::size_t FirstIndex;
+    /// <summary>Index one past the last wire whose value is part of the result</summary>
+    public: std::size_t EndIndex;
+    /// <summary>Reciprocal of the number of values that are part of the result</summary>
+    public: float Reciprocal;
+
+  };
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Builds a sorting network for any number of values</summary>
+  /// <param name="valueCount">Number of values the network will sort</param>
+  /// <returns>The comparators of the sorting network, in the order they're applied</returns>
+  /// <remarks>
+  ///   This is Batcher's merge exchange (Knuth's TAOCP Vol. 3, Algorithm 5.2.2M),
+  ///   which needs O(n log² n) comparators and works for counts that aren't a power of 2.
+  /// </remarks>
+  std::vector<Comparator> createSortingNetwork(std::size_t valueCount) {
+    std::vector<Comparator> comparators;
+    if(valueCount < 2) {
+      return comparators;
+    }
+
+    std::size_t highestBit = 1;
+    while((highestBit * 2) < valueCount) {
+      highestBit *= 2;
+    }
+
+    for(std::size_t p = highestBit; p > 0; p /= 2) {
+      std::size_t q = highestBit, r = 0, d = p;
+      for(;;) {
+        for(std::size_t index = 0; index + d < valueCount; ++index) {
+          if((index & p) == r) {
+            comparators.emplace_back(index, index + d);
+          }
+        }
+        if(q == p) {
+          break;
+        }
+        d = q - p;
+        q /= 2;
+        r = p;
+      }
+    }
+
+    return comparators;
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Removes all comparators that have no effect on the selected wires</summary>
+  /// <param name="comparators">Comparators of a sorting network</param>
+  /// <param name="valueCount">Number of wires in the sorting network</param>
+  /// <param name="firstIndex">Index of the first wire whose value is needed</param>
+  /// <param name="endIndex">Index one past the last wire whose value is needed</param>
+  /// <returns>The comparators the values on the selected wires depend on</returns>
+  std::vector<Comparator> pruneSortingNetwork(
+    const std::vector<Comparator> &comparators,
+    std::size_t valueCount, std::size_t firstIndex, std::size_t endIndex
+  ) {
+    std::vector<bool> isNeeded(valueCount, false);
+    for(std::size_t index = firstIndex; index < endIndex; ++index) {
+      isNeeded[index] = true;
+    }
+
+    // Walk backwards, a comparator matters if a wire it writes to is read later on
+    std::vector<Comparator> pruned;
+    for(std::size_t index = comparators.size(); index > 0; --index) {
+      const Comparator &comparator = comparators[index - 1];
+      if(isNeeded[comparator.first] || isNeeded[comparator.second]) {
+        isNeeded[comparator.first] = true;
+        isNeeded[comparator.second] = true;
+        pruned.push_back(comparator);
+      }
+    }
+
+    std::reverse(pruned.begin(), pruned.end());
+    return pruned;
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Builds comparators that move the smallest and largest values outwards</summary>
+  /// <param name="valueCount">Number of wires the values are on</param>
+  /// <param name="firstIndex">Number of smallest values that will be moved down</param>
+  /// <param name="endIndex">Index at which the largest values will begin</param>
+  /// <returns>The comparators that separate the middle values from the others</returns>
+  /// <remarks>
+  ///   This is a partial bubble sort, each pass moves one more of the smallest values
+  ///   to the bottom or one more of the largest values to the top. When only a few values
+  ///   are discarded at either end, it needs fewer comparators than a sorting network.
+  /// </remarks>
+  std::vector<Comparator> createSelectionPasses(
+    std::size_t valueCount, std::size_t firstIndex, std::size_t endIndex
+  ) {
+    std::vector<Comparator> comparators;
+    for(std::size_t pass = 0; pass < firstIndex; ++pass) {
+      for(std::size_t index = valueCount - 1; index > pass; --index) {
+        comparators.emplace_back(index - 1, index);
+      }
+    }
+    for(std::size_t topIndex = valueCount - 1; topIndex >= endIndex; --topIndex) {
+      for(std::size_t index = firstIndex; index < topIndex; ++index) {
+        comparators.emplace_back(index, index + 1);
+      }
+    }
+
+    return comparators;
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Works out how the values of a channel are combined in an average mode</summary>
+  /// <param name="valueCount">Number of frames that are being combined</param>
+  /// <param name="mode">Average mode that decides which values form the result</param>
+  /// <returns>The comparators and range of wires forming the result</returns>
+  Selection createSelection(std::size_t valueCount, Nuclex::FrameFixer::AverageMode mode) {
+    Selection selection;
+    if(mode == Nuclex::FrameFixer::AverageMode::Median) {
+      selection.FirstIndex = (valueCount - 1) / 2;
+      selection.EndIndex = valueCount / 2 + 1;
+    } else if(mode == Nuclex::FrameFixer::AverageMode::TrimmedMean) {
+      std::size_t trimCount = (valueCount + 1) / 4;
+      selection.FirstIndex = trimCount;
+      selection.EndIndex = valueCount - trimCount;
+    } else {
+      selection.FirstIndex = 0;
+      selection.EndIndex = valueCount;
+    }
+
+    // Use whichever needs fewer comparators, the pruned sorting network
+    // or the partial bubble sort that pushes out the discarded values
+    if((selection.FirstIndex > 0) || (selection.EndIndex < valueCount)) {
+      std::vector<Comparator> network = pruneSortingNetwork(
+        createSortingNetwork(valueCount), valueCount, selection.FirstIndex, selection.EndIndex
+      );
+      std::vector<Comparator> passes = createSelectionPasses(
+        valueCount, selection.FirstIndex, selection.EndIndex
+      );
+      if(passes.size() < network.size()) {
+        selection.Comparators.swap(passes);
+      } else {
+        selection.Comparators.swap(network);
+      }
+    }
+
+    selection.Reciprocal = 1.0f / static_cast<float>(selection.EndIndex - selection.FirstIndex);
+    return selection;
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+#if defined(NUCLEX_FRAMEFIXER_HAVE_AVX2)
+  /// <summary>Combines a row of channels from several frames using AVX2</summary>
+  /// <param name="rows">Row of channel values from each frame</param>
+  /// <param name="rowCount">Number of frames providing rows</param>
+  /// <param name="sixteenBitChannels">Whether the channels are 16 bits wide</param>
+  /// <param name="selection">Selects the values that form the result</param>
+  /// <param name="wires">Scratch space for one vector per frame, aligned to 32 bytes</param>
+  /// <param name="wireStride">Distance between the vectors in the scratch space</param>
+  /// <param name="target">Row that receives the combined channel values</param>
+  /// <param name="count">Number of channels in each row</param>
+  /// <returns>The number of channels that have been combined</returns>
+  NUCLEX_FRAMEFIXER_AVX2_FUNCTION std::size_t selectRowAvx2(
+    const std::uint8_t *const *rows, std::size_t rowCount, bool sixteenBitChannels,
+    const Selection &selection,
+    std::uint16_t *wires, std::size_t wireStride,
+    std::uint8_t *target, std::size_t count
+  ) {
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256 factor = _mm256_set1_ps(selection.Reciprocal);
+    std::size_t comparatorCount = selection.Comparators.size();
+
+    std::size_t index = 0;
+    for(; index + 16 <= count; index += 16) {
+
+      // Each lane sorts the values of one channel, widened to 16 bits
+      for(std::size_t rowIndex = 0; rowIndex < rowCount; ++rowIndex) {
+        __m256i values;
+        if(sixteenBitChannels) {
+          values = _mm256_loadu_si256(
+            reinterpret_cast<const __m256i *>(rows[rowIndex]) + index / 16
+          );
+        } else {
+          values = _mm256_cvtepu8_epi16(
+            _mm_loadu_si128(reinterpret_cast<const __m128i *>(rows[rowIndex] + index))
+          );
+        }
+        _mm256_store_si256(reinterpret_cast<__m256i *>(wires + rowIndex * wireStride), values);
+      }
+
+      for(std::size_t comparatorIndex = 0; comparatorIndex < comparatorCount; ++comparatorIndex) {
+        const Comparator &comparator = selection.Comparators[comparatorIndex];
+        __m256i *lower = reinterpret_cast<__m256i *>(wires + comparator.first * wireStride);
+        __m256i *upper = reinterpret_cast<__m256i *>(wires + comparator.second * wireStride);
+        __m256i lowerValues = _mm256_load_si256(lower);
+        __m256i upperValues = _mm256_load_si256(upper);
+        _mm256_store_si256(lower, _mm256_min_epu16(lowerValues, upperValues));
+        _mm256_store_si256(upper, _mm256_max_epu16(lowerValues, upperValues));
+      }
+
+      // Unpacking and packing work within each 128 bit lane, so the order is restored
+      __m256i lowSum = zero, highSum = zero;
+      for(std::size_t wire = selection.FirstIndex; wire < selection.EndIndex; ++wire) {
+        __m256i values = _mm256_load_si256(
+          reinterpret_cast<const __m256i *>(wires + wire * wireStride)
+        );
+        lowSum = _mm256_add_epi32(lowSum, _mm256_unpacklo_epi16(values, zero));
+        highSum = _mm256_add_epi32(highSum, _mm256_unpackhi_epi16(values, zero));
+      }
+      __m256i result = _mm256_packus_epi32(
+        _mm256_cvtps_epi32(_mm256_mul_ps(_mm256_cvtepi32_ps(lowSum), factor)),
+        _mm256_cvtps_epi32(_mm256_mul_ps(_mm256_cvtepi32_ps(highSum), factor))
+      );
+
+      if(sixteenBitChannels) {
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(target) + index / 16, result);
+      } else {
+        _mm_storeu_si128(
+          reinterpret_cast<__m128i *>(target + index),
+          _mm_packus_epi16(_mm256_castsi256_si128(result), _mm256_extracti128_si256(result, 1))
+        );
+      }
+    }
+
+    return index;
+  }
+#endif // defined(NUCLEX_FRAMEFIXER_HAVE_AVX2)
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Combines a row of channels from several frames</summary>
+  /// <param name="rows">Row of channel values from each frame</param>
+  /// <param name="rowCount">Number of frames providing rows</param>
+  /// <param name="sixteenBitChannels">Whether the channels are 16 bits wide</param>
+  /// <param name="selection">Selects the values that form the result</param>
+  /// <param name="wires">Scratch space for one vector per frame, aligned to 32 bytes</param>
+  /// <param name="wireStride">Distance between the vectors in the scratch space</param>
+  /// <param name="values">Scratch space for one value per frame</param>
+  /// <param name="target">Row that receives the combined channel values</param>
+  /// <param name="count">Number of channels in each row</param>
+  /// <remarks>
+  ///   The target row may be one of the source rows since each group of channels
+  ///   is read from all rows before the results are written.
+  /// </remarks>
+  void selectRow(
+    const std::uint8_t *const *rows, std::size_t rowCount, bool sixteenBitChannels,
+    const Selection &selection,
+    std::uint16_t *wires, std::size_t wireStride,
+    std::uint32_t *values,
+    std::uint8_t *target, std::size_t count
+  ) {
+    std::size_t index = 0;
+
+#if defined(NUCLEX_FRAMEFIXER_HAVE_AVX2)
+    if(Nuclex::FrameFixer::Platform::CpuFeatures::HasAvx2()) {
+      index = selectRowAvx2(
+        rows, rowCount, sixteenBitChannels, selection, wires, wireStride, target, count
+      );
+    }
+#endif
+
+    // SSE2 only has signed 16 bit minimum and maximum, so the values are biased
+    // by 32768 while they're being sorted to make unsigned comparisons signed ones
+#if defined(NUCLEX_FRAMEFIXER_HAVE_SSE2)
+    {
+      const __m128i zero = _mm_setzero_si128();
+      const __m128i bias16 = _mm_set1_epi16(static_cast<short>(0x8000));
+      const __m128i bias32 = _mm_set1_epi32(0x8000);
+      const __m128 factor = _mm_set1_ps(selection.Reciprocal);
+      std::size_t comparatorCount = selection.Comparators.size();
+
+      for(; index + 8 <= count; index += 8) {
+        for(std::size_t rowIndex = 0; rowIndex < rowCount; ++rowIndex) {
+          __m128i values;
+          if(sixteenBitChannels) {
+            values = _mm_loadu_si128(reinterpret_cast<const __m128i *>(rows[rowIndex]) + index / 8);
+          } else {
+            values = _mm_unpacklo_epi8(
+              _mm_loadl_epi64(reinterpret_cast<const __m128i *>(rows[rowIndex] + index)), zero
+            );
+          }
+          _mm_store_si128(
+            reinterpret_cast<__m128i *>(wires + rowIndex * wireStride),
+            _mm_xor_si128(values, bias16)
+          );
+        }
+
+        for(std::size_t comparatorIndex = 0; comparatorIndex < comparatorCount; ++comparatorIndex) {
+          const Comparator &comparator = selection.Comparators[comparatorIndex];
+          __m128i *lower = reinterpret_cast<__m128i *>(wires + comparator.first * wireStride);
+          __m128i *upper = reinterpret_cast<__m128i *>(wires + comparator.second * wireStride);
+          __m128i lowerValues = _mm_load_si128(lower);
+          __m128i upperValues = _mm_load_si128(upper);
+          _mm_store_si128(lower, _mm_min_epi16(lowerValues, upperValues));
+          _mm_store_si128(upper, _mm_max_epi16(lowerValues, upperValues));
+        }
+
+        __m128i lowSum = zero, highSum = zero;
+        for(std::size_t wire = selection.FirstIndex; wire < selection.EndIndex; ++wire) {
+          __m128i values = _mm_xor_si128(
+            _mm_load_si128(reinterpret_cast<const __m128i *>(wires + wire * wireStride)), bias16
+          );
+          lowSum = _mm_add_epi32(lowSum, _mm_unpacklo_epi16(values, zero));
+          highSum = _mm_add_epi32(highSum, _mm_unpackhi_epi16(values, zero));
+        }
+        __m128i low = _mm_cvtps_epi32(_mm_mul_ps(_mm_cvtepi32_ps(lowSum), factor));
+        __m128i high = _mm_cvtps_epi32(_mm_mul_ps(_mm_cvtepi32_ps(highSum), factor));
+        __m128i result = _mm_xor_si128(
+          _mm_packs_epi32(_mm_sub_epi32(low, bias32), _mm_sub_epi32(high, bias32)), bias16
+        );
+
+        if(sixteenBitChannels) {
+          _mm_storeu_si128(reinterpret_cast<__m128i *>(target) + index / 8, result);
+        } else {
+          _mm_storel_epi64(
+            reinterpret_cast<__m128i *>(target + index), _mm_packus_epi16(result, result)
+          );
+        }
+      }
+    }
+#else
+    (void)wires;
+    (void)wireStride;
+#endif
+
+    // Without SIMD, std::nth_element() can select the values with fewer comparisons
+    for(; index < count; ++index) {
+      for(std::size_t rowIndex = 0; rowIndex < rowCount; ++rowIndex) {
+        if(sixteenBitChannels) {
+          values[rowIndex] = reinterpret_cast<const std::uint16_t *>(rows[rowIndex])[index];
+        } else {
+          values[rowIndex] = rows[rowIndex][index];
+        }
+      }
+
+      if(selection.FirstIndex > 0) {
+        std::nth_element(values, values + selection.FirstIndex, values + rowCount);
+      }
+      if(selection.EndIndex < rowCount) {
+        std::nth_element(
+          values + selection.FirstIndex, values + selection.EndIndex, values + rowCount
+        );
+      }
+
+      std::uint32_t sum = 0;
+      for(std::size_t wire = selection.FirstIndex; wire < selection.EndIndex; ++wire) {
+        sum += values[wire];
+      }
+      long result = std::lrint(static_cast<float>(sum) * selection.Reciprocal);
+      if(sixteenBitChannels) {
+        reinterpret_cast<std::uint16_t *>(target)[index] = static_cast<std::uint16_t>(result);
+      } else {
+        target[index] = static_cast<std::uint8_t>(result);
+      }
+    }
+  }
+
   // ------------------------------------------------------------------------------------------- //
 
 } // anonymous namespace
@@ -35,13 +430,58 @@ namespace Nuclex::FrameFixer {
   // ------------------------------------------------------------------------------------------- //
 
   void Averager::Average(QImage &image, const QImage &otherImage) {
-    std::size_t lineCount = static_cast<std::size_t>(image.height());
-    for(std::size_t lineIndex = 0; lineIndex < lineCount; ++lineIndex) {
-      if(image.bytesPerLine() >= image.width() * 8) {
-        QRgba64 *pixels = reinterpret_cast<QRgba64 *>(image.scanLine(lineIndex));
-        const QRgba64 *otherPixels = reinterpret_cast<const QRgba64 *>(otherImage.scanLine(lineIndex));
+    Rendering::FrameBuffer imageBuffer = Rendering::FrameBuffer::Wrap(image);
+    Average(imageBuffer, Rendering::FrameBuffer::WrapReadOnly(otherImage));
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  void Averager::Average(
+    QImage &image, const std::vector<QImage> &otherImages, std::size_t imageWeight /* = 1 */
+  ) {
+    std::vector<Rendering::FrameBuffer> otherBuffers;
+    otherBuffers.reserve(otherImages.size());
+    for(std::size_t index = 0; index < otherImages.size(); ++index) {
+      otherBuffers.push_back(Rendering::FrameBuffer::WrapReadOnly(otherImages[index]));
+    }
+
+    Rendering::FrameBuffer imageBuffer = Rendering::FrameBuffer::Wrap(image);
+    Average(imageBuffer, otherBuffers, imageWeight);
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  void Averager::Average(
+    QImage &image,
+    const std::vector<QImage> &otherImages,
+    AverageMode mode,
+    std::size_t threadCount /* = 1 */
+  ) {
+    std::vector<Rendering::FrameBuffer> otherBuffers;
+    otherBuffers.reserve(otherImages.size());
+    for(std::size_t index = 0; index < otherImages.size(); ++index) {
+      otherBuffers.push_back(Rendering::FrameBuffer::WrapReadOnly(otherImages[index]));
+    }
+
+    Rendering::FrameBuffer imageBuffer = Rendering::FrameBuffer::Wrap(image);
+    Average(imageBuffer, otherBuffers, mode, threadCount);
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  void Averager::Average(
+    Rendering::FrameBuffer &image, const Rendering::FrameBuffer &otherImage
+  ) {
+    std::size_t lineCount = static_cast<std::size_t>(image.GetHeight());
+    std::size_t imageWidth = static_cast<std::size_t>(image.GetWidth());
+
+    if(image.HasSixteenBitChannels()) {
+      for(std::size_t lineIndex = 0; lineIndex < lineCount; ++lineIndex) {
+        QRgba64 *pixels = reinterpret_cast<QRgba64 *>(image.GetRow(lineIndex));
+        const QRgba64 *otherPixels = reinterpret_cast<const QRgba64 *>(
+          otherImage.GetRow(lineIndex)
+        );
 
-        std::size_t imageWidth = static_cast<std::size_t>(image.width());
         for(std::size_t x = 0; x < imageWidth; ++x) {
           quint32 red = qRed(pixels[x]) + qRed(otherPixels[x]);
           quint32 green = qGreen(pixels[x]) + qGreen(otherPixels[x]);
@@ -53,16 +493,17 @@ namespace Nuclex::FrameFixer {
           blue /= 2;
           alpha /= 2;
 
-          pixels[x] = QRgba64::fromRgba(
+          pixels[x] = QRgba64::fromRgba64(
             static_cast<quint16>(red), static_cast<quint16>(green),
             static_cast<quint16>(blue), static_cast<quint16>(alpha)
           );
         }
-      } else {
-        QRgb *pixels = reinterpret_cast<QRgb *>(image.scanLine(lineIndex));
-        const QRgb *otherPixels = reinterpret_cast<const QRgb *>(otherImage.scanLine(lineIndex));
+      }
+    } else { // 16 bits per color channel / 8 bits per color channel
+      for(std::size_t lineIndex = 0; lineIndex < lineCount; ++lineIndex) {
+        QRgb *pixels = reinterpret_cast<QRgb *>(image.GetRow(lineIndex));
+        const QRgb *otherPixels = reinterpret_cast<const QRgb *>(otherImage.GetRow(lineIndex));
 
-        std::size_t imageWidth = static_cast<std::size_t>(image.width());
         for(std::size_t x = 0; x < imageWidth; ++x) {
           quint16 red = qRed(pixels[x]) + qRed(otherPixels[x]);
           quint16 green = qGreen(pixels[x]) + qGreen(otherPixels[x]);
@@ -77,130 +518,104 @@ namespace Nuclex::FrameFixer {
           );
         }
       }
-    }
+    } // if 8 bits per color channel
   }
 
   // ------------------------------------------------------------------------------------------- //
 
-  void Averager::Average(QImage &image, const std::vector<QImage> &otherImages) {
-    if(image.bytesPerLine() >= image.width() * 8) {
-      std::vector<quint32> scanline(image.width() * 4);
-    
-      std::size_t lineCount = static_cast<std::size_t>(image.height());
-      for(std::size_t lineIndex = 0; lineIndex < lineCount; ++lineIndex) {
-
-        // Fetch the original image's scanline
-        {
-          QRgba64 *pixels = reinterpret_cast<QRgba64 *>(image.scanLine(lineIndex));
-          int componentIndex = 0;
-
-          std::size_t imageWidth = static_cast<std::size_t>(image.width());
-          for(std::size_t x = 0; x < imageWidth; ++x) {
-            scanline[componentIndex++] = pixels[x].red();
-            scanline[componentIndex++] = pixels[x].green();
-            scanline[componentIndex++] = pixels[x].blue();
-            scanline[componentIndex++] = pixels[x].alpha();
-          }
-        }
-
-        std::size_t otherImageCount = otherImages.size();
-        for(std::size_t imageIndex = 0; imageIndex < otherImageCount; ++imageIndex) {
-          const QRgba64 *otherPixels = reinterpret_cast<const QRgba64 *>(
-            otherImages[imageIndex].scanLine(lineIndex)
-          );
-
-          int componentIndex = 0;
+  void Averager::Average(
+    Rendering::FrameBuffer &image,
+    const std::vector<Rendering::FrameBuffer> &otherImages,
+    std::size_t imageWeight /* = 1 */
+  ) {
+    AverageAccumulator accumulator;
+    accumulator.Add(image, imageWeight);
+    for(std::size_t index = 0; index < otherImages.size(); ++index) {
+      accumulator.Add(otherImages[index]);
+    }
+    accumulator.Resolve(image);
+  }
 
-          std::size_t imageWidth = static_cast<std::size_t>(image.width());
-          for(std::size_t x = 0; x < imageWidth; ++x) {
-            scanline[componentIndex++] += otherPixels[x].red();
-            scanline[componentIndex++] += otherPixels[x].green();
-            scanline[componentIndex++] += otherPixels[x].blue();
-            scanline[componentIndex++] += otherPixels[x].alpha();
-          }
-        }
+  // ------------------------------------------------------------------------------------------- //
 
-        // Because *this* image is also an image that was summed in the total
-        ++otherImageCount;
-        {
-          QRgba64 *pixels = reinterpret_cast<QRgba64 *>(image.scanLine(lineIndex));
-          int componentIndex = 0;
-
-          std::size_t imageWidth = static_cast<std::size_t>(image.width());
-          for(std::size_t x = 0; x < imageWidth; ++x) {
-            quint32 red = scanline[componentIndex++];
-            quint32 green = scanline[componentIndex++];
-            quint32 blue = scanline[componentIndex++];
-            quint32 alpha = scanline[componentIndex++];
-
-            pixels[x] = QRgba64::fromRgba64(
-              static_cast<quint16>(red / otherImageCount),
-              static_cast<quint16>(green / otherImageCount),
-              static_cast<quint16>(blue / otherImageCount),
-              static_cast<quint16>(alpha / otherImageCount)
-            );
-          }
-        }
+  void Averager::Average(
+    Rendering::FrameBuffer &image,
+    const std::vector<Rendering::FrameBuffer> &otherImages,
+    AverageMode mode,
+    std::size_t threadCount /* = 1 */
+  ) {
+    if(mode == AverageMode::Mean) {
+      AverageAccumulator accumulator;
+      accumulator.SetThreadCount(threadCount);
+      accumulator.Add(image);
+      for(std::size_t index = 0; index < otherImages.size(); ++index) {
+        accumulator.Add(otherImages[index]);
       }
-    } else {
-      std::size_t imageWidth = static_cast<std::size_t>(image.width());
-      std::vector<quint16> scanline(imageWidth * 4);
-    
-      std::size_t lineCount = static_cast<std::size_t>(image.height());
-      for(std::size_t lineIndex = 0; lineIndex < lineCount; ++lineIndex) {
-
-        // Fetch the original image's scanline
-        {
-          QRgb *pixels = reinterpret_cast<QRgb *>(image.scanLine(lineIndex));
-          int componentIndex = 0;
-
-          std::size_t imageWidth = static_cast<std::size_t>(image.width());
-          for(std::size_t x = 0; x < imageWidth; ++x) {
-            scanline[componentIndex++] = qRed(pixels[x]);
-            scanline[componentIndex++] = qGreen(pixels[x]);
-            scanline[componentIndex++] = qBlue(pixels[x]);
-            scanline[componentIndex++] = qAlpha(pixels[x]);
-          }
-        }
-
-        std::size_t otherImageCount = otherImages.size();
-        for(std::size_t imageIndex = 0; imageIndex < otherImageCount; ++imageIndex) {
-          const QRgb *otherPixels = reinterpret_cast<const QRgb *>(
-            otherImages[imageIndex].scanLine(lineIndex)
-          );
+      accumulator.Resolve(image);
+      return;
+    }
 
-          int componentIndex = 0;
+    std::size_t frameCount = otherImages.size() + 1;
+    if(frameCount > AverageAccumulator::MaximumFrameCount) {
+      throw std::runtime_error(u8"Too many frames to average, sums would overflow");
+    }
 
-          std::size_t imageWidth = static_cast<std::size_t>(image.width());
-          for(std::size_t x = 0; x < imageWidth; ++x) {
-            scanline[componentIndex++] += qRed(otherPixels[x]);
-            scanline[componentIndex++] += qGreen(otherPixels[x]);
-            scanline[componentIndex++] += qBlue(otherPixels[x]);
-            scanline[componentIndex++] += qAlpha(otherPixels[x]);
-          }
-        }
+    std::vector<const Rendering::FrameBuffer *> frames;
+    frames.reserve(frameCount);
+    frames.push_back(&image);
+    for(std::size_t index = 0; index < otherImages.size(); ++index) {
+      const Rendering::FrameBuffer &otherImage = otherImages[index];
+      bool isMatching = (
+        (otherImage.GetWidth() == image.GetWidth()) &&
+        (otherImage.GetHeight() == image.GetHeight()) &&
+        (otherImage.HasSixteenBitChannels() == image.HasSixteenBitChannels()) &&
+        (otherImage.GetLayout() == image.GetLayout())
+      );
+      if(!isMatching) {
+        throw std::invalid_argument(
+          u8"All frames must have the same size, channel size and layout"
+        );
+      }
+      frames.push_back(&otherImage);
+    }
 
-        {
-          QRgb *pixels = reinterpret_cast<QRgb *>(image.scanLine(lineIndex));
-          int componentIndex = 0;
-
-          std::size_t imageWidth = static_cast<std::size_t>(image.width());
-          for(std::size_t x = 0; x < imageWidth; ++x) {
-            quint16 red = scanline[componentIndex++];
-            quint16 green = scanline[componentIndex++];
-            quint16 blue = scanline[componentIndex++];
-            quint16 alpha = scanline[componentIndex++];
-
-            pixels[x] = QRgba64::fromRgba(
-              static_cast<quint8>(red / otherImageCount),
-              static_cast<quint8>(green / otherImageCount),
-              static_cast<quint8>(blue / otherImageCount),
-              static_cast<quint8>(alpha / otherImageCount)
+    Selection selection = createSelection(frameCount, mode);
+
+    // Interleaved frames are processed as one plane with four values per pixel
+    bool isPlanar = (image.GetLayout() == Rendering::FrameLayout::Planar);
+    bool sixteenBitChannels = image.HasSixteenBitChannels();
+    std::size_t width = static_cast<std::size_t>(image.GetWidth());
+    std::size_t columnCount = isPlanar ? width : (width * 4);
+    std::size_t planeCount = isPlanar ? 4 : 1;
+
+    // Scratch space for each band is allocated up front, so the threads can't fail.
+    // Each wire holds one AVX2 vector, a 64 byte row is a bit more than needed.
+    std::size_t bandCount = std::max<std::size_t>(threadCount, 1);
+    Algorithm::Matrix2D<std::uint16_t> wires(16, frameCount, bandCount);
+    std::vector<std::uint32_t> values(frameCount * bandCount);
+    std::vector<const std::uint8_t *> rows(frameCount * bandCount);
+    std::atomic<std::size_t> nextBandIndex(0);
+
+    Algorithm::ParallelBands::Process(
+      static_cast<std::size_t>(image.GetHeight()), width, bandCount,
+      [&](std::size_t startLineIndex, std::size_t endLineIndex) {
+        std::size_t bandIndex = nextBandIndex.fetch_add(1);
+        const std::uint8_t **bandRows = rows.data() + bandIndex * frameCount;
+        for(std::size_t planeIndex = 0; planeIndex < planeCount; ++planeIndex) {
+          for(std::size_t lineIndex = startLineIndex; lineIndex < endLineIndex; ++lineIndex) {
+            for(std::size_t frameIndex = 0; frameIndex < frameCount; ++frameIndex) {
+              bandRows[frameIndex] = frames[frameIndex]->GetRow(lineIndex, planeIndex);
+            }
+            selectRow(
+              bandRows, frameCount, sixteenBitChannels, selection,
+              wires.GetRow(0, bandIndex), wires.GetStride(),
+              values.data() + bandIndex * frameCount,
+              image.GetRow(lineIndex, planeIndex), columnCount
             );
           }
         }
       }
-    }
+    );
   }
 
   // ------------------------------------------------------------------------------------------- //
@@ -21,10 +21,22 @@ limitations under the License.
 #define NUCLEX_FRAMEFIXER_AVERAGER_H
 
 #include "Nuclex/FrameFixer/Config.h"
+#include "./AverageMode.h"
 
+#include <cstddef> // for std::size_t
 #include <vector> // for std::vector
 #include <QImage>
 
+namespace Nuclex::FrameFixer::Rendering {
+
+  // ------------------------------------------------------------------------------------------- //
+
+  class FrameBuffer;
+
+  // ------------------------------------------------------------------------------------------- //
+
+} // namespace Nuclex::FrameFixer::Rendering
+
 namespace Nuclex::FrameFixer {
 
   // ------------------------------------------------------------------------------------------- //
@@ -40,7 +52,67 @@ namespace Nuclex::FrameFixer {
     /// <summary>Composites multiple images onto an image</summary>
     /// <param name="image">Image onto which the other images will be composited</param>
     /// <param name="otherImages">Images that will be composited onto the first image</param>
-    public: static void Average(QImage &image, const std::vector<QImage> &otherImages);
+    /// <param name="imageWeight">
+    ///   Number of images the first image stands for. If the first image already is
+    ///   the average of several images, this allows more images to be blended in
+    ///   without holding all of them in memory at once.
+    /// </param>
+    /// <remarks>
+    ///   To average frames as they arrive without collecting them first, use
+    ///   the <see cref="AverageAccumulator" /> directly.
+    /// </remarks>
+    public: static void Average(
+      QImage &image, const std::vector<QImage> &otherImages, std::size_t imageWeight = 1
+    );
+
+    /// <summary>Combines an image with other images in the specified mode</summary>
+    /// <param name="image">
+    ///   First of the images that will be combined, receives the result
+    /// </param>
+    /// <param name="otherImages">Images that will be combined with the first image</param>
+    /// <param name="mode">Whether to use the mean, median or trimmed mean</param>
+    /// <param name="threadCount">Number of threads that may work on bands of the images</param>
+    /// <remarks>
+    ///   Unlike the mean, the median and trimmed mean need all images at once,
+    ///   so these can't be blended in one at a time.
+    /// </remarks>
+    public: static void Average(
+      QImage &image,
+      const std::vector<QImage> &otherImages,
+      AverageMode mode,
+      std::size_t threadCount = 1
+    );
+
+    /// <summary>Composites another frame onto a frame at 50% opacity</summary>
+    /// <param name="image">Frame onto which the second frame will be composited</param>
+    /// <param name="otherImage">Frame that will be composited onto the first frame</param>
+    public: static void Average(
+      Rendering::FrameBuffer &image, const Rendering::FrameBuffer &otherImage
+    );
+
+    /// <summary>Composites multiple frames onto a frame</summary>
+    /// <param name="image">Frame onto which the other frames will be composited</param>
+    /// <param name="otherImages">Frames that will be composited onto the first frame</param>
+    /// <param name="imageWeight">Number of frames the first frame stands for</param>
+    public: static void Average(
+      Rendering::FrameBuffer &image,
+      const std::vector<Rendering::FrameBuffer> &otherImages,
+      std::size_t imageWeight = 1
+    );
+
+    /// <summary>Combines a frame with other frames in the specified mode</summary>
+    /// <param name="image">
+    ///   First of the frames that will be combined, receives the result
+    /// </param>
+    /// <param name="otherImages">Frames that will be combined with the first frame</param>
+    /// <param name="mode">Whether to use the mean, median or trimmed mean</param>
+    /// <param name="threadCount">Number of threads that may work on bands of the frames</param>
+    public: static void Average(
+      Rendering::FrameBuffer &image,
+      const std::vector<Rendering::FrameBuffer> &otherImages,
+      AverageMode mode,
+      std::size_t threadCount = 1
+    );
 
   };
 
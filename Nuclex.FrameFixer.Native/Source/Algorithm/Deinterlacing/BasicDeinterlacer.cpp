@@ -21,7 +21,9 @@ limitations under the License.
 #define NUCLEX_FRAMEFIXER_SOURCE 1
 
 #include "./BasicDeinterlacer.h"
+#include "../../Rendering/FrameBuffer.h"
 
+#include <algorithm> // for std::copy_n()
 #include <vector> // for std::vector
 
 namespace {
@@ -43,43 +45,57 @@ namespace Nuclex::FrameFixer::Algorithm::Deinterlacing {
   // ------------------------------------------------------------------------------------------- //
 
   void BasicDeinterlacer::Deinterlace(QImage &target, DeinterlaceMode mode) {
-    if(mode == DeinterlaceMode::TopFieldFirst)  {
-      if(this->priorFrame.isNull()) {
-        Deinterlace(nullptr, target, true);
-      } else {
-        Deinterlace(&this->priorFrame, target, true);
-      }
-    } else if(mode == DeinterlaceMode::BottomFieldFirst) {
+    if(mode == DeinterlaceMode::Dont) {
+      return;
+    }
+
+    Rendering::FrameBuffer targetBuffer = Rendering::FrameBuffer::Wrap(target);
+    if((mode == DeinterlaceMode::TopFieldFirst) || (mode == DeinterlaceMode::BottomFieldFirst)) {
+      bool topField = (mode == DeinterlaceMode::TopFieldFirst);
       if(this->priorFrame.isNull()) {
-        Deinterlace(nullptr, target, false);
+        Deinterlace(nullptr, targetBuffer, topField);
       } else {
-        Deinterlace(&this->priorFrame, target, false);
+
+        // The prior frame is only read, so it is wrapped without detaching it from
+        // the images it shares its pixels with (which would copy the whole frame)
+        Rendering::FrameBuffer priorBuffer = Rendering::FrameBuffer::WrapReadOnly(
+          this->priorFrame
+        );
+        Deinterlace(&priorBuffer, targetBuffer, topField);
       }
     } else if(mode == DeinterlaceMode::TopFieldOnly) {
-      Deinterlace(nullptr, target, true);
+      Deinterlace(nullptr, targetBuffer, true);
     } else if(mode == DeinterlaceMode::BottomFieldOnly) {
-      Deinterlace(nullptr, target, false);
+      Deinterlace(nullptr, targetBuffer, false);
     }
   }
 
   // ------------------------------------------------------------------------------------------- //
 
   void BasicDeinterlacer::Deinterlace(
-    QImage *previousImage, QImage &image, bool topField /* = true */
+    const Rendering::FrameBuffer *previousImage,
+    Rendering::FrameBuffer &image,
+    bool topField /* = true */
   ) {
-    std::size_t lineCount = static_cast<std::size_t>(image.height());
+    std::size_t lineCount = static_cast<std::size_t>(image.GetHeight());
+    std::size_t imageWidth = static_cast<std::size_t>(image.GetWidth());
 
     // Without a prior frame, interpolate the missing lines
     if(previousImage == nullptr) {
+      bool isSixteenBit = image.HasSixteenBitChannels();
+
       std::size_t lineIndex = topField ? 1 : 2;
       while(lineIndex < lineCount - 1) {
 
-        if(image.bytesPerLine() >= image.width() * 8) {
-          QRgba64 *pixelsAbove = reinterpret_cast<QRgba64 *>(image.scanLine(lineIndex - 1));
-          QRgba64 *pixels = reinterpret_cast<QRgba64 *>(image.scanLine(lineIndex));
-          QRgba64 *pixelsBelow = reinterpret_cast<QRgba64 *>(image.scanLine(lineIndex + 1));
+        if(isSixteenBit) {
+          const QRgba64 *pixelsAbove = reinterpret_cast<const QRgba64 *>(
+            image.GetRow(lineIndex - 1)
+          );
+          QRgba64 *pixels = reinterpret_cast<QRgba64 *>(image.GetRow(lineIndex));
+          const QRgba64 *pixelsBelow = reinterpret_cast<const QRgba64 *>(
+            image.GetRow(lineIndex + 1)
+          );
 
-          std::size_t imageWidth = static_cast<std::size_t>(image.width());
           for(std::size_t x = 0; x < imageWidth; ++x) {
             quint32 red = qRed(pixelsAbove[x]) + qRed(pixelsBelow[x]);
             quint32 green = qGreen(pixelsAbove[x]) + qGreen(pixelsBelow[x]);
@@ -91,17 +107,16 @@ namespace Nuclex::FrameFixer::Algorithm::Deinterlacing {
             blue /= 2;
             alpha /= 2;
 
-            pixels[x] = QRgba64::fromRgba(
+            pixels[x] = QRgba64::fromRgba64(
               static_cast<quint16>(red), static_cast<quint16>(green),
               static_cast<quint16>(blue), static_cast<quint16>(alpha)
             );
           }
         } else { // 16 bits per color channel / 8 bits per color channel 
-          QRgb *pixelsAbove = reinterpret_cast<QRgb *>(image.scanLine(lineIndex - 1));
-          QRgb *pixels = reinterpret_cast<QRgb *>(image.scanLine(lineIndex));
-          QRgb *pixelsBelow = reinterpret_cast<QRgb *>(image.scanLine(lineIndex + 1));
+          const QRgb *pixelsAbove = reinterpret_cast<const QRgb *>(image.GetRow(lineIndex - 1));
+          QRgb *pixels = reinterpret_cast<QRgb *>(image.GetRow(lineIndex));
+          const QRgb *pixelsBelow = reinterpret_cast<const QRgb *>(image.GetRow(lineIndex + 1));
 
-          std::size_t imageWidth = static_cast<std::size_t>(image.width());
           for(std::size_t x = 0; x < imageWidth; ++x) {
             quint16 red = qRed(pixelsAbove[x]) + qRed(pixelsBelow[x]);
             quint16 green = qGreen(pixelsAbove[x]) + qGreen(pixelsBelow[x]);
@@ -122,11 +137,15 @@ namespace Nuclex::FrameFixer::Algorithm::Deinterlacing {
 
     } else { // with a prior frame / without prior frame
 
+      // Both frames have the same pixel format, but their strides may differ
+      // if one is a pooled frame buffer and the other one a QImage
+      std::size_t rowLength = image.GetRowLength();
+
       std::size_t lineIndex = topField ? 1 : 0;
       while(lineIndex < lineCount - 1) {
-        std::uint8_t *previousImageLine = previousImage->scanLine(lineIndex);
-        std::uint8_t *currentImageLine = image.scanLine(lineIndex);
-        std::copy_n(previousImageLine, image.bytesPerLine(), currentImageLine);
+        const std::uint8_t *previousImageLine = previousImage->GetRow(lineIndex);
+        std::uint8_t *currentImageLine = image.GetRow(lineIndex);
+        std::copy_n(previousImageLine, rowLength, currentImageLine);
 
         lineIndex += 2;
       } // while
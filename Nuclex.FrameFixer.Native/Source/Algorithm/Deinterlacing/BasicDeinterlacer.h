@@ -23,6 +23,16 @@ limitations under the License.
 #include "Nuclex/FrameFixer/Config.h"
 #include "./Deinterlacer.h"
 
+namespace Nuclex::FrameFixer::Rendering {
+
+  // ------------------------------------------------------------------------------------------- //
+
+  class FrameBuffer;
+
+  // ------------------------------------------------------------------------------------------- //
+
+} // namespace Nuclex::FrameFixer::Rendering
+
 namespace Nuclex::FrameFixer::Algorithm::Deinterlacing {
 
   // ------------------------------------------------------------------------------------------- //
@@ -41,6 +51,12 @@ namespace Nuclex::FrameFixer::Algorithm::Deinterlacing {
       return u8"Basic: copy or interpolate missing fields";
     }
 
+    /// <summary>Creates another instance of the deinterlacer with the same settings</summary>
+    /// <returns>A new, independent deinterlacer instance</returns>
+    public: std::shared_ptr<Deinterlacer> Clone() const override {
+      return std::make_shared<BasicDeinterlacer>();
+    }
+
     /// <summary>Whether this deinterlacer needs to know the previous frame</summary>
     /// <returns>True if the deinterlacer needs the previous frame to work with</returns>
     public: bool NeedsPriorFrame() const override { return true; }
@@ -73,7 +89,9 @@ namespace Nuclex::FrameFixer::Algorithm::Deinterlacing {
     ///   otherwise, the bottom field (odd rows) will be filled in
     /// </param>
     public: static void Deinterlace(
-      QImage *previousImage, QImage &image, bool topField = true
+      const Rendering::FrameBuffer *previousImage,
+      Rendering::FrameBuffer &image,
+      bool topField = true
     );
 
     /// <summary>The frame preceding the current one</summary>
@@ -25,6 +25,9 @@ limitations under the License.
 
 #include <QImage>
 
+#include <memory> // for std::shared_ptr
+#include <string> // for std::string
+
 namespace Nuclex::FrameFixer::Algorithm::Deinterlacing {
 
   // ------------------------------------------------------------------------------------------- //
@@ -39,6 +42,20 @@ namespace Nuclex::FrameFixer::Algorithm::Deinterlacing {
     /// <returns>A short, human-readable name for the deinterlacer</returns>
     public: virtual std::string GetName() const = 0;
 
+    /// <summary>Creates another instance of the deinterlacer with the same settings</summary>
+    /// <returns>
+    ///   A new, independent deinterlacer instance or an empty pointer if the deinterlacer
+    ///   does not support being instantiated more than once
+    /// </returns>
+    /// <remarks>
+    ///   The renderer uses this to deinterlace several segments of a movie in parallel,
+    ///   each with its own deinterlacer instance. Only the settings are carried over,
+    ///   the new instance does not know the prior or next frame of this one.
+    /// </remarks>
+    public: virtual std::shared_ptr<Deinterlacer> Clone() const {
+      return std::shared_ptr<Deinterlacer>();
+    }
+
     /// <summary>Called before the deinterlacer is used by the application</summary>
     /// <remarks>
     ///   This call should be optional. It gives the deinterlacer a chance to initialize
@@ -21,6 +21,10 @@ limitations under the License.
 #define NUCLEX_FRAMEFIXER_SOURCE 1
 
 #include "./LibAvDeinterlacer.h"
+#include "../../Rendering/PixelConversion.h"
+
+#include <algorithm> // for std::copy_n(), std::min()
+#include <cstdint> // for std::uint8_t, std::uintptr_t
 
 namespace {
 
@@ -50,6 +54,89 @@ namespace {
 
   // ------------------------------------------------------------------------------------------- //
 
+  /// <summary>Number of bytes libav aligns the rows of the frames it allocates to</summary>
+  /// <remarks>
+  ///   Images are only wrapped in AV frames if their rows meet this alignment because
+  ///   the SIMD code in libav's filters may rely on it. The frame buffer pool hands out
+  ///   images with rows aligned to 64 bytes, so frames rendered from it always qualify.
+  /// </remarks>
+  const std::size_t LibAvRowAlignment = 64;
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Checks whether an image can be wrapped in an AV frame without copying</summary>
+  /// <param name="image">Image that will be checked</param>
+  /// <returns>True if libav can directly work with the image's pixels</returns>
+  bool canWrapImage(const QImage &image) {
+    std::uintptr_t address = reinterpret_cast<std::uintptr_t>(image.constBits());
+    std::size_t bytesPerLine = static_cast<std::size_t>(image.bytesPerLine());
+    return (
+      (address != 0) &&
+      ((address % LibAvRowAlignment) == 0) &&
+      ((bytesPerLine % LibAvRowAlignment) == 0)
+    );
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Releases the image whose pixels were wrapped by an AV buffer</summary>
+  /// <param name="opaque">Heap-allocated QImage that kept the pixels alive</param>
+  /// <param name="data">Pixels of the wrapped image</param>
+  void releaseWrappedImage(void *opaque, std::uint8_t *data) {
+    (void)data;
+    delete reinterpret_cast<QImage *>(opaque);
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Copies rows of pixels between two buffers with different strides</summary>
+  /// <param name="source">First row of pixels that will be copied</param>
+  /// <param name="sourceStride">Distance from one source row to the next in bytes</param>
+  /// <param name="target">First row the pixels will be copied into</param>
+  /// <param name="targetStride">Distance from one target row to the next in bytes</param>
+  /// <param name="rowCount">Number of rows that will be copied</param>
+  /// <remarks>
+  ///   Only the bytes both strides have in common are copied, so neither buffer is
+  ///   overrun if one of them carries more padding. If the strides match, all rows
+  ///   are copied in one go.
+  /// </remarks>
+  void copyRows(
+    const std::uint8_t *source, std::size_t sourceStride,
+    std::uint8_t *target, std::size_t targetStride,
+    std::size_t rowCount
+  ) {
+    if(sourceStride == targetStride) {
+      std::copy_n(source, sourceStride * rowCount, target);
+      return;
+    }
+
+    std::size_t rowLength = std::min(sourceStride, targetStride);
+    for(std::size_t rowIndex = 0; rowIndex < rowCount; ++rowIndex) {
+      std::copy_n(source, rowLength, target);
+      source += sourceStride;
+      target += targetStride;
+    }
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Looks up a row of pixels in one plane of an AV frame</summary>
+  /// <typeparam name="TChannel">Type of the channel values stored in the plane</typeparam>
+  /// <param name="frame">Frame containing the plane</param>
+  /// <param name="planeIndex">Index of the plane the row will be looked up in</param>
+  /// <param name="lineIndex">Index of the row that will be looked up</param>
+  /// <returns>The address of the first channel value in the requested row</returns>
+  template<typename TChannel>
+  const TChannel *getPlaneRow(
+    const std::shared_ptr<::AVFrame> &frame, std::size_t planeIndex, std::size_t lineIndex
+  ) {
+    return reinterpret_cast<const TChannel *>(
+      frame->data[planeIndex] + lineIndex * static_cast<std::size_t>(frame->linesize[planeIndex])
+    );
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
 } // anonymous namespace
 
 namespace Nuclex::FrameFixer::Algorithm::Deinterlacing {
@@ -63,42 +150,47 @@ namespace Nuclex::FrameFixer::Algorithm::Deinterlacing {
 
     frame->width = image.width();
     frame->height = image.height();
-    
+
     // TODO: Cheap and insufficient decision between 16 bits per color channel
     //       and 8 bits per color channel. I only have the former kind of images
     //       currently, but this should compare the actual pixel formats!
     if(image.bytesPerLine() >= image.width() * 8) {
       frame->format = AV_PIX_FMT_RGBA64LE; // AV_PIX_FMT_BGR48LE
-
-      LibAvApi::LockAvFrameBuffer(frame);
-
-      std::uint8_t *frameData = frame->data[0];
-      std::size_t frameHeight = static_cast<std::size_t>(frame->height);
-      for(std::size_t lineIndex = 0; lineIndex < frameHeight; ++lineIndex) {
-        std::copy_n(
-          image.scanLine(lineIndex), // Will be QRgba64 (64 bit interleaved) pixels
-          image.bytesPerLine(),
-          frameData
-        );
-        frameData += frame->linesize[0];
-      }
     } else {
       frame->format = AV_PIX_FMT_RGBA; // AV_PIX_FMT_ABGR;
+    }
 
-      LibAvApi::LockAvFrameBuffer(frame);
-
-      std::uint8_t *frameData = frame->data[0];
-      std::size_t frameHeight = static_cast<std::size_t>(frame->height);
-      for(std::size_t lineIndex = 0; lineIndex < frameHeight; ++lineIndex) {
-        std::copy_n(
-          image.scanLine(lineIndex), // Will be QRgb (32 bit interleaved) pixels
-          image.bytesPerLine(),
-          frameData
-        );
-        frameData += frame->linesize[0];
+    // If the image's rows are aligned the way libav's own frames would be, let the AV
+    // frame reference the image's pixels. The AV buffer holds a (shallow) copy of
+    // the QImage, keeping the pixels alive until libav is done with the frame.
+    if(canWrapImage(image)) {
+      QImage *imageReference = new QImage(image);
+      ::AVBufferRef *buffer = ::av_buffer_create(
+        const_cast<std::uint8_t *>(image.constBits()),
+        static_cast<std::size_t>(image.sizeInBytes()),
+        &releaseWrappedImage,
+        imageReference,
+        AV_BUFFER_FLAG_READONLY // Filters must not write into the shared pixels
+      );
+      if(buffer == nullptr) {
+        delete imageReference;
+        throw std::runtime_error(u8"Could not create AV buffer wrapping the image's pixels");
       }
+
+      frame->buf[0] = buffer;
+      frame->data[0] = buffer->data;
+      frame->linesize[0] = image.bytesPerLine();
+
+      return frame;
     }
 
+    LibAvApi::LockAvFrameBuffer(frame);
+    copyRows(
+      image.constBits(), static_cast<std::size_t>(image.bytesPerLine()),
+      frame->data[0], static_cast<std::size_t>(frame->linesize[0]),
+      static_cast<std::size_t>(frame->height)
+    );
+
     return frame;
   }
 
@@ -108,6 +200,7 @@ namespace Nuclex::FrameFixer::Algorithm::Deinterlacing {
     const std::shared_ptr<::AVFrame> &frame, QImage &image
   ) {
     using Nuclex::FrameFixer::Platform::LibAvApi;
+    using Nuclex::FrameFixer::Rendering::PixelConversion;
 
     bool dimensionsMatch = (
       (frame->width == image.width()) &&
@@ -117,6 +210,12 @@ namespace Nuclex::FrameFixer::Algorithm::Deinterlacing {
       throw std::runtime_error(u8"Processed AV frame has different dimensions from QImage");
     }
 
+    // Filters that had nothing to do may hand out the input frame unchanged. If that
+    // frame was wrapping the target image's pixels, the result is already in place.
+    if(frame->data[0] == image.constBits()) {
+      return;
+    }
+
     // TODO: Cheap and insufficient decision between 16 bits per color channel
     //       and 8 bits per color channel. I only have the former kind of images
     //       currently, but this should compare the actual pixel formats!
@@ -125,66 +224,37 @@ namespace Nuclex::FrameFixer::Algorithm::Deinterlacing {
         LibAvApi::LockAvFrameBuffer(frame);
       }
       if(frame->format == AV_PIX_FMT_GBRAP16LE) { // planar output (NNedi does this)
-        const std::uint8_t *greenChannel = frame->data[0];
-        const std::uint8_t *blueChannel = frame->data[1];
-        const std::uint8_t *redChannel = frame->data[2];
-        const std::uint8_t *alphaChannel = frame->data[3];
-
+        std::size_t frameWidth = static_cast<std::size_t>(frame->width);
         std::size_t frameHeight = static_cast<std::size_t>(frame->height);
         for(std::size_t lineIndex = 0; lineIndex < frameHeight; ++lineIndex) {
-          QRgba64 *targetScanline = reinterpret_cast<QRgba64 *>(image.scanLine(lineIndex));
-          std::size_t frameWidth = static_cast<std::size_t>(frame->width);
-          for(std::size_t pixelIndex = 0; pixelIndex < frameWidth; ++pixelIndex) {
-            targetScanline[pixelIndex] = QRgba64::fromRgba64(
-              reinterpret_cast<const quint16 *>(redChannel)[pixelIndex],
-              reinterpret_cast<const quint16 *>(greenChannel)[pixelIndex],
-              reinterpret_cast<const quint16 *>(blueChannel)[pixelIndex],
-              reinterpret_cast<const quint16 *>(alphaChannel)[pixelIndex]
-            );
-          }
-
-          targetScanline += image.bytesPerLine();
-          greenChannel += frame->linesize[0];
-          blueChannel += frame->linesize[1];
-          redChannel += frame->linesize[2];
-          alphaChannel += frame->linesize[3];
+          PixelConversion::Gbrap16ToRgba64(
+            getPlaneRow<std::uint16_t>(frame, 0, lineIndex), // green
+            getPlaneRow<std::uint16_t>(frame, 1, lineIndex), // blue
+            getPlaneRow<std::uint16_t>(frame, 2, lineIndex), // red
+            getPlaneRow<std::uint16_t>(frame, 3, lineIndex), // alpha
+            reinterpret_cast<std::uint16_t *>(image.scanLine(static_cast<int>(lineIndex))),
+            frameWidth
+          );
         }
       } else if(frame->format == AV_PIX_FMT_GBRAP) { // planar output (Yadif does this)
-        const std::uint8_t *greenChannel = frame->data[0];
-        const std::uint8_t *blueChannel = frame->data[1];
-        const std::uint8_t *redChannel = frame->data[2];
-        const std::uint8_t *alphaChannel = frame->data[3];
-
+        std::size_t frameWidth = static_cast<std::size_t>(frame->width);
         std::size_t frameHeight = static_cast<std::size_t>(frame->height);
         for(std::size_t lineIndex = 0; lineIndex < frameHeight; ++lineIndex) {
-          QRgba64 *targetScanline = reinterpret_cast<QRgba64 *>(image.scanLine(lineIndex));
-          std::size_t frameWidth = static_cast<std::size_t>(frame->width);
-          for(std::size_t pixelIndex = 0; pixelIndex < frameWidth; ++pixelIndex) {
-            targetScanline[pixelIndex] = QRgba64::fromRgba(
-              reinterpret_cast<const quint8 *>(redChannel)[pixelIndex],
-              reinterpret_cast<const quint8 *>(greenChannel)[pixelIndex],
-              reinterpret_cast<const quint8 *>(blueChannel)[pixelIndex],
-              reinterpret_cast<const quint8 *>(alphaChannel)[pixelIndex]
-            );
-          }
-
-          targetScanline += image.bytesPerLine();
-          greenChannel += frame->linesize[0];
-          blueChannel += frame->linesize[1];
-          redChannel += frame->linesize[2];
-          alphaChannel += frame->linesize[3];
-        }
-      } else if(frame->format == AV_PIX_FMT_RGBA64LE) { // AV_PIX_FMT_BGR48LE
-        const std::uint8_t *frameData = frame->data[0];
-        std::size_t frameHeight = static_cast<std::size_t>(frame->height);
-        for(std::size_t lineIndex = 0; lineIndex < frameHeight; ++lineIndex) {
-          std::copy_n(
-            frameData,
-            frame->linesize[0],
-            image.scanLine(lineIndex) // Will be QRgba64 (64 bit interleaved) pixels
+          PixelConversion::Gbrap8ToRgba64(
+            getPlaneRow<std::uint8_t>(frame, 0, lineIndex), // green
+            getPlaneRow<std::uint8_t>(frame, 1, lineIndex), // blue
+            getPlaneRow<std::uint8_t>(frame, 2, lineIndex), // red
+            getPlaneRow<std::uint8_t>(frame, 3, lineIndex), // alpha
+            reinterpret_cast<std::uint16_t *>(image.scanLine(static_cast<int>(lineIndex))),
+            frameWidth
           );
-          frameData += frame->linesize[0];
         }
+      } else if(frame->format == AV_PIX_FMT_RGBA64LE) { // AV_PIX_FMT_BGR48LE
+        copyRows(
+          frame->data[0], static_cast<std::size_t>(frame->linesize[0]),
+          image.bits(), static_cast<std::size_t>(image.bytesPerLine()),
+          static_cast<std::size_t>(frame->height)
+        );
       } else {
         throw std::runtime_error(u8"Processed AV frame has different pixel format from QImage");
       }
@@ -196,16 +266,11 @@ namespace Nuclex::FrameFixer::Algorithm::Deinterlacing {
         LibAvApi::LockAvFrameBuffer(frame);
       }
 
-      const std::uint8_t *frameData = frame->data[0];
-      std::size_t frameHeight = static_cast<std::size_t>(frame->height);
-      for(std::size_t lineIndex = 0; lineIndex < frameHeight; ++lineIndex) {
-        std::copy_n(
-          frameData,
-          frame->linesize[0],
-          image.scanLine(lineIndex) // Will be QRgb (32 bit interleaved) pixels
-        );
-        frameData += frame->linesize[0];
-      }
+      copyRows(
+        frame->data[0], static_cast<std::size_t>(frame->linesize[0]),
+        image.bits(), static_cast<std::size_t>(image.bytesPerLine()),
+        static_cast<std::size_t>(frame->height)
+      );
     }
   }
 
@@ -71,8 +71,14 @@ namespace Nuclex::FrameFixer::Algorithm::Deinterlacing {
     }
 
     /// <summary>Creates a new AV frame containing the pixels of a QImage (from Qt)</summary>
-    /// <param name="image">Image whose pixels will be copied into a new AV frame</param>
+    /// <param name="image">Image whose pixels will be provided through a new AV frame</param>
     /// <returns>An AV frame containing the pixels of the input image</returns>
+    /// <remarks>
+    ///   If the image's rows are suitably aligned, the AV frame references the image's
+    ///   pixels instead of copying them and keeps a shallow copy of the image until libav
+    ///   releases the frame. Writing to the image while libav still holds the frame will
+    ///   thus detach it as usual in Qt.
+    /// </remarks>
     protected: static std::shared_ptr<::AVFrame> AvFrameFromQImage(const QImage &image);
 
     /// <summary>Copies the contents of an AV frame into an existing QImage</summary>
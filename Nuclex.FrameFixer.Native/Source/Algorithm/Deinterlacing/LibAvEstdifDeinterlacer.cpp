@@ -75,6 +75,10 @@ namespace Nuclex::FrameFixer::Algorithm::Deinterlacing {
       Platform::LibAvApi::ReadFrameFromFilterGraph(filterGraph)
     );
 
+    // The filter graph may still reference the input frames, which can be wrapping
+    // the target image's pixels. Destroy it so writing the result won't detach the image.
+    filterGraph.reset();
+
     // Finally, put the processed frame back into the QImage
     if(static_cast<bool>(outputFrame2)) {
       CopyAvFrameToQImage(outputFrame2, target);
@@ -40,6 +40,12 @@ namespace Nuclex::FrameFixer::Algorithm::Deinterlacing {
     public: std::string GetName() const override {
       return u8"Estdif-libav: Interpolate missing fields via edge slope tracing";
     }
+
+    /// <summary>Creates another instance of the deinterlacer with the same settings</summary>
+    /// <returns>A new, independent deinterlacer instance</returns>
+    public: std::shared_ptr<Deinterlacer> Clone() const override {
+      return std::make_shared<LibAvEstdifDeinterlacer>();
+    }
     /// <summary>Deinterlaces the specified frame</summary>
     /// <param name="target">Frame that will be deinterlaced</param>
     /// <param name="mode">
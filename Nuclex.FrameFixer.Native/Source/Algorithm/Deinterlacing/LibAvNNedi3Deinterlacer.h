@@ -44,6 +44,12 @@ namespace Nuclex::FrameFixer::Algorithm::Deinterlacing {
       return u8"NNEdi3-libav: Predict missing fields via AI";
     }
 
+    /// <summary>Creates another instance of the deinterlacer with the same settings</summary>
+    /// <returns>A new, independent deinterlacer instance</returns>
+    public: std::shared_ptr<Deinterlacer> Clone() const override {
+      return std::make_shared<LibAvNNedi3Deinterlacer>();
+    }
+
     /// <summary>Whether this deinterlacer needs to know the previous frame</summary>
     /// <returns>True if the deinterlacer needs the previous frame to work with</returns>
     public: bool NeedsPriorFrame() const override { return true; }
@@ -86,7 +86,7 @@ namespace Nuclex::FrameFixer::Algorithm::Deinterlacing {
     if(this->nextFrame.isNull()) {
       nextFrame = AvFrameFromQImage(target);
     } else {
-      nextFrame = AvFrameFromQImage(this->priorFrame);
+      nextFrame = AvFrameFromQImage(this->nextFrame);
     }
 
     std::shared_ptr<::AVFrame> inputFrame = AvFrameFromQImage(target);
@@ -122,6 +122,10 @@ namespace Nuclex::FrameFixer::Algorithm::Deinterlacing {
       Platform::LibAvApi::ReadFrameFromFilterGraph(filterGraph)
     );
 
+    // The filter graph may still reference the input frames, which can be wrapping
+    // the target image's pixels. Destroy it so writing the result won't detach the image.
+    filterGraph.reset();
+
     // Finally, put the processed frame back into the QImage
     if(static_cast<bool>(outputFrame3)) {
       CopyAvFrameToQImage(outputFrame3, target);
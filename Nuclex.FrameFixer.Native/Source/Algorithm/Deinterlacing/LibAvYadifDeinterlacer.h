@@ -49,6 +49,12 @@ namespace Nuclex::FrameFixer::Algorithm::Deinterlacing {
       }
     }
 
+    /// <summary>Creates another instance of the deinterlacer with the same settings</summary>
+    /// <returns>A new, independent deinterlacer instance</returns>
+    public: std::shared_ptr<Deinterlacer> Clone() const override {
+      return std::make_shared<LibAvYadifDeinterlacer>(this->bwDifMode);
+    }
+
     /// <summary>Whether this deinterlacer needs to know the previous frame</summary>
     /// <returns>True if the deinterlacer needs the previous frame to work with</returns>
     public: bool NeedsPriorFrame() const override { return true; }
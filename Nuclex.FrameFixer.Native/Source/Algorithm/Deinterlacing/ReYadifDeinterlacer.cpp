@@ -22,7 +22,9 @@ limitations under the License.
 
 #include "./ReYadifDeinterlacer.h"
 #include "./BasicDeinterlacer.h"
+#include "../../Rendering/FrameBuffer.h"
 
+#include <algorithm> // for std::copy_n()
 #include <vector> // for std::vector
 
 // Declared ni ReYadif8.cpp
@@ -69,67 +71,78 @@ namespace Nuclex::FrameFixer::Algorithm::Deinterlacing {
     }
 
     if((mode == DeinterlaceMode::TopFieldOnly) || (mode == DeinterlaceMode::BottomFieldOnly)) {
+      Rendering::FrameBuffer targetBuffer = Rendering::FrameBuffer::Wrap(target);
       BasicDeinterlacer::Deinterlace(
-        nullptr, target, (mode == DeinterlaceMode::TopFieldOnly)
+        nullptr, targetBuffer, (mode == DeinterlaceMode::TopFieldOnly)
       );
     } else if(mode != DeinterlaceMode::Dont) {
-      QImage currentFrame = target.copy();
+      Rendering::FramePixelFormat format = Rendering::FrameBuffer::GetPixelFormat(target);
+
+      // Keep the copy of the current frame around, so that deinterlacing the next frame
+      // does not need to allocate several megabytes of memory again
+      bool canReuseCopy = (
+        static_cast<bool>(this->currentFrame) &&
+        (this->currentFrame->GetWidth() == target.width()) &&
+        (this->currentFrame->GetHeight() == target.height()) &&
+        (this->currentFrame->GetFormat() == format)
+      );
+      if(!canReuseCopy) {
+        this->currentFrame = std::make_shared<Rendering::FrameBuffer>(
+          target.width(), target.height(), format
+        );
+      }
+
+      std::size_t lineCount = target.height();
+      std::size_t rowLength = this->currentFrame->GetRowLength();
+      for(std::size_t lineIndex = 0; lineIndex < lineCount; ++lineIndex) {
+        std::copy_n(
+          target.constScanLine(static_cast<int>(lineIndex)),
+          rowLength,
+          this->currentFrame->GetRow(lineIndex)
+        );
+      }
+
       int startField = (mode == DeinterlaceMode::TopFieldFirst);
 
       target.fill(Qt::GlobalColor::green);
 
-      std::size_t lineCount = target.height();
-      for(std::size_t lineIndex = 1; lineIndex < lineCount - 1; ++lineIndex) {
-        if(currentFrame.bytesPerLine() >= currentFrame.width() * 8) {
-          std::uint16_t *targetPixels = reinterpret_cast<std::uint16_t *>(
-            target.scanLine(lineIndex)
-          );
-          const std::uint16_t *previousPixels = reinterpret_cast<const std::uint16_t *>(
-            this->priorFrame.scanLine(lineIndex)
-          );
-          const std::uint16_t *currentPixels = reinterpret_cast<const std::uint16_t *>(
-            currentFrame.scanLine(lineIndex)
-          );
-          const std::uint16_t *nextPixels = reinterpret_cast<const std::uint16_t *>(
-            this->priorFrame.scanLine(lineIndex)
-          );
+      Rendering::FrameBuffer targetBuffer = Rendering::FrameBuffer::Wrap(target);
+      Rendering::FrameBuffer priorBuffer = Rendering::FrameBuffer::WrapReadOnly(
+        this->priorFrame
+      );
+      Rendering::FrameBuffer nextBuffer = Rendering::FrameBuffer::WrapReadOnly(
+        this->nextFrame
+      );
+      const Rendering::FrameBuffer &currentBuffer = *this->currentFrame;
 
+      int imageWidth = target.width();
+      if(currentBuffer.HasSixteenBitChannels()) {
+        for(std::size_t lineIndex = 1; lineIndex < lineCount - 1; ++lineIndex) {
           ::ReYadif1Row(
             0,
-            targetPixels,
-            previousPixels,
-            currentPixels,
-            nextPixels,
-            currentFrame.width() * 4,
+            reinterpret_cast<std::uint16_t *>(targetBuffer.GetRow(lineIndex)),
+            reinterpret_cast<const std::uint16_t *>(priorBuffer.GetRow(lineIndex)),
+            reinterpret_cast<const std::uint16_t *>(currentBuffer.GetRow(lineIndex)),
+            reinterpret_cast<const std::uint16_t *>(nextBuffer.GetRow(lineIndex)),
+            imageWidth * 4,
             sizeof(QRgba64),
             startField ^ (lineIndex & 1)
           );
-        } else { // 16 bits per color channel / 8 bits per color channel 
-          std::uint8_t *targetPixels = reinterpret_cast<std::uint8_t *>(
-            target.scanLine(lineIndex)
-          );
-          const std::uint8_t *previousPixels = reinterpret_cast<const std::uint8_t *>(
-            this->priorFrame.scanLine(lineIndex)
-          );
-          const std::uint8_t *currentPixels = reinterpret_cast<const std::uint8_t *>(
-            currentFrame.scanLine(lineIndex)
-          );
-          const std::uint8_t *nextPixels = reinterpret_cast<const std::uint8_t *>(
-            this->nextFrame.scanLine(lineIndex)
-          );
-
+        }
+      } else { // 16 bits per color channel / 8 bits per color channel 
+        for(std::size_t lineIndex = 1; lineIndex < lineCount - 1; ++lineIndex) {
           ::ReYadif1Row(
             0,
-            targetPixels,
-            previousPixels,
-            currentPixels,
-            nextPixels,
-            currentFrame.width() * 4,
+            targetBuffer.GetRow(lineIndex),
+            priorBuffer.GetRow(lineIndex),
+            currentBuffer.GetRow(lineIndex),
+            nextBuffer.GetRow(lineIndex),
+            imageWidth * 4,
             sizeof(std::uint8_t),
             startField ^ (lineIndex & 1)
           );
-        } // if 8 bits per color channel
-      } // for each line
+        }
+      } // if 8 bits per color channel
     } // if top field first or bottom field first mode
   }
 
@@ -23,6 +23,16 @@ limitations under the License.
 #include "Nuclex/FrameFixer/Config.h"
 #include "./Deinterlacer.h"
 
+namespace Nuclex::FrameFixer::Rendering {
+
+  // ------------------------------------------------------------------------------------------- //
+
+  class FrameBuffer;
+
+  // ------------------------------------------------------------------------------------------- //
+
+} // namespace Nuclex::FrameFixer::Rendering
+
 namespace Nuclex::FrameFixer::Algorithm::Deinterlacing {
 
   // ------------------------------------------------------------------------------------------- //
@@ -47,6 +57,12 @@ namespace Nuclex::FrameFixer::Algorithm::Deinterlacing {
       return u8"ReYadif: Broken Yadif implementation";
     }
 
+    /// <summary>Creates another instance of the deinterlacer with the same settings</summary>
+    /// <returns>A new, independent deinterlacer instance</returns>
+    public: std::shared_ptr<Deinterlacer> Clone() const override {
+      return std::make_shared<ReYadifDeinterlacer>();
+    }
+
     /// <summary>Whether this deinterlacer needs to know the previous frame</summary>
     /// <returns>True if the deinterlacer needs the previous frame to work with</returns>
     public: bool NeedsPriorFrame() const override { return true; }
@@ -85,6 +101,8 @@ namespace Nuclex::FrameFixer::Algorithm::Deinterlacing {
     private: QImage priorFrame;
     /// <summary>The frame following the current one</summary>
     private: QImage nextFrame;
+    /// <summary>Copy of the frame being deinterlaced, reused from frame to frame</summary>
+    private: std::shared_ptr<Rendering::FrameBuffer> currentFrame;
 
   };
 
@@ -23,6 +23,9 @@ limitations under the License.
 #include "./Filter.h"
 #include "./RgbColor.h"
 #include "./HslColor.h"
+#include "../Rendering/FrameBuffer.h"
+
+#include <stdexcept> // for std::invalid_argument
 
 namespace {
 
@@ -107,127 +110,173 @@ namespace {
 
   // ------------------------------------------------------------------------------------------- //
 
-} // anonymous namespace
+  /// <summary>Converts a pixel with 16 bits per channel into a QColor</summary>
+  /// <param name="pixel">Pixel that will be converted</param>
+  /// <returns>A QColor with the pixel's (opaque) color</returns>
+  QColor toColor(const QRgba64 &pixel) {
+    return QColor::fromRgbF(
+      static_cast<float>(pixel.red()) / 65535.0f,
+      static_cast<float>(pixel.green()) / 65535.0f,
+      static_cast<float>(pixel.blue()) / 65535.0f,
+      1.0f
+    );
+  }
 
-namespace Nuclex::FrameFixer {
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Converts a pixel with 8 bits per channel into a QColor</summary>
+  /// <param name="pixel">Pixel that will be converted</param>
+  /// <returns>A QColor with the pixel's (opaque) color</returns>
+  QColor toColor(const QRgb &pixel) {
+    return QColor::fromRgbF(
+      static_cast<float>(qRed(pixel)) / 255.0f,
+      static_cast<float>(qGreen(pixel)) / 255.0f,
+      static_cast<float>(qBlue(pixel)) / 255.0f,
+      1.0f
+    );
+  }
 
   // ------------------------------------------------------------------------------------------- //
 
-  void Filter::LuminanceHighPass(QImage &target) {
+  /// <summary>Stores a color in an opaque pixel with 16 bits per channel</summary>
+  /// <param name="pixel">Pixel the color will be stored in</param>
+  /// <param name="color">Color that will be stored</param>
+  void store(QRgba64 &pixel, const Nuclex::FrameFixer::Algorithm::RgbColor &color) {
+    pixel = QRgba64::fromRgba64(
+      static_cast<quint16>(color.Red * 65535.0f),
+      static_cast<quint16>(color.Green * 65535.0f),
+      static_cast<quint16>(color.Blue * 65535.0f),
+      65535U
+    );
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Stores a color in an opaque pixel with 8 bits per channel</summary>
+  /// <param name="pixel">Pixel the color will be stored in</param>
+  /// <param name="color">Color that will be stored</param>
+  void store(QRgb &pixel, const Nuclex::FrameFixer::Algorithm::RgbColor &color) {
+    pixel = qRgb(
+      static_cast<int>(color.Red * 255.0f),
+      static_cast<int>(color.Green * 255.0f),
+      static_cast<int>(color.Blue * 255.0f)
+    );
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Converts a row of pixels into HSL colors</summary>
+  /// <typeparam name="TPixel">Type of the pixels, either QRgb or QRgba64</typeparam>
+  /// <param name="frame">Frame from which a row of pixels will be read</param>
+  /// <param name="lineIndex">Index of the row that will be read</param>
+  /// <param name="line">Receives the HSL color of each pixel in the row</param>
+  template<typename TPixel>
+  void loadLine(
+    const Nuclex::FrameFixer::Rendering::FrameBuffer &frame,
+    std::size_t lineIndex,
+    std::vector<Nuclex::FrameFixer::Algorithm::HslColor> &line
+  ) {
+    const TPixel *pixels = reinterpret_cast<const TPixel *>(frame.GetRow(lineIndex));
+
+    std::size_t width = static_cast<std::size_t>(frame.GetWidth());
+    for(std::size_t x = 0; x < width; ++x) {
+      toColor(pixels[x]).getHslF(
+        &line[x].Hue,
+        &line[x].Saturation,
+        &line[x].Lightness,
+        &line[x].Alpha
+      );
+    }
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Runs a high pass filter on the luma channel of a frame</summary>
+  /// <typeparam name="TPixel">Type of the pixels, either QRgb or QRgba64</typeparam>
+  /// <param name="target">Frame that will be filtered</param>
+  template<typename TPixel>
+  void luminanceHighPass(Nuclex::FrameFixer::Rendering::FrameBuffer &target) {
     using Nuclex::FrameFixer::Algorithm::HslColor;
     using Nuclex::FrameFixer::Algorithm::RgbColor;
 
-    if(target.bytesPerLine() >= target.width() * 8) {
-      std::vector<HslColor> line1, line2, line3;
-      line1.resize(target.width());
-      line2.resize(target.width());
-      line3.resize(target.width());
+    std::size_t targetWidth = static_cast<std::size_t>(target.GetWidth());
+    std::size_t targetHeight = static_cast<std::size_t>(target.GetHeight());
+    if((targetWidth < 3) || (targetHeight < 3)) {
+      return; // The filter leaves the border untouched, so there is nothing to do
+    }
+
+    std::vector<HslColor> line1(targetWidth), line2(targetWidth), line3(targetWidth);
+    std::vector<HslColor> *lines[3] = { &line1, &line2, &line3 };
+
+    // Prepare the initial 2 lines for the filter
+    loadLine<TPixel>(target, 0, line1);
+    loadLine<TPixel>(target, 1, line2);
 
-      // Prepare the initial 2 lines for the filter
+    // Run the filter over all pixels in the image
+    for(std::size_t lineIndex = 1; lineIndex < targetHeight - 1; ++lineIndex) {
+
+      // Fill the third line (each loop, the lines are switched round robin such that
+      // the former lines 2 and 3 take places 1 and 2).
+      loadLine<TPixel>(target, lineIndex + 1, *lines[2]);
+
+      // Filter the middle of the three processed lines
       {
-        QRgba64 *scanLine1 = reinterpret_cast<QRgba64 *>(target.scanLine(0));
-        QRgba64 *scanLine2 = reinterpret_cast<QRgba64 *>(target.scanLine(1));
-
-        std::size_t targetWidth = static_cast<std::size_t>(target.width());
-        for(std::size_t x = 0; x < targetWidth; ++x) {
-          QRgba64 qtColor = scanLine1[x];
-          QColor::fromRgbF(
-            static_cast<float>(qtColor.red()) / 65536.0f,
-            static_cast<float>(qtColor.green()) / 65536.0f,
-            static_cast<float>(qtColor.blue()) / 65536.0f,
-            1.0f
-          ).getHslF(
-            &line1[x].Hue,
-            &line1[x].Saturation,
-            &line1[x].Lightness,
-            &line1[x].Alpha
+        std::vector<HslColor> &line = *lines[1];
+        TPixel *scanLine = reinterpret_cast<TPixel *>(target.GetRow(lineIndex));
+
+        for(std::size_t x = 1; x < targetWidth - 1; ++x) {
+          RgbColor rgbColor;
+          QColor::fromHslF(
+            line[x].Hue,
+            line[x].Saturation,
+            clamp(applyKernelToLightness(lines, lessEdgeDetectionKernel, x)),
+            line[x].Alpha
+          ).getRgbF(
+            &rgbColor.Red,
+            &rgbColor.Green,
+            &rgbColor.Blue,
+            &rgbColor.Alpha
           );
 
-          qtColor = scanLine2[x];
-          QColor::fromRgbF(
-            static_cast<float>(qtColor.red()) / 65536.0f,
-            static_cast<float>(qtColor.green()) / 65536.0f,
-            static_cast<float>(qtColor.blue()) / 65536.0f,
-            1.0f
-          ).getHslF(
-            &line2[x].Hue,
-            &line2[x].Saturation,
-            &line2[x].Lightness,
-            &line2[x].Alpha
-          );
+          store(scanLine[x], rgbColor);
         }
       }
 
-      std::vector<HslColor> *lines[3] = { &line1, &line2, &line3 };
-
-      // Run the filter over all pixels in the image
-      std::size_t targetHeight = static_cast<std::size_t>(target.height());
-      for(std::size_t lineIndex = 1; lineIndex < targetHeight - 1; ++lineIndex) {
-
-        // Fill the third line (each loop, the lines are switched round robin such that
-        // the former lines 2 and 3 take places 1 and 2).
-        {
-          std::vector<HslColor> &line = *lines[2];
-          QRgba64 *scanLine = reinterpret_cast<QRgba64 *>(target.scanLine(lineIndex + 1));
-
-          std::size_t targetWidth = static_cast<std::size_t>(target.width());
-          for(std::size_t x = 0; x < targetWidth; ++x) {
-            QRgba64 qtColor = scanLine[x];
-            QColor::fromRgbF(
-              static_cast<float>(qtColor.red()) / 65536.0f,
-              static_cast<float>(qtColor.green()) / 65536.0f,
-              static_cast<float>(qtColor.blue()) / 65536.0f,
-              1.0f
-            ).getHslF(
-              &line[x].Hue,
-              &line[x].Saturation,
-              &line[x].Lightness,
-              &line[x].Alpha
-            );
-          }
-        }
+      // Move the lines around like a ringbuffer
+      {
+        std::vector<HslColor> *first = lines[0];
+        lines[0] = lines[1];
+        lines[1] = lines[2];
+        lines[2] = first;
+      }
+    } // for each line
+  }
 
-        // Filter the middle of the three processed lines
-        {
-          std::vector<HslColor> &line = *lines[1];
-          QRgba64 *scanLine = reinterpret_cast<QRgba64 *>(target.scanLine(lineIndex));
-
-          std::size_t targetWidth = static_cast<std::size_t>(target.width());
-          for(std::size_t x = 1; x < targetWidth - 1; ++x) {
-            float lightness = applyKernelToLightness(lines, lessEdgeDetectionKernel, x);
-
-            RgbColor rgbColor;
-            QColor::fromHslF(
-              line[x].Hue,
-              line[x].Saturation,
-              clamp(applyKernelToLightness(lines, lessEdgeDetectionKernel, x)),
-              line[x].Alpha
-            ).getRgbF(
-              &rgbColor.Red,
-              &rgbColor.Green,
-              &rgbColor.Blue,
-              &rgbColor.Alpha
-            );
-
-            scanLine[x] = QRgba64::fromRgba64(
-              static_cast<quint16>(rgbColor.Red * 65535.0f),
-              static_cast<quint16>(rgbColor.Green * 65535.0f),
-              static_cast<quint16>(rgbColor.Blue * 65535.0f),
-              65535U
-            );
-          }
-        }
+  // ------------------------------------------------------------------------------------------- //
 
-        // Move the lines around like a ringbuffer
-        {
-          std::vector<HslColor> *first = lines[0];
-          lines[0] = lines[1];
-          lines[1] = lines[2];
-          lines[2] = first;
-        }
-      } // for each line
-    } else { // if 16 bits per color channel / 8 bits per color channel
-      throw std::runtime_error(u8"8 bit color depth not implemented yet, use 16 bit color depth");
+} // anonymous namespace
+
+namespace Nuclex::FrameFixer {
+
+  // ------------------------------------------------------------------------------------------- //
+
+  void Filter::LuminanceHighPass(QImage &target) {
+    Rendering::FrameBuffer targetBuffer = Rendering::FrameBuffer::Wrap(target);
+    LuminanceHighPass(targetBuffer);
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  void Filter::LuminanceHighPass(Rendering::FrameBuffer &target) {
+    if(target.GetLayout() != Rendering::FrameLayout::Interleaved) {
+      throw std::invalid_argument(u8"The luminance high pass filter requires interleaved frames");
+    }
+
+    // The pixel format is looked at once here rather than for each line
+    if(target.HasSixteenBitChannels()) {
+      luminanceHighPass<QRgba64>(target);
+    } else {
+      luminanceHighPass<QRgb>(target);
     }
   }
 
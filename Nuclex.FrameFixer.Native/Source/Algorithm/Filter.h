@@ -25,6 +25,16 @@ limitations under the License.
 #include <vector> // for std::vector
 #include <QImage>
 
+namespace Nuclex::FrameFixer::Rendering {
+
+  // ------------------------------------------------------------------------------------------- //
+
+  class FrameBuffer;
+
+  // ------------------------------------------------------------------------------------------- //
+
+} // namespace Nuclex::FrameFixer::Rendering
+
 namespace Nuclex::FrameFixer {
 
   // ------------------------------------------------------------------------------------------- //
@@ -40,6 +50,13 @@ namespace Nuclex::FrameFixer {
     /// </remarks>
     public: static void LuminanceHighPass(QImage &target);
 
+    /// <summary>Runs a high pass filter on a frame's luma channel</summary>
+    /// <param name="target">Interleaved frame that will be filtered</param>
+    /// <remarks>
+    ///   The pixels on the frame's border are left as they are.
+    /// </remarks>
+    public: static void LuminanceHighPass(Rendering::FrameBuffer &target);
+
     // Should really be generalized, but YAGNI - until more than one filter exists
 #if 0
     /// <summary>Applies a custom filter to an image's saturation</summary>
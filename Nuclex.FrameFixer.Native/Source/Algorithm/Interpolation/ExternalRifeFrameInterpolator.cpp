@@ -21,6 +21,7 @@ limitations under the License.
 #define NUCLEX_FRAMEFIXER_SOURCE 1
 
 #include "./ExternalRifeFrameInterpolator.h"
+#include "../../Diagnostics/TraceRecorder.h"
 #include <Nuclex/Support/Threading/Process.h> // for Process
 
 #include <vector> // for std::vector
@@ -48,9 +49,13 @@ namespace Nuclex::FrameFixer::Algorithm::Interpolation {
       )
     );
 
-    prior.save(u8"/tmp/hacky-prior.png", u8"PNG");
-    after.save(u8"/tmp/hacky-after.png", u8"PNG");
+    {
+      NUCLEX_FRAMEFIXER_TRACE_SCOPE(u8"interpolator", u8"Save input frames");
+      prior.save(u8"/tmp/hacky-prior.png", u8"PNG");
+      after.save(u8"/tmp/hacky-after.png", u8"PNG");
+    }
 
+    NUCLEX_FRAMEFIXER_TRACE_SCOPE(u8"interpolator", u8"rife-ncnn-vulkan process");
     encoderProcess->SetWorkingDirectory(u8"/tmp");
     encoderProcess->Start(
       {
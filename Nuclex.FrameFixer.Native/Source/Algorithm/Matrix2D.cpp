@@ -0,0 +1,309 @@
+#pragma region Apache License 2.0
+/*
+Nuclex Frame Fixer
+Copyright (C) 2024 Markus Ewald / Nuclex Development Labs
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#pragma endregion // Apache License 2.0
+
+// If the application is compiled as a DLL, this ensures symbols are exported
+#define NUCLEX_FRAMEFIXER_SOURCE 1
+
+#include "./Matrix2D.h"
+#include "../Platform/CpuFeatures.h"
+
+#if defined(NUCLEX_FRAMEFIXER_HAVE_SSE2)
+  #include <emmintrin.h> // for SSE2 intrinsics
+#endif
+#if defined(NUCLEX_FRAMEFIXER_HAVE_AVX2)
+  #include <immintrin.h> // for AVX intrinsics
+#endif
+
+namespace {
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Element-wise operations that can be applied to float arrays</summary>
+  enum class ElementOperation {
+
+    /// <summary>Adds the operand to each element</summary>
+    Add,
+    /// <summary>Multiplies each element by the operand</summary>
+    Multiply,
+    /// <summary>Divides each element by the operand</summary>
+    Divide
+
+  };
+
+  // ------------------------------------------------------------------------------------------- //
+
+#if defined(NUCLEX_FRAMEFIXER_HAVE_SSE2)
+  /// <summary>Applies an element-wise operation to four floats</summary>
+  /// <typeparam name="Operation">Operation that will be applied</typeparam>
+  /// <param name="values">Values the operation will be applied to</param>
+  /// <param name="operands">Operands the values will be combined with</param>
+  /// <returns>The result of the operation</returns>
+  template<ElementOperation Operation>
+  inline __m128 apply(__m128 values, __m128 operands) {
+    if constexpr(Operation == ElementOperation::Add) {
+      return _mm_add_ps(values, operands);
+    } else if constexpr(Operation == ElementOperation::Multiply) {
+      return _mm_mul_ps(values, operands);
+    } else {
+      return _mm_div_ps(values, operands);
+    }
+  }
+#endif // defined(NUCLEX_FRAMEFIXER_HAVE_SSE2)
+
+  // ------------------------------------------------------------------------------------------- //
+
+#if defined(NUCLEX_FRAMEFIXER_HAVE_AVX2)
+  /// <summary>Applies an element-wise operation to eight floats</summary>
+  /// <typeparam name="Operation">Operation that will be applied</typeparam>
+  /// <param name="values">Values the operation will be applied to</param>
+  /// <param name="operands">Operands the values will be combined with</param>
+  /// <returns>The result of the operation</returns>
+  template<ElementOperation Operation>
+  NUCLEX_FRAMEFIXER_AVX2_FUNCTION inline __m256 applyAvx(__m256 values, __m256 operands) {
+    if constexpr(Operation == ElementOperation::Add) {
+      return _mm256_add_ps(values, operands);
+    } else if constexpr(Operation == ElementOperation::Multiply) {
+      return _mm256_mul_ps(values, operands);
+    } else {
+      return _mm256_div_ps(values, operands);
+    }
+  }
+#endif // defined(NUCLEX_FRAMEFIXER_HAVE_AVX2)
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Applies an element-wise operation to a single float</summary>
+  /// <typeparam name="Operation">Operation that will be applied</typeparam>
+  /// <param name="value">Value the operation will be applied to</param>
+  /// <param name="operand">Operand the value will be combined with</param>
+  /// <returns>The result of the operation</returns>
+  template<ElementOperation Operation>
+  inline float apply(float value, float operand) {
+    if constexpr(Operation == ElementOperation::Add) {
+      return value + operand;
+    } else if constexpr(Operation == ElementOperation::Multiply) {
+      return value * operand;
+    } else {
+      return value / operand;
+    }
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+#if defined(NUCLEX_FRAMEFIXER_HAVE_AVX2)
+  /// <summary>Combines the elements of two arrays using AVX</summary>
+  /// <typeparam name="Operation">Operation that will be applied to each element</typeparam>
+  /// <param name="elements">Elements that will be combined with the operands</param>
+  /// <param name="operands">Operands the elements will be combined with</param>
+  /// <param name="count">Number of elements that should be processed</param>
+  /// <returns>The number of elements that have been processed</returns>
+  template<ElementOperation Operation>
+  NUCLEX_FRAMEFIXER_AVX2_FUNCTION std::size_t combineArraysAvx(
+    float *elements, const float *operands, std::size_t count
+  ) {
+    std::size_t index = 0;
+    for(; index + 8 <= count; index += 8) {
+      _mm256_store_ps(
+        elements + index,
+        applyAvx<Operation>(_mm256_load_ps(elements + index), _mm256_load_ps(operands + index))
+      );
+    }
+
+    return index;
+  }
+#endif // defined(NUCLEX_FRAMEFIXER_HAVE_AVX2)
+
+  // ------------------------------------------------------------------------------------------- //
+
+#if defined(NUCLEX_FRAMEFIXER_HAVE_AVX2)
+  /// <summary>Combines the elements of an array with a constant using AVX</summary>
+  /// <typeparam name="Operation">Operation that will be applied to each element</typeparam>
+  /// <param name="elements">Elements that will be combined with the operand</param>
+  /// <param name="operand">Operand the elements will be combined with</param>
+  /// <param name="count">Number of elements that should be processed</param>
+  /// <returns>The number of elements that have been processed</returns>
+  template<ElementOperation Operation>
+  NUCLEX_FRAMEFIXER_AVX2_FUNCTION std::size_t combineWithConstantAvx(
+    float *elements, float operand, std::size_t count
+  ) {
+    const __m256 operands = _mm256_set1_ps(operand);
+
+    std::size_t index = 0;
+    for(; index + 8 <= count; index += 8) {
+      _mm256_store_ps(
+        elements + index, applyAvx<Operation>(_mm256_load_ps(elements + index), operands)
+      );
+    }
+
+    return index;
+  }
+#endif // defined(NUCLEX_FRAMEFIXER_HAVE_AVX2)
+
+  // ------------------------------------------------------------------------------------------- //
+
+#if defined(NUCLEX_FRAMEFIXER_HAVE_AVX2)
+  /// <summary>Sets all elements of an array to the same value using AVX</summary>
+  /// <param name="elements">Elements that will be set</param>
+  /// <param name="value">Value the elements will be set to</param>
+  /// <param name="count">Number of elements that should be set</param>
+  /// <returns>The number of elements that have been set</returns>
+  NUCLEX_FRAMEFIXER_AVX2_FUNCTION std::size_t fillAvx(
+    float *elements, float value, std::size_t count
+  ) {
+    const __m256 values = _mm256_set1_ps(value);
+
+    std::size_t index = 0;
+    for(; index + 8 <= count; index += 8) {
+      _mm256_store_ps(elements + index, values);
+    }
+
+    return index;
+  }
+#endif // defined(NUCLEX_FRAMEFIXER_HAVE_AVX2)
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Combines the elements of two arrays</summary>
+  /// <typeparam name="Operation">Operation that will be applied to each element</typeparam>
+  /// <param name="elements">Elements that will be combined with the operands</param>
+  /// <param name="operands">Operands the elements will be combined with</param>
+  /// <param name="count">Number of elements that will be processed</param>
+  /// <remarks>
+  ///   Both arrays have to be aligned to at least 32 bytes, which matrix planes always are.
+  /// </remarks>
+  template<ElementOperation Operation>
+  void combineArrays(float *elements, const float *operands, std::size_t count) {
+    std::size_t index = 0;
+
+#if defined(NUCLEX_FRAMEFIXER_HAVE_AVX2)
+    if(Nuclex::FrameFixer::Platform::CpuFeatures::HasAvx2()) {
+      index = combineArraysAvx<Operation>(elements, operands, count);
+    }
+#endif // defined(NUCLEX_FRAMEFIXER_HAVE_AVX2)
+
+#if defined(NUCLEX_FRAMEFIXER_HAVE_SSE2)
+    for(; index + 4 <= count; index += 4) {
+      _mm_store_ps(
+        elements + index,
+        apply<Operation>(_mm_load_ps(elements + index), _mm_load_ps(operands + index))
+      );
+    }
+#endif // defined(NUCLEX_FRAMEFIXER_HAVE_SSE2)
+
+    for(; index < count; ++index) {
+      elements[index] = apply<Operation>(elements[index], operands[index]);
+    }
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Combines the elements of an array with a constant</summary>
+  /// <typeparam name="Operation">Operation that will be applied to each element</typeparam>
+  /// <param name="elements">Elements that will be combined with the operand</param>
+  /// <param name="operand">Operand the elements will be combined with</param>
+  /// <param name="count">Number of elements that will be processed</param>
+  template<ElementOperation Operation>
+  void combineWithConstant(float *elements, float operand, std::size_t count) {
+    std::size_t index = 0;
+
+#if defined(NUCLEX_FRAMEFIXER_HAVE_AVX2)
+    if(Nuclex::FrameFixer::Platform::CpuFeatures::HasAvx2()) {
+      index = combineWithConstantAvx<Operation>(elements, operand, count);
+    }
+#endif // defined(NUCLEX_FRAMEFIXER_HAVE_AVX2)
+
+#if defined(NUCLEX_FRAMEFIXER_HAVE_SSE2)
+    const __m128 operands = _mm_set1_ps(operand);
+    for(; index + 4 <= count; index += 4) {
+      _mm_store_ps(elements + index, apply<Operation>(_mm_load_ps(elements + index), operands));
+    }
+#endif // defined(NUCLEX_FRAMEFIXER_HAVE_SSE2)
+
+    for(; index < count; ++index) {
+      elements[index] = apply<Operation>(elements[index], operand);
+    }
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+} // anonymous namespace
+
+namespace Nuclex::FrameFixer::Algorithm {
+
+  // ------------------------------------------------------------------------------------------- //
+
+  template<> void Matrix2D<float>::Fill(const float &value) {
+    std::size_t count = this->planeSize * this->planeCount;
+    std::size_t index = 0;
+
+#if defined(NUCLEX_FRAMEFIXER_HAVE_AVX2)
+    if(Platform::CpuFeatures::HasAvx2()) {
+      index = fillAvx(this->elements, value, count);
+    }
+#endif // defined(NUCLEX_FRAMEFIXER_HAVE_AVX2)
+
+#if defined(NUCLEX_FRAMEFIXER_HAVE_SSE2)
+    const __m128 values = _mm_set1_ps(value);
+    for(; index + 4 <= count; index += 4) {
+      _mm_store_ps(this->elements + index, values);
+    }
+#endif // defined(NUCLEX_FRAMEFIXER_HAVE_SSE2)
+
+    for(; index < count; ++index) {
+      this->elements[index] = value;
+    }
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  template<> void Matrix2D<float>::Add(const Matrix2D<float> &other) {
+    requireSameSize(other);
+    combineArrays<ElementOperation::Add>(
+      this->elements, other.elements, this->planeSize * this->planeCount
+    );
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  template<> void Matrix2D<float>::Multiply(const Matrix2D<float> &other) {
+    requireSameSize(other);
+    combineArrays<ElementOperation::Multiply>(
+      this->elements, other.elements, this->planeSize * this->planeCount
+    );
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  template<> void Matrix2D<float>::Multiply(const float &factor) {
+    combineWithConstant<ElementOperation::Multiply>(
+      this->elements, factor, this->planeSize * this->planeCount
+    );
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  template<> void Matrix2D<float>::Divide(const float &divisor) {
+    combineWithConstant<ElementOperation::Divide>(
+      this->elements, divisor, this->planeSize * this->planeCount
+    );
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+} // namespace Nuclex::FrameFixer::Algorithm
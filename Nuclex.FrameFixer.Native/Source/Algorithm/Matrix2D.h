@@ -0,0 +1,291 @@
+#pragma region Apache License 2.0
+/*
+Nuclex Frame Fixer
+Copyright (C) 2024 Markus Ewald / Nuclex Development Labs
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#pragma endregion // Apache License 2.0
+
+
+#ifndef NUCLEX_FRAMEFIXER_ALGORITHM_MATRIX2D_H
+#define NUCLEX_FRAMEFIXER_ALGORITHM_MATRIX2D_H
+
+#include "Nuclex/FrameFixer/Config.h"
+
+#include <algorithm> // for std::fill_n(), std::copy_n()
+#include <cstddef> // for std::size_t
+#include <new> // for std::align_val_t, operator new[]
+#include <stdexcept> // for std::invalid_argument
+#include <type_traits> // for std::is_trivially_copyable
+
+namespace Nuclex::FrameFixer::Algorithm {
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Two dimensional matrix with aligned, padded rows</summary>
+  /// <typeparam name="TElement">Type of the values stored in the matrix</typeparam>
+  /// <remarks>
+  ///   <para>
+  ///     Each row starts on a 64 byte boundary and is padded up to the next one, so SIMD
+  ///     code can work on whole rows without special cases for the start or the end.
+  ///     The padding is part of the matrix' memory and element-wise operations simply
+  ///     run over it, too, treating the whole matrix as one long array.
+  ///   </para>
+  ///   <para>
+  ///     A matrix can consist of several planes of the same size. This is how elements
+  ///     with multiple components are stored as a structure of arrays: a matrix of
+  ///     <see cref="Gradient" /> values is a Matrix2D&lt;float&gt; with two planes, one
+  ///     for the horizontal and one for the vertical components, in the order the members
+  ///     appear in the structure. That way, each component can be processed with SIMD
+  ///     instructions without shuffling. Element types can also be structures,
+  ///     in which case the arithmetic methods require matching operators.
+  ///   </para>
+  ///   <para>
+  ///     For float matrices, the element-wise operations use SSE2 or AVX2, depending on
+  ///     what the CPU supports. Other element types use plain loops.
+  ///   </para>
+  /// </remarks>
+  template<typename TElement>
+  class Matrix2D {
+
+    static_assert(
+      std::is_trivially_copyable<TElement>::value,
+      u8"Matrix elements must be trivially copyable"
+    );
+
+    /// <summary>Number of bytes each row of elements is aligned to</summary>
+    public: static constexpr std::size_t RowAlignment = 64;
+
+    /// <summary>Initializes a new matrix with all elements set to zero</summary>
+    /// <param name="width">Width of the matrix (number of columns)</param>
+    /// <param name="height">Height of the matrix (number of rows)</param>
+    /// <param name="planeCount">Number of planes (components per element)</param>
+    public: Matrix2D(std::size_t width, std::size_t height, std::size_t planeCount = 1) :
+      width(width),
+      height(height),
+      planeCount(planeCount),
+      stride(getAlignedStride(width)),
+      planeSize(this->stride * height),
+      elements(allocate(this->planeSize * planeCount)) {
+      std::fill_n(this->elements, this->planeSize * planeCount, TElement());
+    }
+
+    /// <summary>Initializes a new matrix as a copy of another matrix</summary>
+    /// <param name="other">Matrix whose elements will be copied</param>
+    public: Matrix2D(const Matrix2D &other) :
+      width(other.width),
+      height(other.height),
+      planeCount(other.planeCount),
+      stride(other.stride),
+      planeSize(other.planeSize),
+      elements(allocate(other.planeSize * other.planeCount)) {
+      std::copy_n(other.elements, other.planeSize * other.planeCount, this->elements);
+    }
+
+    /// <summary>Takes over the elements of another matrix</summary>
+    /// <param name="other">Matrix whose elements will be taken over</param>
+    public: Matrix2D(Matrix2D &&other) :
+      width(other.width),
+      height(other.height),
+      planeCount(other.planeCount),
+      stride(other.stride),
+      planeSize(other.planeSize),
+      elements(other.elements) {
+      other.width = other.height = other.planeCount = 0;
+      other.stride = other.planeSize = 0;
+      other.elements = nullptr;
+    }
+
+    /// <summary>Frees all memory used by the matrix</summary>
+    public: ~Matrix2D() {
+      if(this->elements != nullptr) {
+        ::operator delete[](this->elements, std::align_val_t(RowAlignment));
+      }
+    }
+
+    /// <summary>Width of the matrix (number of columns)</summary>
+    public: std::size_t GetWidth() const { return this->width; }
+
+    /// <summary>Height of the matrix (number of rows)</summary>
+    public: std::size_t GetHeight() const { return this->height; }
+
+    /// <summary>Number of planes (components per element) in the matrix</summary>
+    public: std::size_t GetPlaneCount() const { return this->planeCount; }
+
+    /// <summary>Number of elements from the start of one row to the next</summary>
+    /// <remarks>
+    ///   This is at least the width, but padded so each row starts at an aligned address.
+    /// </remarks>
+    public: std::size_t GetStride() const { return this->stride; }
+
+    /// <summary>Looks up a row of elements in the matrix</summary>
+    /// <param name="row">Index of the row that will be looked up</param>
+    /// <param name="plane">Plane in which the row will be looked up</param>
+    /// <returns>The address of the first element in the row</returns>
+    public: TElement *GetRow(std::size_t row, std::size_t plane = 0) {
+      return this->elements + (plane * this->planeSize) + (row * this->stride);
+    }
+
+    /// <summary>Looks up a row of elements in the matrix</summary>
+    /// <param name="row">Index of the row that will be looked up</param>
+    /// <param name="plane">Plane in which the row will be looked up</param>
+    /// <returns>The address of the first element in the row</returns>
+    public: const TElement *GetRow(std::size_t row, std::size_t plane = 0) const {
+      return this->elements + (plane * this->planeSize) + (row * this->stride);
+    }
+
+    /// <summary>Accesses an individual element of the matrix</summary>
+    /// <param name="column">Column in which the element is stored</param>
+    /// <param name="row">Row in which the element is stored</param>
+    /// <param name="plane">Plane in which the element is stored</param>
+    /// <returns>The element at the specified location</returns>
+    public: TElement &At(std::size_t column, std::size_t row, std::size_t plane = 0) {
+      return GetRow(row, plane)[column];
+    }
+
+    /// <summary>Accesses an individual element of the matrix</summary>
+    /// <param name="column">Column in which the element is stored</param>
+    /// <param name="row">Row in which the element is stored</param>
+    /// <param name="plane">Plane in which the element is stored</param>
+    /// <returns>The element at the specified location</returns>
+    public: const TElement &At(std::size_t column, std::size_t row, std::size_t plane = 0) const {
+      return GetRow(row, plane)[column];
+    }
+
+    /// <summary>Sets all elements in all planes of the matrix to the specified value</summary>
+    /// <param name="value">Value all elements will be set to</param>
+    public: void Fill(const TElement &value) {
+      std::fill_n(this->elements, this->planeSize * this->planeCount, value);
+    }
+
+    /// <summary>Adds the elements of another matrix to this matrix' elements</summary>
+    /// <param name="other">Matrix whose elements will be added</param>
+    public: void Add(const Matrix2D &other) {
+      requireSameSize(other);
+
+      std::size_t count = this->planeSize * this->planeCount;
+      for(std::size_t index = 0; index < count; ++index) {
+        this->elements[index] += other.elements[index];
+      }
+    }
+
+    /// <summary>Multiplies the elements of this matrix with another matrix' elements</summary>
+    /// <param name="other">Matrix whose elements will be multiplied with</param>
+    /// <remarks>
+    ///   This is an element-wise (Hadamard) product, not a matrix multiplication.
+    /// </remarks>
+    public: void Multiply(const Matrix2D &other) {
+      requireSameSize(other);
+
+      std::size_t count = this->planeSize * this->planeCount;
+      for(std::size_t index = 0; index < count; ++index) {
+        this->elements[index] *= other.elements[index];
+      }
+    }
+
+    /// <summary>Multiplies all elements in the matrix by the specified factor</summary>
+    /// <param name="factor">Factor all elements will be multiplied by</param>
+    public: void Multiply(const TElement &factor) {
+      std::size_t count = this->planeSize * this->planeCount;
+      for(std::size_t index = 0; index < count; ++index) {
+        this->elements[index] *= factor;
+      }
+    }
+
+    /// <summary>Divides all elements in the matrix by the specified divisor</summary>
+    /// <param name="divisor">Divisor all elements will be divided by</param>
+    public: void Divide(const TElement &divisor) {
+      std::size_t count = this->planeSize * this->planeCount;
+      for(std::size_t index = 0; index < count; ++index) {
+        this->elements[index] /= divisor;
+      }
+    }
+
+    /// <summary>Calculates the number of elements in an aligned row</summary>
+    /// <param name="width">Number of elements the row needs to hold</param>
+    /// <returns>The number of elements including the padding</returns>
+    private: static std::size_t getAlignedStride(std::size_t width) {
+      std::size_t rowByteCount = width * sizeof(TElement);
+      rowByteCount += (RowAlignment - 1);
+      rowByteCount -= rowByteCount % RowAlignment;
+
+      // Elements whose size does not divide the alignment can't be padded to it exactly,
+      // in that case, rows will still be padded but may not all start aligned
+      return (rowByteCount + sizeof(TElement) - 1) / sizeof(TElement);
+    }
+
+    /// <summary>Allocates aligned memory for the specified number of elements</summary>
+    /// <param name="count">Number of elements memory will be allocated for</param>
+    /// <returns>The allocated memory, with the elements not yet initialized</returns>
+    private: static TElement *allocate(std::size_t count) {
+      return reinterpret_cast<TElement *>(
+        ::operator new[](count * sizeof(TElement), std::align_val_t(RowAlignment))
+      );
+    }
+
+    /// <summary>Throws an exception if another matrix differs in size</summary>
+    /// <param name="other">Matrix that will be compared to this one</param>
+    private: void requireSameSize(const Matrix2D &other) const {
+      bool dimensionsMatch = (
+        (this->width == other.width) &&
+        (this->height == other.height) &&
+        (this->planeCount == other.planeCount)
+      );
+      if(!dimensionsMatch) {
+        throw std::invalid_argument(u8"Matrices must have the same size");
+      }
+    }
+
+    /// <summary>Width of the matrix</summary>
+    private: std::size_t width;
+    /// <summary>Height of the matrix</summary>
+    private: std::size_t height;
+    /// <summary>Number of planes in the matrix</summary>
+    private: std::size_t planeCount;
+    /// <summary>Number of elements from the start of one row to the next</summary>
+    private: std::size_t stride;
+    /// <summary>Number of elements from the start of one plane to the next</summary>
+    private: std::size_t planeSize;
+    /// <summary>Aligned memory holding the elements of all planes</summary>
+    private: TElement *elements;
+
+  };
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Sets all elements in all planes of the matrix to the specified value</summary>
+  /// <param name="value">Value all elements will be set to</param>
+  template<> void Matrix2D<float>::Fill(const float &value);
+
+  /// <summary>Adds the elements of another matrix to this matrix' elements</summary>
+  /// <param name="other">Matrix whose elements will be added</param>
+  template<> void Matrix2D<float>::Add(const Matrix2D<float> &other);
+
+  /// <summary>Multiplies the elements of this matrix with another matrix' elements</summary>
+  /// <param name="other">Matrix whose elements will be multiplied with</param>
+  template<> void Matrix2D<float>::Multiply(const Matrix2D<float> &other);
+
+  /// <summary>Multiplies all elements in the matrix by the specified factor</summary>
+  /// <param name="factor">Factor all elements will be multiplied by</param>
+  template<> void Matrix2D<float>::Multiply(const float &factor);
+
+  /// <summary>Divides all elements in the matrix by the specified divisor</summary>
+  /// <param name="divisor">Divisor all elements will be divided by</param>
+  template<> void Matrix2D<float>::Divide(const float &divisor);
+
+  // ------------------------------------------------------------------------------------------- //
+
+} // namespace Nuclex::FrameFixer::Algorithm
+
+#endif // NUCLEX_FRAMEFIXER_ALGORITHM_MATRIX2D_H
@@ -0,0 +1,103 @@
+#pragma region Apache License 2.0
+/*
+Nuclex Frame Fixer
+Copyright (C) 2024 Markus Ewald / Nuclex Development Labs
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#pragma endregion // Apache License 2.0
+
+
+#ifndef NUCLEX_FRAMEFIXER_ALGORITHM_PARALLELBANDS_H
+#define NUCLEX_FRAMEFIXER_ALGORITHM_PARALLELBANDS_H
+
+#include "Nuclex/FrameFixer/Config.h"
+
+#include <algorithm> // for std::min()
+#include <cstddef> // for std::size_t
+#include <thread> // for std::thread
+#include <vector> // for std::vector
+
+namespace Nuclex::FrameFixer::Algorithm {
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Splits images into horizontal bands that are processed in parallel</summary>
+  /// <remarks>
+  ///   Threads are started for each call and joined before it returns, which costs far
+  ///   less than processing the smallest band that is handed to a thread of its own.
+  ///   The calling thread processes the first band itself.
+  /// </remarks>
+  class ParallelBands {
+
+    /// <summary>Fewest pixels worth handing to a thread of their own</summary>
+    public: static constexpr std::size_t MinimumPixelsPerBand = 65536;
+
+    /// <summary>Calls a method for each band of an image, in parallel</summary>
+    /// <typeparam name="TMethod">Method that will be called for each band</typeparam>
+    /// <param name="lineCount">Number of lines in the image</param>
+    /// <param name="lineWidth">Number of pixels in each line</param>
+    /// <param name="threadCount">Highest number of threads that may be used</param>
+    /// <param name="processBand">
+    ///   Method that will be called with the index of the first line and the index one
+    ///   past the last line of each band. Must not throw.
+    /// </param>
+    public: template<typename TMethod>
+    static void Process(
+      std::size_t lineCount,
+      std::size_t lineWidth,
+      std::size_t threadCount,
+      const TMethod &processBand
+    ) {
+      std::size_t bandCount = std::min(
+        std::min(threadCount, lineCount * lineWidth / MinimumPixelsPerBand), lineCount
+      );
+      if(bandCount < 2) {
+        processBand(std::size_t(0), lineCount);
+        return;
+      }
+
+      std::vector<std::thread> threads;
+      threads.reserve(bandCount - 1);
+      try {
+        for(std::size_t bandIndex = 1; bandIndex < bandCount; ++bandIndex) {
+          threads.emplace_back(
+            [&processBand, bandIndex, bandCount, lineCount]() {
+              processBand(
+                bandIndex * lineCount / bandCount, (bandIndex + 1) * lineCount / bandCount
+              );
+            }
+          );
+        }
+      }
+      catch(...) {
+        for(std::size_t index = 0; index < threads.size(); ++index) {
+          threads[index].join();
+        }
+        throw;
+      }
+
+      processBand(std::size_t(0), lineCount / bandCount);
+
+      for(std::size_t index = 0; index < threads.size(); ++index) {
+        threads[index].join();
+      }
+    }
+
+  };
+
+  // ------------------------------------------------------------------------------------------- //
+
+} // namespace Nuclex::FrameFixer::Algorithm
+
+#endif // NUCLEX_FRAMEFIXER_ALGORITHM_PARALLELBANDS_H
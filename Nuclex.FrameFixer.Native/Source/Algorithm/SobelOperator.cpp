@@ -0,0 +1,322 @@
+#pragma region Apache License 2.0
+/*
+Nuclex Frame Fixer
+Copyright (C) 2024 Markus Ewald / Nuclex Development Labs
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#pragma endregion // Apache License 2.0
+
+// If the application is compiled as a DLL, this ensures symbols are exported
+#define NUCLEX_FRAMEFIXER_SOURCE 1
+
+#include "./SobelOperator.h"
+#include "../Rendering/FrameBuffer.h"
+#include "../Platform/CpuFeatures.h"
+
+#include <stdexcept> // for std::invalid_argument
+#include <vector> // for std::vector
+
+#if defined(NUCLEX_FRAMEFIXER_HAVE_SSE2)
+  #include <emmintrin.h> // for SSE2 intrinsics
+#endif
+#if defined(NUCLEX_FRAMEFIXER_HAVE_AVX2)
+  #include <immintrin.h> // for AVX intrinsics
+#endif
+
+namespace {
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Index passed instead of a color channel to extract the luminance</summary>
+  const std::size_t LumaChannel = 3;
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Extracts one color channel of a row of pixels as normalized floats</summary>
+  /// <param name="frame">Frame from which a row of pixels will be read</param>
+  /// <param name="lineIndex">Index of the row that will be read</param>
+  /// <param name="channel">Channel (0: red, 1: green, 2: blue, 3: luma)</param>
+  /// <param name="target">Receives the channel value of each pixel</param>
+  void loadChannelRow(
+    const Nuclex::FrameFixer::Rendering::FrameBuffer &frame,
+    std::size_t lineIndex,
+    std::size_t channel,
+    float *target
+  ) {
+    using Nuclex::FrameFixer::Rendering::FrameLayout;
+
+    std::size_t width = static_cast<std::size_t>(frame.GetWidth());
+    if(channel == LumaChannel) {
+      std::vector<float> green(width), blue(width);
+      loadChannelRow(frame, lineIndex, 0, target);
+      loadChannelRow(frame, lineIndex, 1, green.data());
+      loadChannelRow(frame, lineIndex, 2, blue.data());
+      for(std::size_t x = 0; x < width; ++x) {
+        target[x] = target[x] * 0.2126f + green[x] * 0.7152f + blue[x] * 0.0722f;
+      }
+      return;
+    }
+
+    if(frame.GetLayout() == FrameLayout::Planar) {
+      if(frame.HasSixteenBitChannels()) {
+        const std::uint16_t *values = reinterpret_cast<const std::uint16_t *>(
+          frame.GetRow(lineIndex, channel)
+        );
+        for(std::size_t x = 0; x < width; ++x) {
+          target[x] = static_cast<float>(values[x]) * (1.0f / 65535.0f);
+        }
+      } else {
+        const std::uint8_t *values = frame.GetRow(lineIndex, channel);
+        for(std::size_t x = 0; x < width; ++x) {
+          target[x] = static_cast<float>(values[x]) * (1.0f / 255.0f);
+        }
+      }
+    } else if(frame.HasSixteenBitChannels()) { // Interleaved R, G, B, A
+      const std::uint16_t *values = reinterpret_cast<const std::uint16_t *>(
+        frame.GetRow(lineIndex)
+      ) + channel;
+      for(std::size_t x = 0; x < width; ++x) {
+        target[x] = static_cast<float>(values[x * 4]) * (1.0f / 65535.0f);
+      }
+    } else { // Interleaved QRgb, 0xAARRGGBB
+      const std::uint32_t *pixels = reinterpret_cast<const std::uint32_t *>(
+        frame.GetRow(lineIndex)
+      );
+      unsigned int shift = static_cast<unsigned int>(16 - channel * 8);
+      for(std::size_t x = 0; x < width; ++x) {
+        target[x] = static_cast<float>((pixels[x] >> shift) & 0xFF) * (1.0f / 255.0f);
+      }
+    }
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+#if defined(NUCLEX_FRAMEFIXER_HAVE_AVX2)
+  /// <summary>Applies the Sobel operator to a row of values using AVX</summary>
+  /// <param name="above">Values in the row above, readable one before and after</param>
+  /// <param name="center">Values in the row itself, readable one before and after</param>
+  /// <param name="below">Values in the row below, readable one before and after</param>
+  /// <param name="horizontal">Receives the horizontal gradient of each value</param>
+  /// <param name="vertical">Receives the vertical gradient of each value</param>
+  /// <param name="count">Number of values that should be processed</param>
+  /// <returns>The number of values that have been processed</returns>
+  NUCLEX_FRAMEFIXER_AVX2_FUNCTION std::size_t sobelRowAvx(
+    const float *above, const float *center, const float *below,
+    float *horizontal, float *vertical,
+    std::size_t count
+  ) {
+    const __m256 two = _mm256_set1_ps(2.0f);
+
+    std::size_t index = 0;
+    for(; index + 8 <= count; index += 8) {
+      __m256 aboveLeft = _mm256_loadu_ps(above + index - 1);
+      __m256 aboveRight = _mm256_loadu_ps(above + index + 1);
+      __m256 belowLeft = _mm256_loadu_ps(below + index - 1);
+      __m256 belowRight = _mm256_loadu_ps(below + index + 1);
+
+      __m256 horizontalSum = _mm256_add_ps(
+        _mm256_add_ps(
+          _mm256_sub_ps(aboveRight, aboveLeft), _mm256_sub_ps(belowRight, belowLeft)
+        ),
+        _mm256_mul_ps(
+          two,
+          _mm256_sub_ps(_mm256_loadu_ps(center + index + 1), _mm256_loadu_ps(center + index - 1))
+        )
+      );
+      __m256 verticalSum = _mm256_add_ps(
+        _mm256_add_ps(
+          _mm256_sub_ps(belowLeft, aboveLeft), _mm256_sub_ps(belowRight, aboveRight)
+        ),
+        _mm256_mul_ps(
+          two,
+          _mm256_sub_ps(_mm256_loadu_ps(below + index), _mm256_loadu_ps(above + index))
+        )
+      );
+
+      _mm256_storeu_ps(horizontal + index, horizontalSum);
+      _mm256_storeu_ps(vertical + index, verticalSum);
+    }
+
+    return index;
+  }
+#endif // defined(NUCLEX_FRAMEFIXER_HAVE_AVX2)
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Applies the Sobel operator to a row of values</summary>
+  /// <param name="above">Values in the row above, readable one before and after</param>
+  /// <param name="center">Values in the row itself, readable one before and after</param>
+  /// <param name="below">Values in the row below, readable one before and after</param>
+  /// <param name="horizontal">Receives the horizontal gradient of each value</param>
+  /// <param name="vertical">Receives the vertical gradient of each value</param>
+  /// <param name="count">Number of values that will be processed</param>
+  void sobelRow(
+    const float *above, const float *center, const float *below,
+    float *horizontal, float *vertical,
+    std::size_t count
+  ) {
+    std::size_t index = 0;
+
+#if defined(NUCLEX_FRAMEFIXER_HAVE_AVX2)
+    if(Nuclex::FrameFixer::Platform::CpuFeatures::HasAvx2()) {
+      index = sobelRowAvx(above, center, below, horizontal, vertical, count);
+    }
+#endif // defined(NUCLEX_FRAMEFIXER_HAVE_AVX2)
+
+#if defined(NUCLEX_FRAMEFIXER_HAVE_SSE2)
+    const __m128 two = _mm_set1_ps(2.0f);
+    for(; index + 4 <= count; index += 4) {
+      __m128 aboveLeft = _mm_loadu_ps(above + index - 1);
+      __m128 aboveRight = _mm_loadu_ps(above + index + 1);
+      __m128 belowLeft = _mm_loadu_ps(below + index - 1);
+      __m128 belowRight = _mm_loadu_ps(below + index + 1);
+
+      __m128 horizontalSum = _mm_add_ps(
+        _mm_add_ps(_mm_sub_ps(aboveRight, aboveLeft), _mm_sub_ps(belowRight, belowLeft)),
+        _mm_mul_ps(
+          two, _mm_sub_ps(_mm_loadu_ps(center + index + 1), _mm_loadu_ps(center + index - 1))
+        )
+      );
+      __m128 verticalSum = _mm_add_ps(
+        _mm_add_ps(_mm_sub_ps(belowLeft, aboveLeft), _mm_sub_ps(belowRight, aboveRight)),
+        _mm_mul_ps(two, _mm_sub_ps(_mm_loadu_ps(below + index), _mm_loadu_ps(above + index)))
+      );
+
+      _mm_storeu_ps(horizontal + index, horizontalSum);
+      _mm_storeu_ps(vertical + index, verticalSum);
+    }
+#endif // defined(NUCLEX_FRAMEFIXER_HAVE_SSE2)
+
+    for(; index < count; ++index) {
+      horizontal[index] = (
+        (above[index + 1] - above[index - 1]) +
+        (below[index + 1] - below[index - 1]) +
+        2.0f * (center[index + 1] - center[index - 1])
+      );
+      vertical[index] = (
+        (below[index - 1] - above[index - 1]) +
+        (below[index + 1] - above[index + 1]) +
+        2.0f * (below[index] - above[index])
+      );
+    }
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Calculates the gradients of one channel of a frame</summary>
+  /// <param name="frame">Frame whose gradients will be calculated</param>
+  /// <param name="channel">Channel (0: red, 1: green, 2: blue, 3: luma)</param>
+  /// <param name="gradients">Matrix that receives the gradients</param>
+  /// <param name="firstPlane">
+  ///   Plane receiving the horizontal gradients, the vertical ones go into the next
+  /// </param>
+  /// <remarks>
+  ///   Only three rows of the channel are kept in memory at any time. Each one has
+  ///   an extra value before and after it that repeats the value on the border.
+  /// </remarks>
+  void calculateChannelGradients(
+    const Nuclex::FrameFixer::Rendering::FrameBuffer &frame,
+    std::size_t channel,
+    Nuclex::FrameFixer::Algorithm::Matrix2D<float> &gradients,
+    std::size_t firstPlane
+  ) {
+    std::size_t width = static_cast<std::size_t>(frame.GetWidth());
+    std::size_t height = static_cast<std::size_t>(frame.GetHeight());
+    if((width == 0) || (height == 0)) {
+      return;
+    }
+
+    std::size_t rowLength = width + 2;
+    std::vector<float> rowBuffer(rowLength * 3);
+
+    // Loads a row into the slot it occupies in the three row ring buffer
+    auto loadRow = [&](std::size_t lineIndex) {
+      float *row = rowBuffer.data() + (lineIndex % 3) * rowLength;
+      loadChannelRow(frame, lineIndex, channel, row + 1);
+      row[0] = row[1];
+      row[width + 1] = row[width];
+    };
+    auto getRow = [&](std::size_t lineIndex) {
+      return rowBuffer.data() + (lineIndex % 3) * rowLength + 1;
+    };
+
+    loadRow(0);
+    for(std::size_t lineIndex = 0; lineIndex < height; ++lineIndex) {
+      if(lineIndex + 1 < height) {
+        loadRow(lineIndex + 1);
+      }
+
+      const float *above = getRow((lineIndex == 0) ? 0 : (lineIndex - 1));
+      const float *below = getRow((lineIndex + 1 < height) ? (lineIndex + 1) : lineIndex);
+      sobelRow(
+        above, getRow(lineIndex), below,
+        gradients.GetRow(lineIndex, firstPlane),
+        gradients.GetRow(lineIndex, firstPlane + 1),
+        width
+      );
+    }
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Throws an exception if a matrix can't hold the gradients of a frame</summary>
+  /// <param name="frame">Frame whose gradients will be calculated</param>
+  /// <param name="gradients">Matrix that will receive the gradients</param>
+  /// <param name="planeCount">Number of planes the matrix needs to have</param>
+  void requireMatchingMatrix(
+    const Nuclex::FrameFixer::Rendering::FrameBuffer &frame,
+    const Nuclex::FrameFixer::Algorithm::Matrix2D<float> &gradients,
+    std::size_t planeCount
+  ) {
+    bool dimensionsMatch = (
+      (gradients.GetWidth() == static_cast<std::size_t>(frame.GetWidth())) &&
+      (gradients.GetHeight() == static_cast<std::size_t>(frame.GetHeight())) &&
+      (gradients.GetPlaneCount() == planeCount)
+    );
+    if(!dimensionsMatch) {
+      throw std::invalid_argument(
+        u8"Gradient matrix must match the frame's size and have one plane per gradient"
+      );
+    }
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+} // anonymous namespace
+
+namespace Nuclex::FrameFixer::Algorithm {
+
+  // ------------------------------------------------------------------------------------------- //
+
+  void SobelOperator::CalculateLumaGradients(
+    const Rendering::FrameBuffer &frame, Matrix2D<float> &gradients
+  ) {
+    requireMatchingMatrix(frame, gradients, 2);
+    calculateChannelGradients(frame, LumaChannel, gradients, 0);
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  void SobelOperator::CalculateRgbGradients(
+    const Rendering::FrameBuffer &frame, Matrix2D<float> &gradients
+  ) {
+    requireMatchingMatrix(frame, gradients, 6);
+    for(std::size_t channel = 0; channel < 3; ++channel) {
+      calculateChannelGradients(frame, channel, gradients, channel * 2);
+    }
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+} // namespace Nuclex::FrameFixer::Algorithm
@@ -0,0 +1,83 @@
+#pragma region Apache License 2.0
+/*
+Nuclex Frame Fixer
+Copyright (C) 2024 Markus Ewald / Nuclex Development Labs
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#pragma endregion // Apache License 2.0
+
+
+#ifndef NUCLEX_FRAMEFIXER_ALGORITHM_SOBELOPERATOR_H
+#define NUCLEX_FRAMEFIXER_ALGORITHM_SOBELOPERATOR_H
+
+#include "Nuclex/FrameFixer/Config.h"
+#include "./Matrix2D.h"
+
+namespace Nuclex::FrameFixer::Rendering {
+
+  // ------------------------------------------------------------------------------------------- //
+
+  class FrameBuffer;
+
+  // ------------------------------------------------------------------------------------------- //
+
+} // namespace Nuclex::FrameFixer::Rendering
+
+namespace Nuclex::FrameFixer::Algorithm {
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Calculates the gradients of the pixels in a frame with the Sobel operator</summary>
+  /// <remarks>
+  ///   <para>
+  ///     Channels are normalized to the range 0.0 to 1.0 before the gradients are
+  ///     calculated, so frames with 8 and 16 bits per channel produce gradients on
+  ///     the same scale. Pixels outside of the frame are assumed to repeat the pixels
+  ///     on its border.
+  ///   </para>
+  ///   <para>
+  ///     The gradients are stored in the planes of a float matrix in the same order
+  ///     as the members of <see cref="Gradient" /> or <see cref="RgbGradient" />.
+  ///     The matrix can be reused for any number of frames of the same size.
+  ///   </para>
+  /// </remarks>
+  class SobelOperator {
+
+    /// <summary>Calculates the gradients of the frame's (BT.709) luminance</summary>
+    /// <param name="frame">Frame whose gradients will be calculated</param>
+    /// <param name="gradients">
+    ///   Matrix of the frame's size with two planes that receives the horizontal and
+    ///   vertical gradient of each pixel
+    /// </param>
+    public: static void CalculateLumaGradients(
+      const Rendering::FrameBuffer &frame, Matrix2D<float> &gradients
+    );
+
+    /// <summary>Calculates the gradients of each of the frame's color channels</summary>
+    /// <param name="frame">Frame whose gradients will be calculated</param>
+    /// <param name="gradients">
+    ///   Matrix of the frame's size with six planes that receives the horizontal and
+    ///   vertical gradient of the red, green and blue channel of each pixel
+    /// </param>
+    public: static void CalculateRgbGradients(
+      const Rendering::FrameBuffer &frame, Matrix2D<float> &gradients
+    );
+
+  };
+
+  // ------------------------------------------------------------------------------------------- //
+
+} // namespace Nuclex::FrameFixer::Algorithm
+
+#endif // NUCLEX_FRAMEFIXER_ALGORITHM_SOBELOPERATOR_H
@@ -0,0 +1,341 @@
+#pragma region Apache License 2.0
+/*
+Nuclex Frame Fixer
+Copyright (C) 2024 Markus Ewald / Nuclex Development Labs
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#pragma endregion // Apache License 2.0
+
+
+// If the application is compiled as a DLL, this ensures symbols are exported
+#define NUCLEX_FRAMEFIXER_SOURCE 1
+
+#include "./TraceRecorder.h"
+
+#include <QCoreApplication> // for QCoreApplication::applicationPid()
+#include <QFile>
+
+#include <Nuclex/Support/Text/LexicalAppend.h> // for lexical_append()
+
+#include <cstdint> // for std::int64_t
+#include <memory> // for std::shared_ptr
+#include <mutex> // for std::mutex
+#include <stdexcept> // for std::runtime_error
+#include <string> // for std::string
+#include <vector> // for std::vector
+
+namespace {
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>A span of time recorded by a thread</summary>
+  struct TraceSpan {
+
+    /// <summary>Category the span belongs to</summary>
+    public: const char *Category;
+    /// <summary>Name of the span</summary>
+    public: const char *Name;
+    /// <summary>Nanoseconds since the steady clock's epoch at which the span began</summary>
+    public: std::int64_t StartNanoseconds;
+    /// <summary>Length of the span in nanoseconds</summary>
+    public: std::int64_t DurationNanoseconds;
+
+  };
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Spans recorded by a single thread</summary>
+  struct ThreadBuffer {
+
+    /// <summary>Must be held while accessing the buffer</summary>
+    /// <remarks>
+    ///   Only the owning thread and <see cref="TraceRecorder.Save" /> ever take this,
+    ///   so recording a span almost never has to wait.
+    /// </remarks>
+    public: std::mutex Mutex;
+    /// <summary>Number by which the thread is identified in the trace</summary>
+    public: std::size_t ThreadId;
+    /// <summary>Name of the thread, empty if it was not named</summary>
+    public: std::string ThreadName;
+    /// <summary>Spans the thread has recorded</summary>
+    public: std::vector<TraceSpan> Spans;
+    /// <summary>Number of spans dropped because the buffer was full</summary>
+    public: std::size_t DroppedSpanCount;
+
+  };
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Buffers of all threads that have recorded spans</summary>
+  struct RecorderState {
+
+    /// <summary>Must be held while accessing the list of buffers</summary>
+    public: std::mutex Mutex;
+    /// <summary>Buffers of all threads that have recorded spans</summary>
+    public: std::vector<std::shared_ptr<ThreadBuffer>> Buffers;
+    /// <summary>Identifier that will be assigned to the next thread</summary>
+    public: std::size_t NextThreadId = 1;
+    /// <summary>Point in time at which recording was started</summary>
+    public: std::chrono::steady_clock::time_point StartTime;
+
+  };
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Returns the shared state of the trace recorder</summary>
+  /// <returns>The trace recorder's state</returns>
+  RecorderState &getRecorderState() {
+    static RecorderState state;
+    return state;
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Buffer of the calling thread, created when it first records a span</summary>
+  /// <remarks>
+  ///   The recorder state keeps its own reference, so spans of threads that have ended
+  ///   remain available until the next recording is started.
+  /// </remarks>
+  thread_local std::shared_ptr<ThreadBuffer> currentThreadBuffer;
+
+  /// <summary>Name the calling thread was given, copied into its buffer when created</summary>
+  /// <remarks>
+  ///   Threads are named when they start, which mostly happens while nothing is being
+  ///   recorded. Keeping the name here means those threads don't register a buffer
+  ///   that would otherwise be kept around until the next recording is started.
+  /// </remarks>
+  thread_local std::string currentThreadName;
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Returns the buffer of the calling thread, creating it if needed</summary>
+  /// <returns>The calling thread's span buffer</returns>
+  ThreadBuffer &getCurrentThreadBuffer() {
+    if(!static_cast<bool>(currentThreadBuffer)) {
+      std::shared_ptr<ThreadBuffer> buffer = std::make_shared<ThreadBuffer>();
+      buffer->ThreadName = currentThreadName;
+      buffer->DroppedSpanCount = 0;
+
+      RecorderState &state = getRecorderState();
+      {
+        std::unique_lock<std::mutex> stateLock(state.Mutex);
+        buffer->ThreadId = state.NextThreadId++;
+        state.Buffers.push_back(buffer);
+      }
+
+      currentThreadBuffer = std::move(buffer);
+    }
+
+    return *currentThreadBuffer;
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Appends a string to a JSON document, quoting and escaping it</summary>
+  /// <param name="target">JSON document the string will be appended to</param>
+  /// <param name="text">String that will be appended</param>
+  void appendJsonString(std::string &target, const char *text) {
+    target.push_back(u8'"');
+    for(; *text != 0; ++text) {
+      if((*text == u8'"') || (*text == u8'\\')) {
+        target.push_back(u8'\\');
+        target.push_back(*text);
+      } else if(static_cast<unsigned char>(*text) >= 0x20) {
+        target.push_back(*text);
+      }
+    }
+    target.push_back(u8'"');
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Appends the process and thread identifiers of an event</summary>
+  /// <param name="target">JSON document the identifiers will be appended to</param>
+  /// <param name="processId">Identifier of the process that recorded the event</param>
+  /// <param name="threadId">Identifier of the thread that recorded the event</param>
+  void appendEventOwner(std::string &target, std::uint64_t processId, std::size_t threadId) {
+    target.append(u8",\"pid\":", 7);
+    Nuclex::Support::Text::lexical_append(target, processId);
+    target.append(u8",\"tid\":", 7);
+    Nuclex::Support::Text::lexical_append(target, threadId);
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+} // anonymous namespace
+
+namespace Nuclex::FrameFixer::Diagnostics {
+
+  // ------------------------------------------------------------------------------------------- //
+
+  const std::size_t TraceRecorder::MaximumSpansPerThread = 4 * 1024 * 1024;
+
+  // ------------------------------------------------------------------------------------------- //
+
+  std::atomic<bool> TraceRecorder::recording(false);
+
+  // ------------------------------------------------------------------------------------------- //
+
+  void TraceRecorder::Start() {
+    RecorderState &state = getRecorderState();
+    {
+      std::unique_lock<std::mutex> stateLock(state.Mutex);
+
+      // Buffers nobody but us holds on to belong to threads that have ended
+      std::size_t keptBufferCount = 0;
+      for(std::size_t index = 0; index < state.Buffers.size(); ++index) {
+        if(state.Buffers[index].use_count() >= 2) {
+          {
+            std::unique_lock<std::mutex> bufferLock(state.Buffers[index]->Mutex);
+            state.Buffers[index]->Spans.clear();
+            state.Buffers[index]->DroppedSpanCount = 0;
+          }
+          state.Buffers[keptBufferCount++] = state.Buffers[index];
+        }
+      }
+      state.Buffers.resize(keptBufferCount);
+
+      state.StartTime = std::chrono::steady_clock::now();
+    }
+
+    recording.store(true, std::memory_order_release);
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  void TraceRecorder::Stop() {
+    recording.store(false, std::memory_order_release);
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  void TraceRecorder::Save(const std::string &path) {
+    std::uint64_t processId = static_cast<std::uint64_t>(QCoreApplication::applicationPid());
+
+    std::string json(u8"{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n", 40);
+    json.append(u8"{\"name\":\"process_name\",\"ph\":\"M\"", 31);
+    appendEventOwner(json, processId, 0);
+    json.append(u8",\"args\":{\"name\":\"Nuclex Frame Fixer\"}}", 38);
+
+    RecorderState &state = getRecorderState();
+    {
+      std::unique_lock<std::mutex> stateLock(state.Mutex);
+      std::int64_t startNanoseconds = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        state.StartTime.time_since_epoch()
+      ).count();
+
+      for(const std::shared_ptr<ThreadBuffer> &buffer : state.Buffers) {
+        std::unique_lock<std::mutex> bufferLock(buffer->Mutex);
+
+        if(!buffer->ThreadName.empty()) {
+          json.append(u8",\n{\"name\":\"thread_name\",\"ph\":\"M\"", 32);
+          appendEventOwner(json, processId, buffer->ThreadId);
+          json.append(u8",\"args\":{\"name\":", 16);
+          appendJsonString(json, buffer->ThreadName.c_str());
+          json.append(u8"}}", 2);
+        }
+
+        // Complete events ("X") carry their start time and duration, timestamps
+        // are in microseconds but may have fractions
+        for(const TraceSpan &span : buffer->Spans) {
+          json.append(u8",\n{\"name\":", 10);
+          appendJsonString(json, span.Name);
+          json.append(u8",\"cat\":", 7);
+          appendJsonString(json, span.Category);
+          json.append(u8",\"ph\":\"X\",\"ts\":", 15);
+          Nuclex::Support::Text::lexical_append(
+            json, static_cast<double>(span.StartNanoseconds - startNanoseconds) / 1000.0
+          );
+          json.append(u8",\"dur\":", 7);
+          Nuclex::Support::Text::lexical_append(
+            json, static_cast<double>(span.DurationNanoseconds) / 1000.0
+          );
+          appendEventOwner(json, processId, buffer->ThreadId);
+          json.push_back(u8'}');
+        }
+
+        if(buffer->DroppedSpanCount > 0) {
+          json.append(u8",\n{\"name\":\"dropped spans\",\"ph\":\"i\",\"s\":\"t\",\"ts\":0", 49);
+          appendEventOwner(json, processId, buffer->ThreadId);
+          json.append(u8",\"args\":{\"count\":", 17);
+          Nuclex::Support::Text::lexical_append(json, buffer->DroppedSpanCount);
+          json.append(u8"}}", 2);
+        }
+      }
+    }
+
+    json.append(u8"\n]}\n", 4);
+
+    QFile traceFile(QString::fromStdString(path));
+    bool written = traceFile.open(
+      QIODevice::OpenModeFlag::WriteOnly | QIODevice::OpenModeFlag::Truncate
+    );
+    if(written) {
+      qint64 writtenByteCount = traceFile.write(json.data(), json.length());
+      written = (writtenByteCount == static_cast<qint64>(json.length()));
+    }
+    if(!written) {
+      std::string message(u8"Could not write trace file '", 28);
+      message.append(path);
+      message.append(u8"'", 1);
+      throw std::runtime_error(message);
+    }
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  void TraceRecorder::NameCurrentThread(const std::string &name) {
+    currentThreadName = name;
+
+    // If the thread already recorded spans, its buffer needs to be renamed, too
+    if(static_cast<bool>(currentThreadBuffer)) {
+      std::unique_lock<std::mutex> bufferLock(currentThreadBuffer->Mutex);
+      currentThreadBuffer->ThreadName = name;
+    }
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  void TraceRecorder::RecordSpan(
+    const char *category,
+    const char *name,
+    std::chrono::steady_clock::time_point startTime,
+    std::chrono::steady_clock::time_point endTime
+  ) {
+    if(!IsRecording()) {
+      return; // Recording was stopped while the span was open
+    }
+
+    ThreadBuffer &buffer = getCurrentThreadBuffer();
+    std::unique_lock<std::mutex> bufferLock(buffer.Mutex);
+    if(buffer.Spans.size() >= MaximumSpansPerThread) {
+      ++buffer.DroppedSpanCount;
+      return;
+    }
+
+    buffer.Spans.push_back(
+      TraceSpan {
+        category,
+        name,
+        std::chrono::duration_cast<std::chrono::nanoseconds>(
+          startTime.time_since_epoch()
+        ).count(),
+        std::chrono::duration_cast<std::chrono::nanoseconds>(endTime - startTime).count()
+      }
+    );
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+} // namespace Nuclex::FrameFixer::Diagnostics
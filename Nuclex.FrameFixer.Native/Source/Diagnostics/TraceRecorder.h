@@ -0,0 +1,174 @@
+#pragma region Apache License 2.0
+/*
+Nuclex Frame Fixer
+Copyright (C) 2024 Markus Ewald / Nuclex Development Labs
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#pragma endregion // Apache License 2.0
+
+
+#ifndef NUCLEX_FRAMEFIXER_DIAGNOSTICS_TRACERECORDER_H
+#define NUCLEX_FRAMEFIXER_DIAGNOSTICS_TRACERECORDER_H
+
+#include "Nuclex/FrameFixer/Config.h"
+
+#include <atomic> // for std::atomic
+#include <chrono> // for std::chrono::steady_clock
+#include <string> // for std::string
+
+// --------------------------------------------------------------------------------------------- //
+
+#if defined(NUCLEX_FRAMEFIXER_ENABLE_TRACING)
+
+/// <summary>Helper that pastes two tokens together after expanding them</summary>
+#define NUCLEX_FRAMEFIXER_TRACE_CONCAT_INNER(left, right) left##right
+
+/// <summary>Helper that pastes two tokens together after expanding them</summary>
+#define NUCLEX_FRAMEFIXER_TRACE_CONCAT(left, right) \
+  NUCLEX_FRAMEFIXER_TRACE_CONCAT_INNER(left, right)
+
+/// <summary>Records a span from this point until the end of the enclosing scope</summary>
+/// <param name="category">Category of the span, must be a string literal</param>
+/// <param name="name">Name of the span, must be a string literal</param>
+#define NUCLEX_FRAMEFIXER_TRACE_SCOPE(category, name) \
+  ::Nuclex::FrameFixer::Diagnostics::TraceScope NUCLEX_FRAMEFIXER_TRACE_CONCAT( \
+    traceScope, __LINE__ \
+  )(category, name)
+
+#else
+
+/// <summary>Records a span from this point until the end of the enclosing scope</summary>
+/// <param name="category">Category of the span, must be a string literal</param>
+/// <param name="name">Name of the span, must be a string literal</param>
+#define NUCLEX_FRAMEFIXER_TRACE_SCOPE(category, name) do {} while(false)
+
+#endif // defined(NUCLEX_FRAMEFIXER_ENABLE_TRACING)
+
+// --------------------------------------------------------------------------------------------- //
+
+namespace Nuclex::FrameFixer::Diagnostics {
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Records spans of time in the Chrome / Perfetto trace event format</summary>
+  /// <remarks>
+  ///   <para>
+  ///     While recording is stopped, each span costs a single relaxed atomic load.
+  ///     While recording, each thread appends its spans to a buffer of its own, so
+  ///     threads never wait on each other. Buffers are only merged when the trace is saved.
+  ///   </para>
+  ///   <para>
+  ///     The saved file can be opened in chrome://tracing or https://ui.perfetto.dev
+  ///     and shows each thread as a row of nested spans, which makes stalls and places
+  ///     where threads wait on each other easy to spot.
+  ///   </para>
+  ///   <para>
+  ///     Category and span names are stored as pointers, so they must be string literals
+  ///     or otherwise outlive the recording.
+  ///   </para>
+  /// </remarks>
+  class TraceRecorder {
+
+    /// <summary>Maximum number of spans recorded per thread</summary>
+    /// <remarks>
+    ///   Keeps a forgotten recording from eating up all memory. Spans beyond this limit
+    ///   are dropped and the number of dropped spans is noted in the saved trace.
+    /// </remarks>
+    public: static const std::size_t MaximumSpansPerThread;
+
+    /// <summary>Discards any previously recorded spans and begins recording</summary>
+    public: static void Start();
+
+    /// <summary>Stops recording, keeping the spans recorded so far</summary>
+    public: static void Stop();
+
+    /// <summary>Checks whether spans are currently being recorded</summary>
+    /// <returns>True if spans are being recorded</returns>
+    public: static bool IsRecording() {
+      return recording.load(std::memory_order_relaxed);
+    }
+
+    /// <summary>Saves all recorded spans as a trace event JSON file</summary>
+    /// <param name="path">Path of the file the trace will be saved in</param>
+    public: static void Save(const std::string &path);
+
+    /// <summary>Assigns a name to the calling thread that will appear in the trace</summary>
+    /// <param name="name">Name under which the thread will be shown</param>
+    /// <remarks>
+    ///   This is cheap enough to call from every thread that is started. The thread
+    ///   only appears in the trace once it records a span while recording is on.
+    /// </remarks>
+    public: static void NameCurrentThread(const std::string &name);
+
+    /// <summary>Records a span of time in the calling thread</summary>
+    /// <param name="category">Category the span belongs to</param>
+    /// <param name="name">Name of the span</param>
+    /// <param name="startTime">Point in time at which the span began</param>
+    /// <param name="endTime">Point in time at which the span ended</param>
+    public: static void RecordSpan(
+      const char *category,
+      const char *name,
+      std::chrono::steady_clock::time_point startTime,
+      std::chrono::steady_clock::time_point endTime
+    );
+
+    /// <summary>Whether spans are currently being recorded</summary>
+    private: static std::atomic<bool> recording;
+
+  };
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Records a span from its construction until it is destroyed</summary>
+  /// <remarks>
+  ///   Use the <see cref="NUCLEX_FRAMEFIXER_TRACE_SCOPE" /> macro rather than this class
+  ///   so that tracing can be removed entirely at compile time.
+  /// </remarks>
+  class TraceScope {
+
+    /// <summary>Begins a span if recording is enabled</summary>
+    /// <param name="category">Category the span belongs to</param>
+    /// <param name="name">Name of the span</param>
+    public: TraceScope(const char *category, const char *name) :
+      category(category),
+      name(name),
+      startTime() {
+      if(TraceRecorder::IsRecording()) {
+        this->startTime = std::chrono::steady_clock::now();
+      }
+    }
+
+    /// <summary>Ends the span and records it</summary>
+    public: ~TraceScope() {
+      if(this->startTime != std::chrono::steady_clock::time_point()) {
+        TraceRecorder::RecordSpan(
+          this->category, this->name, this->startTime, std::chrono::steady_clock::now()
+        );
+      }
+    }
+
+    /// <summary>Category the span belongs to</summary>
+    private: const char *category;
+    /// <summary>Name of the span</summary>
+    private: const char *name;
+    /// <summary>Point in time the span began at, default if not recording</summary>
+    private: std::chrono::steady_clock::time_point startTime;
+
+  };
+
+  // ------------------------------------------------------------------------------------------- //
+
+} // namespace Nuclex::FrameFixer::Diagnostics
+
+#endif // NUCLEX_FRAMEFIXER_DIAGNOSTICS_TRACERECORDER_H
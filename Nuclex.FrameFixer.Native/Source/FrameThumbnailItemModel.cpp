@@ -23,9 +23,56 @@ limitations under the License.
 #include "FrameThumbnailItemModel.h"
 
 #include "./Model/Movie.h"
+#include "./Services/FrameCache.h"
+#include "./Diagnostics/TraceRecorder.h"
+#include "./Rendering/PixelConversion.h"
 
 #include <QPixmap>
 
+#include <algorithm> // for std::max()
+
+namespace {
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Reduces an image with 16 bits per channel to 8 bits per channel</summary>
+  /// <param name="image">Image that will be reduced</param>
+  /// <returns>The image with 8 bits per channel</returns>
+  /// <remarks>
+  ///   Pixmaps are 8 bits per channel anyway, but Qt's own conversion of 16 bit frames
+  ///   is much slower than the SIMD code converting the frames for the encoders.
+  /// </remarks>
+  QImage reduceToEightBits(const QImage &image) {
+    using Nuclex::FrameFixer::Rendering::PixelConversion;
+
+    bool isSixteenBit = (
+      (image.format() == QImage::Format_RGBA64) ||
+      (image.format() == QImage::Format_RGBX64)
+    );
+    if(!isSixteenBit) {
+      return image;
+    }
+
+    QImage reducedImage(
+      image.width(), image.height(),
+      image.hasAlphaChannel() ? QImage::Format_ARGB32 : QImage::Format_RGB32
+    );
+    std::size_t width = static_cast<std::size_t>(image.width());
+    for(int lineIndex = 0; lineIndex < image.height(); ++lineIndex) {
+      PixelConversion::Rgba64ToArgb32(
+        reinterpret_cast<const std::uint16_t *>(image.constScanLine(lineIndex)),
+        reinterpret_cast<std::uint32_t *>(reducedImage.scanLine(lineIndex)),
+        width
+      );
+    }
+
+    return reducedImage;
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+} // anonymous namespace
+
 namespace Nuclex::FrameFixer {
 
   // ------------------------------------------------------------------------------------------- //
@@ -33,7 +80,9 @@ namespace Nuclex::FrameFixer {
   FrameThumbnailItemModel::FrameThumbnailItemModel(QObject *parent) :
     QAbstractListModel(parent),
     movie(),
+    frameCache(),
     thumbnailCache(),
+    thumbnailSlotCount(0),
     thumbnailResolution(128, 128) {}
 
   // ------------------------------------------------------------------------------------------- //
@@ -50,11 +99,51 @@ namespace Nuclex::FrameFixer {
     this->thumbnailCache.reset(
       new Nuclex::Support::Collections::SequentialSlotCache<std::size_t, QVariant>(frameCount)
     );
+    this->thumbnailSlotCount = frameCount;
     endResetModel();
   }
 
   // ------------------------------------------------------------------------------------------- //
 
+  void FrameThumbnailItemModel::AppendFrames(const std::vector<std::string> &filenames) {
+    if(!static_cast<bool>(this->movie) || filenames.empty()) {
+      return;
+    }
+
+    std::size_t firstFrameIndex = this->movie->Frames.size();
+    std::size_t frameCount = firstFrameIndex + filenames.size();
+
+    beginInsertRows(
+      QModelIndex(), static_cast<int>(firstFrameIndex), static_cast<int>(frameCount - 1)
+    );
+    for(std::size_t index = 0; index < filenames.size(); ++index) {
+      Frame &frame = this->movie->Frames.emplace_back(filenames[index]);
+      frame.Index = firstFrameIndex + index;
+    }
+
+    // The thumbnail cache has a slot for each frame. Grow it in large steps since
+    // the thumbnails cached so far are lost each time it is replaced.
+    if(frameCount > this->thumbnailSlotCount) {
+      this->thumbnailSlotCount = std::max(frameCount, this->thumbnailSlotCount * 2);
+      this->thumbnailCache.reset(
+        new Nuclex::Support::Collections::SequentialSlotCache<std::size_t, QVariant>(
+          this->thumbnailSlotCount
+        )
+      );
+    }
+    endInsertRows();
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  void FrameThumbnailItemModel::SetFrameCache(
+    const std::shared_ptr<Services::FrameCache> &frameCache
+  ) {
+    this->frameCache = frameCache;
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
   void FrameThumbnailItemModel::SetThumbnailResolution(const QSize &resolution) {
     beginResetModel();
     this->thumbnailResolution = resolution;
@@ -99,22 +188,21 @@ namespace Nuclex::FrameFixer {
     bool wasCached = this->thumbnailCache->TryGet(rowIndex, thumbnail);
     if(!wasCached) {
 
-      // Reconstitute the absolute path of the image file for this element
-      std::string frameImagePath;
-      {
-        frameImagePath = this->movie->FrameDirectory;
-        std::string::size_type length = frameImagePath.length();
-        if(length >= 1) {
-          if(frameImagePath[length - 1] != '/') {
-            frameImagePath.push_back('/');
-          }
-        }
-        frameImagePath.append(this->movie->Frames[rowIndex].Filename);
-      }
-
       // Load the image, resize it to thumbnail format and return it for the 
       {
-        QPixmap bitmap(QString::fromStdString(frameImagePath));
+        NUCLEX_FRAMEFIXER_TRACE_SCOPE(u8"ui", u8"Thumbnail decode");
+        QPixmap bitmap;
+        if(static_cast<bool>(this->frameCache)) {
+          bitmap = QPixmap::fromImage(
+            reduceToEightBits(
+              this->frameCache->GetFrame(*this->movie, static_cast<std::size_t>(rowIndex))
+            )
+          );
+        } else {
+          bitmap = QPixmap::fromImage(
+            reduceToEightBits(this->movie->LoadFrame(static_cast<std::size_t>(rowIndex)))
+          );
+        }
 
         int width = bitmap.width();
         int height = bitmap.height();
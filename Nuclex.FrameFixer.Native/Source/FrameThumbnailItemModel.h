@@ -26,6 +26,8 @@ limitations under the License.
 #include <QSize>
 
 #include <memory> // for std::shared_ptr
+#include <vector> // for std::vector
+#include <string> // for std::string
 
 #include <Nuclex/Support/Collections/SequentialSlotCache.h> // for SequentialSlotCache
 
@@ -39,6 +41,16 @@ namespace Nuclex::FrameFixer {
 
 } // namespace Nuclex::FrameFixer
 
+namespace Nuclex::FrameFixer::Services {
+
+  // ------------------------------------------------------------------------------------------- //
+
+  class FrameCache;
+
+  // ------------------------------------------------------------------------------------------- //
+
+} // namespace Nuclex::FrameFixer::Services
+
 namespace Nuclex::FrameFixer {
 
   // ------------------------------------------------------------------------------------------- //
@@ -58,6 +70,22 @@ namespace Nuclex::FrameFixer {
     /// <param name="movie">Movie for which thumbnails will be provided</param>
     public: void SetMovie(const std::shared_ptr<Movie> &movie);
 
+    /// <summary>Returns the movie for whose frames thumbnails are provided</summary>
+    /// <returns>The movie thumbnails are provided for, can be empty</returns>
+    public: const std::shared_ptr<Movie> &GetMovie() const { return this->movie; }
+
+    /// <summary>Adds frames to the end of the movie while it is being scanned</summary>
+    /// <param name="filenames">Filenames of the frames that will be added</param>
+    /// <remarks>
+    ///   Used to fill the thumbnail list progressively while a frame folder is scanned.
+    ///   The frames are appended to the movie set via <see cref="SetMovie" />.
+    /// </remarks>
+    public: void AppendFrames(const std::vector<std::string> &filenames);
+
+    /// <summary>Selects a cache through which the frames will be loaded</summary>
+    /// <param name="frameCache">Cache that will be used to look up decoded frames</param>
+    public: void SetFrameCache(const std::shared_ptr<Services::FrameCache> &frameCache);
+
     /// <summary>Sets the resolution in which thumbnails will be generated</summary>
     /// <param name="resolution">The desired thumbnail resolution</param>
     public: void SetThumbnailResolution(const QSize &resolution);
@@ -77,10 +105,14 @@ namespace Nuclex::FrameFixer {
 
     /// <summary>The movie for which the model provides thumbnails</summary>
     private: std::shared_ptr<Movie> movie;
+    /// <summary>Cache through which frames are loaded, can be empty</summary>
+    private: std::shared_ptr<Services::FrameCache> frameCache;
     /// <summary>Cached thumbnails for the movie's frames</summary>
     private: std::unique_ptr<
       Nuclex::Support::Collections::SequentialSlotCache<std::size_t, QVariant>
     > thumbnailCache;
+    /// <summary>Number of frames the thumbnail cache has slots for</summary>
+    private: std::size_t thumbnailSlotCount;
     /// <summary>Size the individual thumbnails should have</summary>
     private: QSize thumbnailResolution;
 
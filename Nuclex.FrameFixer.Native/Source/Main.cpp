@@ -26,10 +26,13 @@ limitations under the License.
 #include "./Services/DeinterlacerRepository.h"
 #include "./Services/InterpolatorRepository.h"
 #include "./MainWindow.h"
+#include "./Diagnostics/TraceRecorder.h"
 
 #include <QApplication>
 #include <QMessageBox>
 
+#include <cstdio> // for std::fprintf()
+
 // --------------------------------------------------------------------------------------------- //
 
 /// <summary>Entry point for the application</summary>
@@ -41,6 +44,14 @@ int main(int argc, char *argv[]) {
   {
     QApplication application(argc, argv);
 
+    // When the FRAMEFIXER_TRACE environment variable holds a path, everything that
+    // happens until the application exits is recorded as a trace into that file
+    std::string tracePath = qgetenv(u8"FRAMEFIXER_TRACE").toStdString();
+    if(!tracePath.empty()) {
+      Nuclex::FrameFixer::Diagnostics::TraceRecorder::Start();
+      Nuclex::FrameFixer::Diagnostics::TraceRecorder::NameCurrentThread(u8"User interface");
+    }
+
     // Create the service provider (we use a simple class that ties all the services
     // together instead of a full-blown IoC container to keep things simple).
     std::shared_ptr<Nuclex::FrameFixer::Services::ServicesRoot> servicesRoot;
@@ -84,6 +95,16 @@ int main(int argc, char *argv[]) {
     mainWindow->show();
 
     exitCode = application.exec();
+
+    if(!tracePath.empty()) {
+      Nuclex::FrameFixer::Diagnostics::TraceRecorder::Stop();
+      try {
+        Nuclex::FrameFixer::Diagnostics::TraceRecorder::Save(tracePath);
+      }
+      catch(const std::exception &error) {
+        std::fprintf(stderr, "%s\n", error.what());
+      }
+    }
   }
 
   return exitCode;
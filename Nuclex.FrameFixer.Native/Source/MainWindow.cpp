@@ -27,6 +27,7 @@ limitations under the License.
 
 #include "./Services/ServicesRoot.h"
 #include "./Services/DeinterlacerRepository.h"
+#include "./Services/FrameCache.h"
 #include "./Model/Movie.h"
 #include "./Renderer.h"
 
@@ -35,12 +36,18 @@ limitations under the License.
 #include "./FrameThumbnailPaintDelegate.h"
 
 #include <Nuclex/Support/Text/LexicalCast.h>
+#include <Nuclex/Support/Errors/CanceledError.h>
 
 #include <QFileDialog>
+#include <QFileInfo>
 #include <QGraphicsPixmapItem>
 #include <QThread>
 #include <QComboBox>
 
+#include <thread> // for std::thread
+#include <algorithm> // for std::min()
+#include <stdexcept> // for std::exception
+
 #include "./Algorithm/Filter.h"
 
 namespace {
@@ -62,6 +69,13 @@ namespace Nuclex::FrameFixer {
     deinterlacerItemModel(std::make_unique<DeinterlacerItemModel>()),
     servicesRoot(),
     currentMovie(),
+    ingestionThread(),
+    ingestionTimer(),
+    ingestionTrigger(),
+    ingestionMutex(),
+    scannedFilenames(),
+    ingestedMovie(),
+    ingestionError(),
     deinterlacer() {
 
     this->ui->setupUi(this);
@@ -100,7 +114,9 @@ namespace Nuclex::FrameFixer {
 
   // ------------------------------------------------------------------------------------------- //
 
-  MainWindow::~MainWindow() {}
+  MainWindow::~MainWindow() {
+    cancelIngestion();
+  }
 
   // ------------------------------------------------------------------------------------------- //
 
@@ -113,6 +129,7 @@ namespace Nuclex::FrameFixer {
       this->deinterlacerItemModel->SetDeinterlacers(
         servicesRoot->Deinterlacers()->GetDeinterlacers()
       );
+      this->thumbnailItemModel->SetFrameCache(servicesRoot->DecodedFrames());
     
       selectedDeinterlacerChanged(0); // Make sure deinterlace instance is set up
     }
@@ -227,8 +244,143 @@ namespace Nuclex::FrameFixer {
   // ------------------------------------------------------------------------------------------- //
 
   void MainWindow::ingestMovieFrames() {
+    cancelIngestion();
+
+    // Until the scan completes, there is no movie that could be edited. The thumbnail
+    // list shows a stand-in movie to which the frames are added as they are found.
     std::string frameDirectoryPath = this->ui->frameDirectoryText->text().toStdString();
-    this->currentMovie = Movie::FromImageFolder(frameDirectoryPath);
+    this->currentMovie.reset();
+    {
+      std::shared_ptr<Movie> partialMovie = std::make_shared<Movie>();
+      partialMovie->FrameDirectory = frameDirectoryPath;
+      this->thumbnailItemModel->SetMovie(partialMovie);
+      this->thumbnailPaintDelegate->SetMovie(partialMovie);
+    }
+
+    // The frame cache identifies frames by the index within their directory,
+    // which the frames of the stand-in movie do not have yet
+    if(static_cast<bool>(this->servicesRoot)) {
+      this->servicesRoot->DecodedFrames()->Clear();
+    }
+
+    this->ingestionTrigger = Nuclex::Platform::Tasks::CancellationTrigger::Create();
+    this->ingestionThread.reset(
+      QThread::create(&MainWindow::ingestInBackgroundThread, this, frameDirectoryPath)
+    );
+
+    this->ingestionTimer = std::make_unique<QTimer>(this);
+    connect(
+      this->ingestionTimer.get(), &QTimer::timeout,
+      this, &MainWindow::updateIngestionProgress
+    );
+    this->ingestionTimer->start(100);
+    this->ingestionThread->start();
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  void MainWindow::ingestInBackgroundThread(const std::string &path) {
+    std::shared_ptr<Movie> movie;
+    std::exception_ptr error;
+    try {
+      movie = Movie::Open(
+        path,
+        this->ingestionTrigger->GetWatcher(),
+        [this](const std::vector<std::string> &filenames) {
+          QMutexLocker ingestionLock(&this->ingestionMutex);
+          this->scannedFilenames.insert(
+            this->scannedFilenames.end(), filenames.begin(), filenames.end()
+          );
+        }
+      );
+    }
+    catch(const Nuclex::Support::Errors::CanceledError &) {}
+    catch(...) {
+      error = std::current_exception();
+    }
+
+    QMutexLocker ingestionLock(&this->ingestionMutex);
+    this->ingestedMovie = movie;
+    this->ingestionError = error;
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  void MainWindow::updateIngestionProgress() {
+    if(!static_cast<bool>(this->ingestionThread)) {
+      return;
+    }
+
+    // Check whether the thread is done before collecting its results, so that
+    // if it is done, nothing it reported can be missed
+    bool isFinished = this->ingestionThread->isFinished();
+
+    std::vector<std::string> filenames;
+    std::shared_ptr<Movie> movie;
+    std::exception_ptr error;
+    {
+      QMutexLocker ingestionLock(&this->ingestionMutex);
+      filenames.swap(this->scannedFilenames);
+      movie.swap(this->ingestedMovie);
+      error = this->ingestionError;
+      this->ingestionError = std::exception_ptr();
+    }
+
+    if(!isFinished) {
+      this->thumbnailItemModel->AppendFrames(filenames);
+      return;
+    }
+
+    this->ingestionTimer->stop();
+    this->ingestionTimer.reset();
+    this->ingestionThread->wait();
+    this->ingestionThread.reset();
+    this->ingestionTrigger.reset();
+
+    if(static_cast<bool>(error)) {
+      try {
+        std::rethrow_exception(error);
+      }
+      catch(const std::exception &exception) {
+        this->ui->frameStatusLabel->setText(
+          QString(u8"Could not open the movie: ") + QString::fromUtf8(exception.what())
+        );
+      }
+      catch(...) {
+        this->ui->frameStatusLabel->setText(QString(u8"Could not open the movie"));
+      }
+      return;
+    }
+    if(!static_cast<bool>(movie)) {
+      return; // The scan was cancelled
+    }
+
+    this->currentMovie = movie;
+
+    // If a frame cache file has been created for the movie (by the command-line renderer
+    // or an earlier session), use it so scrubbing through the frames needs no decoding
+    if(QFileInfo::exists(QString::fromStdString(this->currentMovie->GetCacheFilePath()))) {
+      this->currentMovie->EnableCacheFile();
+    }
+
+    // Unless the files were found in frame order already (or came from a cached
+    // listing), the frames in the frame cache are now associated with the wrong indices
+    std::shared_ptr<Movie> partialMovie = this->thumbnailItemModel->GetMovie();
+    bool isSameOrder = true;
+    if(static_cast<bool>(partialMovie)) {
+      std::size_t partialFrameCount = std::min(
+        partialMovie->Frames.size(), this->currentMovie->Frames.size()
+      );
+      for(std::size_t index = 0; index < partialFrameCount; ++index) {
+        if(partialMovie->Frames[index].Filename != this->currentMovie->Frames[index].Filename) {
+          isSameOrder = false;
+          break;
+        }
+      }
+    }
+    if(!isSameOrder && static_cast<bool>(this->servicesRoot)) {
+      this->servicesRoot->DecodedFrames()->Clear();
+    }
 
     this->thumbnailItemModel->SetMovie(this->currentMovie);
     this->thumbnailPaintDelegate->SetMovie(this->currentMovie);
@@ -243,6 +395,26 @@ namespace Nuclex::FrameFixer {
 
   // ------------------------------------------------------------------------------------------- //
 
+  void MainWindow::cancelIngestion() {
+    if(static_cast<bool>(this->ingestionTimer)) {
+      this->ingestionTimer->stop();
+      this->ingestionTimer.reset();
+    }
+    if(static_cast<bool>(this->ingestionThread)) {
+      this->ingestionTrigger->Cancel();
+      this->ingestionThread->wait();
+      this->ingestionThread.reset();
+      this->ingestionTrigger.reset();
+    }
+
+    QMutexLocker ingestionLock(&this->ingestionMutex);
+    this->scannedFilenames.clear();
+    this->ingestedMovie.reset();
+    this->ingestionError = std::exception_ptr();
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
   std::size_t MainWindow::getLastTaggedFrameIndex() const {
     std::size_t lastTaggedFrameIndex = std::size_t(-1);
 
@@ -447,18 +619,25 @@ namespace Nuclex::FrameFixer {
     if(static_cast<bool>(this->currentMovie)) {
       QImage frameImage;
 
+      std::shared_ptr<Services::FrameCache> frameCache;
+      if(static_cast<bool>(this->servicesRoot)) {
+        frameCache = this->servicesRoot->DecodedFrames();
+      }
+
       if(this->ui->previewOption->isChecked()) {
         Renderer movieRenderer;
         movieRenderer.SetDeinterlacer(this->deinterlacer);
+        movieRenderer.SetFrameCache(frameCache);
         
         if(this->ui->swapFieldsOption->isChecked()) {
           movieRenderer.FlipTopAndBottomField();
         }
 
         frameImage = movieRenderer.Preview(this->currentMovie, frame.Index);
+      } else if(static_cast<bool>(frameCache)) {
+        frameImage = frameCache->GetFrame(*this->currentMovie, frame.Index);
       } else {
-        std::string imagePath = this->currentMovie->GetFramePath(frame.Index);
-        frameImage.load(QString::fromStdString(imagePath));
+        frameImage = this->currentMovie->LoadFrame(frame.Index);
       }
 
       if(this->ui->enhanceOption->isChecked()) {
@@ -485,6 +664,14 @@ namespace Nuclex::FrameFixer {
         status += u8"\n";
         status += u8"File: ";
         status += frame.Filename;
+        if(static_cast<bool>(frameCache)) {
+          status += u8"\n";
+          status += u8"Cache hits: ";
+          status += Nuclex::Support::Text::lexical_cast<std::string>(
+            static_cast<int>(frameCache->GetHitRate() * 100.0 + 0.5)
+          );
+          status += u8"%";
+        }
         this->ui->frameStatusLabel->setText(QString::fromStdString(status));
       }
     }
@@ -569,7 +756,10 @@ namespace Nuclex::FrameFixer {
           renderDialog->GetSelectedDeinterlacer(),
           renderDialog->GetSelectedInterpolator(),
           renderDialog->GetInputFrameRange(),
-          renderDialog->GetOutputFrameRange()
+          renderDialog->GetOutputFrameRange(),
+          renderDialog->GetVideoSettings(),
+          renderDialog->GetImageEncoder(),
+          renderDialog->GetAverageMode()
         );
       }
     }
@@ -586,12 +776,30 @@ namespace Nuclex::FrameFixer {
     ) */,
     std::optional<std::pair<std::size_t, std::size_t>> outputFrameRange /* = (
       std::optional<std::pair<std::size_t, std::size_t>>()
-    ) */
+    ) */,
+    std::optional<Rendering::VideoSettings> videoSettings /* = (
+      std::optional<Rendering::VideoSettings>()
+    ) */,
+    const std::shared_ptr<Rendering::ImageFormats::ImageEncoder> &imageEncoder /* = (
+      std::shared_ptr<Rendering::ImageFormats::ImageEncoder>()
+    ) */,
+    AverageMode averageMode /* = AverageMode::Mean */
   ) {
     std::shared_ptr<Renderer> movieRenderer = std::make_shared<Renderer>();
     movieRenderer->SetDeinterlacer(deinterlacer);
     movieRenderer->SetInterpolator(interpolator);
-    
+    if(static_cast<bool>(this->servicesRoot)) {
+      movieRenderer->SetFrameCache(this->servicesRoot->DecodedFrames());
+    }
+    movieRenderer->EnablePipelining();
+    movieRenderer->SetEncoderThreadCount(std::thread::hardware_concurrency());
+    movieRenderer->SetProcessingThreadCount(std::thread::hardware_concurrency());
+    movieRenderer->SetReadAheadThreadCount(2);
+    movieRenderer->EnableIncrementalRendering();
+    movieRenderer->SetImageEncoder(imageEncoder);
+    movieRenderer->SetVideoOutput(videoSettings);
+    movieRenderer->SetAverageMode(averageMode);
+
     if(this->ui->swapFieldsOption->isChecked()) {
       movieRenderer->FlipTopAndBottomField();
     }
@@ -24,15 +24,24 @@ limitations under the License.
 
 #include "./Model/DeinterlaceMode.h"
 #include "./Model/FrameAction.h"
+#include "./Rendering/VideoSettings.h"
+#include "./Algorithm/AverageMode.h"
 #include "./Algorithm/Deinterlacing/Deinterlacer.h"
 
 #include <QMainWindow> // for QMainWindow
 #include <QItemSelection> // for QItemSelection
 #include <QMutex> // for QMutex
+#include <QThread> // for QThread
+#include <QTimer> // for QTimer
 
 #include <memory> // for std::unique_ptr
 #include <optional> // for std::optional
 #include <map> // for std::pair
+#include <vector> // for std::vector
+#include <string> // for std::string
+#include <exception> // for std::exception_ptr
+
+#include <Nuclex/Platform/Tasks/CancellationTrigger.h> // for CancellationTrigger
 
 namespace Nuclex::FrameFixer::Services {
 
@@ -64,6 +73,16 @@ namespace Nuclex::FrameFixer::Algorithm::Interpolation{
 
 }
 
+namespace Nuclex::FrameFixer::Rendering::ImageFormats {
+
+  // ------------------------------------------------------------------------------------------- //
+
+  class ImageEncoder;
+
+  // ------------------------------------------------------------------------------------------- //
+
+}
+
 namespace Nuclex::FrameFixer {
 
   // ------------------------------------------------------------------------------------------- //
@@ -119,8 +138,23 @@ namespace Nuclex::FrameFixer {
     private: void connectUiSignals();
 
     /// <summary>Loads the currently selected movie's frames</summary>
+    /// <remarks>
+    ///   The frame folder is scanned in a background thread. While the scan runs,
+    ///   the thumbnail list is filled with the frames found so far, in the order they
+    ///   were found, and the movie becomes available for editing once it completes.
+    /// </remarks>
     private: void ingestMovieFrames();
 
+    /// <summary>Scans the frame folder, called in the ingestion thread</summary>
+    /// <param name="path">Path of the frame folder or video file</param>
+    private: void ingestInBackgroundThread(const std::string &path);
+
+    /// <summary>Shows newly found frames and takes over the movie once it is loaded</summary>
+    private: void updateIngestionProgress();
+
+    /// <summary>Cancels a running scan and waits for the ingestion thread to end</summary>
+    private: void cancelIngestion();
+
     /// <summary>
     ///   Lets the user browse for the frames folder when the button is clicked
     /// </summary>
@@ -212,7 +246,14 @@ namespace Nuclex::FrameFixer {
       ),
       std::optional<std::pair<std::size_t, std::size_t>> outputFrameRange = (
         std::optional<std::pair<std::size_t, std::size_t>>()
-      )
+      ),
+      std::optional<Rendering::VideoSettings> videoSettings = (
+        std::optional<Rendering::VideoSettings>()
+      ),
+      const std::shared_ptr<Rendering::ImageFormats::ImageEncoder> &imageEncoder = (
+        std::shared_ptr<Rendering::ImageFormats::ImageEncoder>()
+      ),
+      AverageMode averageMode = AverageMode::Mean
     );
 
     /// <summary>Saves the status of all frames when the user clicks on save</summary>
@@ -232,6 +273,20 @@ namespace Nuclex::FrameFixer {
     private: std::shared_ptr<Services::ServicesRoot> servicesRoot;
     /// <summary>The movie whose frames are currently loaded for processing</summary>
     private: std::shared_ptr<Movie> currentMovie;
+    /// <summary>Thread scanning the frame folder of the movie being opened</summary>
+    private: std::unique_ptr<QThread> ingestionThread;
+    /// <summary>Periodically moves the results of the scan into the user interface</summary>
+    private: std::unique_ptr<QTimer> ingestionTimer;
+    /// <summary>Allows the scan of the frame folder to be cancelled</summary>
+    private: std::shared_ptr<Nuclex::Platform::Tasks::CancellationTrigger> ingestionTrigger;
+    /// <summary>Must be held while accessing the results of the scan</summary>
+    private: QMutex ingestionMutex;
+    /// <summary>Filenames found by the scan that are not shown in the list yet</summary>
+    private: std::vector<std::string> scannedFilenames;
+    /// <summary>Movie set up by the scan, available once the scan completes</summary>
+    private: std::shared_ptr<Movie> ingestedMovie;
+    /// <summary>Error that ended the scan, if any</summary>
+    private: std::exception_ptr ingestionError;
     /// <summary>The currently selected deinterlacer</summary>
     private: std::shared_ptr<Algorithm::Deinterlacing::Deinterlacer> deinterlacer;
 
@@ -0,0 +1,342 @@
+#pragma region Apache License 2.0
+/*
+Nuclex Frame Fixer
+Copyright (C) 2024 Markus Ewald / Nuclex Development Labs
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#pragma endregion // Apache License 2.0
+
+// If the application is compiled as a DLL, this ensures symbols are exported
+#define NUCLEX_FRAMEFIXER_SOURCE 1
+
+#include "./FrameDirectoryListing.h"
+
+#include <QDirIterator>
+#include <QFile>
+#include <QFileInfo>
+#include <QDateTime>
+
+#include <Nuclex/Support/Text/LexicalCast.h> // for lexical_cast()
+#include <Nuclex/Support/Text/LexicalAppend.h> // for lexical_append()
+
+#include <algorithm> // for std::sort(), std::find(), std::min(), std::max()
+#include <utility> // for std::pair
+
+namespace {
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Text at the beginning of a cached listing, includes the format version</summary>
+  const std::string ListingSignature(u8"NXFFLIST 1 ", 11);
+
+  /// <summary>Number of files that are collected before reporting them as progress</summary>
+  const std::size_t ProgressBatchSize = 1000;
+
+  /// <summary>Time a directory has to be unchanged before its listing is cached</summary>
+  /// <remarks>
+  ///   File systems with coarse timestamps might give a directory the same modification
+  ///   time again if a file is added right after the scan, so recently modified directories
+  ///   are scanned each time until they have settled down.
+  /// </remarks>
+  const std::int64_t SettleTimeInMilliseconds = 2000;
+
+  /// <summary>Maximum number of digits a frame number can have without overflowing</summary>
+  const std::size_t MaximumFrameNumberDigitCount = 18;
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Forms the first line of a cached listing</summary>
+  /// <param name="modificationTime">Modification time of the listed directory</param>
+  /// <returns>The header line, without the number of files and line break</returns>
+  std::string getListingHeader(std::int64_t modificationTime) {
+    std::string header(ListingSignature);
+    Nuclex::Support::Text::lexical_append(header, modificationTime);
+    header.push_back(u8' ');
+    return header;
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Checks whether a character is one of the decimal digits</summary>
+  /// <param name="character">Character that will be checked</param>
+  /// <returns>True if the character is a decimal digit</returns>
+  bool isDigit(char character) {
+    return (character >= u8'0') && (character <= u8'9');
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Locates the last run of digits in a filename</summary>
+  /// <param name="filename">Filename in which the frame number will be located</param>
+  /// <param name="digitsStart">Receives the index of the run's first digit</param>
+  /// <param name="digitCount">Receives the number of digits in the run</param>
+  /// <returns>True if the filename contains any digits</returns>
+  bool findFrameNumber(
+    const std::string &filename, std::size_t &digitsStart, std::size_t &digitCount
+  ) {
+    std::size_t digitsEnd = filename.length();
+    while((digitsEnd >= 1) && !isDigit(filename[digitsEnd - 1])) {
+      --digitsEnd;
+    }
+    if(digitsEnd == 0) {
+      return false;
+    }
+
+    digitsStart = digitsEnd - 1;
+    while((digitsStart >= 1) && isDigit(filename[digitsStart - 1])) {
+      --digitsStart;
+    }
+
+    digitCount = digitsEnd - digitsStart;
+    return true;
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+} // anonymous namespace
+
+namespace Nuclex::FrameFixer {
+
+  // ------------------------------------------------------------------------------------------- //
+
+  std::vector<std::string> FrameDirectoryListing::Read(
+    const std::string &directoryPath,
+    const std::string &listingPath,
+    const std::shared_ptr<const CancellationWatcher> &cancellationWatcher /* = (
+      std::shared_ptr<const CancellationWatcher>()
+    ) */,
+    const ProgressCallback &progressCallback /* = ProgressCallback() */
+  ) {
+
+    // The modification time is taken before scanning, so if the directory changes
+    // during the scan, the cached listing will already be outdated when it is written
+    QFileInfo directoryInfo(QString::fromStdString(directoryPath));
+    std::int64_t modificationTime = directoryInfo.lastModified().toMSecsSinceEpoch();
+
+    std::vector<std::string> filenames;
+    if(tryReadListing(listingPath, modificationTime, filenames)) {
+      if(static_cast<bool>(progressCallback)) {
+        progressCallback(filenames);
+      }
+      return filenames;
+    }
+
+    filenames = scanDirectory(directoryPath, cancellationWatcher, progressCallback);
+
+    // Sort the frames by their filenames. This assumes frames have been exported
+    // with leading zeroes (i.e. what you get when you export images with ffmpeg).
+    if(!trySortByFrameNumber(filenames)) {
+      std::sort(filenames.begin(), filenames.end());
+    }
+
+    std::int64_t now = QDateTime::currentMSecsSinceEpoch();
+    if(now - modificationTime >= SettleTimeInMilliseconds) {
+      writeListing(listingPath, modificationTime, filenames);
+    }
+
+    return filenames;
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  bool FrameDirectoryListing::tryReadListing(
+    const std::string &listingPath,
+    std::int64_t modificationTime,
+    std::vector<std::string> &filenames
+  ) {
+    QFile listingFile(QString::fromStdString(listingPath));
+    if(!listingFile.open(QIODevice::OpenModeFlag::ReadOnly)) {
+      return false;
+    }
+
+    QByteArray contents = listingFile.readAll();
+    const char *current = contents.constData();
+    const char *end = current + contents.size();
+
+    // The header states the modification time the listing was taken at and
+    // the number of files, which tells whether the listing was written completely
+    std::string expectedHeader = getListingHeader(modificationTime);
+    const char *lineEnd = std::find(current, end, '\n');
+    std::string header(current, lineEnd);
+    if(header.compare(0, expectedHeader.length(), expectedHeader) != 0) {
+      return false;
+    }
+    std::size_t fileCount = Nuclex::Support::Text::lexical_cast<std::size_t>(
+      header.substr(expectedHeader.length())
+    );
+
+    filenames.clear();
+    filenames.reserve(fileCount);
+    while(lineEnd != end) {
+      current = lineEnd + 1;
+      lineEnd = std::find(current, end, '\n');
+      if(lineEnd == end) {
+        break; // Each filename is terminated by a line break, anything else is a leftover
+      }
+
+      filenames.emplace_back(current, lineEnd);
+    }
+
+    return (filenames.size() == fileCount);
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  void FrameDirectoryListing::writeListing(
+    const std::string &listingPath,
+    std::int64_t modificationTime,
+    const std::vector<std::string> &filenames
+  ) {
+
+    // The listing is only a shortcut, so if it can't be written (for example because
+    // the frames are on read-only storage), the directory will simply be scanned again
+    QFile listingFile(QString::fromStdString(listingPath));
+    bool isOpen = listingFile.open(
+      QIODevice::OpenModeFlag::WriteOnly | QIODevice::OpenModeFlag::Truncate
+    );
+    if(!isOpen) {
+      return;
+    }
+
+    std::string contents = getListingHeader(modificationTime);
+    Nuclex::Support::Text::lexical_append(contents, filenames.size());
+    contents.push_back(u8'\n');
+    for(std::size_t index = 0; index < filenames.size(); ++index) {
+      contents.append(filenames[index]);
+      contents.push_back(u8'\n');
+    }
+
+    listingFile.write(contents.data(), static_cast<qint64>(contents.length()));
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  std::vector<std::string> FrameDirectoryListing::scanDirectory(
+    const std::string &directoryPath,
+    const std::shared_ptr<const CancellationWatcher> &cancellationWatcher,
+    const ProgressCallback &progressCallback
+  ) {
+    QStringList acceptedExtensions({"*.png", "*.tif", "*.bmp"});
+    QDirIterator directoryEnumerator(
+      QString::fromStdString(directoryPath),
+      acceptedExtensions,
+      QDir::Filter::Files,
+      QDirIterator::IteratorFlag::NoIteratorFlags
+    );
+
+    // Enumerate all image files in the target directory. The files will be enumerated
+    // in an undefined order. Every so often, report the files found so far.
+    std::vector<std::string> filenames;
+    std::vector<std::string> batch;
+    while(directoryEnumerator.hasNext()) {
+      directoryEnumerator.next();
+      filenames.push_back(directoryEnumerator.fileName().toStdString());
+
+      if(static_cast<bool>(progressCallback)) {
+        batch.push_back(filenames.back());
+        if(batch.size() >= ProgressBatchSize) {
+          progressCallback(batch);
+          batch.clear();
+        }
+      }
+
+      if((filenames.size() % 100) == 0) {
+        if(static_cast<bool>(cancellationWatcher)) {
+          cancellationWatcher->ThrowIfCanceled();
+        }
+      }
+    }
+
+    if(!batch.empty()) {
+      progressCallback(batch);
+    }
+
+    return filenames;
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  bool FrameDirectoryListing::trySortByFrameNumber(std::vector<std::string> &filenames) {
+    std::size_t fileCount = filenames.size();
+    if(fileCount < 2) {
+      return true;
+    }
+
+    // Use the first file as the pattern all other files have to follow
+    std::size_t digitsStart, digitCount;
+    if(!findFrameNumber(filenames[0], digitsStart, digitCount)) {
+      return false;
+    }
+    if(digitCount > MaximumFrameNumberDigitCount) {
+      return false;
+    }
+    const std::string &pattern = filenames[0];
+    std::size_t digitsEnd = digitsStart + digitCount;
+
+    // Parse the frame number of each file, making sure that the text around it
+    // is identical and that the number has the same amount of digits
+    std::vector<std::pair<std::uint64_t, std::size_t>> frameNumbers;
+    frameNumbers.reserve(fileCount);
+    std::uint64_t lowestFrameNumber = std::uint64_t(-1);
+    std::uint64_t highestFrameNumber = 0;
+    for(std::size_t index = 0; index < fileCount; ++index) {
+      const std::string &filename = filenames[index];
+      bool followsPattern = (
+        (filename.length() == pattern.length()) &&
+        (filename.compare(0, digitsStart, pattern, 0, digitsStart) == 0) &&
+        (filename.compare(digitsEnd, std::string::npos, pattern, digitsEnd) == 0)
+      );
+      if(!followsPattern) {
+        return false;
+      }
+
+      std::uint64_t frameNumber = 0;
+      for(std::size_t digitIndex = digitsStart; digitIndex < digitsEnd; ++digitIndex) {
+        char digit = filename[digitIndex];
+        if(!isDigit(digit)) {
+          return false;
+        }
+        frameNumber = frameNumber * 10 + static_cast<std::uint64_t>(digit - u8'0');
+      }
+
+      frameNumbers.emplace_back(frameNumber, index);
+      lowestFrameNumber = std::min(lowestFrameNumber, frameNumber);
+      highestFrameNumber = std::max(highestFrameNumber, frameNumber);
+    }
+
+    // Filenames are unique, so if the numbers cover a range as long as the list, each
+    // number appears exactly once and every file can be put straight into its place.
+    // Otherwise, frames are missing in between and the numbers need to be sorted.
+    std::vector<std::string> sortedFilenames(fileCount);
+    if(highestFrameNumber - lowestFrameNumber + 1 == fileCount) {
+      for(std::size_t index = 0; index < fileCount; ++index) {
+        std::size_t sortedIndex = static_cast<std::size_t>(
+          frameNumbers[index].first - lowestFrameNumber
+        );
+        sortedFilenames[sortedIndex].swap(filenames[frameNumbers[index].second]);
+      }
+    } else {
+      std::sort(frameNumbers.begin(), frameNumbers.end());
+      for(std::size_t index = 0; index < fileCount; ++index) {
+        sortedFilenames[index].swap(filenames[frameNumbers[index].second]);
+      }
+    }
+
+    filenames.swap(sortedFilenames);
+    return true;
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+} // namespace Nuclex::FrameFixer
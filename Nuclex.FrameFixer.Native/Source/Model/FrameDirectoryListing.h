@@ -0,0 +1,130 @@
+#pragma region Apache License 2.0
+/*
+Nuclex Frame Fixer
+Copyright (C) 2024 Markus Ewald / Nuclex Development Labs
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#pragma endregion // Apache License 2.0
+
+#ifndef NUCLEX_FRAMEFIXER_FRAMEDIRECTORYLISTING_H
+#define NUCLEX_FRAMEFIXER_FRAMEDIRECTORYLISTING_H
+
+#include "Nuclex/FrameFixer/Config.h"
+
+#include <string> // for std::string
+#include <vector> // for std::vector
+#include <memory> // for std::shared_ptr
+#include <functional> // for std::function
+#include <cstdint> // for std::int64_t
+
+#include <Nuclex/Platform/Tasks/CancellationWatcher.h> // for CancellationWatcher
+
+namespace Nuclex::FrameFixer {
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Lists the image files in which the frames of a movie are stored</summary>
+  /// <remarks>
+  ///   <para>
+  ///     Enumerating a directory holding hundreds of thousands of frames takes a long time,
+  ///     especially on network storage. The sorted listing is therefore stored in a file
+  ///     next to the frame directory and reused for as long as the directory's modification
+  ///     time stays the same (adding, removing or renaming files changes it).
+  ///   </para>
+  ///   <para>
+  ///     Frames are usually exported with a common name and a zero-padded frame number
+  ///     (what ffmpeg produces), in which case the files are ordered by their numbers
+  ///     rather than by comparing their names, which gives the same order much faster.
+  ///   </para>
+  /// </remarks>
+  class FrameDirectoryListing {
+
+    typedef Nuclex::Platform::Tasks::CancellationWatcher CancellationWatcher;
+
+    /// <summary>Receives batches of filenames while a directory is being scanned</summary>
+    /// <remarks>
+    ///   Filenames are reported in the order they are found, which is not the order
+    ///   of the frames. The callback is invoked from the thread doing the scan.
+    /// </remarks>
+    public: typedef std::function<
+      void(const std::vector<std::string> &filenames)
+    > ProgressCallback;
+
+    /// <summary>Looks up the sorted filenames of all frames in a directory</summary>
+    /// <param name="directoryPath">Path of the directory holding the frames</param>
+    /// <param name="listingPath">Path under which the listing will be cached</param>
+    /// <param name="cancellationWatcher">Allows the scan to be cancelled</param>
+    /// <param name="progressCallback">Receives the filenames as they are found</param>
+    /// <returns>The filenames of all frames in the directory, in frame order</returns>
+    public: static std::vector<std::string> Read(
+      const std::string &directoryPath,
+      const std::string &listingPath,
+      const std::shared_ptr<const CancellationWatcher> &cancellationWatcher = (
+        std::shared_ptr<const CancellationWatcher>()
+      ),
+      const ProgressCallback &progressCallback = ProgressCallback()
+    );
+
+    /// <summary>Reads a cached listing if it is still valid</summary>
+    /// <param name="listingPath">Path of the cached listing</param>
+    /// <param name="modificationTime">Current modification time of the directory</param>
+    /// <param name="filenames">Receives the filenames stored in the listing</param>
+    /// <returns>True if the listing was valid and has been read</returns>
+    private: static bool tryReadListing(
+      const std::string &listingPath,
+      std::int64_t modificationTime,
+      std::vector<std::string> &filenames
+    );
+
+    /// <summary>Stores the listing of a directory for the next time it is opened</summary>
+    /// <param name="listingPath">Path under which the listing will be stored</param>
+    /// <param name="modificationTime">Modification time of the directory</param>
+    /// <param name="filenames">Sorted filenames that will be stored in the listing</param>
+    private: static void writeListing(
+      const std::string &listingPath,
+      std::int64_t modificationTime,
+      const std::vector<std::string> &filenames
+    );
+
+    /// <summary>Enumerates the image files in a directory</summary>
+    /// <param name="directoryPath">Path of the directory that will be enumerated</param>
+    /// <param name="cancellationWatcher">Allows the scan to be cancelled</param>
+    /// <param name="progressCallback">Receives the filenames as they are found</param>
+    /// <returns>The filenames of all image files in the directory, unsorted</returns>
+    private: static std::vector<std::string> scanDirectory(
+      const std::string &directoryPath,
+      const std::shared_ptr<const CancellationWatcher> &cancellationWatcher,
+      const ProgressCallback &progressCallback
+    );
+
+    /// <summary>Sorts filenames by their frame numbers if they all follow one pattern</summary>
+    /// <param name="filenames">Filenames that will be sorted</param>
+    /// <returns>
+    ///   True if the filenames have been sorted, false if they differ in more than
+    ///   their frame numbers and have to be sorted by name
+    /// </returns>
+    /// <remarks>
+    ///   Only filenames that share everything but their frame numbers, which also have
+    ///   to be padded to the same number of digits, qualify. For those, the numeric order
+    ///   is identical to the order a comparison of the filenames would produce.
+    /// </remarks>
+    private: static bool trySortByFrameNumber(std::vector<std::string> &filenames);
+
+  };
+
+  // ------------------------------------------------------------------------------------------- //
+
+} // namespace Nuclex::FrameFixer
+
+#endif // NUCLEX_FRAMEFIXER_FRAMEDIRECTORYLISTING_H
@@ -21,26 +21,43 @@ limitations under the License.
 #define NUCLEX_FRAMEFIXER_SOURCE 1
 
 #include "Movie.h"
+#include "../Rendering/VideoDecoder.h"
+#include "../Rendering/ImageFormats/PngImageDecoder.h"
+#include "../Services/FrameCacheFile.h"
 
-#include <QDirIterator>
 #include <QFile>
+#include <QFileInfo>
+#include <QDateTime>
 #include <QTextStream>
 
 #include <Nuclex/Support/Text/LexicalCast.h>
 #include <Nuclex/Support/Text/LexicalAppend.h>
 
+#include <cstdio> // for std::snprintf()
+#include <stdexcept> // for std::runtime_error
+
 namespace {
 
   // ------------------------------------------------------------------------------------------- //
 
-  /// <summary>Compares the sort order relation of two frames using their filenames</summary>
-  /// <param name="left">Frame that will be compared on the left side</param>
-  /// <param name="left">Frame that will be compared on the right side</param>
-  /// <returns>True if the left frame is ordered before the right frame</returns>
-  bool compareFramesByFilename(
-    const Nuclex::FrameFixer::Frame &left, const Nuclex::FrameFixer::Frame &right
-  ) {
-    return left.Filename < right.Filename;
+  /// <summary>Offset basis of the 64 bit FNV-1a hash</summary>
+  const std::uint64_t FnvOffsetBasis = 14695981039346656037ULL;
+
+  /// <summary>Prime of the 64 bit FNV-1a hash</summary>
+  const std::uint64_t FnvPrime = 1099511628211ULL;
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Mixes the bytes of a value into a running FNV-1a hash</summary>
+  /// <param name="hash">Hash the value will be mixed into</param>
+  /// <param name="value">Value that will be mixed into the hash</param>
+  /// <returns>The updated hash</returns>
+  std::uint64_t hashValue(std::uint64_t hash, std::uint64_t value) {
+    for(std::size_t index = 0; index < sizeof(value); ++index) {
+      hash ^= (value >> (index * 8)) & 0xFF;
+      hash *= FnvPrime;
+    }
+    return hash;
   }
 
   // ------------------------------------------------------------------------------------------- //
@@ -51,51 +68,99 @@ namespace Nuclex::FrameFixer {
 
   // ------------------------------------------------------------------------------------------- //
 
+  std::shared_ptr<Movie> Movie::Open(
+    const std::string &path,
+    const std::shared_ptr<const CancellationWatcher> &cancellationWatcher /* = (
+      std::shared_ptr<const CancellationWatcher>()
+    ) */,
+    const FrameDirectoryListing::ProgressCallback &progressCallback /* = (
+      FrameDirectoryListing::ProgressCallback()
+    ) */
+  ) {
+    QFileInfo pathInfo(QString::fromStdString(path));
+    if(pathInfo.isFile()) {
+      return FromVideoFile(path, cancellationWatcher);
+    } else {
+      return FromImageFolder(path, cancellationWatcher, progressCallback);
+    }
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
   std::shared_ptr<Movie> Movie::FromImageFolder(
     const std::string &path,
     const std::shared_ptr<const CancellationWatcher> &cancellationWatcher /* = (
       std::shared_ptr<const CancellationWatcher>()
+    ) */,
+    const FrameDirectoryListing::ProgressCallback &progressCallback /* = (
+      FrameDirectoryListing::ProgressCallback()
     ) */
   ) {
     std::shared_ptr<Movie> movie = std::make_shared<Movie>();
     movie->FrameDirectory = path;
     {
-      QStringList acceptedExtensions({"*.png", "*.tif", "*.bmp"});
-      QDirIterator directoryEnumerator(
-        QString::fromStdString(path),
-        acceptedExtensions,
-        QDir::Filter::Files,
-        QDirIterator::IteratorFlag::NoIteratorFlags
+      std::vector<std::string> filenames = FrameDirectoryListing::Read(
+        path,
+        getSiblingPath(path, std::string(u8".frames.list", 12)),
+        cancellationWatcher,
+        progressCallback
       );
 
-      // Enumerate all image files in the target directory and add them to the frames
-      // list of the movie. The files will be enumerated in an undefined order.
-      std::size_t frameIndex = 0;
-      while(directoryEnumerator.hasNext()) {
-        directoryEnumerator.next();
-        movie->Frames.emplace_back(directoryEnumerator.fileName().toStdString());
-        ++frameIndex;
-
-        if((frameIndex % 100) == 0) {
-          if(static_cast<bool>(cancellationWatcher)) {
-            cancellationWatcher->ThrowIfCanceled();
-          }
-        }
+      // The filenames are already in frame order, so give the frames an index
+      // to easily address them.
+      movie->Frames.reserve(filenames.size());
+      for(std::size_t index = 0; index < filenames.size(); ++index) {
+        Frame &frame = movie->Frames.emplace_back(filenames[index]);
+        frame.Index = index;
       }
+    }
 
-      // Now sort the frames by their filename. This assumes frames have been exported
-      // with leading zeroes (i.e. what you get when you export images with ffmpeg),
-      std::sort(movie->Frames.begin(), movie->Frames.end(), &compareFramesByFilename);
+    loadState(*movie);
 
-      // Now that the frames are ordered, give them an index to easily address them.
-      for(std::size_t index = 0; index < movie->Frames.size(); ++index) {
-        movie->Frames[index].Index = index;
-      }
+    return movie;
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  std::shared_ptr<Movie> Movie::FromVideoFile(
+    const std::string &path,
+    const std::shared_ptr<const CancellationWatcher> &cancellationWatcher /* = (
+      std::shared_ptr<const CancellationWatcher>()
+    ) */
+  ) {
+#if defined(NUCLEX_FRAMEFIXER_ENABLE_LIBAV)
+    std::shared_ptr<Movie> movie = std::make_shared<Movie>();
+    movie->FrameDirectory = path;
+    movie->Video = std::make_shared<Rendering::VideoDecoder>(path, cancellationWatcher);
+
+    // Name the frames the way ffmpeg would if the video was extracted into images,
+    // so the state file looks the same and the names are useful in the user interface
+    std::size_t frameCount = movie->Video->GetFrameCount();
+    movie->Frames.reserve(frameCount);
+    for(std::size_t index = 0; index < frameCount; ++index) {
+      char filename[32];
+      std::snprintf(filename, sizeof(filename), u8"%08zu", index + 1);
+
+      Frame &frame = movie->Frames.emplace_back(std::string(filename));
+      frame.Index = index;
     }
 
+    loadState(*movie);
+
+    return movie;
+#else
+    (void)path;
+    (void)cancellationWatcher;
+    throw std::runtime_error(u8"Video input requires the application to be built with libav");
+#endif
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  void Movie::loadState(Movie &movie) {
     // This application also saves the states of manually marked frames inside a text file
     // using the same name as the frame directory. Restore the states is the file exists.
-    std::string stateFilePath = getStateFilePath(path);
+    std::string stateFilePath = getStateFilePath(movie.FrameDirectory);
     QFile stateFile(QString::fromStdString(stateFilePath));
     if(stateFile.open(QIODevice::OpenModeFlag::ReadOnly | QIODevice::OpenModeFlag::Text)) {
       using Nuclex::Support::Text::lexical_cast;
@@ -112,25 +177,25 @@ namespace Nuclex::FrameFixer {
         QString typeAsString = tokens[2].trimmed();
         if(!typeAsString.isEmpty()) {
           if(typeAsString == u8"Discard") {
-            movie->Frames[frameIndex].Action = FrameAction::Discard;
+            movie.Frames[frameIndex].Action = FrameAction::Discard;
           } else if((typeAsString == u8"BC") || (typeAsString == u8"TopFieldFirst")) {
-            movie->Frames[frameIndex].Action = FrameAction::TopFieldFirst;
+            movie.Frames[frameIndex].Action = FrameAction::TopFieldFirst;
           } else if((typeAsString == u8"CD") || (typeAsString == u8"BottomFieldFirst")) {
-            movie->Frames[frameIndex].Action = FrameAction::BottomFieldFirst;
+            movie.Frames[frameIndex].Action = FrameAction::BottomFieldFirst;
           } else if((typeAsString == u8"TopC") || (typeAsString == u8"TopFieldOnly")) {
-            movie->Frames[frameIndex].Action = FrameAction::TopFieldOnly;
+            movie.Frames[frameIndex].Action = FrameAction::TopFieldOnly;
           } else if((typeAsString == u8"BottomC") || (typeAsString == u8"BottomFieldOnly")) {
-            movie->Frames[frameIndex].Action = FrameAction::BottomFieldOnly;
+            movie.Frames[frameIndex].Action = FrameAction::BottomFieldOnly;
           } else if(typeAsString == u8"Progressive") {
-            movie->Frames[frameIndex].Action = FrameAction::Progressive;
+            movie.Frames[frameIndex].Action = FrameAction::Progressive;
           } else if(typeAsString == u8"Average") {
-            movie->Frames[frameIndex].Action = FrameAction::Average;
+            movie.Frames[frameIndex].Action = FrameAction::Average;
           } else if(typeAsString == u8"Duplicate") {
-            movie->Frames[frameIndex].Action = FrameAction::Duplicate;
+            movie.Frames[frameIndex].Action = FrameAction::Duplicate;
           } else if(typeAsString == u8"Triplicate") {
-            movie->Frames[frameIndex].Action = FrameAction::Triplicate;
+            movie.Frames[frameIndex].Action = FrameAction::Triplicate;
           } else if((typeAsString == u8"Blended") || (typeAsString == u8"Deblend")) {
-            movie->Frames[frameIndex].Action = FrameAction::Deblend;
+            movie.Frames[frameIndex].Action = FrameAction::Deblend;
           } else if(typeAsString.startsWith(u8"InterpolateFrom(")) {
             int firstEndIndex = typeAsString.indexOf(u8'+', 16);
             if((firstEndIndex != -1) && (firstEndIndex > 16)) {
@@ -142,8 +207,8 @@ namespace Nuclex::FrameFixer {
                 std::size_t rightFrameIndex = Nuclex::Support::Text::lexical_cast<std::size_t>(
                   typeAsString.mid(firstEndIndex + 1, secondEndIndex - (firstEndIndex + 1)).toStdString()
                 );
-                movie->Frames[frameIndex].Action = FrameAction::Interpolate;
-                movie->Frames[frameIndex].InterpolationSourceIndices = (
+                movie.Frames[frameIndex].Action = FrameAction::Interpolate;
+                movie.Frames[frameIndex].InterpolationSourceIndices = (
                   std::pair<std::size_t, std::size_t>(leftFrameIndex, rightFrameIndex)
                 );
               }
@@ -154,22 +219,20 @@ namespace Nuclex::FrameFixer {
               std::size_t replacementFrameIndex = Nuclex::Support::Text::lexical_cast<std::size_t>(
                 typeAsString.mid(12, endIndex - 12).toStdString()
               );
-              movie->Frames[frameIndex].Action = FrameAction::Replace;
-              movie->Frames[frameIndex].LeftOrReplacementIndex = replacementFrameIndex;
+              movie.Frames[frameIndex].Action = FrameAction::Replace;
+              movie.Frames[frameIndex].LeftOrReplacementIndex = replacementFrameIndex;
             }
           }
 
           if(tokens.size() > 3) {
             QString interpolationType = tokens[3].trimmed();
             if(interpolationType == u8"AlsoInsertInterpolatedFrameAfter") {
-              movie->Frames[frameIndex].AlsoInsertInterpolatedAfter = true;
+              movie.Frames[frameIndex].AlsoInsertInterpolatedAfter = true;
             }
           }
         }
       }
     }
-
-    return movie;
   }
 
   // ------------------------------------------------------------------------------------------- //
@@ -244,6 +307,10 @@ namespace Nuclex::FrameFixer {
   // ------------------------------------------------------------------------------------------- //
 
   std::string Movie::GetFramePath(std::size_t frameIndex) const {
+    if(static_cast<bool>(this->Video)) {
+      return this->FrameDirectory;
+    }
+
     std::string path = this->FrameDirectory;
     {
       std::string::size_type length = path.length();
@@ -261,17 +328,114 @@ namespace Nuclex::FrameFixer {
 
   // ------------------------------------------------------------------------------------------- //
 
+  void Movie::EnableCacheFile() {
+    this->CacheFile = std::make_shared<Services::FrameCacheFile>(
+      GetCacheFilePath(), this->Frames.size()
+    );
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  std::string Movie::GetCacheFilePath() const {
+    return getSiblingPath(this->FrameDirectory, std::string(u8".frames.cache", 13));
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  QImage Movie::LoadFrame(std::size_t frameIndex) const {
+    if(!static_cast<bool>(this->CacheFile)) {
+      return loadFrameFromSource(frameIndex);
+    }
+
+    // If the frame has been stored in the cache file and its source is unchanged,
+    // the image can be handed out from the mapped file. It comes back in the format
+    // it had when it was stored, so this doesn't change what the render produces.
+    QImage image;
+    std::uint64_t sourceStamp = getSourceStamp(frameIndex);
+    if(this->CacheFile->TryGetFrame(frameIndex, sourceStamp, image)) {
+      return image;
+    }
+
+    image = loadFrameFromSource(frameIndex);
+    this->CacheFile->StoreFrame(frameIndex, sourceStamp, image);
+    return image;
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  QImage Movie::loadFrameFromSource(std::size_t frameIndex) const {
+#if defined(NUCLEX_FRAMEFIXER_ENABLE_LIBAV)
+    if(static_cast<bool>(this->Video)) {
+      return this->Video->DecodeFrame(frameIndex);
+    }
+#endif
+
+    // PNG frames are decoded directly into the pipeline's pixel layout. Each thread keeps
+    // its own decoder so the file and row buffers are reused from frame to frame.
+    std::string path = GetFramePath(frameIndex);
+    if(Rendering::ImageFormats::PngImageDecoder::IsPngPath(path)) {
+      thread_local Rendering::ImageFormats::PngImageDecoder pngDecoder;
+
+      QImage image;
+      if(pngDecoder.TryDecode(path, image)) {
+        return image;
+      }
+    }
+
+    return QImage(QString::fromStdString(path));
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  std::uint64_t Movie::GetEncodedFrameSize(std::size_t frameIndex) const {
+#if defined(NUCLEX_FRAMEFIXER_ENABLE_LIBAV)
+    if(static_cast<bool>(this->Video)) {
+      return static_cast<std::uint64_t>(this->Video->GetEncodedFrameSize(frameIndex));
+    }
+#endif
+
+    QFileInfo fileInfo(QString::fromStdString(GetFramePath(frameIndex)));
+    return static_cast<std::uint64_t>(fileInfo.size());
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  std::uint64_t Movie::getSourceStamp(std::size_t frameIndex) const {
+    QFileInfo fileInfo(QString::fromStdString(GetFramePath(frameIndex)));
+
+    std::uint64_t stamp = FnvOffsetBasis;
+    for(char character : this->Frames.at(frameIndex).Filename) {
+      stamp = hashValue(stamp, static_cast<std::uint64_t>(static_cast<unsigned char>(character)));
+    }
+    stamp = hashValue(stamp, GetEncodedFrameSize(frameIndex));
+    stamp = hashValue(
+      stamp, static_cast<std::uint64_t>(fileInfo.lastModified().toMSecsSinceEpoch())
+    );
+
+    return (stamp == 0) ? 1 : stamp; // Zero marks frames not stored in the cache file
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
   std::string Movie::getStateFilePath(const std::string &frameDirectoryPath) {
+    return getSiblingPath(frameDirectoryPath, std::string(u8".frames.txt", 11));
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  std::string Movie::getSiblingPath(
+    const std::string &frameDirectoryPath, const std::string &extension
+  ) {
     std::string::size_type length = frameDirectoryPath.length();
 
-    std::string stateFilePath;
+    std::string siblingPath;
     if((length >= 1) && (frameDirectoryPath[length - 1] == '/')) {
-      stateFilePath = frameDirectoryPath.substr(0, length - 1) + u8".frames.txt";
+      siblingPath = frameDirectoryPath.substr(0, length - 1) + extension;
     } else {
-      stateFilePath = frameDirectoryPath + u8".frames.txt";
+      siblingPath = frameDirectoryPath + extension;
     }
 
-    return stateFilePath;
+    return siblingPath;
   }
 
   // ------------------------------------------------------------------------------------------- //
@@ -22,12 +22,36 @@ limitations under the License.
 
 #include "Nuclex/FrameFixer/Config.h"
 #include "./Frame.h"
+#include "./FrameDirectoryListing.h"
 
 #include <vector> // for std::vector
 #include <memory> // for std::shared_ptr
+#include <cstdint> // for std::uint64_t
+
+#include <QImage>
 
 #include <Nuclex/Platform/Tasks/CancellationWatcher.h> // for CancellationWatcher
 
+namespace Nuclex::FrameFixer::Rendering {
+
+  // ------------------------------------------------------------------------------------------- //
+
+  class VideoDecoder;
+
+  // ------------------------------------------------------------------------------------------- //
+
+} // namespace Nuclex::FrameFixer::Rendering
+
+namespace Nuclex::FrameFixer::Services {
+
+  // ------------------------------------------------------------------------------------------- //
+
+  class FrameCacheFile;
+
+  // ------------------------------------------------------------------------------------------- //
+
+} // namespace Nuclex::FrameFixer::Services
+
 namespace Nuclex::FrameFixer {
 
   // ------------------------------------------------------------------------------------------- //
@@ -38,15 +62,63 @@ namespace Nuclex::FrameFixer {
     typedef Nuclex::Platform::Tasks::CancellationWatcher CancellationWatcher;
 
     /// <summary>Path to the directory in which the frame images are stored</summary>
+    /// <remarks>
+    ///   If the movie was opened from a video file, this is the path of the video file.
+    /// </remarks>
     public: std::string FrameDirectory;
     /// <summary>Informations about each frame in the movie</summary>
     public: std::vector<Frame> Frames;
+    /// <summary>Decodes the frames if the movie was opened from a video file</summary>
+    public: std::shared_ptr<Rendering::VideoDecoder> Video;
+    /// <summary>Stores decoded frames for fast random access, if enabled</summary>
+    public: std::shared_ptr<Services::FrameCacheFile> CacheFile;
+
+    /// <summary>Sets up a movie from either a folder of images or a video file</summary>
+    /// <param name="path">Path of the frame folder or video file</param>
+    /// <param name="cancellationWatcher">Allows the scan to be cancelled</param>
+    /// <param name="progressCallback">
+    ///   Receives the filenames of a frame folder's images as they are found
+    /// </param>
+    /// <returns>A movie with all frames set up</returns>
+    public: static std::shared_ptr<Movie> Open(
+      const std::string &path,
+      const std::shared_ptr<const CancellationWatcher> &cancellationWatcher = (
+        std::shared_ptr<const CancellationWatcher>()
+      ),
+      const FrameDirectoryListing::ProgressCallback &progressCallback = (
+        FrameDirectoryListing::ProgressCallback()
+      )
+    );
 
     /// <summarys>Sets up a movie using images stored in a folder</summary>
     /// <param name="path">Path in which the movie's frames are stored</param>
     /// <param name="cancellationWatcher">Allows the scan to be cancelled</param>
+    /// <param name="progressCallback">Receives the filenames as they are found</param>
     /// <returns>A movie with all frames set up
+    /// <remarks>
+    ///   The listing of the folder is cached next to it (see
+    ///   <see cref="FrameDirectoryListing" />), so opening the same folder again
+    ///   does not require a scan unless files were added, removed or renamed.
+    /// </remarks>
     public: static std::shared_ptr<Movie> FromImageFolder(
+      const std::string &path,
+      const std::shared_ptr<const CancellationWatcher> &cancellationWatcher = (
+        std::shared_ptr<const CancellationWatcher>()
+      ),
+      const FrameDirectoryListing::ProgressCallback &progressCallback = (
+        FrameDirectoryListing::ProgressCallback()
+      )
+    );
+
+    /// <summary>Sets up a movie whose frames are decoded from a video file</summary>
+    /// <param name="path">Path of the video file</param>
+    /// <param name="cancellationWatcher">Allows the scan to be cancelled</param>
+    /// <returns>A movie with all frames set up</returns>
+    /// <remarks>
+    ///   This requires the application to be built with libav. Frames are decoded on
+    ///   demand, so there is no need to extract the video into an image folder first.
+    /// </remarks>
+    public: static std::shared_ptr<Movie> FromVideoFile(
       const std::string &path,
       const std::shared_ptr<const CancellationWatcher> &cancellationWatcher = (
         std::shared_ptr<const CancellationWatcher>()
@@ -60,13 +132,66 @@ namespace Nuclex::FrameFixer {
     /// </remarks>
     public: void SaveState() const;
 
+    /// <summary>Opens or prepares the frame cache file next to the movie</summary>
+    /// <remarks>
+    ///   Once enabled, each frame is stored in the frame cache file after it has been
+    ///   decoded for the first time and read from there, without decoding it again,
+    ///   until its image file (or the video) changes. The file takes up 8 bytes per pixel
+    ///   for each frame, so it should only be enabled if there is enough disk space.
+    /// </remarks>
+    public: void EnableCacheFile();
+
+    /// <summary>Forms the path of the frame cache file next to the movie</summary>
+    /// <returns>The path the frame cache file is or would be stored under</returns>
+    public: std::string GetCacheFilePath() const;
+
     /// <summary>Reconstitutes the full path to the image file for a specific frame</summary>
     /// <param name="frameIndex">Index of the frame whose path will be returned</param>
     /// <returns>The full path to the image file storing the requested frame</returns>
+    /// <remarks>
+    ///   For movies opened from a video file, this is the path of the video file.
+    /// </remarks>
     public: std::string GetFramePath(std::size_t frameIndex) const;
 
+    /// <summary>Loads the image of the specified frame</summary>
+    /// <param name="frameIndex">Index of the frame whose image will be loaded</param>
+    /// <returns>The image of the requested frame</returns>
+    /// <remarks>
+    ///   Frames decoded from a video file or read from the frame cache file are always
+    ///   delivered in QImage::Format_RGBA64, frames from image files in the format
+    ///   of the file.
+    /// </remarks>
+    public: QImage LoadFrame(std::size_t frameIndex) const;
+
+    /// <summary>Determines how many bytes have to be read to load a frame</summary>
+    /// <param name="frameIndex">Index of the frame whose stored size will be returned</param>
+    /// <returns>The size of the frame's image file or compressed video packet</returns>
+    public: std::uint64_t GetEncodedFrameSize(std::size_t frameIndex) const;
+
+    /// <summary>Restores the frame states from the text file next to the movie</summary>
+    /// <param name="movie">Movie whose frame states will be restored</param>
+    private: static void loadState(Movie &movie);
+
+    /// <summary>Loads the image of the specified frame from its image file or video</summary>
+    /// <param name="frameIndex">Index of the frame whose image will be loaded</param>
+    /// <returns>The image of the requested frame</returns>
+    private: QImage loadFrameFromSource(std::size_t frameIndex) const;
+
+    /// <summary>Calculates a stamp that changes when the source of a frame is modified</summary>
+    /// <param name="frameIndex">Index of the frame whose source will be identified</param>
+    /// <returns>A stamp identifying the current state of the frame's source</returns>
+    private: std::uint64_t getSourceStamp(std::size_t frameIndex) const;
+
     private: static std::string getStateFilePath(const std::string &frameDirectoryPath);
 
+    /// <summary>Forms the path of a file stored next to the frame directory</summary>
+    /// <param name="frameDirectoryPath">Path of the frame directory or video file</param>
+    /// <param name="extension">Extension that will be appended to the path</param>
+    /// <returns>The path of the file next to the frame directory</returns>
+    private: static std::string getSiblingPath(
+      const std::string &frameDirectoryPath, const std::string &extension
+    );
+
   };
 
   // ------------------------------------------------------------------------------------------- //
@@ -0,0 +1,178 @@
+#pragma region Apache License 2.0
+/*
+Nuclex Frame Fixer
+Copyright (C) 2024 Markus Ewald / Nuclex Development Labs
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#pragma endregion // Apache License 2.0
+
+// If the application is compiled as a DLL, this ensures symbols are exported
+#define NUCLEX_FRAMEFIXER_SOURCE 1
+
+#include "./CpuFeatures.h"
+
+#if defined(NUCLEX_FRAMEFIXER_HAVE_SSE2)
+  #if defined(_MSC_VER)
+    #include <intrin.h> // for __cpuid(), __cpuidex(), _xgetbv()
+  #else
+    #include <cpuid.h> // for __get_cpuid(), __get_cpuid_count()
+  #endif
+#endif
+
+#include <atomic> // for std::atomic
+#include <cstdint> // for std::uint32_t, std::uint64_t
+
+namespace {
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Instruction sets the CPU has been found to support</summary>
+  struct DetectedFeatures {
+
+    /// <summary>Queries the CPU for the instruction sets it supports</summary>
+    public: DetectedFeatures();
+
+    /// <summary>Whether SSE2 instructions can be used</summary>
+    public: bool Sse2;
+    /// <summary>Whether AVX2 instructions can be used</summary>
+    public: bool Avx2;
+
+  };
+
+  // ------------------------------------------------------------------------------------------- //
+
+#if defined(NUCLEX_FRAMEFIXER_HAVE_SSE2)
+  /// <summary>Runs the cpuid instruction for the specified leaf</summary>
+  /// <param name="leaf">Leaf (category of information) that will be queried</param>
+  /// <param name="subleaf">Sub-leaf that will be queried for leaves that have them</param>
+  /// <param name="registers">Receives the EAX, EBX, ECX and EDX registers</param>
+  /// <returns>True if the CPU supports the leaf, false otherwise</returns>
+  bool queryCpuId(std::uint32_t leaf, std::uint32_t subleaf, std::uint32_t registers[4]) {
+#if defined(_MSC_VER)
+    int values[4];
+    ::__cpuid(values, 0);
+    if(static_cast<std::uint32_t>(values[0]) < leaf) {
+      return false;
+    }
+
+    ::__cpuidex(values, static_cast<int>(leaf), static_cast<int>(subleaf));
+    for(std::size_t index = 0; index < 4; ++index) {
+      registers[index] = static_cast<std::uint32_t>(values[index]);
+    }
+    return true;
+#else
+    unsigned int eax, ebx, ecx, edx;
+    if(::__get_cpuid_count(leaf, subleaf, &eax, &ebx, &ecx, &edx) == 0) {
+      return false;
+    }
+
+    registers[0] = eax;
+    registers[1] = ebx;
+    registers[2] = ecx;
+    registers[3] = edx;
+    return true;
+#endif
+  }
+#endif // defined(NUCLEX_FRAMEFIXER_HAVE_SSE2)
+
+  // ------------------------------------------------------------------------------------------- //
+
+#if defined(NUCLEX_FRAMEFIXER_HAVE_SSE2)
+  /// <summary>Reads the XCR0 register telling which register states the OS saves</summary>
+  /// <returns>The contents of the XCR0 register</returns>
+  /// <remarks>
+  ///   Must only be called if cpuid reports OSXSAVE, otherwise the instruction faults.
+  /// </remarks>
+  std::uint64_t readExtendedControlRegister() {
+#if defined(_MSC_VER)
+    return static_cast<std::uint64_t>(::_xgetbv(0));
+#else
+    std::uint32_t eax, edx;
+    __asm__ volatile("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+    return (static_cast<std::uint64_t>(edx) << 32) | eax;
+#endif
+  }
+#endif // defined(NUCLEX_FRAMEFIXER_HAVE_SSE2)
+
+  // ------------------------------------------------------------------------------------------- //
+
+  DetectedFeatures::DetectedFeatures() :
+    Sse2(false),
+    Avx2(false) {
+#if defined(NUCLEX_FRAMEFIXER_HAVE_SSE2)
+    std::uint32_t registers[4];
+    if(!queryCpuId(1, 0, registers)) {
+      return;
+    }
+
+    this->Sse2 = ((registers[3] & (1U << 26)) != 0);
+
+    // AVX2 needs the OS to save the YMM registers (XCR0 bits 1 and 2), which can only
+    // be checked if the OS has enabled the XGETBV instruction (OSXSAVE, ECX bit 27)
+    bool hasOsXSave = ((registers[2] & (1U << 27)) != 0);
+    bool hasAvx = ((registers[2] & (1U << 28)) != 0);
+    if(!hasOsXSave || !hasAvx) {
+      return;
+    }
+    if((readExtendedControlRegister() & 0x6) != 0x6) {
+      return;
+    }
+
+    if(queryCpuId(7, 0, registers)) {
+      this->Avx2 = ((registers[1] & (1U << 5)) != 0);
+    }
+#endif // defined(NUCLEX_FRAMEFIXER_HAVE_SSE2)
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Returns the instruction sets supported by the CPU</summary>
+  /// <returns>The detected CPU features</returns>
+  const DetectedFeatures &getDetectedFeatures() {
+    static const DetectedFeatures features;
+    return features;
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Whether the AVX2 code paths may be used if the CPU supports them</summary>
+  std::atomic<bool> isAvx2Enabled(true);
+
+  // ------------------------------------------------------------------------------------------- //
+
+} // anonymous namespace
+
+namespace Nuclex::FrameFixer::Platform {
+
+  // ------------------------------------------------------------------------------------------- //
+
+  bool CpuFeatures::HasSse2() {
+    return getDetectedFeatures().Sse2;
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  bool CpuFeatures::HasAvx2() {
+    return getDetectedFeatures().Avx2 && isAvx2Enabled.load(std::memory_order_relaxed);
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  void CpuFeatures::SetAvx2Enabled(bool enabled) {
+    isAvx2Enabled.store(enabled, std::memory_order_relaxed);
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+} // namespace Nuclex::FrameFixer::Platform
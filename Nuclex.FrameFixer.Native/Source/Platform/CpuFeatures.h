@@ -0,0 +1,85 @@
+#pragma region Apache License 2.0
+/*
+Nuclex Frame Fixer
+Copyright (C) 2024 Markus Ewald / Nuclex Development Labs
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#pragma endregion // Apache License 2.0
+
+
+#ifndef NUCLEX_FRAMEFIXER_PLATFORM_CPUFEATURES_H
+#define NUCLEX_FRAMEFIXER_PLATFORM_CPUFEATURES_H
+
+#include "Nuclex/FrameFixer/Config.h"
+
+// SSE2 is part of the x64 instruction set, on 32 bit x86 the compiler has to be told
+// to use it. Code using SSE2 intrinsics is compiled in whenever they are available.
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+  #define NUCLEX_FRAMEFIXER_HAVE_SSE2 1
+#endif
+
+// AVX2 code is always compiled in on x86 and x64 (without requiring the whole program
+// to be compiled for AVX2) and only called if CpuFeatures::HasAvx2() says it can be.
+// GCC and clang need each function using AVX2 intrinsics to be marked for that target.
+#if defined(NUCLEX_FRAMEFIXER_HAVE_SSE2)
+  #define NUCLEX_FRAMEFIXER_HAVE_AVX2 1
+  #if defined(_MSC_VER)
+    #define NUCLEX_FRAMEFIXER_AVX2_FUNCTION
+  #else
+    #define NUCLEX_FRAMEFIXER_AVX2_FUNCTION __attribute__((target("avx2")))
+  #endif
+#endif
+
+namespace Nuclex::FrameFixer::Platform {
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Reports which optional instruction sets the CPU can execute</summary>
+  /// <remarks>
+  ///   The CPU is queried via cpuid the first time any of the methods is called and
+  ///   the results are remembered from then on. On CPUs other than x86 and x64, all
+  ///   methods return false.
+  /// </remarks>
+  class CpuFeatures {
+
+    /// <summary>Checks whether the CPU supports SSE2 instructions</summary>
+    /// <returns>True if SSE2 instructions can be used</returns>
+    public: static bool HasSse2();
+
+    /// <summary>Checks whether the CPU and operating system support AVX2 instructions</summary>
+    /// <returns>True if AVX2 instructions can be used</returns>
+    /// <remarks>
+    ///   Besides the CPU, the operating system needs to save the upper halves of
+    ///   the 256 bit registers when switching threads, so this is checked, too.
+    /// </remarks>
+    public: static bool HasAvx2();
+
+    /// <summary>Switches the AVX2 code paths on or off</summary>
+    /// <param name="enabled">
+    ///   Whether HasAvx2() may report AVX2 support. AVX2 is still only reported if
+    ///   the CPU actually supports it.
+    /// </param>
+    /// <remarks>
+    ///   This lets the unit tests and benchmarks run the SSE2 code paths on CPUs that
+    ///   support AVX2. It should be called before any work that checks for AVX2 begins.
+    /// </remarks>
+    public: static void SetAvx2Enabled(bool enabled);
+
+  };
+
+  // ------------------------------------------------------------------------------------------- //
+
+} // namespace Nuclex::FrameFixer::Platform
+
+#endif // NUCLEX_FRAMEFIXER_PLATFORM_CPUFEATURES_H
@@ -24,6 +24,8 @@ limitations under the License.
 
 #if defined(NUCLEX_FRAMEFIXER_ENABLE_LIBAV)
 
+#include "../Diagnostics/TraceRecorder.h"
+
 #include <stdexcept> // for std::runtime_error
 
 #include <Nuclex/Support/Text/LexicalAppend.h>
@@ -191,6 +193,7 @@ namespace Nuclex::FrameFixer::Platform {
     const std::shared_ptr<::AVFrame> &frame,
     const std::string &inputFilterContextName /* = std::string(u8"in") */
   ) {
+    NUCLEX_FRAMEFIXER_TRACE_SCOPE(u8"libav", u8"Push frame into filter graph");
     AVFilterContext *bufferFilterContext = ::avfilter_graph_get_filter(
       filterGraph.get(), inputFilterContextName.c_str()
     );
@@ -217,6 +220,9 @@ namespace Nuclex::FrameFixer::Platform {
     const std::shared_ptr<::AVFilterGraph> &filterGraph,
     const std::string &sinkFilterContextName /* = std::string(u8"out") */
   ) {
+    // The filters run while the buffer sink is asked for a frame, so this span
+    // is where the actual deinterlacing work of libav shows up in the trace
+    NUCLEX_FRAMEFIXER_TRACE_SCOPE(u8"libav", u8"Read frame from filter graph");
     AVFilterContext *buffersinkFilterContext = ::avfilter_graph_get_filter(
       filterGraph.get(), sinkFilterContextName.c_str()
     );
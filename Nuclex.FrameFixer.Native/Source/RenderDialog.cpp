@@ -33,11 +33,67 @@ limitations under the License.
 #include "./Algorithm/Deinterlacing/Deinterlacer.h"
 #include "./Algorithm/Interpolation/FrameInterpolator.h"
 
+#include "./Rendering/ImageFormats/PngImageEncoder.h"
+#include "./Rendering/ImageFormats/TiffImageEncoder.h"
+#include "./Rendering/ImageFormats/QoiImageEncoder.h"
+
 #include <QFileDialog> // for QFileDialog, shows file and folder selection dialogs
 #include <QCloseEvent> // for QCloseEvent
 #include <QMessageBox> // for QMessageBox
 #include <QRadioButton> // for QRadioButton
 
+namespace {
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Video codecs offered in the output format combo box, in order</summary>
+  /// <remarks>
+  ///   The video codecs are listed after the image formats and are only available
+  ///   if the application was built with libav.
+  /// </remarks>
+  const Nuclex::FrameFixer::Rendering::VideoCodec VideoCodecs[] = {
+    Nuclex::FrameFixer::Rendering::VideoCodec::Ffv1,
+    Nuclex::FrameFixer::Rendering::VideoCodec::H264,
+    Nuclex::FrameFixer::Rendering::VideoCodec::H265
+  };
+
+  /// <summary>Names under which the video codecs are listed, in the same order</summary>
+  const char *const VideoCodecNames[] = {
+    u8"FFV1 video (lossless)",
+    u8"H.264 video (x264)",
+    u8"H.265 video (x265)"
+  };
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Ways of averaging frames offered in the averaging combo box, in order</summary>
+  const Nuclex::FrameFixer::AverageMode AverageModes[] = {
+    Nuclex::FrameFixer::AverageMode::Mean,
+    Nuclex::FrameFixer::AverageMode::Median,
+    Nuclex::FrameFixer::AverageMode::TrimmedMean
+  };
+
+  /// <summary>Names under which the ways of averaging are listed, in the same order</summary>
+  const char *const AverageModeNames[] = {
+    u8"Mean (fastest)",
+    u8"Median (rejects outliers)",
+    u8"Trimmed mean (rejects outliers, less noise)"
+  };
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Frame rate that will be stored in videos</summary>
+  /// <remarks>
+  ///   Detelecined NTSC material plays at the film rate of 24000/1001 frames per second.
+  /// </remarks>
+  const std::size_t VideoFrameRateNumerator = 24000;
+
+  /// <summary>Denominator of the frame rate that will be stored in videos</summary>
+  const std::size_t VideoFrameRateDenominator = 1001;
+
+  // ------------------------------------------------------------------------------------------- //
+
+}
+
 namespace Nuclex::FrameFixer {
 
   // ------------------------------------------------------------------------------------------- //
@@ -47,7 +103,8 @@ namespace Nuclex::FrameFixer {
     ui(std::make_unique<Ui::RenderDialog>()),
     servicesRoot(),
     deinterlacerModel(std::make_unique<DeinterlacerItemModel>()),
-    interpolatorModel(std::make_unique<InterpolatorItemModel>()) {
+    interpolatorModel(std::make_unique<InterpolatorItemModel>()),
+    imageEncoders() {
 
     this->ui->setupUi(this);
 
@@ -55,6 +112,10 @@ namespace Nuclex::FrameFixer {
       this->ui->browseTargetDirectoryButton, &QPushButton::clicked,
       this, &RenderDialog::browseTargetDirectoryClicked
     );
+    connect(
+      this->ui->outputFormatCombo, QOverload<int>::of(&QComboBox::currentIndexChanged),
+      this, &RenderDialog::outputFormatChosen
+    );
     connect(
       this->ui->renderAllChoice, &QRadioButton::toggled,
       this, &RenderDialog::everythingChosen
@@ -71,6 +132,36 @@ namespace Nuclex::FrameFixer {
     this->ui->deinterlacerCombo->setModel(this->deinterlacerModel.get());
     this->ui->interpolatorCombo->setModel(this->interpolatorModel.get());
 
+    // Image formats, beginning with the default. The faster formats are meant for
+    // intermediate frames that will be fed into a video encoder afterwards.
+    this->imageEncoders.push_back(std::make_shared<Rendering::ImageFormats::PngImageEncoder>());
+    this->imageEncoders.push_back(
+      std::make_shared<Rendering::ImageFormats::PngImageEncoder>(
+        1, Rendering::ImageFormats::PngFilter::Up
+      )
+    );
+    this->imageEncoders.push_back(std::make_shared<Rendering::ImageFormats::TiffImageEncoder>());
+    this->imageEncoders.push_back(std::make_shared<Rendering::ImageFormats::QoiImageEncoder>());
+    for(std::size_t index = 0; index < this->imageEncoders.size(); ++index) {
+      this->ui->outputFormatCombo->addItem(
+        QString::fromStdString(this->imageEncoders[index]->GetName())
+      );
+    }
+
+    // Video output is only available if the application was built with libav
+#if defined(NUCLEX_FRAMEFIXER_ENABLE_LIBAV)
+    for(const char *videoCodecName : VideoCodecNames) {
+      this->ui->outputFormatCombo->addItem(QString(videoCodecName));
+    }
+#endif
+    this->ui->outputFormatCombo->setCurrentIndex(0);
+
+    for(const char *averageModeName : AverageModeNames) {
+      this->ui->averageModeCombo->addItem(QString(averageModeName));
+    }
+    this->ui->averageModeCombo->setCurrentIndex(0);
+
+    outputFormatChosen(0);
     everythingChosen(true);
   }
 
@@ -183,6 +274,50 @@ namespace Nuclex::FrameFixer {
 
   // ------------------------------------------------------------------------------------------- //
 
+  AverageMode RenderDialog::GetAverageMode() const {
+    std::size_t averageModeCount = sizeof(AverageModes) / sizeof(AverageModes[0]);
+    int index = this->ui->averageModeCombo->currentIndex();
+    if((index >= 0) && (static_cast<std::size_t>(index) < averageModeCount)) {
+      return AverageModes[static_cast<std::size_t>(index)];
+    } else {
+      return AverageMode::Mean;
+    }
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  std::optional<Rendering::VideoSettings> RenderDialog::GetVideoSettings() const {
+    Rendering::VideoSettings settings;
+    settings.Quality = this->ui->videoQualityNumber->value();
+    settings.FrameRateNumerator = VideoFrameRateNumerator;
+    settings.FrameRateDenominator = VideoFrameRateDenominator;
+
+    std::optional<std::size_t> videoCodecIndex = getSelectedVideoCodecIndex(
+      this->ui->outputFormatCombo->currentIndex()
+    );
+    if(!videoCodecIndex.has_value()) {
+      return std::optional<Rendering::VideoSettings>();
+    }
+
+    settings.Codec = VideoCodecs[videoCodecIndex.value()];
+    return settings;
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  std::shared_ptr<
+    Rendering::ImageFormats::ImageEncoder
+  > RenderDialog::GetImageEncoder() const {
+    int index = this->ui->outputFormatCombo->currentIndex();
+    if((index >= 0) && (static_cast<std::size_t>(index) < this->imageEncoders.size())) {
+      return this->imageEncoders[static_cast<std::size_t>(index)];
+    } else {
+      return std::shared_ptr<Rendering::ImageFormats::ImageEncoder>();
+    }
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
   void RenderDialog::SetInitialframeCount(std::size_t frameCount) {
     this->ui->inputEndFrameNumber->setValue(static_cast<int>(frameCount));
   }
@@ -260,6 +395,36 @@ namespace Nuclex::FrameFixer {
 
   // ------------------------------------------------------------------------------------------- //
 
+  void RenderDialog::outputFormatChosen(int index) {
+    std::optional<std::size_t> videoCodecIndex = getSelectedVideoCodecIndex(index);
+    bool isLossy = (
+      videoCodecIndex.has_value() &&
+      (VideoCodecs[videoCodecIndex.value()] != Rendering::VideoCodec::Ffv1)
+    );
+
+    this->ui->videoQualityLabel->setEnabled(isLossy);
+    this->ui->videoQualityNumber->setEnabled(isLossy);
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  std::optional<std::size_t> RenderDialog::getSelectedVideoCodecIndex(int index) const {
+    if(index < 0) {
+      return std::optional<std::size_t>();
+    }
+
+    std::size_t imageEncoderCount = this->imageEncoders.size();
+    std::size_t videoCodecCount = sizeof(VideoCodecs) / sizeof(VideoCodecs[0]);
+    std::size_t formatIndex = static_cast<std::size_t>(index);
+    if((formatIndex < imageEncoderCount) || (formatIndex >= imageEncoderCount + videoCodecCount)) {
+      return std::optional<std::size_t>();
+    }
+
+    return formatIndex - imageEncoderCount;
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
   void RenderDialog::browseTargetDirectoryClicked() {
     std::unique_ptr<QFileDialog> selectDirectoryDialog = (
       std::make_unique<QFileDialog>(this)
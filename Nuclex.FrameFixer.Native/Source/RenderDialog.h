@@ -21,11 +21,14 @@ limitations under the License.
 #define NUCLEX_FRAMEFIXER_RENDERDIALOG_H
 
 #include "Nuclex/FrameFixer/Config.h"
+#include "./Rendering/VideoSettings.h"
+#include "./Algorithm/AverageMode.h"
 
 #include <QDialog> // for QDialog
 #include <memory> // for std::unique_ptr
 #include <optional> // for std::optional
 #include <map> // for std::pair
+#include <vector> // for std::vector
 
 namespace Ui {
 
@@ -47,6 +50,16 @@ namespace Nuclex::FrameFixer::Services {
 
 }
 
+namespace Nuclex::FrameFixer::Rendering::ImageFormats {
+
+  // ------------------------------------------------------------------------------------------- //
+
+  class ImageEncoder;
+
+  // ------------------------------------------------------------------------------------------- //
+
+}
+
 namespace Nuclex::FrameFixer::Algorithm::Deinterlacing {
 
   // ------------------------------------------------------------------------------------------- //
@@ -127,6 +140,24 @@ namespace Nuclex::FrameFixer {
       Algorithm::Interpolation::FrameInterpolator
     > GetSelectedInterpolator() const;
 
+    /// <summary>Returns how frames tagged for averaging should be combined</summary>
+    /// <returns>The way of averaging frames selected by the user</returns>
+    public: AverageMode GetAverageMode() const;
+
+    /// <summary>Returns the video settings if the user wants to render into a video</summary>
+    /// <returns>
+    ///   The codec and quality selected by the user or an empty value if the output
+    ///   frames should be saved as individual images
+    /// </returns>
+    public: std::optional<Rendering::VideoSettings> GetVideoSettings() const;
+
+    /// <summary>Returns the image format the output frames should be saved in</summary>
+    /// <returns>
+    ///   The encoder for the image format selected by the user or an empty pointer
+    ///   if the output frames should be encoded into a video
+    /// </returns>
+    public: std::shared_ptr<Rendering::ImageFormats::ImageEncoder> GetImageEncoder() const;
+
     /// <summary>Verifies the settings when the dialog is closed via the okay button</summary>
     protected: void accept() override;
 
@@ -148,6 +179,18 @@ namespace Nuclex::FrameFixer {
     /// </param>
     private: void outputFrameRangeChosen(bool checked);
 
+    /// <summary>Enables or disables the quality setting when an output format is chosen</summary>
+    /// <param name="index">Index of the output format that has been selected</param>
+    private: void outputFormatChosen(int index);
+
+    /// <summary>Looks up the video codec an entry in the output format list stands for</summary>
+    /// <param name="index">Index of the entry in the output format list</param>
+    /// <returns>
+    ///   The index of the video codec in the list of video codecs or an empty value if
+    ///   the entry is an image format
+    /// </returns>
+    private: std::optional<std::size_t> getSelectedVideoCodecIndex(int index) const;
+
     /// <summary>Opens the directory browser when the user clicks on the browse button</summary>
     private: void browseTargetDirectoryClicked();
 
@@ -182,6 +225,8 @@ namespace Nuclex::FrameFixer {
     private: std::unique_ptr<DeinterlacerItemModel> deinterlacerModel;
     /// <summary>Item model for the inerpolator selection</summary>
     private: std::unique_ptr<InterpolatorItemModel> interpolatorModel; 
+    /// <summary>Image formats offered in the output format list, in order</summary>
+    private: std::vector<std::shared_ptr<Rendering::ImageFormats::ImageEncoder>> imageEncoders;
 
   };
 
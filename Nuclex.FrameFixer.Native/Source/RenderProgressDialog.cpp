@@ -25,12 +25,140 @@ limitations under the License.
 
 #include "./Services/ServicesRoot.h" // for ServicesRoot
 #include "./Renderer.h"
+#include "./Rendering/RenderStatistics.h"
+#include "./Rendering/FrameMemoryBudget.h"
 
 #include <QTimer>
 
 #include <Nuclex/Support/Errors/CanceledError.h>
 #include <Nuclex/Support/Text/LexicalAppend.h>
 
+#include <cmath> // for std::round()
+
+namespace {
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Appends a number to a string, padding it to two digits</summary>
+  /// <param name="target">String the number will be appended to</param>
+  /// <param name="number">Number that will be appended</param>
+  void appendTwoDigits(std::string &target, std::size_t number) {
+    if(number < 10) {
+      target.push_back(u8'0');
+    }
+    Nuclex::Support::Text::lexical_append(target, number);
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Describes the frame rate and remaining time of a render</summary>
+  /// <param name="statistics">Statistics of the render that is running</param>
+  /// <param name="remainingFrameCount">Number of frames that still need to be rendered</param>
+  /// <returns>A short text stating the frames per second and the estimated time left</returns>
+  std::string describeThroughput(
+    const Nuclex::FrameFixer::Rendering::RenderStatistics &statistics,
+    std::size_t remainingFrameCount
+  ) {
+    double framesPerSecond = statistics.GetFramesPerSecond();
+
+    std::string text;
+    Nuclex::Support::Text::lexical_append(
+      text, std::round(framesPerSecond * 10.0) / 10.0
+    );
+    text.append(u8" fps, ETA: ", 11);
+    if(framesPerSecond <= 0.0) {
+      text.append(u8"unknown", 7);
+      return text;
+    }
+
+    std::size_t remainingSeconds = static_cast<std::size_t>(
+      static_cast<double>(remainingFrameCount) / framesPerSecond
+    );
+    text.push_back(u8'~');
+    appendTwoDigits(text, remainingSeconds / 3600);
+    text.push_back(u8':');
+    appendTwoDigits(text, (remainingSeconds / 60) % 60);
+    text.push_back(u8':');
+    appendTwoDigits(text, remainingSeconds % 60);
+    return text;
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Describes how much memory the frames in flight currently take up</summary>
+  /// <param name="memoryBudget">Budget limiting the memory used by the render</param>
+  /// <returns>A short text stating the current and peak memory use in MiB</returns>
+  std::string describeMemoryUsage(
+    const Nuclex::FrameFixer::Rendering::FrameMemoryBudget &memoryBudget
+  ) {
+    const std::size_t bytesPerMebibyte = 1024 * 1024;
+
+    std::string text;
+    Nuclex::Support::Text::lexical_append(
+      text, memoryBudget.GetCurrentUsage() / bytesPerMebibyte
+    );
+    text.append(u8" MiB of frames in memory, peak ", 31);
+    Nuclex::Support::Text::lexical_append(text, memoryBudget.GetPeakUsage() / bytesPerMebibyte);
+    text.append(u8" MiB", 4);
+
+    std::size_t limit = memoryBudget.GetLimit();
+    if(limit != 0) {
+      text.append(u8" of ", 4);
+      Nuclex::Support::Text::lexical_append(text, limit / bytesPerMebibyte);
+      text.append(u8" MiB", 4);
+    }
+
+    return text;
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Names the stage of the render pipeline that has taken the most time</summary>
+  /// <param name="statistics">Statistics of the render that is running</param>
+  /// <returns>A short text naming the slowest stage and its share of the time</returns>
+  std::string describeSlowestStage(
+    const Nuclex::FrameFixer::Rendering::RenderStatistics &statistics
+  ) {
+    using Nuclex::FrameFixer::Rendering::RenderStage;
+    using Nuclex::FrameFixer::Rendering::RenderStatistics;
+
+    std::chrono::nanoseconds totalTime(0), slowestTime(0);
+    RenderStage slowestStage = RenderStage::Decode;
+    for(
+      std::size_t stageIndex = 0;
+      stageIndex <= static_cast<std::size_t>(RenderStage::Write);
+      ++stageIndex
+    ) {
+      RenderStage stage = static_cast<RenderStage>(stageIndex);
+      std::chrono::nanoseconds stageTime = statistics.GetStageStatistics(stage).TotalTime;
+      totalTime += stageTime;
+      if(stageTime > slowestTime) {
+        slowestTime = stageTime;
+        slowestStage = stage;
+      }
+    }
+
+    std::string text(u8"Rendering...", 12);
+    if(totalTime.count() > 0) {
+      text.append(u8" (most time spent in ", 21);
+      text.append(RenderStatistics::GetStageName(slowestStage));
+      text.append(u8": ", 2);
+      Nuclex::Support::Text::lexical_append(
+        text,
+        static_cast<std::size_t>(
+          static_cast<double>(slowestTime.count()) * 100.0 /
+          static_cast<double>(totalTime.count())
+        )
+      );
+      text.append(u8"%)", 2);
+    }
+    return text;
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+} // anonymous namespace
+
 namespace Nuclex::FrameFixer {
 
   // ------------------------------------------------------------------------------------------- //
@@ -131,7 +259,9 @@ namespace Nuclex::FrameFixer {
         status.append(u8" out of ");
         Nuclex::Support::Text::lexical_append(status, this->totalFrameCount);
       }
-      
+      status.push_back(u8'\n');
+      status.append(describeMemoryUsage(*this->renderer->GetFrameMemoryBudget()));
+
       this->ui->currentFrameLabel->setText(QString::fromStdString(status));
 
       if(this->totalFrameCount != std::size_t(-1)) {
@@ -144,6 +274,20 @@ namespace Nuclex::FrameFixer {
         this->ui->progressBar->setValue(
           static_cast<double>(completedFrameCount) / static_cast<double>(totalFrameCount) * 100.0
         );
+
+        std::size_t remainingFrameCount = 0;
+        if(completedFrameCount < this->totalFrameCount) {
+          remainingFrameCount = this->totalFrameCount - completedFrameCount;
+        }
+        std::shared_ptr<const Rendering::RenderStatistics> statistics = (
+          this->renderer->GetStatistics()
+        );
+        this->ui->etaLabel->setText(
+          QString::fromStdString(describeThroughput(*statistics, remainingFrameCount))
+        );
+        this->ui->renderingLabel->setText(
+          QString::fromStdString(describeSlowestStage(*statistics))
+        );
       }
 
     }
@@ -25,115 +25,43 @@ limitations under the License.
 #include "./Model/Movie.h"
 #include "./Algorithm/Deinterlacing/Deinterlacer.h"
 #include "./Algorithm/Interpolation/FrameInterpolator.h"
+#include "./Algorithm/AverageAccumulator.h"
 #include "./Algorithm/Averager.h"
-
-#include <Nuclex/Support/Text/LexicalCast.h>
+#include "./Rendering/FrameBufferPool.h"
+#include "./Rendering/FrameLoader.h"
+#include "./Rendering/FrameMemoryBudget.h"
+#include "./Rendering/FrameWriter.h"
+#include "./Rendering/RenderPlan.h"
+#include "./Rendering/RenderManifest.h"
+#include "./Rendering/RenderStatistics.h"
+#include "./Services/FrameCache.h"
+#include "./Diagnostics/TraceRecorder.h"
 
 #include <QPixmap>
 
-namespace {
-
-  // ------------------------------------------------------------------------------------------- //
+#include <algorithm> // for std::min(), std::max()
+#include <thread> // for std::thread
+#include <exception> // for std::exception_ptr
 
-  /// <summary>Determines the final frame type as which a frame will be processed</summary>
-  /// <param name="frame">Frame whose type will be determined</param>
-  /// <param name="flip">Whether the flip field order option is turned on</param>
-  /// <returns>The frame type of the specified frame</returns>
-  Nuclex::FrameFixer::FrameAction getFrameType(
-    const Nuclex::FrameFixer::Frame &frame, bool flip = false
-  ) {
-    using Nuclex::FrameFixer::FrameAction;
-
-    // Use the assigned frame type. If none was assigned, use the determined frame type
-    // which is calculated by other parts of the application by either detecting combing
-    // patterns or repeating the most recent 5-frame cycle.
-    FrameAction frameType = frame.Action;
-    if(frameType == FrameAction::Unknown) {
-      // TODO: Re-enable once the DeinterlaceMode split is complete
-      //frameType = frame.ProvisionalMode;
-    }
-
-    // Swap top and bottom field enum values if the field order is set to flipped.
-    if(flip) {
-      switch(frameType) {
-        case FrameAction::TopFieldFirst: { frameType = FrameAction::BottomFieldFirst; break; }
-        case FrameAction::BottomFieldFirst: { frameType = FrameAction::TopFieldFirst; break; }
-        case FrameAction::TopFieldOnly: { frameType = FrameAction::BottomFieldOnly; break; }
-        case FrameAction::BottomFieldOnly: { frameType = FrameAction::TopFieldOnly; break; }
-        default: { break; }
-      }
-    }
-
-    return frameType;
-  }
+namespace {
 
   // ------------------------------------------------------------------------------------------- //
 
-  /// <summary>
-  ///   Saves a frame as a PNG in the target directory if conditions are fulfilled
-  /// </summary>
-  /// <param name="image">Image containing the pixels that will potentially be saved</param>
-  /// <param name="directory">Directory in which the frame will be saved as a PNG</param>
-  /// <param name="inputFrameIndex">
-  ///   Index of the source frame that produced this outputframe
-  /// </param>
-  /// <param name="outputFrameIndex">Index of the output frame</param>
-  /// <param name="inputFrameRange">Optional range of input frames that will be saved</param>
-  /// <param name="outputFrameRange">Optional range of output frames that will be saved</param>
-  void saveImage(
-    QImage &image,
-    const std::string &directory,
-    std::size_t inputFrameIndex,
-    std::size_t outputFrameIndex,
-    const std::optional<std::pair<std::size_t, std::size_t>> &inputFrameRange,
-    const std::optional<std::pair<std::size_t, std::size_t>> &outputFrameRange
-  ) {
+  /// <summary>Number of input frames that will be decoded ahead unless configured</summary>
+  const std::size_t DefaultReadAheadDepth = 8;
 
-    // If the user limited the export by an input frame range,
-    // only write the file if the input frame index is within that range
-    if(inputFrameRange.has_value()) {
-      bool isInRange = (
-        (inputFrameIndex >= inputFrameRange.value().first) &&
-        (inputFrameIndex < inputFrameRange.value().second)
-      );
-      if(!isInRange) {
-        return;
-      }
-    }
+  /// <summary>Number of output frames that can wait to be written per encoder thread</summary>
+  const std::size_t WriteBehindFramesPerThread = 2;
 
-    // If the user limited the export by an input frame range,
-    // only write the file if the input frame index is within that range
-    if(outputFrameRange.has_value()) {
-      bool isInRange = (
-        (outputFrameIndex >= outputFrameRange.value().first) &&
-        (outputFrameIndex < outputFrameRange.value().second)
-      );
-      if(!isInRange) {
-        return;
-      }
-    }
+  /// <summary>Number of segments to aim for per thread when rendering in parallel</summary>
+  /// <remarks>
+  ///   Using more segments than threads evens out the load when some segments turn out
+  ///   to be more expensive (for example due to interpolated frames) than others.
+  /// </remarks>
+  const std::size_t SegmentsPerThread = 4;
 
-    std::string path;
-    {
-      std::string::size_type length = directory.length();
-      if((length >= 1) && (directory[length - 1] != '/')) {
-        path = directory + u8"/";
-      } else {
-        path = directory;
-      }
-
-      std::string filename = Nuclex::Support::Text::lexical_cast<std::string>(outputFrameIndex);
-      for(std::size_t index = filename.length(); index < 8; ++index) {
-        path.push_back(u8'0');
-      }
-    
-      path.append(filename);
-      path.append(u8".png");
-    }
-
-    image.save(QString::fromStdString(path), u8"PNG");
-
-  }
+  /// <summary>Minimum number of operations in a segment rendered in parallel</summary>
+  const std::size_t MinimumSegmentLength = 24;
 
   // ------------------------------------------------------------------------------------------- //
 
@@ -149,6 +77,22 @@ namespace Nuclex::FrameFixer {
     outputFrameRange(),
     flipFields(false),
     collapseAverageFrames(false),
+    averageMode(AverageMode::Mean),
+    pipelined(false),
+    encoderThreadCount(1),
+    processingThreadCount(1),
+    readAheadDepth(DefaultReadAheadDepth),
+    readAheadThreadCount(1),
+    incremental(false),
+    savesStatistics(true),
+    imageEncoder(),
+    videoSettings(),
+    streamSettings(),
+    interpolatorMutex(),
+    frameCache(),
+    statistics(std::make_shared<Rendering::RenderStatistics>()),
+    memoryBudget(std::make_shared<Rendering::FrameMemoryBudget>()),
+    frameBufferPool(std::make_shared<Rendering::FrameBufferPool>()),
     completedFrameCount(0) {}
 
   // ------------------------------------------------------------------------------------------- //
@@ -185,6 +129,96 @@ namespace Nuclex::FrameFixer {
 
   // ------------------------------------------------------------------------------------------- //
 
+  void Renderer::SetAverageMode(AverageMode mode) {
+    this->averageMode = mode;
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  void Renderer::SetFrameCache(const std::shared_ptr<Services::FrameCache> &frameCache) {
+    this->frameCache = frameCache;
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  void Renderer::SetFrameMemoryBudget(std::size_t limitInBytes) {
+    this->memoryBudget->SetLimit(limitInBytes);
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  std::shared_ptr<const Rendering::FrameMemoryBudget> Renderer::GetFrameMemoryBudget() const {
+    return this->memoryBudget;
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  void Renderer::EnablePipelining(bool enable /* = true */) {
+    this->pipelined = enable;
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  void Renderer::SetEncoderThreadCount(std::size_t threadCount) {
+    this->encoderThreadCount = threadCount;
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  void Renderer::SetReadAheadDepth(std::size_t frameCount) {
+    this->readAheadDepth = frameCount;
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  void Renderer::SetReadAheadThreadCount(std::size_t threadCount) {
+    this->readAheadThreadCount = threadCount;
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  void Renderer::SetProcessingThreadCount(std::size_t threadCount) {
+    this->processingThreadCount = threadCount;
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  void Renderer::EnableIncrementalRendering(bool enable /* = true */) {
+    this->incremental = enable;
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  void Renderer::EnableStatisticsFile(bool enable /* = true */) {
+    this->savesStatistics = enable;
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  void Renderer::SetImageEncoder(
+    const std::shared_ptr<Rendering::ImageFormats::ImageEncoder> &imageEncoder
+  ) {
+    this->imageEncoder = imageEncoder;
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  void Renderer::SetVideoOutput(
+    const std::optional<Rendering::VideoSettings> &videoSettings
+  ) {
+    this->videoSettings = videoSettings;
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  void Renderer::SetStreamOutput(
+    const std::optional<Rendering::StreamSettings> &streamSettings
+  ) {
+    this->streamSettings = streamSettings;
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
   void Renderer::RestrictRangeOfInputFrames(
     std::size_t startFrameIndex, std::size_t endFrameIndex
   ) {
@@ -205,194 +239,717 @@ namespace Nuclex::FrameFixer {
 
   // ------------------------------------------------------------------------------------------- //
 
+  std::shared_ptr<const Rendering::RenderStatistics> Renderer::GetStatistics() const {
+    return this->statistics;
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  std::pair<std::size_t, std::size_t> Renderer::GetOutputFrameRange(
+    const std::shared_ptr<Movie> &movie
+  ) const {
+    Rendering::RenderPlan plan = compilePlan(*movie);
+
+    // Output frames are numbered in the order of the operations producing them, so
+    // the output frames of a range of input frames form one contiguous range, too.
+    std::size_t startOutputFrameIndex = 1;
+    std::size_t endOutputFrameIndex = plan.GetEndOutputFrameIndex();
+    if(this->inputFrameRange.has_value()) {
+      startOutputFrameIndex = plan.GetFirstOutputFrameIndex(
+        plan.FindFirstOperationOfInputFrame(this->inputFrameRange.value().first)
+      );
+      endOutputFrameIndex = plan.GetFirstOutputFrameIndex(
+        plan.FindFirstOperationOfInputFrame(this->inputFrameRange.value().second)
+      );
+    }
+    if(this->outputFrameRange.has_value()) {
+      startOutputFrameIndex = std::max(
+        startOutputFrameIndex, this->outputFrameRange.value().first
+      );
+      endOutputFrameIndex = std::min(
+        endOutputFrameIndex, this->outputFrameRange.value().second
+      );
+    }
+
+    if(endOutputFrameIndex < startOutputFrameIndex) {
+      endOutputFrameIndex = startOutputFrameIndex;
+    }
+
+    return std::pair<std::size_t, std::size_t>(startOutputFrameIndex, endOutputFrameIndex);
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
   std::size_t Renderer::GetTotalFrameCount(
     const std::shared_ptr<Movie> &movie
   ) const {
-    std::size_t outputFrameIndex = 1;
-    std::size_t totalFrameCount = 0;
-
-    std::size_t frameCount = movie->Frames.size();
-    for(std::size_t frameIndex = 0; frameIndex < frameCount; ++frameIndex) {
-      const Frame &currentFrame = movie->Frames[frameIndex];
-      FrameAction currentFrameType = getFrameType(currentFrame, this->flipFields);
-
-      bool render = true;
-      if(this->inputFrameRange.has_value()) {
-        render &= (
-          (frameIndex >= this->inputFrameRange.value().first) &&
-          (frameIndex < this->inputFrameRange.value().second)
+    std::pair<std::size_t, std::size_t> outputFrameRange = GetOutputFrameRange(movie);
+    return outputFrameRange.second - outputFrameRange.first;
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  void Renderer::Render(
+    const std::shared_ptr<Movie> &movie,
+    const std::string &directory,
+    const std::shared_ptr<const Nuclex::Platform::Tasks::CancellationWatcher> &canceller /* = (
+      std::shared_ptr<Nuclex::Platform::Tasks::CancellationWatcher>()
+    ) */
+  ) {
+    NUCLEX_FRAMEFIXER_TRACE_SCOPE(u8"render", u8"Render");
+    this->completedFrameCount.store(0, std::memory_order::memory_order_release);
+    this->statistics->Reset();
+
+    // The frame cache is shared with the user interface, so remember how much it had
+    // read before and attribute only what it reads from here on to the render
+    std::uint64_t cacheReadByteCount = 0;
+    if(static_cast<bool>(this->frameCache)) {
+      cacheReadByteCount = this->frameCache->GetReadByteCount();
+      this->frameCache->SetMemoryBudget(this->memoryBudget);
+    }
+    this->memoryBudget->ResetPeakUsage();
+
+    // Work out which operations produce the frames that have been requested. Rendering
+    // has to begin at an operation that does not depend on the frames before it.
+    Rendering::RenderPlan plan = compilePlan(*movie);
+    std::size_t startOperationIndex, endOperationIndex;
+    findOperationRange(plan, startOperationIndex, endOperationIndex);
+    if(startOperationIndex >= endOperationIndex) {
+      return; // Nothing to render
+    }
+    std::size_t firstOutputOperationIndex = startOperationIndex;
+    startOperationIndex = plan.FindIndependentOperation(startOperationIndex);
+
+    // When rendering incrementally, look up which output frames a prior render into
+    // the same directory already produced from identical inputs. Only the runs of
+    // operations that produce outdated frames need to be executed then.
+    Rendering::FrameWriter writer(directory);
+    writer.SetStatistics(this->statistics);
+    writer.SetMemoryBudget(this->memoryBudget);
+    if(static_cast<bool>(this->imageEncoder)) {
+      writer.SetImageEncoder(this->imageEncoder);
+    }
+    if(this->videoSettings.has_value()) {
+      writer.EncodeToVideo(this->videoSettings.value());
+    } else if(this->streamSettings.has_value()) {
+      writer.StreamTo(this->streamSettings.value());
+    }
+    std::shared_ptr<Rendering::RenderManifest> manifest;
+    std::vector<Segment> runs;
+    if(this->incremental && !needsOrderedOutput()) {
+      manifest = std::make_shared<Rendering::RenderManifest>(directory);
+      manifest->Load();
+      manifest->CalculateFingerprints(*movie, plan, describeSettings());
+      writer.SetManifest(manifest);
+
+      runs = findOutdatedRuns(plan, writer, startOperationIndex, endOperationIndex);
+
+      // Frames produced by operations outside of the runs (or only warming up
+      // the deinterlacer at the beginning of a run) are already done
+      std::size_t upToDateFrameCount = 0;
+      std::size_t runIndex = 0;
+      for(
+        std::size_t operationIndex = startOperationIndex;
+        operationIndex < endOperationIndex;
+        ++operationIndex
+      ) {
+        while((runIndex < runs.size()) && (runs[runIndex].EndOperationIndex <= operationIndex)) {
+          ++runIndex;
+        }
+        bool isInRun = (
+          (runIndex < runs.size()) &&
+          (runs[runIndex].FirstOutputOperationIndex <= operationIndex)
         );
+        if(!isInRun) {
+          upToDateFrameCount += countOutputFramesInRange(plan, operationIndex);
+        }
       }
-      if(this->outputFrameRange.has_value()) {
-        render &= (
-          (outputFrameIndex >= this->outputFrameRange.value().first) &&
-          (outputFrameIndex < this->outputFrameRange.value().second)
+      this->completedFrameCount.store(upToDateFrameCount, std::memory_order::memory_order_release);
+    } else {
+      runs.push_back(
+        Segment { startOperationIndex, firstOutputOperationIndex, endOperationIndex }
+      );
+    }
+
+    // Set up the write stage. Unless pipelining or multiple encoder threads are enabled,
+    // this will simply save frames on the spot in the thread that produced them.
+    if(this->pipelined || (this->encoderThreadCount >= 2)) {
+      std::size_t threadCount = std::max<std::size_t>(this->encoderThreadCount, 1);
+      writer.StartBackgroundWriting(threadCount, threadCount * WriteBehindFramesPerThread);
+    }
+
+    // If we're allowed to use multiple threads, try to cut the movie into segments
+    // that can be rendered independently. This needs one deinterlacer per thread.
+    // Videos and streams need their frames in order, so this is not an option for them.
+    std::vector<std::shared_ptr<Algorithm::Deinterlacing::Deinterlacer>> deinterlacers;
+    std::vector<Segment> segments;
+    if((this->processingThreadCount >= 2) && !needsOrderedOutput()) {
+      for(std::size_t index = 0; index < this->processingThreadCount; ++index) {
+        std::shared_ptr<Algorithm::Deinterlacing::Deinterlacer> clone = (
+          this->deinterlacer->Clone()
         );
+        if(!static_cast<bool>(clone)) {
+          deinterlacers.clear();
+          break;
+        }
+        deinterlacers.push_back(std::move(clone));
       }
+      if(deinterlacers.size() >= 2) {
+        std::size_t totalRunLength = 0;
+        for(std::size_t runIndex = 0; runIndex < runs.size(); ++runIndex) {
+          totalRunLength += runs[runIndex].EndOperationIndex - runs[runIndex].StartOperationIndex;
+        }
 
-      switch(currentFrameType) {
-        case FrameAction::Discard: { break; }
-        case FrameAction::Duplicate: {
-          outputFrameIndex += 2;
-          if(render) {
-            totalFrameCount += 2;
-          }
-          break;
+        // Divide the desired number of segments among the runs by their lengths
+        std::size_t segmentCount = deinterlacers.size() * SegmentsPerThread;
+        for(std::size_t runIndex = 0; runIndex < runs.size(); ++runIndex) {
+          const Segment &run = runs[runIndex];
+          std::size_t runLength = run.EndOperationIndex - run.StartOperationIndex;
+          std::vector<Segment> runSegments = findIndependentSegments(
+            plan, run, (segmentCount * runLength + totalRunLength - 1) / totalRunLength
+          );
+          segments.insert(segments.end(), runSegments.begin(), runSegments.end());
         }
-        case FrameAction::Triplicate: {
-          outputFrameIndex += 3;
-          if(render) {
-            totalFrameCount += 3;
-          }
-          break;
+      }
+    }
+
+    if(segments.size() >= 2) {
+      renderSegmentsInParallel(movie, plan, writer, segments, deinterlacers, canceller);
+    } else {
+      Rendering::FrameLoader loader(movie, this->frameCache);
+      loader.SetStatistics(this->statistics);
+      loader.SetMemoryBudget(this->memoryBudget);
+      for(std::size_t runIndex = 0; runIndex < runs.size(); ++runIndex) {
+        const Segment &run = runs[runIndex];
+        if(this->pipelined) {
+          loader.StartReadAhead(
+            getLoadOrder(
+              plan, *this->deinterlacer, loader, run.StartOperationIndex, run.EndOperationIndex
+            ),
+            this->readAheadDepth,
+            this->readAheadThreadCount
+          );
         }
-        default: {
-          ++outputFrameIndex;
-          if(render) {
-            ++totalFrameCount;
-          }
-          break;
+
+        // Segments aren't rendered in parallel, so let averaging use the threads instead
+        renderSegment(
+          movie, plan, *this->deinterlacer, loader, writer, run,
+          std::max<std::size_t>(this->processingThreadCount, 1), canceller
+        );
+      }
+    }
+
+    // Wait for the write stage to finish. This also reports any error that occurred
+    // while writing in the background thread and completes the video file or stream.
+    writer.Flush();
+
+    // All frames have been recorded as they were written, but the manifest may contain
+    // many superseded entries by now, so write a clean one.
+    if(static_cast<bool>(manifest)) {
+      manifest->Save();
+    }
+
+    // Leave a summary of where the time went next to the output frames. Streams
+    // do not use the directory, so their summary is only available via the renderer,
+    // and neither is it for renders sharing the directory with other renders.
+    if(static_cast<bool>(this->frameCache)) {
+      this->statistics->AddBytesRead(this->frameCache->GetReadByteCount() - cacheReadByteCount);
+    }
+    this->statistics->RecordMemoryUsage(
+      this->memoryBudget->GetLimit(), this->memoryBudget->GetPeakUsage()
+    );
+    if(this->savesStatistics && !this->streamSettings.has_value()) {
+      this->statistics->Save(directory);
+    }
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  QImage Renderer::Preview(const std::shared_ptr<Movie> &movie, const std::size_t frameIndex) {
+    return preview(movie, frameIndex, *this->deinterlacer);
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  Rendering::RenderPlan Renderer::compilePlan(const Movie &movie) const {
+    bool needsPriorFrame = true;
+    if(static_cast<bool>(this->deinterlacer)) {
+      needsPriorFrame = this->deinterlacer->NeedsPriorFrame();
+    }
+
+    return Rendering::RenderPlan(
+      movie, this->flipFields, this->collapseAverageFrames, this->inputFrameRange,
+      needsPriorFrame
+    );
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  void Renderer::findOperationRange(
+    const Rendering::RenderPlan &plan,
+    std::size_t &startOperationIndex,
+    std::size_t &endOperationIndex
+  ) const {
+    startOperationIndex = 0;
+    endOperationIndex = plan.GetOperationCount();
+
+    // Operations are in input frame order, so the input range maps directly
+    // to the operations between the first operations of its start and end frames
+    if(this->inputFrameRange.has_value()) {
+      startOperationIndex = plan.FindFirstOperationOfInputFrame(
+        this->inputFrameRange.value().first
+      );
+      endOperationIndex = plan.FindFirstOperationOfInputFrame(
+        this->inputFrameRange.value().second
+      );
+    }
+
+    // For the output range, we need the operation producing the first output frame
+    // and the operation producing the last one (which may produce more frames after it)
+    if(this->outputFrameRange.has_value()) {
+      startOperationIndex = std::max(
+        startOperationIndex, plan.FindOperationOfOutputFrame(this->outputFrameRange.value().first)
+      );
+
+      std::size_t endOutputFrameIndex = this->outputFrameRange.value().second;
+      std::size_t lastOperationIndex = plan.FindOperationOfOutputFrame(endOutputFrameIndex);
+      if(lastOperationIndex < plan.GetOperationCount()) {
+        if(plan.GetOperation(lastOperationIndex).FirstOutputFrameIndex < endOutputFrameIndex) {
+          ++lastOperationIndex;
         }
       }
-      if(currentFrame.AlsoInsertInterpolatedAfter.has_value()) {
-        if(currentFrame.AlsoInsertInterpolatedAfter.value()) {
-          ++outputFrameIndex;
-          if(render) {
-            ++totalFrameCount;
+      endOperationIndex = std::min(endOperationIndex, lastOperationIndex);
+    }
+
+    if(startOperationIndex > endOperationIndex) {
+      startOperationIndex = endOperationIndex;
+    }
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  std::vector<Renderer::Segment> Renderer::findOutdatedRuns(
+    const Rendering::RenderPlan &plan,
+    const Rendering::FrameWriter &writer,
+    std::size_t startOperationIndex,
+    std::size_t endOperationIndex
+  ) const {
+    std::vector<Segment> runs;
+
+    for(
+      std::size_t operationIndex = startOperationIndex;
+      operationIndex < endOperationIndex;
+      ++operationIndex
+    ) {
+      const Rendering::RenderOperation &operation = plan.GetOperation(operationIndex);
+
+      std::size_t producedFrameCount = operation.OutputFrameCount;
+      if(operation.InsertInterpolatedAfter) {
+        ++producedFrameCount;
+      }
+
+      bool isOutdated = false;
+      for(std::size_t index = 0; index < producedFrameCount; ++index) {
+        std::size_t outputFrameIndex = operation.FirstOutputFrameIndex + index;
+        if(isInRange(operation.InputFrameIndex, outputFrameIndex)) {
+          if(!writer.IsUpToDate(outputFrameIndex)) {
+            isOutdated = true;
+            break;
           }
         }
       }
+
+      // An outdated operation may depend on the operations before it, so the run
+      // has to begin at the closest independent operation. If that overlaps with
+      // the previous run, simply extend the previous run.
+      if(isOutdated) {
+        std::size_t runStartIndex = std::max(
+          startOperationIndex, plan.FindIndependentOperation(operationIndex)
+        );
+        if(!runs.empty() && (runs.back().EndOperationIndex >= runStartIndex)) {
+          runs.back().EndOperationIndex = operationIndex + 1;
+        } else {
+          runs.push_back(Segment { runStartIndex, operationIndex, operationIndex + 1 });
+        }
+      }
     }
 
-    return totalFrameCount;
+    return runs;
   }
 
   // ------------------------------------------------------------------------------------------- //
 
-  void Renderer::Render(
+  std::size_t Renderer::countOutputFramesInRange(
+    const Rendering::RenderPlan &plan, std::size_t operationIndex
+  ) const {
+    const Rendering::RenderOperation &operation = plan.GetOperation(operationIndex);
+
+    std::size_t producedFrameCount = operation.OutputFrameCount;
+    if(operation.InsertInterpolatedAfter) {
+      ++producedFrameCount;
+    }
+
+    std::size_t frameCount = 0;
+    for(std::size_t index = 0; index < producedFrameCount; ++index) {
+      if(isInRange(operation.InputFrameIndex, operation.FirstOutputFrameIndex + index)) {
+        ++frameCount;
+      }
+    }
+
+    return frameCount;
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  bool Renderer::needsOrderedOutput() const {
+    return this->videoSettings.has_value() || this->streamSettings.has_value();
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  std::string Renderer::describeSettings() const {
+    std::string settings;
+
+    // The deinterlacer names include their settings (i.e. Yadif vs. BWDif mode)
+    if(static_cast<bool>(this->deinterlacer)) {
+      settings.append(this->deinterlacer->GetName());
+    }
+    settings.append(u8"\n");
+    if(static_cast<bool>(this->interpolator)) {
+      settings.append(this->interpolator->GetName());
+    }
+    settings.append(u8"\n");
+    settings.append(this->flipFields ? u8"FlipFields\n" : u8"KeepFields\n");
+    settings.append(this->collapseAverageFrames ? u8"CollapseAverages\n" : u8"KeepAverages\n");
+
+    // Only mentioned if it isn't the mean, so manifests from before it existed stay valid
+    if(this->averageMode == AverageMode::Median) {
+      settings.append(u8"MedianAverages\n");
+    } else if(this->averageMode == AverageMode::TrimmedMean) {
+      settings.append(u8"TrimmedMeanAverages\n");
+    }
+
+    return settings;
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  std::vector<Renderer::Segment> Renderer::findIndependentSegments(
+    const Rendering::RenderPlan &plan, const Segment &run, std::size_t segmentCount
+  ) {
+    std::vector<Segment> segments;
+    if(run.EndOperationIndex <= run.StartOperationIndex) {
+      return segments;
+    }
+
+    std::size_t segmentLength = (
+      (run.EndOperationIndex - run.StartOperationIndex) / std::max<std::size_t>(segmentCount, 1)
+    );
+    segmentLength = std::max(segmentLength, MinimumSegmentLength);
+
+    // The plan already knows at which operations rendering can begin, so just pick
+    // those that result in segments of roughly equal length. Where the deinterlacer
+    // needs its prior frame, a segment begins with a few operations as a warm-up.
+    segments.push_back(run);
+    for(
+      std::size_t operationIndex = run.FirstOutputOperationIndex + 1;
+      operationIndex < run.EndOperationIndex;
+      ++operationIndex
+    ) {
+      if((operationIndex - segments.back().FirstOutputOperationIndex) >= segmentLength) {
+        std::size_t startOperationIndex = plan.FindIndependentOperation(operationIndex);
+        if(startOperationIndex > segments.back().StartOperationIndex) {
+          segments.back().EndOperationIndex = operationIndex;
+          segments.push_back(
+            Segment { startOperationIndex, operationIndex, run.EndOperationIndex }
+          );
+        }
+      }
+    }
+
+    return segments;
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  void Renderer::renderSegmentsInParallel(
     const std::shared_ptr<Movie> &movie,
-    const std::string &directory,
-    const std::shared_ptr<const Nuclex::Platform::Tasks::CancellationWatcher> &canceller /* = (
-      std::shared_ptr<Nuclex::Platform::Tasks::CancellationWatcher>()
-    ) */
+    const Rendering::RenderPlan &plan,
+    Rendering::FrameWriter &writer,
+    const std::vector<Segment> &segments,
+    const std::vector<std::shared_ptr<Algorithm::Deinterlacing::Deinterlacer>> &deinterlacers,
+    const std::shared_ptr<const Nuclex::Platform::Tasks::CancellationWatcher> &canceller
   ) {
-    std::size_t outputFrameIndex = 1;
-    bool needsNextFrame = this->deinterlacer->NeedsNextFrame();
-    bool needsPriorImage = this->deinterlacer->NeedsPriorFrame();
+    std::atomic<std::size_t> nextSegmentIndex(0);
+    std::atomic<bool> failed(false);
+    std::mutex errorMutex;
+    std::exception_ptr error;
+
+    // Each thread keeps taking the next segment until all segments are rendered.
+    // Segments are handed out in order, so output frames are written roughly in order.
+    std::vector<std::thread> threads;
+    threads.reserve(deinterlacers.size());
+    for(std::size_t threadIndex = 0; threadIndex < deinterlacers.size(); ++threadIndex) {
+      threads.emplace_back(
+        [&, threadIndex]() {
+          Diagnostics::TraceRecorder::NameCurrentThread(
+            u8"Segment renderer " + std::to_string(threadIndex + 1)
+          );
+          try {
+            for(;;) {
+              std::size_t segmentIndex = nextSegmentIndex.fetch_add(1);
+              if((segmentIndex >= segments.size()) || failed.load()) {
+                break;
+              }
+
+              const Segment &segment = segments[segmentIndex];
+              Rendering::FrameLoader loader(movie, this->frameCache);
+              loader.SetStatistics(this->statistics);
+              loader.SetMemoryBudget(this->memoryBudget);
+              if(this->pipelined) {
+                loader.StartReadAhead(
+                  getLoadOrder(
+                    plan, *deinterlacers[threadIndex], loader,
+                    segment.StartOperationIndex, segment.EndOperationIndex
+                  ),
+                  this->readAheadDepth
+                );
+              }
+              renderSegment(
+                movie, plan, *deinterlacers[threadIndex], loader, writer, segment, 1, canceller
+              );
+            }
+          }
+          catch(...) {
+            std::unique_lock<std::mutex> errorLock(errorMutex);
+            if(!static_cast<bool>(error)) {
+              error = std::current_exception();
+            }
+            failed.store(true);
+          }
 
-    QImage lastInterpolatedImage;
+          deinterlacers[threadIndex]->CoolDown();
+        }
+      );
+    }
+
+    for(std::size_t index = 0; index < threads.size(); ++index) {
+      threads[index].join();
+    }
+    if(static_cast<bool>(error)) {
+      std::rethrow_exception(error);
+    }
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  std::vector<std::size_t> Renderer::getLoadOrder(
+    const Rendering::RenderPlan &plan,
+    const Algorithm::Deinterlacing::Deinterlacer &deinterlacer,
+    const Rendering::FrameLoader &loader,
+    std::size_t startOperationIndex,
+    std::size_t endOperationIndex
+  ) const {
+    bool needsNextFrame = deinterlacer.NeedsNextFrame();
+    bool interpolatesFrames = (
+      static_cast<bool>(this->interpolator) && this->interpolator->CanInterpolateMiddleFrame()
+    );
+
+    std::vector<std::size_t> loadOrder;
+    std::size_t nextImageFrameIndex = Rendering::RenderOperation::None;
     std::size_t lastInterpolationPriorIndex = std::size_t(-1);
     std::size_t lastInterpolationAfterIndex = std::size_t(-1);
-    
-    QImage priorImage, currentImage, nextImage;
-    std::vector<QImage> imagesToAverage;
-    FrameAction firstImageToAverageType = FrameAction::Unknown;
-
-    std::size_t frameCount = movie->Frames.size();
-    for(std::size_t frameIndex = 0; frameIndex < frameCount; ++frameIndex) {
-      const Frame &currentFrame = movie->Frames[frameIndex];
-      FrameAction currentFrameType = getFrameType(currentFrame, this->flipFields);
-
-      // Figure out if we're still far from the export range. If so, do quick skip mode.
-      // TODO: this is currently running in danger of entering a long averaging block without
-      //       a start frame. Scan for the start frame before or just assume nobody will
-      //       find more than 10 exactly equal frames in a row to average?
-      bool skip = false;
-      if(this->inputFrameRange.has_value()) {
-        skip = (frameIndex + 10) < this->inputFrameRange.value().first;
-      }
-      if(this->outputFrameRange.has_value()) {
-        skip |= (outputFrameIndex + 10) < this->outputFrameRange.value().first;
-      }
-      if(skip) {
-        switch(currentFrameType) {
-          case FrameAction::Discard: { break; }
-          case FrameAction::Duplicate: { outputFrameIndex += 2; break; }
-          case FrameAction::Triplicate: { outputFrameIndex += 3; break; }
-          default: { ++outputFrameIndex; break; }
-        }
-        if(currentFrame.AlsoInsertInterpolatedAfter.has_value()) {
-          if(currentFrame.AlsoInsertInterpolatedAfter.value()) {
-            ++outputFrameIndex;
+
+    for(
+      std::size_t operationIndex = startOperationIndex;
+      operationIndex < endOperationIndex;
+      ++operationIndex
+    ) {
+      const Rendering::RenderOperation &operation = plan.GetOperation(operationIndex);
+
+      // Averaging runs load all of their frames, except for one that was already
+      // loaded as the next image for the deinterlacer
+      if(operation.Type == Rendering::RenderOperationType::EmitAverage) {
+        std::size_t endAveragedFrameIndex = (
+          operation.FirstAveragedFrameIndex + operation.AveragedFrameCount
+        );
+        for(
+          std::size_t frameIndex = operation.FirstAveragedFrameIndex;
+          frameIndex < endAveragedFrameIndex;
+          ++frameIndex
+        ) {
+          if(frameIndex == nextImageFrameIndex) {
+            nextImageFrameIndex = Rendering::RenderOperation::None;
+          } else {
+            loadOrder.push_back(loader.GetSourceFrameIndex(frameIndex));
           }
         }
-        continue; // Skip processing and loop here!
+
+        continue;
       }
 
-      if(this->outputFrameRange.has_value()) {
-        if(outputFrameIndex > this->outputFrameRange.value().first) {
-          this->completedFrameCount.store(
-            outputFrameIndex - this->outputFrameRange.value().first,
-            std::memory_order::memory_order_release
-          );
-        }
+      if(nextImageFrameIndex != operation.InputFrameIndex) {
+        loadOrder.push_back(loader.GetSourceFrameIndex(operation.InputFrameIndex));
+      }
+      if(needsNextFrame && (operation.NextFrameIndex != Rendering::RenderOperation::None)) {
+        loadOrder.push_back(loader.GetSourceFrameIndex(operation.NextFrameIndex));
+        nextImageFrameIndex = operation.NextFrameIndex;
       } else {
-        this->completedFrameCount.store(
-          outputFrameIndex, std::memory_order::memory_order_release
-        );
+        nextImageFrameIndex = Rendering::RenderOperation::None;
       }
-      canceller->ThrowIfCanceled();
 
-      // If the frame type is 'average', queue the image up as an averaging sample
-      if(currentFrameType == FrameAction::Average) {
-        if(nextImage.isNull()) {
-          std::string imagePath = movie->GetFramePath(frameIndex);
-          imagesToAverage.emplace_back(QString::fromStdString(imagePath));
-        } else {
-          nextImage.swap(imagesToAverage.emplace_back());
+      // Interpolated frames load their source frames as they are, unless the frame
+      // before was interpolated from the same pair and can simply be copied
+      if(interpolatesFrames && (operation.Action == FrameAction::Interpolate)) {
+        std::pair<std::size_t, std::size_t> sourceIndices = (
+          operation.InterpolationSourceIndices.value()
+        );
+        bool alreadyInterpolated = (
+          (sourceIndices.first == lastInterpolationPriorIndex) &&
+          (sourceIndices.second == lastInterpolationAfterIndex)
+        );
+        if(!alreadyInterpolated) {
+          loadOrder.push_back(sourceIndices.first);
+          loadOrder.push_back(sourceIndices.second);
+          lastInterpolationPriorIndex = sourceIndices.first;
+          lastInterpolationAfterIndex = sourceIndices.second;
         }
+      }
+    }
 
-        bool isLastFrame = ((frameIndex + 1) >= frameCount);
-        if(this->inputFrameRange.has_value()) {
-          isLastFrame |= ((frameIndex + 1) >= this->inputFrameRange.value().second);
-        }
+    return loadOrder;
+  }
 
-        // Just keep collecting all frames tagged for the averaging block, unless we
-        // reach the end of the movie, in which case we need to flush it now.
-        if(!isLastFrame) {
-          continue;
-        }
+  // ------------------------------------------------------------------------------------------- //
+
+  void Renderer::renderSegment(
+    const std::shared_ptr<Movie> &movie,
+    const Rendering::RenderPlan &plan,
+    Algorithm::Deinterlacing::Deinterlacer &deinterlacer,
+    Rendering::FrameLoader &loader,
+    Rendering::FrameWriter &writer,
+    const Segment &segment,
+    std::size_t averagingThreadCount,
+    const std::shared_ptr<const Nuclex::Platform::Tasks::CancellationWatcher> &canceller
+  ) {
+    NUCLEX_FRAMEFIXER_TRACE_SCOPE(u8"render", u8"Render segment");
+    bool needsNextFrame = deinterlacer.NeedsNextFrame();
+    bool needsPriorImage = deinterlacer.NeedsPriorFrame();
+
+    QImage lastInterpolatedImage;
+    std::size_t lastInterpolationPriorIndex = std::size_t(-1);
+    std::size_t lastInterpolationAfterIndex = std::size_t(-1);
+
+    QImage priorImage, currentImage, nextImage;
+    std::size_t nextImageFrameIndex = Rendering::RenderOperation::None;
+
+    for(
+      std::size_t operationIndex = segment.StartOperationIndex;
+      operationIndex < segment.EndOperationIndex;
+      ++operationIndex
+    ) {
+      const Rendering::RenderOperation &operation = plan.GetOperation(operationIndex);
+      std::size_t outputFrameIndex = operation.FirstOutputFrameIndex;
+
+      // Warm-up operations only prime the deinterlacer, their output is not exact
+      bool isWarmUp = (operationIndex < segment.FirstOutputOperationIndex);
+
+      if(static_cast<bool>(canceller)) {
+        canceller->ThrowIfCanceled();
       }
-      if(imagesToAverage.size() >= 1) {
-        Averager::Average(currentImage, imagesToAverage);
-
-        // First, save the very first frame prior to the one or more frames tagged
-        // for averaging. Save it to multiple outputs if it is tagged for duplication.
-        if(firstImageToAverageType == FrameAction::Triplicate) {
-          saveImage(
-            currentImage, directory, frameIndex, outputFrameIndex++,
-            this->inputFrameRange, this->outputFrameRange
-          );
-          saveImage(
-            currentImage, directory, frameIndex, outputFrameIndex++,
-            this->inputFrameRange, this->outputFrameRange
+
+      // If this operation concludes a run of averaged frames, load the frames
+      // and blend them into the processed image of the frame before the run
+      if(operation.Type == Rendering::RenderOperationType::EmitAverage) {
+        std::size_t endAveragedFrameIndex = (
+          operation.FirstAveragedFrameIndex + operation.AveragedFrameCount
+        );
+
+        // The median and trimmed mean have to look at all frames of the run at once,
+        // so the frames are collected, each one claiming its memory since the run
+        // can't be completed without it
+        if(this->averageMode != AverageMode::Mean) {
+          std::vector<QImage> imagesToAverage;
+          std::vector<Rendering::FrameMemoryBudget::Reservation> averagedImageReservations;
+          imagesToAverage.reserve(operation.AveragedFrameCount);
+          averagedImageReservations.reserve(operation.AveragedFrameCount);
+          for(
+            std::size_t frameIndex = operation.FirstAveragedFrameIndex;
+            frameIndex < endAveragedFrameIndex;
+            ++frameIndex
+          ) {
+            QImage image;
+            if(frameIndex == nextImageFrameIndex) {
+              nextImage.swap(image);
+              nextImageFrameIndex = Rendering::RenderOperation::None;
+            } else {
+              image = loader.Load(frameIndex);
+            }
+
+            averagedImageReservations.push_back(
+              this->memoryBudget->Claim(static_cast<std::size_t>(image.sizeInBytes()))
+            );
+            imagesToAverage.push_back(std::move(image));
+          }
+
+          Rendering::RenderStatistics::ScopedTimer averageTimer(
+            this->statistics.get(), Rendering::RenderStage::Average
           );
-        } else if(firstImageToAverageType == FrameAction::Duplicate) {
-          saveImage(
-            currentImage, directory, frameIndex, outputFrameIndex++,
-            this->inputFrameRange, this->outputFrameRange
+          this->frameBufferPool->Detach(currentImage);
+          Averager::Average(
+            currentImage, imagesToAverage, this->averageMode, averagingThreadCount
           );
-        }
-        saveImage(
-          currentImage, directory, frameIndex, outputFrameIndex++,
-          this->inputFrameRange, this->outputFrameRange
-        );
+        } else {
+          // Frames are summed up one by one as they are loaded, so however long
+          // the run is, only the running sum and the frame being added take up memory
+          Rendering::FrameMemoryBudget::Reservation accumulatorReservation;
+          AverageAccumulator accumulator;
+          accumulator.SetThreadCount(averagingThreadCount);
+          {
+            Rendering::RenderStatistics::ScopedTimer averageTimer(
+              this->statistics.get(), Rendering::RenderStage::Average
+            );
+            accumulator.Add(currentImage);
+            accumulatorReservation = this->memoryBudget->Claim(accumulator.GetByteCount());
+          }
+
+          for(
+            std::size_t frameIndex = operation.FirstAveragedFrameIndex;
+            frameIndex < endAveragedFrameIndex;
+            ++frameIndex
+          ) {
+            QImage image;
+            if(frameIndex == nextImageFrameIndex) {
+              nextImage.swap(image);
+              nextImageFrameIndex = Rendering::RenderOperation::None;
+            } else {
+              image = loader.Load(frameIndex);
+            }
 
-        // Each frame that was tagged to be averaged also needs to result in
-        // one output image being saved each.
-        if(!this->collapseAverageFrames) {
-          for(std::size_t index = 0; index < imagesToAverage.size(); ++index) {
-            saveImage(
-              currentImage, directory, frameIndex, outputFrameIndex++,
-              this->inputFrameRange, this->outputFrameRange
+            Rendering::RenderStatistics::ScopedTimer averageTimer(
+              this->statistics.get(), Rendering::RenderStage::Average
             );
+            accumulator.Add(image);
+          }
+
+          {
+            Rendering::RenderStatistics::ScopedTimer averageTimer(
+              this->statistics.get(), Rendering::RenderStage::Average
+            );
+            this->frameBufferPool->Detach(currentImage);
+            accumulator.Resolve(currentImage);
           }
         }
 
-        imagesToAverage.clear();
+        // The averaged image takes the place of the frame before the run (including
+        // its duplicates) and, unless collapsed, of each of the averaged frames
+        if(!isWarmUp) {
+          for(std::size_t index = 0; index < operation.OutputFrameCount; ++index) {
+            saveFrame(writer, currentImage, operation.InputFrameIndex, outputFrameIndex++);
+          }
+        }
 
-        // Continue processing the current (yet to be loaded) frame. It was not part
-        // of theaveraging chain (in fact, it broke it), so it is processed normally.
+        continue;
       }
 
       // If the deinterlacer requires a prior frame and we have a current frame
@@ -403,74 +960,54 @@ namespace Nuclex::FrameFixer {
         }
       }
 
-      // If we have a next image loaded (for whatever reason), make it become
+      // If we have already loaded this frame as the next image, make it become
       // the current image. Otherwise, load the file for the current frame.
-      if(!nextImage.isNull()) {
+      if(nextImageFrameIndex == operation.InputFrameIndex) {
         nextImage.swap(currentImage);
-      } else if(movie->Frames[frameIndex].LeftOrReplacementIndex.has_value()) {
-        std::string imagePath = movie->GetFramePath(
-          movie->Frames[frameIndex].LeftOrReplacementIndex.value()
-        );
-        currentImage.load(QString::fromStdString(imagePath));
       } else {
-        std::string imagePath = movie->GetFramePath(frameIndex);
-        currentImage.load(QString::fromStdString(imagePath));
+        currentImage = loader.Load(operation.InputFrameIndex);
       }
 
       // If the deinterlacer needs a next frame, also load the image that
       // follows the current one
-      if(needsNextFrame && ((frameIndex + 1) < frameCount)) {
-        if(movie->Frames[frameIndex + 1].LeftOrReplacementIndex.has_value()) {
-          std::string imagePath = movie->GetFramePath(
-            movie->Frames[frameIndex + 1].LeftOrReplacementIndex.value()
-          );
-          nextImage.load(QString::fromStdString(imagePath));
-        } else {
-          std::string imagePath = movie->GetFramePath(frameIndex + 1);
-          nextImage.load(QString::fromStdString(imagePath));
-        }
-      } else if(!nextImage.isNull()) {
+      if(needsNextFrame && (operation.NextFrameIndex != Rendering::RenderOperation::None)) {
+        nextImage = loader.Load(operation.NextFrameIndex);
+        nextImageFrameIndex = operation.NextFrameIndex;
+      } else {
         QImage emptyImage;
         nextImage.swap(emptyImage);
+        nextImageFrameIndex = Rendering::RenderOperation::None;
       }
 
       // Now give the deinterlacer the images it needs to work
       if(needsPriorImage) {
         if(priorImage.isNull()) {
-          this->deinterlacer->SetPriorFrame(currentImage);
+          deinterlacer.SetPriorFrame(currentImage);
         } else {
-          this->deinterlacer->SetPriorFrame(priorImage);
+          deinterlacer.SetPriorFrame(priorImage);
         }
       }
       if(needsNextFrame) {
         if(nextImage.isNull()) {
-          this->deinterlacer->SetNextFrame(currentImage);
+          deinterlacer.SetNextFrame(currentImage);
         } else {
-          this->deinterlacer->SetNextFrame(nextImage);
+          deinterlacer.SetNextFrame(nextImage);
         }
       }
 
-      if(currentFrameType == FrameAction::TopFieldFirst) {
-        this->deinterlacer->Deinterlace(
-          currentImage, DeinterlaceMode::TopFieldFirst
-        );
-      } else if(currentFrameType == FrameAction::BottomFieldFirst) {
-        this->deinterlacer->Deinterlace(
-          currentImage, DeinterlaceMode::BottomFieldFirst
-        );
-      } else if(currentFrameType == FrameAction::TopFieldOnly) {
-        this->deinterlacer->Deinterlace(
-          currentImage, DeinterlaceMode::TopFieldOnly
-        );
-      } else if(currentFrameType == FrameAction::BottomFieldOnly) {
-        this->deinterlacer->Deinterlace(
-          currentImage, DeinterlaceMode::BottomFieldOnly
-        );
-      } else if(currentFrameType == FrameAction::Interpolate) {
+      if(operation.Action == FrameAction::TopFieldFirst) {
+        deinterlace(deinterlacer, currentImage, DeinterlaceMode::TopFieldFirst);
+      } else if(operation.Action == FrameAction::BottomFieldFirst) {
+        deinterlace(deinterlacer, currentImage, DeinterlaceMode::BottomFieldFirst);
+      } else if(operation.Action == FrameAction::TopFieldOnly) {
+        deinterlace(deinterlacer, currentImage, DeinterlaceMode::TopFieldOnly);
+      } else if(operation.Action == FrameAction::BottomFieldOnly) {
+        deinterlace(deinterlacer, currentImage, DeinterlaceMode::BottomFieldOnly);
+      } else if(operation.Action == FrameAction::Interpolate) {
         if(static_cast<bool>(this->interpolator)) {
           if(this->interpolator->CanInterpolateMiddleFrame()) {
             std::pair<std::size_t, std::size_t> sourceIndices = (
-              movie->Frames[frameIndex].InterpolationSourceIndices.value()
+              operation.InterpolationSourceIndices.value()
             );
             bool alreadyInterpolated = (
               (!lastInterpolatedImage.isNull()) &&
@@ -478,140 +1015,84 @@ namespace Nuclex::FrameFixer {
               (sourceIndices.second == lastInterpolationAfterIndex)
             );
             if(!alreadyInterpolated) {
-              std::string imagePath = movie->GetFramePath(sourceIndices.first);
-              QImage prior(QString::fromStdString(imagePath));
-
-              imagePath = movie->GetFramePath(sourceIndices.second);
-              QImage after(QString::fromStdString(imagePath));
-              
-              QImage interpolatedImage = this->interpolator->Interpolate(prior, after);
+              QImage prior = loader.LoadSource(sourceIndices.first);
+              QImage after = loader.LoadSource(sourceIndices.second);
+              QImage interpolatedImage = interpolate(prior, after);
               lastInterpolatedImage.swap(interpolatedImage);
               lastInterpolationPriorIndex = sourceIndices.first;
               lastInterpolationAfterIndex = sourceIndices.second;
             }
 
-            currentImage = lastInterpolatedImage.copy();
+            currentImage = this->frameBufferPool->Copy(lastInterpolatedImage);
           }
         }
       }
 
-      // Figure out if the frame that follows uses averaging
-      bool nextImageUsesAveraging = false;
-      if((frameIndex + 1) < frameCount) {
-        if(movie->Frames[frameIndex + 1].Action == FrameAction::Average) {
-          nextImageUsesAveraging = true;
-        }
+      // Emit the output frames. If the next frame begins an averaging run, the plan
+      // has no output frames here and the image will be emitted after averaging.
+      if(isWarmUp) {
+        continue;
       }
-      if(this->inputFrameRange.has_value()) {
-        nextImageUsesAveraging &= ((frameIndex + 1) < this->inputFrameRange.value().second);
+      for(std::size_t index = 0; index < operation.OutputFrameCount; ++index) {
+        saveFrame(writer, currentImage, operation.InputFrameIndex, outputFrameIndex++);
       }
-
-      // If the next image is tagged for averaging, don't save the image,
-      // we'll have to average it first with one or more future frames.
-      if(nextImageUsesAveraging) {
-        firstImageToAverageType = currentFrameType;
-      } else { // next image tagged / not tagged for averaging
-        if(currentFrameType == FrameAction::Triplicate) {
-          saveImage(
-            currentImage, directory, frameIndex, outputFrameIndex++,
-            this->inputFrameRange, this->outputFrameRange
-          );
-          saveImage(
-            currentImage, directory, frameIndex, outputFrameIndex++,
-            this->inputFrameRange, this->outputFrameRange
-          );
-        } else if(currentFrameType == FrameAction::Duplicate) {
-          saveImage(
-            currentImage, directory, frameIndex, outputFrameIndex++,
-            this->inputFrameRange, this->outputFrameRange
-          );
-        }
-        if(currentFrameType != FrameAction::Discard) {
-          saveImage(
-            currentImage, directory, frameIndex, outputFrameIndex++,
-            this->inputFrameRange, this->outputFrameRange
-          );
-        }
-
-        if(movie->Frames[frameIndex].AlsoInsertInterpolatedAfter.has_value()) {
-          if(movie->Frames[frameIndex].AlsoInsertInterpolatedAfter.value()) {
-            QImage tempNextImage = Preview(movie, frameIndex + 1);
-
-            QImage interpolatedImage = this->interpolator->Interpolate(
-              currentImage, tempNextImage
-            );
-            saveImage(
-              interpolatedImage, directory, frameIndex, outputFrameIndex++,
-              this->inputFrameRange, this->outputFrameRange
-            );
-          }
-        }
-
-        // Stop if we produced all the requested frames
-        if(this->inputFrameRange.has_value()) {
-          if(frameIndex >= this->inputFrameRange.value().second) {
-            break;
-          }
-        }
-        if(this->outputFrameRange.has_value()) {
-          if(outputFrameIndex >= this->outputFrameRange.value().second) {
-            break;
-          }
+      if(operation.InsertInterpolatedAfter) {
+        if(static_cast<bool>(this->interpolator)) {
+          QImage tempNextImage = preview(movie, operation.InputFrameIndex + 1, deinterlacer);
+          QImage interpolatedImage = interpolate(currentImage, tempNextImage);
+          saveFrame(writer, interpolatedImage, operation.InputFrameIndex, outputFrameIndex++);
+        } else { // Without an interpolator, repeat the frame to keep the output numbering
+          saveFrame(writer, currentImage, operation.InputFrameIndex, outputFrameIndex++);
         }
-
-      } // next image is not tagged for averaging
-    } // for frame index from 0 to frame count
+      }
+    } // for each operation from start to end of segment
   }
 
   // ------------------------------------------------------------------------------------------- //
 
-  QImage Renderer::Preview(const std::shared_ptr<Movie> &movie, const std::size_t frameIndex) {
-    std::string imagePath = movie->GetFramePath(frameIndex);
-    QImage currentImage(QString::fromStdString(imagePath));
+  QImage Renderer::preview(
+    const std::shared_ptr<Movie> &movie,
+    std::size_t frameIndex,
+    Algorithm::Deinterlacing::Deinterlacer &deinterlacer
+  ) {
+    QImage currentImage = loadFrame(*movie, frameIndex);
 
     QImage priorImage;
-    if(this->deinterlacer->NeedsPriorFrame()) {
+    if(deinterlacer.NeedsPriorFrame()) {
       if(frameIndex > 0) {
-        std::string imagePath = movie->GetFramePath(frameIndex - 1);
-        priorImage.load(QString::fromStdString(imagePath));
-        this->deinterlacer->SetPriorFrame(priorImage);
+        priorImage = loadFrame(*movie, frameIndex - 1);
+        deinterlacer.SetPriorFrame(priorImage);
       } else {
-        this->deinterlacer->SetPriorFrame(currentImage);
+        deinterlacer.SetPriorFrame(currentImage);
       }
     }
 
     QImage nextImage;
-    if(this->deinterlacer->NeedsNextFrame()) {
-      if(frameIndex > 0) {
-        std::string imagePath = movie->GetFramePath(frameIndex + 1);
-        nextImage.load(QString::fromStdString(imagePath));
-        this->deinterlacer->SetNextFrame(nextImage);
+    if(deinterlacer.NeedsNextFrame()) {
+      if((frameIndex > 0) && ((frameIndex + 1) < movie->Frames.size())) {
+        nextImage = loadFrame(*movie, frameIndex + 1);
+        deinterlacer.SetNextFrame(nextImage);
       } else {
-        this->deinterlacer->SetNextFrame(nextImage);
+        deinterlacer.SetNextFrame(nextImage);
       }
     }
 
-    FrameAction currentFrameType = getFrameType(movie->Frames[frameIndex], this->flipFields);
+    FrameAction currentFrameType = Rendering::RenderPlan::GetFrameAction(
+      movie->Frames[frameIndex], this->flipFields
+    );
 
     if(currentFrameType == FrameAction::TopFieldFirst) {
-      this->deinterlacer->Deinterlace(
-        currentImage, DeinterlaceMode::TopFieldFirst
-      );
+      deinterlace(deinterlacer, currentImage, DeinterlaceMode::TopFieldFirst);
     } else if(currentFrameType == FrameAction::BottomFieldFirst) {
-      this->deinterlacer->Deinterlace(
-        currentImage, DeinterlaceMode::BottomFieldFirst
-      );
+      deinterlace(deinterlacer, currentImage, DeinterlaceMode::BottomFieldFirst);
     } else if(currentFrameType == FrameAction::TopFieldOnly) {
-      this->deinterlacer->Deinterlace(
-        currentImage, DeinterlaceMode::TopFieldOnly
-      );
+      deinterlace(deinterlacer, currentImage, DeinterlaceMode::TopFieldOnly);
     } else if(currentFrameType == FrameAction::BottomFieldOnly) {
-      this->deinterlacer->Deinterlace(
-        currentImage, DeinterlaceMode::BottomFieldOnly
-      );
+      deinterlace(deinterlacer, currentImage, DeinterlaceMode::BottomFieldOnly);
     } else if(currentFrameType == FrameAction::Replace) {
-      imagePath = movie->GetFramePath(movie->Frames[frameIndex].LeftOrReplacementIndex.value());
-      QImage replacementImage(QString::fromStdString(imagePath));
+      QImage replacementImage = loadFrame(
+        *movie, movie->Frames[frameIndex].LeftOrReplacementIndex.value()
+      );
       currentImage.swap(replacementImage);
     }
 
@@ -620,4 +1101,106 @@ namespace Nuclex::FrameFixer {
 
   // ------------------------------------------------------------------------------------------- //
 
+  QImage Renderer::loadFrame(const Movie &movie, std::size_t frameIndex) const {
+    Rendering::RenderStatistics::ScopedTimer decodeTimer(
+      this->statistics.get(), Rendering::RenderStage::Decode
+    );
+    if(static_cast<bool>(this->frameCache)) {
+      return this->frameCache->GetFrame(movie, frameIndex);
+    }
+
+    this->statistics->AddBytesRead(movie.GetEncodedFrameSize(frameIndex));
+    return movie.LoadFrame(frameIndex);
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  void Renderer::deinterlace(
+    Algorithm::Deinterlacing::Deinterlacer &deinterlacer, QImage &image, DeinterlaceMode mode
+  ) {
+    Rendering::RenderStatistics::ScopedTimer deinterlaceTimer(
+      this->statistics.get(), Rendering::RenderStatistics::GetDeinterlaceStage(mode)
+    );
+
+    // The deinterlacers work in place. If the image is still shared with the frame cache
+    // or the writer, copy it into recycled memory before Qt allocates a new frame for it.
+    this->frameBufferPool->Detach(image);
+    deinterlacer.Deinterlace(image, mode);
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  QImage Renderer::interpolate(const QImage &prior, const QImage &after) {
+
+    // Interpolators are not guaranteed to be thread safe (the external RIFE interpolator
+    // exchanges images through fixed file names, for example), so when segments are
+    // rendered in parallel, only one thread at a time gets to use the interpolator.
+    std::unique_lock<std::mutex> interpolatorLock(this->interpolatorMutex, std::defer_lock);
+    {
+      NUCLEX_FRAMEFIXER_TRACE_SCOPE(u8"render", u8"Wait for interpolator");
+      interpolatorLock.lock();
+    }
+
+    Rendering::RenderStatistics::ScopedTimer interpolateTimer(
+      this->statistics.get(), Rendering::RenderStage::Interpolate
+    );
+    return this->interpolator->Interpolate(prior, after);
+
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  bool Renderer::isInRange(std::size_t inputFrameIndex, std::size_t outputFrameIndex) const {
+
+    // If the user limited the export by an input frame range,
+    // only write the file if the input frame index is within that range
+    if(this->inputFrameRange.has_value()) {
+      bool isInInputRange = (
+        (inputFrameIndex >= this->inputFrameRange.value().first) &&
+        (inputFrameIndex < this->inputFrameRange.value().second)
+      );
+      if(!isInInputRange) {
+        return false;
+      }
+    }
+
+    // If the user limited the export by an output frame range,
+    // only write the file if the output frame index is within that range
+    if(this->outputFrameRange.has_value()) {
+      bool isInOutputRange = (
+        (outputFrameIndex >= this->outputFrameRange.value().first) &&
+        (outputFrameIndex < this->outputFrameRange.value().second)
+      );
+      if(!isInOutputRange) {
+        return false;
+      }
+    }
+
+    return true;
+
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  void Renderer::saveFrame(
+    Rendering::FrameWriter &writer,
+    const QImage &image,
+    std::size_t inputFrameIndex,
+    std::size_t outputFrameIndex
+  ) {
+    if(!isInRange(inputFrameIndex, outputFrameIndex)) {
+      return;
+    }
+
+    // When rendering incrementally, frames that are still up to date are processed
+    // (since the frames after them may depend on them), but don't need to be written
+    if(!writer.IsUpToDate(outputFrameIndex)) {
+      writer.Write(image, outputFrameIndex);
+      this->statistics->RecordFrame();
+    }
+    this->completedFrameCount.fetch_add(1, std::memory_order::memory_order_release);
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
 } // namespace Nuclex::FrameFixer
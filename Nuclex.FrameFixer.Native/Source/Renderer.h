@@ -21,12 +21,19 @@ limitations under the License.
 #define NUCLEX_FRAMEFIXER_RENDERER_H
 
 #include "Nuclex/FrameFixer/Config.h"
+#include "./Rendering/VideoSettings.h"
+#include "./Rendering/StreamSettings.h"
+#include "./Model/DeinterlaceMode.h"
+#include "./Algorithm/AverageMode.h"
 
 #include <memory> // for std;:shared_ptr
 #include <cstddef> // for std::size_t
 #include <string> // for std::string
 #include <optional> // for std::optional
+#include <utility> // for std::pair
 #include <atomic> // for std::atomic
+#include <vector> // for std::vector
+#include <mutex> // for std::mutex
 
 #include <QImage>
 
@@ -62,6 +69,41 @@ namespace Nuclex::FrameFixer::Algorithm::Interpolation {
 
 }
 
+namespace Nuclex::FrameFixer::Services {
+
+  // ------------------------------------------------------------------------------------------- //
+
+  class FrameCache;
+
+  // ------------------------------------------------------------------------------------------- //
+
+}
+
+namespace Nuclex::FrameFixer::Rendering {
+
+  // ------------------------------------------------------------------------------------------- //
+
+  class FrameBufferPool;
+  class FrameLoader;
+  class FrameMemoryBudget;
+  class FrameWriter;
+  class RenderPlan;
+  class RenderStatistics;
+
+  // ------------------------------------------------------------------------------------------- //
+
+}
+
+namespace Nuclex::FrameFixer::Rendering::ImageFormats {
+
+  // ------------------------------------------------------------------------------------------- //
+
+  class ImageEncoder;
+
+  // ------------------------------------------------------------------------------------------- //
+
+}
+
 namespace Nuclex::FrameFixer {
 
   // ------------------------------------------------------------------------------------------- //
@@ -94,6 +136,165 @@ namespace Nuclex::FrameFixer {
     /// <param name="flip">True to collapse successive averaged frames</param>
     public: void CollapseAverageFrames(bool collapse = true);
 
+    /// <summary>Selects how the frames in averaging runs are combined</summary>
+    /// <param name="mode">Whether to use the mean, median or trimmed mean</param>
+    /// <remarks>
+    ///   The mean is the default. The median and trimmed mean reject dropouts and
+    ///   sparkle in individual frames, but need all frames of an averaging run in
+    ///   memory at once, regardless of the frame memory budget.
+    /// </remarks>
+    public: void SetAverageMode(AverageMode mode);
+
+    /// <summary>Selects a cache through which all input frames will be loaded</summary>
+    /// <param name="frameCache">Cache that will be used to look up decoded frames</param>
+    /// <remarks>
+    ///   Without a cache, each input frame is loaded from disk whenever it is needed.
+    /// </remarks>
+    public: void SetFrameCache(const std::shared_ptr<Services::FrameCache> &frameCache);
+
+    /// <summary>Limits how much memory the frames in flight may take up</summary>
+    /// <param name="limitInBytes">Number of bytes frames may occupy, 0 for no limit</param>
+    /// <remarks>
+    ///   <para>
+    ///     The budget covers frames read ahead, the running sums of averaging runs, frames
+    ///     waiting to be written and the frame cache. When it is exhausted, reading ahead
+    ///     and handing frames to the encoder threads wait for the other stages to catch up
+    ///     and the frame cache evicts images.
+    ///   </para>
+    ///   <para>
+    ///     The few frames each thread is working on at any moment are not covered, so
+    ///     the budget should leave some room for those (a 16 bit 4K frame takes 64 MiB).
+    ///   </para>
+    /// </remarks>
+    public: void SetFrameMemoryBudget(std::size_t limitInBytes);
+
+    /// <summary>Provides the budget that limits the memory used by frames in flight</summary>
+    /// <returns>The renderer's frame memory budget</returns>
+    /// <remarks>
+    ///   The current and peak usage can be read from any thread while a render is
+    ///   running. The peak usage is reset when a render begins.
+    /// </remarks>
+    public: std::shared_ptr<const Rendering::FrameMemoryBudget> GetFrameMemoryBudget() const;
+
+    /// <summary>Toggles whether decoding and writing run in their own threads</summary>
+    /// <param name="enable">True to decode, process and write frames concurrently</param>
+    /// <remarks>
+    ///   When enabled, input frames are decoded ahead of time by I/O threads and
+    ///   output frames are compressed and written by another, so that only the actual
+    ///   processing (deinterlacing, interpolating and averaging) happens in the thread
+    ///   calling <see cref="Render" />. Both hand-overs are bounded, limiting how many
+    ///   frames are held in memory. Output frames are still written in order.
+    /// </remarks>
+    public: void EnablePipelining(bool enable = true);
+
+    /// <summary>Sets the number of threads that will compress and write output frames</summary>
+    /// <param name="threadCount">Number of encoder threads to use</param>
+    /// <remarks>
+    ///   PNG compression of 16 bit frames usually takes longer than processing them,
+    ///   so using several encoder threads speeds up exports considerably. With more than
+    ///   one thread, output frames are written in the background even if pipelining
+    ///   is disabled. The number of frames waiting for an encoder is limited.
+    /// </remarks>
+    public: void SetEncoderThreadCount(std::size_t threadCount);
+
+    /// <summary>Sets how many input frames will be decoded ahead when pipelining</summary>
+    /// <param name="frameCount">Number of input frames that will be decoded ahead</param>
+    /// <remarks>
+    ///   The read-ahead follows the order in which the render will need the input frames,
+    ///   including replacement frames, averaging runs and the sources of interpolated
+    ///   frames. A deeper read-ahead hides more storage latency (such as that of frame
+    ///   folders on a network share) at the cost of keeping more frames in memory.
+    /// </remarks>
+    public: void SetReadAheadDepth(std::size_t frameCount);
+
+    /// <summary>Sets the number of threads that will read and decode input frames</summary>
+    /// <param name="threadCount">Number of I/O threads to use</param>
+    /// <remarks>
+    ///   Only has an effect when pipelining is enabled. When segments are rendered in
+    ///   parallel, each segment reads ahead with a single I/O thread instead.
+    /// </remarks>
+    public: void SetReadAheadThreadCount(std::size_t threadCount);
+
+    /// <summary>Sets the number of threads that will process segments of the movie</summary>
+    /// <param name="threadCount">Number of processing threads to use</param>
+    /// <remarks>
+    ///   <para>
+    ///     With more than one thread, the renderer cuts the movie into segments and renders
+    ///     them concurrently, each thread with its own instance of the deinterlacer. No
+    ///     averaging run or interpolation source crosses a cut, and output frame numbers
+    ///     are assigned up front, so every frame lands where a single-threaded render
+    ///     would put it. If the deinterlacer cannot be cloned, rendering falls back to
+    ///     a single thread. Without segments, the threads still sum up bands of the frames
+    ///     in averaging runs.
+    ///   </para>
+    ///   <para>
+    ///     In interlaced stretches, where the deinterlacer looks at the processed prior
+    ///     frame, a segment begins with <see cref="Rendering::RenderPlan.WarmUpOperationCount" />
+    ///     frames that are processed but not written (see
+    ///     <see cref="Rendering::RenderPlan.FindIndependentOperation" />). The deinterlacer
+    ///     only sees that many frames of history instead of the whole stretch, so the first
+    ///     frames after a cut may differ slightly from a single-threaded render.
+    ///   </para>
+    /// </remarks>
+    public: void SetProcessingThreadCount(std::size_t threadCount);
+
+    /// <summary>Toggles whether output frames that are still up to date are skipped</summary>
+    /// <param name="enable">True to only write output frames whose inputs changed</param>
+    /// <remarks>
+    ///   When enabled, the renderer keeps a manifest in the output directory recording
+    ///   the inputs (source frames, frame actions, deinterlacer and other settings) each
+    ///   output frame was rendered from. When rendering into the same directory again,
+    ///   only output frames whose inputs changed or which are missing are rendered.
+    ///   This also lets a canceled or crashed render continue where it stopped.
+    /// </remarks>
+    public: void EnableIncrementalRendering(bool enable = true);
+
+    /// <summary>Toggles whether a summary of the render is saved with the output frames</summary>
+    /// <param name="enable">True to save the render statistics in the target directory</param>
+    /// <remarks>
+    ///   Enabled by default. Should be disabled if several renderers write into the same
+    ///   directory, otherwise each render overwrites the summary of the others.
+    /// </remarks>
+    public: void EnableStatisticsFile(bool enable = true);
+
+    /// <summary>Selects the image format output frames will be saved in</summary>
+    /// <param name="imageEncoder">
+    ///   Encoder that will save the output frames or an empty pointer to use the default,
+    ///   PNG images with zlib's default compression
+    /// </param>
+    /// <remarks>
+    ///   Fast formats are useful when the frames are only an intermediate step and will
+    ///   be fed into a video encoder afterwards. The image format does not matter when
+    ///   encoding into a video file or streaming.
+    /// </remarks>
+    public: void SetImageEncoder(
+      const std::shared_ptr<Rendering::ImageFormats::ImageEncoder> &imageEncoder
+    );
+
+    /// <summary>Selects whether output frames are encoded into a video file</summary>
+    /// <param name="videoSettings">
+    ///   Codec, quality and frame rate of the video or an empty value to save each
+    ///   output frame as an image
+    /// </param>
+    /// <remarks>
+    ///   The video is written into the target directory. Since the frames have to reach
+    ///   the video codec in order, the movie is processed by a single thread in this mode
+    ///   and incremental rendering does not apply.
+    /// </remarks>
+    public: void SetVideoOutput(const std::optional<Rendering::VideoSettings> &videoSettings);
+
+    /// <summary>Selects whether output frames are streamed to another application</summary>
+    /// <param name="streamSettings">
+    ///   Format and destination of the stream or an empty value to save each
+    ///   output frame as an image
+    /// </param>
+    /// <remarks>
+    ///   As with video output, the movie is processed by a single thread so that frames
+    ///   are streamed in order, and incremental rendering does not apply. The directory
+    ///   passed to <see cref="Render" /> is not used for streams.
+    /// </remarks>
+    public: void SetStreamOutput(const std::optional<Rendering::StreamSettings> &streamSettings);
+
     /// <summary>
     ///   Limits the frames being rendered to those produced by the specified input frames
     /// </summary>
@@ -123,6 +324,28 @@ namespace Nuclex::FrameFixer {
       return this->completedFrameCount.load(std::memory_order::memory_order_relaxed);
     }
 
+    /// <summary>Provides the timings and throughput figures of the current render</summary>
+    /// <returns>The statistics of the current or most recent render</returns>
+    /// <remarks>
+    ///   The statistics are reset when a render begins and can be read from any thread
+    ///   while it is running. When a render into a directory completes, a summary of
+    ///   the statistics is also saved next to the output frames.
+    /// </remarks>
+    public: std::shared_ptr<const Rendering::RenderStatistics> GetStatistics() const;
+
+    /// <summary>Determines the output frames a render of the movie will write</summary>
+    /// <param name="movie">Movie whose output frames will be determined</param>
+    /// <returns>
+    ///   The first output frame index and the index one past the last output frame within
+    ///   the input and output ranges. If no frames would be written, both are equal.
+    /// </returns>
+    public: std::pair<std::size_t, std::size_t> GetOutputFrameRange(
+      const std::shared_ptr<Movie> &movie
+    ) const;
+
+    /// <summary>Calculates the number of frames a render of the movie will write</summary>
+    /// <param name="movie">Movie whose output frames will be counted</param>
+    /// <returns>The number of output frames within the input and output ranges</returns>
     public: std::size_t GetTotalFrameCount(const std::shared_ptr<Movie> &movie) const;
 
     /// <summary>Processes and saves a movie's frames into the specified directory</summary>
@@ -149,6 +372,192 @@ namespace Nuclex::FrameFixer {
     /// </remarks>
     public: QImage Preview(const std::shared_ptr<Movie> &movie, const std::size_t frameIndex);
 
+    /// <summary>Run of render plan operations that can be rendered independently</summary>
+    private: struct Segment {
+
+      /// <summary>Index of the first operation in the segment</summary>
+      public: std::size_t StartOperationIndex;
+      /// <summary>Index of the first operation whose output frames will be saved</summary>
+      /// <remarks>
+      ///   Operations before this one only warm up the deinterlacer and are discarded.
+      /// </remarks>
+      public: std::size_t FirstOutputOperationIndex;
+      /// <summary>Index one past the last operation in the segment</summary>
+      public: std::size_t EndOperationIndex;
+
+    };
+
+    /// <summary>Compiles a render plan for the movie using the current settings</summary>
+    /// <param name="movie">Movie for which a render plan will be compiled</param>
+    /// <returns>The render plan for the specified movie</returns>
+    private: Rendering::RenderPlan compilePlan(const Movie &movie) const;
+
+    /// <summary>Determines the operations needed to render the requested ranges</summary>
+    /// <param name="plan">Render plan whose operations will be looked up</param>
+    /// <param name="startOperationIndex">
+    ///   Receives the index of the first operation producing frames within the ranges
+    /// </param>
+    /// <param name="endOperationIndex">
+    ///   Receives the index one past the last operation producing frames within the ranges
+    /// </param>
+    private: void findOperationRange(
+      const Rendering::RenderPlan &plan,
+      std::size_t &startOperationIndex,
+      std::size_t &endOperationIndex
+    ) const;
+
+    /// <summary>Cuts a run of operations into segments that can be rendered independently</summary>
+    /// <param name="plan">Render plan containing the operations</param>
+    /// <param name="run">Run of operations that will be cut into segments</param>
+    /// <param name="segmentCount">Number of segments that should be aimed for</param>
+    /// <returns>The segments, in order, covering all operations that need to be executed</returns>
+    /// <remarks>
+    ///   Segments may begin with a few warm-up operations that overlap the segment before
+    ///   them, so that long stretches of deinterlaced frames can still be cut up.
+    /// </remarks>
+    private: static std::vector<Segment> findIndependentSegments(
+      const Rendering::RenderPlan &plan, const Segment &run, std::size_t segmentCount
+    );
+
+    /// <summary>Finds the runs of operations that produce outdated output frames</summary>
+    /// <param name="plan">Render plan containing the operations</param>
+    /// <param name="writer">Writer that knows which output frames are up to date</param>
+    /// <param name="startOperationIndex">Index of the first operation to render</param>
+    /// <param name="endOperationIndex">Index one past the last operation to render</param>
+    /// <returns>
+    ///   Runs of operations, each beginning at an independent operation or warm-up start,
+    ///   that need to be executed to bring all output frames in the requested ranges
+    ///   up to date
+    /// </returns>
+    private: std::vector<Segment> findOutdatedRuns(
+      const Rendering::RenderPlan &plan,
+      const Rendering::FrameWriter &writer,
+      std::size_t startOperationIndex,
+      std::size_t endOperationIndex
+    ) const;
+
+    /// <summary>Counts the output frames of an operation that lie within the ranges</summary>
+    /// <param name="plan">Render plan containing the operation</param>
+    /// <param name="operationIndex">Index of the operation whose frames will be counted</param>
+    /// <returns>The number of output frames the operation will contribute</returns>
+    private: std::size_t countOutputFramesInRange(
+      const Rendering::RenderPlan &plan, std::size_t operationIndex
+    ) const;
+
+    /// <summary>Checks whether output frames have to be written in order</summary>
+    /// <returns>True if the frames go into a video file or a stream</returns>
+    private: bool needsOrderedOutput() const;
+
+    /// <summary>Describes all settings that affect the contents of output frames</summary>
+    /// <returns>A string that changes whenever the output frames would change</returns>
+    private: std::string describeSettings() const;
+
+    /// <summary>Renders the specified segments using one thread per deinterlacer</summary>
+    /// <param name="movie">Movie whose segments will be rendered</param>
+    /// <param name="plan">Render plan the segments refer to</param>
+    /// <param name="writer">Writer that will receive the output frames</param>
+    /// <param name="segments">Segments that will be rendered</param>
+    /// <param name="deinterlacers">Deinterlacers that will be used by the threads</param>
+    /// <param name="canceller">Allows the render process ot be cancelled</param>
+    private: void renderSegmentsInParallel(
+      const std::shared_ptr<Movie> &movie,
+      const Rendering::RenderPlan &plan,
+      Rendering::FrameWriter &writer,
+      const std::vector<Segment> &segments,
+      const std::vector<std::shared_ptr<Algorithm::Deinterlacing::Deinterlacer>> &deinterlacers,
+      const std::shared_ptr<const Nuclex::Platform::Tasks::CancellationWatcher> &canceller
+    );
+
+    /// <summary>Lists the source frames a run of operations will load, in order</summary>
+    /// <param name="plan">Render plan containing the operations</param>
+    /// <param name="deinterlacer">Deinterlacer the operations will be executed with</param>
+    /// <param name="loader">Loader that will provide the input frames</param>
+    /// <param name="startOperationIndex">Index of the first operation to execute</param>
+    /// <param name="endOperationIndex">Index one past the last operation to execute</param>
+    /// <returns>The source frame indices in the order the operations will request them</returns>
+    /// <remarks>
+    ///   This has to mirror the order in which <see cref="renderSegment" /> requests
+    ///   the images from its loader, otherwise the read-ahead will decode frames for nothing.
+    /// </remarks>
+    private: std::vector<std::size_t> getLoadOrder(
+      const Rendering::RenderPlan &plan,
+      const Algorithm::Deinterlacing::Deinterlacer &deinterlacer,
+      const Rendering::FrameLoader &loader,
+      std::size_t startOperationIndex,
+      std::size_t endOperationIndex
+    ) const;
+
+    /// <summary>Executes a consecutive run of operations from the render plan</summary>
+    /// <param name="movie">Movie whose frames will be rendered</param>
+    /// <param name="plan">Render plan containing the operations</param>
+    /// <param name="deinterlacer">Deinterlacer that will be used on interlaced frames</param>
+    /// <param name="loader">Loader that will provide the input frames</param>
+    /// <param name="writer">Writer that will receive the output frames</param>
+    /// <param name="segment">Operations that will be executed and saved</param>
+    /// <param name="averagingThreadCount">
+    ///   Number of threads that will sum up bands of the frames in averaging runs
+    /// </param>
+    /// <param name="canceller">Allows the render process ot be cancelled</param>
+    private: void renderSegment(
+      const std::shared_ptr<Movie> &movie,
+      const Rendering::RenderPlan &plan,
+      Algorithm::Deinterlacing::Deinterlacer &deinterlacer,
+      Rendering::FrameLoader &loader,
+      Rendering::FrameWriter &writer,
+      const Segment &segment,
+      std::size_t averagingThreadCount,
+      const std::shared_ptr<const Nuclex::Platform::Tasks::CancellationWatcher> &canceller
+    );
+
+    /// <summary>Generates a preview image of a single frame using a specific deinterlacer</summary>
+    /// <param name="movie">Movie of which a preview frame will be rendered</param>
+    /// <param name="frameIndex">Index of the frame that will be rendered as a preview</param>
+    /// <param name="deinterlacer">Deinterlacer that will be used on the frame</param>
+    /// <returns>A Qt image with a preview of the frame with the specified index</returns>
+    private: QImage preview(
+      const std::shared_ptr<Movie> &movie,
+      std::size_t frameIndex,
+      Algorithm::Deinterlacing::Deinterlacer &deinterlacer
+    );
+
+    /// <summary>Loads the image of an input frame, using the frame cache if set</summary>
+    /// <param name="movie">Movie whose frame will be loaded</param>
+    /// <param name="frameIndex">Index of the frame that will be loaded</param>
+    /// <returns>The image of the requested frame</returns>
+    private: QImage loadFrame(const Movie &movie, std::size_t frameIndex) const;
+
+    /// <summary>Deinterlaces an image, recording the time it took</summary>
+    /// <param name="deinterlacer">Deinterlacer that will be used on the image</param>
+    /// <param name="image">Image that will be deinterlaced</param>
+    /// <param name="mode">How the fields of the image will be combined</param>
+    private: void deinterlace(
+      Algorithm::Deinterlacing::Deinterlacer &deinterlacer, QImage &image, DeinterlaceMode mode
+    );
+
+    /// <summary>Interpolates a frame, making sure only one thread does so at a time</summary>
+    /// <param name="prior">Frame before the one that will be interpolated</param>
+    /// <param name="after">Frame after the one that will be interpolated</param>
+    /// <returns>The interpolated frame</returns>
+    private: QImage interpolate(const QImage &prior, const QImage &after);
+
+    /// <summary>Checks whether an output frame lies within the input and output ranges</summary>
+    /// <param name="inputFrameIndex">Index of the input frame that produced the frame</param>
+    /// <param name="outputFrameIndex">Index of the output frame</param>
+    /// <returns>True if the output frame is within the ranges that should be rendered</returns>
+    private: bool isInRange(std::size_t inputFrameIndex, std::size_t outputFrameIndex) const;
+
+    /// <summary>Saves an output frame if it lies within the input and output ranges</summary>
+    /// <param name="writer">Writer through which the image will be saved</param>
+    /// <param name="image">Image containing the pixels that will potentially be saved</param>
+    /// <param name="inputFrameIndex">Index of the input frame that produced the image</param>
+    /// <param name="outputFrameIndex">Index of the output frame</param>
+    private: void saveFrame(
+      Rendering::FrameWriter &writer,
+      const QImage &image,
+      std::size_t inputFrameIndex,
+      std::size_t outputFrameIndex
+    );
+
     /// <summary>Deinterlacer the renderer is using on the input frames</summary>
     private: std::shared_ptr<Algorithm::Deinterlacing::Deinterlacer> deinterlacer;
     /// <summary>Interpolator the renderer is using on the input frames</summary>
@@ -161,6 +570,38 @@ namespace Nuclex::FrameFixer {
     private: bool flipFields;
     /// <summary>Whether to collapse successive frames being averaged into one</summary>
     private: bool collapseAverageFrames;
+    /// <summary>How the frames in averaging runs will be combined</summary>
+    private: AverageMode averageMode;
+    /// <summary>Whether decoding and writing happen in separate threads</summary>
+    private: bool pipelined;
+    /// <summary>Number of threads that will encode and write output frames</summary>
+    private: std::size_t encoderThreadCount;
+    /// <summary>Number of threads that will render segments of the movie</summary>
+    private: std::size_t processingThreadCount;
+    /// <summary>Number of input frames that will be decoded ahead when pipelining</summary>
+    private: std::size_t readAheadDepth;
+    /// <summary>Number of threads that will decode input frames ahead</summary>
+    private: std::size_t readAheadThreadCount;
+    /// <summary>Whether output frames that are still up to date will be skipped</summary>
+    private: bool incremental;
+    /// <summary>Whether the render statistics will be saved in the target directory</summary>
+    private: bool savesStatistics;
+    /// <summary>Encoder that saves output frames as images, empty for the default</summary>
+    private: std::shared_ptr<Rendering::ImageFormats::ImageEncoder> imageEncoder;
+    /// <summary>Settings for encoding into a video file, empty to write images</summary>
+    private: std::optional<Rendering::VideoSettings> videoSettings;
+    /// <summary>Settings for streaming to another application, empty to write images</summary>
+    private: std::optional<Rendering::StreamSettings> streamSettings;
+    /// <summary>Must be held while the interpolator is in use</summary>
+    private: std::mutex interpolatorMutex;
+    /// <summary>Cache through which input frames are loaded, can be empty</summary>
+    private: std::shared_ptr<Services::FrameCache> frameCache;
+    /// <summary>Timings and throughput figures of the current render</summary>
+    private: std::shared_ptr<Rendering::RenderStatistics> statistics;
+    /// <summary>Limits the memory taken up by frames in flight</summary>
+    private: std::shared_ptr<Rendering::FrameMemoryBudget> memoryBudget;
+    /// <summary>Recycles the memory of frames the renderer modifies</summary>
+    private: std::shared_ptr<Rendering::FrameBufferPool> frameBufferPool;
     /// <summary>The number of frames the renderer has completed so far</summary>
     private: std::atomic<std::size_t> completedFrameCount;
 
@@ -0,0 +1,157 @@
+#pragma region Apache License 2.0
+/*
+Nuclex Frame Fixer
+Copyright (C) 2024 Markus Ewald / Nuclex Development Labs
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#pragma endregion // Apache License 2.0
+
+#ifndef NUCLEX_FRAMEFIXER_RENDERING_BOUNDEDQUEUE_H
+#define NUCLEX_FRAMEFIXER_RENDERING_BOUNDEDQUEUE_H
+
+#include "Nuclex/FrameFixer/Config.h"
+
+#include <cstddef> // for std::size_t
+#include <deque> // for std::deque
+#include <mutex> // for std::mutex, std::unique_lock
+#include <condition_variable> // for std::condition_variable
+
+namespace Nuclex::FrameFixer::Rendering {
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Queue with a fixed capacity that blocks producers when it is full</summary>
+  /// <typeparam name="TItem">Type of the items that will be passed through the queue</typeparam>
+  /// <remarks>
+  ///   <para>
+  ///     This is used to connect the stages of the render pipeline. Each stage runs in
+  ///     its own thread, so the capacity limits how far one stage can run ahead of the next
+  ///     (and with it, the number of decoded frames that are held in memory).
+  ///   </para>
+  ///   <para>
+  ///     Closing the queue works in both directions: a producer that has nothing more to
+  ///     send closes it so the consumer drains the remaining items and then stops, whereas
+  ///     a consumer that gives up closes it so a producer blocked in <see cref="Push" />
+  ///     wakes up and learns that nobody is listening anymore.
+  ///   </para>
+  /// </remarks>
+  template<typename TItem>
+  class BoundedQueue {
+
+    /// <summary>Initializes a new bounded queue</summary>
+    /// <param name="capacity">Maximum number of items the queue can hold</param>
+    public: explicit BoundedQueue(std::size_t capacity) :
+      capacity((capacity >= 1) ? capacity : 1),
+      closed(false) {}
+
+    /// <summary>Frees all resources owned by the queue</summary>
+    public: ~BoundedQueue() = default;
+
+    /// <summary>Appends an item to the queue, waiting if the queue is full</summary>
+    /// <param name="item">Item that will be appended to the queue</param>
+    /// <returns>True if the item was queued, false if the queue has been closed</returns>
+    public: bool Push(TItem &&item) {
+      std::unique_lock<std::mutex> lock(this->mutex);
+      this->notFull.wait(
+        lock, [this]() { return this->closed || (this->items.size() < this->capacity); }
+      );
+      if(this->closed) {
+        return false;
+      }
+
+      this->items.push_back(std::move(item));
+      lock.unlock();
+
+      this->notEmpty.notify_one();
+      return true;
+    }
+
+    /// <summary>Takes the oldest item from the queue, waiting if the queue is empty</summary>
+    /// <param name="item">Receives the item that was taken from the queue</param>
+    /// <returns>
+    ///   True if an item was taken, false if the queue has been closed and is empty
+    /// </returns>
+    public: bool Pop(TItem &item) {
+      std::unique_lock<std::mutex> lock(this->mutex);
+      this->notEmpty.wait(
+        lock, [this]() { return this->closed || !this->items.empty(); }
+      );
+      if(this->items.empty()) {
+        return false; // Queue was closed and all remaining items have been drained
+      }
+
+      // The item is assigned only after the lock has been released because
+      // whatever the item overwrites may do some work of its own when destroyed
+      TItem frontItem(std::move(this->items.front()));
+      this->items.pop_front();
+      lock.unlock();
+
+      item = std::move(frontItem);
+      this->notFull.notify_one();
+      return true;
+    }
+
+    /// <summary>Checks whether the queue currently holds no items</summary>
+    /// <returns>True if there are no items waiting in the queue</returns>
+    public: bool IsEmpty() const {
+      std::unique_lock<std::mutex> lock(this->mutex);
+      return this->items.empty();
+    }
+
+    /// <summary>Closes the queue, waking up all threads waiting on it</summary>
+    /// <remarks>
+    ///   Items still in the queue can be taken after it has been closed, but no new items
+    ///   can be pushed. Closing the queue more than once is harmless.
+    /// </remarks>
+    public: void Close() {
+      {
+        std::unique_lock<std::mutex> lock(this->mutex);
+        this->closed = true;
+      }
+
+      this->notFull.notify_all();
+      this->notEmpty.notify_all();
+    }
+
+    /// <summary>Drops all items that are still waiting in the queue</summary>
+    public: void Clear() {
+      std::deque<TItem> droppedItems;
+      {
+        std::unique_lock<std::mutex> lock(this->mutex);
+        this->items.swap(droppedItems);
+      }
+
+      this->notFull.notify_all();
+    }
+
+    /// <summary>Maximum number of items the queue can hold</summary>
+    private: std::size_t capacity;
+    /// <summary>Whether the queue has been closed</summary>
+    private: bool closed;
+    /// <summary>Items currently waiting in the queue</summary>
+    private: std::deque<TItem> items;
+    /// <summary>Must be held while accessing the item list or the closed flag</summary>
+    private: mutable std::mutex mutex;
+    /// <summary>Signalled when an item has been taken from the queue</summary>
+    private: std::condition_variable notFull;
+    /// <summary>Signalled when an item has been added to the queue</summary>
+    private: std::condition_variable notEmpty;
+
+  };
+
+  // ------------------------------------------------------------------------------------------- //
+
+} // namespace Nuclex::FrameFixer::Rendering
+
+#endif // NUCLEX_FRAMEFIXER_RENDERING_BOUNDEDQUEUE_H
@@ -0,0 +1,275 @@
+#pragma region Apache License 2.0
+/*
+Nuclex Frame Fixer
+Copyright (C) 2024 Markus Ewald / Nuclex Development Labs
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#pragma endregion // Apache License 2.0
+
+// If the application is compiled as a DLL, this ensures symbols are exported
+#define NUCLEX_FRAMEFIXER_SOURCE 1
+
+#include "./FrameBuffer.h"
+#include "./FrameBufferPool.h"
+
+#include <new> // for std::align_val_t
+#include <stdexcept> // for std::runtime_error
+
+namespace {
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Rounds a number of bytes up to the next multiple of the row alignment</summary>
+  /// <param name="byteCount">Number of bytes that will be rounded up</param>
+  /// <param name="alignment">Alignment to which the byte count will be rounded up</param>
+  /// <returns>The smallest multiple of the alignment not less than the byte count</returns>
+  std::size_t alignUp(std::size_t byteCount, std::size_t alignment) {
+    return (byteCount + alignment - 1) / alignment * alignment;
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Returns the number of bytes each channel of a pixel occupies</summary>
+  /// <param name="format">Pixel format whose channel size will be returned</param>
+  /// <returns>The size of a single channel in bytes</returns>
+  std::size_t getBytesPerChannel(Nuclex::FrameFixer::Rendering::FramePixelFormat format) {
+    using Nuclex::FrameFixer::Rendering::FramePixelFormat;
+
+    if((format == FramePixelFormat::Rgba64) || (format == FramePixelFormat::Rgbx64)) {
+      return 2;
+    } else {
+      return 1;
+    }
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Calculates the stride of a frame buffer allocated by this code</summary>
+  /// <param name="width">Width of the frame in pixels</param>
+  /// <param name="format">Format in which the pixels will be stored</param>
+  /// <param name="layout">Whether the channels are interleaved or in separate planes</param>
+  /// <param name="alignment">Alignment each row needs to begin on</param>
+  /// <returns>The number of bytes from one row to the next</returns>
+  std::size_t getAlignedStride(
+    int width,
+    Nuclex::FrameFixer::Rendering::FramePixelFormat format,
+    Nuclex::FrameFixer::Rendering::FrameLayout layout,
+    std::size_t alignment
+  ) {
+    using Nuclex::FrameFixer::Rendering::FrameLayout;
+
+    // All supported formats have four channels (with alpha being unused in some),
+    // so interleaved rows hold four channels per pixel and planar rows hold one
+    std::size_t rowLength = static_cast<std::size_t>(width) * getBytesPerChannel(format);
+    if(layout == FrameLayout::Interleaved) {
+      rowLength *= 4;
+    }
+
+    return alignUp(rowLength, alignment);
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Releases the frame buffer a QImage has been using</summary>
+  /// <param name="cleanupInfo">Shared pointer to the frame buffer, allocated on the heap</param>
+  void releaseWrappedFrameBuffer(void *cleanupInfo) {
+    delete reinterpret_cast<std::shared_ptr<Nuclex::FrameFixer::Rendering::FrameBuffer> *>(
+      cleanupInfo
+    );
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+} // anonymous namespace
+
+namespace Nuclex::FrameFixer::Rendering {
+
+  // ------------------------------------------------------------------------------------------- //
+
+  const std::size_t FrameBuffer::RowAlignment = 64;
+
+  // ------------------------------------------------------------------------------------------- //
+
+  FrameBuffer::FrameBuffer(
+    int width, int height,
+    FramePixelFormat format, FrameLayout layout /* = FrameLayout::Interleaved */
+  ) :
+    width(width),
+    height(height),
+    format(format),
+    layout(layout),
+    stride(getAlignedStride(width, format, layout, RowAlignment)),
+    planeSize(this->stride * static_cast<std::size_t>(height)),
+    pixels(nullptr),
+    memory(nullptr),
+    capacity(GetRequiredByteCount(width, height, format, layout)),
+    pool() {
+    this->memory = allocate(this->capacity);
+    this->pixels = this->memory;
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  FrameBuffer::FrameBuffer(
+    int width, int height, FramePixelFormat format, FrameLayout layout,
+    std::uint8_t *memory, std::size_t capacity,
+    const std::shared_ptr<FrameBufferPool> &pool
+  ) :
+    width(width),
+    height(height),
+    format(format),
+    layout(layout),
+    stride(getAlignedStride(width, format, layout, RowAlignment)),
+    planeSize(this->stride * static_cast<std::size_t>(height)),
+    pixels(memory),
+    memory(memory),
+    capacity(capacity),
+    pool(pool) {}
+
+  // ------------------------------------------------------------------------------------------- //
+
+  FrameBuffer::FrameBuffer(const QImage &image, std::uint8_t *pixels) :
+    width(image.width()),
+    height(image.height()),
+    format(GetPixelFormat(image)),
+    layout(FrameLayout::Interleaved),
+    stride(static_cast<std::size_t>(image.bytesPerLine())),
+    planeSize(this->stride * static_cast<std::size_t>(image.height())),
+    pixels(pixels),
+    memory(nullptr),
+    capacity(0),
+    pool() {}
+
+  // ------------------------------------------------------------------------------------------- //
+
+  FrameBuffer::FrameBuffer(FrameBuffer &&other) :
+    width(other.width),
+    height(other.height),
+    format(other.format),
+    layout(other.layout),
+    stride(other.stride),
+    planeSize(other.planeSize),
+    pixels(other.pixels),
+    memory(other.memory),
+    capacity(other.capacity),
+    pool(std::move(other.pool)) {
+    other.pixels = nullptr;
+    other.memory = nullptr;
+    other.capacity = 0;
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  FrameBuffer::~FrameBuffer() {
+    if(this->memory != nullptr) {
+      if(static_cast<bool>(this->pool)) {
+        this->pool->recycle(this->memory, this->capacity);
+      } else {
+        deallocate(this->memory);
+      }
+    }
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  FrameBuffer FrameBuffer::Wrap(QImage &image) {
+    return FrameBuffer(image, image.bits()); // bits() detaches the image if it is shared
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  FrameBuffer FrameBuffer::WrapReadOnly(const QImage &image) {
+    return FrameBuffer(image, const_cast<std::uint8_t *>(image.constBits()));
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  QImage FrameBuffer::ToImage(const std::shared_ptr<FrameBuffer> &buffer) {
+    if((buffer->layout != FrameLayout::Interleaved) || (buffer->memory == nullptr)) {
+      throw std::runtime_error(
+        u8"Only interleaved frame buffers owning their memory can be handed out as QImage"
+      );
+    }
+
+    // The QImage holds a reference to the frame buffer until its last copy is gone
+    return QImage(
+      buffer->pixels,
+      buffer->width,
+      buffer->height,
+      static_cast<qsizetype>(buffer->stride),
+      GetImageFormat(buffer->format),
+      &releaseWrappedFrameBuffer,
+      new std::shared_ptr<FrameBuffer>(buffer)
+    );
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  FramePixelFormat FrameBuffer::GetPixelFormat(const QImage &image) {
+    switch(image.depth()) {
+      case 32: {
+        return image.hasAlphaChannel() ? FramePixelFormat::Argb32 : FramePixelFormat::Rgb32;
+      }
+      case 64: {
+        return image.hasAlphaChannel() ? FramePixelFormat::Rgba64 : FramePixelFormat::Rgbx64;
+      }
+      default: {
+        throw std::runtime_error(u8"Image format can not be stored in a frame buffer");
+      }
+    }
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  QImage::Format FrameBuffer::GetImageFormat(FramePixelFormat format) {
+    switch(format) {
+      case FramePixelFormat::Rgb32: { return QImage::Format_RGB32; }
+      case FramePixelFormat::Argb32: { return QImage::Format_ARGB32; }
+      case FramePixelFormat::Rgbx64: { return QImage::Format_RGBX64; }
+      default: { return QImage::Format_RGBA64; }
+    }
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  std::size_t FrameBuffer::GetRequiredByteCount(
+    int width, int height, FramePixelFormat format, FrameLayout layout
+  ) {
+    std::size_t planeSize = (
+      getAlignedStride(width, format, layout, RowAlignment) * static_cast<std::size_t>(height)
+    );
+    if(layout == FrameLayout::Planar) {
+      return planeSize * 4;
+    } else {
+      return planeSize;
+    }
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  std::uint8_t *FrameBuffer::allocate(std::size_t byteCount) {
+    return static_cast<std::uint8_t *>(
+      ::operator new[](byteCount, std::align_val_t(RowAlignment))
+    );
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  void FrameBuffer::deallocate(std::uint8_t *memory) {
+    ::operator delete[](memory, std::align_val_t(RowAlignment));
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+} // namespace Nuclex::FrameFixer::Rendering
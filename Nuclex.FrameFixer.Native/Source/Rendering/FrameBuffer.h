@@ -0,0 +1,287 @@
+#pragma region Apache License 2.0
+/*
+Nuclex Frame Fixer
+Copyright (C) 2024 Markus Ewald / Nuclex Development Labs
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#pragma endregion // Apache License 2.0
+
+#ifndef NUCLEX_FRAMEFIXER_RENDERING_FRAMEBUFFER_H
+#define NUCLEX_FRAMEFIXER_RENDERING_FRAMEBUFFER_H
+
+#include "Nuclex/FrameFixer/Config.h"
+
+#include <QImage>
+
+#include <cstddef> // for std::size_t
+#include <cstdint> // for std::uint8_t
+#include <memory> // for std::shared_ptr
+
+namespace Nuclex::FrameFixer::Rendering {
+
+  // ------------------------------------------------------------------------------------------- //
+
+  class FrameBufferPool;
+
+  // ------------------------------------------------------------------------------------------- //
+
+} // namespace Nuclex::FrameFixer::Rendering
+
+namespace Nuclex::FrameFixer::Rendering {
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Pixel formats a frame buffer can store</summary>
+  enum class FramePixelFormat {
+
+    /// <summary>8 bits per channel, stored like QImage::Format_RGB32 (QRgb)</summary>
+    Rgb32,
+    /// <summary>8 bits per channel with alpha, stored like QImage::Format_ARGB32 (QRgb)</summary>
+    Argb32,
+    /// <summary>16 bits per channel, stored like QImage::Format_RGBX64</summary>
+    Rgbx64,
+    /// <summary>16 bits per channel with alpha, stored like QImage::Format_RGBA64</summary>
+    Rgba64
+
+  };
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>How the channels of the pixels in a frame buffer are arranged</summary>
+  enum class FrameLayout {
+
+    /// <summary>All channels of a pixel are stored next to each other in one plane</summary>
+    Interleaved,
+    /// <summary>Each channel is stored in its own plane, in R, G, B, A order</summary>
+    Planar
+
+  };
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Pixels of a frame in memory laid out for fast processing</summary>
+  /// <remarks>
+  ///   <para>
+  ///     Frame buffers state their pixel format explicitly, so algorithms can pick their
+  ///     code path once per frame rather than guessing it from QImage::bytesPerLine() on
+  ///     each line. Buffers allocated by the frame buffer itself or by a
+  ///     <see cref="FrameBufferPool" /> start each row on a 64 byte boundary (the size of
+  ///     a cache line and of an AVX-512 register), with the stride padded to match.
+  ///   </para>
+  ///   <para>
+  ///     At the boundary to the rest of the application, an interleaved frame buffer can be
+  ///     handed out as a QImage that uses the buffer's memory without copying it and keeps
+  ///     the buffer alive for as long as the QImage exists. The other way around, a QImage
+  ///     can be wrapped in a frame buffer without copying it. Such a frame buffer is only
+  ///     valid while the QImage exists and its rows are wherever Qt put them, so they
+  ///     may not be aligned.
+  ///   </para>
+  /// </remarks>
+  class FrameBuffer {
+
+    /// <summary>Number of bytes each row of pixels is aligned to</summary>
+    public: static const std::size_t RowAlignment;
+
+    /// <summary>Initializes a new frame buffer and allocates memory for its pixels</summary>
+    /// <param name="width">Width of the frame in pixels</param>
+    /// <param name="height">Height of the frame in pixels</param>
+    /// <param name="format">Format in which the pixels will be stored</param>
+    /// <param name="layout">Whether the channels are interleaved or in separate planes</param>
+    public: FrameBuffer(
+      int width, int height,
+      FramePixelFormat format, FrameLayout layout = FrameLayout::Interleaved
+    );
+    /// <summary>Takes over the pixels of another frame buffer</summary>
+    /// <param name="other">Frame buffer whose pixels will be taken over</param>
+    public: FrameBuffer(FrameBuffer &&other);
+    /// <summary>Frees the memory of the frame buffer or returns it to its pool</summary>
+    public: ~FrameBuffer();
+
+    /// <summary>Wraps a QImage in a frame buffer through which its pixels can be changed</summary>
+    /// <param name="image">Image that will be wrapped</param>
+    /// <returns>A frame buffer accessing the pixels of the image</returns>
+    /// <remarks>
+    ///   If the image shares its pixels with other QImage instances, Qt copies them once
+    ///   here, so the frame buffer can then be written to without any further checks.
+    /// </remarks>
+    public: static FrameBuffer Wrap(QImage &image);
+
+    /// <summary>Wraps a QImage in a frame buffer for reading its pixels</summary>
+    /// <param name="image">Image that will be wrapped</param>
+    /// <returns>A frame buffer accessing the pixels of the image</returns>
+    /// <remarks>
+    ///   The image's pixels are not copied, even if they are shared with other QImage
+    ///   instances, so the returned frame buffer must only be read from.
+    /// </remarks>
+    public: static FrameBuffer WrapReadOnly(const QImage &image);
+
+    /// <summary>Hands out the pixels of a frame buffer as a QImage without copying them</summary>
+    /// <param name="buffer">Interleaved frame buffer that will be handed out</param>
+    /// <returns>A QImage using the frame buffer's memory</returns>
+    /// <remarks>
+    ///   The QImage keeps the frame buffer alive until it and all of its implicitly
+    ///   shared copies have been destroyed. Pooled buffers return to their pool then.
+    /// </remarks>
+    public: static QImage ToImage(const std::shared_ptr<FrameBuffer> &buffer);
+
+    /// <summary>Determines the frame buffer pixel format matching a QImage</summary>
+    /// <param name="image">QImage for which the pixel format will be determined</param>
+    /// <returns>The pixel format storing pixels the same way as the QImage</returns>
+    /// <remarks>
+    ///   The algorithms have always told the pixel layout apart only by the number of bytes
+    ///   per pixel, so other QImage formats with four channels of the same size map to
+    ///   the same pixel formats. Throws an exception for all other QImage formats.
+    /// </remarks>
+    public: static FramePixelFormat GetPixelFormat(const QImage &image);
+
+    /// <summary>Determines the QImage format matching a frame buffer pixel format</summary>
+    /// <param name="format">Pixel format for which the QImage format will be determined</param>
+    /// <returns>The QImage format storing pixels the same way as the pixel format</returns>
+    public: static QImage::Format GetImageFormat(FramePixelFormat format);
+
+    /// <summary>Calculates the number of bytes needed to store a frame</summary>
+    /// <param name="width">Width of the frame in pixels</param>
+    /// <param name="height">Height of the frame in pixels</param>
+    /// <param name="format">Format in which the pixels will be stored</param>
+    /// <param name="layout">Whether the channels are interleaved or in separate planes</param>
+    /// <returns>The number of bytes an aligned frame buffer needs for the pixels</returns>
+    public: static std::size_t GetRequiredByteCount(
+      int width, int height, FramePixelFormat format, FrameLayout layout
+    );
+
+    /// <summary>Returns the width of the frame in pixels</summary>
+    /// <returns>The frame's width in pixels</returns>
+    public: int GetWidth() const { return this->width; }
+
+    /// <summary>Returns the height of the frame in pixels</summary>
+    /// <returns>The frame's height in pixels</returns>
+    public: int GetHeight() const { return this->height; }
+
+    /// <summary>Returns the format in which the pixels are stored</summary>
+    /// <returns>The pixel format of the frame buffer</returns>
+    public: FramePixelFormat GetFormat() const { return this->format; }
+
+    /// <summary>Returns whether the channels are interleaved or in separate planes</summary>
+    /// <returns>The layout of the frame buffer's channels</returns>
+    public: FrameLayout GetLayout() const { return this->layout; }
+
+    /// <summary>Returns the number of bytes from one row to the next in the same plane</summary>
+    /// <returns>The distance between the starts of two rows in bytes</returns>
+    public: std::size_t GetStride() const { return this->stride; }
+
+    /// <summary>Returns the number of bytes the pixels in one row of a plane occupy</summary>
+    /// <returns>The length of a row in bytes, not including any padding</returns>
+    public: std::size_t GetRowLength() const {
+      std::size_t channelsPerPlane = (this->layout == FrameLayout::Planar) ? 1 : 4;
+      std::size_t bytesPerChannel = HasSixteenBitChannels() ? 2 : 1;
+      return static_cast<std::size_t>(this->width) * channelsPerPlane * bytesPerChannel;
+    }
+
+    /// <summary>Returns the number of planes the frame buffer is made up of</summary>
+    /// <returns>1 for interleaved frame buffers, 4 for planar ones</returns>
+    public: std::size_t GetPlaneCount() const {
+      return (this->layout == FrameLayout::Planar) ? 4 : 1;
+    }
+
+    /// <summary>Returns the number of bytes occupied by the pixels of the frame</summary>
+    /// <returns>The size of the frame's pixels in memory, including padding</returns>
+    public: std::size_t GetSizeInBytes() const {
+      return this->planeSize * GetPlaneCount();
+    }
+
+    /// <summary>Checks whether the frame stores 16 bits per color channel</summary>
+    /// <returns>True if each color channel has 16 bits, false if it has 8 bits</returns>
+    public: bool HasSixteenBitChannels() const {
+      return (
+        (this->format == FramePixelFormat::Rgba64) ||
+        (this->format == FramePixelFormat::Rgbx64)
+      );
+    }
+
+    /// <summary>Returns a pointer to the pixels in a row of the frame</summary>
+    /// <param name="lineIndex">Index of the row whose pixels will be returned</param>
+    /// <param name="planeIndex">Plane from which the row will be taken</param>
+    /// <returns>The address of the first pixel in the row</returns>
+    public: std::uint8_t *GetRow(std::size_t lineIndex, std::size_t planeIndex = 0) {
+      return this->pixels + (planeIndex * this->planeSize) + (lineIndex * this->stride);
+    }
+
+    /// <summary>Returns a pointer to the pixels in a row of the frame</summary>
+    /// <param name="lineIndex">Index of the row whose pixels will be returned</param>
+    /// <param name="planeIndex">Plane from which the row will be taken</param>
+    /// <returns>The address of the first pixel in the row</returns>
+    public: const std::uint8_t *GetRow(
+      std::size_t lineIndex, std::size_t planeIndex = 0
+    ) const {
+      return this->pixels + (planeIndex * this->planeSize) + (lineIndex * this->stride);
+    }
+
+    /// <summary>Initializes a frame buffer that uses memory provided by a pool</summary>
+    /// <param name="width">Width of the frame in pixels</param>
+    /// <param name="height">Height of the frame in pixels</param>
+    /// <param name="format">Format in which the pixels will be stored</param>
+    /// <param name="layout">Whether the channels are interleaved or in separate planes</param>
+    /// <param name="memory">Aligned memory the pixels will be stored in</param>
+    /// <param name="capacity">Size of the memory block in bytes</param>
+    /// <param name="pool">Pool the memory will be returned to</param>
+    private: FrameBuffer(
+      int width, int height, FramePixelFormat format, FrameLayout layout,
+      std::uint8_t *memory, std::size_t capacity,
+      const std::shared_ptr<FrameBufferPool> &pool
+    );
+
+    /// <summary>Initializes a frame buffer that accesses the pixels of a QImage</summary>
+    /// <param name="image">Image whose pixels the frame buffer will access</param>
+    /// <param name="pixels">Address of the image's first pixel</param>
+    private: FrameBuffer(const QImage &image, std::uint8_t *pixels);
+
+    /// <summary>Allocates a block of memory aligned to the row alignment</summary>
+    /// <param name="byteCount">Number of bytes that will be allocated</param>
+    /// <returns>The allocated memory block</returns>
+    private: static std::uint8_t *allocate(std::size_t byteCount);
+
+    /// <summary>Frees a block of memory allocated through <see cref="allocate" /></summary>
+    /// <param name="memory">Memory block that will be freed</param>
+    private: static void deallocate(std::uint8_t *memory);
+
+    /// <summary>Width of the frame in pixels</summary>
+    private: int width;
+    /// <summary>Height of the frame in pixels</summary>
+    private: int height;
+    /// <summary>Format in which the pixels are stored</summary>
+    private: FramePixelFormat format;
+    /// <summary>Whether the channels are interleaved or in separate planes</summary>
+    private: FrameLayout layout;
+    /// <summary>Number of bytes from one row to the next</summary>
+    private: std::size_t stride;
+    /// <summary>Number of bytes from one plane to the next</summary>
+    private: std::size_t planeSize;
+    /// <summary>Address of the first pixel in the frame buffer</summary>
+    private: std::uint8_t *pixels;
+    /// <summary>Memory block owned by the frame buffer, null if it wraps a QImage</summary>
+    private: std::uint8_t *memory;
+    /// <summary>Size of the owned memory block in bytes</summary>
+    private: std::size_t capacity;
+    /// <summary>Pool the owned memory block will be returned to, if any</summary>
+    private: std::shared_ptr<FrameBufferPool> pool;
+
+    friend class FrameBufferPool;
+
+  };
+
+  // ------------------------------------------------------------------------------------------- //
+
+} // namespace Nuclex::FrameFixer::Rendering
+
+#endif // NUCLEX_FRAMEFIXER_RENDERING_FRAMEBUFFER_H
@@ -0,0 +1,192 @@
+#pragma region Apache License 2.0
+/*
+Nuclex Frame Fixer
+Copyright (C) 2024 Markus Ewald / Nuclex Development Labs
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#pragma endregion // Apache License 2.0
+
+// If the application is compiled as a DLL, this ensures symbols are exported
+#define NUCLEX_FRAMEFIXER_SOURCE 1
+
+#include "./FrameBufferPool.h"
+
+#include <algorithm> // for std::copy_n()
+
+namespace {
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Checks whether the pool can provide memory for images in a format</summary>
+  /// <param name="format">QImage format that will be checked</param>
+  /// <returns>True if frame buffers can store images in the format</returns>
+  bool isPoolableFormat(QImage::Format format) {
+    return (
+      (format == QImage::Format_RGB32) ||
+      (format == QImage::Format_ARGB32) ||
+      (format == QImage::Format_RGBX64) ||
+      (format == QImage::Format_RGBA64)
+    );
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+} // anonymous namespace
+
+namespace Nuclex::FrameFixer::Rendering {
+
+  // ------------------------------------------------------------------------------------------- //
+
+  const std::size_t FrameBufferPool::DefaultRetainedByteLimit = std::size_t(256) * 1024 * 1024;
+
+  // ------------------------------------------------------------------------------------------- //
+
+  FrameBufferPool::FrameBufferPool(
+    std::size_t retainedByteLimit /* = DefaultRetainedByteLimit */
+  ) :
+    mutex(),
+    idleBlocks(),
+    retainedByteLimit(retainedByteLimit),
+    retainedByteCount(0) {}
+
+  // ------------------------------------------------------------------------------------------- //
+
+  FrameBufferPool::~FrameBufferPool() {
+    Trim();
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  std::shared_ptr<FrameBuffer> FrameBufferPool::Acquire(
+    int width, int height,
+    FramePixelFormat format, FrameLayout layout /* = FrameLayout::Interleaved */
+  ) {
+    std::size_t requiredByteCount = FrameBuffer::GetRequiredByteCount(
+      width, height, format, layout
+    );
+
+    // Look for the smallest idle block that fits. Blocks more than twice as large
+    // are left alone so a thumbnail does not tie up the memory of a whole frame.
+    std::uint8_t *memory = nullptr;
+    std::size_t capacity = 0;
+    {
+      std::unique_lock<std::mutex> poolLock(this->mutex);
+
+      std::size_t bestIndex = this->idleBlocks.size();
+      for(std::size_t index = 0; index < this->idleBlocks.size(); ++index) {
+        std::size_t blockCapacity = this->idleBlocks[index].Capacity;
+        bool fits = (
+          (blockCapacity >= requiredByteCount) && (blockCapacity / 2 <= requiredByteCount)
+        );
+        if(fits) {
+          if(
+            (bestIndex == this->idleBlocks.size()) ||
+            (blockCapacity < this->idleBlocks[bestIndex].Capacity)
+          ) {
+            bestIndex = index;
+          }
+        }
+      }
+
+      if(bestIndex < this->idleBlocks.size()) {
+        memory = this->idleBlocks[bestIndex].Memory;
+        capacity = this->idleBlocks[bestIndex].Capacity;
+        this->retainedByteCount -= capacity;
+
+        this->idleBlocks[bestIndex] = this->idleBlocks.back();
+        this->idleBlocks.pop_back();
+      }
+    }
+
+    if(memory == nullptr) {
+      memory = FrameBuffer::allocate(requiredByteCount);
+      capacity = requiredByteCount;
+    }
+
+    return std::shared_ptr<FrameBuffer>(
+      new FrameBuffer(width, height, format, layout, memory, capacity, shared_from_this())
+    );
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  QImage FrameBufferPool::Copy(const QImage &image) {
+    if(image.isNull() || !isPoolableFormat(image.format())) {
+      return image.copy();
+    }
+
+    std::shared_ptr<FrameBuffer> buffer = Acquire(
+      image.width(), image.height(), FrameBuffer::GetPixelFormat(image)
+    );
+
+    std::size_t rowLength = buffer->GetRowLength();
+    std::size_t lineCount = static_cast<std::size_t>(image.height());
+    for(std::size_t lineIndex = 0; lineIndex < lineCount; ++lineIndex) {
+      std::copy_n(
+        image.constScanLine(static_cast<int>(lineIndex)), rowLength, buffer->GetRow(lineIndex)
+      );
+    }
+
+    return FrameBuffer::ToImage(buffer);
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  void FrameBufferPool::Detach(QImage &image) {
+    if(!image.isNull() && !image.isDetached()) {
+      QImage copiedImage = Copy(image);
+      image.swap(copiedImage);
+    }
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  std::size_t FrameBufferPool::GetRetainedByteCount() const {
+    std::unique_lock<std::mutex> poolLock(this->mutex);
+    return this->retainedByteCount;
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  void FrameBufferPool::Trim() {
+    std::vector<IdleBlock> releasedBlocks;
+    {
+      std::unique_lock<std::mutex> poolLock(this->mutex);
+      releasedBlocks.swap(this->idleBlocks);
+      this->retainedByteCount = 0;
+    }
+
+    for(std::size_t index = 0; index < releasedBlocks.size(); ++index) {
+      FrameBuffer::deallocate(releasedBlocks[index].Memory);
+    }
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  void FrameBufferPool::recycle(std::uint8_t *memory, std::size_t capacity) {
+    {
+      std::unique_lock<std::mutex> poolLock(this->mutex);
+      if(this->retainedByteCount + capacity <= this->retainedByteLimit) {
+        this->idleBlocks.push_back(IdleBlock { memory, capacity });
+        this->retainedByteCount += capacity;
+        return;
+      }
+    }
+
+    FrameBuffer::deallocate(memory);
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+} // namespace Nuclex::FrameFixer::Rendering
@@ -0,0 +1,127 @@
+#pragma region Apache License 2.0
+/*
+Nuclex Frame Fixer
+Copyright (C) 2024 Markus Ewald / Nuclex Development Labs
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#pragma endregion // Apache License 2.0
+
+#ifndef NUCLEX_FRAMEFIXER_RENDERING_FRAMEBUFFERPOOL_H
+#define NUCLEX_FRAMEFIXER_RENDERING_FRAMEBUFFERPOOL_H
+
+#include "Nuclex/FrameFixer/Config.h"
+#include "./FrameBuffer.h"
+
+#include <cstddef> // for std::size_t
+#include <cstdint> // for std::uint8_t
+#include <memory> // for std::shared_ptr, std::enable_shared_from_this
+#include <mutex> // for std::mutex
+#include <vector> // for std::vector
+
+namespace Nuclex::FrameFixer::Rendering {
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Recycles the memory of frame buffers that are no longer in use</summary>
+  /// <remarks>
+  ///   <para>
+  ///     A frame of 16 bit video takes several megabytes. Allocating that much memory for
+  ///     each frame means fresh pages from the operating system that have to be faulted in
+  ///     and zeroed before the first pixel can be written. The pool keeps the memory of
+  ///     released frame buffers around and hands it out again for the next frame, which
+  ///     in a render almost always has the same size.
+  ///   </para>
+  ///   <para>
+  ///     Create instances through std::make_shared() since frame buffers keep their pool
+  ///     alive until they have been destroyed. All methods are thread-safe.
+  ///   </para>
+  /// </remarks>
+  class FrameBufferPool : public std::enable_shared_from_this<FrameBufferPool> {
+
+    /// <summary>Default number of bytes of unused memory the pool holds on to</summary>
+    public: static const std::size_t DefaultRetainedByteLimit;
+
+    /// <summary>Initializes a new frame buffer pool</summary>
+    /// <param name="retainedByteLimit">
+    ///   Number of bytes of unused memory the pool holds on to at most. Any memory returned
+    ///   to the pool beyond this is freed.
+    /// </param>
+    public: FrameBufferPool(std::size_t retainedByteLimit = DefaultRetainedByteLimit);
+    /// <summary>Frees all memory held by the pool</summary>
+    public: ~FrameBufferPool();
+
+    /// <summary>Provides a frame buffer, reusing memory from the pool if possible</summary>
+    /// <param name="width">Width of the frame in pixels</param>
+    /// <param name="height">Height of the frame in pixels</param>
+    /// <param name="format">Format in which the pixels will be stored</param>
+    /// <param name="layout">Whether the channels are interleaved or in separate planes</param>
+    /// <returns>A frame buffer whose pixels have undefined contents</returns>
+    public: std::shared_ptr<FrameBuffer> Acquire(
+      int width, int height,
+      FramePixelFormat format, FrameLayout layout = FrameLayout::Interleaved
+    );
+
+    /// <summary>Copies an image into memory from the pool</summary>
+    /// <param name="image">Image that will be copied</param>
+    /// <returns>A QImage with the same pixels that uses a pooled frame buffer</returns>
+    public: QImage Copy(const QImage &image);
+
+    /// <summary>Ensures that an image does not share its pixels with other images</summary>
+    /// <param name="image">Image that will be made exclusive</param>
+    /// <remarks>
+    ///   This does what Qt does when an implicitly shared image is written to, except
+    ///   that the copy is made in pooled memory rather than a fresh allocation.
+    /// </remarks>
+    public: void Detach(QImage &image);
+
+    /// <summary>Returns the number of bytes of unused memory the pool holds on to</summary>
+    /// <returns>The number of bytes of memory waiting to be reused</returns>
+    public: std::size_t GetRetainedByteCount() const;
+
+    /// <summary>Frees all unused memory the pool is holding on to</summary>
+    public: void Trim();
+
+    /// <summary>Takes back the memory of a frame buffer that has been destroyed</summary>
+    /// <param name="memory">Memory block the frame buffer was using</param>
+    /// <param name="capacity">Size of the memory block in bytes</param>
+    private: void recycle(std::uint8_t *memory, std::size_t capacity);
+
+    /// <summary>Block of memory waiting to be used by another frame buffer</summary>
+    private: struct IdleBlock {
+
+      /// <summary>Address of the memory block</summary>
+      public: std::uint8_t *Memory;
+      /// <summary>Size of the memory block in bytes</summary>
+      public: std::size_t Capacity;
+
+    };
+
+    /// <summary>Must be held while accessing the idle blocks</summary>
+    private: mutable std::mutex mutex;
+    /// <summary>Memory blocks that are waiting to be reused</summary>
+    private: std::vector<IdleBlock> idleBlocks;
+    /// <summary>Number of bytes of unused memory the pool holds on to at most</summary>
+    private: std::size_t retainedByteLimit;
+    /// <summary>Number of bytes in all idle memory blocks together</summary>
+    private: std::size_t retainedByteCount;
+
+    friend class FrameBuffer;
+
+  };
+
+  // ------------------------------------------------------------------------------------------- //
+
+} // namespace Nuclex::FrameFixer::Rendering
+
+#endif // NUCLEX_FRAMEFIXER_RENDERING_FRAMEBUFFERPOOL_H
@@ -0,0 +1,311 @@
+#pragma region Apache License 2.0
+/*
+Nuclex Frame Fixer
+Copyright (C) 2024 Markus Ewald / Nuclex Development Labs
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#pragma endregion // Apache License 2.0
+
+// If the application is compiled as a DLL, this ensures symbols are exported
+#define NUCLEX_FRAMEFIXER_SOURCE 1
+
+#include "./FrameLoader.h"
+#include "../Model/Movie.h"
+#include "../Services/FrameCache.h"
+#include "./RenderStatistics.h"
+#include "../Diagnostics/TraceRecorder.h"
+
+#include <algorithm> // for std::max(), std::min()
+
+namespace Nuclex::FrameFixer::Rendering {
+
+  // ------------------------------------------------------------------------------------------- //
+
+  FrameLoader::FrameLoader(
+    const std::shared_ptr<Movie> &movie,
+    const std::shared_ptr<Services::FrameCache> &frameCache /* = (
+      std::shared_ptr<Services::FrameCache>()
+    ) */
+  ) :
+    movie(movie),
+    frameCache(frameCache),
+    statistics(),
+    memoryBudget(),
+    readAheadMutex(),
+    positionConsumed(),
+    frameDecoded(),
+    loadOrder(),
+    readAheadDepth(0),
+    nextClaimedPosition(0),
+    nextConsumedPosition(0),
+    decodedFrames(),
+    stopping(false),
+    readAheadThreads(),
+    readAheadError() {}
+
+  // ------------------------------------------------------------------------------------------- //
+
+  FrameLoader::~FrameLoader() {
+    StopReadAhead();
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  void FrameLoader::SetStatistics(const std::shared_ptr<RenderStatistics> &statistics) {
+    this->statistics = statistics;
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  void FrameLoader::SetMemoryBudget(const std::shared_ptr<FrameMemoryBudget> &memoryBudget) {
+    this->memoryBudget = memoryBudget;
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  std::size_t FrameLoader::GetSourceFrameIndex(std::size_t frameIndex) const {
+    const Frame &frame = this->movie->Frames[frameIndex];
+    if(frame.LeftOrReplacementIndex.has_value()) {
+      return frame.LeftOrReplacementIndex.value();
+    } else {
+      return frameIndex;
+    }
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  void FrameLoader::StartReadAhead(
+    const std::vector<std::size_t> &loadOrder,
+    std::size_t depth,
+    std::size_t threadCount /* = 1 */
+  ) {
+    StopReadAhead();
+    if(loadOrder.empty() || (depth < 1)) {
+      return;
+    }
+
+    this->loadOrder = loadOrder;
+    this->readAheadDepth = depth;
+    this->nextClaimedPosition = 0;
+    this->nextConsumedPosition.store(0);
+    this->stopping.store(false);
+    this->readAheadError = std::exception_ptr();
+
+    // More threads than images that can be decoded ahead would only sit around
+    threadCount = std::min(std::max<std::size_t>(threadCount, 1), depth);
+    this->readAheadThreads.reserve(threadCount);
+    for(std::size_t index = 0; index < threadCount; ++index) {
+      this->readAheadThreads.emplace_back(&FrameLoader::readAheadInBackground, this);
+    }
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  void FrameLoader::StopReadAhead() {
+    {
+      std::unique_lock<std::mutex> readAheadLock(this->readAheadMutex);
+      this->stopping.store(true);
+    }
+    this->positionConsumed.notify_all();
+
+    // I/O threads might be waiting for the memory budget, let them see that we're stopping
+    if(static_cast<bool>(this->memoryBudget)) {
+      this->memoryBudget->WakeWaitingStages();
+    }
+
+    for(std::size_t index = 0; index < this->readAheadThreads.size(); ++index) {
+      this->readAheadThreads[index].join();
+    }
+    this->readAheadThreads.clear();
+
+    this->decodedFrames.clear();
+    this->loadOrder.clear();
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  QImage FrameLoader::Load(std::size_t frameIndex) {
+    return LoadSource(GetSourceFrameIndex(frameIndex));
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  QImage FrameLoader::LoadSource(std::size_t sourceFrameIndex) {
+    std::map<std::size_t, DecodedFrame> skippedFrames;
+    std::size_t position;
+    {
+      std::unique_lock<std::mutex> readAheadLock(this->readAheadMutex);
+
+      // Look for the requested image in the read-ahead window. If the renderer asks
+      // for an image we did not predict, load it directly and leave the window as it is.
+      std::size_t startPosition = this->nextConsumedPosition.load();
+      std::size_t endPosition = std::min(
+        this->loadOrder.size(), startPosition + this->readAheadDepth
+      );
+      position = startPosition;
+      while((position < endPosition) && (this->loadOrder[position] != sourceFrameIndex)) {
+        ++position;
+      }
+      if(position >= endPosition) {
+        readAheadLock.unlock();
+        return loadImmediately(sourceFrameIndex);
+      }
+
+      // Images the renderer skipped will not be requested anymore. Move them out so
+      // their memory can be returned to the budget once we no longer hold the lock.
+      std::map<std::size_t, DecodedFrame>::iterator firstKept = (
+        this->decodedFrames.lower_bound(position)
+      );
+      skippedFrames.insert(
+        std::make_move_iterator(this->decodedFrames.begin()), std::make_move_iterator(firstKept)
+      );
+      this->decodedFrames.erase(this->decodedFrames.begin(), firstKept);
+
+      this->nextConsumedPosition.store(position);
+    }
+    this->positionConsumed.notify_all();
+
+    // The I/O thread decoding the requested image may be waiting for the memory budget,
+    // which it is allowed to exceed now that the renderer is waiting for its image.
+    skippedFrames.clear();
+    if(static_cast<bool>(this->memoryBudget)) {
+      this->memoryBudget->WakeWaitingStages();
+    }
+
+    // Wait for the image to be decoded. Once the image leaves the loader, its memory
+    // is no longer the read-ahead's responsibility. Stages keeping it around have to
+    // reserve it themselves.
+    DecodedFrame decodedFrame;
+    {
+      std::unique_lock<std::mutex> readAheadLock(this->readAheadMutex);
+      {
+        NUCLEX_FRAMEFIXER_TRACE_SCOPE(u8"render", u8"Wait for read-ahead");
+        this->frameDecoded.wait(
+          readAheadLock,
+          [&]() {
+            return (
+              (this->decodedFrames.find(position) != this->decodedFrames.end()) ||
+              static_cast<bool>(this->readAheadError)
+            );
+          }
+        );
+      }
+
+      std::map<std::size_t, DecodedFrame>::iterator iterator = (
+        this->decodedFrames.find(position)
+      );
+      if(iterator == this->decodedFrames.end()) {
+        std::rethrow_exception(this->readAheadError);
+      }
+
+      decodedFrame = std::move(iterator->second);
+      this->decodedFrames.erase(iterator);
+      this->nextConsumedPosition.store(position + 1);
+    }
+    this->positionConsumed.notify_all();
+
+    QImage image;
+    image.swap(decodedFrame.Image);
+    return image;
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  QImage FrameLoader::loadImmediately(std::size_t sourceFrameIndex) const {
+    RenderStatistics::ScopedTimer decodeTimer(this->statistics.get(), RenderStage::Decode);
+    if(static_cast<bool>(this->frameCache)) {
+      return this->frameCache->GetFrame(*this->movie, sourceFrameIndex);
+    }
+
+    if(static_cast<bool>(this->statistics)) {
+      this->statistics->AddBytesRead(this->movie->GetEncodedFrameSize(sourceFrameIndex));
+    }
+    return this->movie->LoadFrame(sourceFrameIndex);
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  void FrameLoader::readAheadInBackground() {
+    Diagnostics::TraceRecorder::NameCurrentThread(u8"Frame read-ahead");
+    try {
+      for(;;) {
+
+        // Claim the next position in the load order, but stay within the read-ahead
+        // window. If the renderer has jumped ahead, continue from where it is.
+        std::size_t position;
+        {
+          std::unique_lock<std::mutex> readAheadLock(this->readAheadMutex);
+          this->positionConsumed.wait(
+            readAheadLock,
+            [this]() {
+              std::size_t nextPosition = std::max(
+                this->nextClaimedPosition, this->nextConsumedPosition.load()
+              );
+              return (
+                this->stopping.load() ||
+                (nextPosition >= this->loadOrder.size()) ||
+                (nextPosition < this->nextConsumedPosition.load() + this->readAheadDepth)
+              );
+            }
+          );
+
+          position = std::max(this->nextClaimedPosition, this->nextConsumedPosition.load());
+          if(this->stopping.load() || (position >= this->loadOrder.size())) {
+            break;
+          }
+          this->nextClaimedPosition = position + 1;
+        }
+
+        DecodedFrame decodedFrame;
+        decodedFrame.Image = loadImmediately(this->loadOrder[position]);
+
+        // Wait for the renderer to catch up if the frames in flight exhaust the budget,
+        // unless the renderer is waiting for exactly this image
+        if(static_cast<bool>(this->memoryBudget)) {
+          NUCLEX_FRAMEFIXER_TRACE_SCOPE(u8"render", u8"Wait for memory budget");
+          decodedFrame.MemoryReservation = this->memoryBudget->Acquire(
+            static_cast<std::size_t>(decodedFrame.Image.sizeInBytes()),
+            [this, position]() {
+              return this->stopping.load() || (position <= this->nextConsumedPosition.load());
+            }
+          );
+        }
+
+        // If the renderer skipped the image while we were decoding it, drop it. This
+        // happens after the lock is released, since it returns the image's reservation.
+        {
+          std::unique_lock<std::mutex> readAheadLock(this->readAheadMutex);
+          if(this->stopping.load() || (position < this->nextConsumedPosition.load())) {
+            continue;
+          }
+
+          this->decodedFrames.emplace(position, std::move(decodedFrame));
+        }
+        this->frameDecoded.notify_all();
+      }
+    }
+    catch(...) {
+      {
+        std::unique_lock<std::mutex> readAheadLock(this->readAheadMutex);
+        if(!static_cast<bool>(this->readAheadError)) {
+          this->readAheadError = std::current_exception();
+        }
+      }
+      this->frameDecoded.notify_all();
+    }
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+} // namespace Nuclex::FrameFixer::Rendering
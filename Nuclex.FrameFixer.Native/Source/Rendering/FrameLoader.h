@@ -0,0 +1,215 @@
+#pragma region Apache License 2.0
+/*
+Nuclex Frame Fixer
+Copyright (C) 2024 Markus Ewald / Nuclex Development Labs
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#pragma endregion // Apache License 2.0
+
+#ifndef NUCLEX_FRAMEFIXER_RENDERING_FRAMELOADER_H
+#define NUCLEX_FRAMEFIXER_RENDERING_FRAMELOADER_H
+
+#include "Nuclex/FrameFixer/Config.h"
+#include "./FrameMemoryBudget.h"
+
+#include <memory> // for std::shared_ptr
+#include <cstddef> // for std::size_t
+#include <vector> // for std::vector
+#include <map> // for std::map
+#include <thread> // for std::thread
+#include <mutex> // for std::mutex
+#include <condition_variable> // for std::condition_variable
+#include <atomic> // for std::atomic
+#include <exception> // for std::exception_ptr
+
+#include <QImage>
+
+namespace Nuclex::FrameFixer {
+
+  // ------------------------------------------------------------------------------------------- //
+
+  class Movie;
+
+  // ------------------------------------------------------------------------------------------- //
+
+}
+
+namespace Nuclex::FrameFixer::Services {
+
+  // ------------------------------------------------------------------------------------------- //
+
+  class FrameCache;
+
+  // ------------------------------------------------------------------------------------------- //
+
+}
+
+namespace Nuclex::FrameFixer::Rendering {
+
+  // ------------------------------------------------------------------------------------------- //
+
+  class RenderStatistics;
+
+  // ------------------------------------------------------------------------------------------- //
+
+}
+
+namespace Nuclex::FrameFixer::Rendering {
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Loads the source images of a movie's frames, optionally reading ahead</summary>
+  /// <remarks>
+  ///   <para>
+  ///     This is the decode stage of the render pipeline. Without read-ahead, it simply
+  ///     loads the image for a frame when it is requested. With read-ahead started, it is
+  ///     given the order in which the renderer will request source images (including
+  ///     replacement frames, the frames of averaging runs and interpolation sources)
+  ///     and one or more I/O threads decode the images a number of steps ahead, so
+  ///     storage latency and decoding overlap with the processing of the current frame.
+  ///   </para>
+  ///   <para>
+  ///     Requests are matched against the load order from front to back. A request that
+  ///     is found in the read-ahead window skips any images before it, a request that is
+  ///     not found (because the renderer deviated from the predicted order) is loaded on
+  ///     the spot and does not advance the window.
+  ///   </para>
+  /// </remarks>
+  class FrameLoader {
+
+    /// <summary>Initializes a new frame loader for the specified movie</summary>
+    /// <param name="movie">Movie whose frames the loader will provide</param>
+    /// <param name="frameCache">
+    ///   Cache through which frames will be loaded. If empty, frames are loaded from disk.
+    /// </param>
+    public: FrameLoader(
+      const std::shared_ptr<Movie> &movie,
+      const std::shared_ptr<Services::FrameCache> &frameCache = (
+        std::shared_ptr<Services::FrameCache>()
+      )
+    );
+    /// <summary>Stops reading ahead and frees all resources used by the loader</summary>
+    public: ~FrameLoader();
+
+    /// <summary>Selects the statistics the time spent decoding frames goes into</summary>
+    /// <param name="statistics">Statistics that will be updated as frames are loaded</param>
+    /// <remarks>
+    ///   When no frame cache is used, the size of each loaded file is also recorded as
+    ///   bytes read. With a frame cache, only the cache knows which frames came from disk.
+    /// </remarks>
+    public: void SetStatistics(const std::shared_ptr<RenderStatistics> &statistics);
+
+    /// <summary>Selects the budget that frames read ahead are counted against</summary>
+    /// <param name="memoryBudget">Budget the frames read ahead have to stay within</param>
+    /// <remarks>
+    ///   When the budget is exhausted, the I/O threads wait until the renderer has taken
+    ///   frames from the loader (or other stages have released theirs). They only exceed
+    ///   the budget for the image the renderer is going to request next.
+    /// </remarks>
+    public: void SetMemoryBudget(const std::shared_ptr<FrameMemoryBudget> &memoryBudget);
+
+    /// <summary>Looks up the frame whose image will be used for a frame</summary>
+    /// <param name="frameIndex">Index of the frame that will be looked up</param>
+    /// <returns>The index of the replacement frame or the frame itself</returns>
+    public: std::size_t GetSourceFrameIndex(std::size_t frameIndex) const;
+
+    /// <summary>Begins decoding frames in the background</summary>
+    /// <param name="loadOrder">
+    ///   Indices of the frames whose images will be requested, in the order in which they
+    ///   will be requested, with replacement frames already resolved
+    /// </param>
+    /// <param name="depth">Number of images that will be decoded ahead</param>
+    /// <param name="threadCount">Number of threads that will decode images</param>
+    public: void StartReadAhead(
+      const std::vector<std::size_t> &loadOrder, std::size_t depth, std::size_t threadCount = 1
+    );
+
+    /// <summary>Stops the background decoding threads and drops any decoded frames</summary>
+    public: void StopReadAhead();
+
+    /// <summary>Provides the source image that should be used for a frame</summary>
+    /// <param name="frameIndex">Index of the frame whose image will be provided</param>
+    /// <returns>The image for the specified frame</returns>
+    /// <remarks>
+    ///   If a frame has been marked to be replaced by another frame, the image of
+    ///   the replacement frame will be returned.
+    /// </remarks>
+    public: QImage Load(std::size_t frameIndex);
+
+    /// <summary>Provides the image stored for a frame, ignoring replacements</summary>
+    /// <param name="sourceFrameIndex">Index of the frame whose image will be provided</param>
+    /// <returns>The image stored for the specified frame</returns>
+    public: QImage LoadSource(std::size_t sourceFrameIndex);
+
+    /// <summary>Loads the image of a frame, bypassing the read-ahead</summary>
+    /// <param name="sourceFrameIndex">Index of the frame whose image will be loaded</param>
+    /// <returns>The image stored for the specified frame</returns>
+    private: QImage loadImmediately(std::size_t sourceFrameIndex) const;
+
+    /// <summary>Called in the I/O threads to decode frames ahead of time</summary>
+    private: void readAheadInBackground();
+
+    /// <summary>A decoded frame waiting to be handed to the renderer</summary>
+    private: struct DecodedFrame {
+
+      /// <summary>Image that has been decoded for the frame</summary>
+      public: QImage Image;
+      /// <summary>Memory reserved for the image while it waits in the loader</summary>
+      public: FrameMemoryBudget::Reservation MemoryReservation;
+
+    };
+
+    /// <summary>Movie whose frames are being loaded</summary>
+    private: std::shared_ptr<Movie> movie;
+    /// <summary>Cache through which frames are loaded, can be empty</summary>
+    private: std::shared_ptr<Services::FrameCache> frameCache;
+    /// <summary>Statistics in which decode times are recorded, can be empty</summary>
+    private: std::shared_ptr<RenderStatistics> statistics;
+    /// <summary>Budget frames read ahead are counted against, can be empty</summary>
+    private: std::shared_ptr<FrameMemoryBudget> memoryBudget;
+
+    /// <summary>Must be held while accessing the read-ahead state</summary>
+    private: std::mutex readAheadMutex;
+    /// <summary>Signalled when the renderer advances through the load order</summary>
+    private: std::condition_variable positionConsumed;
+    /// <summary>Signalled when an I/O thread has decoded a frame or failed</summary>
+    private: std::condition_variable frameDecoded;
+    /// <summary>Source frame indices in the order the renderer will request them</summary>
+    private: std::vector<std::size_t> loadOrder;
+    /// <summary>Number of images the I/O threads may decode ahead of the renderer</summary>
+    private: std::size_t readAheadDepth;
+    /// <summary>Position in the load order the next I/O thread will decode</summary>
+    private: std::size_t nextClaimedPosition;
+    /// <summary>Position in the load order the renderer will request next</summary>
+    /// <remarks>
+    ///   Atomic because the I/O threads check it from within the memory budget's
+    ///   callback, where they must not take the read-ahead mutex.
+    /// </remarks>
+    private: std::atomic<std::size_t> nextConsumedPosition;
+    /// <summary>Decoded frames waiting to be requested by their position</summary>
+    private: std::map<std::size_t, DecodedFrame> decodedFrames;
+    /// <summary>Set to make the I/O threads stop</summary>
+    private: std::atomic<bool> stopping;
+    /// <summary>Threads decoding frames in the background</summary>
+    private: std::vector<std::thread> readAheadThreads;
+    /// <summary>Error that caused an I/O thread to stop, if any</summary>
+    private: std::exception_ptr readAheadError;
+
+  };
+
+  // ------------------------------------------------------------------------------------------- //
+
+} // namespace Nuclex::FrameFixer::Rendering
+
+#endif // NUCLEX_FRAMEFIXER_RENDERING_FRAMELOADER_H
@@ -0,0 +1,214 @@
+#pragma region Apache License 2.0
+/*
+Nuclex Frame Fixer
+Copyright (C) 2024 Markus Ewald / Nuclex Development Labs
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#pragma endregion // Apache License 2.0
+
+
+// If the application is compiled as a DLL, this ensures symbols are exported
+#define NUCLEX_FRAMEFIXER_SOURCE 1
+
+#include "./FrameMemoryBudget.h"
+
+#include <algorithm> // for std::max()
+
+namespace Nuclex::FrameFixer::Rendering {
+
+  // ------------------------------------------------------------------------------------------- //
+
+  FrameMemoryBudget::Reservation::Reservation() :
+    budget(),
+    byteCount(0) {}
+
+  // ------------------------------------------------------------------------------------------- //
+
+  FrameMemoryBudget::Reservation::Reservation(Reservation &&other) :
+    budget(std::move(other.budget)),
+    byteCount(other.byteCount) {
+    other.byteCount = 0;
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  FrameMemoryBudget::Reservation::~Reservation() {
+    Release();
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  FrameMemoryBudget::Reservation &FrameMemoryBudget::Reservation::operator =(
+    Reservation &&other
+  ) {
+    if(&other != this) {
+      Release();
+
+      this->budget = std::move(other.budget);
+      this->byteCount = other.byteCount;
+      other.byteCount = 0;
+    }
+
+    return *this;
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  void FrameMemoryBudget::Reservation::Release() {
+    if(static_cast<bool>(this->budget)) {
+      this->budget->release(this->byteCount);
+      this->budget.reset();
+    }
+
+    this->byteCount = 0;
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  FrameMemoryBudget::FrameMemoryBudget(std::size_t limitInBytes /* = 0 */) :
+    mutex(),
+    bytesReleased(),
+    limitInBytes(limitInBytes),
+    usedBytes(0),
+    peakBytes(0) {}
+
+  // ------------------------------------------------------------------------------------------- //
+
+  FrameMemoryBudget::~FrameMemoryBudget() {}
+
+  // ------------------------------------------------------------------------------------------- //
+
+  void FrameMemoryBudget::SetLimit(std::size_t limitInBytes) {
+    {
+      std::unique_lock<std::mutex> budgetLock(this->mutex);
+      this->limitInBytes = limitInBytes;
+    }
+
+    // If the budget was raised, waiting stages may be able to continue
+    this->bytesReleased.notify_all();
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  std::size_t FrameMemoryBudget::GetLimit() const {
+    std::unique_lock<std::mutex> budgetLock(this->mutex);
+    return this->limitInBytes;
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  std::size_t FrameMemoryBudget::GetCurrentUsage() const {
+    std::unique_lock<std::mutex> budgetLock(this->mutex);
+    return this->usedBytes;
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  std::size_t FrameMemoryBudget::GetPeakUsage() const {
+    std::unique_lock<std::mutex> budgetLock(this->mutex);
+    return this->peakBytes;
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  void FrameMemoryBudget::ResetPeakUsage() {
+    std::unique_lock<std::mutex> budgetLock(this->mutex);
+    this->peakBytes = this->usedBytes;
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  FrameMemoryBudget::Reservation FrameMemoryBudget::Acquire(
+    std::size_t byteCount, const std::function<bool()> &mayExceedBudget
+  ) {
+    std::unique_lock<std::mutex> budgetLock(this->mutex);
+    this->bytesReleased.wait(
+      budgetLock, [&]() { return fits(byteCount) || mayExceedBudget(); }
+    );
+
+    return reserve(byteCount);
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  bool FrameMemoryBudget::TryAcquire(std::size_t byteCount, Reservation &reservation) {
+    std::unique_lock<std::mutex> budgetLock(this->mutex);
+    if(!fits(byteCount)) {
+      return false;
+    }
+
+    // Releasing the old reservation would need the mutex we're holding
+    Reservation newReservation = reserve(byteCount);
+    budgetLock.unlock();
+
+    reservation = std::move(newReservation);
+    return true;
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  FrameMemoryBudget::Reservation FrameMemoryBudget::Claim(std::size_t byteCount) {
+    std::unique_lock<std::mutex> budgetLock(this->mutex);
+    return reserve(byteCount);
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  void FrameMemoryBudget::WakeWaitingStages() {
+
+    // Taking the mutex ensures that a stage which just found its callback returning
+    // false is already waiting on the condition variable and will be woken up
+    {
+      std::unique_lock<std::mutex> budgetLock(this->mutex);
+    }
+
+    this->bytesReleased.notify_all();
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  bool FrameMemoryBudget::fits(std::size_t byteCount) const {
+    if((this->limitInBytes == 0) || (this->usedBytes == 0)) {
+      return true;
+    }
+
+    return (byteCount <= this->limitInBytes) && (this->usedBytes <= this->limitInBytes - byteCount);
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  FrameMemoryBudget::Reservation FrameMemoryBudget::reserve(std::size_t byteCount) {
+    this->usedBytes += byteCount;
+    this->peakBytes = std::max(this->peakBytes, this->usedBytes);
+
+    Reservation reservation;
+    reservation.budget = shared_from_this();
+    reservation.byteCount = byteCount;
+    return reservation;
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  void FrameMemoryBudget::release(std::size_t byteCount) {
+    {
+      std::unique_lock<std::mutex> budgetLock(this->mutex);
+      this->usedBytes -= byteCount;
+    }
+
+    this->bytesReleased.notify_all();
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+} // namespace Nuclex::FrameFixer::Rendering
@@ -0,0 +1,194 @@
+#pragma region Apache License 2.0
+/*
+Nuclex Frame Fixer
+Copyright (C) 2024 Markus Ewald / Nuclex Development Labs
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#pragma endregion // Apache License 2.0
+
+
+#ifndef NUCLEX_FRAMEFIXER_RENDERING_FRAMEMEMORYBUDGET_H
+#define NUCLEX_FRAMEFIXER_RENDERING_FRAMEMEMORYBUDGET_H
+
+#include "Nuclex/FrameFixer/Config.h"
+
+#include <condition_variable> // for std::condition_variable
+#include <cstddef> // for std::size_t
+#include <functional> // for std::function
+#include <memory> // for std::shared_ptr, std::enable_shared_from_this
+#include <mutex> // for std::mutex
+
+namespace Nuclex::FrameFixer::Rendering {
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Limits the number of bytes all frames in flight may occupy together</summary>
+  /// <remarks>
+  ///   <para>
+  ///     The stages of the render pipeline (read-ahead, averaging runs, write-behind and
+  ///     the frame cache) reserve the size of each frame they hold on to and release it
+  ///     when they let go of the frame. Stages that merely run ahead of the others block
+  ///     when the budget is exhausted, stages that have to make progress spill instead
+  ///     (the frame cache evicts) or claim the little memory they need regardless.
+  ///   </para>
+  ///   <para>
+  ///     To rule out deadlocks, a blocking stage may exceed the budget if waiting would
+  ///     leave the next stage with nothing to work on. The budget is therefore a soft limit
+  ///     that can be overshot by the few frames each thread is working on at any moment.
+  ///     Frames shared between stages (a cached frame that is also waiting in the read-ahead
+  ///     queue, for example) are counted by each stage, so the budget errs on the safe side.
+  ///   </para>
+  ///   <para>
+  ///     Create instances through std::make_shared() since reservations keep the budget
+  ///     alive until they have been released. All methods are thread-safe.
+  ///   </para>
+  /// </remarks>
+  class FrameMemoryBudget : public std::enable_shared_from_this<FrameMemoryBudget> {
+
+    /// <summary>Bytes reserved from a budget, released when the reservation is destroyed</summary>
+    public: class Reservation {
+
+      /// <summary>Initializes an empty reservation</summary>
+      public: Reservation();
+      /// <summary>Takes over the bytes of another reservation</summary>
+      /// <param name="other">Reservation whose bytes will be taken over</param>
+      public: Reservation(Reservation &&other);
+      /// <summary>Releases the reserved bytes</summary>
+      public: ~Reservation();
+
+      /// <summary>Releases the reserved bytes and takes over another reservation</summary>
+      /// <param name="other">Reservation whose bytes will be taken over</param>
+      /// <returns>This reservation</returns>
+      public: Reservation &operator =(Reservation &&other);
+
+      /// <summary>Returns the number of bytes held by the reservation</summary>
+      /// <returns>The number of reserved bytes</returns>
+      public: std::size_t GetByteCount() const { return this->byteCount; }
+
+      /// <summary>Returns the reserved bytes to the budget</summary>
+      public: void Release();
+
+      /// <summary>Budget the bytes are reserved from</summary>
+      private: std::shared_ptr<FrameMemoryBudget> budget;
+      /// <summary>Number of bytes that have been reserved</summary>
+      private: std::size_t byteCount;
+
+      /// <summary>Only the budget itself can hand out reservations</summary>
+      friend class FrameMemoryBudget;
+
+    };
+
+    /// <summary>Initializes a new frame memory budget</summary>
+    /// <param name="limitInBytes">Number of bytes frames may occupy, 0 for no limit</param>
+    public: FrameMemoryBudget(std::size_t limitInBytes = 0);
+    /// <summary>Frees all resources owned by the budget</summary>
+    public: ~FrameMemoryBudget();
+
+    /// <summary>Changes the number of bytes frames may occupy together</summary>
+    /// <param name="limitInBytes">Number of bytes frames may occupy, 0 for no limit</param>
+    public: void SetLimit(std::size_t limitInBytes);
+
+    /// <summary>Returns the number of bytes frames may occupy together</summary>
+    /// <returns>The budget in bytes, 0 if memory use is not limited</returns>
+    public: std::size_t GetLimit() const;
+
+    /// <summary>Returns the number of bytes currently reserved</summary>
+    /// <returns>The number of bytes occupied by frames right now</returns>
+    public: std::size_t GetCurrentUsage() const;
+
+    /// <summary>Returns the highest number of bytes that were reserved at once</summary>
+    /// <returns>The peak number of bytes occupied by frames</returns>
+    public: std::size_t GetPeakUsage() const;
+
+    /// <summary>Lets the peak usage begin counting from the current usage again</summary>
+    public: void ResetPeakUsage();
+
+    /// <summary>Reserves bytes, waiting until they fit into the budget</summary>
+    /// <param name="byteCount">Number of bytes that will be reserved</param>
+    /// <param name="mayExceedBudget">
+    ///   Checked while waiting, if it returns true, the bytes are reserved even though
+    ///   they exceed the budget. Should return true if the caller's consumer has run out
+    ///   of work, otherwise the pipeline could deadlock.
+    /// </param>
+    /// <returns>The reservation holding the requested bytes</returns>
+    /// <remarks>
+    ///   The callback is invoked while the budget's mutex is held, so it must not
+    ///   release reservations or do anything else that accesses the budget.
+    /// </remarks>
+    public: Reservation Acquire(
+      std::size_t byteCount, const std::function<bool()> &mayExceedBudget
+    );
+
+    /// <summary>Reserves bytes only if they fit into the budget right now</summary>
+    /// <param name="byteCount">Number of bytes that will be reserved</param>
+    /// <param name="reservation">Receives the reservation if the bytes fit</param>
+    /// <returns>True if the bytes were reserved, false if they would exceed the budget</returns>
+    public: bool TryAcquire(std::size_t byteCount, Reservation &reservation);
+
+    /// <summary>Reserves bytes even if they exceed the budget</summary>
+    /// <param name="byteCount">Number of bytes that will be reserved</param>
+    /// <returns>The reservation holding the requested bytes</returns>
+    /// <remarks>
+    ///   Meant for frames a stage can neither do without nor spill, so that the usage
+    ///   (and its peak) still reflects them.
+    /// </remarks>
+    public: Reservation Claim(std::size_t byteCount);
+
+    /// <summary>Lets stages waiting for memory check their callbacks again</summary>
+    /// <remarks>
+    ///   Waiting stages are woken up when bytes are released. If a stage's consumer runs
+    ///   out of work without any bytes being released, this has to be called, otherwise
+    ///   the stage would not notice that it may exceed the budget.
+    /// </remarks>
+    public: void WakeWaitingStages();
+
+    /// <summary>Checks whether the requested bytes fit into the budget</summary>
+    /// <param name="byteCount">Number of bytes that would be reserved</param>
+    /// <returns>True if the bytes would fit into the budget</returns>
+    /// <remarks>
+    ///   Must be called with the mutex held. If nothing is reserved, anything fits
+    ///   so that frames larger than the budget can still be processed one at a time.
+    /// </remarks>
+    private: bool fits(std::size_t byteCount) const;
+
+    /// <summary>Adds bytes to the usage and wraps them in a reservation</summary>
+    /// <param name="byteCount">Number of bytes that will be reserved</param>
+    /// <returns>The reservation holding the requested bytes</returns>
+    /// <remarks>
+    ///   Must be called with the mutex held.
+    /// </remarks>
+    private: Reservation reserve(std::size_t byteCount);
+
+    /// <summary>Returns bytes held by a reservation to the budget</summary>
+    /// <param name="byteCount">Number of bytes that will be returned</param>
+    private: void release(std::size_t byteCount);
+
+    /// <summary>Must be held while accessing the usage counters</summary>
+    private: mutable std::mutex mutex;
+    /// <summary>Signalled whenever reserved bytes are released</summary>
+    private: std::condition_variable bytesReleased;
+    /// <summary>Number of bytes frames may occupy, 0 for no limit</summary>
+    private: std::size_t limitInBytes;
+    /// <summary>Number of bytes currently reserved</summary>
+    private: std::size_t usedBytes;
+    /// <summary>Highest number of bytes that were reserved at once</summary>
+    private: std::size_t peakBytes;
+
+  };
+
+  // ------------------------------------------------------------------------------------------- //
+
+} // namespace Nuclex::FrameFixer::Rendering
+
+#endif // NUCLEX_FRAMEFIXER_RENDERING_FRAMEMEMORYBUDGET_H
@@ -0,0 +1,284 @@
+#pragma region Apache License 2.0
+/*
+Nuclex Frame Fixer
+Copyright (C) 2024 Markus Ewald / Nuclex Development Labs
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#pragma endregion // Apache License 2.0
+
+// If the application is compiled as a DLL, this ensures symbols are exported
+#define NUCLEX_FRAMEFIXER_SOURCE 1
+
+#include "./FrameStreamer.h"
+#include "./PixelConversion.h"
+
+#include <Nuclex/Support/Text/LexicalAppend.h> // for lexical_append()
+
+#include <stdexcept> // for std::runtime_error
+
+#if defined(NUCLEX_FRAMEFIXER_WINDOWS)
+  #include <io.h> // for ::_setmode(), ::_fileno()
+  #include <fcntl.h> // for _O_BINARY
+#else
+  #include <csignal> // for ::signal()
+  #include <sys/wait.h> // for WIFEXITED(), WEXITSTATUS()
+#endif
+
+namespace {
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Size of the buffer used for the stream</summary>
+  /// <remarks>
+  ///   Pipes on Linux only hold 64 KiB, so a larger buffer reduces the number of times
+  ///   we wait for the consumer when writing a frame of several megabytes.
+  /// </remarks>
+  const std::size_t StreamBufferSize = 1048576; // 1 MiB
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Returns the image itself or a copy in the 16 bit RGBA format</summary>
+  /// <param name="image">Image that will be returned in the 16 bit RGBA format</param>
+  /// <returns>An image with four 16 bit channels per pixel</returns>
+  QImage toRgba64(const QImage &image) {
+    QImage::Format format = image.format();
+    if((format == QImage::Format_RGBA64) || (format == QImage::Format_RGBX64)) {
+      return image; // Implicitly shared, no pixels are copied
+    } else {
+      return image.convertToFormat(QImage::Format_RGBA64);
+    }
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+}
+
+namespace Nuclex::FrameFixer::Rendering {
+
+  // ------------------------------------------------------------------------------------------- //
+
+  FrameStreamer::FrameStreamer(const StreamSettings &settings) :
+    settings(settings),
+    stream(nullptr),
+    isChildProcessPipe(false),
+    frameWidth(0),
+    frameHeight(0),
+    conversionBuffer() {}
+
+  // ------------------------------------------------------------------------------------------- //
+
+  FrameStreamer::~FrameStreamer() {
+    close();
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  void FrameStreamer::Write(const QImage &image) {
+    QImage rgbaImage = toRgba64(image);
+
+    if(this->stream == nullptr) {
+      this->frameWidth = rgbaImage.width();
+      this->frameHeight = rgbaImage.height();
+
+      open();
+      if(this->settings.Format == StreamFormat::Y4m) {
+        writeY4mHeader();
+      }
+    } else {
+      bool dimensionsMatch = (
+        (rgbaImage.width() == this->frameWidth) &&
+        (rgbaImage.height() == this->frameHeight)
+      );
+      if(!dimensionsMatch) {
+        throw std::runtime_error(u8"All frames sent into a stream must have the same size");
+      }
+    }
+
+    std::size_t width = static_cast<std::size_t>(this->frameWidth);
+    std::size_t height = static_cast<std::size_t>(this->frameHeight);
+
+    switch(this->settings.Format) {
+
+      // RGBA64 is exactly the layout of the QImage, so the lines can be written directly
+      case StreamFormat::Rgba64: {
+        for(std::size_t lineIndex = 0; lineIndex < height; ++lineIndex) {
+          writeBytes(rgbaImage.constScanLine(static_cast<int>(lineIndex)), width * 8);
+        }
+        break;
+      }
+
+      // For RGB48, the alpha channel is dropped one line at a time
+      case StreamFormat::Rgb48: {
+        this->conversionBuffer.resize(width * 3);
+        for(std::size_t lineIndex = 0; lineIndex < height; ++lineIndex) {
+          PixelConversion::Rgba64ToRgb48(
+            reinterpret_cast<const std::uint16_t *>(
+              rgbaImage.constScanLine(static_cast<int>(lineIndex))
+            ),
+            this->conversionBuffer.data(),
+            width
+          );
+          writeBytes(this->conversionBuffer.data(), width * 6);
+        }
+        break;
+      }
+
+      // Y4M frames are planar, so the whole frame has to be converted before
+      // it can be written, starting with the luma plane
+      case StreamFormat::Y4m: {
+        std::size_t planeSize = width * height;
+        this->conversionBuffer.resize(planeSize * 3);
+
+        std::uint16_t *luma = this->conversionBuffer.data();
+        std::uint16_t *blueDifference = luma + planeSize;
+        std::uint16_t *redDifference = blueDifference + planeSize;
+        for(std::size_t lineIndex = 0; lineIndex < height; ++lineIndex) {
+          PixelConversion::Rgba64ToYuv444p16(
+            reinterpret_cast<const std::uint16_t *>(
+              rgbaImage.constScanLine(static_cast<int>(lineIndex))
+            ),
+            luma, blueDifference, redDifference,
+            width
+          );
+          luma += width;
+          blueDifference += width;
+          redDifference += width;
+        }
+
+        writeBytes(u8"FRAME\n", 6);
+        writeBytes(this->conversionBuffer.data(), planeSize * 6);
+        break;
+      }
+
+    }
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  void FrameStreamer::Finish() {
+    if(this->stream == nullptr) {
+      return; // No frames were written, so the stream was never opened
+    }
+
+    int exitCode = close();
+    if(exitCode != 0) {
+      std::string message(u8"Process consuming the frame stream exited with code ", 52);
+      Nuclex::Support::Text::lexical_append(message, exitCode);
+      throw std::runtime_error(message);
+    }
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  void FrameStreamer::open() {
+    switch(this->settings.Target) {
+      case StreamTarget::StandardOutput: {
+#if defined(NUCLEX_FRAMEFIXER_WINDOWS)
+        ::_setmode(::_fileno(stdout), _O_BINARY); // Don't turn \n bytes into \r\n
+#endif
+        this->stream = stdout;
+        break;
+      }
+      case StreamTarget::File: {
+        this->stream = std::fopen(this->settings.Destination.c_str(), u8"wb");
+        break;
+      }
+      case StreamTarget::ChildProcess: {
+#if defined(NUCLEX_FRAMEFIXER_WINDOWS)
+        this->stream = ::_popen(this->settings.Destination.c_str(), u8"wb");
+#else
+        this->stream = ::popen(this->settings.Destination.c_str(), u8"w");
+#endif
+        this->isChildProcessPipe = true;
+        break;
+      }
+    }
+    if(this->stream == nullptr) {
+      std::string message(u8"Could not open frame stream to '", 32);
+      message.append(this->settings.Destination);
+      message.append(u8"'", 1);
+      throw std::runtime_error(message);
+    }
+
+#if !defined(NUCLEX_FRAMEFIXER_WINDOWS)
+    // If the consumer exits early, writing into the pipe would kill us with SIGPIPE.
+    // Ignoring the signal makes the write fail instead, which is reported as an error.
+    ::signal(SIGPIPE, SIG_IGN);
+#endif
+
+    std::setvbuf(this->stream, nullptr, _IOFBF, StreamBufferSize);
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  void FrameStreamer::writeY4mHeader() {
+    using Nuclex::Support::Text::lexical_append;
+
+    std::string header(u8"YUV4MPEG2 W", 11);
+    lexical_append(header, this->frameWidth);
+    header.append(u8" H", 2);
+    lexical_append(header, this->frameHeight);
+    header.append(u8" F", 2);
+    lexical_append(header, this->settings.FrameRateNumerator);
+    header.push_back(u8':');
+    lexical_append(header, this->settings.FrameRateDenominator);
+    header.append(u8" Ip A1:1 C444p16\n", 17);
+
+    writeBytes(header.data(), header.length());
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  void FrameStreamer::writeBytes(const void *data, std::size_t byteCount) {
+    std::size_t writtenByteCount = std::fwrite(data, 1, byteCount, this->stream);
+    if(writtenByteCount != byteCount) {
+      throw std::runtime_error(
+        u8"Could not write into frame stream, the consumer may have exited"
+      );
+    }
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  int FrameStreamer::close() {
+    if(this->stream == nullptr) {
+      return 0;
+    }
+
+    int exitCode = 0;
+    if(this->isChildProcessPipe) {
+#if defined(NUCLEX_FRAMEFIXER_WINDOWS)
+      exitCode = ::_pclose(this->stream);
+#else
+      int status = ::pclose(this->stream);
+      if((status != -1) && WIFEXITED(status)) {
+        exitCode = WEXITSTATUS(status);
+      } else {
+        exitCode = -1;
+      }
+#endif
+    } else if(this->stream == stdout) {
+      std::fflush(stdout);
+    } else {
+      std::fclose(this->stream);
+    }
+
+    this->stream = nullptr;
+    this->isChildProcessPipe = false;
+    return exitCode;
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+} // namespace Nuclex::FrameFixer::Rendering
@@ -0,0 +1,109 @@
+#pragma region Apache License 2.0
+/*
+Nuclex Frame Fixer
+Copyright (C) 2024 Markus Ewald / Nuclex Development Labs
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#pragma endregion // Apache License 2.0
+
+#ifndef NUCLEX_FRAMEFIXER_RENDERING_FRAMESTREAMER_H
+#define NUCLEX_FRAMEFIXER_RENDERING_FRAMESTREAMER_H
+
+#include "Nuclex/FrameFixer/Config.h"
+#include "./StreamSettings.h"
+
+#include <cstddef> // for std::size_t
+#include <cstdint> // for std::uint16_t
+#include <cstdio> // for std::FILE
+#include <vector> // for std::vector
+
+#include <QImage>
+
+namespace Nuclex::FrameFixer::Rendering {
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Streams output frames as Y4M or raw video into a pipe or file</summary>
+  /// <remarks>
+  ///   <para>
+  ///     Encoders further down the line can consume the frames without them ever touching
+  ///     the file system. The stream is opened when the first frame arrives, since the Y4M
+  ///     header needs to state the frame size. Frames are always streamed at 16 bits per
+  ///     channel in little endian byte order.
+  ///   </para>
+  ///   <para>
+  ///     Child processes are started through the system's shell with a pipe connected to
+  ///     their standard input. When the stream is finished, the pipe is closed, which
+  ///     tells the consumer that no more frames follow, and the streamer waits for
+  ///     the child process to exit.
+  ///   </para>
+  ///   <para>
+  ///     Frames must be written in the order they should appear in. The streamer is
+  ///     not thread-safe.
+  ///   </para>
+  /// </remarks>
+  class FrameStreamer {
+
+    /// <summary>Initializes a new frame streamer</summary>
+    /// <param name="settings">Format and destination of the stream</param>
+    public: FrameStreamer(const StreamSettings &settings);
+    /// <summary>Closes the stream and frees all resources used by the streamer</summary>
+    public: ~FrameStreamer();
+
+    /// <summary>Sends the next frame into the stream</summary>
+    /// <param name="image">Image that will be streamed as the next frame</param>
+    public: void Write(const QImage &image);
+
+    /// <summary>Closes the stream and, for child processes, waits for them to exit</summary>
+    /// <remarks>
+    ///   Throws an exception if the child process reported an error through its
+    ///   exit code.
+    /// </remarks>
+    public: void Finish();
+
+    /// <summary>Opens the stream to the destination</summary>
+    private: void open();
+
+    /// <summary>Writes the Y4M stream header</summary>
+    private: void writeY4mHeader();
+
+    /// <summary>Writes raw bytes into the stream</summary>
+    /// <param name="data">Bytes that will be written</param>
+    /// <param name="byteCount">Number of bytes that will be written</param>
+    private: void writeBytes(const void *data, std::size_t byteCount);
+
+    /// <summary>Closes the stream</summary>
+    /// <returns>The exit code of the child process or 0 for other destinations</returns>
+    private: int close();
+
+    /// <summary>Format and destination of the stream</summary>
+    private: StreamSettings settings;
+    /// <summary>Stream the frames are written into, null until the first frame</summary>
+    private: std::FILE *stream;
+    /// <summary>Whether the stream is a pipe to a child process</summary>
+    private: bool isChildProcessPipe;
+    /// <summary>Width of the frames in the stream in pixels</summary>
+    private: int frameWidth;
+    /// <summary>Height of the frames in the stream in pixels</summary>
+    private: int frameHeight;
+    /// <summary>Holds the converted pixels of one frame before they are written</summary>
+    private: std::vector<std::uint16_t> conversionBuffer;
+
+  };
+
+  // ------------------------------------------------------------------------------------------- //
+
+} // namespace Nuclex::FrameFixer::Rendering
+
+#endif // NUCLEX_FRAMEFIXER_RENDERING_FRAMESTREAMER_H
@@ -0,0 +1,304 @@
+#pragma region Apache License 2.0
+/*
+Nuclex Frame Fixer
+Copyright (C) 2024 Markus Ewald / Nuclex Development Labs
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#pragma endregion // Apache License 2.0
+
+// If the application is compiled as a DLL, this ensures symbols are exported
+#define NUCLEX_FRAMEFIXER_SOURCE 1
+
+#include "./FrameWriter.h"
+#include "./RenderManifest.h"
+#include "./RenderStatistics.h"
+#include "./VideoEncoder.h"
+#include "./FrameStreamer.h"
+#include "./ImageFormats/PngImageEncoder.h"
+#include "../Diagnostics/TraceRecorder.h"
+
+#include <QFileInfo>
+
+#include <Nuclex/Support/Text/LexicalCast.h> // for lexical_cast()
+
+#include <stdexcept> // for std::runtime_error
+
+namespace Nuclex::FrameFixer::Rendering {
+
+  // ------------------------------------------------------------------------------------------- //
+
+  const std::string FrameWriter::VideoFilename(u8"movie.mkv", 9);
+
+  // ------------------------------------------------------------------------------------------- //
+
+  FrameWriter::FrameWriter(const std::string &directory) :
+    directory(directory),
+    writeQueue(),
+    writeThreads(),
+    writeErrorMutex(),
+    writeError(),
+    manifest(),
+    statistics(),
+    memoryBudget(),
+    imageEncoder(std::make_shared<ImageFormats::PngImageEncoder>()),
+    videoEncoder(),
+    streamer() {
+    std::string::size_type length = this->directory.length();
+    if((length >= 1) && (this->directory[length - 1] != '/')) {
+      this->directory.push_back(u8'/');
+    }
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  FrameWriter::~FrameWriter() {
+    stopBackgroundWriting(true);
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  void FrameWriter::StartBackgroundWriting(std::size_t threadCount, std::size_t queueDepth) {
+    stopBackgroundWriting(false);
+
+    this->writeError = std::exception_ptr();
+    this->writeQueue = std::make_unique<BoundedQueue<QueuedFrame>>(queueDepth);
+
+    // Video and stream frames have to be sent in order, so there can only be one thread
+    bool isOrdered = static_cast<bool>(this->videoEncoder) || static_cast<bool>(this->streamer);
+    if((threadCount < 1) || isOrdered) {
+      threadCount = 1;
+    }
+    this->writeThreads.reserve(threadCount);
+    for(std::size_t index = 0; index < threadCount; ++index) {
+      this->writeThreads.emplace_back(&FrameWriter::writeInBackground, this);
+    }
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  void FrameWriter::EncodeToVideo(const VideoSettings &settings) {
+#if defined(NUCLEX_FRAMEFIXER_ENABLE_LIBAV)
+    this->videoEncoder = std::make_shared<VideoEncoder>(this->directory + VideoFilename, settings);
+#else
+    (void)settings;
+    throw std::runtime_error(u8"Video output requires the application to be built with libav");
+#endif
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  void FrameWriter::StreamTo(const StreamSettings &settings) {
+    this->streamer = std::make_shared<FrameStreamer>(settings);
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  void FrameWriter::SetImageEncoder(
+    const std::shared_ptr<ImageFormats::ImageEncoder> &imageEncoder
+  ) {
+    this->imageEncoder = imageEncoder;
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  void FrameWriter::SetManifest(const std::shared_ptr<RenderManifest> &manifest) {
+    this->manifest = manifest;
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  void FrameWriter::SetStatistics(const std::shared_ptr<RenderStatistics> &statistics) {
+    this->statistics = statistics;
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  void FrameWriter::SetMemoryBudget(const std::shared_ptr<FrameMemoryBudget> &memoryBudget) {
+    this->memoryBudget = memoryBudget;
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  bool FrameWriter::IsUpToDate(std::size_t outputFrameIndex) const {
+    if(static_cast<bool>(this->manifest)) {
+      return this->manifest->IsUpToDate(outputFrameIndex, GetOutputPath(outputFrameIndex));
+    } else {
+      return false;
+    }
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  void FrameWriter::Write(const QImage &image, std::size_t outputFrameIndex) {
+    if(static_cast<bool>(this->manifest)) {
+      this->manifest->Invalidate(outputFrameIndex);
+    }
+    if(!static_cast<bool>(this->writeQueue)) {
+      writeImmediately(image, outputFrameIndex);
+      return;
+    }
+
+    // QImage is implicitly shared, so this does not copy any pixels. Should the renderer
+    // modify its image before the worker thread is done with it, Qt detaches the image.
+    QueuedFrame queuedFrame;
+    queuedFrame.OutputFrameIndex = outputFrameIndex;
+    queuedFrame.Image = image;
+
+    // Wait for the encoder threads to catch up if the frames in flight exhaust
+    // the budget, unless they have nothing left to do
+    if(static_cast<bool>(this->memoryBudget)) {
+      NUCLEX_FRAMEFIXER_TRACE_SCOPE(u8"render", u8"Wait for memory budget");
+      queuedFrame.MemoryReservation = this->memoryBudget->Acquire(
+        static_cast<std::size_t>(image.sizeInBytes()),
+        [this]() { return this->writeQueue->IsEmpty(); }
+      );
+    }
+
+    if(!this->writeQueue->Push(std::move(queuedFrame))) {
+      std::unique_lock<std::mutex> errorLock(this->writeErrorMutex);
+      if(static_cast<bool>(this->writeError)) {
+        std::rethrow_exception(this->writeError);
+      }
+    }
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  void FrameWriter::Flush() {
+    stopBackgroundWriting(false);
+
+    if(static_cast<bool>(this->writeError)) {
+      std::exception_ptr error = this->writeError;
+      this->writeError = std::exception_ptr();
+      std::rethrow_exception(error);
+    }
+
+#if defined(NUCLEX_FRAMEFIXER_ENABLE_LIBAV)
+    if(static_cast<bool>(this->videoEncoder)) {
+      this->videoEncoder->Finish();
+
+      // The muxer writes the video file as it goes, so only its final size is known
+      if(static_cast<bool>(this->statistics)) {
+        QFileInfo videoFileInfo(QString::fromStdString(this->directory + VideoFilename));
+        this->statistics->AddBytesWritten(static_cast<std::uint64_t>(videoFileInfo.size()));
+      }
+    }
+#endif
+    if(static_cast<bool>(this->streamer)) {
+      this->streamer->Finish();
+    }
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  std::string FrameWriter::GetOutputPath(std::size_t outputFrameIndex) const {
+    std::string path = this->directory;
+
+    std::string filename = Nuclex::Support::Text::lexical_cast<std::string>(outputFrameIndex);
+    for(std::size_t index = filename.length(); index < 8; ++index) {
+      path.push_back(u8'0');
+    }
+
+    path.append(filename);
+    path.append(this->imageEncoder->GetFileExtension());
+
+    return path;
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  void FrameWriter::writeImmediately(const QImage &image, std::size_t outputFrameIndex) {
+    RenderStatistics *statistics = this->statistics.get();
+#if defined(NUCLEX_FRAMEFIXER_ENABLE_LIBAV)
+    if(static_cast<bool>(this->videoEncoder)) {
+      RenderStatistics::ScopedTimer encodeTimer(statistics, RenderStage::Encode);
+      this->videoEncoder->Encode(image);
+      return;
+    }
+#endif
+    if(static_cast<bool>(this->streamer)) {
+      RenderStatistics::ScopedTimer writeTimer(statistics, RenderStage::Write);
+      this->streamer->Write(image);
+      return;
+    }
+
+    // Encode and write separately, so it's possible to tell whether compression
+    // or the disk is holding up the render
+    std::vector<std::uint8_t> contents;
+    {
+      RenderStatistics::ScopedTimer encodeTimer(statistics, RenderStage::Encode);
+      contents = this->imageEncoder->Encode(image);
+    }
+    {
+      RenderStatistics::ScopedTimer writeTimer(statistics, RenderStage::Write);
+      ImageFormats::ImageEncoder::WriteFile(GetOutputPath(outputFrameIndex), contents);
+    }
+    if(statistics != nullptr) {
+      statistics->AddBytesWritten(contents.size());
+    }
+
+    // Only record the frame once its file is complete, so that frames which were
+    // still being written when the application crashed are rendered again
+    if(static_cast<bool>(this->manifest)) {
+      this->manifest->Record(outputFrameIndex);
+    }
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  void FrameWriter::writeInBackground() {
+    Diagnostics::TraceRecorder::NameCurrentThread(u8"Frame writer");
+    try {
+      QueuedFrame queuedFrame;
+      while(this->writeQueue->Pop(queuedFrame)) {
+        writeImmediately(queuedFrame.Image, queuedFrame.OutputFrameIndex);
+        queuedFrame.Image = QImage(); // Release our reference before waiting again
+        queuedFrame.MemoryReservation.Release();
+      }
+    }
+    catch(...) {
+      {
+        std::unique_lock<std::mutex> errorLock(this->writeErrorMutex);
+        if(!static_cast<bool>(this->writeError)) {
+          this->writeError = std::current_exception();
+        }
+      }
+
+      // Stop the other encoder threads, too, and wake up the renderer
+      // if it is waiting for space in the queue
+      this->writeQueue->Close();
+      this->writeQueue->Clear();
+    }
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  void FrameWriter::stopBackgroundWriting(bool dropQueuedFrames) {
+    if(static_cast<bool>(this->writeQueue)) {
+      if(dropQueuedFrames) {
+        this->writeQueue->Clear();
+      }
+      this->writeQueue->Close();
+    }
+    for(std::size_t index = 0; index < this->writeThreads.size(); ++index) {
+      this->writeThreads[index].join();
+    }
+
+    this->writeThreads.clear();
+    this->writeQueue.reset();
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+} // namespace Nuclex::FrameFixer::Rendering
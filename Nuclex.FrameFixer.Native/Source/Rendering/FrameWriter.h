@@ -0,0 +1,238 @@
+#pragma region Apache License 2.0
+/*
+Nuclex Frame Fixer
+Copyright (C) 2024 Markus Ewald / Nuclex Development Labs
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#pragma endregion // Apache License 2.0
+
+#ifndef NUCLEX_FRAMEFIXER_RENDERING_FRAMEWRITER_H
+#define NUCLEX_FRAMEFIXER_RENDERING_FRAMEWRITER_H
+
+#include "Nuclex/FrameFixer/Config.h"
+#include "./BoundedQueue.h"
+#include "./FrameMemoryBudget.h"
+#include "./VideoSettings.h"
+#include "./StreamSettings.h"
+
+#include <memory> // for std::unique_ptr, std::shared_ptr
+#include <cstddef> // for std::size_t
+#include <string> // for std::string
+#include <utility> // for std::pair
+#include <thread> // for std::thread
+#include <vector> // for std::vector
+#include <mutex> // for std::mutex
+#include <exception> // for std::exception_ptr
+
+#include <QImage>
+
+namespace Nuclex::FrameFixer::Rendering {
+
+  // ------------------------------------------------------------------------------------------- //
+
+  class RenderManifest;
+  class RenderStatistics;
+  class VideoEncoder;
+  class FrameStreamer;
+
+  // ------------------------------------------------------------------------------------------- //
+
+}
+
+namespace Nuclex::FrameFixer::Rendering::ImageFormats {
+
+  // ------------------------------------------------------------------------------------------- //
+
+  class ImageEncoder;
+
+  // ------------------------------------------------------------------------------------------- //
+
+}
+
+namespace Nuclex::FrameFixer::Rendering {
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Encodes and writes output frames, optionally using a pool of threads</summary>
+  /// <remarks>
+  ///   <para>
+  ///     This is the encode/write stage of the render pipeline. Without background threads,
+  ///     each frame is written on the spot. Once background writing is started, frames are
+  ///     handed to a pool of encoder threads through a bounded queue, so PNG compression
+  ///     (which is very expensive for 16 bit frames) and disk I/O run concurrently with
+  ///     each other and with the processing of the following frames.
+  ///   </para>
+  ///   <para>
+  ///     Encoder threads pick up frames in the order they were submitted in. With a single
+  ///     encoder thread, frames are also written in that order, with multiple threads,
+  ///     the files of neighbouring frames may be completed out of order.
+  ///   </para>
+  ///   <para>
+  ///     Instead of saving one image file per frame, the writer can also encode all frames
+  ///     into a video file or stream them to another application. Frames then have to
+  ///     arrive in order, so only one encoder thread will be started in those modes.
+  ///   </para>
+  ///   <para>
+  ///     If the queue is full, <see cref="Write" /> blocks until an encoder thread has
+  ///     caught up, so no more than the queue depth plus the number of encoder threads
+  ///     frames are ever waiting to be written.
+  ///   </para>
+  /// </remarks>
+  class FrameWriter {
+
+    /// <summary>Initializes a new frame writer</summary>
+    /// <param name="directory">Directory in which the output frames will be saved</param>
+    public: FrameWriter(const std::string &directory);
+    /// <summary>Stops the encoder threads and frees all resources used by the writer</summary>
+    /// <remarks>
+    ///   Frames that are still waiting in the queue when the writer is destroyed are
+    ///   dropped. Use <see cref="Flush" /> to make sure all frames have been written.
+    /// </remarks>
+    public: ~FrameWriter();
+
+    /// <summary>Begins writing frames in background threads</summary>
+    /// <param name="threadCount">Number of encoder threads that will be started</param>
+    /// <param name="queueDepth">Maximum number of frames that can wait to be written</param>
+    public: void StartBackgroundWriting(std::size_t threadCount, std::size_t queueDepth);
+
+    /// <summary>Encodes all frames into a single video file instead of image files</summary>
+    /// <param name="settings">Codec, quality and frame rate of the video</param>
+    /// <remarks>
+    ///   The video file is created in the target directory under the name given by
+    ///   <see cref="VideoFilename" />. Frames must be written in the order they appear
+    ///   in the video and this method must be called before background writing starts.
+    /// </remarks>
+    public: void EncodeToVideo(const VideoSettings &settings);
+
+    /// <summary>Streams all frames to another application instead of saving them</summary>
+    /// <param name="settings">Format and destination of the stream</param>
+    /// <remarks>
+    ///   Frames must be written in the order they should appear in the stream and
+    ///   this method must be called before background writing starts.
+    /// </remarks>
+    public: void StreamTo(const StreamSettings &settings);
+
+    /// <summary>Name of the video file frames are encoded into in video mode</summary>
+    public: static const std::string VideoFilename;
+
+    /// <summary>Selects the image format output frames will be saved in</summary>
+    /// <param name="imageEncoder">Encoder that will save the output frames</param>
+    /// <remarks>
+    ///   By default, frames are saved as PNG images with zlib's default compression.
+    ///   The encoder also decides the file extension of the output frames, so this
+    ///   should be called before checking whether frames are up to date.
+    /// </remarks>
+    public: void SetImageEncoder(const std::shared_ptr<ImageFormats::ImageEncoder> &imageEncoder);
+
+    /// <summary>Selects a manifest in which all written frames will be recorded</summary>
+    /// <param name="manifest">Manifest that will be updated as frames are written</param>
+    public: void SetManifest(const std::shared_ptr<RenderManifest> &manifest);
+
+    /// <summary>Selects the statistics the time spent encoding and writing goes into</summary>
+    /// <param name="statistics">Statistics that will be updated as frames are written</param>
+    public: void SetStatistics(const std::shared_ptr<RenderStatistics> &statistics);
+
+    /// <summary>Selects the budget that frames waiting to be written are counted against</summary>
+    /// <param name="memoryBudget">Budget the write-behind queue has to stay within</param>
+    /// <remarks>
+    ///   When the budget is exhausted, <see cref="Write" /> blocks until the encoder
+    ///   threads have written some frames. It only exceeds the budget if the encoder
+    ///   threads would otherwise sit idle.
+    /// </remarks>
+    public: void SetMemoryBudget(const std::shared_ptr<FrameMemoryBudget> &memoryBudget);
+
+    /// <summary>Checks whether an output frame has already been written by a prior render</summary>
+    /// <param name="outputFrameIndex">Index of the output frame that will be checked</param>
+    /// <returns>
+    ///   True if the manifest shows that the output frame exists and was rendered from
+    ///   the same inputs as in the current render
+    /// </returns>
+    public: bool IsUpToDate(std::size_t outputFrameIndex) const;
+
+    /// <summary>Writes an output frame into the target directory</summary>
+    /// <param name="image">Image that will be written</param>
+    /// <param name="outputFrameIndex">Index of the output frame, determines the file name</param>
+    public: void Write(const QImage &image, std::size_t outputFrameIndex);
+
+    /// <summary>Builds the path of the file an output frame will be saved in</summary>
+    /// <param name="outputFrameIndex">Index of the output frame</param>
+    /// <returns>The path of the file in which the output frame will be saved</returns>
+    /// <remarks>
+    ///   Output frames are named by their index, zero-padded to 8 digits, so that
+    ///   the files sort correctly and can be fed to encoders using a %08d pattern.
+    /// </remarks>
+    public: std::string GetOutputPath(std::size_t outputFrameIndex) const;
+
+    /// <summary>Waits until all frames have been written and stops the encoder threads</summary>
+    /// <remarks>
+    ///   If writing a frame failed in an encoder thread, the error will resurface here.
+    ///   When encoding to a video or streaming, this also completes the video file
+    ///   or closes the stream.
+    /// </remarks>
+    public: void Flush();
+
+    /// <summary>Encodes and saves an image in the specified file</summary>
+    /// <param name="image">Image that will be saved</param>
+    /// <param name="outputFrameIndex">Index of the output frame the image is for</param>
+    private: void writeImmediately(const QImage &image, std::size_t outputFrameIndex);
+
+    /// <summary>Called in the encoder threads to write the queued frames</summary>
+    private: void writeInBackground();
+
+    /// <summary>Stops the encoder threads, optionally dropping queued frames</summary>
+    /// <param name="dropQueuedFrames">Whether frames still in the queue will be dropped</param>
+    private: void stopBackgroundWriting(bool dropQueuedFrames);
+
+    /// <summary>An output frame waiting for an encoder thread</summary>
+    private: struct QueuedFrame {
+
+      /// <summary>Index of the output frame, determines the file name</summary>
+      public: std::size_t OutputFrameIndex;
+      /// <summary>Image that should be written for the output frame</summary>
+      public: QImage Image;
+      /// <summary>Memory reserved for the image until it has been written</summary>
+      public: FrameMemoryBudget::Reservation MemoryReservation;
+
+    };
+
+    /// <summary>Directory in which the output frames are saved, ending with a slash</summary>
+    private: std::string directory;
+    /// <summary>Queue through which frames are handed to the encoder threads</summary>
+    private: std::unique_ptr<BoundedQueue<QueuedFrame>> writeQueue;
+    /// <summary>Threads encoding and writing frames in the background</summary>
+    private: std::vector<std::thread> writeThreads;
+    /// <summary>Must be held when storing an error from an encoder thread</summary>
+    private: std::mutex writeErrorMutex;
+    /// <summary>First error that caused an encoder thread to stop, if any</summary>
+    private: std::exception_ptr writeError;
+    /// <summary>Manifest in which written frames are recorded, can be empty</summary>
+    private: std::shared_ptr<RenderManifest> manifest;
+    /// <summary>Statistics in which encode and write times are recorded, can be empty</summary>
+    private: std::shared_ptr<RenderStatistics> statistics;
+    /// <summary>Budget queued frames are counted against, can be empty</summary>
+    private: std::shared_ptr<FrameMemoryBudget> memoryBudget;
+    /// <summary>Encoder that saves the output frames as image files</summary>
+    private: std::shared_ptr<ImageFormats::ImageEncoder> imageEncoder;
+    /// <summary>Encoder for the video file frames are written to, empty for images</summary>
+    private: std::shared_ptr<VideoEncoder> videoEncoder;
+    /// <summary>Stream frames are sent into, empty for images</summary>
+    private: std::shared_ptr<FrameStreamer> streamer;
+
+  };
+
+  // ------------------------------------------------------------------------------------------- //
+
+} // namespace Nuclex::FrameFixer::Rendering
+
+#endif // NUCLEX_FRAMEFIXER_RENDERING_FRAMEWRITER_H
@@ -0,0 +1,111 @@
+#pragma region Apache License 2.0
+/*
+Nuclex Frame Fixer
+Copyright (C) 2024 Markus Ewald / Nuclex Development Labs
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#pragma endregion // Apache License 2.0
+
+// If the application is compiled as a DLL, this ensures symbols are exported
+#define NUCLEX_FRAMEFIXER_SOURCE 1
+
+#include "./ImageEncoder.h"
+
+#include <QFile>
+
+#include <stdexcept> // for std::runtime_error
+
+namespace Nuclex::FrameFixer::Rendering::ImageFormats {
+
+  // ------------------------------------------------------------------------------------------- //
+
+  void ImageEncoder::Save(const QImage &image, const std::string &path) const {
+    WriteFile(path, Encode(image));
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  bool ImageEncoder::HasSixteenBitChannels(const QImage &image) {
+    switch(image.format()) {
+      case QImage::Format_RGBX64:
+      case QImage::Format_RGBA64:
+      case QImage::Format_RGBA64_Premultiplied:
+      case QImage::Format_Grayscale16: {
+        return true;
+      }
+      default: {
+        return false;
+      }
+    }
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  QImage ImageEncoder::ToRgba64(const QImage &image) {
+    QImage::Format format = image.format();
+    if((format == QImage::Format_RGBA64) || (format == QImage::Format_RGBX64)) {
+      return image; // Implicitly shared, no pixels are copied
+    } else if(image.hasAlphaChannel()) {
+      return image.convertToFormat(QImage::Format_RGBA64);
+    } else {
+      return image.convertToFormat(QImage::Format_RGBX64);
+    }
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  QImage ImageEncoder::ToRgba8888(const QImage &image) {
+    QImage::Format format = image.format();
+    if((format == QImage::Format_RGBA8888) || (format == QImage::Format_RGBX8888)) {
+      return image; // Implicitly shared, no pixels are copied
+    } else if(image.hasAlphaChannel()) {
+      return image.convertToFormat(QImage::Format_RGBA8888);
+    } else {
+      return image.convertToFormat(QImage::Format_RGBX8888);
+    }
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  void ImageEncoder::WriteFile(
+    const std::string &path, const std::vector<std::uint8_t> &contents
+  ) {
+    QFile file(QString::fromStdString(path));
+    bool opened = file.open(
+      QIODevice::OpenModeFlag::WriteOnly | QIODevice::OpenModeFlag::Truncate
+    );
+    if(!opened) {
+      std::string message(u8"Could not create image file '", 29);
+      message.append(path);
+      message.append(u8"'", 1);
+      throw std::runtime_error(message);
+    }
+
+    qint64 writtenByteCount = file.write(
+      reinterpret_cast<const char *>(contents.data()), static_cast<qint64>(contents.size())
+    );
+    file.close();
+
+    if(writtenByteCount != static_cast<qint64>(contents.size())) {
+      QFile::remove(QString::fromStdString(path)); // Don't leave a truncated image behind
+      std::string message(u8"Could not write image file '", 28);
+      message.append(path);
+      message.append(u8"'", 1);
+      throw std::runtime_error(message);
+    }
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+} // namespace Nuclex::FrameFixer::Rendering::ImageFormats
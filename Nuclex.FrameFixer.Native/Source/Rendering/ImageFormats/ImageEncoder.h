@@ -0,0 +1,95 @@
+#pragma region Apache License 2.0
+/*
+Nuclex Frame Fixer
+Copyright (C) 2024 Markus Ewald / Nuclex Development Labs
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#pragma endregion // Apache License 2.0
+
+#ifndef NUCLEX_FRAMEFIXER_RENDERING_IMAGEFORMATS_IMAGEENCODER_H
+#define NUCLEX_FRAMEFIXER_RENDERING_IMAGEFORMATS_IMAGEENCODER_H
+
+#include "Nuclex/FrameFixer/Config.h"
+
+#include <QImage>
+
+#include <cstddef> // for std::size_t
+#include <cstdint> // for std::uint8_t
+#include <string> // for std::string
+#include <vector> // for std::vector
+
+namespace Nuclex::FrameFixer::Rendering::ImageFormats {
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Saves output frames as image files in a specific format</summary>
+  /// <remarks>
+  ///   The frame writer calls <see cref="Encode" /> from all of its encoder threads at once,
+  ///   so implementations must not modify any state while encoding an image.
+  /// </remarks>
+  class ImageEncoder {
+
+    /// <summary>Frees all resources used by the instance</summary>
+    public: virtual ~ImageEncoder() = default;
+
+    /// <summary>Returns a name by which the image format can be displayed</summary>
+    /// <returns>A short, human-readable name for the image format and its settings</returns>
+    public: virtual std::string GetName() const = 0;
+
+    /// <summary>Returns the file extension used for images in this format</summary>
+    /// <returns>The file extension, including the leading dot</returns>
+    public: virtual std::string GetFileExtension() const = 0;
+
+    /// <summary>Encodes an image into the contents of an image file</summary>
+    /// <param name="image">Image that will be encoded</param>
+    /// <returns>The bytes that make up the image file</returns>
+    public: virtual std::vector<std::uint8_t> Encode(const QImage &image) const = 0;
+
+    /// <summary>Saves an image in the specified file</summary>
+    /// <param name="image">Image that will be saved</param>
+    /// <param name="path">Path of the file the image will be saved in</param>
+    public: void Save(const QImage &image, const std::string &path) const;
+
+    /// <summary>Replaces the contents of a file with the specified bytes</summary>
+    /// <param name="path">Path of the file that will be written</param>
+    /// <param name="contents">Bytes that will be written into the file</param>
+    /// <remarks>
+    ///   Throws an exception if the file can not be created or not be written completely.
+    /// </remarks>
+    public: static void WriteFile(
+      const std::string &path, const std::vector<std::uint8_t> &contents
+    );
+
+    /// <summary>Checks whether an image stores 16 bits per color channel</summary>
+    /// <param name="image">Image that will be checked</param>
+    /// <returns>True if the image's color channels have 16 bits</returns>
+    protected: static bool HasSixteenBitChannels(const QImage &image);
+
+    /// <summary>Returns the image itself or a copy with four 16 bit channels</summary>
+    /// <param name="image">Image that will be provided in the RGBA64 format</param>
+    /// <returns>An image in the QImage::Format_RGBA64 or QImage::Format_RGBX64 format</returns>
+    protected: static QImage ToRgba64(const QImage &image);
+
+    /// <summary>Returns the image itself or a copy with four 8 bit channels</summary>
+    /// <param name="image">Image that will be provided in the RGBA8888 format</param>
+    /// <returns>An image in the QImage::Format_RGBA8888 or QImage::Format_RGBX8888 format</returns>
+    protected: static QImage ToRgba8888(const QImage &image);
+
+  };
+
+  // ------------------------------------------------------------------------------------------- //
+
+} // namespace Nuclex::FrameFixer::Rendering::ImageFormats
+
+#endif // NUCLEX_FRAMEFIXER_RENDERING_IMAGEFORMATS_IMAGEENCODER_H
@@ -0,0 +1,570 @@
+#pragma region Apache License 2.0
+/*
+Nuclex Frame Fixer
+Copyright (C) 2024 Markus Ewald / Nuclex Development Labs
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#pragma endregion // Apache License 2.0
+
+// If the application is compiled as a DLL, this ensures symbols are exported
+#define NUCLEX_FRAMEFIXER_SOURCE 1
+
+#include "./PngImageDecoder.h"
+
+#include <QFile>
+
+#include <zlib.h> // for inflate(), crc32()
+
+#include <algorithm> // for std::fill()
+#include <cstdlib> // for std::abs()
+#include <cstring> // for std::memcmp()
+#include <utility> // for std::swap()
+
+namespace {
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Signature every PNG file begins with</summary>
+  const std::uint8_t PngSignature[8] = { 0x89, 0x50, 0x4E, 0x47, 0x0D, 0x0A, 0x1A, 0x0A };
+
+  /// <summary>PNG color type for images storing only a gray level</summary>
+  const std::uint8_t GrayscaleColorType = 0;
+  /// <summary>PNG color type for images storing red, green and blue</summary>
+  const std::uint8_t RgbColorType = 2;
+  /// <summary>PNG color type for images storing indices into a palette</summary>
+  const std::uint8_t PaletteColorType = 3;
+  /// <summary>PNG color type for images storing a gray level and alpha</summary>
+  const std::uint8_t GrayscaleAlphaColorType = 4;
+  /// <summary>PNG color type for images storing red, green, blue and alpha</summary>
+  const std::uint8_t RgbaColorType = 6;
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Properties of a PNG image as stated in its IHDR chunk</summary>
+  struct PngHeader {
+
+    /// <summary>Width of the image in pixels</summary>
+    public: int Width;
+    /// <summary>Height of the image in pixels</summary>
+    public: int Height;
+    /// <summary>Number of bits per channel, either 8 or 16</summary>
+    public: std::uint8_t BitDepth;
+    /// <summary>Channels the image stores and whether it uses a palette</summary>
+    public: std::uint8_t ColorType;
+    /// <summary>Number of bytes each pixel occupies in the image data</summary>
+    public: std::size_t BytesPerPixel;
+
+  };
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Releases a zlib decompression stream when it goes out of scope</summary>
+  class InflateStreamScope {
+
+    /// <summary>Initializes a new zlib stream scope</summary>
+    /// <param name="stream">Stream that will be released when the scope ends</param>
+    public: InflateStreamScope(z_stream &stream) : stream(stream) {}
+    /// <summary>Releases the zlib stream</summary>
+    public: ~InflateStreamScope() { ::inflateEnd(&this->stream); }
+
+    /// <summary>Stream that will be released when the scope ends</summary>
+    private: z_stream &stream;
+
+  };
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Reads a 32 bit integer stored in big endian byte order</summary>
+  /// <param name="bytes">Bytes from which the integer will be read</param>
+  /// <returns>The integer stored in the bytes</returns>
+  inline std::uint32_t readBigEndian(const std::uint8_t *bytes) {
+    return (
+      (static_cast<std::uint32_t>(bytes[0]) << 24) |
+      (static_cast<std::uint32_t>(bytes[1]) << 16) |
+      (static_cast<std::uint32_t>(bytes[2]) << 8) |
+      static_cast<std::uint32_t>(bytes[3])
+    );
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Reads a 16 bit sample stored in big endian byte order</summary>
+  /// <param name="bytes">Bytes from which the sample will be read</param>
+  /// <returns>The sample stored in the bytes</returns>
+  inline quint16 readSample(const std::uint8_t *bytes) {
+    return static_cast<quint16>((static_cast<unsigned int>(bytes[0]) << 8) | bytes[1]);
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Predicts a byte from its neighbours the way the Paeth filter does</summary>
+  /// <param name="left">Byte of the pixel to the left</param>
+  /// <param name="above">Byte of the pixel above</param>
+  /// <param name="aboveLeft">Byte of the pixel above and to the left</param>
+  /// <returns>Whichever neighbour is closest to the estimate of the filter</returns>
+  inline std::uint8_t paethPredictor(int left, int above, int aboveLeft) {
+    int estimate = left + above - aboveLeft;
+    int leftDistance = std::abs(estimate - left);
+    int aboveDistance = std::abs(estimate - above);
+    int aboveLeftDistance = std::abs(estimate - aboveLeft);
+
+    if((leftDistance <= aboveDistance) && (leftDistance <= aboveLeftDistance)) {
+      return static_cast<std::uint8_t>(left);
+    } else if(aboveDistance <= aboveLeftDistance) {
+      return static_cast<std::uint8_t>(above);
+    } else {
+      return static_cast<std::uint8_t>(aboveLeft);
+    }
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Reverses the PNG filter that has been applied to a row of pixels</summary>
+  /// <param name="filter">Filter type the row was stored with</param>
+  /// <param name="row">Filtered row of pixels that will be restored in place</param>
+  /// <param name="priorRow">Restored row of pixels above, all zeros for the first row</param>
+  /// <param name="rowLength">Length of a row in bytes</param>
+  /// <param name="bytesPerPixel">Number of bytes each pixel occupies</param>
+  /// <returns>True if the row was restored, false if the filter type is unknown</returns>
+  bool unfilterRow(
+    std::uint8_t filter, std::uint8_t *row, const std::uint8_t *priorRow,
+    std::size_t rowLength, std::size_t bytesPerPixel
+  ) {
+    switch(filter) {
+      case 0: {
+        return true;
+      }
+      case 1: {
+        for(std::size_t index = bytesPerPixel; index < rowLength; ++index) {
+          row[index] = static_cast<std::uint8_t>(row[index] + row[index - bytesPerPixel]);
+        }
+        return true;
+      }
+      case 2: {
+        for(std::size_t index = 0; index < rowLength; ++index) {
+          row[index] = static_cast<std::uint8_t>(row[index] + priorRow[index]);
+        }
+        return true;
+      }
+      case 3: {
+        for(std::size_t index = 0; index < bytesPerPixel; ++index) {
+          row[index] = static_cast<std::uint8_t>(row[index] + (priorRow[index] >> 1));
+        }
+        for(std::size_t index = bytesPerPixel; index < rowLength; ++index) {
+          int average = (
+            static_cast<int>(row[index - bytesPerPixel]) + static_cast<int>(priorRow[index])
+          ) >> 1;
+          row[index] = static_cast<std::uint8_t>(row[index] + average);
+        }
+        return true;
+      }
+      case 4: {
+        for(std::size_t index = 0; index < bytesPerPixel; ++index) {
+          row[index] = static_cast<std::uint8_t>(row[index] + priorRow[index]);
+        }
+        for(std::size_t index = bytesPerPixel; index < rowLength; ++index) {
+          std::uint8_t predicted = paethPredictor(
+            row[index - bytesPerPixel], priorRow[index], priorRow[index - bytesPerPixel]
+          );
+          row[index] = static_cast<std::uint8_t>(row[index] + predicted);
+        }
+        return true;
+      }
+      default: {
+        return false;
+      }
+    }
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Writes a row of 16 bit PNG pixels into an RGBA64 or RGBX64 scanline</summary>
+  /// <param name="header">Properties of the PNG image</param>
+  /// <param name="row">Unfiltered row of pixels from the PNG image</param>
+  /// <param name="target">Scanline of the QImage that receives the pixels</param>
+  void writeSixteenBitRow(const PngHeader &header, const std::uint8_t *row, uchar *target) {
+    QRgba64 *pixels = reinterpret_cast<QRgba64 *>(target);
+    switch(header.ColorType) {
+      case GrayscaleColorType: {
+        for(int x = 0; x < header.Width; ++x, row += 2) {
+          quint16 gray = readSample(row);
+          pixels[x] = QRgba64::fromRgba64(gray, gray, gray, 65535);
+        }
+        break;
+      }
+      case GrayscaleAlphaColorType: {
+        for(int x = 0; x < header.Width; ++x, row += 4) {
+          quint16 gray = readSample(row);
+          pixels[x] = QRgba64::fromRgba64(gray, gray, gray, readSample(row + 2));
+        }
+        break;
+      }
+      case RgbColorType: {
+        for(int x = 0; x < header.Width; ++x, row += 6) {
+          pixels[x] = QRgba64::fromRgba64(
+            readSample(row), readSample(row + 2), readSample(row + 4), 65535
+          );
+        }
+        break;
+      }
+      default: {
+        for(int x = 0; x < header.Width; ++x, row += 8) {
+          pixels[x] = QRgba64::fromRgba64(
+            readSample(row), readSample(row + 2), readSample(row + 4), readSample(row + 6)
+          );
+        }
+        break;
+      }
+    }
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Writes a row of 8 bit PNG pixels into an RGB32 or ARGB32 scanline</summary>
+  /// <param name="header">Properties of the PNG image</param>
+  /// <param name="palette">Colors of the palette if the image uses one</param>
+  /// <param name="row">Unfiltered row of pixels from the PNG image</param>
+  /// <param name="target">Scanline of the QImage that receives the pixels</param>
+  void writeEightBitRow(
+    const PngHeader &header, const QRgb *palette, const std::uint8_t *row, uchar *target
+  ) {
+    QRgb *pixels = reinterpret_cast<QRgb *>(target);
+    switch(header.ColorType) {
+      case GrayscaleColorType: {
+        for(int x = 0; x < header.Width; ++x, ++row) {
+          pixels[x] = qRgb(row[0], row[0], row[0]);
+        }
+        break;
+      }
+      case GrayscaleAlphaColorType: {
+        for(int x = 0; x < header.Width; ++x, row += 2) {
+          pixels[x] = qRgba(row[0], row[0], row[0], row[1]);
+        }
+        break;
+      }
+      case PaletteColorType: {
+        for(int x = 0; x < header.Width; ++x, ++row) {
+          pixels[x] = palette[row[0]];
+        }
+        break;
+      }
+      case RgbColorType: {
+        for(int x = 0; x < header.Width; ++x, row += 3) {
+          pixels[x] = qRgb(row[0], row[1], row[2]);
+        }
+        break;
+      }
+      default: {
+        for(int x = 0; x < header.Width; ++x, row += 4) {
+          pixels[x] = qRgba(row[0], row[1], row[2], row[3]);
+        }
+        break;
+      }
+    }
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Reads the IHDR chunk of a PNG file</summary>
+  /// <param name="data">Data stored in the IHDR chunk</param>
+  /// <param name="length">Length of the IHDR chunk's data in bytes</param>
+  /// <param name="header">Receives the properties of the image</param>
+  /// <returns>True if the decoder supports the image, false otherwise</returns>
+  bool tryReadHeader(const std::uint8_t *data, std::size_t length, PngHeader &header) {
+    if(length < 13) {
+      return false;
+    }
+
+    std::uint32_t width = readBigEndian(data);
+    std::uint32_t height = readBigEndian(data + 4);
+    if((width == 0) || (height == 0) || (width > 0x7FFFFF) || (height > 0x7FFFFF)) {
+      return false;
+    }
+
+    // Only the standard compression and filter methods exist. Interlaced images and
+    // bit depths below 8 are rare for video frames and left to QImage.
+    bool isSupported = (data[10] == 0) && (data[11] == 0) && (data[12] == 0);
+    if(!isSupported) {
+      return false;
+    }
+
+    header.Width = static_cast<int>(width);
+    header.Height = static_cast<int>(height);
+    header.BitDepth = data[8];
+    header.ColorType = data[9];
+
+    std::size_t channelCount;
+    switch(header.ColorType) {
+      case GrayscaleColorType: { channelCount = 1; break; }
+      case RgbColorType: { channelCount = 3; break; }
+      case PaletteColorType: { channelCount = 1; break; }
+      case GrayscaleAlphaColorType: { channelCount = 2; break; }
+      case RgbaColorType: { channelCount = 4; break; }
+      default: { return false; }
+    }
+    if(header.BitDepth == 16) {
+      if(header.ColorType == PaletteColorType) {
+        return false;
+      }
+    } else if(header.BitDepth != 8) {
+      return false;
+    }
+
+    header.BytesPerPixel = channelCount * (header.BitDepth / 8);
+    return true;
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+} // anonymous namespace
+
+namespace Nuclex::FrameFixer::Rendering::ImageFormats {
+
+  // ------------------------------------------------------------------------------------------- //
+
+  PngImageDecoder::PngImageDecoder() :
+    fileContents(),
+    rowBuffer() {}
+
+  // ------------------------------------------------------------------------------------------- //
+
+  PngImageDecoder::~PngImageDecoder() {}
+
+  // ------------------------------------------------------------------------------------------- //
+
+  bool PngImageDecoder::IsPngPath(const std::string &path) {
+    std::string::size_type length = path.length();
+    if(length < 4) {
+      return false;
+    }
+
+    return (
+      (path[length - 4] == u8'.') &&
+      ((path[length - 3] == u8'p') || (path[length - 3] == u8'P')) &&
+      ((path[length - 2] == u8'n') || (path[length - 2] == u8'N')) &&
+      ((path[length - 1] == u8'g') || (path[length - 1] == u8'G'))
+    );
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  bool PngImageDecoder::TryDecode(const std::string &path, QImage &image) {
+    QFile file(QString::fromStdString(path));
+    if(!file.open(QIODevice::ReadOnly)) {
+      return false;
+    }
+
+    // The buffer only ever grows, so after the first few frames of a movie,
+    // reading another frame does not allocate any memory
+    qint64 fileSize = file.size();
+    if(fileSize <= 0) {
+      return false;
+    }
+    this->fileContents.resize(static_cast<std::size_t>(fileSize));
+
+    qint64 readByteCount = file.read(
+      reinterpret_cast<char *>(this->fileContents.data()), fileSize
+    );
+    if(readByteCount != fileSize) {
+      return false;
+    }
+
+    return TryDecode(this->fileContents.data(), this->fileContents.size(), image);
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  bool PngImageDecoder::TryDecode(
+    const std::uint8_t *contents, std::size_t length, QImage &image
+  ) {
+    if((length < 8) || (std::memcmp(contents, PngSignature, 8) != 0)) {
+      return false;
+    }
+
+    z_stream stream = z_stream();
+    if(::inflateInit(&stream) != Z_OK) {
+      return false;
+    }
+    InflateStreamScope inflateScope(stream);
+
+    PngHeader header = PngHeader();
+    bool hasHeader = false;
+
+    // Palette entries the image does not define are black, like libpng treats them
+    QRgb palette[256];
+    std::fill(palette, palette + 256, qRgb(0, 0, 0));
+    bool paletteHasAlpha = false;
+
+    std::size_t rowLength = 0;
+    std::uint8_t *currentRow = nullptr;
+    std::uint8_t *priorRow = nullptr;
+    std::size_t filledByteCount = 0;
+    int rowIndex = 0;
+    bool streamEnded = false;
+    bool hasEnd = false;
+
+    // Walk through the chunks of the file, decoding the image data as it appears
+    std::size_t offset = 8;
+    while(offset + 12 <= length) {
+      std::size_t chunkLength = readBigEndian(contents + offset);
+      const std::uint8_t *chunkType = contents + offset + 4;
+      const std::uint8_t *chunkData = contents + offset + 8;
+      if(chunkLength > length - offset - 12) {
+        return false;
+      }
+      offset += chunkLength + 12;
+
+      // The CRCs of the image data chunks are not checked, the image data is protected
+      // by the Adler-32 checksum zlib verifies when it reaches the end of the stream.
+      // The few bytes in the other chunks that matter are checked.
+      bool isImageData = (std::memcmp(chunkType, u8"IDAT", 4) == 0);
+      if(!isImageData) {
+        std::uint32_t checksum = static_cast<std::uint32_t>(
+          ::crc32(::crc32(0, nullptr, 0), chunkType, static_cast<uInt>(chunkLength + 4))
+        );
+        if(checksum != readBigEndian(chunkData + chunkLength)) {
+          return false;
+        }
+      }
+
+      if(std::memcmp(chunkType, u8"IHDR", 4) == 0) {
+        if(!tryReadHeader(chunkData, chunkLength, header)) {
+          return false;
+        }
+        hasHeader = true;
+      } else if(std::memcmp(chunkType, u8"PLTE", 4) == 0) {
+        std::size_t colorCount = std::min<std::size_t>(chunkLength / 3, 256);
+        for(std::size_t index = 0; index < colorCount; ++index) {
+          const std::uint8_t *color = chunkData + index * 3;
+          palette[index] = qRgb(color[0], color[1], color[2]);
+        }
+      } else if(std::memcmp(chunkType, u8"tRNS", 4) == 0) {
+        if(!hasHeader || (header.ColorType != PaletteColorType)) {
+          return false; // Color key transparency is left to QImage
+        }
+        std::size_t alphaCount = std::min<std::size_t>(chunkLength, 256);
+        for(std::size_t index = 0; index < alphaCount; ++index) {
+          QRgb color = palette[index];
+          palette[index] = qRgba(qRed(color), qGreen(color), qBlue(color), chunkData[index]);
+        }
+        paletteHasAlpha = true;
+      } else if(isImageData) {
+        if(!hasHeader) {
+          return false;
+        }
+
+        // Prepare the target image and the row buffers when the image data begins.
+        // All chunks that affect the pixel format are required to come before it.
+        if(currentRow == nullptr) {
+          // The encoders only write an alpha channel if the image format has one,
+          // so opaque images must not be given a format with alpha
+          bool hasAlpha = (
+            (header.ColorType == RgbaColorType) ||
+            (header.ColorType == GrayscaleAlphaColorType) ||
+            paletteHasAlpha
+          );
+
+          QImage::Format format;
+          if(header.BitDepth == 16) {
+            format = hasAlpha ? QImage::Format_RGBA64 : QImage::Format_RGBX64;
+          } else {
+            format = hasAlpha ? QImage::Format_ARGB32 : QImage::Format_RGB32;
+          }
+
+          bool canReuseImage = (
+            (image.width() == header.Width) &&
+            (image.height() == header.Height) &&
+            (image.format() == format) &&
+            image.isDetached()
+          );
+          if(!canReuseImage) {
+            image = QImage(header.Width, header.Height, format);
+            if(image.isNull()) {
+              return false;
+            }
+          }
+
+          rowLength = static_cast<std::size_t>(header.Width) * header.BytesPerPixel;
+          this->rowBuffer.resize((rowLength + 1) * 2);
+          std::fill(this->rowBuffer.begin(), this->rowBuffer.end(), std::uint8_t(0));
+          currentRow = this->rowBuffer.data();
+          priorRow = currentRow + (rowLength + 1);
+        }
+
+        stream.next_in = const_cast<Bytef *>(chunkData);
+        stream.avail_in = static_cast<uInt>(chunkLength);
+
+        // Inflate into the current row until it is complete, then unfilter it and
+        // write it into the image right away while it is still in the CPU cache.
+        // After the last row, the stream is inflated up to its end, which is where
+        // zlib verifies the checksum, so cut off or corrupted image data is rejected.
+        while(!streamEnded) {
+          bool isPastLastRow = (rowIndex >= header.Height);
+          if(isPastLastRow) {
+            filledByteCount = 0;
+          }
+          stream.next_out = currentRow + filledByteCount;
+          stream.avail_out = static_cast<uInt>(rowLength + 1 - filledByteCount);
+
+          int result = ::inflate(&stream, Z_NO_FLUSH);
+          if(result == Z_STREAM_END) {
+            streamEnded = true;
+          } else if((result != Z_OK) && (result != Z_BUF_ERROR)) {
+            return false;
+          }
+
+          filledByteCount = rowLength + 1 - stream.avail_out;
+          if(isPastLastRow) {
+            if(filledByteCount != 0) {
+              return false; // The stream holds more data than the image
+            }
+            if(stream.avail_in == 0) {
+              break; // zlib needs the next IDAT chunk to reach the end
+            }
+            continue;
+          }
+          if(filledByteCount < rowLength + 1) {
+            break; // zlib needs the next IDAT chunk to continue
+          }
+
+          bool wasUnfiltered = unfilterRow(
+            currentRow[0], currentRow + 1, priorRow + 1, rowLength, header.BytesPerPixel
+          );
+          if(!wasUnfiltered) {
+            return false;
+          }
+
+          if(header.BitDepth == 16) {
+            writeSixteenBitRow(header, currentRow + 1, image.scanLine(rowIndex));
+          } else {
+            writeEightBitRow(header, palette, currentRow + 1, image.scanLine(rowIndex));
+          }
+
+          std::swap(currentRow, priorRow);
+          filledByteCount = 0;
+          ++rowIndex;
+        }
+      } else if(std::memcmp(chunkType, u8"IEND", 4) == 0) {
+        hasEnd = true;
+        break;
+      }
+    }
+
+    // Files cut off anywhere, even after the last row, are left to QImage to deal with
+    return hasHeader && streamEnded && hasEnd && (rowIndex == header.Height);
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+} // namespace Nuclex::FrameFixer::Rendering::ImageFormats
@@ -0,0 +1,100 @@
+#pragma region Apache License 2.0
+/*
+Nuclex Frame Fixer
+Copyright (C) 2024 Markus Ewald / Nuclex Development Labs
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#pragma endregion // Apache License 2.0
+
+#ifndef NUCLEX_FRAMEFIXER_RENDERING_IMAGEFORMATS_PNGIMAGEDECODER_H
+#define NUCLEX_FRAMEFIXER_RENDERING_IMAGEFORMATS_PNGIMAGEDECODER_H
+
+#include "Nuclex/FrameFixer/Config.h"
+
+#include <QImage>
+
+#include <cstddef> // for std::size_t
+#include <cstdint> // for std::uint8_t
+#include <string> // for std::string
+#include <vector> // for std::vector
+
+namespace Nuclex::FrameFixer::Rendering::ImageFormats {
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Loads PNG files straight into the pixel layouts used by the render pipeline</summary>
+  /// <remarks>
+  ///   <para>
+  ///     Loading a PNG file through QImage decodes it into whatever format matches the file
+  ///     (indexed, grayscale, RGBX64 and so on), which the pipeline then has to convert once
+  ///     more. This decoder inflates the image data with zlib and writes each row directly
+  ///     in its final layout as soon as it has been unfiltered: 16 bit files become
+  ///     QImage::Format_RGBA64 or QImage::Format_RGBX64 images and 8 bit files become
+  ///     QImage::Format_ARGB32 or QImage::Format_RGB32 images, depending on whether
+  ///     they have an alpha channel.
+  ///   </para>
+  ///   <para>
+  ///     Only two rows of filtered pixels are held at any time and the buffers for the file
+  ///     contents and rows are kept between calls, so a decoder instance should be reused
+  ///     for consecutive frames. Instances are not thread-safe, each thread needs its own.
+  ///   </para>
+  ///   <para>
+  ///     Interlaced files, bit depths below 8 and color key transparency are not handled.
+  ///     The decoder reports these (and damaged files) by returning false, in which case
+  ///     the caller should fall back to loading the file through QImage.
+  ///   </para>
+  /// </remarks>
+  class PngImageDecoder {
+
+    /// <summary>Initializes a new PNG decoder</summary>
+    public: PngImageDecoder();
+    /// <summary>Frees all resources used by the decoder</summary>
+    public: ~PngImageDecoder();
+
+    /// <summary>Checks whether a path refers to a PNG file by its extension</summary>
+    /// <param name="path">Path that will be checked</param>
+    /// <returns>True if the path ends with a .png extension</returns>
+    public: static bool IsPngPath(const std::string &path);
+
+    /// <summary>Tries to load a PNG file into an image</summary>
+    /// <param name="path">Path of the PNG file that will be loaded</param>
+    /// <param name="image">
+    ///   Image that receives the pixels. If it already has the right size and format and
+    ///   does not share its pixels with another image, it will be decoded into in place.
+    /// </param>
+    /// <returns>True if the file was decoded, false if it has to be loaded another way</returns>
+    public: bool TryDecode(const std::string &path, QImage &image);
+
+    /// <summary>Tries to decode the contents of a PNG file into an image</summary>
+    /// <param name="contents">Contents of the PNG file</param>
+    /// <param name="length">Length of the PNG file in bytes</param>
+    /// <param name="image">
+    ///   Image that receives the pixels. If it already has the right size and format and
+    ///   does not share its pixels with another image, it will be decoded into in place.
+    /// </param>
+    /// <returns>True if the file was decoded, false if it has to be loaded another way</returns>
+    public: bool TryDecode(const std::uint8_t *contents, std::size_t length, QImage &image);
+
+    /// <summary>Contents of the most recently loaded file</summary>
+    private: std::vector<std::uint8_t> fileContents;
+    /// <summary>Current and prior row of filtered pixels, each with its filter byte</summary>
+    private: std::vector<std::uint8_t> rowBuffer;
+
+  };
+
+  // ------------------------------------------------------------------------------------------- //
+
+} // namespace Nuclex::FrameFixer::Rendering::ImageFormats
+
+#endif // NUCLEX_FRAMEFIXER_RENDERING_IMAGEFORMATS_PNGIMAGEDECODER_H
@@ -0,0 +1,402 @@
+#pragma region Apache License 2.0
+/*
+Nuclex Frame Fixer
+Copyright (C) 2024 Markus Ewald / Nuclex Development Labs
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#pragma endregion // Apache License 2.0
+
+
+// If the application is compiled as a DLL, this ensures symbols are exported
+#define NUCLEX_FRAMEFIXER_SOURCE 1
+
+#include "./PngImageEncoder.h"
+
+#include <Nuclex/Support/Text/LexicalAppend.h> // for lexical_append()
+
+#include <zlib.h> // for deflate(), crc32()
+
+#include <cstdlib> // for std::abs()
+#include <stdexcept> // for std::runtime_error
+#include <utility> // for std::swap()
+
+namespace {
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Signature every PNG file begins with</summary>
+  const std::uint8_t PngSignature[8] = { 0x89, 0x50, 0x4E, 0x47, 0x0D, 0x0A, 0x1A, 0x0A };
+
+  /// <summary>Number of bytes of compressed data after which an IDAT chunk is emitted</summary>
+  const std::size_t IdatChunkSize = 256 * 1024;
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Releases a zlib compression stream when it goes out of scope</summary>
+  class DeflateStreamScope {
+
+    /// <summary>Initializes a new zlib stream scope</summary>
+    /// <param name="stream">Stream that will be released when the scope ends</param>
+    public: DeflateStreamScope(z_stream &stream) : stream(stream) {}
+    /// <summary>Releases the zlib stream</summary>
+    public: ~DeflateStreamScope() { ::deflateEnd(&this->stream); }
+
+    /// <summary>Stream that will be released when the scope ends</summary>
+    private: z_stream &stream;
+
+  };
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Appends a 32 bit integer in big endian byte order</summary>
+  /// <param name="target">Buffer the integer will be appended to</param>
+  /// <param name="value">Integer that will be appended</param>
+  void appendBigEndian(std::vector<std::uint8_t> &target, std::uint32_t value) {
+    target.push_back(static_cast<std::uint8_t>(value >> 24));
+    target.push_back(static_cast<std::uint8_t>(value >> 16));
+    target.push_back(static_cast<std::uint8_t>(value >> 8));
+    target.push_back(static_cast<std::uint8_t>(value));
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Appends a complete PNG chunk including its length and checksum</summary>
+  /// <param name="target">Buffer the chunk will be appended to</param>
+  /// <param name="type">Four-character type of the chunk</param>
+  /// <param name="data">Data that will be stored in the chunk</param>
+  /// <param name="length">Number of bytes of data in the chunk</param>
+  void appendChunk(
+    std::vector<std::uint8_t> &target,
+    const char type[4], const std::uint8_t *data, std::size_t length
+  ) {
+    appendBigEndian(target, static_cast<std::uint32_t>(length));
+
+    const std::uint8_t *typeBytes = reinterpret_cast<const std::uint8_t *>(type);
+    target.insert(target.end(), typeBytes, typeBytes + 4);
+
+    uLong checksum = ::crc32(0, typeBytes, 4);
+    if(length > 0) { // zlib returns the initial checksum if it gets a null pointer
+      target.insert(target.end(), data, data + length);
+      checksum = ::crc32(checksum, data, static_cast<uInt>(length));
+    }
+    appendBigEndian(target, static_cast<std::uint32_t>(checksum));
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Predicts a byte from its neighbours the way the Paeth filter does</summary>
+  /// <param name="left">Byte of the pixel to the left</param>
+  /// <param name="above">Byte of the pixel above</param>
+  /// <param name="aboveLeft">Byte of the pixel above and to the left</param>
+  /// <returns>Whichever neighbour is closest to the estimate of the filter</returns>
+  inline std::uint8_t paethPredictor(int left, int above, int aboveLeft) {
+    int estimate = left + above - aboveLeft;
+    int leftDistance = std::abs(estimate - left);
+    int aboveDistance = std::abs(estimate - above);
+    int aboveLeftDistance = std::abs(estimate - aboveLeft);
+
+    if((leftDistance <= aboveDistance) && (leftDistance <= aboveLeftDistance)) {
+      return static_cast<std::uint8_t>(left);
+    } else if(aboveDistance <= aboveLeftDistance) {
+      return static_cast<std::uint8_t>(above);
+    } else {
+      return static_cast<std::uint8_t>(aboveLeft);
+    }
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Applies a PNG filter to a row of pixels</summary>
+  /// <param name="filter">Filter that will be applied, must not be adaptive</param>
+  /// <param name="row">Row of pixels that will be filtered</param>
+  /// <param name="priorRow">Unfiltered row of pixels above, all zeros for the first row</param>
+  /// <param name="rowLength">Length of a row in bytes</param>
+  /// <param name="bytesPerPixel">Number of bytes each pixel occupies</param>
+  /// <param name="target">
+  ///   Receives the filter type followed by the filtered row, must have room for
+  ///   one byte more than the row length
+  /// </param>
+  void filterRow(
+    Nuclex::FrameFixer::Rendering::ImageFormats::PngFilter filter,
+    const std::uint8_t *row, const std::uint8_t *priorRow,
+    std::size_t rowLength, std::size_t bytesPerPixel,
+    std::uint8_t *target
+  ) {
+    using Nuclex::FrameFixer::Rendering::ImageFormats::PngFilter;
+
+    std::uint8_t *filtered = target + 1;
+    switch(filter) {
+      case PngFilter::Sub: {
+        target[0] = 1;
+        for(std::size_t index = 0; index < bytesPerPixel; ++index) {
+          filtered[index] = row[index];
+        }
+        for(std::size_t index = bytesPerPixel; index < rowLength; ++index) {
+          filtered[index] = static_cast<std::uint8_t>(row[index] - row[index - bytesPerPixel]);
+        }
+        break;
+      }
+      case PngFilter::Up: {
+        target[0] = 2;
+        for(std::size_t index = 0; index < rowLength; ++index) {
+          filtered[index] = static_cast<std::uint8_t>(row[index] - priorRow[index]);
+        }
+        break;
+      }
+      case PngFilter::Average: {
+        target[0] = 3;
+        for(std::size_t index = 0; index < bytesPerPixel; ++index) {
+          filtered[index] = static_cast<std::uint8_t>(row[index] - (priorRow[index] >> 1));
+        }
+        for(std::size_t index = bytesPerPixel; index < rowLength; ++index) {
+          int average = (
+            static_cast<int>(row[index - bytesPerPixel]) + static_cast<int>(priorRow[index])
+          ) >> 1;
+          filtered[index] = static_cast<std::uint8_t>(row[index] - average);
+        }
+        break;
+      }
+      case PngFilter::Paeth: {
+        target[0] = 4;
+        for(std::size_t index = 0; index < bytesPerPixel; ++index) {
+          filtered[index] = static_cast<std::uint8_t>(row[index] - priorRow[index]);
+        }
+        for(std::size_t index = bytesPerPixel; index < rowLength; ++index) {
+          std::uint8_t predicted = paethPredictor(
+            row[index - bytesPerPixel], priorRow[index], priorRow[index - bytesPerPixel]
+          );
+          filtered[index] = static_cast<std::uint8_t>(row[index] - predicted);
+        }
+        break;
+      }
+      default: {
+        target[0] = 0;
+        for(std::size_t index = 0; index < rowLength; ++index) {
+          filtered[index] = row[index];
+        }
+        break;
+      }
+    }
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Estimates how well a filtered row will compress</summary>
+  /// <param name="filteredRow">Filtered row, including the leading filter type</param>
+  /// <param name="rowLength">Length of the row in bytes, excluding the filter type</param>
+  /// <returns>The sum of all bytes as signed values, lower values compress better</returns>
+  /// <remarks>
+  ///   This is the heuristic recommended by the PNG specification and used by libpng.
+  /// </remarks>
+  std::size_t estimateCompressibility(const std::uint8_t *filteredRow, std::size_t rowLength) {
+    std::size_t sum = 0;
+    for(std::size_t index = 1; index <= rowLength; ++index) {
+      sum += static_cast<std::size_t>(std::abs(static_cast<std::int8_t>(filteredRow[index])));
+    }
+
+    return sum;
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Returns a human-readable name for a PNG filter</summary>
+  /// <param name="filter">Filter whose name will be returned</param>
+  /// <returns>The name of the specified filter</returns>
+  std::string getFilterName(Nuclex::FrameFixer::Rendering::ImageFormats::PngFilter filter) {
+    using Nuclex::FrameFixer::Rendering::ImageFormats::PngFilter;
+
+    switch(filter) {
+      case PngFilter::None: { return u8"no filter"; }
+      case PngFilter::Sub: { return u8"sub filter"; }
+      case PngFilter::Up: { return u8"up filter"; }
+      case PngFilter::Average: { return u8"average filter"; }
+      case PngFilter::Paeth: { return u8"Paeth filter"; }
+      default: { return u8"adaptive filter"; }
+    }
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+} // anonymous namespace
+
+namespace Nuclex::FrameFixer::Rendering::ImageFormats {
+
+  // ------------------------------------------------------------------------------------------- //
+
+  PngImageEncoder::PngImageEncoder(int compressionLevel, PngFilter filter) :
+    compressionLevel(compressionLevel),
+    filter(filter) {}
+
+  // ------------------------------------------------------------------------------------------- //
+
+  std::string PngImageEncoder::GetName() const {
+    std::string name(u8"PNG images (level ", 18);
+    Nuclex::Support::Text::lexical_append(name, this->compressionLevel);
+    name.append(u8", ", 2);
+    name.append(getFilterName(this->filter));
+    name.append(u8")", 1);
+    return name;
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  std::string PngImageEncoder::GetFileExtension() const {
+    return std::string(u8".png", 4);
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  std::vector<std::uint8_t> PngImageEncoder::Encode(const QImage &image) const {
+    bool isSixteenBit = HasSixteenBitChannels(image);
+    QImage source = isSixteenBit ? ToRgba64(image) : ToRgba8888(image);
+    bool hasAlpha = source.hasAlphaChannel();
+
+    std::size_t width = static_cast<std::size_t>(source.width());
+    std::size_t height = static_cast<std::size_t>(source.height());
+    std::size_t channelCount = hasAlpha ? 4 : 3;
+    std::size_t bytesPerPixel = channelCount * (isSixteenBit ? 2 : 1);
+    std::size_t rowLength = width * bytesPerPixel;
+
+    std::vector<std::uint8_t> contents;
+    contents.reserve(rowLength * height / 2 + 1024);
+    contents.insert(contents.end(), PngSignature, PngSignature + sizeof(PngSignature));
+
+    // Image header with the dimensions and pixel format
+    {
+      std::vector<std::uint8_t> header;
+      appendBigEndian(header, static_cast<std::uint32_t>(width));
+      appendBigEndian(header, static_cast<std::uint32_t>(height));
+      header.push_back(isSixteenBit ? 16 : 8); // bit depth
+      header.push_back(hasAlpha ? 6 : 2); // color type, RGBA or RGB
+      header.push_back(0); // compression method, always deflate
+      header.push_back(0); // filter method, always the five standard filters
+      header.push_back(0); // interlace method, none
+      appendChunk(contents, "IHDR", header.data(), header.size());
+    }
+
+    z_stream stream = z_stream();
+    int result = ::deflateInit2(
+      &stream,
+      this->compressionLevel,
+      Z_DEFLATED,
+      15, // window bits, largest possible window
+      8, // memory level, zlib's default
+      (this->filter == PngFilter::None) ? Z_DEFAULT_STRATEGY : Z_FILTERED
+    );
+    if(result != Z_OK) {
+      throw std::runtime_error(u8"Could not initialize zlib for PNG compression");
+    }
+    DeflateStreamScope streamScope(stream);
+
+    // PNG filters work on the big endian samples as they appear in the file, so each row
+    // is first converted into file order, then filtered, then fed to zlib.
+    std::vector<std::uint8_t> priorRow(rowLength, 0);
+    std::vector<std::uint8_t> currentRow(rowLength);
+    std::vector<std::uint8_t> filteredRow(rowLength + 1);
+    std::vector<std::uint8_t> candidateRow(rowLength + 1);
+    std::vector<std::uint8_t> compressed(IdatChunkSize);
+
+    stream.next_out = compressed.data();
+    stream.avail_out = static_cast<uInt>(compressed.size());
+
+    for(std::size_t y = 0; y < height; ++y) {
+      if(isSixteenBit) {
+        const std::uint16_t *pixels = reinterpret_cast<const std::uint16_t *>(
+          source.constScanLine(static_cast<int>(y))
+        );
+        std::uint8_t *target = currentRow.data();
+        for(std::size_t x = 0; x < width; ++x) {
+          for(std::size_t channel = 0; channel < channelCount; ++channel) {
+            std::uint16_t sample = pixels[x * 4 + channel];
+            target[0] = static_cast<std::uint8_t>(sample >> 8);
+            target[1] = static_cast<std::uint8_t>(sample);
+            target += 2;
+          }
+        }
+      } else {
+        const std::uint8_t *pixels = source.constScanLine(static_cast<int>(y));
+        std::uint8_t *target = currentRow.data();
+        for(std::size_t x = 0; x < width; ++x) {
+          for(std::size_t channel = 0; channel < channelCount; ++channel) {
+            target[channel] = pixels[x * 4 + channel];
+          }
+          target += channelCount;
+        }
+      }
+
+      // Either apply the chosen filter or try all of them and keep the best result
+      if(this->filter == PngFilter::Adaptive) {
+        static const PngFilter candidates[] = {
+          PngFilter::None, PngFilter::Sub, PngFilter::Up, PngFilter::Average, PngFilter::Paeth
+        };
+
+        std::size_t bestScore = static_cast<std::size_t>(-1);
+        for(PngFilter candidate : candidates) {
+          filterRow(
+            candidate, currentRow.data(), priorRow.data(), rowLength, bytesPerPixel,
+            candidateRow.data()
+          );
+          std::size_t score = estimateCompressibility(candidateRow.data(), rowLength);
+          if(score < bestScore) {
+            bestScore = score;
+            std::swap(filteredRow, candidateRow);
+          }
+        }
+      } else {
+        filterRow(
+          this->filter, currentRow.data(), priorRow.data(), rowLength, bytesPerPixel,
+          filteredRow.data()
+        );
+      }
+
+      // Compress the row, emitting an IDAT chunk whenever the output buffer is full
+      stream.next_in = filteredRow.data();
+      stream.avail_in = static_cast<uInt>(filteredRow.size());
+      while(stream.avail_in > 0) {
+        ::deflate(&stream, Z_NO_FLUSH);
+        if(stream.avail_out == 0) {
+          appendChunk(contents, "IDAT", compressed.data(), compressed.size());
+          stream.next_out = compressed.data();
+          stream.avail_out = static_cast<uInt>(compressed.size());
+        }
+      }
+
+      std::swap(priorRow, currentRow);
+    }
+
+    // Flush out whatever zlib is still holding on to
+    for(;;) {
+      result = ::deflate(&stream, Z_FINISH);
+      std::size_t compressedByteCount = compressed.size() - stream.avail_out;
+      if(compressedByteCount > 0) {
+        appendChunk(contents, "IDAT", compressed.data(), compressedByteCount);
+        stream.next_out = compressed.data();
+        stream.avail_out = static_cast<uInt>(compressed.size());
+      }
+      if(result == Z_STREAM_END) {
+        break;
+      }
+      if(result != Z_OK) {
+        throw std::runtime_error(u8"zlib failed to compress PNG image data");
+      }
+    }
+
+    appendChunk(contents, "IEND", nullptr, 0);
+
+    return contents;
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+} // namespace Nuclex::FrameFixer::Rendering::ImageFormats
@@ -0,0 +1,238 @@
+#pragma region Apache License 2.0
+/*
+Nuclex Frame Fixer
+Copyright (C) 2024 Markus Ewald / Nuclex Development Labs
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#pragma endregion // Apache License 2.0
+
+
+// If the application is compiled as a DLL, this ensures symbols are exported
+#define NUCLEX_FRAMEFIXER_SOURCE 1
+
+#include "./QoiImageEncoder.h"
+
+namespace {
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Marks a reference to one of the 64 recently seen colors</summary>
+  const std::uint8_t QoiOpIndex = 0x00;
+
+  /// <summary>Marks a small difference to the previous pixel in all channels</summary>
+  const std::uint8_t QoiOpDiff = 0x40;
+
+  /// <summary>Marks a difference to the previous pixel relative to the green channel</summary>
+  const std::uint8_t QoiOpLuma = 0x80;
+
+  /// <summary>Marks a run of pixels identical to the previous pixel</summary>
+  const std::uint8_t QoiOpRun = 0xC0;
+
+  /// <summary>Marks a pixel stored with all three color channels</summary>
+  const std::uint8_t QoiOpRgb = 0xFE;
+
+  /// <summary>Marks a pixel stored with all three color channels and alpha</summary>
+  const std::uint8_t QoiOpRgba = 0xFF;
+
+  /// <summary>Longest run of identical pixels that can be stored in one run</summary>
+  const std::size_t QoiMaximumRunLength = 62;
+
+  /// <summary>Bytes that end every QOI file</summary>
+  const std::uint8_t QoiEndMarker[8] = { 0, 0, 0, 0, 0, 0, 0, 1 };
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Color of a single pixel</summary>
+  struct QoiPixel {
+
+    /// <summary>Checks whether this pixel has the same color as another pixel</summary>
+    /// <param name="other">Other pixel that will be compared to this one</param>
+    /// <returns>True if both pixels have the same color</returns>
+    public: bool operator ==(const QoiPixel &other) const {
+      return (
+        (this->Red == other.Red) && (this->Green == other.Green) &&
+        (this->Blue == other.Blue) && (this->Alpha == other.Alpha)
+      );
+    }
+
+    /// <summary>Calculates the slot of the pixel in the recently seen colors</summary>
+    /// <returns>The slot the pixel's color is stored in</returns>
+    public: std::size_t GetIndexPosition() const {
+      return (
+        static_cast<std::size_t>(this->Red) * 3 +
+        static_cast<std::size_t>(this->Green) * 5 +
+        static_cast<std::size_t>(this->Blue) * 7 +
+        static_cast<std::size_t>(this->Alpha) * 11
+      ) % 64;
+    }
+
+    /// <summary>Intensity of the pixel's red channel</summary>
+    public: std::uint8_t Red;
+    /// <summary>Intensity of the pixel's green channel</summary>
+    public: std::uint8_t Green;
+    /// <summary>Intensity of the pixel's blue channel</summary>
+    public: std::uint8_t Blue;
+    /// <summary>Opacity of the pixel</summary>
+    public: std::uint8_t Alpha;
+
+  };
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Appends a 32 bit integer in big endian byte order</summary>
+  /// <param name="target">Buffer the integer will be appended to</param>
+  /// <param name="value">Integer that will be appended</param>
+  void appendBigEndian(std::vector<std::uint8_t> &target, std::uint32_t value) {
+    target.push_back(static_cast<std::uint8_t>(value >> 24));
+    target.push_back(static_cast<std::uint8_t>(value >> 16));
+    target.push_back(static_cast<std::uint8_t>(value >> 8));
+    target.push_back(static_cast<std::uint8_t>(value));
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+} // anonymous namespace
+
+namespace Nuclex::FrameFixer::Rendering::ImageFormats {
+
+  // ------------------------------------------------------------------------------------------- //
+
+  std::string QoiImageEncoder::GetName() const {
+    return std::string(u8"QOI images (8 bits per channel)", 31);
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  std::string QoiImageEncoder::GetFileExtension() const {
+    return std::string(u8".qoi", 4);
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  std::vector<std::uint8_t> QoiImageEncoder::Encode(const QImage &image) const {
+    QImage source = ToRgba8888(image);
+    bool hasAlpha = source.hasAlphaChannel();
+
+    std::size_t width = static_cast<std::size_t>(source.width());
+    std::size_t height = static_cast<std::size_t>(source.height());
+    std::size_t channelCount = hasAlpha ? 4 : 3;
+
+    // The worst case is one extra byte per pixel, but that practically never happens
+    std::vector<std::uint8_t> contents;
+    contents.reserve(width * height * channelCount / 2 + 1024);
+
+    contents.push_back('q');
+    contents.push_back('o');
+    contents.push_back('i');
+    contents.push_back('f');
+    appendBigEndian(contents, static_cast<std::uint32_t>(width));
+    appendBigEndian(contents, static_cast<std::uint32_t>(height));
+    contents.push_back(static_cast<std::uint8_t>(channelCount));
+    contents.push_back(0); // sRGB with linear alpha
+
+    QoiPixel recentColors[64] = {};
+    QoiPixel previous = { 0, 0, 0, 255 };
+    std::size_t runLength = 0;
+
+    for(std::size_t y = 0; y < height; ++y) {
+      const std::uint8_t *row = source.constScanLine(static_cast<int>(y));
+      for(std::size_t x = 0; x < width; ++x) {
+        QoiPixel current = {
+          row[x * 4 + 0], row[x * 4 + 1], row[x * 4 + 2],
+          hasAlpha ? row[x * 4 + 3] : std::uint8_t(255)
+        };
+
+        if(current == previous) {
+          ++runLength;
+          if(runLength == QoiMaximumRunLength) {
+            contents.push_back(static_cast<std::uint8_t>(QoiOpRun | (runLength - 1)));
+            runLength = 0;
+          }
+          continue;
+        }
+
+        if(runLength > 0) {
+          contents.push_back(static_cast<std::uint8_t>(QoiOpRun | (runLength - 1)));
+          runLength = 0;
+        }
+
+        std::size_t indexPosition = current.GetIndexPosition();
+        if(recentColors[indexPosition] == current) {
+          contents.push_back(static_cast<std::uint8_t>(QoiOpIndex | indexPosition));
+        } else {
+          recentColors[indexPosition] = current;
+
+          if(current.Alpha == previous.Alpha) {
+            int redDifference = static_cast<std::int8_t>(current.Red - previous.Red);
+            int greenDifference = static_cast<std::int8_t>(current.Green - previous.Green);
+            int blueDifference = static_cast<std::int8_t>(current.Blue - previous.Blue);
+            int redToGreen = redDifference - greenDifference;
+            int blueToGreen = blueDifference - greenDifference;
+
+            bool isSmallDifference = (
+              (redDifference >= -2) && (redDifference <= 1) &&
+              (greenDifference >= -2) && (greenDifference <= 1) &&
+              (blueDifference >= -2) && (blueDifference <= 1)
+            );
+            bool isLumaDifference = (
+              (greenDifference >= -32) && (greenDifference <= 31) &&
+              (redToGreen >= -8) && (redToGreen <= 7) &&
+              (blueToGreen >= -8) && (blueToGreen <= 7)
+            );
+
+            if(isSmallDifference) {
+              contents.push_back(
+                static_cast<std::uint8_t>(
+                  QoiOpDiff |
+                  ((redDifference + 2) << 4) |
+                  ((greenDifference + 2) << 2) |
+                  (blueDifference + 2)
+                )
+              );
+            } else if(isLumaDifference) {
+              contents.push_back(static_cast<std::uint8_t>(QoiOpLuma | (greenDifference + 32)));
+              contents.push_back(
+                static_cast<std::uint8_t>(((redToGreen + 8) << 4) | (blueToGreen + 8))
+              );
+            } else {
+              contents.push_back(QoiOpRgb);
+              contents.push_back(current.Red);
+              contents.push_back(current.Green);
+              contents.push_back(current.Blue);
+            }
+          } else {
+            contents.push_back(QoiOpRgba);
+            contents.push_back(current.Red);
+            contents.push_back(current.Green);
+            contents.push_back(current.Blue);
+            contents.push_back(current.Alpha);
+          }
+        }
+
+        previous = current;
+      }
+    }
+
+    if(runLength > 0) {
+      contents.push_back(static_cast<std::uint8_t>(QoiOpRun | (runLength - 1)));
+    }
+
+    contents.insert(contents.end(), QoiEndMarker, QoiEndMarker + sizeof(QoiEndMarker));
+
+    return contents;
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+} // namespace Nuclex::FrameFixer::Rendering::ImageFormats
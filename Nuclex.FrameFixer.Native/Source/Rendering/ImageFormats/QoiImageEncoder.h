@@ -0,0 +1,69 @@
+#pragma region Apache License 2.0
+/*
+Nuclex Frame Fixer
+Copyright (C) 2024 Markus Ewald / Nuclex Development Labs
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#pragma endregion // Apache License 2.0
+
+#ifndef NUCLEX_FRAMEFIXER_RENDERING_IMAGEFORMATS_QOIIMAGEENCODER_H
+#define NUCLEX_FRAMEFIXER_RENDERING_IMAGEFORMATS_QOIIMAGEENCODER_H
+
+#include "Nuclex/FrameFixer/Config.h"
+#include "./ImageEncoder.h"
+
+namespace Nuclex::FrameFixer::Rendering::ImageFormats {
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Saves images in the "Quite OK Image" format</summary>
+  /// <remarks>
+  ///   <para>
+  ///     QOI is a very simple lossless format that encodes each pixel as a run, a reference
+  ///     to a recently seen color or a small difference to the previous pixel. Encoding is
+  ///     many times faster than PNG while the files typically end up only slightly larger,
+  ///     which makes it a good intermediate format. ffmpeg can read QOI files directly.
+  ///   </para>
+  ///   <para>
+  ///     The format only supports 8 bits per channel, so 16 bit frames lose precision.
+  ///     Use PNG or TIFF if the full color depth has to be preserved.
+  ///   </para>
+  /// </remarks>
+  class QoiImageEncoder : public ImageEncoder {
+
+    /// <summary>Initializes a new QOI encoder</summary>
+    public: QoiImageEncoder() = default;
+    /// <summary>Frees all resources used by the encoder</summary>
+    public: ~QoiImageEncoder() override = default;
+
+    /// <summary>Returns a name by which the image format can be displayed</summary>
+    /// <returns>A short, human-readable name for the image format and its settings</returns>
+    public: std::string GetName() const override;
+
+    /// <summary>Returns the file extension used for images in this format</summary>
+    /// <returns>The file extension, including the leading dot</returns>
+    public: std::string GetFileExtension() const override;
+
+    /// <summary>Encodes an image into the contents of an image file</summary>
+    /// <param name="image">Image that will be encoded</param>
+    /// <returns>The bytes that make up the image file</returns>
+    public: std::vector<std::uint8_t> Encode(const QImage &image) const override;
+
+  };
+
+  // ------------------------------------------------------------------------------------------- //
+
+} // namespace Nuclex::FrameFixer::Rendering::ImageFormats
+
+#endif // NUCLEX_FRAMEFIXER_RENDERING_IMAGEFORMATS_QOIIMAGEENCODER_H
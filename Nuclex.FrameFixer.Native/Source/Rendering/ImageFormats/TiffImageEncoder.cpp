@@ -0,0 +1,199 @@
+#pragma region Apache License 2.0
+/*
+Nuclex Frame Fixer
+Copyright (C) 2024 Markus Ewald / Nuclex Development Labs
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#pragma endregion // Apache License 2.0
+
+
+// If the application is compiled as a DLL, this ensures symbols are exported
+#define NUCLEX_FRAMEFIXER_SOURCE 1
+
+#include "./TiffImageEncoder.h"
+#include "../PixelConversion.h"
+
+#include <cstring> // for std::memcpy()
+
+namespace {
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Data type of TIFF tag values that are 16 bit integers</summary>
+  const std::uint16_t TiffShort = 3;
+
+  /// <summary>Data type of TIFF tag values that are 32 bit integers</summary>
+  const std::uint16_t TiffLong = 4;
+
+  /// <summary>Size of the TIFF file header in bytes</summary>
+  const std::size_t TiffHeaderSize = 8;
+
+  /// <summary>Size of a single entry in a TIFF image file directory</summary>
+  const std::size_t TiffDirectoryEntrySize = 12;
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Appends an integer in the platform's native byte order</summary>
+  /// <typeparam name="TInteger">Type of integer that will be appended</typeparam>
+  /// <param name="target">Buffer the integer will be appended to</param>
+  /// <param name="value">Integer that will be appended</param>
+  template<typename TInteger>
+  void appendNative(std::vector<std::uint8_t> &target, TInteger value) {
+    std::size_t offset = target.size();
+    target.resize(offset + sizeof(value));
+    std::memcpy(target.data() + offset, &value, sizeof(value));
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Appends an entry to a TIFF image file directory</summary>
+  /// <param name="target">Buffer the entry will be appended to</param>
+  /// <param name="tag">Tag that identifies the entry</param>
+  /// <param name="type">Data type of the entry's value</param>
+  /// <param name="count">Number of values stored in the entry</param>
+  /// <param name="value">
+  ///   The value itself if there is a single one, otherwise the offset of the values
+  /// </param>
+  void appendDirectoryEntry(
+    std::vector<std::uint8_t> &target,
+    std::uint16_t tag, std::uint16_t type, std::uint32_t count, std::uint32_t value
+  ) {
+    appendNative(target, tag);
+    appendNative(target, type);
+    appendNative(target, count);
+    // A single short value is stored in the first two bytes of the field,
+    // offsets to several values are always stored as 32 bit integers
+    if((type == TiffShort) && (count == 1)) {
+      appendNative(target, static_cast<std::uint16_t>(value));
+      appendNative(target, std::uint16_t(0));
+    } else {
+      appendNative(target, value);
+    }
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+} // anonymous namespace
+
+namespace Nuclex::FrameFixer::Rendering::ImageFormats {
+
+  // ------------------------------------------------------------------------------------------- //
+
+  std::string TiffImageEncoder::GetName() const {
+    return std::string(u8"TIFF images (uncompressed)", 26);
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  std::string TiffImageEncoder::GetFileExtension() const {
+    return std::string(u8".tif", 4);
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  std::vector<std::uint8_t> TiffImageEncoder::Encode(const QImage &image) const {
+    bool isSixteenBit = HasSixteenBitChannels(image);
+    QImage source = isSixteenBit ? ToRgba64(image) : ToRgba8888(image);
+    bool hasAlpha = source.hasAlphaChannel();
+
+    std::size_t width = static_cast<std::size_t>(source.width());
+    std::size_t height = static_cast<std::size_t>(source.height());
+    std::size_t channelCount = hasAlpha ? 4 : 3;
+    std::size_t bytesPerChannel = isSixteenBit ? 2 : 1;
+    std::size_t rowLength = width * channelCount * bytesPerChannel;
+
+    // The file is laid out as header, image file directory, bits per sample array
+    // and finally the pixels, all in one strip.
+    std::size_t directoryEntryCount = hasAlpha ? 11 : 10;
+    std::size_t directorySize = 2 + directoryEntryCount * TiffDirectoryEntrySize + 4;
+    std::size_t bitsPerSampleOffset = TiffHeaderSize + directorySize;
+    std::size_t pixelOffset = bitsPerSampleOffset + channelCount * 2;
+    std::size_t pixelByteCount = rowLength * height;
+
+    std::vector<std::uint8_t> contents;
+    contents.reserve(pixelOffset + pixelByteCount);
+
+#if defined(NUCLEX_FRAMEFIXER_LITTLE_ENDIAN)
+    contents.push_back('I');
+    contents.push_back('I');
+#else
+    contents.push_back('M');
+    contents.push_back('M');
+#endif
+    appendNative(contents, std::uint16_t(42));
+    appendNative(contents, static_cast<std::uint32_t>(TiffHeaderSize));
+
+    // Image file directory, the tags must appear in ascending order
+    appendNative(contents, static_cast<std::uint16_t>(directoryEntryCount));
+    appendDirectoryEntry(contents, 256, TiffLong, 1, static_cast<std::uint32_t>(width));
+    appendDirectoryEntry(contents, 257, TiffLong, 1, static_cast<std::uint32_t>(height));
+    appendDirectoryEntry( // BitsPerSample
+      contents, 258, TiffShort,
+      static_cast<std::uint32_t>(channelCount), static_cast<std::uint32_t>(bitsPerSampleOffset)
+    );
+    appendDirectoryEntry(contents, 259, TiffShort, 1, 1); // Compression: none
+    appendDirectoryEntry(contents, 262, TiffShort, 1, 2); // PhotometricInterpretation: RGB
+    appendDirectoryEntry( // StripOffsets
+      contents, 273, TiffLong, 1, static_cast<std::uint32_t>(pixelOffset)
+    );
+    appendDirectoryEntry( // SamplesPerPixel
+      contents, 277, TiffShort, 1, static_cast<std::uint32_t>(channelCount)
+    );
+    appendDirectoryEntry( // RowsPerStrip
+      contents, 278, TiffLong, 1, static_cast<std::uint32_t>(height)
+    );
+    appendDirectoryEntry( // StripByteCounts
+      contents, 279, TiffLong, 1, static_cast<std::uint32_t>(pixelByteCount)
+    );
+    appendDirectoryEntry(contents, 284, TiffShort, 1, 1); // PlanarConfiguration: chunky
+    if(hasAlpha) {
+      appendDirectoryEntry(contents, 338, TiffShort, 1, 2); // ExtraSamples: straight alpha
+    }
+    appendNative(contents, std::uint32_t(0)); // No further image file directories
+
+    for(std::size_t channel = 0; channel < channelCount; ++channel) {
+      appendNative(contents, static_cast<std::uint16_t>(bytesPerChannel * 8));
+    }
+
+    // Pixels. With alpha, the rows are already in the right layout, otherwise the alpha
+    // (or rather, unused X) channel needs to be dropped from each pixel.
+    contents.resize(pixelOffset + pixelByteCount);
+    std::uint8_t *target = contents.data() + pixelOffset;
+    for(std::size_t y = 0; y < height; ++y) {
+      const std::uint8_t *row = source.constScanLine(static_cast<int>(y));
+      if(hasAlpha) {
+        std::memcpy(target, row, rowLength);
+      } else if(isSixteenBit) {
+        PixelConversion::Rgba64ToRgb48(
+          reinterpret_cast<const std::uint16_t *>(row),
+          reinterpret_cast<std::uint16_t *>(target),
+          width
+        );
+      } else {
+        for(std::size_t x = 0; x < width; ++x) {
+          target[x * 3 + 0] = row[x * 4 + 0];
+          target[x * 3 + 1] = row[x * 4 + 1];
+          target[x * 3 + 2] = row[x * 4 + 2];
+        }
+      }
+
+      target += rowLength;
+    }
+
+    return contents;
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+} // namespace Nuclex::FrameFixer::Rendering::ImageFormats
@@ -0,0 +1,70 @@
+#pragma region Apache License 2.0
+/*
+Nuclex Frame Fixer
+Copyright (C) 2024 Markus Ewald / Nuclex Development Labs
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#pragma endregion // Apache License 2.0
+
+#ifndef NUCLEX_FRAMEFIXER_RENDERING_IMAGEFORMATS_TIFFIMAGEENCODER_H
+#define NUCLEX_FRAMEFIXER_RENDERING_IMAGEFORMATS_TIFFIMAGEENCODER_H
+
+#include "Nuclex/FrameFixer/Config.h"
+#include "./ImageEncoder.h"
+
+namespace Nuclex::FrameFixer::Rendering::ImageFormats {
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Saves images as uncompressed TIFF files</summary>
+  /// <remarks>
+  ///   <para>
+  ///     Uncompressed TIFF files are several times larger than PNG files, but writing them
+  ///     is little more than copying the pixels, so they are the fastest choice when disk
+  ///     space is plentiful and the frames are only an intermediate step on the way to
+  ///     a video encoder. ffmpeg, ImageMagick and all common image editors can read them.
+  ///   </para>
+  ///   <para>
+  ///     Files are written in the platform's native byte order so the pixels can be
+  ///     copied as they are. 16 bit images stay 16 bit and the alpha channel is only
+  ///     stored if the image has one.
+  ///   </para>
+  /// </remarks>
+  class TiffImageEncoder : public ImageEncoder {
+
+    /// <summary>Initializes a new TIFF encoder</summary>
+    public: TiffImageEncoder() = default;
+    /// <summary>Frees all resources used by the encoder</summary>
+    public: ~TiffImageEncoder() override = default;
+
+    /// <summary>Returns a name by which the image format can be displayed</summary>
+    /// <returns>A short, human-readable name for the image format and its settings</returns>
+    public: std::string GetName() const override;
+
+    /// <summary>Returns the file extension used for images in this format</summary>
+    /// <returns>The file extension, including the leading dot</returns>
+    public: std::string GetFileExtension() const override;
+
+    /// <summary>Encodes an image into the contents of an image file</summary>
+    /// <param name="image">Image that will be encoded</param>
+    /// <returns>The bytes that make up the image file</returns>
+    public: std::vector<std::uint8_t> Encode(const QImage &image) const override;
+
+  };
+
+  // ------------------------------------------------------------------------------------------- //
+
+} // namespace Nuclex::FrameFixer::Rendering::ImageFormats
+
+#endif // NUCLEX_FRAMEFIXER_RENDERING_IMAGEFORMATS_TIFFIMAGEENCODER_H
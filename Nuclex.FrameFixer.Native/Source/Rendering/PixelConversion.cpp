@@ -0,0 +1,1117 @@
+#pragma region Apache License 2.0
+/*
+Nuclex Frame Fixer
+Copyright (C) 2024 Markus Ewald / Nuclex Development Labs
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#pragma endregion // Apache License 2.0
+
+// If the application is compiled as a DLL, this ensures symbols are exported
+#define NUCLEX_FRAMEFIXER_SOURCE 1
+
+#include "./PixelConversion.h"
+#include "../Platform/CpuFeatures.h"
+
+#if defined(NUCLEX_FRAMEFIXER_HAVE_SSE2)
+  #include <emmintrin.h> // for SSE2 intrinsics
+#endif
+#if defined(NUCLEX_FRAMEFIXER_HAVE_AVX2)
+  #include <immintrin.h> // for AVX2 intrinsics
+#endif
+
+namespace {
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Weight of the red channel in the BT.709 luma calculation</summary>
+  constexpr float RedWeight = 0.2126f;
+  /// <summary>Weight of the green channel in the BT.709 luma calculation</summary>
+  constexpr float GreenWeight = 0.7152f;
+  /// <summary>Weight of the blue channel in the BT.709 luma calculation</summary>
+  constexpr float BlueWeight = 0.0722f;
+
+  /// <summary>Scale from full range 16 bit values to limited range luma values</summary>
+  constexpr float LumaScale = 56064.0f / 65535.0f; // (235 - 16) << 8
+  /// <summary>Offset of limited range 16 bit luma values</summary>
+  constexpr float LumaOffset = 4096.0f; // 16 << 8
+  /// <summary>Scale from full range 16 bit values to limited range chroma values</summary>
+  constexpr float ChromaScale = 57344.0f / 65535.0f; // (240 - 16) << 8
+  /// <summary>Offset of 16 bit chroma values (their zero point)</summary>
+  constexpr float ChromaOffset = 32768.0f;
+
+  // Coefficients of the complete RGB to Y'CbCr matrix, including the range scaling.
+  // Cb = (B - Y) / (2 * (1 - Kb)), Cr = (R - Y) / (2 * (1 - Kr))
+
+  constexpr float YR = RedWeight * LumaScale;
+  constexpr float YG = GreenWeight * LumaScale;
+  constexpr float YB = BlueWeight * LumaScale;
+  constexpr float CbR = -RedWeight / (2.0f * (1.0f - BlueWeight)) * ChromaScale;
+  constexpr float CbG = -GreenWeight / (2.0f * (1.0f - BlueWeight)) * ChromaScale;
+  constexpr float CbB = 0.5f * ChromaScale;
+  constexpr float CrR = 0.5f * ChromaScale;
+  constexpr float CrG = -GreenWeight / (2.0f * (1.0f - RedWeight)) * ChromaScale;
+  constexpr float CrB = -BlueWeight / (2.0f * (1.0f - RedWeight)) * ChromaScale;
+
+  // Coefficients of the inverse matrix, applied after the offsets have been subtracted.
+  // R = Y + 2 * (1 - Kr) * Cr, B = Y + 2 * (1 - Kb) * Cb and G from the luma weights.
+
+  constexpr float RY = 1.0f / LumaScale;
+  constexpr float RCr = 2.0f * (1.0f - RedWeight) / ChromaScale;
+  constexpr float GCb = -2.0f * BlueWeight * (1.0f - BlueWeight) / GreenWeight / ChromaScale;
+  constexpr float GCr = -2.0f * RedWeight * (1.0f - RedWeight) / GreenWeight / ChromaScale;
+  constexpr float BCb = 2.0f * (1.0f - BlueWeight) / ChromaScale;
+
+  // ------------------------------------------------------------------------------------------- //
+
+#if defined(NUCLEX_FRAMEFIXER_HAVE_SSE2)
+  /// <summary>Packs four 32 bit integers into four unsigned 16 bit integers</summary>
+  /// <param name="values">Values that will be packed, must be in the range 0-65535</param>
+  /// <returns>The packed values in the lower 64 bits of the register</returns>
+  /// <remarks>
+  ///   SSE2 only has a signed saturating pack, so the values are moved into
+  ///   the signed range before packing and moved back afterwards.
+  /// </remarks>
+  inline __m128i packUnsigned16(__m128i values) {
+    const __m128i bias32 = _mm_set1_epi32(32768);
+    const __m128i bias16 = _mm_set1_epi16(-32768);
+
+    values = _mm_sub_epi32(values, bias32);
+    values = _mm_packs_epi32(values, values);
+    return _mm_xor_si128(values, bias16);
+  }
+#endif // defined(NUCLEX_FRAMEFIXER_HAVE_SSE2)
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Converts a float into an unsigned 16 bit integer, clamping and rounding it</summary>
+  /// <param name="value">Value that will be converted</param>
+  /// <returns>The value as a 16 bit integer</returns>
+  /// <remarks>
+  ///   The SIMD kernels clamp after adding the rounding offset, too, so that all code paths
+  ///   produce identical results.
+  /// </remarks>
+  inline std::uint16_t clampToUnsigned16(float value) {
+    value += 0.5f;
+    if(value <= 0.0f) {
+      return 0;
+    } else if(value >= 65535.0f) {
+      return 65535;
+    } else {
+      return static_cast<std::uint16_t>(value);
+    }
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Expands an 8 bit channel value to 16 bits</summary>
+  /// <param name="value">Value that will be expanded</param>
+  /// <returns>The equivalent 16 bit value</returns>
+  inline std::uint16_t expandTo16Bits(std::uint8_t value) {
+    return static_cast<std::uint16_t>(value) * 257; // same as (value << 8) | value
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Reduces a 16 bit channel value to 8 bits, rounding to nearest</summary>
+  /// <param name="value">Value that will be reduced</param>
+  /// <returns>The equivalent 8 bit value</returns>
+  /// <remarks>
+  ///   This is a division by 257 with rounding, exactly as Qt does it. The SIMD
+  ///   kernels use the same formula so all code paths produce identical results.
+  /// </remarks>
+  inline std::uint32_t reduceTo8Bits(std::uint16_t value) {
+    return (static_cast<std::uint32_t>(value) - (value >> 8) + 0x80) >> 8;
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+#if defined(NUCLEX_FRAMEFIXER_HAVE_SSE2)
+  /// <summary>Interleaves one register per channel into eight RGBA pixels</summary>
+  /// <param name="red">Red values of eight pixels</param>
+  /// <param name="green">Green values of eight pixels</param>
+  /// <param name="blue">Blue values of eight pixels</param>
+  /// <param name="alpha">Alpha values of eight pixels</param>
+  /// <param name="target">Receives the eight pixels with four 16 bit channels each</param>
+  inline void storeInterleaved(
+    __m128i red, __m128i green, __m128i blue, __m128i alpha, std::uint16_t *target
+  ) {
+    // R0 G0 R1 G1 R2 G2 R3 G3 and B0 A0 B1 A1 B2 A2 B3 A3 (plus the same for pixels 4-7)
+    __m128i redGreen0123 = _mm_unpacklo_epi16(red, green);
+    __m128i redGreen4567 = _mm_unpackhi_epi16(red, green);
+    __m128i blueAlpha0123 = _mm_unpacklo_epi16(blue, alpha);
+    __m128i blueAlpha4567 = _mm_unpackhi_epi16(blue, alpha);
+
+    // Pairs of 32 bit RG and BA values then form complete pixels
+    __m128i *targetVector = reinterpret_cast<__m128i *>(target);
+    _mm_storeu_si128(targetVector, _mm_unpacklo_epi32(redGreen0123, blueAlpha0123));
+    _mm_storeu_si128(targetVector + 1, _mm_unpackhi_epi32(redGreen0123, blueAlpha0123));
+    _mm_storeu_si128(targetVector + 2, _mm_unpacklo_epi32(redGreen4567, blueAlpha4567));
+    _mm_storeu_si128(targetVector + 3, _mm_unpackhi_epi32(redGreen4567, blueAlpha4567));
+  }
+#endif // defined(NUCLEX_FRAMEFIXER_HAVE_SSE2)
+
+  // ------------------------------------------------------------------------------------------- //
+
+#if defined(NUCLEX_FRAMEFIXER_HAVE_SSE2)
+  /// <summary>Converts the YUV values of four pixels into RGB values</summary>
+  /// <param name="luma">Luma values of four pixels as 32 bit integers</param>
+  /// <param name="blueDifference">Cb values of four pixels as 32 bit integers</param>
+  /// <param name="redDifference">Cr values of four pixels as 32 bit integers</param>
+  /// <param name="red">Receives the red values, packed into the lower 64 bits</param>
+  /// <param name="green">Receives the green values, packed into the lower 64 bits</param>
+  /// <param name="blue">Receives the blue values, packed into the lower 64 bits</param>
+  inline void convertYuvToRgb(
+    __m128i luma, __m128i blueDifference, __m128i redDifference,
+    __m128i &red, __m128i &green, __m128i &blue
+  ) {
+    const __m128 half = _mm_set1_ps(0.5f);
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 maximum = _mm_set1_ps(65535.0f);
+
+    __m128 y = _mm_mul_ps(
+      _mm_sub_ps(_mm_cvtepi32_ps(luma), _mm_set1_ps(LumaOffset)), _mm_set1_ps(RY)
+    );
+    __m128 cb = _mm_sub_ps(_mm_cvtepi32_ps(blueDifference), _mm_set1_ps(ChromaOffset));
+    __m128 cr = _mm_sub_ps(_mm_cvtepi32_ps(redDifference), _mm_set1_ps(ChromaOffset));
+
+    // Same order of operations as in the scalar code, so the results are identical
+    __m128 r = _mm_add_ps(_mm_add_ps(y, _mm_mul_ps(cr, _mm_set1_ps(RCr))), half);
+    __m128 g = _mm_add_ps(
+      _mm_add_ps(
+        _mm_add_ps(y, _mm_mul_ps(cb, _mm_set1_ps(GCb))), _mm_mul_ps(cr, _mm_set1_ps(GCr))
+      ),
+      half
+    );
+    __m128 b = _mm_add_ps(_mm_add_ps(y, _mm_mul_ps(cb, _mm_set1_ps(BCb))), half);
+
+    red = packUnsigned16(_mm_cvttps_epi32(_mm_min_ps(_mm_max_ps(r, zero), maximum)));
+    green = packUnsigned16(_mm_cvttps_epi32(_mm_min_ps(_mm_max_ps(g, zero), maximum)));
+    blue = packUnsigned16(_mm_cvttps_epi32(_mm_min_ps(_mm_max_ps(b, zero), maximum)));
+  }
+#endif // defined(NUCLEX_FRAMEFIXER_HAVE_SSE2)
+
+  // ------------------------------------------------------------------------------------------- //
+
+#if defined(NUCLEX_FRAMEFIXER_HAVE_SSE2)
+  /// <summary>Reduces the 16 bit channels of two RGBA pixels to 8 bits in BGRA order</summary>
+  /// <param name="pixels">Two pixels with four 16 bit channels each</param>
+  /// <returns>The reduced channels, still in 16 bit lanes, ready to be packed</returns>
+  inline __m128i reduceTo8BitsBgra(__m128i pixels) {
+    __m128i reduced = _mm_srli_epi16(
+      _mm_add_epi16(
+        _mm_sub_epi16(pixels, _mm_srli_epi16(pixels, 8)), _mm_set1_epi16(0x80)
+      ),
+      8
+    );
+
+    // Swap red and blue. A QRgb in memory is B, G, R, A on little endian systems.
+    reduced = _mm_shufflelo_epi16(reduced, _MM_SHUFFLE(3, 0, 1, 2));
+    return _mm_shufflehi_epi16(reduced, _MM_SHUFFLE(3, 0, 1, 2));
+  }
+#endif // defined(NUCLEX_FRAMEFIXER_HAVE_SSE2)
+
+  // ------------------------------------------------------------------------------------------- //
+
+#if defined(NUCLEX_FRAMEFIXER_HAVE_SSE2)
+  /// <summary>Expands two BGRA pixels with 8 bit channels to RGBA with 16 bit channels</summary>
+  /// <param name="pixels">Register whose lower 8 bytes hold the two QRgb pixels</param>
+  /// <returns>The two pixels with four 16 bit channels each</returns>
+  inline __m128i expandTo16BitsRgba(__m128i pixels) {
+    __m128i expanded = _mm_unpacklo_epi8(pixels, pixels); // (value << 8) | value
+    expanded = _mm_shufflelo_epi16(expanded, _MM_SHUFFLE(3, 0, 1, 2));
+    return _mm_shufflehi_epi16(expanded, _MM_SHUFFLE(3, 0, 1, 2));
+  }
+#endif // defined(NUCLEX_FRAMEFIXER_HAVE_SSE2)
+
+  // ------------------------------------------------------------------------------------------- //
+
+#if defined(NUCLEX_FRAMEFIXER_HAVE_AVX2)
+  /// <summary>Interleaves one register per channel into sixteen RGBA pixels</summary>
+  /// <param name="red">Red values of sixteen pixels</param>
+  /// <param name="green">Green values of sixteen pixels</param>
+  /// <param name="blue">Blue values of sixteen pixels</param>
+  /// <param name="alpha">Alpha values of sixteen pixels</param>
+  /// <param name="target">Receives the sixteen pixels with four 16 bit channels each</param>
+  NUCLEX_FRAMEFIXER_AVX2_FUNCTION inline void storeInterleavedAvx2(
+    __m256i red, __m256i green, __m256i blue, __m256i alpha, std::uint16_t *target
+  ) {
+    // AVX2 unpacks within each 128 bit lane, so the lower lane works on pixels 0-7
+    // and the upper lane on pixels 8-15, exactly like two SSE2 registers would
+    __m256i redGreenLow = _mm256_unpacklo_epi16(red, green);
+    __m256i redGreenHigh = _mm256_unpackhi_epi16(red, green);
+    __m256i blueAlphaLow = _mm256_unpacklo_epi16(blue, alpha);
+    __m256i blueAlphaHigh = _mm256_unpackhi_epi16(blue, alpha);
+
+    __m256i pixels01And89 = _mm256_unpacklo_epi32(redGreenLow, blueAlphaLow);
+    __m256i pixels23And1011 = _mm256_unpackhi_epi32(redGreenLow, blueAlphaLow);
+    __m256i pixels45And1213 = _mm256_unpacklo_epi32(redGreenHigh, blueAlphaHigh);
+    __m256i pixels67And1415 = _mm256_unpackhi_epi32(redGreenHigh, blueAlphaHigh);
+
+    // Now gather the lanes so the pixels are written in order
+    __m256i *targetVector = reinterpret_cast<__m256i *>(target);
+    _mm256_storeu_si256(
+      targetVector, _mm256_permute2x128_si256(pixels01And89, pixels23And1011, 0x20)
+    );
+    _mm256_storeu_si256(
+      targetVector + 1, _mm256_permute2x128_si256(pixels45And1213, pixels67And1415, 0x20)
+    );
+    _mm256_storeu_si256(
+      targetVector + 2, _mm256_permute2x128_si256(pixels01And89, pixels23And1011, 0x31)
+    );
+    _mm256_storeu_si256(
+      targetVector + 3, _mm256_permute2x128_si256(pixels45And1213, pixels67And1415, 0x31)
+    );
+  }
+#endif // defined(NUCLEX_FRAMEFIXER_HAVE_AVX2)
+
+  // ------------------------------------------------------------------------------------------- //
+
+#if defined(NUCLEX_FRAMEFIXER_HAVE_AVX2)
+  /// <summary>Interleaves planar 16 bit GBRA channels using AVX2</summary>
+  /// <param name="green">Green channel with one 16 bit value per pixel</param>
+  /// <param name="blue">Blue channel with one 16 bit value per pixel</param>
+  /// <param name="red">Red channel with one 16 bit value per pixel</param>
+  /// <param name="alpha">Alpha channel with one 16 bit value per pixel</param>
+  /// <param name="target">Receives the pixels with four 16 bit channels each</param>
+  /// <param name="pixelCount">Number of pixels that should be converted</param>
+  /// <returns>The number of pixels that have been converted</returns>
+  NUCLEX_FRAMEFIXER_AVX2_FUNCTION std::size_t gbrap16ToRgba64Avx2(
+    const std::uint16_t *green,
+    const std::uint16_t *blue,
+    const std::uint16_t *red,
+    const std::uint16_t *alpha,
+    std::uint16_t *target,
+    std::size_t pixelCount
+  ) {
+    std::size_t pixelIndex = 0;
+    for(; pixelIndex + 16 <= pixelCount; pixelIndex += 16) {
+      storeInterleavedAvx2(
+        _mm256_loadu_si256(reinterpret_cast<const __m256i *>(red + pixelIndex)),
+        _mm256_loadu_si256(reinterpret_cast<const __m256i *>(green + pixelIndex)),
+        _mm256_loadu_si256(reinterpret_cast<const __m256i *>(blue + pixelIndex)),
+        _mm256_loadu_si256(reinterpret_cast<const __m256i *>(alpha + pixelIndex)),
+        target + pixelIndex * 4
+      );
+    }
+
+    return pixelIndex;
+  }
+#endif // defined(NUCLEX_FRAMEFIXER_HAVE_AVX2)
+
+  // ------------------------------------------------------------------------------------------- //
+
+#if defined(NUCLEX_FRAMEFIXER_HAVE_AVX2)
+  /// <summary>Loads sixteen 8 bit channel values and expands them to 16 bits</summary>
+  /// <param name="values">Address of the first channel value</param>
+  /// <returns>The sixteen channel values expanded to 16 bits</returns>
+  NUCLEX_FRAMEFIXER_AVX2_FUNCTION inline __m256i loadExpandedAvx2(const std::uint8_t *values) {
+    __m256i widened = _mm256_cvtepu8_epi16(
+      _mm_loadu_si128(reinterpret_cast<const __m128i *>(values))
+    );
+    return _mm256_or_si256(widened, _mm256_slli_epi16(widened, 8));
+  }
+#endif // defined(NUCLEX_FRAMEFIXER_HAVE_AVX2)
+
+  // ------------------------------------------------------------------------------------------- //
+
+#if defined(NUCLEX_FRAMEFIXER_HAVE_AVX2)
+  /// <summary>Interleaves planar 8 bit GBRA channels into 16 bit pixels using AVX2</summary>
+  /// <param name="green">Green channel with one 8 bit value per pixel</param>
+  /// <param name="blue">Blue channel with one 8 bit value per pixel</param>
+  /// <param name="red">Red channel with one 8 bit value per pixel</param>
+  /// <param name="alpha">Alpha channel with one 8 bit value per pixel</param>
+  /// <param name="target">Receives the pixels with four 16 bit channels each</param>
+  /// <param name="pixelCount">Number of pixels that should be converted</param>
+  /// <returns>The number of pixels that have been converted</returns>
+  NUCLEX_FRAMEFIXER_AVX2_FUNCTION std::size_t gbrap8ToRgba64Avx2(
+    const std::uint8_t *green,
+    const std::uint8_t *blue,
+    const std::uint8_t *red,
+    const std::uint8_t *alpha,
+    std::uint16_t *target,
+    std::size_t pixelCount
+  ) {
+    std::size_t pixelIndex = 0;
+    for(; pixelIndex + 16 <= pixelCount; pixelIndex += 16) {
+      storeInterleavedAvx2(
+        loadExpandedAvx2(red + pixelIndex),
+        loadExpandedAvx2(green + pixelIndex),
+        loadExpandedAvx2(blue + pixelIndex),
+        loadExpandedAvx2(alpha + pixelIndex),
+        target + pixelIndex * 4
+      );
+    }
+
+    return pixelIndex;
+  }
+#endif // defined(NUCLEX_FRAMEFIXER_HAVE_AVX2)
+
+  // ------------------------------------------------------------------------------------------- //
+
+#if defined(NUCLEX_FRAMEFIXER_HAVE_AVX2)
+  /// <summary>Reduces 16 bit RGBA pixels to 8 bit QRgb pixels using AVX2</summary>
+  /// <param name="source">Pixels with four 16 bit channels each</param>
+  /// <param name="target">Receives the pixels as 0xAARRGGBB integers</param>
+  /// <param name="pixelCount">Number of pixels that should be converted</param>
+  /// <returns>The number of pixels that have been converted</returns>
+  NUCLEX_FRAMEFIXER_AVX2_FUNCTION std::size_t rgba64ToArgb32Avx2(
+    const std::uint16_t *source, std::uint32_t *target, std::size_t pixelCount
+  ) {
+    const __m256i roundingOffset = _mm256_set1_epi16(0x80);
+
+    std::size_t pixelIndex = 0;
+    for(; pixelIndex + 8 <= pixelCount; pixelIndex += 8) {
+      const __m256i *sourceVector = reinterpret_cast<const __m256i *>(source + pixelIndex * 4);
+      __m256i pixels0123 = _mm256_loadu_si256(sourceVector);
+      __m256i pixels4567 = _mm256_loadu_si256(sourceVector + 1);
+
+      pixels0123 = _mm256_srli_epi16(
+        _mm256_add_epi16(
+          _mm256_sub_epi16(pixels0123, _mm256_srli_epi16(pixels0123, 8)), roundingOffset
+        ),
+        8
+      );
+      pixels4567 = _mm256_srli_epi16(
+        _mm256_add_epi16(
+          _mm256_sub_epi16(pixels4567, _mm256_srli_epi16(pixels4567, 8)), roundingOffset
+        ),
+        8
+      );
+
+      // Packing works per lane, leaving pixels in the order 0 1 4 5 2 3 6 7,
+      // so after packing, the 64 bit pixel pairs are put back in order
+      __m256i packed = _mm256_packus_epi16(pixels0123, pixels4567);
+      packed = _mm256_permute4x64_epi64(packed, _MM_SHUFFLE(3, 1, 2, 0));
+
+      // Swap red and blue by shuffling the bytes of each pixel
+      packed = _mm256_shuffle_epi8(
+        packed,
+        _mm256_setr_epi8(
+          2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15,
+          2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15
+        )
+      );
+
+      _mm256_storeu_si256(reinterpret_cast<__m256i *>(target + pixelIndex), packed);
+    }
+
+    return pixelIndex;
+  }
+#endif // defined(NUCLEX_FRAMEFIXER_HAVE_AVX2)
+
+  // ------------------------------------------------------------------------------------------- //
+
+#if defined(NUCLEX_FRAMEFIXER_HAVE_AVX2)
+  /// <summary>Expands 8 bit QRgb pixels to 16 bit RGBA pixels using AVX2</summary>
+  /// <param name="source">Pixels as 0xAARRGGBB integers</param>
+  /// <param name="target">Receives the pixels with four 16 bit channels each</param>
+  /// <param name="pixelCount">Number of pixels that should be converted</param>
+  /// <returns>The number of pixels that have been converted</returns>
+  NUCLEX_FRAMEFIXER_AVX2_FUNCTION std::size_t argb32ToRgba64Avx2(
+    const std::uint32_t *source, std::uint16_t *target, std::size_t pixelCount
+  ) {
+    const __m256i swapRedAndBlue = _mm256_setr_epi8(
+      2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15,
+      2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15
+    );
+
+    std::size_t pixelIndex = 0;
+    for(; pixelIndex + 8 <= pixelCount; pixelIndex += 8) {
+      __m256i pixels = _mm256_shuffle_epi8(
+        _mm256_loadu_si256(reinterpret_cast<const __m256i *>(source + pixelIndex)),
+        swapRedAndBlue
+      );
+
+      // Unpacking works per lane, giving pixels 0 1 4 5 and 2 3 6 7
+      __m256i pixels0145 = _mm256_unpacklo_epi8(pixels, pixels); // (value << 8) | value
+      __m256i pixels2367 = _mm256_unpackhi_epi8(pixels, pixels);
+
+      __m256i *targetVector = reinterpret_cast<__m256i *>(target + pixelIndex * 4);
+      _mm256_storeu_si256(
+        targetVector, _mm256_permute2x128_si256(pixels0145, pixels2367, 0x20)
+      );
+      _mm256_storeu_si256(
+        targetVector + 1, _mm256_permute2x128_si256(pixels0145, pixels2367, 0x31)
+      );
+    }
+
+    return pixelIndex;
+  }
+#endif // defined(NUCLEX_FRAMEFIXER_HAVE_AVX2)
+
+  // ------------------------------------------------------------------------------------------- //
+
+#if defined(NUCLEX_FRAMEFIXER_HAVE_AVX2)
+  /// <summary>Converts RGBA pixels into planar 4:4:4 YUV pixels using AVX2</summary>
+  /// <param name="source">Pixels with four 16 bit channels each</param>
+  /// <param name="luma">Receives the 16 bit luma (Y) value of each pixel</param>
+  /// <param name="blueDifference">Receives the 16 bit Cb value of each pixel</param>
+  /// <param name="redDifference">Receives the 16 bit Cr value of each pixel</param>
+  /// <param name="pixelCount">Number of pixels that should be converted</param>
+  /// <returns>The number of pixels that have been converted</returns>
+  NUCLEX_FRAMEFIXER_AVX2_FUNCTION std::size_t rgba64ToYuv444p16Avx2(
+    const std::uint16_t *source,
+    std::uint16_t *luma,
+    std::uint16_t *blueDifference,
+    std::uint16_t *redDifference,
+    std::size_t pixelCount
+  ) {
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256 lumaOffset = _mm256_set1_ps(LumaOffset + 0.5f);
+    const __m256 chromaOffset = _mm256_set1_ps(ChromaOffset + 0.5f);
+
+    // Unpacking and packing happen within 128 bit lanes, which leaves the pixels
+    // in the order 0 1 4 5 2 3 6 7. This puts the 32 bit pixel pairs back in order.
+    const __m256i pixelPairOrder = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+
+    std::size_t pixelIndex = 0;
+    for(; pixelIndex + 8 <= pixelCount; pixelIndex += 8) {
+      const __m256i *sourceVector = reinterpret_cast<const __m256i *>(source + pixelIndex * 4);
+      __m256i pixels0123 = _mm256_loadu_si256(sourceVector);
+      __m256i pixels4567 = _mm256_loadu_si256(sourceVector + 1);
+
+      // Transpose into one register per channel, like the SSE2 code does
+      __m256i interleaved0415 = _mm256_unpacklo_epi16(pixels0123, pixels4567);
+      __m256i interleaved1526 = _mm256_unpackhi_epi16(pixels0123, pixels4567);
+      __m256i redGreen = _mm256_unpacklo_epi16(interleaved0415, interleaved1526);
+      __m256i blueAlpha = _mm256_unpackhi_epi16(interleaved0415, interleaved1526);
+
+      __m256 red = _mm256_cvtepi32_ps(_mm256_unpacklo_epi16(redGreen, zero));
+      __m256 green = _mm256_cvtepi32_ps(_mm256_unpackhi_epi16(redGreen, zero));
+      __m256 blue = _mm256_cvtepi32_ps(_mm256_unpacklo_epi16(blueAlpha, zero));
+
+      __m256 y = _mm256_add_ps(
+        _mm256_add_ps(
+          _mm256_mul_ps(red, _mm256_set1_ps(YR)),
+          _mm256_mul_ps(green, _mm256_set1_ps(YG))
+        ),
+        _mm256_add_ps(_mm256_mul_ps(blue, _mm256_set1_ps(YB)), lumaOffset)
+      );
+      __m256 cb = _mm256_add_ps(
+        _mm256_add_ps(
+          _mm256_mul_ps(red, _mm256_set1_ps(CbR)),
+          _mm256_mul_ps(green, _mm256_set1_ps(CbG))
+        ),
+        _mm256_add_ps(_mm256_mul_ps(blue, _mm256_set1_ps(CbB)), chromaOffset)
+      );
+      __m256 cr = _mm256_add_ps(
+        _mm256_add_ps(
+          _mm256_mul_ps(red, _mm256_set1_ps(CrR)),
+          _mm256_mul_ps(green, _mm256_set1_ps(CrG))
+        ),
+        _mm256_add_ps(_mm256_mul_ps(blue, _mm256_set1_ps(CrB)), chromaOffset)
+      );
+
+      // Luma goes into the lower half, Cb into the upper half of one register
+      __m256i lumaAndBlue = _mm256_permutevar8x32_epi32(
+        _mm256_packus_epi32(_mm256_cvttps_epi32(y), _mm256_cvttps_epi32(cb)), pixelPairOrder
+      );
+      __m256i redTwice = _mm256_permutevar8x32_epi32(
+        _mm256_packus_epi32(_mm256_cvttps_epi32(cr), _mm256_cvttps_epi32(cr)), pixelPairOrder
+      );
+
+      _mm_storeu_si128(
+        reinterpret_cast<__m128i *>(luma + pixelIndex), _mm256_castsi256_si128(lumaAndBlue)
+      );
+      _mm_storeu_si128(
+        reinterpret_cast<__m128i *>(blueDifference + pixelIndex),
+        _mm256_extracti128_si256(lumaAndBlue, 1)
+      );
+      _mm_storeu_si128(
+        reinterpret_cast<__m128i *>(redDifference + pixelIndex),
+        _mm256_castsi256_si128(redTwice)
+      );
+    }
+
+    return pixelIndex;
+  }
+#endif // defined(NUCLEX_FRAMEFIXER_HAVE_AVX2)
+
+  // ------------------------------------------------------------------------------------------- //
+
+#if defined(NUCLEX_FRAMEFIXER_HAVE_AVX2)
+  /// <summary>Converts the YUV values of eight pixels into RGB values using AVX2</summary>
+  /// <param name="luma">Luma values of eight pixels</param>
+  /// <param name="blueDifference">Cb values of eight pixels</param>
+  /// <param name="redDifference">Cr values of eight pixels</param>
+  /// <param name="red">Receives the red values as 32 bit integers</param>
+  /// <param name="green">Receives the green values as 32 bit integers</param>
+  /// <param name="blue">Receives the blue values as 32 bit integers</param>
+  NUCLEX_FRAMEFIXER_AVX2_FUNCTION inline void convertYuvToRgbAvx2(
+    __m128i luma, __m128i blueDifference, __m128i redDifference,
+    __m256i &red, __m256i &green, __m256i &blue
+  ) {
+    const __m256 half = _mm256_set1_ps(0.5f);
+    const __m256 zero = _mm256_setzero_ps();
+    const __m256 maximum = _mm256_set1_ps(65535.0f);
+
+    __m256 y = _mm256_mul_ps(
+      _mm256_sub_ps(
+        _mm256_cvtepi32_ps(_mm256_cvtepu16_epi32(luma)), _mm256_set1_ps(LumaOffset)
+      ),
+      _mm256_set1_ps(RY)
+    );
+    __m256 cb = _mm256_sub_ps(
+      _mm256_cvtepi32_ps(_mm256_cvtepu16_epi32(blueDifference)), _mm256_set1_ps(ChromaOffset)
+    );
+    __m256 cr = _mm256_sub_ps(
+      _mm256_cvtepi32_ps(_mm256_cvtepu16_epi32(redDifference)), _mm256_set1_ps(ChromaOffset)
+    );
+
+    __m256 r = _mm256_add_ps(_mm256_add_ps(y, _mm256_mul_ps(cr, _mm256_set1_ps(RCr))), half);
+    __m256 g = _mm256_add_ps(
+      _mm256_add_ps(
+        _mm256_add_ps(y, _mm256_mul_ps(cb, _mm256_set1_ps(GCb))),
+        _mm256_mul_ps(cr, _mm256_set1_ps(GCr))
+      ),
+      half
+    );
+    __m256 b = _mm256_add_ps(_mm256_add_ps(y, _mm256_mul_ps(cb, _mm256_set1_ps(BCb))), half);
+
+    red = _mm256_cvttps_epi32(_mm256_min_ps(_mm256_max_ps(r, zero), maximum));
+    green = _mm256_cvttps_epi32(_mm256_min_ps(_mm256_max_ps(g, zero), maximum));
+    blue = _mm256_cvttps_epi32(_mm256_min_ps(_mm256_max_ps(b, zero), maximum));
+  }
+#endif // defined(NUCLEX_FRAMEFIXER_HAVE_AVX2)
+
+  // ------------------------------------------------------------------------------------------- //
+
+#if defined(NUCLEX_FRAMEFIXER_HAVE_AVX2)
+  /// <summary>Converts planar 4:4:4 YUV pixels into RGBA pixels using AVX2</summary>
+  /// <param name="luma">Luma (Y) channel with one 16 bit value per pixel</param>
+  /// <param name="blueDifference">Cb channel with one 16 bit value per pixel</param>
+  /// <param name="redDifference">Cr channel with one 16 bit value per pixel</param>
+  /// <param name="target">Receives the pixels with four 16 bit channels each</param>
+  /// <param name="pixelCount">Number of pixels that should be converted</param>
+  /// <returns>The number of pixels that have been converted</returns>
+  NUCLEX_FRAMEFIXER_AVX2_FUNCTION std::size_t yuv444p16ToRgba64Avx2(
+    const std::uint16_t *luma,
+    const std::uint16_t *blueDifference,
+    const std::uint16_t *redDifference,
+    std::uint16_t *target,
+    std::size_t pixelCount
+  ) {
+    const __m256i opaque = _mm256_set1_epi16(-1);
+
+    std::size_t pixelIndex = 0;
+    for(; pixelIndex + 16 <= pixelCount; pixelIndex += 16) {
+      const __m128i *lumaVector = reinterpret_cast<const __m128i *>(luma + pixelIndex);
+      const __m128i *blueVector = reinterpret_cast<const __m128i *>(
+        blueDifference + pixelIndex
+      );
+      const __m128i *redVector = reinterpret_cast<const __m128i *>(redDifference + pixelIndex);
+
+      __m256i red0to7, green0to7, blue0to7;
+      convertYuvToRgbAvx2(
+        _mm_loadu_si128(lumaVector), _mm_loadu_si128(blueVector), _mm_loadu_si128(redVector),
+        red0to7, green0to7, blue0to7
+      );
+      __m256i red8to15, green8to15, blue8to15;
+      convertYuvToRgbAvx2(
+        _mm_loadu_si128(lumaVector + 1),
+        _mm_loadu_si128(blueVector + 1),
+        _mm_loadu_si128(redVector + 1),
+        red8to15, green8to15, blue8to15
+      );
+
+      // Packing works per lane, leaving the values in the order 0-3 8-11 4-7 12-15,
+      // so the 64 bit groups are put back in order afterwards
+      storeInterleavedAvx2(
+        _mm256_permute4x64_epi64(
+          _mm256_packus_epi32(red0to7, red8to15), _MM_SHUFFLE(3, 1, 2, 0)
+        ),
+        _mm256_permute4x64_epi64(
+          _mm256_packus_epi32(green0to7, green8to15), _MM_SHUFFLE(3, 1, 2, 0)
+        ),
+        _mm256_permute4x64_epi64(
+          _mm256_packus_epi32(blue0to7, blue8to15), _MM_SHUFFLE(3, 1, 2, 0)
+        ),
+        opaque,
+        target + pixelIndex * 4
+      );
+    }
+
+    return pixelIndex;
+  }
+#endif // defined(NUCLEX_FRAMEFIXER_HAVE_AVX2)
+
+  // ------------------------------------------------------------------------------------------- //
+
+} // anonymous namespace
+
+namespace Nuclex::FrameFixer::Rendering {
+
+  // ------------------------------------------------------------------------------------------- //
+
+  void PixelConversion::Rgba64ToRgb48(
+    const std::uint16_t *source, std::uint16_t *target, std::size_t pixelCount
+  ) {
+    std::size_t pixelIndex = 0;
+
+#if defined(NUCLEX_FRAMEFIXER_HAVE_SSE2)
+    // Four pixels (32 bytes) go in, four pixels (24 bytes) come out. Within each
+    // register holding two pixels, the second pixel is moved down by one channel
+    // to overwrite the alpha value of the first.
+    const __m128i firstPixelMask = _mm_set_epi16(0, 0, 0, 0, 0, -1, -1, -1);
+    const __m128i secondPixelMask = _mm_set_epi16(0, 0, -1, -1, -1, 0, 0, 0);
+    for(; pixelIndex + 4 <= pixelCount; pixelIndex += 4) {
+      __m128i pixels01 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(source));
+      __m128i pixels23 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(source + 8));
+
+      __m128i packed01 = _mm_or_si128(
+        _mm_and_si128(pixels01, firstPixelMask),
+        _mm_and_si128(_mm_srli_si128(pixels01, 2), secondPixelMask)
+      );
+      __m128i packed23 = _mm_or_si128(
+        _mm_and_si128(pixels23, firstPixelMask),
+        _mm_and_si128(_mm_srli_si128(pixels23, 2), secondPixelMask)
+      );
+
+      // 12 bytes from the first pair plus 4 from the second make one full register,
+      // the remaining 8 bytes of the second pair are stored separately
+      _mm_storeu_si128(
+        reinterpret_cast<__m128i *>(target),
+        _mm_or_si128(packed01, _mm_slli_si128(packed23, 12))
+      );
+      _mm_storel_epi64(
+        reinterpret_cast<__m128i *>(target + 8), _mm_srli_si128(packed23, 4)
+      );
+
+      source += 16;
+      target += 12;
+    }
+#endif // defined(NUCLEX_FRAMEFIXER_HAVE_SSE2)
+
+    for(; pixelIndex < pixelCount; ++pixelIndex) {
+      target[0] = source[0];
+      target[1] = source[1];
+      target[2] = source[2];
+
+      source += 4;
+      target += 3;
+    }
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  void PixelConversion::Rgba64ToYuv444p16(
+    const std::uint16_t *source,
+    std::uint16_t *luma,
+    std::uint16_t *blueDifference,
+    std::uint16_t *redDifference,
+    std::size_t pixelCount
+  ) {
+    std::size_t pixelIndex = 0;
+
+#if defined(NUCLEX_FRAMEFIXER_HAVE_AVX2)
+    if(Platform::CpuFeatures::HasAvx2()) {
+      pixelIndex = rgba64ToYuv444p16Avx2(
+        source, luma, blueDifference, redDifference, pixelCount
+      );
+      source += pixelIndex * 4;
+      luma += pixelIndex;
+      blueDifference += pixelIndex;
+      redDifference += pixelIndex;
+    }
+#endif // defined(NUCLEX_FRAMEFIXER_HAVE_AVX2)
+
+#if defined(NUCLEX_FRAMEFIXER_HAVE_SSE2)
+    const __m128i zero = _mm_setzero_si128();
+    const __m128 half = _mm_set1_ps(0.5f);
+    const __m128 lumaOffset = _mm_set1_ps(LumaOffset);
+    const __m128 chromaOffset = _mm_set1_ps(ChromaOffset);
+
+    for(; pixelIndex + 4 <= pixelCount; pixelIndex += 4) {
+      __m128i pixels01 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(source));
+      __m128i pixels23 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(source + 8));
+
+      // Transpose the interleaved RGBA channels into one register per channel.
+      // R0 G0 B0 A0 R1 G1 B1 A1 + R2 G2 B2 A2 R3 G3 B3 A3 -> R0 R2 G0 G2 B0 B2 A0 A2 ...
+      __m128i interleaved02 = _mm_unpacklo_epi16(pixels01, pixels23);
+      __m128i interleaved13 = _mm_unpackhi_epi16(pixels01, pixels23);
+      // -> R0 R1 R2 R3 G0 G1 G2 G3 and B0 B1 B2 B3 A0 A1 A2 A3
+      __m128i redGreen = _mm_unpacklo_epi16(interleaved02, interleaved13);
+      __m128i blueAlpha = _mm_unpackhi_epi16(interleaved02, interleaved13);
+
+      __m128 red = _mm_cvtepi32_ps(_mm_unpacklo_epi16(redGreen, zero));
+      __m128 green = _mm_cvtepi32_ps(_mm_unpackhi_epi16(redGreen, zero));
+      __m128 blue = _mm_cvtepi32_ps(_mm_unpacklo_epi16(blueAlpha, zero));
+
+      __m128 y = _mm_add_ps(
+        _mm_add_ps(
+          _mm_mul_ps(red, _mm_set1_ps(YR)),
+          _mm_mul_ps(green, _mm_set1_ps(YG))
+        ),
+        _mm_add_ps(
+          _mm_mul_ps(blue, _mm_set1_ps(YB)),
+          _mm_add_ps(lumaOffset, half)
+        )
+      );
+      __m128 cb = _mm_add_ps(
+        _mm_add_ps(
+          _mm_mul_ps(red, _mm_set1_ps(CbR)),
+          _mm_mul_ps(green, _mm_set1_ps(CbG))
+        ),
+        _mm_add_ps(
+          _mm_mul_ps(blue, _mm_set1_ps(CbB)),
+          _mm_add_ps(chromaOffset, half)
+        )
+      );
+      __m128 cr = _mm_add_ps(
+        _mm_add_ps(
+          _mm_mul_ps(red, _mm_set1_ps(CrR)),
+          _mm_mul_ps(green, _mm_set1_ps(CrG))
+        ),
+        _mm_add_ps(
+          _mm_mul_ps(blue, _mm_set1_ps(CrB)),
+          _mm_add_ps(chromaOffset, half)
+        )
+      );
+
+      _mm_storel_epi64(
+        reinterpret_cast<__m128i *>(luma), packUnsigned16(_mm_cvttps_epi32(y))
+      );
+      _mm_storel_epi64(
+        reinterpret_cast<__m128i *>(blueDifference), packUnsigned16(_mm_cvttps_epi32(cb))
+      );
+      _mm_storel_epi64(
+        reinterpret_cast<__m128i *>(redDifference), packUnsigned16(_mm_cvttps_epi32(cr))
+      );
+
+      source += 16;
+      luma += 4;
+      blueDifference += 4;
+      redDifference += 4;
+    }
+#endif // defined(NUCLEX_FRAMEFIXER_HAVE_SSE2)
+
+    for(; pixelIndex < pixelCount; ++pixelIndex) {
+      float red = static_cast<float>(source[0]);
+      float green = static_cast<float>(source[1]);
+      float blue = static_cast<float>(source[2]);
+
+      // Summed in the same order as in the SIMD code, rounding included, because floats
+      // added in another order can differ in the last bit and flip the rounding
+      *luma = static_cast<std::uint16_t>(
+        (red * YR + green * YG) + (blue * YB + (LumaOffset + 0.5f))
+      );
+      *blueDifference = static_cast<std::uint16_t>(
+        (red * CbR + green * CbG) + (blue * CbB + (ChromaOffset + 0.5f))
+      );
+      *redDifference = static_cast<std::uint16_t>(
+        (red * CrR + green * CrG) + (blue * CrB + (ChromaOffset + 0.5f))
+      );
+
+      source += 4;
+      ++luma;
+      ++blueDifference;
+      ++redDifference;
+    }
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  void PixelConversion::Yuv444p16ToRgba64(
+    const std::uint16_t *luma,
+    const std::uint16_t *blueDifference,
+    const std::uint16_t *redDifference,
+    std::uint16_t *target,
+    std::size_t pixelCount
+  ) {
+    std::size_t pixelIndex = 0;
+
+#if defined(NUCLEX_FRAMEFIXER_HAVE_AVX2)
+    if(Platform::CpuFeatures::HasAvx2()) {
+      pixelIndex = yuv444p16ToRgba64Avx2(
+        luma, blueDifference, redDifference, target, pixelCount
+      );
+    }
+#endif // defined(NUCLEX_FRAMEFIXER_HAVE_AVX2)
+
+#if defined(NUCLEX_FRAMEFIXER_HAVE_SSE2)
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i opaque = _mm_set1_epi16(-1);
+
+    for(; pixelIndex + 8 <= pixelCount; pixelIndex += 8) {
+      __m128i luma8 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(luma + pixelIndex));
+      __m128i blue8 = _mm_loadu_si128(
+        reinterpret_cast<const __m128i *>(blueDifference + pixelIndex)
+      );
+      __m128i red8 = _mm_loadu_si128(
+        reinterpret_cast<const __m128i *>(redDifference + pixelIndex)
+      );
+
+      __m128i red0123, green0123, blue0123;
+      convertYuvToRgb(
+        _mm_unpacklo_epi16(luma8, zero),
+        _mm_unpacklo_epi16(blue8, zero),
+        _mm_unpacklo_epi16(red8, zero),
+        red0123, green0123, blue0123
+      );
+      __m128i red4567, green4567, blue4567;
+      convertYuvToRgb(
+        _mm_unpackhi_epi16(luma8, zero),
+        _mm_unpackhi_epi16(blue8, zero),
+        _mm_unpackhi_epi16(red8, zero),
+        red4567, green4567, blue4567
+      );
+
+      storeInterleaved(
+        _mm_unpacklo_epi64(red0123, red4567),
+        _mm_unpacklo_epi64(green0123, green4567),
+        _mm_unpacklo_epi64(blue0123, blue4567),
+        opaque,
+        target + pixelIndex * 4
+      );
+    }
+#endif // defined(NUCLEX_FRAMEFIXER_HAVE_SSE2)
+
+    for(; pixelIndex < pixelCount; ++pixelIndex) {
+      float y = (static_cast<float>(luma[pixelIndex]) - LumaOffset) * RY;
+      float cb = static_cast<float>(blueDifference[pixelIndex]) - ChromaOffset;
+      float cr = static_cast<float>(redDifference[pixelIndex]) - ChromaOffset;
+
+      std::uint16_t *pixel = target + pixelIndex * 4;
+      pixel[0] = clampToUnsigned16(y + cr * RCr);
+      pixel[1] = clampToUnsigned16(y + cb * GCb + cr * GCr);
+      pixel[2] = clampToUnsigned16(y + cb * BCb);
+      pixel[3] = 65535;
+    }
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  void PixelConversion::Gbrap16ToRgba64(
+    const std::uint16_t *green,
+    const std::uint16_t *blue,
+    const std::uint16_t *red,
+    const std::uint16_t *alpha,
+    std::uint16_t *target,
+    std::size_t pixelCount
+  ) {
+    std::size_t pixelIndex = 0;
+
+#if defined(NUCLEX_FRAMEFIXER_HAVE_AVX2)
+    if(Platform::CpuFeatures::HasAvx2()) {
+      pixelIndex = gbrap16ToRgba64Avx2(green, blue, red, alpha, target, pixelCount);
+    }
+#endif // defined(NUCLEX_FRAMEFIXER_HAVE_AVX2)
+
+#if defined(NUCLEX_FRAMEFIXER_HAVE_SSE2)
+    for(; pixelIndex + 8 <= pixelCount; pixelIndex += 8) {
+      storeInterleaved(
+        _mm_loadu_si128(reinterpret_cast<const __m128i *>(red + pixelIndex)),
+        _mm_loadu_si128(reinterpret_cast<const __m128i *>(green + pixelIndex)),
+        _mm_loadu_si128(reinterpret_cast<const __m128i *>(blue + pixelIndex)),
+        _mm_loadu_si128(reinterpret_cast<const __m128i *>(alpha + pixelIndex)),
+        target + pixelIndex * 4
+      );
+    }
+#endif // defined(NUCLEX_FRAMEFIXER_HAVE_SSE2)
+
+    for(; pixelIndex < pixelCount; ++pixelIndex) {
+      std::uint16_t *pixel = target + pixelIndex * 4;
+      pixel[0] = red[pixelIndex];
+      pixel[1] = green[pixelIndex];
+      pixel[2] = blue[pixelIndex];
+      pixel[3] = alpha[pixelIndex];
+    }
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  void PixelConversion::Gbrap8ToRgba64(
+    const std::uint8_t *green,
+    const std::uint8_t *blue,
+    const std::uint8_t *red,
+    const std::uint8_t *alpha,
+    std::uint16_t *target,
+    std::size_t pixelCount
+  ) {
+    std::size_t pixelIndex = 0;
+
+#if defined(NUCLEX_FRAMEFIXER_HAVE_AVX2)
+    if(Platform::CpuFeatures::HasAvx2()) {
+      pixelIndex = gbrap8ToRgba64Avx2(green, blue, red, alpha, target, pixelCount);
+    }
+#endif // defined(NUCLEX_FRAMEFIXER_HAVE_AVX2)
+
+#if defined(NUCLEX_FRAMEFIXER_HAVE_SSE2)
+    // Sixteen pixels per iteration. Unpacking a byte with itself yields (value << 8) | value,
+    // which is the 8 bit value expanded to 16 bits.
+    for(; pixelIndex + 16 <= pixelCount; pixelIndex += 16) {
+      __m128i red16 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(red + pixelIndex));
+      __m128i green16 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(green + pixelIndex));
+      __m128i blue16 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(blue + pixelIndex));
+      __m128i alpha16 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(alpha + pixelIndex));
+
+      storeInterleaved(
+        _mm_unpacklo_epi8(red16, red16),
+        _mm_unpacklo_epi8(green16, green16),
+        _mm_unpacklo_epi8(blue16, blue16),
+        _mm_unpacklo_epi8(alpha16, alpha16),
+        target + pixelIndex * 4
+      );
+      storeInterleaved(
+        _mm_unpackhi_epi8(red16, red16),
+        _mm_unpackhi_epi8(green16, green16),
+        _mm_unpackhi_epi8(blue16, blue16),
+        _mm_unpackhi_epi8(alpha16, alpha16),
+        target + pixelIndex * 4 + 32
+      );
+    }
+#endif // defined(NUCLEX_FRAMEFIXER_HAVE_SSE2)
+
+    for(; pixelIndex < pixelCount; ++pixelIndex) {
+      std::uint16_t *pixel = target + pixelIndex * 4;
+      pixel[0] = expandTo16Bits(red[pixelIndex]);
+      pixel[1] = expandTo16Bits(green[pixelIndex]);
+      pixel[2] = expandTo16Bits(blue[pixelIndex]);
+      pixel[3] = expandTo16Bits(alpha[pixelIndex]);
+    }
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  void PixelConversion::Rgba64ToGbrap16(
+    const std::uint16_t *source,
+    std::uint16_t *green,
+    std::uint16_t *blue,
+    std::uint16_t *red,
+    std::uint16_t *alpha,
+    std::size_t pixelCount
+  ) {
+    std::size_t pixelIndex = 0;
+
+#if defined(NUCLEX_FRAMEFIXER_HAVE_SSE2)
+    for(; pixelIndex + 8 <= pixelCount; pixelIndex += 8) {
+      const __m128i *sourceVector = reinterpret_cast<const __m128i *>(source + pixelIndex * 4);
+      __m128i pixels01 = _mm_loadu_si128(sourceVector);
+      __m128i pixels23 = _mm_loadu_si128(sourceVector + 1);
+      __m128i pixels45 = _mm_loadu_si128(sourceVector + 2);
+      __m128i pixels67 = _mm_loadu_si128(sourceVector + 3);
+
+      // Transpose each group of four pixels as in Rgba64ToYuv444p16(), giving
+      // R0 R1 R2 R3 G0 G1 G2 G3 and B0 B1 B2 B3 A0 A1 A2 A3 (and the same for pixels 4-7)
+      __m128i interleaved02 = _mm_unpacklo_epi16(pixels01, pixels23);
+      __m128i interleaved13 = _mm_unpackhi_epi16(pixels01, pixels23);
+      __m128i redGreen0123 = _mm_unpacklo_epi16(interleaved02, interleaved13);
+      __m128i blueAlpha0123 = _mm_unpackhi_epi16(interleaved02, interleaved13);
+
+      __m128i interleaved46 = _mm_unpacklo_epi16(pixels45, pixels67);
+      __m128i interleaved57 = _mm_unpackhi_epi16(pixels45, pixels67);
+      __m128i redGreen4567 = _mm_unpacklo_epi16(interleaved46, interleaved57);
+      __m128i blueAlpha4567 = _mm_unpackhi_epi16(interleaved46, interleaved57);
+
+      _mm_storeu_si128(
+        reinterpret_cast<__m128i *>(red + pixelIndex),
+        _mm_unpacklo_epi64(redGreen0123, redGreen4567)
+      );
+      _mm_storeu_si128(
+        reinterpret_cast<__m128i *>(green + pixelIndex),
+        _mm_unpackhi_epi64(redGreen0123, redGreen4567)
+      );
+      _mm_storeu_si128(
+        reinterpret_cast<__m128i *>(blue + pixelIndex),
+        _mm_unpacklo_epi64(blueAlpha0123, blueAlpha4567)
+      );
+      _mm_storeu_si128(
+        reinterpret_cast<__m128i *>(alpha + pixelIndex),
+        _mm_unpackhi_epi64(blueAlpha0123, blueAlpha4567)
+      );
+    }
+#endif // defined(NUCLEX_FRAMEFIXER_HAVE_SSE2)
+
+    for(; pixelIndex < pixelCount; ++pixelIndex) {
+      const std::uint16_t *pixel = source + pixelIndex * 4;
+      red[pixelIndex] = pixel[0];
+      green[pixelIndex] = pixel[1];
+      blue[pixelIndex] = pixel[2];
+      alpha[pixelIndex] = pixel[3];
+    }
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  void PixelConversion::Rgba64ToArgb32(
+    const std::uint16_t *source, std::uint32_t *target, std::size_t pixelCount
+  ) {
+    std::size_t pixelIndex = 0;
+
+#if defined(NUCLEX_FRAMEFIXER_HAVE_AVX2)
+    if(Platform::CpuFeatures::HasAvx2()) {
+      pixelIndex = rgba64ToArgb32Avx2(source, target, pixelCount);
+    }
+#endif // defined(NUCLEX_FRAMEFIXER_HAVE_AVX2)
+
+#if defined(NUCLEX_FRAMEFIXER_HAVE_SSE2)
+    for(; pixelIndex + 4 <= pixelCount; pixelIndex += 4) {
+      const __m128i *sourceVector = reinterpret_cast<const __m128i *>(source + pixelIndex * 4);
+      _mm_storeu_si128(
+        reinterpret_cast<__m128i *>(target + pixelIndex),
+        _mm_packus_epi16(
+          reduceTo8BitsBgra(_mm_loadu_si128(sourceVector)),
+          reduceTo8BitsBgra(_mm_loadu_si128(sourceVector + 1))
+        )
+      );
+    }
+#endif // defined(NUCLEX_FRAMEFIXER_HAVE_SSE2)
+
+    for(; pixelIndex < pixelCount; ++pixelIndex) {
+      const std::uint16_t *pixel = source + pixelIndex * 4;
+      target[pixelIndex] = (
+        (reduceTo8Bits(pixel[3]) << 24) |
+        (reduceTo8Bits(pixel[0]) << 16) |
+        (reduceTo8Bits(pixel[1]) << 8) |
+        reduceTo8Bits(pixel[2])
+      );
+    }
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  void PixelConversion::Argb32ToRgba64(
+    const std::uint32_t *source, std::uint16_t *target, std::size_t pixelCount
+  ) {
+    std::size_t pixelIndex = 0;
+
+#if defined(NUCLEX_FRAMEFIXER_HAVE_AVX2)
+    if(Platform::CpuFeatures::HasAvx2()) {
+      pixelIndex = argb32ToRgba64Avx2(source, target, pixelCount);
+    }
+#endif // defined(NUCLEX_FRAMEFIXER_HAVE_AVX2)
+
+#if defined(NUCLEX_FRAMEFIXER_HAVE_SSE2)
+    for(; pixelIndex + 4 <= pixelCount; pixelIndex += 4) {
+      __m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i *>(source + pixelIndex));
+
+      __m128i *targetVector = reinterpret_cast<__m128i *>(target + pixelIndex * 4);
+      _mm_storeu_si128(targetVector, expandTo16BitsRgba(pixels));
+      _mm_storeu_si128(targetVector + 1, expandTo16BitsRgba(_mm_srli_si128(pixels, 8)));
+    }
+#endif // defined(NUCLEX_FRAMEFIXER_HAVE_SSE2)
+
+    for(; pixelIndex < pixelCount; ++pixelIndex) {
+      std::uint32_t pixel = source[pixelIndex];
+      std::uint16_t *targetPixel = target + pixelIndex * 4;
+      targetPixel[0] = expandTo16Bits(static_cast<std::uint8_t>(pixel >> 16));
+      targetPixel[1] = expandTo16Bits(static_cast<std::uint8_t>(pixel >> 8));
+      targetPixel[2] = expandTo16Bits(static_cast<std::uint8_t>(pixel));
+      targetPixel[3] = expandTo16Bits(static_cast<std::uint8_t>(pixel >> 24));
+    }
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+} // namespace Nuclex::FrameFixer::Rendering
@@ -0,0 +1,172 @@
+#pragma region Apache License 2.0
+/*
+Nuclex Frame Fixer
+Copyright (C) 2024 Markus Ewald / Nuclex Development Labs
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#pragma endregion // Apache License 2.0
+
+#ifndef NUCLEX_FRAMEFIXER_RENDERING_PIXELCONVERSION_H
+#define NUCLEX_FRAMEFIXER_RENDERING_PIXELCONVERSION_H
+
+#include "Nuclex/FrameFixer/Config.h"
+
+#include <cstddef> // for std::size_t
+#include <cstdint> // for std::uint8_t, std::uint16_t, std::uint32_t
+
+namespace Nuclex::FrameFixer::Rendering {
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Converts rows of pixels between the layouts used by Qt, libav and encoders</summary>
+  /// <remarks>
+  ///   <para>
+  ///     Interleaved 16 bit pixels are in the layout of QImage::Format_RGBA64, that is,
+  ///     four 16 bit channels in R, G, B, A order. Interleaved 8 bit pixels are QRgb values
+  ///     as in QImage::Format_ARGB32 (0xAARRGGBB integers). Planar pixels are in libav's
+  ///     GBRAP layout with one row per channel.
+  ///   </para>
+  ///   <para>
+  ///     On x86 and x64, SSE2 is used to process several pixels at once and if the CPU
+  ///     supports AVX2 (checked at runtime), the busiest conversions use it to process
+  ///     twice as many. Other architectures fall back to plain loops that produce
+  ///     the exact same results.
+  ///   </para>
+  ///   <para>
+  ///     YUV pixels use the BT.709 color matrix in limited ("TV") range, scaled up
+  ///     to 16 bits, which is what ffmpeg expects from yuv444p16 frames.
+  ///   </para>
+  /// </remarks>
+  class PixelConversion {
+
+    /// <summary>Converts RGBA pixels into RGB pixels by dropping the alpha channel</summary>
+    /// <param name="source">Pixels with four 16 bit channels each</param>
+    /// <param name="target">Receives the pixels with three 16 bit channels each</param>
+    /// <param name="pixelCount">Number of pixels that will be converted</param>
+    public: static void Rgba64ToRgb48(
+      const std::uint16_t *source, std::uint16_t *target, std::size_t pixelCount
+    );
+
+    /// <summary>Converts RGBA pixels into planar 4:4:4 YUV pixels</summary>
+    /// <param name="source">Pixels with four 16 bit channels each</param>
+    /// <param name="luma">Receives the 16 bit luma (Y) value of each pixel</param>
+    /// <param name="blueDifference">Receives the 16 bit Cb value of each pixel</param>
+    /// <param name="redDifference">Receives the 16 bit Cr value of each pixel</param>
+    /// <param name="pixelCount">Number of pixels that will be converted</param>
+    public: static void Rgba64ToYuv444p16(
+      const std::uint16_t *source,
+      std::uint16_t *luma,
+      std::uint16_t *blueDifference,
+      std::uint16_t *redDifference,
+      std::size_t pixelCount
+    );
+
+    /// <summary>Converts planar 4:4:4 YUV pixels into RGBA pixels</summary>
+    /// <param name="luma">Luma (Y) channel with one 16 bit value per pixel</param>
+    /// <param name="blueDifference">Cb channel with one 16 bit value per pixel</param>
+    /// <param name="redDifference">Cr channel with one 16 bit value per pixel</param>
+    /// <param name="target">Receives the pixels with four 16 bit channels each</param>
+    /// <param name="pixelCount">Number of pixels that will be converted</param>
+    /// <remarks>
+    ///   YUV values that lie outside of the RGB color space are clamped to it and
+    ///   all pixels are fully opaque.
+    /// </remarks>
+    public: static void Yuv444p16ToRgba64(
+      const std::uint16_t *luma,
+      const std::uint16_t *blueDifference,
+      const std::uint16_t *redDifference,
+      std::uint16_t *target,
+      std::size_t pixelCount
+    );
+
+    /// <summary>Interleaves planar 16 bit GBRA channels into RGBA pixels</summary>
+    /// <param name="green">Green channel with one 16 bit value per pixel</param>
+    /// <param name="blue">Blue channel with one 16 bit value per pixel</param>
+    /// <param name="red">Red channel with one 16 bit value per pixel</param>
+    /// <param name="alpha">Alpha channel with one 16 bit value per pixel</param>
+    /// <param name="target">Receives the pixels with four 16 bit channels each</param>
+    /// <param name="pixelCount">Number of pixels that will be converted</param>
+    public: static void Gbrap16ToRgba64(
+      const std::uint16_t *green,
+      const std::uint16_t *blue,
+      const std::uint16_t *red,
+      const std::uint16_t *alpha,
+      std::uint16_t *target,
+      std::size_t pixelCount
+    );
+
+    /// <summary>Interleaves planar 8 bit GBRA channels into 16 bit RGBA pixels</summary>
+    /// <param name="green">Green channel with one 8 bit value per pixel</param>
+    /// <param name="blue">Blue channel with one 8 bit value per pixel</param>
+    /// <param name="red">Red channel with one 8 bit value per pixel</param>
+    /// <param name="alpha">Alpha channel with one 8 bit value per pixel</param>
+    /// <param name="target">Receives the pixels with four 16 bit channels each</param>
+    /// <param name="pixelCount">Number of pixels that will be converted</param>
+    /// <remarks>
+    ///   Channels are expanded the way QRgba64::fromRgba() does it, so 255 becomes 65535.
+    /// </remarks>
+    public: static void Gbrap8ToRgba64(
+      const std::uint8_t *green,
+      const std::uint8_t *blue,
+      const std::uint8_t *red,
+      const std::uint8_t *alpha,
+      std::uint16_t *target,
+      std::size_t pixelCount
+    );
+
+    /// <summary>Splits RGBA pixels into planar 16 bit GBRA channels</summary>
+    /// <param name="source">Pixels with four 16 bit channels each</param>
+    /// <param name="green">Receives the 16 bit green value of each pixel</param>
+    /// <param name="blue">Receives the 16 bit blue value of each pixel</param>
+    /// <param name="red">Receives the 16 bit red value of each pixel</param>
+    /// <param name="alpha">Receives the 16 bit alpha value of each pixel</param>
+    /// <param name="pixelCount">Number of pixels that will be converted</param>
+    public: static void Rgba64ToGbrap16(
+      const std::uint16_t *source,
+      std::uint16_t *green,
+      std::uint16_t *blue,
+      std::uint16_t *red,
+      std::uint16_t *alpha,
+      std::size_t pixelCount
+    );
+
+    /// <summary>Reduces 16 bit RGBA pixels to 8 bit QRgb pixels</summary>
+    /// <param name="source">Pixels with four 16 bit channels each</param>
+    /// <param name="target">Receives the pixels as 0xAARRGGBB integers</param>
+    /// <param name="pixelCount">Number of pixels that will be converted</param>
+    /// <remarks>
+    ///   Channels are rounded the way QRgba64::toArgb32() does it.
+    /// </remarks>
+    public: static void Rgba64ToArgb32(
+      const std::uint16_t *source, std::uint32_t *target, std::size_t pixelCount
+    );
+
+    /// <summary>Expands 8 bit QRgb pixels to 16 bit RGBA pixels</summary>
+    /// <param name="source">Pixels as 0xAARRGGBB integers</param>
+    /// <param name="target">Receives the pixels with four 16 bit channels each</param>
+    /// <param name="pixelCount">Number of pixels that will be converted</param>
+    /// <remarks>
+    ///   Channels are expanded the way QRgba64::fromArgb32() does it.
+    /// </remarks>
+    public: static void Argb32ToRgba64(
+      const std::uint32_t *source, std::uint16_t *target, std::size_t pixelCount
+    );
+
+  };
+
+  // ------------------------------------------------------------------------------------------- //
+
+} // namespace Nuclex::FrameFixer::Rendering
+
+#endif // NUCLEX_FRAMEFIXER_RENDERING_PIXELCONVERSION_H
@@ -0,0 +1,435 @@
+#pragma region Apache License 2.0
+/*
+Nuclex Frame Fixer
+Copyright (C) 2024 Markus Ewald / Nuclex Development Labs
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#pragma endregion // Apache License 2.0
+
+
+// If the application is compiled as a DLL, this ensures symbols are exported
+#define NUCLEX_FRAMEFIXER_SOURCE 1
+
+#include "./RenderLeaseFile.h"
+
+#include <QCoreApplication> // for QCoreApplication::applicationPid()
+#include <QFile>
+#include <QLockFile>
+#include <QSaveFile>
+#include <QSysInfo>
+#include <QTextStream>
+
+#include <Nuclex/Support/Text/LexicalCast.h> // for lexical_cast()
+#include <Nuclex/Support/Text/LexicalAppend.h> // for lexical_append()
+
+#include <stdexcept> // for std::runtime_error
+
+namespace {
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Age in milliseconds after which a lock file is considered abandoned</summary>
+  /// <remarks>
+  ///   Workers only hold the lock for as long as it takes to read and write the small
+  ///   lease file, so a lock that is this old belongs to a worker that died while
+  ///   holding it (QLockFile detects this directly if the worker was on the same host).
+  /// </remarks>
+  const int StaleLockMilliseconds = 30000;
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Returns the current time in seconds since the epoch</summary>
+  /// <returns>The number of seconds since the epoch</returns>
+  std::uint64_t getCurrentTime() {
+    return static_cast<std::uint64_t>(
+      std::chrono::duration_cast<std::chrono::seconds>(
+        std::chrono::system_clock::now().time_since_epoch()
+      ).count()
+    );
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Acquires a lock file or throws an exception if that is not possible</summary>
+  /// <param name="lockFile">Lock file that will be acquired</param>
+  void lockOrThrow(QLockFile &lockFile) {
+    lockFile.setStaleLockTime(StaleLockMilliseconds);
+    if(!lockFile.lock()) {
+      std::string message(u8"Could not acquire lock file '", 29);
+      message.append(lockFile.fileName().toStdString());
+      message.append(u8"'", 1);
+      throw std::runtime_error(message);
+    }
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Splits a line of comma-separated fields</summary>
+  /// <param name="line">Line that will be split</param>
+  /// <returns>The fields in the line with surrounding whitespace removed</returns>
+  std::vector<std::string> splitFields(const std::string &line) {
+    std::vector<std::string> fields;
+
+    std::string::size_type start = 0;
+    for(;;) {
+      std::string::size_type end = line.find(u8',', start);
+      std::string field = line.substr(
+        start, (end == std::string::npos) ? std::string::npos : (end - start)
+      );
+
+      std::string::size_type first = field.find_first_not_of(u8" \t");
+      std::string::size_type last = field.find_last_not_of(u8" \t");
+      if(first == std::string::npos) {
+        fields.emplace_back();
+      } else {
+        fields.push_back(field.substr(first, last - first + 1));
+      }
+
+      if(end == std::string::npos) {
+        return fields;
+      }
+      start = end + 1;
+    }
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+} // anonymous namespace
+
+namespace Nuclex::FrameFixer::Rendering {
+
+  // ------------------------------------------------------------------------------------------- //
+
+  const std::string RenderLeaseFile::Filename(u8"render-leases.txt");
+
+  // ------------------------------------------------------------------------------------------- //
+
+  const std::chrono::seconds RenderLeaseFile::DefaultLeaseDuration(120);
+
+  // ------------------------------------------------------------------------------------------- //
+
+  RenderLeaseFile::RenderLeaseFile(
+    const std::string &directory,
+    const std::string &workerName,
+    std::chrono::seconds leaseDuration /* = DefaultLeaseDuration */
+  ) :
+    path(directory),
+    lockPath(),
+    workerName(workerName),
+    leaseDuration(leaseDuration) {
+    std::string::size_type length = this->path.length();
+    if((length >= 1) && (this->path[length - 1] != '/')) {
+      this->path.push_back(u8'/');
+    }
+    this->path.append(Filename);
+
+    this->lockPath = this->path;
+    this->lockPath.append(u8".lock", 5);
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  RenderLeaseFile::~RenderLeaseFile() {}
+
+  // ------------------------------------------------------------------------------------------- //
+
+  std::string RenderLeaseFile::GetDefaultWorkerName() {
+    std::string name = QSysInfo::machineHostName().toStdString();
+    if(name.empty()) {
+      name.assign(u8"localhost", 9);
+    }
+    name.push_back(u8':');
+    Nuclex::Support::Text::lexical_append(
+      name, static_cast<std::uint64_t>(QCoreApplication::applicationPid())
+    );
+    return name;
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  void RenderLeaseFile::Prepare(
+    std::size_t startOutputFrameIndex, std::size_t endOutputFrameIndex, std::size_t chunkSize
+  ) {
+    if(chunkSize < 1) {
+      chunkSize = 1;
+    }
+
+    QLockFile lockFile(QString::fromStdString(this->lockPath));
+    lockOrThrow(lockFile);
+
+    // If another worker created the lease file already, make sure it is for the same
+    // output frames. The chunk size does not matter, whoever came first decided it.
+    std::vector<Chunk> chunks;
+    if(readChunks(chunks)) {
+      std::size_t existingStart = startOutputFrameIndex;
+      std::size_t existingEnd = startOutputFrameIndex;
+      if(!chunks.empty()) {
+        existingStart = chunks.front().StartOutputFrameIndex;
+        existingEnd = chunks.back().EndOutputFrameIndex;
+      }
+      if(
+        (existingStart != startOutputFrameIndex) ||
+        (std::max(existingEnd, existingStart) != endOutputFrameIndex)
+      ) {
+        std::string message(u8"Lease file '", 12);
+        message.append(this->path);
+        message.append(u8"' belongs to a render of output frames ", 39);
+        Nuclex::Support::Text::lexical_append(message, existingStart);
+        message.append(u8" to ", 4);
+        Nuclex::Support::Text::lexical_append(message, existingEnd);
+        message.append(u8", delete it to start over", 25);
+        throw std::runtime_error(message);
+      }
+
+      return;
+    }
+
+    for(std::size_t start = startOutputFrameIndex; start < endOutputFrameIndex; start += chunkSize) {
+      Chunk &chunk = chunks.emplace_back();
+      chunk.StartOutputFrameIndex = start;
+      chunk.EndOutputFrameIndex = std::min(start + chunkSize, endOutputFrameIndex);
+      chunk.State = ChunkState::Open;
+      chunk.ExpiryTime = 0;
+    }
+
+    writeChunks(chunks);
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  std::optional<RenderLease> RenderLeaseFile::Acquire() {
+    QLockFile lockFile(QString::fromStdString(this->lockPath));
+    lockOrThrow(lockFile);
+
+    std::vector<Chunk> chunks;
+    if(!readChunks(chunks)) {
+      throw std::runtime_error(u8"Lease file has not been prepared or was deleted");
+    }
+
+    // Take the first chunk nobody is working on. Chunks whose lease has expired
+    // belonged to a worker that crashed or lost its connection, so they're fair game.
+    std::uint64_t now = getCurrentTime();
+    for(Chunk &chunk : chunks) {
+      bool isAvailable = (
+        (chunk.State == ChunkState::Open) ||
+        ((chunk.State == ChunkState::Leased) && (chunk.ExpiryTime < now))
+      );
+      if(isAvailable) {
+        chunk.State = ChunkState::Leased;
+        chunk.WorkerName = this->workerName;
+        chunk.ExpiryTime = now + static_cast<std::uint64_t>(this->leaseDuration.count());
+        writeChunks(chunks);
+
+        RenderLease lease;
+        lease.StartOutputFrameIndex = chunk.StartOutputFrameIndex;
+        lease.EndOutputFrameIndex = chunk.EndOutputFrameIndex;
+        return lease;
+      }
+    }
+
+    return std::optional<RenderLease>();
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  bool RenderLeaseFile::Renew(const RenderLease &lease) {
+    return updateLease(lease, ChunkState::Leased);
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  void RenderLeaseFile::Complete(const RenderLease &lease) {
+    updateLease(lease, ChunkState::Done);
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  void RenderLeaseFile::Release(const RenderLease &lease) {
+    updateLease(lease, ChunkState::Open);
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  bool RenderLeaseFile::IsFinished() const {
+    QLockFile lockFile(QString::fromStdString(this->lockPath));
+    lockOrThrow(lockFile);
+
+    std::vector<Chunk> chunks;
+    readChunks(chunks);
+    for(const Chunk &chunk : chunks) {
+      if(chunk.State != ChunkState::Done) {
+        return false;
+      }
+    }
+
+    return true;
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  std::size_t RenderLeaseFile::CountCompletedFrames() const {
+    QLockFile lockFile(QString::fromStdString(this->lockPath));
+    lockOrThrow(lockFile);
+
+    std::vector<Chunk> chunks;
+    readChunks(chunks);
+
+    std::size_t completedFrameCount = 0;
+    for(const Chunk &chunk : chunks) {
+      if(chunk.State == ChunkState::Done) {
+        completedFrameCount += chunk.EndOutputFrameIndex - chunk.StartOutputFrameIndex;
+      }
+    }
+
+    return completedFrameCount;
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  bool RenderLeaseFile::readChunks(std::vector<Chunk> &chunks) const {
+    chunks.clear();
+
+    QFile leaseFile(QString::fromStdString(this->path));
+    if(!leaseFile.open(QIODevice::OpenModeFlag::ReadOnly | QIODevice::OpenModeFlag::Text)) {
+      return false;
+    }
+
+    // Each line is "start, end, state, worker, expiry time"
+    QTextStream leaseReader(&leaseFile);
+    while(!leaseReader.atEnd()) {
+      std::string line = leaseReader.readLine().toStdString();
+      if(line.empty() || (line[0] == u8'#')) {
+        continue;
+      }
+
+      std::vector<std::string> fields = splitFields(line);
+      if(fields.size() < 5) {
+        continue;
+      }
+
+      Chunk &chunk = chunks.emplace_back();
+      chunk.StartOutputFrameIndex = Nuclex::Support::Text::lexical_cast<std::size_t>(fields[0]);
+      chunk.EndOutputFrameIndex = Nuclex::Support::Text::lexical_cast<std::size_t>(fields[1]);
+      if(fields[2] == u8"done") {
+        chunk.State = ChunkState::Done;
+      } else if(fields[2] == u8"leased") {
+        chunk.State = ChunkState::Leased;
+      } else {
+        chunk.State = ChunkState::Open;
+      }
+      chunk.WorkerName = fields[3];
+      chunk.ExpiryTime = Nuclex::Support::Text::lexical_cast<std::uint64_t>(fields[4]);
+    }
+
+    return true;
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  void RenderLeaseFile::writeChunks(const std::vector<Chunk> &chunks) const {
+    std::string contents(
+      u8"# Output frame ranges handed out to render workers\n"
+      u8"# start, end (exclusive), state, worker, lease expiry (seconds since epoch)\n"
+    );
+    for(const Chunk &chunk : chunks) {
+      Nuclex::Support::Text::lexical_append(contents, chunk.StartOutputFrameIndex);
+      contents.append(u8", ", 2);
+      Nuclex::Support::Text::lexical_append(contents, chunk.EndOutputFrameIndex);
+      switch(chunk.State) {
+        case ChunkState::Done: { contents.append(u8", done, ", 8); break; }
+        case ChunkState::Leased: { contents.append(u8", leased, ", 10); break; }
+        default: { contents.append(u8", open, ", 8); break; }
+      }
+      contents.append(chunk.WorkerName.empty() ? std::string(u8"-", 1) : chunk.WorkerName);
+      contents.append(u8", ", 2);
+      Nuclex::Support::Text::lexical_append(contents, chunk.ExpiryTime);
+      contents.push_back(u8'\n');
+    }
+
+    // QSaveFile writes into a temporary file and renames it over the lease file,
+    // so other workers reading the file never see it half-written
+    QSaveFile leaseFile(QString::fromStdString(this->path));
+    bool saved = leaseFile.open(
+      QIODevice::OpenModeFlag::WriteOnly | QIODevice::OpenModeFlag::Text
+    );
+    if(saved) {
+      qint64 writtenByteCount = leaseFile.write(contents.data(), contents.length());
+      saved = (writtenByteCount == static_cast<qint64>(contents.length()));
+    }
+    if(saved) {
+      saved = leaseFile.commit();
+    } else {
+      leaseFile.cancelWriting();
+    }
+    if(!saved) {
+      std::string message(u8"Could not write lease file '", 28);
+      message.append(this->path);
+      message.append(u8"'", 1);
+      throw std::runtime_error(message);
+    }
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  bool RenderLeaseFile::updateLease(const RenderLease &lease, ChunkState newState) {
+    QLockFile lockFile(QString::fromStdString(this->lockPath));
+    lockOrThrow(lockFile);
+
+    std::vector<Chunk> chunks;
+    readChunks(chunks);
+    for(Chunk &chunk : chunks) {
+      bool isLeasedChunk = (
+        (chunk.StartOutputFrameIndex == lease.StartOutputFrameIndex) &&
+        (chunk.EndOutputFrameIndex == lease.EndOutputFrameIndex)
+      );
+      if(!isLeasedChunk) {
+        continue;
+      }
+
+      // Finished frames are finished, even if another worker took over the chunk
+      // in the meantime. Everything else requires that this worker still holds the lease.
+      bool isOwnLease = (
+        (chunk.State == ChunkState::Leased) && (chunk.WorkerName == this->workerName)
+      );
+      if(newState == ChunkState::Done) {
+        if(chunk.State == ChunkState::Done) {
+          return true;
+        }
+      } else if(!isOwnLease) {
+        return false;
+      }
+
+      chunk.State = newState;
+      if(newState == ChunkState::Leased) {
+        chunk.ExpiryTime = getCurrentTime() + static_cast<std::uint64_t>(
+          this->leaseDuration.count()
+        );
+      } else if(newState == ChunkState::Done) {
+        chunk.WorkerName = this->workerName;
+        chunk.ExpiryTime = 0;
+      } else {
+        chunk.WorkerName.clear();
+        chunk.ExpiryTime = 0;
+      }
+
+      writeChunks(chunks);
+      return true;
+    }
+
+    return false;
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+} // namespace Nuclex::FrameFixer::Rendering
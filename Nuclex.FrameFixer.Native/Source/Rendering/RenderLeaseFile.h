@@ -0,0 +1,206 @@
+#pragma region Apache License 2.0
+/*
+Nuclex Frame Fixer
+Copyright (C) 2024 Markus Ewald / Nuclex Development Labs
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#pragma endregion // Apache License 2.0
+
+#ifndef NUCLEX_FRAMEFIXER_RENDERING_RENDERLEASEFILE_H
+#define NUCLEX_FRAMEFIXER_RENDERING_RENDERLEASEFILE_H
+
+#include "Nuclex/FrameFixer/Config.h"
+
+#include <chrono> // for std::chrono::seconds
+#include <cstddef> // for std::size_t
+#include <cstdint> // for std::uint64_t
+#include <optional> // for std::optional
+#include <string> // for std::string
+#include <vector> // for std::vector
+
+namespace Nuclex::FrameFixer::Rendering {
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Range of output frames a worker process has been assigned to render</summary>
+  struct RenderLease {
+
+    /// <summary>First output frame the worker should render</summary>
+    public: std::size_t StartOutputFrameIndex;
+    /// <summary>Output frame index one past the last frame the worker should render</summary>
+    public: std::size_t EndOutputFrameIndex;
+
+  };
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Hands out ranges of output frames to several cooperating render processes</summary>
+  /// <remarks>
+  ///   <para>
+  ///     This splits one render across any number of worker processes, either on the same
+  ///     machine or on several machines that write into a shared directory. The output
+  ///     frames are divided into chunks which are recorded in a text file in the target
+  ///     directory. Each worker leases the next open chunk, renders it and marks it as done,
+  ///     then comes back for more, so fast workers automatically take on more chunks than
+  ///     slow ones and nobody has to split the movie by hand.
+  ///   </para>
+  ///   <para>
+  ///     Leases expire unless the worker renews them periodically. If a worker crashes or
+  ///     its machine goes down, its chunk is handed to the next worker asking for work
+  ///     once the lease has expired. Expiry times are absolute, so the clocks of machines
+  ///     sharing a render should be reasonably in sync.
+  ///   </para>
+  ///   <para>
+  ///     All access to the file is serialized through a lock file next to it and changes
+  ///     replace the file atomically, so workers never see a partially written file.
+  ///     Finished chunks stay recorded, so restarting the workers continues the render.
+  ///   </para>
+  /// </remarks>
+  class RenderLeaseFile {
+
+    /// <summary>Initializes a new lease file in the specified output directory</summary>
+    /// <param name="directory">Directory the rendered frames are being saved in</param>
+    /// <param name="workerName">Name identifying this worker in the lease file</param>
+    /// <param name="leaseDuration">Time after which a lease expires unless renewed</param>
+    public: RenderLeaseFile(
+      const std::string &directory,
+      const std::string &workerName,
+      std::chrono::seconds leaseDuration = DefaultLeaseDuration
+    );
+    /// <summary>Frees all resources owned by the lease file</summary>
+    public: ~RenderLeaseFile();
+
+    /// <summary>Name of the file the leases are stored in</summary>
+    public: static const std::string Filename;
+
+    /// <summary>Default time after which a lease expires unless it is renewed</summary>
+    public: static const std::chrono::seconds DefaultLeaseDuration;
+
+    /// <summary>Builds a worker name from the host name and process id</summary>
+    /// <returns>A name that is unique for the calling process across machines</returns>
+    public: static std::string GetDefaultWorkerName();
+
+    /// <summary>Creates the lease file or verifies that it matches the current render</summary>
+    /// <param name="startOutputFrameIndex">First output frame of the whole render</param>
+    /// <param name="endOutputFrameIndex">Output frame index one past the last frame</param>
+    /// <param name="chunkSize">Number of output frames handed out per lease</param>
+    /// <remarks>
+    ///   The first worker creates the file, all others check that they were started with
+    ///   the same range. If an existing file describes a different range, an exception is
+    ///   thrown, since mixing chunks of different renders would produce garbage.
+    /// </remarks>
+    public: void Prepare(
+      std::size_t startOutputFrameIndex, std::size_t endOutputFrameIndex, std::size_t chunkSize
+    );
+
+    /// <summary>Leases the next chunk of output frames that still needs rendering</summary>
+    /// <returns>
+    ///   The leased range of output frames or an empty value if all chunks are either done
+    ///   or currently leased to other workers
+    /// </returns>
+    /// <remarks>
+    ///   Chunks whose lease has expired are taken over, so the work of a worker that has
+    ///   stopped responding is not lost.
+    /// </remarks>
+    public: std::optional<RenderLease> Acquire();
+
+    /// <summary>Extends a lease so that other workers do not take it over</summary>
+    /// <param name="lease">Lease that will be extended</param>
+    /// <returns>
+    ///   True if the lease was extended, false if another worker has taken it over
+    ///   because it had expired already
+    /// </returns>
+    public: bool Renew(const RenderLease &lease);
+
+    /// <summary>Marks a leased chunk as rendered</summary>
+    /// <param name="lease">Lease of the chunk that has been rendered</param>
+    public: void Complete(const RenderLease &lease);
+
+    /// <summary>Gives up a lease so that another worker can render the chunk</summary>
+    /// <param name="lease">Lease that will be given up</param>
+    public: void Release(const RenderLease &lease);
+
+    /// <summary>Checks whether all chunks have been rendered</summary>
+    /// <returns>True if there is no more work left for any worker</returns>
+    public: bool IsFinished() const;
+
+    /// <summary>Counts the output frames in the chunks that are done</summary>
+    /// <returns>The number of output frames rendered by all workers together</returns>
+    public: std::size_t CountCompletedFrames() const;
+
+    /// <summary>Possible states of a chunk of output frames</summary>
+    private: enum class ChunkState {
+
+      /// <summary>Chunk still needs to be rendered and nobody is working on it</summary>
+      Open,
+      /// <summary>A worker is currently rendering the chunk</summary>
+      Leased,
+      /// <summary>The chunk has been rendered</summary>
+      Done
+
+    };
+
+    /// <summary>Range of output frames handed out as a unit</summary>
+    private: struct Chunk {
+
+      /// <summary>First output frame in the chunk</summary>
+      public: std::size_t StartOutputFrameIndex;
+      /// <summary>Output frame index one past the last frame in the chunk</summary>
+      public: std::size_t EndOutputFrameIndex;
+      /// <summary>Whether the chunk is open, leased or done</summary>
+      public: ChunkState State;
+      /// <summary>Name of the worker that leased or completed the chunk</summary>
+      public: std::string WorkerName;
+      /// <summary>Time at which the lease expires in seconds since the epoch</summary>
+      public: std::uint64_t ExpiryTime;
+
+    };
+
+    /// <summary>Reads all chunks from the lease file</summary>
+    /// <param name="chunks">Receives the chunks stored in the lease file</param>
+    /// <returns>True if the lease file existed, false otherwise</returns>
+    /// <remarks>
+    ///   Must be called with the lock file held.
+    /// </remarks>
+    private: bool readChunks(std::vector<Chunk> &chunks) const;
+
+    /// <summary>Replaces the contents of the lease file with the specified chunks</summary>
+    /// <param name="chunks">Chunks that will be stored in the lease file</param>
+    /// <remarks>
+    ///   Must be called with the lock file held.
+    /// </remarks>
+    private: void writeChunks(const std::vector<Chunk> &chunks) const;
+
+    /// <summary>Changes the state of a leased chunk if it is still held by this worker</summary>
+    /// <param name="lease">Lease of the chunk whose state will be changed</param>
+    /// <param name="newState">State the chunk will be changed to</param>
+    /// <returns>True if the chunk was still leased by this worker</returns>
+    private: bool updateLease(const RenderLease &lease, ChunkState newState);
+
+    /// <summary>Path of the lease file</summary>
+    private: std::string path;
+    /// <summary>Path of the lock file that serializes access to the lease file</summary>
+    private: std::string lockPath;
+    /// <summary>Name identifying this worker in the lease file</summary>
+    private: std::string workerName;
+    /// <summary>Time after which a lease expires unless it is renewed</summary>
+    private: std::chrono::seconds leaseDuration;
+
+  };
+
+  // ------------------------------------------------------------------------------------------- //
+
+} // namespace Nuclex::FrameFixer::Rendering
+
+#endif // NUCLEX_FRAMEFIXER_RENDERING_RENDERLEASEFILE_H
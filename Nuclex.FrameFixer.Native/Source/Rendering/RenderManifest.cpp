@@ -0,0 +1,399 @@
+#pragma region Apache License 2.0
+/*
+Nuclex Frame Fixer
+Copyright (C) 2024 Markus Ewald / Nuclex Development Labs
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#pragma endregion // Apache License 2.0
+
+// If the application is compiled as a DLL, this ensures symbols are exported
+#define NUCLEX_FRAMEFIXER_SOURCE 1
+
+#include "./RenderManifest.h"
+#include "./RenderPlan.h"
+#include "../Model/Movie.h"
+
+#include <QFile>
+#include <QFileInfo>
+#include <QTextStream>
+
+#include <Nuclex/Support/Text/LexicalCast.h> // for lexical_cast()
+#include <Nuclex/Support/Text/LexicalAppend.h> // for lexical_append()
+
+#include <algorithm> // for std::sort()
+#include <cstdlib> // for std::strtoull()
+
+namespace {
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Initial value of a 64 bit FNV-1a hash</summary>
+  const std::uint64_t FnvOffsetBasis = 14695981039346656037ULL;
+
+  /// <summary>Prime number by which a 64 bit FNV-1a hash is multiplied after each byte</summary>
+  const std::uint64_t FnvPrime = 1099511628211ULL;
+
+  /// <summary>Value mixed into the fingerprint of inserted interpolated frames</summary>
+  const std::uint64_t InsertedInterpolatedFrameMarker = 0x496E736572746564ULL;
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Mixes a number of bytes into a hash</summary>
+  /// <param name="hash">Hash the bytes will be mixed into</param>
+  /// <param name="data">Bytes that will be mixed into the hash</param>
+  /// <param name="byteCount">Number of bytes to mix into the hash</param>
+  /// <returns>The updated hash</returns>
+  std::uint64_t hashBytes(std::uint64_t hash, const void *data, std::size_t byteCount) {
+    const std::uint8_t *bytes = reinterpret_cast<const std::uint8_t *>(data);
+    for(std::size_t index = 0; index < byteCount; ++index) {
+      hash ^= bytes[index];
+      hash *= FnvPrime;
+    }
+
+    return hash;
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Mixes a number into a hash</summary>
+  /// <param name="hash">Hash the number will be mixed into</param>
+  /// <param name="value">Number that will be mixed into the hash</param>
+  /// <returns>The updated hash</returns>
+  std::uint64_t hashValue(std::uint64_t hash, std::uint64_t value) {
+    return hashBytes(hash, &value, sizeof(value));
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Mixes the characters of a string into a hash</summary>
+  /// <param name="hash">Hash the string will be mixed into</param>
+  /// <param name="text">String that will be mixed into the hash</param>
+  /// <returns>The updated hash</returns>
+  std::uint64_t hashString(std::uint64_t hash, const std::string &text) {
+    hash = hashBytes(hash, text.data(), text.length());
+    return hashValue(hash, text.length());
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Calculates a hash identifying the current state of an input frame's file</summary>
+  /// <param name="movie">Movie containing the frame</param>
+  /// <param name="frameIndex">Index of the frame whose file will be identified</param>
+  /// <param name="fileHashes">Stores the hashes of files that have already been checked</param>
+  /// <returns>A hash that changes when the file is modified</returns>
+  std::uint64_t hashSourceFile(
+    const Nuclex::FrameFixer::Movie &movie,
+    std::size_t frameIndex,
+    std::vector<std::uint64_t> &fileHashes
+  ) {
+    if(fileHashes[frameIndex] == 0) {
+      QFileInfo fileInfo(QString::fromStdString(movie.GetFramePath(frameIndex)));
+
+      std::uint64_t hash = hashString(FnvOffsetBasis, movie.Frames[frameIndex].Filename);
+      hash = hashValue(hash, static_cast<std::uint64_t>(fileInfo.size()));
+      hash = hashValue(
+        hash, static_cast<std::uint64_t>(fileInfo.lastModified().toMSecsSinceEpoch())
+      );
+      fileHashes[frameIndex] = (hash == 0) ? 1 : hash;
+    }
+
+    return fileHashes[frameIndex];
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Determines which frame's image will be loaded when a frame is needed</summary>
+  /// <param name="movie">Movie containing the frame</param>
+  /// <param name="frameIndex">Index of the frame whose source will be determined</param>
+  /// <returns>The index of the frame whose image file will be loaded</returns>
+  std::size_t getSourceFrameIndex(const Nuclex::FrameFixer::Movie &movie, std::size_t frameIndex) {
+    const Nuclex::FrameFixer::Frame &frame = movie.Frames[frameIndex];
+    if(frame.LeftOrReplacementIndex.has_value()) {
+      return frame.LeftOrReplacementIndex.value();
+    } else {
+      return frameIndex;
+    }
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Appends a number as 16 hexadecimal digits to a string</summary>
+  /// <param name="target">String to which the number will be appended</param>
+  /// <param name="value">Number that will be appended</param>
+  void appendHexadecimal(std::string &target, std::uint64_t value) {
+    static const char digits[] = u8"0123456789abcdef";
+    for(int shift = 60; shift >= 0; shift -= 4) {
+      target.push_back(digits[(value >> shift) & 0xF]);
+    }
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+}
+
+namespace Nuclex::FrameFixer::Rendering {
+
+  // ------------------------------------------------------------------------------------------- //
+
+  const std::string RenderManifest::Filename(u8"render-manifest.txt");
+
+  // ------------------------------------------------------------------------------------------- //
+
+  RenderManifest::RenderManifest(const std::string &directory) :
+    path(directory),
+    mutex(),
+    recordedFingerprints(),
+    expectedFingerprints(),
+    journal() {
+    std::string::size_type length = this->path.length();
+    if((length >= 1) && (this->path[length - 1] != '/')) {
+      this->path.push_back(u8'/');
+    }
+    this->path.append(Filename);
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  RenderManifest::~RenderManifest() {}
+
+  // ------------------------------------------------------------------------------------------- //
+
+  void RenderManifest::Load() {
+    std::unique_lock<std::mutex> manifestLock(this->mutex);
+    this->recordedFingerprints.clear();
+
+    QFile manifestFile(QString::fromStdString(this->path));
+    if(!manifestFile.open(QIODevice::OpenModeFlag::ReadOnly | QIODevice::OpenModeFlag::Text)) {
+      return; // No manifest, so this is the first render into the directory
+    }
+
+    // Later entries override earlier ones, a fingerprint of zero marks a frame
+    // that was about to be overwritten when the manifest was last written to.
+    QTextStream manifestReader(&manifestFile);
+    while(!manifestReader.atEnd()) {
+      std::string line = manifestReader.readLine().toStdString();
+
+      std::string::size_type commaIndex = line.find(u8',');
+      if(commaIndex == std::string::npos) {
+        continue; // Incomplete line, the render probably crashed while writing it
+      }
+
+      std::size_t outputFrameIndex = Nuclex::Support::Text::lexical_cast<std::size_t>(
+        line.substr(0, commaIndex)
+      );
+      std::uint64_t fingerprint = std::strtoull(line.c_str() + commaIndex + 1, nullptr, 16);
+      if(fingerprint == 0) {
+        this->recordedFingerprints.erase(outputFrameIndex);
+      } else {
+        this->recordedFingerprints[outputFrameIndex] = fingerprint;
+      }
+    }
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  void RenderManifest::CalculateFingerprints(
+    const Movie &movie, const RenderPlan &plan, const std::string &settings
+  ) {
+    std::vector<std::uint64_t> fileHashes(movie.Frames.size(), 0);
+    std::uint64_t settingsFingerprint = hashString(FnvOffsetBasis, settings);
+
+    // First hash what goes into each operation by itself: its action and the state
+    // of the files it loads. How operations depend on each other comes after.
+    std::size_t operationCount = plan.GetOperationCount();
+    std::vector<std::uint64_t> operationHashes;
+    operationHashes.reserve(operationCount);
+    for(std::size_t operationIndex = 0; operationIndex < operationCount; ++operationIndex) {
+      const RenderOperation &operation = plan.GetOperation(operationIndex);
+
+      std::uint64_t hash = hashValue(FnvOffsetBasis, static_cast<std::uint64_t>(operation.Type));
+      hash = hashValue(hash, static_cast<std::uint64_t>(operation.Action));
+
+      if(operation.SourceFrameIndex != RenderOperation::None) {
+        hash = hashValue(hash, hashSourceFile(movie, operation.SourceFrameIndex, fileHashes));
+      }
+
+      // The next frame may be looked at by the deinterlacer and is used to interpolate
+      // an inserted frame, in which case its action matters, too.
+      if(operation.NextFrameIndex != RenderOperation::None) {
+        std::size_t nextSourceIndex = getSourceFrameIndex(movie, operation.NextFrameIndex);
+        hash = hashValue(hash, hashSourceFile(movie, nextSourceIndex, fileHashes));
+        hash = hashValue(
+          hash, static_cast<std::uint64_t>(movie.Frames[operation.NextFrameIndex].Action)
+        );
+      }
+
+      for(std::size_t index = 0; index < operation.AveragedFrameCount; ++index) {
+        std::size_t sourceIndex = getSourceFrameIndex(
+          movie, operation.FirstAveragedFrameIndex + index
+        );
+        hash = hashValue(hash, hashSourceFile(movie, sourceIndex, fileHashes));
+      }
+
+      if(operation.InterpolationSourceIndices.has_value()) {
+        const std::pair<std::size_t, std::size_t> &sourceIndices = (
+          operation.InterpolationSourceIndices.value()
+        );
+        hash = hashValue(hash, hashSourceFile(movie, sourceIndices.first, fileHashes));
+        hash = hashValue(hash, hashSourceFile(movie, sourceIndices.second, fileHashes));
+      }
+
+      operationHashes.push_back(hash);
+    }
+
+    std::vector<std::uint64_t> fingerprints;
+    fingerprints.reserve(plan.GetEndOutputFrameIndex() - 1);
+
+    // An operation's output frames depend on the operations from the point where
+    // the renderer would begin (or warm up) to produce them. Only those go into
+    // the fingerprint, so an edited tag invalidates the frames up to the end of
+    // the warm-up window behind it rather than everything after it.
+    for(std::size_t operationIndex = 0; operationIndex < operationCount; ++operationIndex) {
+      const RenderOperation &operation = plan.GetOperation(operationIndex);
+
+      std::uint64_t fingerprint = settingsFingerprint;
+      std::size_t startOperationIndex = plan.FindIndependentOperation(operationIndex);
+      for(std::size_t index = startOperationIndex; index <= operationIndex; ++index) {
+        fingerprint = hashValue(fingerprint, operationHashes[index]);
+      }
+
+      // Zero is used to mark invalidated frames in the manifest file
+      if(fingerprint == 0) {
+        fingerprint = 1;
+      }
+
+      fingerprints.insert(fingerprints.end(), operation.OutputFrameCount, fingerprint);
+      if(operation.InsertInterpolatedAfter) {
+        fingerprints.push_back(hashValue(fingerprint, InsertedInterpolatedFrameMarker));
+      }
+    }
+
+    std::unique_lock<std::mutex> manifestLock(this->mutex);
+    this->expectedFingerprints.swap(fingerprints);
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  bool RenderManifest::IsUpToDate(
+    std::size_t outputFrameIndex, const std::string &outputPath
+  ) const {
+    {
+      std::unique_lock<std::mutex> manifestLock(this->mutex);
+      if((outputFrameIndex < 1) || (outputFrameIndex > this->expectedFingerprints.size())) {
+        return false;
+      }
+
+      auto iterator = this->recordedFingerprints.find(outputFrameIndex);
+      if(iterator == this->recordedFingerprints.end()) {
+        return false;
+      }
+      if(iterator->second != this->expectedFingerprints[outputFrameIndex - 1]) {
+        return false;
+      }
+    }
+
+    // The user may have deleted some of the output frames since the last render
+    return QFile::exists(QString::fromStdString(outputPath));
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  void RenderManifest::Invalidate(std::size_t outputFrameIndex) {
+    std::unique_lock<std::mutex> manifestLock(this->mutex);
+
+    // If the frame is recorded, remove it from the manifest before its file gets
+    // overwritten. Otherwise, a crash during writing could leave a damaged file behind
+    // that would be considered up to date if the user reverted their changes.
+    auto iterator = this->recordedFingerprints.find(outputFrameIndex);
+    if(iterator != this->recordedFingerprints.end()) {
+      this->recordedFingerprints.erase(iterator);
+      appendEntry(outputFrameIndex, 0);
+    }
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  void RenderManifest::Record(std::size_t outputFrameIndex) {
+    std::unique_lock<std::mutex> manifestLock(this->mutex);
+    if((outputFrameIndex < 1) || (outputFrameIndex > this->expectedFingerprints.size())) {
+      return;
+    }
+
+    std::uint64_t fingerprint = this->expectedFingerprints[outputFrameIndex - 1];
+    this->recordedFingerprints[outputFrameIndex] = fingerprint;
+    appendEntry(outputFrameIndex, fingerprint);
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  void RenderManifest::Save() {
+    std::unique_lock<std::mutex> manifestLock(this->mutex);
+    this->journal.reset();
+
+    std::vector<std::pair<std::size_t, std::uint64_t>> entries(
+      this->recordedFingerprints.begin(), this->recordedFingerprints.end()
+    );
+    std::sort(entries.begin(), entries.end());
+
+    QFile manifestFile(QString::fromStdString(this->path));
+    if(
+      manifestFile.open(
+        QIODevice::OpenModeFlag::WriteOnly |
+        QIODevice::OpenModeFlag::Truncate |
+        QIODevice::OpenModeFlag::Text
+      )
+    ) {
+      std::string line;
+      for(std::size_t index = 0; index < entries.size(); ++index) {
+        line.clear();
+        Nuclex::Support::Text::lexical_append(line, entries[index].first);
+        line.append(u8", ");
+        appendHexadecimal(line, entries[index].second);
+        line.append(u8"\n");
+
+        manifestFile.write(line.data(), line.length());
+      }
+    }
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  void RenderManifest::appendEntry(std::size_t outputFrameIndex, std::uint64_t fingerprint) {
+    if(!static_cast<bool>(this->journal)) {
+      this->journal = std::make_unique<QFile>(QString::fromStdString(this->path));
+      bool opened = this->journal->open(
+        QIODevice::OpenModeFlag::WriteOnly |
+        QIODevice::OpenModeFlag::Append |
+        QIODevice::OpenModeFlag::Text
+      );
+      if(!opened) {
+        this->journal.reset();
+        return; // Manifest can't be written, so the next render will start over
+      }
+    }
+
+    std::string line;
+    Nuclex::Support::Text::lexical_append(line, outputFrameIndex);
+    line.append(u8", ");
+    appendHexadecimal(line, fingerprint);
+    line.append(u8"\n");
+
+    // Flush after each entry so the manifest survives if the application crashes
+    this->journal->write(line.data(), line.length());
+    this->journal->flush();
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+} // namespace Nuclex::FrameFixer::Rendering
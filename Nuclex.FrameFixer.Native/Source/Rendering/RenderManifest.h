@@ -0,0 +1,149 @@
+#pragma region Apache License 2.0
+/*
+Nuclex Frame Fixer
+Copyright (C) 2024 Markus Ewald / Nuclex Development Labs
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#pragma endregion // Apache License 2.0
+
+#ifndef NUCLEX_FRAMEFIXER_RENDERING_RENDERMANIFEST_H
+#define NUCLEX_FRAMEFIXER_RENDERING_RENDERMANIFEST_H
+
+#include "Nuclex/FrameFixer/Config.h"
+
+#include <cstddef> // for std::size_t
+#include <cstdint> // for std::uint64_t
+#include <string> // for std::string
+#include <vector> // for std::vector
+#include <unordered_map> // for std::unordered_map
+#include <memory> // for std::unique_ptr
+#include <mutex> // for std::mutex
+
+class QFile;
+
+namespace Nuclex::FrameFixer {
+
+  // ------------------------------------------------------------------------------------------- //
+
+  class Movie;
+
+  // ------------------------------------------------------------------------------------------- //
+
+}
+
+namespace Nuclex::FrameFixer::Rendering {
+
+  // ------------------------------------------------------------------------------------------- //
+
+  class RenderPlan;
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Remembers the inputs each output frame in a directory was rendered from</summary>
+  /// <remarks>
+  ///   <para>
+  ///     Each output frame gets a fingerprint calculated from everything that goes into it:
+  ///     the source frames (their file names, sizes and modification times), the actions
+  ///     assigned to them, the deinterlacer and interpolator used, the field order and,
+  ///     where a frame depends on the frames processed before it, the inputs of those
+  ///     frames back to where the renderer could begin or warm up to produce it (see
+  ///     <see cref="RenderPlan.FindIndependentOperation" />). If an output file exists and
+  ///     its recorded fingerprint matches the one calculated for the current render,
+  ///     the file does not need to be written again.
+  ///   </para>
+  ///   <para>
+  ///     The manifest is stored as a text file in the output directory. Frames are appended
+  ///     to it as soon as their file has been written, so if a render crashes or is canceled,
+  ///     the next render picks up where it left off. When a render completes, the file is
+  ///     rewritten to drop superseded entries.
+  ///   </para>
+  ///   <para>
+  ///     All methods are thread-safe since frames are recorded by the encoder threads.
+  ///   </para>
+  /// </remarks>
+  class RenderManifest {
+
+    /// <summary>Initializes a new render manifest for the specified output directory</summary>
+    /// <param name="directory">Directory the rendered frames are being saved in</param>
+    public: RenderManifest(const std::string &directory);
+    /// <summary>Frees all resources owned by the render manifest</summary>
+    public: ~RenderManifest();
+
+    /// <summary>Name of the file the manifest is stored in</summary>
+    public: static const std::string Filename;
+
+    /// <summary>Loads the manifest of a prior render from the output directory</summary>
+    /// <remarks>
+    ///   If there is no manifest in the output directory, all output frames will be
+    ///   considered outdated.
+    /// </remarks>
+    public: void Load();
+
+    /// <summary>Calculates the fingerprints the output frames should have</summary>
+    /// <param name="movie">Movie that is being rendered</param>
+    /// <param name="plan">Render plan the renderer will be executing</param>
+    /// <param name="settings">
+    ///   Description of all renderer settings that affect the output frames, such as
+    ///   the deinterlacer and interpolator names
+    /// </param>
+    public: void CalculateFingerprints(
+      const Movie &movie, const RenderPlan &plan, const std::string &settings
+    );
+
+    /// <summary>Checks whether an output frame already exists with the right inputs</summary>
+    /// <param name="outputFrameIndex">Index of the output frame that will be checked</param>
+    /// <param name="outputPath">Path of the file the output frame is saved in</param>
+    /// <returns>True if the output frame does not need to be written again</returns>
+    public: bool IsUpToDate(std::size_t outputFrameIndex, const std::string &outputPath) const;
+
+    /// <summary>Marks an output frame as outdated before its file is overwritten</summary>
+    /// <param name="outputFrameIndex">Index of the output frame that will be overwritten</param>
+    public: void Invalidate(std::size_t outputFrameIndex);
+
+    /// <summary>Records that an output frame has been written with the current inputs</summary>
+    /// <param name="outputFrameIndex">Index of the output frame that was written</param>
+    public: void Record(std::size_t outputFrameIndex);
+
+    /// <summary>Rewrites the manifest file, dropping entries that were superseded</summary>
+    public: void Save();
+
+    /// <summary>Appends an entry to the manifest file on disk</summary>
+    /// <param name="outputFrameIndex">Index of the output frame the entry is for</param>
+    /// <param name="fingerprint">Fingerprint that will be recorded for the frame</param>
+    /// <remarks>
+    ///   Must be called with the mutex held.
+    /// </remarks>
+    private: void appendEntry(std::size_t outputFrameIndex, std::uint64_t fingerprint);
+
+    /// <summary>Path of the manifest file</summary>
+    private: std::string path;
+    /// <summary>Must be held while accessing the manifest's state</summary>
+    private: mutable std::mutex mutex;
+    /// <summary>Fingerprints the existing output frames were rendered with</summary>
+    private: std::unordered_map<std::size_t, std::uint64_t> recordedFingerprints;
+    /// <summary>Fingerprints the output frames of the current render will have</summary>
+    /// <remarks>
+    ///   Output frames are numbered beginning at 1, so element 0 is for output frame 1.
+    /// </remarks>
+    private: std::vector<std::uint64_t> expectedFingerprints;
+    /// <summary>Manifest file opened for appending, if any entries were added</summary>
+    private: std::unique_ptr<QFile> journal;
+
+  };
+
+  // ------------------------------------------------------------------------------------------- //
+
+} // namespace Nuclex::FrameFixer::Rendering
+
+#endif // NUCLEX_FRAMEFIXER_RENDERING_RENDERMANIFEST_H
@@ -0,0 +1,115 @@
+#pragma region Apache License 2.0
+/*
+Nuclex Frame Fixer
+Copyright (C) 2024 Markus Ewald / Nuclex Development Labs
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#pragma endregion // Apache License 2.0
+
+#ifndef NUCLEX_FRAMEFIXER_RENDERING_RENDEROPERATION_H
+#define NUCLEX_FRAMEFIXER_RENDERING_RENDEROPERATION_H
+
+#include "Nuclex/FrameFixer/Config.h"
+#include "../Model/FrameAction.h"
+
+#include <cstddef> // for std::size_t
+#include <optional> // for std::optional
+#include <utility> // for std::pair
+
+namespace Nuclex::FrameFixer::Rendering {
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Kinds of steps the renderer carries out when executing a render plan</summary>
+  enum class RenderOperationType {
+
+    /// <summary>Loads and processes an input frame, then emits its output frames</summary>
+    ProcessFrame,
+
+    /// <summary>Averages a run of frames into the processed frame before them</summary>
+    /// <remarks>
+    ///   The averaged image is emitted as the output frames of the frame before the run
+    ///   and, unless averaged frames are collapsed, once more for each averaged frame.
+    /// </remarks>
+    EmitAverage
+
+  };
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Single step in a precompiled render plan</summary>
+  struct RenderOperation {
+
+    /// <summary>Value used for frame indices that don't apply to an operation</summary>
+    public: static constexpr std::size_t None = std::size_t(-1);
+
+    /// <summary>What the renderer needs to do in this step</summary>
+    public: RenderOperationType Type;
+    /// <summary>Input frame the operation is carried out for</summary>
+    /// <remarks>
+    ///   All output frames produced by the operation count as produced by this input frame
+    ///   when the render is restricted to a range of input frames.
+    /// </remarks>
+    public: std::size_t InputFrameIndex;
+    /// <summary>Action that will be performed, with flipped fields already accounted for</summary>
+    /// <remarks>
+    ///   For an <see cref="RenderOperationType.EmitAverage" /> operation, this is
+    ///   the action of the frame the averaged frames are blended into.
+    /// </remarks>
+    public: FrameAction Action;
+    /// <summary>Frame whose image file will be loaded, after applying replacements</summary>
+    public: std::size_t SourceFrameIndex;
+    /// <summary>Input frame processed right before this one or None</summary>
+    /// <remarks>
+    ///   This is the frame whose processed image a deinterlacer sees as its prior frame.
+    ///   For an <see cref="RenderOperationType.EmitAverage" /> operation, it is
+    ///   the frame into which the averaged frames are blended.
+    /// </remarks>
+    public: std::size_t PriorFrameIndex;
+    /// <summary>Input frame a deinterlacer can look at as the next frame or None</summary>
+    public: std::size_t NextFrameIndex;
+    /// <summary>First frame in the run of averaged frames</summary>
+    public: std::size_t FirstAveragedFrameIndex;
+    /// <summary>Number of frames in the run of averaged frames</summary>
+    public: std::size_t AveragedFrameCount;
+    /// <summary>Frames between which the frame will be interpolated, if any</summary>
+    public: std::optional<std::pair<std::size_t, std::size_t>> InterpolationSourceIndices;
+    /// <summary>Output frame index of the first output frame the operation produces</summary>
+    public: std::size_t FirstOutputFrameIndex;
+    /// <summary>Number of times the resulting image is emitted as an output frame</summary>
+    public: std::size_t OutputFrameCount;
+    /// <summary>Whether an interpolated frame is emitted after the resulting image</summary>
+    public: bool InsertInterpolatedAfter;
+    /// <summary>Whether rendering can begin at this operation without any earlier state</summary>
+    /// <remarks>
+    ///   Operations inside or right after a run of averaged frames, deinterlacing
+    ///   operations (if the deinterlacer looks at the processed prior frame) and
+    ///   interpolations from earlier frames depend on what came before them.
+    /// </remarks>
+    public: bool IsIndependent;
+    /// <summary>Whether rendering can begin here if the following frames are discarded</summary>
+    /// <remarks>
+    ///   True for independent operations and for deinterlacing operations that only depend
+    ///   on the deinterlacer's prior frame. Without the prior frame, the deinterlacer's
+    ///   output differs for a few frames, so those are rendered as a warm-up and thrown away.
+    /// </remarks>
+    public: bool CanBeginWarmUp;
+
+  };
+
+  // ------------------------------------------------------------------------------------------- //
+
+} // namespace Nuclex::FrameFixer::Rendering
+
+#endif // NUCLEX_FRAMEFIXER_RENDERING_RENDEROPERATION_H
@@ -0,0 +1,326 @@
+#pragma region Apache License 2.0
+/*
+Nuclex Frame Fixer
+Copyright (C) 2024 Markus Ewald / Nuclex Development Labs
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#pragma endregion // Apache License 2.0
+
+// If the application is compiled as a DLL, this ensures symbols are exported
+#define NUCLEX_FRAMEFIXER_SOURCE 1
+
+#include "./RenderPlan.h"
+#include "../Model/Movie.h"
+
+namespace {
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Checks whether the deinterlacer will be run on frames with an action</summary>
+  /// <param name="action">Action that will be checked</param>
+  /// <returns>True if frames with the specified action will be deinterlaced</returns>
+  bool isDeinterlaced(Nuclex::FrameFixer::FrameAction action) {
+    using Nuclex::FrameFixer::FrameAction;
+    return (
+      (action == FrameAction::TopFieldFirst) ||
+      (action == FrameAction::BottomFieldFirst) ||
+      (action == FrameAction::TopFieldOnly) ||
+      (action == FrameAction::BottomFieldOnly)
+    );
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+}
+
+namespace Nuclex::FrameFixer::Rendering {
+
+  // ------------------------------------------------------------------------------------------- //
+
+  const std::size_t RenderPlan::WarmUpOperationCount = 10;
+
+  // ------------------------------------------------------------------------------------------- //
+
+  RenderPlan::RenderPlan(
+    const Movie &movie,
+    bool flipFields,
+    bool collapseAverageFrames,
+    const std::optional<std::pair<std::size_t, std::size_t>> &inputFrameRange,
+    bool needsPriorFrame
+  ) :
+    operations(),
+    firstOperationOfInputFrame(),
+    operationOfOutputFrame() {
+    std::size_t frameCount = movie.Frames.size();
+
+    this->operations.reserve(frameCount + frameCount / 4);
+    this->firstOperationOfInputFrame.reserve(frameCount + 1);
+
+    std::size_t outputFrameIndex = 1;
+    std::size_t priorFrameIndex = RenderOperation::None;
+    std::size_t firstAveragedFrameIndex = 0;
+    std::size_t averagedFrameCount = 0;
+    FrameAction firstImageToAverageType = FrameAction::Unknown;
+
+    for(std::size_t frameIndex = 0; frameIndex < frameCount; ++frameIndex) {
+      const Frame &currentFrame = movie.Frames[frameIndex];
+      FrameAction currentFrameType = GetFrameAction(currentFrame, flipFields);
+
+      this->firstOperationOfInputFrame.push_back(this->operations.size());
+
+      // Frames tagged for averaging are collected until the run ends. The run is
+      // flushed when the frame after it comes up or at the end of the movie / range.
+      if(currentFrameType == FrameAction::Average) {
+        if(averagedFrameCount == 0) {
+          firstAveragedFrameIndex = frameIndex;
+        }
+        ++averagedFrameCount;
+
+        bool isLastFrame = ((frameIndex + 1) >= frameCount);
+        if(inputFrameRange.has_value()) {
+          isLastFrame |= ((frameIndex + 1) >= inputFrameRange.value().second);
+        }
+        if(!isLastFrame) {
+          continue;
+        }
+      }
+      if(averagedFrameCount >= 1) {
+        RenderOperation &emitAverage = this->operations.emplace_back();
+        emitAverage.Type = RenderOperationType::EmitAverage;
+        emitAverage.InputFrameIndex = frameIndex;
+        emitAverage.Action = firstImageToAverageType;
+        emitAverage.SourceFrameIndex = RenderOperation::None;
+        emitAverage.PriorFrameIndex = priorFrameIndex;
+        emitAverage.NextFrameIndex = RenderOperation::None;
+        emitAverage.FirstAveragedFrameIndex = firstAveragedFrameIndex;
+        emitAverage.AveragedFrameCount = averagedFrameCount;
+        emitAverage.FirstOutputFrameIndex = outputFrameIndex;
+        if(firstImageToAverageType == FrameAction::Triplicate) {
+          emitAverage.OutputFrameCount = 3;
+        } else if(firstImageToAverageType == FrameAction::Duplicate) {
+          emitAverage.OutputFrameCount = 2;
+        } else {
+          emitAverage.OutputFrameCount = 1;
+        }
+        if(!collapseAverageFrames) {
+          emitAverage.OutputFrameCount += averagedFrameCount;
+        }
+        emitAverage.InsertInterpolatedAfter = false;
+        emitAverage.IsIndependent = false;
+        emitAverage.CanBeginWarmUp = false;
+
+        outputFrameIndex += emitAverage.OutputFrameCount;
+        averagedFrameCount = 0;
+      }
+
+      RenderOperation &processFrame = this->operations.emplace_back();
+      processFrame.Type = RenderOperationType::ProcessFrame;
+      processFrame.InputFrameIndex = frameIndex;
+      processFrame.Action = currentFrameType;
+      if(currentFrame.LeftOrReplacementIndex.has_value()) {
+        processFrame.SourceFrameIndex = currentFrame.LeftOrReplacementIndex.value();
+      } else {
+        processFrame.SourceFrameIndex = frameIndex;
+      }
+      processFrame.PriorFrameIndex = priorFrameIndex;
+      if((frameIndex + 1) < frameCount) {
+        processFrame.NextFrameIndex = frameIndex + 1;
+      } else {
+        processFrame.NextFrameIndex = RenderOperation::None;
+      }
+      processFrame.FirstAveragedFrameIndex = RenderOperation::None;
+      processFrame.AveragedFrameCount = 0;
+      if(currentFrameType == FrameAction::Interpolate) {
+        processFrame.InterpolationSourceIndices = currentFrame.InterpolationSourceIndices;
+      }
+      processFrame.FirstOutputFrameIndex = outputFrameIndex;
+
+      // Rendering can't begin inside or right after a run of averaged frames, nor on
+      // a frame interpolated from earlier frames. On a deinterlaced frame, if the
+      // deinterlacer looks at the processed previous frame, it can only begin as a warm-up.
+      if(frameIndex == 0) {
+        processFrame.CanBeginWarmUp = true;
+      } else {
+        processFrame.CanBeginWarmUp = (
+          (currentFrame.Action != FrameAction::Average) &&
+          (movie.Frames[frameIndex - 1].Action != FrameAction::Average)
+        );
+        if(processFrame.InterpolationSourceIndices.has_value()) {
+          processFrame.CanBeginWarmUp &= (
+            processFrame.InterpolationSourceIndices.value().first >= frameIndex
+          );
+        }
+      }
+      processFrame.IsIndependent = processFrame.CanBeginWarmUp;
+      if(needsPriorFrame && (frameIndex > 0)) {
+        processFrame.IsIndependent &= !isDeinterlaced(currentFrameType);
+      }
+
+      // If the frame that follows is tagged for averaging, this frame's image is held
+      // back and will be emitted once it has been averaged with the following frames
+      bool nextImageUsesAveraging = false;
+      if((frameIndex + 1) < frameCount) {
+        if(movie.Frames[frameIndex + 1].Action == FrameAction::Average) {
+          nextImageUsesAveraging = true;
+        }
+      }
+      if(inputFrameRange.has_value()) {
+        nextImageUsesAveraging &= ((frameIndex + 1) < inputFrameRange.value().second);
+      }
+
+      if(nextImageUsesAveraging) {
+        firstImageToAverageType = currentFrameType;
+        processFrame.OutputFrameCount = 0;
+        processFrame.InsertInterpolatedAfter = false;
+      } else {
+        switch(currentFrameType) {
+          case FrameAction::Discard: { processFrame.OutputFrameCount = 0; break; }
+          case FrameAction::Duplicate: { processFrame.OutputFrameCount = 2; break; }
+          case FrameAction::Triplicate: { processFrame.OutputFrameCount = 3; break; }
+          default: { processFrame.OutputFrameCount = 1; break; }
+        }
+
+        // The last frame of the movie has no following frame to interpolate towards
+        processFrame.InsertInterpolatedAfter = (
+          currentFrame.AlsoInsertInterpolatedAfter.has_value() &&
+          currentFrame.AlsoInsertInterpolatedAfter.value() &&
+          ((frameIndex + 1) < frameCount)
+        );
+      }
+
+      outputFrameIndex += processFrame.OutputFrameCount;
+      if(processFrame.InsertInterpolatedAfter) {
+        ++outputFrameIndex;
+      }
+
+      priorFrameIndex = frameIndex;
+    } // for each frame index
+
+    this->firstOperationOfInputFrame.push_back(this->operations.size());
+
+    // Build the reverse lookup from output frames to the operations producing them
+    this->operationOfOutputFrame.reserve(outputFrameIndex - 1);
+    for(std::size_t index = 0; index < this->operations.size(); ++index) {
+      const RenderOperation &operation = this->operations[index];
+
+      std::size_t producedFrameCount = operation.OutputFrameCount;
+      if(operation.InsertInterpolatedAfter) {
+        ++producedFrameCount;
+      }
+      this->operationOfOutputFrame.insert(
+        this->operationOfOutputFrame.end(), producedFrameCount, index
+      );
+    }
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  RenderPlan::~RenderPlan() {}
+
+  // ------------------------------------------------------------------------------------------- //
+
+  FrameAction RenderPlan::GetFrameAction(const Frame &frame, bool flipFields /* = false */) {
+
+    // Use the assigned frame type. If none was assigned, use the determined frame type
+    // which is calculated by other parts of the application by either detecting combing
+    // patterns or repeating the most recent 5-frame cycle.
+    FrameAction frameType = frame.Action;
+    if(frameType == FrameAction::Unknown) {
+      // TODO: Re-enable once the DeinterlaceMode split is complete
+      //frameType = frame.ProvisionalMode;
+    }
+
+    // Swap top and bottom field enum values if the field order is set to flipped.
+    if(flipFields) {
+      switch(frameType) {
+        case FrameAction::TopFieldFirst: { frameType = FrameAction::BottomFieldFirst; break; }
+        case FrameAction::BottomFieldFirst: { frameType = FrameAction::TopFieldFirst; break; }
+        case FrameAction::TopFieldOnly: { frameType = FrameAction::BottomFieldOnly; break; }
+        case FrameAction::BottomFieldOnly: { frameType = FrameAction::TopFieldOnly; break; }
+        default: { break; }
+      }
+    }
+
+    return frameType;
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  std::size_t RenderPlan::GetEndOutputFrameIndex() const {
+    return this->operationOfOutputFrame.size() + 1;
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  std::size_t RenderPlan::GetFirstOutputFrameIndex(std::size_t operationIndex) const {
+    if(operationIndex < this->operations.size()) {
+      return this->operations[operationIndex].FirstOutputFrameIndex;
+    } else {
+      return GetEndOutputFrameIndex();
+    }
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  std::size_t RenderPlan::FindFirstOperationOfInputFrame(std::size_t frameIndex) const {
+    if(frameIndex < this->firstOperationOfInputFrame.size()) {
+      return this->firstOperationOfInputFrame[frameIndex];
+    } else {
+      return this->operations.size();
+    }
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  std::size_t RenderPlan::FindOperationOfOutputFrame(std::size_t outputFrameIndex) const {
+    if((outputFrameIndex >= 1) && (outputFrameIndex < GetEndOutputFrameIndex())) {
+      return this->operationOfOutputFrame[outputFrameIndex - 1];
+    } else if(outputFrameIndex == 0) {
+      return 0;
+    } else {
+      return this->operations.size();
+    }
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  std::size_t RenderPlan::FindIndependentOperation(std::size_t operationIndex) const {
+    if(operationIndex >= this->operations.size()) {
+      return this->operations.size();
+    }
+
+    // Rendering can always begin at the very first operation since there's no state yet.
+    // If only the deinterlacer's prior frame is missing, going back a few operations
+    // is enough, otherwise a long interlaced stretch would lead back to the beginning.
+    std::size_t startOperationIndex = operationIndex;
+    while(startOperationIndex > 0) {
+      const RenderOperation &operation = this->operations[startOperationIndex];
+      if(operation.IsIndependent) {
+        break;
+      }
+      if(operation.CanBeginWarmUp) {
+        if((operationIndex - startOperationIndex) >= WarmUpOperationCount) {
+          break;
+        }
+      }
+
+      --startOperationIndex;
+    }
+
+    return startOperationIndex;
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+} // namespace Nuclex::FrameFixer::Rendering
@@ -0,0 +1,173 @@
+#pragma region Apache License 2.0
+/*
+Nuclex Frame Fixer
+Copyright (C) 2024 Markus Ewald / Nuclex Development Labs
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#pragma endregion // Apache License 2.0
+
+#ifndef NUCLEX_FRAMEFIXER_RENDERING_RENDERPLAN_H
+#define NUCLEX_FRAMEFIXER_RENDERING_RENDERPLAN_H
+
+#include "Nuclex/FrameFixer/Config.h"
+#include "./RenderOperation.h"
+
+#include <cstddef> // for std::size_t
+#include <optional> // for std::optional
+#include <utility> // for std::pair
+#include <vector> // for std::vector
+
+namespace Nuclex::FrameFixer {
+
+  // ------------------------------------------------------------------------------------------- //
+
+  class Movie;
+  class Frame;
+
+  // ------------------------------------------------------------------------------------------- //
+
+}
+
+namespace Nuclex::FrameFixer::Rendering {
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Precompiled list of the steps needed to render a movie</summary>
+  /// <remarks>
+  ///   <para>
+  ///     Which input frames produce which output frames depends on everything that came
+  ///     before them: discarded, duplicated and triplicated frames, runs of averaged frames
+  ///     and inserted interpolated frames all shift the output frame numbers. Instead of
+  ///     walking through the whole movie each time this is needed, the plan works it out
+  ///     once and records the results as a flat list of operations, each knowing its
+  ///     source frames, its dependencies and the output frame numbers it will produce.
+  ///   </para>
+  ///   <para>
+  ///     The renderer simply executes the operations in order. Looking up the operation
+  ///     for an input frame or output frame is done through precomputed tables, so seeking
+  ///     to the beginning of a render range and counting its output frames is immediate.
+  ///   </para>
+  /// </remarks>
+  class RenderPlan {
+
+    /// <summary>Number of operations rendered ahead of a warm-up start without output</summary>
+    /// <remarks>
+    ///   Deinterlacers that look at the processed prior frame settle after a few frames,
+    ///   so this many operations before the first output frame are executed to warm them up.
+    /// </remarks>
+    public: static const std::size_t WarmUpOperationCount;
+
+    /// <summary>Compiles a render plan for the specified movie</summary>
+    /// <param name="movie">Movie for which a render plan will be compiled</param>
+    /// <param name="flipFields">Whether the top and bottom fields will be flipped</param>
+    /// <param name="collapseAverageFrames">
+    ///   Whether successive averaged frames will be collapsed into one
+    /// </param>
+    /// <param name="inputFrameRange">
+    ///   Range of input frames being rendered. Runs of averaged frames are cut off at
+    ///   the end of this range, so it affects the operations.
+    /// </param>
+    /// <param name="needsPriorFrame">
+    ///   Whether the deinterlacer looks at the processed prior frame. Deinterlaced frames
+    ///   then depend on their predecessors and rendering can not start at them.
+    /// </param>
+    public: RenderPlan(
+      const Movie &movie,
+      bool flipFields,
+      bool collapseAverageFrames,
+      const std::optional<std::pair<std::size_t, std::size_t>> &inputFrameRange,
+      bool needsPriorFrame
+    );
+    /// <summary>Frees all resources owned by the render plan</summary>
+    public: ~RenderPlan();
+
+    /// <summary>Determines the final action with which a frame will be processed</summary>
+    /// <param name="frame">Frame whose action will be determined</param>
+    /// <param name="flipFields">Whether the flip field order option is turned on</param>
+    /// <returns>The action that will be performed on the specified frame</returns>
+    public: static FrameAction GetFrameAction(const Frame &frame, bool flipFields = false);
+
+    /// <summary>Returns the number of operations in the plan</summary>
+    /// <returns>The number of operations the plan consists of</returns>
+    public: std::size_t GetOperationCount() const { return this->operations.size(); }
+
+    /// <summary>Accesses an operation in the plan</summary>
+    /// <param name="operationIndex">Index of the operation that will be returned</param>
+    /// <returns>The operation with the specified index</returns>
+    public: const RenderOperation &GetOperation(std::size_t operationIndex) const {
+      return this->operations[operationIndex];
+    }
+
+    /// <summary>Returns the output frame index that follows the last output frame</summary>
+    /// <returns>The output frame index one past the last output frame</returns>
+    public: std::size_t GetEndOutputFrameIndex() const;
+
+    /// <summary>Returns the first output frame index produced at or after an operation</summary>
+    /// <param name="operationIndex">
+    ///   Index of the operation whose first output frame index will be returned,
+    ///   may be equal to the operation count.
+    /// </param>
+    /// <returns>The output frame index the operation's output frames begin at</returns>
+    public: std::size_t GetFirstOutputFrameIndex(std::size_t operationIndex) const;
+
+    /// <summary>Looks up the first operation carried out for an input frame</summary>
+    /// <param name="frameIndex">Index of the input frame that will be looked up</param>
+    /// <returns>
+    ///   The index of the first operation for the frame or for the frames following it.
+    ///   If the frame index lies beyond the movie, the operation count is returned.
+    /// </returns>
+    public: std::size_t FindFirstOperationOfInputFrame(std::size_t frameIndex) const;
+
+    /// <summary>Looks up the operation that produces an output frame</summary>
+    /// <param name="outputFrameIndex">Output frame index that will be looked up</param>
+    /// <returns>
+    ///   The index of the operation that produces the output frame. If the output frame
+    ///   index lies beyond the end of the movie, the operation count is returned.
+    /// </returns>
+    public: std::size_t FindOperationOfOutputFrame(std::size_t outputFrameIndex) const;
+
+    /// <summary>Finds the nearest operation at which rendering can begin</summary>
+    /// <param name="operationIndex">Operation at which rendering should begin</param>
+    /// <returns>
+    ///   The index of the closest operation at or before the specified one that
+    ///   does not depend on any earlier state, a warm-up start at least
+    ///   <see cref="WarmUpOperationCount" /> operations before it or the first operation
+    ///   in the plan
+    /// </returns>
+    /// <remarks>
+    ///   If a warm-up start is returned, the output frames of the operations before
+    ///   the specified one differ from a full render and must not be written.
+    /// </remarks>
+    public: std::size_t FindIndependentOperation(std::size_t operationIndex) const;
+
+    /// <summary>All operations required to render the movie, in order</summary>
+    private: std::vector<RenderOperation> operations;
+    /// <summary>Index of the first operation of each input frame</summary>
+    /// <remarks>
+    ///   Contains one extra element at the end that holds the number of operations.
+    /// </remarks>
+    private: std::vector<std::size_t> firstOperationOfInputFrame;
+    /// <summary>Index of the operation producing each output frame</summary>
+    /// <remarks>
+    ///   Output frames are numbered beginning at 1, so element 0 is for output frame 1.
+    /// </remarks>
+    private: std::vector<std::size_t> operationOfOutputFrame;
+
+  };
+
+  // ------------------------------------------------------------------------------------------- //
+
+} // namespace Nuclex::FrameFixer::Rendering
+
+#endif // NUCLEX_FRAMEFIXER_RENDERING_RENDERPLAN_H
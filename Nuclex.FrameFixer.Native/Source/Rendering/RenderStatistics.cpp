@@ -0,0 +1,412 @@
+#pragma region Apache License 2.0
+/*
+Nuclex Frame Fixer
+Copyright (C) 2024 Markus Ewald / Nuclex Development Labs
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#pragma endregion // Apache License 2.0
+
+
+// If the application is compiled as a DLL, this ensures symbols are exported
+#define NUCLEX_FRAMEFIXER_SOURCE 1
+
+#include "./RenderStatistics.h"
+#include "../Diagnostics/TraceRecorder.h"
+
+#include <QFile>
+
+#include <Nuclex/Support/Text/LexicalAppend.h> // for lexical_append()
+
+#include <stdexcept> // for std::runtime_error
+
+namespace {
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Determines the histogram bucket an execution time falls into</summary>
+  /// <param name="nanoseconds">Execution time in nanoseconds</param>
+  /// <returns>The index of the histogram bucket for the execution time</returns>
+  std::size_t getHistogramBucket(std::uint64_t nanoseconds) {
+    std::uint64_t microseconds = nanoseconds / 1000;
+
+    std::size_t bucketIndex = 0;
+    while(microseconds >= 2) {
+      microseconds >>= 1;
+      ++bucketIndex;
+    }
+
+    const std::size_t lastBucketIndex = (
+      Nuclex::FrameFixer::Rendering::RenderStageStatistics::HistogramBucketCount - 1
+    );
+    return std::min(bucketIndex, lastBucketIndex);
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Converts a duration into seconds</summary>
+  /// <param name="duration">Duration that will be converted</param>
+  /// <returns>The number of seconds in the duration</returns>
+  template<typename TDuration>
+  double toSeconds(TDuration duration) {
+    return std::chrono::duration<double>(duration).count();
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Returns the name under which a stage appears in recorded traces</summary>
+  /// <param name="stage">Stage whose trace span name will be returned</param>
+  /// <returns>The name of the stage's trace spans</returns>
+  const char *getTraceSpanName(Nuclex::FrameFixer::Rendering::RenderStage stage) {
+    using Nuclex::FrameFixer::Rendering::RenderStage;
+    switch(stage) {
+      case RenderStage::Decode: { return u8"Decode"; }
+      case RenderStage::DeinterlaceTopFieldFirst: { return u8"Deinterlace (TFF)"; }
+      case RenderStage::DeinterlaceBottomFieldFirst: { return u8"Deinterlace (BFF)"; }
+      case RenderStage::DeinterlaceTopFieldOnly: { return u8"Deinterlace (top only)"; }
+      case RenderStage::DeinterlaceBottomFieldOnly: { return u8"Deinterlace (bottom only)"; }
+      case RenderStage::Interpolate: { return u8"Interpolate"; }
+      case RenderStage::Average: { return u8"Average"; }
+      case RenderStage::Encode: { return u8"Encode"; }
+      case RenderStage::Write: { return u8"Write"; }
+      default: { return u8"Unknown"; }
+    }
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+} // anonymous namespace
+
+namespace Nuclex::FrameFixer::Rendering {
+
+  // ------------------------------------------------------------------------------------------- //
+
+  RenderStatistics::ScopedTimer::ScopedTimer(RenderStatistics *statistics, RenderStage stage) :
+    statistics(statistics),
+    stage(stage),
+    startTime() {
+    if((statistics != nullptr) || Diagnostics::TraceRecorder::IsRecording()) {
+      this->startTime = std::chrono::steady_clock::now();
+    }
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  RenderStatistics::ScopedTimer::~ScopedTimer() {
+    if(this->startTime == std::chrono::steady_clock::time_point()) {
+      return; // Neither statistics nor a trace are being recorded
+    }
+
+    std::chrono::steady_clock::time_point endTime = std::chrono::steady_clock::now();
+    if(this->statistics != nullptr) {
+      this->statistics->RecordStage(this->stage, endTime - this->startTime);
+    }
+#if defined(NUCLEX_FRAMEFIXER_ENABLE_TRACING)
+    Diagnostics::TraceRecorder::RecordSpan(
+      u8"render", getTraceSpanName(this->stage), this->startTime, endTime
+    );
+#endif
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  const std::string RenderStatistics::Filename(u8"render-statistics.json");
+
+  // ------------------------------------------------------------------------------------------- //
+
+  RenderStatistics::RenderStatistics() :
+    stages(),
+    processedFrameCount(0),
+    bytesRead(0),
+    bytesWritten(0),
+    memoryLimit(0),
+    peakMemoryUsage(0),
+    startTicks(0) {
+    Reset();
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  RenderStatistics::~RenderStatistics() {}
+
+  // ------------------------------------------------------------------------------------------- //
+
+  RenderStage RenderStatistics::GetDeinterlaceStage(DeinterlaceMode mode) {
+    switch(mode) {
+      case DeinterlaceMode::TopFieldOnly: { return RenderStage::DeinterlaceTopFieldOnly; }
+      case DeinterlaceMode::BottomFieldOnly: { return RenderStage::DeinterlaceBottomFieldOnly; }
+      case DeinterlaceMode::BottomFieldFirst: { return RenderStage::DeinterlaceBottomFieldFirst; }
+      default: { return RenderStage::DeinterlaceTopFieldFirst; }
+    }
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  std::string RenderStatistics::GetStageName(RenderStage stage) {
+    switch(stage) {
+      case RenderStage::Decode: { return u8"decode"; }
+      case RenderStage::DeinterlaceTopFieldFirst: { return u8"deinterlaceTopFieldFirst"; }
+      case RenderStage::DeinterlaceBottomFieldFirst: { return u8"deinterlaceBottomFieldFirst"; }
+      case RenderStage::DeinterlaceTopFieldOnly: { return u8"deinterlaceTopFieldOnly"; }
+      case RenderStage::DeinterlaceBottomFieldOnly: { return u8"deinterlaceBottomFieldOnly"; }
+      case RenderStage::Interpolate: { return u8"interpolate"; }
+      case RenderStage::Average: { return u8"average"; }
+      case RenderStage::Encode: { return u8"encode"; }
+      case RenderStage::Write: { return u8"write"; }
+      default: { return u8"unknown"; }
+    }
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  void RenderStatistics::Reset() {
+    for(std::size_t stageIndex = 0; stageIndex < StageCount; ++stageIndex) {
+      StageCounters &counters = this->stages[stageIndex];
+      counters.ExecutionCount.store(0, std::memory_order_relaxed);
+      counters.TotalNanoseconds.store(0, std::memory_order_relaxed);
+      counters.MaximumNanoseconds.store(0, std::memory_order_relaxed);
+      for(std::size_t index = 0; index < RenderStageStatistics::HistogramBucketCount; ++index) {
+        counters.Histogram[index].store(0, std::memory_order_relaxed);
+      }
+    }
+
+    this->processedFrameCount.store(0, std::memory_order_relaxed);
+    this->bytesRead.store(0, std::memory_order_relaxed);
+    this->bytesWritten.store(0, std::memory_order_relaxed);
+    this->memoryLimit.store(0, std::memory_order_relaxed);
+    this->peakMemoryUsage.store(0, std::memory_order_relaxed);
+    this->startTicks.store(
+      std::chrono::steady_clock::now().time_since_epoch().count(), std::memory_order_release
+    );
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  void RenderStatistics::RecordStage(
+    RenderStage stage, std::chrono::steady_clock::duration time
+  ) {
+    std::uint64_t nanoseconds = static_cast<std::uint64_t>(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(time).count()
+    );
+
+    StageCounters &counters = this->stages[static_cast<std::size_t>(stage)];
+    counters.ExecutionCount.fetch_add(1, std::memory_order_relaxed);
+    counters.TotalNanoseconds.fetch_add(nanoseconds, std::memory_order_relaxed);
+    counters.Histogram[getHistogramBucket(nanoseconds)].fetch_add(1, std::memory_order_relaxed);
+
+    std::uint64_t maximum = counters.MaximumNanoseconds.load(std::memory_order_relaxed);
+    while(maximum < nanoseconds) {
+      bool replaced = counters.MaximumNanoseconds.compare_exchange_weak(
+        maximum, nanoseconds, std::memory_order_relaxed
+      );
+      if(replaced) {
+        break;
+      }
+    }
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  void RenderStatistics::RecordFrame() {
+    this->processedFrameCount.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  void RenderStatistics::AddBytesRead(std::uint64_t byteCount) {
+    this->bytesRead.fetch_add(byteCount, std::memory_order_relaxed);
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  void RenderStatistics::AddBytesWritten(std::uint64_t byteCount) {
+    this->bytesWritten.fetch_add(byteCount, std::memory_order_relaxed);
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  void RenderStatistics::RecordMemoryUsage(std::uint64_t limitBytes, std::uint64_t peakBytes) {
+    this->memoryLimit.store(limitBytes, std::memory_order_relaxed);
+    this->peakMemoryUsage.store(peakBytes, std::memory_order_relaxed);
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  RenderStageStatistics RenderStatistics::GetStageStatistics(RenderStage stage) const {
+    const StageCounters &counters = this->stages[static_cast<std::size_t>(stage)];
+
+    RenderStageStatistics statistics;
+    statistics.ExecutionCount = counters.ExecutionCount.load(std::memory_order_relaxed);
+    statistics.TotalTime = std::chrono::nanoseconds(
+      counters.TotalNanoseconds.load(std::memory_order_relaxed)
+    );
+    statistics.MaximumTime = std::chrono::nanoseconds(
+      counters.MaximumNanoseconds.load(std::memory_order_relaxed)
+    );
+    for(std::size_t index = 0; index < RenderStageStatistics::HistogramBucketCount; ++index) {
+      statistics.Histogram[index] = counters.Histogram[index].load(std::memory_order_relaxed);
+    }
+
+    return statistics;
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  std::uint64_t RenderStatistics::GetProcessedFrameCount() const {
+    return this->processedFrameCount.load(std::memory_order_relaxed);
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  std::uint64_t RenderStatistics::GetBytesRead() const {
+    return this->bytesRead.load(std::memory_order_relaxed);
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  std::uint64_t RenderStatistics::GetBytesWritten() const {
+    return this->bytesWritten.load(std::memory_order_relaxed);
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  std::uint64_t RenderStatistics::GetMemoryLimit() const {
+    return this->memoryLimit.load(std::memory_order_relaxed);
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  std::uint64_t RenderStatistics::GetPeakMemoryUsage() const {
+    return this->peakMemoryUsage.load(std::memory_order_relaxed);
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  std::chrono::steady_clock::duration RenderStatistics::GetElapsedTime() const {
+    std::chrono::steady_clock::duration startTime(
+      this->startTicks.load(std::memory_order_acquire)
+    );
+    return std::chrono::steady_clock::now().time_since_epoch() - startTime;
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  double RenderStatistics::GetFramesPerSecond() const {
+    double elapsedSeconds = toSeconds(GetElapsedTime());
+    if(elapsedSeconds <= 0.0) {
+      return 0.0;
+    }
+
+    return static_cast<double>(GetProcessedFrameCount()) / elapsedSeconds;
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  std::string RenderStatistics::ToJson() const {
+    using Nuclex::Support::Text::lexical_append;
+
+    std::string json(u8"{\n  \"elapsedSeconds\": ", 22);
+    lexical_append(json, toSeconds(GetElapsedTime()));
+    json.append(u8",\n  \"frames\": ", 14);
+    lexical_append(json, GetProcessedFrameCount());
+    json.append(u8",\n  \"framesPerSecond\": ", 23);
+    lexical_append(json, GetFramesPerSecond());
+    json.append(u8",\n  \"bytesRead\": ", 17);
+    lexical_append(json, GetBytesRead());
+    json.append(u8",\n  \"bytesWritten\": ", 20);
+    lexical_append(json, GetBytesWritten());
+    json.append(u8",\n  \"memoryLimitBytes\": ", 24);
+    lexical_append(json, GetMemoryLimit());
+    json.append(u8",\n  \"peakMemoryBytes\": ", 23);
+    lexical_append(json, GetPeakMemoryUsage());
+    json.append(u8",\n  \"stages\": {", 15);
+
+    for(std::size_t stageIndex = 0; stageIndex < StageCount; ++stageIndex) {
+      RenderStage stage = static_cast<RenderStage>(stageIndex);
+      RenderStageStatistics statistics = GetStageStatistics(stage);
+
+      json.append((stageIndex == 0) ? u8"\n    \"" : u8",\n    \"");
+      json.append(GetStageName(stage));
+      json.append(u8"\": {\n      \"count\": ", 20);
+      lexical_append(json, statistics.ExecutionCount);
+      json.append(u8",\n      \"totalSeconds\": ", 24);
+      lexical_append(json, toSeconds(statistics.TotalTime));
+      json.append(u8",\n      \"averageMilliseconds\": ", 31);
+      if(statistics.ExecutionCount == 0) {
+        json.push_back(u8'0');
+      } else {
+        lexical_append(
+          json,
+          toSeconds(statistics.TotalTime) * 1000.0 / static_cast<double>(statistics.ExecutionCount)
+        );
+      }
+      json.append(u8",\n      \"maximumMilliseconds\": ", 31);
+      lexical_append(json, toSeconds(statistics.MaximumTime) * 1000.0);
+
+      // Only list the histogram buckets that have any entries, each with its upper bound
+      json.append(u8",\n      \"histogram\": [", 22);
+      bool isFirstBucket = true;
+      for(std::size_t index = 0; index < RenderStageStatistics::HistogramBucketCount; ++index) {
+        if(statistics.Histogram[index] == 0) {
+          continue;
+        }
+        json.append(isFirstBucket ? u8"\n        " : u8",\n        ");
+        json.append(u8"{ \"belowMicroseconds\": ", 23);
+        if(index + 1 == RenderStageStatistics::HistogramBucketCount) {
+          json.append(u8"null", 4);
+        } else {
+          lexical_append(json, std::uint64_t(2) << index);
+        }
+        json.append(u8", \"count\": ", 11);
+        lexical_append(json, statistics.Histogram[index]);
+        json.append(u8" }", 2);
+        isFirstBucket = false;
+      }
+      json.append(isFirstBucket ? u8"]\n    }" : u8"\n      ]\n    }");
+    }
+
+    json.append(u8"\n  }\n}\n", 7);
+    return json;
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  void RenderStatistics::Save(const std::string &directory) const {
+    std::string path = directory;
+    std::string::size_type length = path.length();
+    if((length >= 1) && (path[length - 1] != '/')) {
+      path.push_back(u8'/');
+    }
+    path.append(Filename);
+
+    std::string json = ToJson();
+
+    QFile summaryFile(QString::fromStdString(path));
+    bool written = summaryFile.open(
+      QIODevice::OpenModeFlag::WriteOnly | QIODevice::OpenModeFlag::Truncate
+    );
+    if(written) {
+      qint64 writtenByteCount = summaryFile.write(json.data(), json.length());
+      written = (writtenByteCount == static_cast<qint64>(json.length()));
+    }
+    if(!written) {
+      std::string message(u8"Could not write render statistics to '", 38);
+      message.append(path);
+      message.append(u8"'", 1);
+      throw std::runtime_error(message);
+    }
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+} // namespace Nuclex::FrameFixer::Rendering
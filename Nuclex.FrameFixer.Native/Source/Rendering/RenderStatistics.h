@@ -0,0 +1,251 @@
+#pragma region Apache License 2.0
+/*
+Nuclex Frame Fixer
+Copyright (C) 2024 Markus Ewald / Nuclex Development Labs
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#pragma endregion // Apache License 2.0
+
+
+#ifndef NUCLEX_FRAMEFIXER_RENDERING_RENDERSTATISTICS_H
+#define NUCLEX_FRAMEFIXER_RENDERING_RENDERSTATISTICS_H
+
+#include "Nuclex/FrameFixer/Config.h"
+#include "../Model/DeinterlaceMode.h"
+
+#include <array> // for std::array
+#include <atomic> // for std::atomic
+#include <chrono> // for std::chrono::steady_clock
+#include <cstddef> // for std::size_t
+#include <cstdint> // for std::uint64_t
+#include <string> // for std::string
+
+namespace Nuclex::FrameFixer::Rendering {
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Stages of the render pipeline whose execution time is measured</summary>
+  enum class RenderStage {
+
+    /// <summary>Loading and decoding input frames</summary>
+    Decode,
+    /// <summary>Deinterlacing with the top field first</summary>
+    DeinterlaceTopFieldFirst,
+    /// <summary>Deinterlacing with the bottom field first</summary>
+    DeinterlaceBottomFieldFirst,
+    /// <summary>Deinterlacing using only the top field</summary>
+    DeinterlaceTopFieldOnly,
+    /// <summary>Deinterlacing using only the bottom field</summary>
+    DeinterlaceBottomFieldOnly,
+    /// <summary>Synthesizing frames with the interpolator</summary>
+    Interpolate,
+    /// <summary>Blending runs of frames together</summary>
+    Average,
+    /// <summary>Compressing output frames into an image or video format</summary>
+    Encode,
+    /// <summary>Writing encoded output frames to disk or into a stream</summary>
+    Write
+
+  };
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Snapshot of the measurements taken for one stage of the render pipeline</summary>
+  struct RenderStageStatistics {
+
+    /// <summary>Number of buckets in the execution time histogram</summary>
+    /// <remarks>
+    ///   Bucket n counts executions that took from 2^n up to 2^(n + 1) microseconds,
+    ///   the first bucket also counts anything faster and the last anything slower.
+    /// </remarks>
+    public: static constexpr std::size_t HistogramBucketCount = 24;
+
+    /// <summary>Number of times the stage was executed</summary>
+    public: std::uint64_t ExecutionCount;
+    /// <summary>Time spent in the stage, summed over all threads</summary>
+    public: std::chrono::nanoseconds TotalTime;
+    /// <summary>Longest time a single execution of the stage took</summary>
+    public: std::chrono::nanoseconds MaximumTime;
+    /// <summary>Number of executions that fell into each execution time bucket</summary>
+    public: std::array<std::uint64_t, HistogramBucketCount> Histogram;
+
+  };
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Collects timings and throughput figures while a movie is being rendered</summary>
+  /// <remarks>
+  ///   <para>
+  ///     All counters are atomic, so the decode, processing and encoder threads can
+  ///     record their measurements without taking a lock and the user interface can read
+  ///     them at any time while the render is running.
+  ///   </para>
+  ///   <para>
+  ///     Stage times are summed over all threads, so with several processing or encoder
+  ///     threads, the time spent in a stage can exceed the time the render took. Comparing
+  ///     the stages against each other still shows where the time went, i.e. whether
+  ///     a render is waiting on the disk or on the deinterlacer.
+  ///   </para>
+  /// </remarks>
+  class RenderStatistics {
+
+    /// <summary>Measures the time until it goes out of scope and records it</summary>
+    public: class ScopedTimer {
+
+      /// <summary>Starts measuring the time spent in a stage</summary>
+      /// <param name="statistics">Statistics the time will be recorded in, can be null</param>
+      /// <param name="stage">Stage the time will be recorded for</param>
+      public: ScopedTimer(RenderStatistics *statistics, RenderStage stage);
+      /// <summary>Records the time that has passed since the timer was created</summary>
+      /// <remarks>
+      ///   If a trace is being recorded, the stage is also added to it as a span.
+      /// </remarks>
+      public: ~ScopedTimer();
+
+      /// <summary>Statistics the time will be recorded in, null to do nothing</summary>
+      private: RenderStatistics *statistics;
+      /// <summary>Stage the time will be recorded for</summary>
+      private: RenderStage stage;
+      /// <summary>Point in time at which the timer was started</summary>
+      private: std::chrono::steady_clock::time_point startTime;
+
+    };
+
+    /// <summary>Initializes a new, empty set of render statistics</summary>
+    public: RenderStatistics();
+    /// <summary>Frees all resources owned by the render statistics</summary>
+    public: ~RenderStatistics();
+
+    /// <summary>Name of the file the summary is saved in next to the output frames</summary>
+    public: static const std::string Filename;
+
+    /// <summary>Returns the stage in which a deinterlace mode is accounted</summary>
+    /// <param name="mode">Deinterlace mode whose stage will be returned</param>
+    /// <returns>The stage measuring the time spent deinterlacing in that mode</returns>
+    public: static RenderStage GetDeinterlaceStage(DeinterlaceMode mode);
+
+    /// <summary>Returns the name under which a stage appears in the summary</summary>
+    /// <param name="stage">Stage whose name will be returned</param>
+    /// <returns>The name of the specified stage</returns>
+    public: static std::string GetStageName(RenderStage stage);
+
+    /// <summary>Clears all counters and restarts the clock for a new render</summary>
+    public: void Reset();
+
+    /// <summary>Records the time a single execution of a stage took</summary>
+    /// <param name="stage">Stage that was executed</param>
+    /// <param name="time">Time the stage took to execute</param>
+    public: void RecordStage(RenderStage stage, std::chrono::steady_clock::duration time);
+
+    /// <summary>Records that an output frame has been processed</summary>
+    public: void RecordFrame();
+
+    /// <summary>Adds to the number of bytes read from input frame files</summary>
+    /// <param name="byteCount">Number of bytes that were read</param>
+    public: void AddBytesRead(std::uint64_t byteCount);
+
+    /// <summary>Adds to the number of bytes written into output files</summary>
+    /// <param name="byteCount">Number of bytes that were written</param>
+    public: void AddBytesWritten(std::uint64_t byteCount);
+
+    /// <summary>Records how much memory the frames in flight took up</summary>
+    /// <param name="limitBytes">Frame memory budget of the render, 0 if unlimited</param>
+    /// <param name="peakBytes">Highest number of bytes frames occupied at once</param>
+    public: void RecordMemoryUsage(std::uint64_t limitBytes, std::uint64_t peakBytes);
+
+    /// <summary>Takes a snapshot of the measurements for one stage</summary>
+    /// <param name="stage">Stage whose measurements will be returned</param>
+    /// <returns>The measurements recorded for the stage so far</returns>
+    public: RenderStageStatistics GetStageStatistics(RenderStage stage) const;
+
+    /// <summary>Returns the number of output frames processed since the last reset</summary>
+    /// <returns>The number of processed output frames</returns>
+    public: std::uint64_t GetProcessedFrameCount() const;
+
+    /// <summary>Returns the number of bytes read from input frame files</summary>
+    /// <returns>The number of bytes read since the last reset</returns>
+    public: std::uint64_t GetBytesRead() const;
+
+    /// <summary>Returns the number of bytes written into output files</summary>
+    /// <returns>The number of bytes written since the last reset</returns>
+    public: std::uint64_t GetBytesWritten() const;
+
+    /// <summary>Returns the frame memory budget the render was given</summary>
+    /// <returns>The budget in bytes, 0 if memory use was not limited</returns>
+    public: std::uint64_t GetMemoryLimit() const;
+
+    /// <summary>Returns the highest number of bytes frames occupied at once</summary>
+    /// <returns>The peak memory use of frames in flight</returns>
+    public: std::uint64_t GetPeakMemoryUsage() const;
+
+    /// <summary>Returns the time that has passed since the last reset</summary>
+    /// <returns>The wall time the current or last render has been running for</returns>
+    public: std::chrono::steady_clock::duration GetElapsedTime() const;
+
+    /// <summary>Calculates the average number of output frames processed per second</summary>
+    /// <returns>The number of frames per second since the last reset</returns>
+    public: double GetFramesPerSecond() const;
+
+    /// <summary>Formats all measurements as a JSON document</summary>
+    /// <returns>A JSON document summarizing the render</returns>
+    public: std::string ToJson() const;
+
+    /// <summary>Saves the JSON summary of all measurements in a directory</summary>
+    /// <param name="directory">Directory in which the summary will be saved</param>
+    /// <remarks>
+    ///   The summary is saved under the name given by <see cref="Filename" />.
+    /// </remarks>
+    public: void Save(const std::string &directory) const;
+
+    /// <summary>Counters for a single stage of the render pipeline</summary>
+    private: struct StageCounters {
+
+      /// <summary>Number of times the stage was executed</summary>
+      public: std::atomic<std::uint64_t> ExecutionCount;
+      /// <summary>Nanoseconds spent in the stage</summary>
+      public: std::atomic<std::uint64_t> TotalNanoseconds;
+      /// <summary>Longest single execution of the stage in nanoseconds</summary>
+      public: std::atomic<std::uint64_t> MaximumNanoseconds;
+      /// <summary>Number of executions falling into each execution time bucket</summary>
+      public: std::atomic<std::uint64_t> Histogram[RenderStageStatistics::HistogramBucketCount];
+
+    };
+
+    /// <summary>Number of stages for which counters are kept</summary>
+    private: static constexpr std::size_t StageCount = (
+      static_cast<std::size_t>(RenderStage::Write) + 1
+    );
+
+    /// <summary>Counters for each stage of the render pipeline</summary>
+    private: StageCounters stages[StageCount];
+    /// <summary>Number of output frames processed</summary>
+    private: std::atomic<std::uint64_t> processedFrameCount;
+    /// <summary>Number of bytes read from input frame files</summary>
+    private: std::atomic<std::uint64_t> bytesRead;
+    /// <summary>Number of bytes written into output files</summary>
+    private: std::atomic<std::uint64_t> bytesWritten;
+    /// <summary>Frame memory budget of the render in bytes, 0 if unlimited</summary>
+    private: std::atomic<std::uint64_t> memoryLimit;
+    /// <summary>Highest number of bytes occupied by frames in flight</summary>
+    private: std::atomic<std::uint64_t> peakMemoryUsage;
+    /// <summary>Time since the epoch of the steady clock at which the render started</summary>
+    private: std::atomic<std::chrono::steady_clock::rep> startTicks;
+
+  };
+
+  // ------------------------------------------------------------------------------------------- //
+
+} // namespace Nuclex::FrameFixer::Rendering
+
+#endif // NUCLEX_FRAMEFIXER_RENDERING_RENDERSTATISTICS_H
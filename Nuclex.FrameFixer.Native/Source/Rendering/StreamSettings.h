@@ -0,0 +1,95 @@
+#pragma region Apache License 2.0
+/*
+Nuclex Frame Fixer
+Copyright (C) 2024 Markus Ewald / Nuclex Development Labs
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#pragma endregion // Apache License 2.0
+
+#ifndef NUCLEX_FRAMEFIXER_RENDERING_STREAMSETTINGS_H
+#define NUCLEX_FRAMEFIXER_RENDERING_STREAMSETTINGS_H
+
+#include "Nuclex/FrameFixer/Config.h"
+
+#include <cstddef> // for std::size_t
+#include <string> // for std::string
+
+namespace Nuclex::FrameFixer::Rendering {
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Formats in which output frames can be streamed</summary>
+  enum class StreamFormat {
+
+    /// <summary>YUV4MPEG2 stream with 16 bit 4:4:4 frames (ffmpeg's yuv444p16)</summary>
+    /// <remarks>
+    ///   The stream header carries the frame size and frame rate, so consumers
+    ///   can read it without being told anything about the frames.
+    /// </remarks>
+    Y4m,
+
+    /// <summary>Headerless 16 bit RGB frames (ffmpeg's rgb48le rawvideo)</summary>
+    Rgb48,
+
+    /// <summary>Headerless 16 bit RGBA frames (ffmpeg's rgba64le rawvideo)</summary>
+    Rgba64
+
+  };
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Where streamed output frames are sent</summary>
+  enum class StreamTarget {
+
+    /// <summary>Frames are written to the standard output of the application</summary>
+    StandardOutput,
+
+    /// <summary>Frames are written into a file or named pipe (FIFO)</summary>
+    /// <remarks>
+    ///   Opening a named pipe blocks until the consumer has opened its end.
+    /// </remarks>
+    File,
+
+    /// <summary>Frames are written into the standard input of a child process</summary>
+    ChildProcess
+
+  };
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Settings for streaming output frames to another application</summary>
+  struct StreamSettings {
+
+    /// <summary>Format in which the frames will be streamed</summary>
+    public: StreamFormat Format;
+    /// <summary>Where the frames will be sent</summary>
+    public: StreamTarget Target;
+    /// <summary>Path of the file or named pipe or command line of the child process</summary>
+    /// <remarks>
+    ///   The command line is run through the system's shell, so it can contain arguments
+    ///   and quotes as it would when typed in a terminal.
+    /// </remarks>
+    public: std::string Destination;
+    /// <summary>Numerator of the frame rate announced in the Y4M header</summary>
+    public: std::size_t FrameRateNumerator;
+    /// <summary>Denominator of the frame rate announced in the Y4M header</summary>
+    public: std::size_t FrameRateDenominator;
+
+  };
+
+  // ------------------------------------------------------------------------------------------- //
+
+} // namespace Nuclex::FrameFixer::Rendering
+
+#endif // NUCLEX_FRAMEFIXER_RENDERING_STREAMSETTINGS_H
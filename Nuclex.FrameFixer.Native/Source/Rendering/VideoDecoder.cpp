@@ -0,0 +1,702 @@
+#pragma region Apache License 2.0
+/*
+Nuclex Frame Fixer
+Copyright (C) 2024 Markus Ewald / Nuclex Development Labs
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#pragma endregion // Apache License 2.0
+
+// If the application is compiled as a DLL, this ensures symbols are exported
+#define NUCLEX_FRAMEFIXER_SOURCE 1
+
+#include "./VideoDecoder.h"
+
+#if defined(NUCLEX_FRAMEFIXER_ENABLE_LIBAV)
+
+#include "../Platform/LibAvApi.h"
+#include "../Diagnostics/TraceRecorder.h"
+
+#include <Nuclex/Support/Text/LexicalAppend.h> // for lexical_append()
+
+#include <stdexcept> // for std::runtime_error
+#include <algorithm> // for std::sort(), std::lower_bound(), std::copy_n(), std::min()
+#include <iterator> // for std::distance()
+
+extern "C" {
+  #include <libavcodec/avcodec.h>
+  #include <libavformat/avformat.h>
+}
+
+namespace {
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Throws an exception for the specified libav result code</summary>
+  /// <param name="libavResult">
+  ///   libav result code for which an error message will be provided in the exception
+  /// </param>
+  /// <param name="message">
+  ///   Additional text that will be prefixed to the exception message
+  /// </param>
+  [[noreturn]] void throwExceptionForAvError(int libAvResult, const std::string &message) {
+    char buffer[1024];
+    int errorStringResult = ::av_strerror(libAvResult, buffer, sizeof(buffer));
+
+    std::string combinedMessage(message);
+    if(errorStringResult == 0) {
+      combinedMessage.append(buffer);
+    } else {
+      combinedMessage.append(u8"unknown error ", 14);
+      Nuclex::Support::Text::lexical_append(combinedMessage, libAvResult);
+    }
+
+    throw std::runtime_error(combinedMessage);
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Maximum number of readers that decode the video at the same time</summary>
+  /// <remarks>
+  ///   Each reader has its own codec (which runs its own threads), so more readers than
+  ///   a render has segments and read-ahead threads touching different parts of
+  ///   the video at once would only cost memory.
+  /// </remarks>
+  const std::size_t MaximumReaderCount = 4;
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Frees an AV packet</summary>
+  /// <param name="packet">Packet that will be freed</param>
+  /// <remarks>
+  ///   This is a wrapper method so the shared_ptr can call av_packet_free()
+  /// </remarks>
+  void deleteAvPacket(::AVPacket *packet) {
+    ::av_packet_free(&packet);
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Frees an AV frame</summary>
+  /// <param name="frame">Frame that will be freed</param>
+  /// <remarks>
+  ///   This is a wrapper method so the shared_ptr can call av_frame_free()
+  /// </remarks>
+  void deleteAvFrame(::AVFrame *frame) {
+    ::av_frame_free(&frame);
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+} // anonymous namespace
+
+namespace Nuclex::FrameFixer::Rendering {
+
+  // ------------------------------------------------------------------------------------------- //
+
+  struct VideoDecoder::Reader {
+
+    /// <summary>Initializes a new reader without opening anything yet</summary>
+    public: Reader() :
+      FormatContext(nullptr),
+      CodecContext(nullptr),
+      ConversionFilterGraph(),
+      ConversionWidth(0),
+      ConversionHeight(0),
+      ConversionPixelFormat(-1),
+      DecodedFrame(::av_frame_alloc(), &deleteAvFrame),
+      Packet(::av_packet_alloc(), &deleteAvPacket),
+      LastDecodedFrameIndex(std::size_t(-1)),
+      IsCodecDrained(false) {
+      if(!static_cast<bool>(this->DecodedFrame) || !static_cast<bool>(this->Packet)) {
+        throw std::runtime_error(u8"Could not allocate AV frame and packet for decoding");
+      }
+    }
+
+    /// <summary>Closes the video file and releases all libav objects</summary>
+    public: ~Reader() {
+      this->ConversionFilterGraph.reset();
+
+      if(this->CodecContext != nullptr) {
+        ::avcodec_free_context(&this->CodecContext);
+      }
+      if(this->FormatContext != nullptr) {
+        ::avformat_close_input(&this->FormatContext);
+      }
+    }
+
+    /// <summary>Checks whether the reader can reach a frame without seeking</summary>
+    /// <param name="frames">Index of all frames in the video stream</param>
+    /// <param name="frameIndex">Index of the frame that should be decoded next</param>
+    /// <returns>True if decoding onwards from the reader's position reaches the frame</returns>
+    public: bool CanDecodeOnwardsTo(
+      const std::vector<IndexedFrame> &frames, std::size_t frameIndex
+    ) const {
+      return (
+        (this->LastDecodedFrameIndex != std::size_t(-1)) &&
+        (frameIndex > this->LastDecodedFrameIndex) &&
+        (frames[frameIndex].KeyframeIndex <= this->LastDecodedFrameIndex)
+      );
+    }
+
+    /// <summary>Container the video is read from</summary>
+    public: ::AVFormatContext *FormatContext;
+    /// <summary>Codec decoding the video stream</summary>
+    public: ::AVCodecContext *CodecContext;
+    /// <summary>Filter graph that converts decoded frames into RGBA64</summary>
+    public: std::shared_ptr<::AVFilterGraph> ConversionFilterGraph;
+    /// <summary>Width of the frames the filter graph was set up for</summary>
+    public: int ConversionWidth;
+    /// <summary>Height of the frames the filter graph was set up for</summary>
+    public: int ConversionHeight;
+    /// <summary>Pixel format of the frames the filter graph was set up for</summary>
+    public: int ConversionPixelFormat;
+    /// <summary>Receives decoded frames from the codec, reused to avoid allocations</summary>
+    public: std::shared_ptr<::AVFrame> DecodedFrame;
+    /// <summary>Packet the demuxer reads the compressed frames into</summary>
+    public: std::shared_ptr<::AVPacket> Packet;
+    /// <summary>Index of the frame the reader delivered last, -1 after seeking</summary>
+    public: std::size_t LastDecodedFrameIndex;
+    /// <summary>Whether the codec has been flushed after reaching the end of the file</summary>
+    public: bool IsCodecDrained;
+
+  };
+
+  // ------------------------------------------------------------------------------------------- //
+
+  VideoDecoder::VideoDecoder(
+    const std::string &path,
+    const std::shared_ptr<const CancellationWatcher> &cancellationWatcher /* = (
+      std::shared_ptr<const CancellationWatcher>()
+    ) */
+  ) :
+    path(path),
+    streamIndex(-1),
+    frames(),
+    readerMutex(),
+    readerReleased(),
+    idleReaders(),
+    openReaderCount(0) {
+
+    // The reader that indexes the video stays open to decode the first requested frame
+    std::unique_ptr<Reader> reader = openReader();
+    buildFrameIndex(*reader, cancellationWatcher);
+
+    this->idleReaders.push_back(std::move(reader));
+    this->openReaderCount = 1;
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  VideoDecoder::~VideoDecoder() = default;
+
+  // ------------------------------------------------------------------------------------------- //
+
+  std::size_t VideoDecoder::GetFrameCount() const {
+    return this->frames.size();
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  std::size_t VideoDecoder::GetEncodedFrameSize(std::size_t frameIndex) const {
+    return this->frames.at(frameIndex).EncodedSize;
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  QImage VideoDecoder::DecodeFrame(std::size_t frameIndex) {
+    NUCLEX_FRAMEFIXER_TRACE_SCOPE(u8"libav", u8"Decode video frame");
+
+    if(frameIndex >= this->frames.size()) {
+      throw std::runtime_error(u8"Requested frame lies beyond the end of the video");
+    }
+
+    std::unique_ptr<Reader> reader = acquireReader(frameIndex);
+
+    QImage image;
+    try {
+      image = decodeFrame(*reader, frameIndex);
+    }
+    catch(...) {
+      reader->LastDecodedFrameIndex = std::size_t(-1); // Force a seek on the next use
+      releaseReader(std::move(reader));
+      throw;
+    }
+
+    releaseReader(std::move(reader));
+    return image;
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  QImage VideoDecoder::decodeFrame(Reader &reader, std::size_t frameIndex) {
+
+    // If the requested frame comes after the last one the reader decoded and no keyframe
+    // lies in between, decoding onwards is cheaper than seeking. This is the typical case
+    // during rendering, where frames are requested in order.
+    if(!reader.CanDecodeOnwardsTo(this->frames, frameIndex)) {
+      seekToKeyframeBefore(reader, frameIndex);
+    }
+
+    // Decode frames until the requested one comes out. The codec returns frames
+    // in presentation order, so everything before the requested frame is skipped.
+    std::int64_t targetTimestamp = this->frames[frameIndex].PresentationTimestamp;
+    for(;;) {
+      int result = ::avcodec_receive_frame(reader.CodecContext, reader.DecodedFrame.get());
+      if(result == AVERROR(EAGAIN)) {
+        if(reader.IsCodecDrained) {
+          throw std::runtime_error(u8"Video codec requested more data after the end of the file");
+        }
+        sendNextPacketToCodec(reader);
+        continue;
+      }
+      if(result < 0) {
+        if(result == AVERROR_EOF) {
+          throw std::runtime_error(u8"Requested frame could not be decoded from the video");
+        } else {
+          throwExceptionForAvError(
+            result, std::string(u8"Could not receive frame from video codec: ", 42)
+          );
+        }
+      }
+
+      std::int64_t timestamp = reader.DecodedFrame->best_effort_timestamp;
+      if(timestamp == AV_NOPTS_VALUE) {
+        timestamp = reader.DecodedFrame->pts;
+      }
+      if(timestamp < targetTimestamp) {
+        ::av_frame_unref(reader.DecodedFrame.get());
+        continue;
+      }
+
+      // If the requested frame was missing from the stream, deliver the next one,
+      // but remember where the reader really is so the next frame is not skipped.
+      if(timestamp == targetTimestamp) {
+        reader.LastDecodedFrameIndex = frameIndex;
+      } else {
+        auto iterator = std::lower_bound(
+          this->frames.begin(), this->frames.end(), timestamp,
+          [](const IndexedFrame &frame, std::int64_t searchedTimestamp) {
+            return frame.PresentationTimestamp < searchedTimestamp;
+          }
+        );
+        reader.LastDecodedFrameIndex = static_cast<std::size_t>(
+          std::distance(this->frames.begin(), iterator)
+        );
+      }
+
+      return convertToImage(reader, reader.DecodedFrame);
+    }
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  std::unique_ptr<VideoDecoder::Reader> VideoDecoder::acquireReader(std::size_t frameIndex) {
+    {
+      std::unique_lock<std::mutex> readerLock(this->readerMutex);
+      for(;;) {
+
+        // Prefer the reader closest behind the requested frame. When two threads ask for
+        // neighbouring frames, this keeps each on its own reader instead of having both
+        // seek the same reader back and forth.
+        std::size_t bestIndex = std::size_t(-1);
+        for(std::size_t index = 0; index < this->idleReaders.size(); ++index) {
+          const Reader &candidate = *this->idleReaders[index];
+          if(candidate.CanDecodeOnwardsTo(this->frames, frameIndex)) {
+            bool isCloser = (
+              (bestIndex == std::size_t(-1)) ||
+              (
+                candidate.LastDecodedFrameIndex >
+                this->idleReaders[bestIndex]->LastDecodedFrameIndex
+              )
+            );
+            if(isCloser) {
+              bestIndex = index;
+            }
+          }
+        }
+
+        // If no idle reader is in position and another one may be opened, open one
+        // rather than moving a reader away from where another thread is working.
+        // Otherwise, seek with the least recently used reader.
+        if(bestIndex == std::size_t(-1)) {
+          if(this->openReaderCount < MaximumReaderCount) {
+            ++this->openReaderCount;
+            break;
+          }
+          if(!this->idleReaders.empty()) {
+            bestIndex = 0;
+          }
+        }
+
+        if(bestIndex != std::size_t(-1)) {
+          std::unique_ptr<Reader> reader = std::move(this->idleReaders[bestIndex]);
+          this->idleReaders.erase(this->idleReaders.begin() + bestIndex);
+          return reader;
+        }
+
+        this->readerReleased.wait(readerLock);
+      }
+    }
+
+    // Opening the file and codec happens outside of the lock so other threads
+    // can keep decoding with the readers that are already open
+    try {
+      return openReader();
+    }
+    catch(...) {
+      {
+        std::unique_lock<std::mutex> readerLock(this->readerMutex);
+        --this->openReaderCount;
+      }
+      this->readerReleased.notify_one();
+      throw;
+    }
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  void VideoDecoder::releaseReader(std::unique_ptr<Reader> reader) {
+    {
+      std::unique_lock<std::mutex> readerLock(this->readerMutex);
+      this->idleReaders.push_back(std::move(reader));
+    }
+    this->readerReleased.notify_one();
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  std::unique_ptr<VideoDecoder::Reader> VideoDecoder::openReader() {
+    NUCLEX_FRAMEFIXER_TRACE_SCOPE(u8"libav", u8"Open video");
+    std::unique_ptr<Reader> reader = std::make_unique<Reader>();
+
+    {
+      int result = ::avformat_open_input(
+        &reader->FormatContext, this->path.c_str(), nullptr, nullptr
+      );
+      if(result < 0) {
+        throwExceptionForAvError(result, std::string(u8"Could not open video file: ", 27));
+      }
+    }
+    {
+      int result = ::avformat_find_stream_info(reader->FormatContext, nullptr);
+      if(result < 0) {
+        throwExceptionForAvError(
+          result, std::string(u8"Could not read stream informations from video file: ", 52)
+        );
+      }
+    }
+
+    // Pick the video stream. If there are several, libav knows which one is the main one.
+    // Readers opened later ask for the same stream the first reader has indexed.
+    const ::AVCodec *codec = nullptr;
+    int foundStreamIndex = ::av_find_best_stream(
+      reader->FormatContext, AVMEDIA_TYPE_VIDEO, this->streamIndex, -1, &codec, 0
+    );
+    if(foundStreamIndex < 0) {
+      throwExceptionForAvError(
+        foundStreamIndex, std::string(u8"Could not find a decodable video stream: ", 41)
+      );
+    }
+    if(this->streamIndex == -1) {
+      this->streamIndex = foundStreamIndex;
+    } else if(foundStreamIndex != this->streamIndex) {
+      throw std::runtime_error(u8"Video file changed while it was being decoded");
+    }
+
+    reader->CodecContext = ::avcodec_alloc_context3(codec);
+    if(reader->CodecContext == nullptr) {
+      throw std::runtime_error(u8"Could not allocate video codec context");
+    }
+    {
+      int result = ::avcodec_parameters_to_context(
+        reader->CodecContext, reader->FormatContext->streams[this->streamIndex]->codecpar
+      );
+      if(result < 0) {
+        throwExceptionForAvError(
+          result, std::string(u8"Could not copy stream parameters to codec: ", 43)
+        );
+      }
+    }
+    reader->CodecContext->thread_count = 0; // Let the codec use as many threads as it likes
+    {
+      int result = ::avcodec_open2(reader->CodecContext, codec, nullptr);
+      if(result < 0) {
+        throwExceptionForAvError(result, std::string(u8"Could not open video codec: ", 28));
+      }
+    }
+
+    return reader;
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  void VideoDecoder::buildFrameIndex(
+    Reader &reader, const std::shared_ptr<const CancellationWatcher> &cancellationWatcher
+  ) {
+    NUCLEX_FRAMEFIXER_TRACE_SCOPE(u8"libav", u8"Index video frames");
+
+    // The frame count in the stream header is only a hint (and missing in many
+    // containers), but it saves growing the index over and over again
+    const ::AVStream *stream = reader.FormatContext->streams[this->streamIndex];
+    if(stream->nb_frames > 0) {
+      this->frames.reserve(static_cast<std::size_t>(stream->nb_frames));
+    }
+
+    // Read all packets of the video stream without decoding them. Each packet
+    // holds exactly one frame, so this yields the true frame count and timestamps.
+    std::size_t packetCount = 0;
+    for(;;) {
+      int result = ::av_read_frame(reader.FormatContext, reader.Packet.get());
+      if(result == AVERROR_EOF) {
+        break;
+      }
+      if(result < 0) {
+        throwExceptionForAvError(result, std::string(u8"Could not read from video file: ", 32));
+      }
+
+      bool isDisplayedFrame = (
+        (reader.Packet->stream_index == this->streamIndex) &&
+        ((reader.Packet->flags & AV_PKT_FLAG_DISCARD) == 0)
+      );
+      if(isDisplayedFrame) {
+        IndexedFrame &frame = this->frames.emplace_back();
+        frame.PresentationTimestamp = reader.Packet->pts;
+        frame.DecodingTimestamp = reader.Packet->dts;
+        if(frame.PresentationTimestamp == AV_NOPTS_VALUE) {
+          frame.PresentationTimestamp = frame.DecodingTimestamp;
+        } else if(frame.DecodingTimestamp == AV_NOPTS_VALUE) {
+          frame.DecodingTimestamp = frame.PresentationTimestamp;
+        }
+        frame.KeyframeIndex = 0;
+        frame.EncodedSize = static_cast<std::size_t>(reader.Packet->size);
+        frame.IsKeyframe = ((reader.Packet->flags & AV_PKT_FLAG_KEY) != 0);
+
+        if(frame.PresentationTimestamp == AV_NOPTS_VALUE) {
+          throw std::runtime_error(
+            u8"Video stream has no timestamps, frames need to be extracted into images"
+          );
+        }
+      }
+      ::av_packet_unref(reader.Packet.get());
+
+      ++packetCount;
+      if((packetCount % 100) == 0) {
+        if(static_cast<bool>(cancellationWatcher)) {
+          cancellationWatcher->ThrowIfCanceled();
+        }
+      }
+    }
+
+    // Packets are stored in decoding order, but frames are addressed in the order
+    // in which they are displayed (these differ when B-frames are used).
+    std::sort(
+      this->frames.begin(), this->frames.end(),
+      [](const IndexedFrame &left, const IndexedFrame &right) {
+        return left.PresentationTimestamp < right.PresentationTimestamp;
+      }
+    );
+
+    // Decoding any frame can begin at the last keyframe displayed before it. Frames
+    // that reference an earlier group of pictures (open GOPs) end up assigned to that
+    // group's keyframe, so decoding from there produces them, too.
+    std::size_t keyframeIndex = 0;
+    for(std::size_t index = 0; index < this->frames.size(); ++index) {
+      if(this->frames[index].IsKeyframe) {
+        keyframeIndex = index;
+      }
+      this->frames[index].KeyframeIndex = keyframeIndex;
+    }
+
+    // The demuxer is now at the end of the file, so the first decode has to seek
+    reader.LastDecodedFrameIndex = std::size_t(-1);
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  void VideoDecoder::seekToKeyframeBefore(Reader &reader, std::size_t frameIndex) {
+    NUCLEX_FRAMEFIXER_TRACE_SCOPE(u8"libav", u8"Seek video");
+    const IndexedFrame &keyframe = this->frames[this->frames[frameIndex].KeyframeIndex];
+
+    // Seeking backwards from the keyframe's decoding timestamp lands on the keyframe
+    // itself or, if the container's index is coarser than ours, an earlier one.
+    // Either way, decoding onwards from there eventually produces the requested frame.
+    int result = ::av_seek_frame(
+      reader.FormatContext, this->streamIndex, keyframe.DecodingTimestamp, AVSEEK_FLAG_BACKWARD
+    );
+    if(result < 0) {
+      throwExceptionForAvError(result, std::string(u8"Could not seek in video file: ", 30));
+    }
+
+    ::avcodec_flush_buffers(reader.CodecContext);
+    reader.LastDecodedFrameIndex = std::size_t(-1);
+    reader.IsCodecDrained = false;
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  bool VideoDecoder::sendNextPacketToCodec(Reader &reader) {
+    for(;;) {
+      int result = ::av_read_frame(reader.FormatContext, reader.Packet.get());
+      if(result == AVERROR_EOF) {
+        break;
+      }
+      if(result < 0) {
+        throwExceptionForAvError(result, std::string(u8"Could not read from video file: ", 32));
+      }
+      if(reader.Packet->stream_index != this->streamIndex) {
+        ::av_packet_unref(reader.Packet.get());
+        continue;
+      }
+
+      result = ::avcodec_send_packet(reader.CodecContext, reader.Packet.get());
+      ::av_packet_unref(reader.Packet.get());
+
+      // Damaged packets are common in captured or ripped video. Skipping them means
+      // the frame comes out garbled (or not at all), which is what players do, too.
+      if((result < 0) && (result != AVERROR_INVALIDDATA)) {
+        throwExceptionForAvError(result, std::string(u8"Could not send packet to codec: ", 32));
+      }
+
+      return true;
+    }
+
+    // At the end of the file, sending an empty packet makes the codec emit
+    // the frames it was still holding back for reordering
+    int result = ::avcodec_send_packet(reader.CodecContext, nullptr);
+    if((result < 0) && (result != AVERROR_EOF)) {
+      throwExceptionForAvError(result, std::string(u8"Could not flush video codec: ", 29));
+    }
+
+    reader.IsCodecDrained = true;
+    return false;
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  QImage VideoDecoder::convertToImage(
+    Reader &reader, const std::shared_ptr<::AVFrame> &frame
+  ) {
+    using Nuclex::FrameFixer::Platform::LibAvApi;
+
+    bool formatChanged = (
+      (frame->width != reader.ConversionWidth) ||
+      (frame->height != reader.ConversionHeight) ||
+      (frame->format != reader.ConversionPixelFormat)
+    );
+    if(!static_cast<bool>(reader.ConversionFilterGraph) || formatChanged) {
+      createConversionFilterGraph(reader, *frame);
+    }
+
+    // This hands the frame's buffers over to the filter graph and leaves it empty
+    LibAvApi::PushFrameIntoFilterGraph(reader.ConversionFilterGraph, frame);
+    std::shared_ptr<::AVFrame> convertedFrame = LibAvApi::ReadFrameFromFilterGraph(
+      reader.ConversionFilterGraph
+    );
+    if(!static_cast<bool>(convertedFrame)) {
+      throw std::runtime_error(u8"Pixel format conversion of decoded frame produced no output");
+    }
+
+    // Qt's 64 bit format stores 16 bit channels in RGBA order in native endianness,
+    // which is exactly what the rgba64le format means on little endian systems.
+    QImage image(convertedFrame->width, convertedFrame->height, QImage::Format_RGBA64);
+    {
+      const std::uint8_t *frameData = convertedFrame->data[0];
+      std::size_t frameHeight = static_cast<std::size_t>(convertedFrame->height);
+      std::size_t lineLength = std::min<std::size_t>(
+        image.bytesPerLine(), static_cast<std::size_t>(convertedFrame->linesize[0])
+      );
+      for(std::size_t lineIndex = 0; lineIndex < frameHeight; ++lineIndex) {
+        std::copy_n(frameData, lineLength, image.scanLine(lineIndex));
+        frameData += convertedFrame->linesize[0];
+      }
+    }
+
+    ::av_frame_unref(convertedFrame.get());
+    return image;
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  void VideoDecoder::createConversionFilterGraph(
+    Reader &reader, const ::AVFrame &frame
+  ) {
+    using Nuclex::FrameFixer::Platform::LibAvApi;
+    using Nuclex::Support::Text::lexical_append;
+
+    reader.ConversionFilterGraph = LibAvApi::NewAvFilterGraph();
+
+    const ::AVStream *stream = reader.FormatContext->streams[this->streamIndex];
+    ::AVRational pixelAspect = frame.sample_aspect_ratio;
+    if((pixelAspect.num <= 0) || (pixelAspect.den <= 0)) {
+      pixelAspect = ::AVRational { 1, 1 };
+    }
+
+    std::string inputBufferArguments(u8"video_size=", 11);
+    lexical_append(inputBufferArguments, frame.width);
+    inputBufferArguments.push_back(u8'x');
+    lexical_append(inputBufferArguments, frame.height);
+    inputBufferArguments.append(u8":pix_fmt=", 9);
+    lexical_append(inputBufferArguments, frame.format);
+    inputBufferArguments.append(u8":time_base=", 11);
+    lexical_append(inputBufferArguments, stream->time_base.num);
+    inputBufferArguments.push_back(u8'/');
+    lexical_append(inputBufferArguments, stream->time_base.den);
+    inputBufferArguments.append(u8":pixel_aspect=", 14);
+    lexical_append(inputBufferArguments, pixelAspect.num);
+    inputBufferArguments.push_back(u8'/');
+    lexical_append(inputBufferArguments, pixelAspect.den);
+
+    // The scale filter picks the color matrix from the frame's tags. Chroma is
+    // interpolated at full precision so the deinterlacers get clean field lines.
+    std::string scaleArguments(u8"flags=accurate_rnd+full_chroma_int", 34);
+
+    ::AVFilterContext *inputFilterContext = LibAvApi::NewAvFilterContext(
+      reader.ConversionFilterGraph,
+      ::avfilter_get_by_name(u8"buffer"),
+      u8"in",
+      inputBufferArguments
+    );
+    ::AVFilterContext *scaleFilterContext = LibAvApi::NewAvFilterContext(
+      reader.ConversionFilterGraph,
+      ::avfilter_get_by_name(u8"scale"),
+      u8"convert",
+      scaleArguments
+    );
+    ::AVFilterContext *formatFilterContext = LibAvApi::NewAvFilterContext(
+      reader.ConversionFilterGraph,
+      ::avfilter_get_by_name(u8"format"),
+      u8"format",
+      std::string(u8"pix_fmts=rgba64le", 17)
+    );
+    ::AVFilterContext *outputFilterContext = LibAvApi::NewAvFilterContext(
+      reader.ConversionFilterGraph,
+      ::avfilter_get_by_name(u8"buffersink"),
+      u8"out"
+    );
+
+    LibAvApi::LinkAvFilterContexts(inputFilterContext, scaleFilterContext);
+    LibAvApi::LinkAvFilterContexts(scaleFilterContext, formatFilterContext);
+    LibAvApi::LinkAvFilterContexts(formatFilterContext, outputFilterContext);
+    LibAvApi::ConfigureAvFilterGraph(reader.ConversionFilterGraph);
+
+    reader.ConversionWidth = frame.width;
+    reader.ConversionHeight = frame.height;
+    reader.ConversionPixelFormat = frame.format;
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+} // namespace Nuclex::FrameFixer::Rendering
+
+#endif // defined(NUCLEX_FRAMEFIXER_ENABLE_LIBAV)
@@ -0,0 +1,199 @@
+#pragma region Apache License 2.0
+/*
+Nuclex Frame Fixer
+Copyright (C) 2024 Markus Ewald / Nuclex Development Labs
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#pragma endregion // Apache License 2.0
+
+#ifndef NUCLEX_FRAMEFIXER_RENDERING_VIDEODECODER_H
+#define NUCLEX_FRAMEFIXER_RENDERING_VIDEODECODER_H
+
+#include "Nuclex/FrameFixer/Config.h"
+
+#if defined(NUCLEX_FRAMEFIXER_ENABLE_LIBAV)
+
+#include <memory> // for std::shared_ptr
+#include <cstddef> // for std::size_t
+#include <cstdint> // for std::int64_t
+#include <string> // for std::string
+#include <vector> // for std::vector
+#include <mutex> // for std::mutex
+#include <condition_variable> // for std::condition_variable
+
+#include <QImage>
+
+#include <Nuclex/Platform/Tasks/CancellationWatcher.h> // for CancellationWatcher
+
+extern "C" {
+  struct AVFormatContext;
+  struct AVCodecContext;
+  struct AVFilterGraph;
+  struct AVFrame;
+  struct AVPacket;
+}
+
+namespace Nuclex::FrameFixer::Rendering {
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Decodes individual frames of a video file using libavformat and libavcodec</summary>
+  /// <remarks>
+  ///   <para>
+  ///     This lets a movie be opened directly from its video file instead of having
+  ///     ffmpeg extract every frame into a PNG file first. When the decoder is created,
+  ///     it reads through all packets of the video stream once (without decoding them)
+  ///     to build an index of the frames in presentation order and of the keyframes
+  ///     from which decoding can begin.
+  ///   </para>
+  ///   <para>
+  ///     Requesting a frame seeks to the closest keyframe before it and decodes forward
+  ///     until the exact frame is reached. Frames requested in ascending order within
+  ///     the same group of pictures are decoded without seeking again.
+  ///   </para>
+  ///   <para>
+  ///     The decoder can be shared by the threads of a render. Each concurrent request
+  ///     is served by its own reader (a demuxer and codec with its own position in
+  ///     the file), picking the reader that can decode onwards to the requested frame,
+  ///     so parallel segments and read-ahead threads don't keep seeking each other's
+  ///     readers back to a keyframe. Up to four readers are kept open.
+  ///   </para>
+  ///   <para>
+  ///     Frames are delivered as QImage::Format_RGBA64, the 16 bit layout all
+  ///     deinterlacers work with.
+  ///   </para>
+  /// </remarks>
+  class VideoDecoder {
+
+    typedef Nuclex::Platform::Tasks::CancellationWatcher CancellationWatcher;
+
+    /// <summary>Opens the specified video file and indexes its frames</summary>
+    /// <param name="path">Path of the video file that will be opened</param>
+    /// <param name="cancellationWatcher">Allows the indexing pass to be cancelled</param>
+    public: VideoDecoder(
+      const std::string &path,
+      const std::shared_ptr<const CancellationWatcher> &cancellationWatcher = (
+        std::shared_ptr<const CancellationWatcher>()
+      )
+    );
+    /// <summary>Closes the video file and frees all resources used by the decoder</summary>
+    public: ~VideoDecoder();
+
+    /// <summary>Counts the number of frames in the video stream</summary>
+    /// <returns>The number of frames the video stream consists of</returns>
+    public: std::size_t GetFrameCount() const;
+
+    /// <summary>Looks up how many bytes a frame takes up in the video file</summary>
+    /// <param name="frameIndex">Index of the frame whose encoded size will be returned</param>
+    /// <returns>The size of the compressed packet holding the frame</returns>
+    public: std::size_t GetEncodedFrameSize(std::size_t frameIndex) const;
+
+    /// <summary>Decodes the specified frame of the video</summary>
+    /// <param name="frameIndex">Index of the frame in presentation order</param>
+    /// <returns>The decoded frame as a 16 bit per channel RGBA image</returns>
+    public: QImage DecodeFrame(std::size_t frameIndex);
+
+    /// <summary>Stores the position and properties of a frame in the video stream</summary>
+    private: struct IndexedFrame {
+
+      /// <summary>Presentation timestamp of the frame in the stream's time base</summary>
+      public: std::int64_t PresentationTimestamp;
+      /// <summary>Decoding timestamp of the frame's packet, used when seeking</summary>
+      public: std::int64_t DecodingTimestamp;
+      /// <summary>Index of the keyframe decoding has to start from to reach this frame</summary>
+      public: std::size_t KeyframeIndex;
+      /// <summary>Size of the compressed packet holding the frame</summary>
+      public: std::size_t EncodedSize;
+      /// <summary>Whether decoding can begin at this frame</summary>
+      public: bool IsKeyframe;
+
+    };
+
+    /// <summary>Demuxer and codec decoding the video from one position in the file</summary>
+    private: struct Reader;
+
+    /// <summary>Decodes the specified frame with the specified reader</summary>
+    /// <param name="reader">Reader that will decode the frame</param>
+    /// <param name="frameIndex">Index of the frame in presentation order</param>
+    /// <returns>The decoded frame as a 16 bit per channel RGBA image</returns>
+    private: QImage decodeFrame(Reader &reader, std::size_t frameIndex);
+
+    /// <summary>Takes the reader best suited to decode the specified frame</summary>
+    /// <param name="frameIndex">Index of the frame that will be decoded next</param>
+    /// <returns>
+    ///   An idle reader, a newly opened one or, if the maximum number of readers are
+    ///   busy, the first reader that becomes available
+    /// </returns>
+    private: std::unique_ptr<Reader> acquireReader(std::size_t frameIndex);
+
+    /// <summary>Returns a reader so it can be used for the next requested frame</summary>
+    /// <param name="reader">Reader that will be returned</param>
+    private: void releaseReader(std::unique_ptr<Reader> reader);
+
+    /// <summary>Opens the video file and sets up a codec for its video stream</summary>
+    /// <returns>A new reader positioned at the beginning of the file</returns>
+    private: std::unique_ptr<Reader> openReader();
+
+    /// <summary>Reads all packets of the video stream and builds the frame index</summary>
+    /// <param name="reader">Reader whose demuxer will be used to read the packets</param>
+    /// <param name="cancellationWatcher">Allows the indexing pass to be cancelled</param>
+    private: void buildFrameIndex(
+      Reader &reader, const std::shared_ptr<const CancellationWatcher> &cancellationWatcher
+    );
+
+    /// <summary>Moves the read position to the keyframe preceding the specified frame</summary>
+    /// <param name="reader">Reader whose read position will be moved</param>
+    /// <param name="frameIndex">Index of the frame that should be decoded next</param>
+    private: void seekToKeyframeBefore(Reader &reader, std::size_t frameIndex);
+
+    /// <summary>Reads the next packet of the video stream and sends it to the codec</summary>
+    /// <param name="reader">Reader whose demuxer and codec will be used</param>
+    /// <returns>False if the end of the file was reached and the codec was flushed</returns>
+    private: bool sendNextPacketToCodec(Reader &reader);
+
+    /// <summary>Converts a decoded frame into a QImage with 16 bit channels</summary>
+    /// <param name="reader">Reader that decoded the frame</param>
+    /// <param name="frame">Frame that will be converted</param>
+    /// <returns>A QImage holding the pixels of the frame</returns>
+    private: QImage convertToImage(Reader &reader, const std::shared_ptr<::AVFrame> &frame);
+
+    /// <summary>Sets up the filter graph converting decoded frames into RGBA64</summary>
+    /// <param name="reader">Reader the filter graph will be set up for</param>
+    /// <param name="frame">Decoded frame whose format the filter graph will accept</param>
+    private: void createConversionFilterGraph(Reader &reader, const ::AVFrame &frame);
+
+    /// <summary>Path of the video file being read</summary>
+    private: std::string path;
+    /// <summary>Index of the video stream inside the container</summary>
+    private: int streamIndex;
+    /// <summary>All frames of the video stream in presentation order</summary>
+    private: std::vector<IndexedFrame> frames;
+    /// <summary>Must be held while taking or returning readers</summary>
+    private: std::mutex readerMutex;
+    /// <summary>Signalled when a reader is returned</summary>
+    private: std::condition_variable readerReleased;
+    /// <summary>Readers that are currently not decoding, least recently used first</summary>
+    private: std::vector<std::unique_ptr<Reader>> idleReaders;
+    /// <summary>Number of readers that are open, including the busy ones</summary>
+    private: std::size_t openReaderCount;
+
+  };
+
+  // ------------------------------------------------------------------------------------------- //
+
+} // namespace Nuclex::FrameFixer::Rendering
+
+#endif // defined(NUCLEX_FRAMEFIXER_ENABLE_LIBAV)
+
+#endif // NUCLEX_FRAMEFIXER_RENDERING_VIDEODECODER_H
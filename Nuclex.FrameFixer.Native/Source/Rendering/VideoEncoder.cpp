@@ -0,0 +1,544 @@
+#pragma region Apache License 2.0
+/*
+Nuclex Frame Fixer
+Copyright (C) 2024 Markus Ewald / Nuclex Development Labs
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#pragma endregion // Apache License 2.0
+
+// If the application is compiled as a DLL, this ensures symbols are exported
+#define NUCLEX_FRAMEFIXER_SOURCE 1
+
+#include "./VideoEncoder.h"
+
+#if defined(NUCLEX_FRAMEFIXER_ENABLE_LIBAV)
+
+#include "../Platform/LibAvApi.h"
+
+#include <Nuclex/Support/Text/LexicalAppend.h> // for lexical_append()
+#include <Nuclex/Support/Text/LexicalCast.h> // for lexical_cast()
+
+#include <stdexcept> // for std::runtime_error
+#include <algorithm> // for std::copy_n(), std::min()
+#include <cstdint> // for std::uint8_t, std::int64_t
+
+extern "C" {
+  #include <libavcodec/avcodec.h>
+  #include <libavformat/avformat.h>
+  #include <libavutil/pixdesc.h>
+}
+
+namespace {
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Throws an exception for the specified libav result code</summary>
+  /// <param name="libavResult">
+  ///   libav result code for which an error message will be provided in the exception
+  /// </param>
+  /// <param name="message">
+  ///   Additional text that will be prefixed to the exception message
+  /// </param>
+  [[noreturn]] void throwExceptionForAvError(int libAvResult, const std::string &message) {
+    char buffer[1024];
+    int errorStringResult = ::av_strerror(libAvResult, buffer, sizeof(buffer));
+
+    std::string combinedMessage(message);
+    if(errorStringResult == 0) {
+      combinedMessage.append(buffer);
+    } else {
+      combinedMessage.append(u8"unknown error ", 14);
+      Nuclex::Support::Text::lexical_append(combinedMessage, libAvResult);
+    }
+
+    throw std::runtime_error(combinedMessage);
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Frees an AV packet</summary>
+  /// <param name="packet">Packet that will be freed</param>
+  /// <remarks>
+  ///   This is a wrapper method so the shared_ptr can call av_packet_free()
+  /// </remarks>
+  void deleteAvPacket(::AVPacket *packet) {
+    ::av_packet_free(&packet);
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Looks up the name of the libavcodec encoder for a video codec</summary>
+  /// <param name="codec">Video codec whose encoder name will be returned</param>
+  /// <returns>The name under which libavcodec registers the encoder</returns>
+  const char *getEncoderName(Nuclex::FrameFixer::Rendering::VideoCodec codec) {
+    using Nuclex::FrameFixer::Rendering::VideoCodec;
+    switch(codec) {
+      case VideoCodec::H264: { return u8"libx264"; }
+      case VideoCodec::H265: { return u8"libx265"; }
+      default: { return u8"ffv1"; }
+    }
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Checks whether a codec can encode frames in the specified pixel format</summary>
+  /// <param name="codec">Codec that will be checked</param>
+  /// <param name="pixelFormat">Pixel format the codec should accept</param>
+  /// <returns>True if the codec lists the pixel format as supported</returns>
+  bool supportsPixelFormat(const ::AVCodec *codec, ::AVPixelFormat pixelFormat) {
+    if(codec->pix_fmts == nullptr) {
+      return false;
+    }
+
+    for(const ::AVPixelFormat *current = codec->pix_fmts; *current != AV_PIX_FMT_NONE; ++current) {
+      if(*current == pixelFormat) {
+        return true;
+      }
+    }
+
+    return false;
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Picks the pixel format in which a codec will encode the frames</summary>
+  /// <param name="codec">Codec the frames will be encoded with</param>
+  /// <param name="videoCodec">Video codec selected in the settings</param>
+  /// <param name="inputPixelFormat">Pixel format of the frames from the renderer</param>
+  /// <returns>The pixel format the codec will be set up for</returns>
+  /// <remarks>
+  ///   Left to itself, libavcodec prefers planar RGB for RGB input when a codec offers
+  ///   it because that loses nothing, which would give RGB H.265 that most players can't
+  ///   play. So x264 and x265 always get 4:2:0 YUV, 10 bit for frames with 16 bit
+  ///   channels if the installed encoder was built with support for it.
+  /// </remarks>
+  ::AVPixelFormat selectCodecPixelFormat(
+    const ::AVCodec *codec,
+    Nuclex::FrameFixer::Rendering::VideoCodec videoCodec,
+    ::AVPixelFormat inputPixelFormat
+  ) {
+    using Nuclex::FrameFixer::Rendering::VideoCodec;
+
+    if((videoCodec == VideoCodec::H264) || (videoCodec == VideoCodec::H265)) {
+      bool useTenBits = (
+        (inputPixelFormat == AV_PIX_FMT_RGBA64) &&
+        supportsPixelFormat(codec, AV_PIX_FMT_YUV420P10LE)
+      );
+      return useTenBits ? AV_PIX_FMT_YUV420P10LE : AV_PIX_FMT_YUV420P;
+    }
+
+    if(codec->pix_fmts == nullptr) {
+      return inputPixelFormat;
+    } else {
+      return ::avcodec_find_best_pix_fmt_of_list(codec->pix_fmts, inputPixelFormat, 0, nullptr);
+    }
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Picks the libav pixel format matching a QImage with the least loss</summary>
+  /// <param name="image">Image for which the libav pixel format will be picked</param>
+  /// <returns>
+  ///   AV_PIX_FMT_RGBA64 for images with 16 bit channels, otherwise AV_PIX_FMT_RGB32
+  /// </returns>
+  ::AVPixelFormat getAvPixelFormat(const QImage &image) {
+    if(image.depth() > 32) {
+      return AV_PIX_FMT_RGBA64;
+    } else {
+      return AV_PIX_FMT_RGB32;
+    }
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Creates a new AV frame containing the pixels of a QImage</summary>
+  /// <param name="image">Image whose pixels will be copied into a new AV frame</param>
+  /// <param name="pixelFormat">
+  ///   Pixel format of the AV frame, either AV_PIX_FMT_RGBA64 or AV_PIX_FMT_RGB32
+  /// </param>
+  /// <returns>An AV frame containing the pixels of the input image</returns>
+  /// <remarks>
+  ///   The conversion filter graph only accepts frames in the pixel format it was set up
+  ///   for, but interpolated, averaged and cached frames can come in other QImage formats
+  ///   than the first frame did. Those are converted here.
+  /// </remarks>
+  std::shared_ptr<::AVFrame> avFrameFromQImage(const QImage &image, ::AVPixelFormat pixelFormat) {
+    using Nuclex::FrameFixer::Platform::LibAvApi;
+
+    std::shared_ptr<::AVFrame> frame = LibAvApi::NewAvFrame();
+    frame->width = image.width();
+    frame->height = image.height();
+    frame->format = pixelFormat;
+
+    // Qt's 64 bit formats store 16 bit channels in RGBA order in native endianness,
+    // its 32 bit formats store 0xAARRGGBB integers, which is what AV_PIX_FMT_RGB32 means.
+    QImage convertedImage;
+    const QImage *sourceImage = &image;
+    if(pixelFormat == AV_PIX_FMT_RGBA64) {
+      bool isMatching = (
+        (image.format() == QImage::Format_RGBA64) ||
+        (image.format() == QImage::Format_RGBX64)
+      );
+      if(!isMatching) {
+        convertedImage = image.convertToFormat(QImage::Format_RGBA64);
+        sourceImage = &convertedImage;
+      }
+    } else {
+      bool isMatching = (
+        (image.format() == QImage::Format_RGB32) ||
+        (image.format() == QImage::Format_ARGB32)
+      );
+      if(!isMatching) {
+        convertedImage = image.convertToFormat(QImage::Format_RGB32);
+        sourceImage = &convertedImage;
+      }
+    }
+
+    LibAvApi::LockAvFrameBuffer(frame);
+
+    std::uint8_t *frameData = frame->data[0];
+    std::size_t frameHeight = static_cast<std::size_t>(frame->height);
+    std::size_t lineLength = std::min<std::size_t>(
+      sourceImage->bytesPerLine(), static_cast<std::size_t>(frame->linesize[0])
+    );
+    for(std::size_t lineIndex = 0; lineIndex < frameHeight; ++lineIndex) {
+      std::copy_n(sourceImage->scanLine(lineIndex), lineLength, frameData);
+      frameData += frame->linesize[0];
+    }
+
+    return frame;
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+} // anonymous namespace
+
+namespace Nuclex::FrameFixer::Rendering {
+
+  // ------------------------------------------------------------------------------------------- //
+
+  VideoEncoder::VideoEncoder(const std::string &path, const VideoSettings &settings) :
+    path(path),
+    settings(settings),
+    formatContext(nullptr),
+    codecContext(nullptr),
+    stream(nullptr),
+    conversionFilterGraph(),
+    inputPixelFormat(AV_PIX_FMT_NONE),
+    encodedFrameCount(0) {}
+
+  // ------------------------------------------------------------------------------------------- //
+
+  VideoEncoder::~VideoEncoder() {
+    close();
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  void VideoEncoder::Encode(const QImage &image) {
+    using Nuclex::FrameFixer::Platform::LibAvApi;
+
+    // The first frame decides the pixel format the conversion filter graph is set up for,
+    // all later frames are brought into that format, whatever format they come in.
+    if(this->codecContext == nullptr) {
+      open(image.width(), image.height(), getAvPixelFormat(image));
+    } else {
+      bool dimensionsMatch = (
+        (image.width() == this->codecContext->width) &&
+        (image.height() == this->codecContext->height)
+      );
+      if(!dimensionsMatch) {
+        throw std::runtime_error(u8"All frames encoded into a video must have the same size");
+      }
+    }
+
+    std::shared_ptr<::AVFrame> frame = avFrameFromQImage(
+      image, static_cast<::AVPixelFormat>(this->inputPixelFormat)
+    );
+
+    // Convert the frame into the codec's pixel format. The conversion filters
+    // do not hold back any frames, but we collect whatever comes out anyway.
+    LibAvApi::PushFrameIntoFilterGraph(this->conversionFilterGraph, frame);
+    for(;;) {
+      std::shared_ptr<::AVFrame> convertedFrame = LibAvApi::ReadFrameFromFilterGraph(
+        this->conversionFilterGraph
+      );
+      if(!static_cast<bool>(convertedFrame)) {
+        break;
+      }
+
+      convertedFrame->pts = static_cast<std::int64_t>(this->encodedFrameCount);
+      ++this->encodedFrameCount;
+
+      sendFrameToCodec(convertedFrame);
+    }
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  void VideoEncoder::Finish() {
+    if(this->codecContext == nullptr) {
+      return; // No frames were encoded, so there is no file to complete
+    }
+
+    // Sending an empty frame makes the codec emit any frames it was still holding
+    // (x264 and x265 look ahead by several dozen frames)
+    sendFrameToCodec(std::shared_ptr<::AVFrame>());
+
+    int result = ::av_write_trailer(this->formatContext);
+    if(result < 0) {
+      throwExceptionForAvError(result, std::string(u8"Could not complete video file: ", 31));
+    }
+
+    close();
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  void VideoEncoder::open(int width, int height, int inputPixelFormat) {
+    const ::AVCodec *codec = ::avcodec_find_encoder_by_name(getEncoderName(this->settings.Codec));
+    if(codec == nullptr) {
+      std::string message(u8"Video encoder '", 15);
+      message.append(getEncoderName(this->settings.Codec));
+      message.append(u8"' is not available in the installed libavcodec", 46);
+      throw std::runtime_error(message);
+    }
+
+    // Set up the container. libavformat picks the container format from the file extension.
+    {
+      int result = ::avformat_alloc_output_context2(
+        &this->formatContext, nullptr, nullptr, this->path.c_str()
+      );
+      if(result < 0) {
+        throwExceptionForAvError(result, std::string(u8"Could not set up video container: ", 34));
+      }
+    }
+    this->stream = ::avformat_new_stream(this->formatContext, nullptr);
+    if(this->stream == nullptr) {
+      throw std::runtime_error(u8"Could not add video stream to container");
+    }
+
+    // Set up the codec. FFV1 gets the pixel format closest to that of the rendered frames,
+    // which is 16 bit planar RGB (truly lossless), x264/x265 get YUV (see below).
+    this->codecContext = ::avcodec_alloc_context3(codec);
+    if(this->codecContext == nullptr) {
+      throw std::runtime_error(u8"Could not allocate video codec context");
+    }
+    this->codecContext->width = width;
+    this->codecContext->height = height;
+    this->codecContext->time_base = ::AVRational {
+      static_cast<int>(this->settings.FrameRateDenominator),
+      static_cast<int>(this->settings.FrameRateNumerator)
+    };
+    this->codecContext->framerate = ::AVRational {
+      static_cast<int>(this->settings.FrameRateNumerator),
+      static_cast<int>(this->settings.FrameRateDenominator)
+    };
+    this->codecContext->sample_aspect_ratio = ::AVRational { 1, 1 };
+    this->codecContext->thread_count = 0; // Let the codec use as many threads as it likes
+    this->codecContext->pix_fmt = selectCodecPixelFormat(
+      codec, this->settings.Codec, static_cast<::AVPixelFormat>(inputPixelFormat)
+    );
+
+    // Tag YUV output as HD video so players don't apply the SD color matrix
+    const ::AVPixFmtDescriptor *pixelFormatDescriptor = ::av_pix_fmt_desc_get(
+      this->codecContext->pix_fmt
+    );
+    bool isRgb = (
+      (pixelFormatDescriptor != nullptr) &&
+      ((pixelFormatDescriptor->flags & AV_PIX_FMT_FLAG_RGB) != 0)
+    );
+    if(!isRgb) {
+      this->codecContext->colorspace = AVCOL_SPC_BT709;
+      this->codecContext->color_primaries = AVCOL_PRI_BT709;
+      this->codecContext->color_trc = AVCOL_TRC_BT709;
+      this->codecContext->color_range = AVCOL_RANGE_MPEG;
+    }
+
+    if(this->settings.Codec == VideoCodec::Ffv1) {
+      this->codecContext->gop_size = 1;
+      ::av_opt_set(this->codecContext->priv_data, u8"level", u8"3", 0);
+      ::av_opt_set(this->codecContext->priv_data, u8"slices", u8"16", 0);
+      ::av_opt_set(this->codecContext->priv_data, u8"slicecrc", u8"1", 0);
+    } else {
+      std::string crf = Nuclex::Support::Text::lexical_cast<std::string>(this->settings.Quality);
+      ::av_opt_set(this->codecContext->priv_data, u8"crf", crf.c_str(), 0);
+      ::av_opt_set(this->codecContext->priv_data, u8"preset", u8"medium", 0);
+    }
+    if((this->formatContext->oformat->flags & AVFMT_GLOBALHEADER) != 0) {
+      this->codecContext->flags |= AV_CODEC_FLAG_GLOBAL_HEADER;
+    }
+
+    {
+      int result = ::avcodec_open2(this->codecContext, codec, nullptr);
+      if(result < 0) {
+        throwExceptionForAvError(result, std::string(u8"Could not open video codec: ", 28));
+      }
+    }
+    {
+      int result = ::avcodec_parameters_from_context(this->stream->codecpar, this->codecContext);
+      if(result < 0) {
+        throwExceptionForAvError(
+          result, std::string(u8"Could not copy codec parameters to stream: ", 43)
+        );
+      }
+    }
+    this->stream->time_base = this->codecContext->time_base;
+
+    // Create the file and write the container header
+    if((this->formatContext->oformat->flags & AVFMT_NOFILE) == 0) {
+      int result = ::avio_open(&this->formatContext->pb, this->path.c_str(), AVIO_FLAG_WRITE);
+      if(result < 0) {
+        throwExceptionForAvError(result, std::string(u8"Could not create video file: ", 29));
+      }
+    }
+    {
+      int result = ::avformat_write_header(this->formatContext, nullptr);
+      if(result < 0) {
+        throwExceptionForAvError(
+          result, std::string(u8"Could not write video container header: ", 40)
+        );
+      }
+    }
+
+    createConversionFilterGraph(inputPixelFormat);
+    this->inputPixelFormat = inputPixelFormat;
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  void VideoEncoder::createConversionFilterGraph(int inputPixelFormat) {
+    using Nuclex::FrameFixer::Platform::LibAvApi;
+    using Nuclex::Support::Text::lexical_append;
+
+    this->conversionFilterGraph = LibAvApi::NewAvFilterGraph();
+
+    std::string inputBufferArguments(u8"video_size=", 11);
+    lexical_append(inputBufferArguments, this->codecContext->width);
+    inputBufferArguments.push_back(u8'x');
+    lexical_append(inputBufferArguments, this->codecContext->height);
+    inputBufferArguments.append(u8":pix_fmt=", 9);
+    lexical_append(inputBufferArguments, inputPixelFormat);
+    inputBufferArguments.append(u8":time_base=", 11);
+    lexical_append(inputBufferArguments, this->codecContext->time_base.num);
+    inputBufferArguments.push_back(u8'/');
+    lexical_append(inputBufferArguments, this->codecContext->time_base.den);
+    inputBufferArguments.append(u8":pixel_aspect=1/1", 17);
+
+    // The scale filter does the actual conversion. It is told to use the HD color
+    // matrix for YUV, matching the tags on the codec, and to not skimp on precision.
+    std::string scaleArguments(u8"out_color_matrix=bt709:out_range=tv", 35);
+    scaleArguments.append(u8":flags=accurate_rnd+full_chroma_int", 35);
+
+    std::string formatArguments(u8"pix_fmts=", 9);
+    formatArguments.append(::av_get_pix_fmt_name(this->codecContext->pix_fmt));
+
+    ::AVFilterContext *inputFilterContext = LibAvApi::NewAvFilterContext(
+      this->conversionFilterGraph,
+      ::avfilter_get_by_name(u8"buffer"),
+      u8"in",
+      inputBufferArguments
+    );
+    ::AVFilterContext *scaleFilterContext = LibAvApi::NewAvFilterContext(
+      this->conversionFilterGraph,
+      ::avfilter_get_by_name(u8"scale"),
+      u8"convert",
+      scaleArguments
+    );
+    ::AVFilterContext *formatFilterContext = LibAvApi::NewAvFilterContext(
+      this->conversionFilterGraph,
+      ::avfilter_get_by_name(u8"format"),
+      u8"format",
+      formatArguments
+    );
+    ::AVFilterContext *outputFilterContext = LibAvApi::NewAvFilterContext(
+      this->conversionFilterGraph,
+      ::avfilter_get_by_name(u8"buffersink"),
+      u8"out"
+    );
+
+    LibAvApi::LinkAvFilterContexts(inputFilterContext, scaleFilterContext);
+    LibAvApi::LinkAvFilterContexts(scaleFilterContext, formatFilterContext);
+    LibAvApi::LinkAvFilterContexts(formatFilterContext, outputFilterContext);
+
+    LibAvApi::ConfigureAvFilterGraph(this->conversionFilterGraph);
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  void VideoEncoder::sendFrameToCodec(const std::shared_ptr<::AVFrame> &frame) {
+    int result = ::avcodec_send_frame(this->codecContext, frame.get());
+    if(result < 0) {
+      throwExceptionForAvError(result, std::string(u8"Could not send frame to video codec: ", 37));
+    }
+
+    writeCompletedPackets();
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  void VideoEncoder::writeCompletedPackets() {
+    std::shared_ptr<::AVPacket> packet(::av_packet_alloc(), &deleteAvPacket);
+    if(!static_cast<bool>(packet)) {
+      throw std::runtime_error(u8"Could not allocate AV packet");
+    }
+
+    for(;;) {
+      int result = ::avcodec_receive_packet(this->codecContext, packet.get());
+      if((result == AVERROR(EAGAIN)) || (result == AVERROR_EOF)) {
+        break;
+      }
+      if(result < 0) {
+        throwExceptionForAvError(
+          result, std::string(u8"Could not receive packet from video codec: ", 43)
+        );
+      }
+
+      // The container may use a different time base than the codec (Matroska
+      // always uses milliseconds), so the timestamps need to be converted.
+      ::av_packet_rescale_ts(packet.get(), this->codecContext->time_base, this->stream->time_base);
+      packet->stream_index = this->stream->index;
+
+      // This takes ownership of the packet's data and resets the packet
+      result = ::av_interleaved_write_frame(this->formatContext, packet.get());
+      if(result < 0) {
+        throwExceptionForAvError(result, std::string(u8"Could not write video packet: ", 30));
+      }
+    }
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  void VideoEncoder::close() {
+    this->conversionFilterGraph.reset();
+
+    if(this->codecContext != nullptr) {
+      ::avcodec_free_context(&this->codecContext);
+    }
+    if(this->formatContext != nullptr) {
+      if((this->formatContext->oformat->flags & AVFMT_NOFILE) == 0) {
+        ::avio_closep(&this->formatContext->pb);
+      }
+      ::avformat_free_context(this->formatContext);
+      this->formatContext = nullptr;
+    }
+
+    this->stream = nullptr;
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+} // namespace Nuclex::FrameFixer::Rendering
+
+#endif // defined(NUCLEX_FRAMEFIXER_ENABLE_LIBAV)
@@ -0,0 +1,130 @@
+#pragma region Apache License 2.0
+/*
+Nuclex Frame Fixer
+Copyright (C) 2024 Markus Ewald / Nuclex Development Labs
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#pragma endregion // Apache License 2.0
+
+#ifndef NUCLEX_FRAMEFIXER_RENDERING_VIDEOENCODER_H
+#define NUCLEX_FRAMEFIXER_RENDERING_VIDEOENCODER_H
+
+#include "Nuclex/FrameFixer/Config.h"
+
+#if defined(NUCLEX_FRAMEFIXER_ENABLE_LIBAV)
+
+#include "./VideoSettings.h"
+
+#include <memory> // for std::shared_ptr
+#include <cstddef> // for std::size_t
+#include <string> // for std::string
+
+#include <QImage>
+
+extern "C" {
+  struct AVFormatContext;
+  struct AVCodecContext;
+  struct AVStream;
+  struct AVFilterGraph;
+  struct AVFrame;
+}
+
+namespace Nuclex::FrameFixer::Rendering {
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Encodes output frames into a video file using libavcodec and libavformat</summary>
+  /// <remarks>
+  ///   <para>
+  ///     This avoids having to store each output frame as a PNG file and then feeding
+  ///     the whole sequence to ffmpeg in a second pass. The container format is chosen
+  ///     by the extension of the output path, Matroska (.mkv) can hold all supported codecs.
+  ///   </para>
+  ///   <para>
+  ///     The encoder is opened when the first frame arrives, since only then are
+  ///     its dimensions and pixel format known. Later frames are brought into the first
+  ///     frame's pixel format and then converted for the codec via a libav filter graph,
+  ///     so 16 bit frames stay 16 bit with FFV1 and become 10 bit 4:2:0 YUV with x265.
+  ///   </para>
+  ///   <para>
+  ///     Frames must be passed in the order they should appear in the video. The encoder
+  ///     is not thread-safe, but the codecs themselves use as many threads as they can.
+  ///   </para>
+  /// </remarks>
+  class VideoEncoder {
+
+    /// <summary>Initializes a new video encoder writing to the specified file</summary>
+    /// <param name="path">Path of the video file that will be created</param>
+    /// <param name="settings">Codec, quality and frame rate of the video</param>
+    public: VideoEncoder(const std::string &path, const VideoSettings &settings);
+    /// <summary>Closes the video file and frees all resources used by the encoder</summary>
+    /// <remarks>
+    ///   If <see cref="Finish" /> has not been called, frames still buffered inside
+    ///   the codec are lost and the video file may not be playable.
+    /// </remarks>
+    public: ~VideoEncoder();
+
+    /// <summary>Encodes the next frame of the video</summary>
+    /// <param name="image">Image that will be encoded as the next frame</param>
+    public: void Encode(const QImage &image);
+
+    /// <summary>Encodes any frames still buffered by the codec and completes the file</summary>
+    public: void Finish();
+
+    /// <summary>Creates the video file and sets up the codec for the first frame</summary>
+    /// <param name="width">Width of the video in pixels</param>
+    /// <param name="height">Height of the video in pixels</param>
+    /// <param name="inputPixelFormat">Pixel format of the frames from the renderer</param>
+    private: void open(int width, int height, int inputPixelFormat);
+
+    /// <summary>Sets up the filter graph converting frames for the codec</summary>
+    /// <param name="inputPixelFormat">Pixel format of the frames from the renderer</param>
+    private: void createConversionFilterGraph(int inputPixelFormat);
+
+    /// <summary>Sends a frame to the codec, or flushes the codec if the frame is empty</summary>
+    /// <param name="frame">Frame that will be sent to the codec</param>
+    private: void sendFrameToCodec(const std::shared_ptr<::AVFrame> &frame);
+
+    /// <summary>Writes all packets the codec has completed into the video file</summary>
+    private: void writeCompletedPackets();
+
+    /// <summary>Closes the video file and releases all libav objects</summary>
+    private: void close();
+
+    /// <summary>Path of the video file being written</summary>
+    private: std::string path;
+    /// <summary>Codec, quality and frame rate of the video</summary>
+    private: VideoSettings settings;
+    /// <summary>Container the encoded video is written into</summary>
+    private: ::AVFormatContext *formatContext;
+    /// <summary>Codec encoding the frames</summary>
+    private: ::AVCodecContext *codecContext;
+    /// <summary>Video stream inside the container, owned by the format context</summary>
+    private: ::AVStream *stream;
+    /// <summary>Filter graph that converts frames into the codec's pixel format</summary>
+    private: std::shared_ptr<::AVFilterGraph> conversionFilterGraph;
+    /// <summary>Pixel format all frames are converted to before entering the filter graph</summary>
+    private: int inputPixelFormat;
+    /// <summary>Number of frames sent to the codec so far, used as timestamp</summary>
+    private: std::size_t encodedFrameCount;
+
+  };
+
+  // ------------------------------------------------------------------------------------------- //
+
+} // namespace Nuclex::FrameFixer::Rendering
+
+#endif // defined(NUCLEX_FRAMEFIXER_ENABLE_LIBAV)
+
+#endif // NUCLEX_FRAMEFIXER_RENDERING_VIDEOENCODER_H
@@ -0,0 +1,69 @@
+#pragma region Apache License 2.0
+/*
+Nuclex Frame Fixer
+Copyright (C) 2024 Markus Ewald / Nuclex Development Labs
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#pragma endregion // Apache License 2.0
+
+#ifndef NUCLEX_FRAMEFIXER_RENDERING_VIDEOSETTINGS_H
+#define NUCLEX_FRAMEFIXER_RENDERING_VIDEOSETTINGS_H
+
+#include "Nuclex/FrameFixer/Config.h"
+
+#include <cstddef> // for std::size_t
+
+namespace Nuclex::FrameFixer::Rendering {
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Video codecs output frames can be encoded with</summary>
+  enum class VideoCodec {
+
+    /// <summary>Lossless FFV1 codec, keeps 16 bits per color channel</summary>
+    Ffv1,
+
+    /// <summary>H.264 / AVC codec via x264, quality controlled by the CRF value</summary>
+    H264,
+
+    /// <summary>H.265 / HEVC codec via x265, quality controlled by the CRF value</summary>
+    H265
+
+  };
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Settings for encoding output frames into a video file</summary>
+  struct VideoSettings {
+
+    /// <summary>Codec the output frames will be encoded with</summary>
+    public: VideoCodec Codec;
+    /// <summary>Constant rate factor for lossy codecs, lower values mean higher quality</summary>
+    /// <remarks>
+    ///   Ignored by lossless codecs. x264 and x265 both accept values from 0 to 51,
+    ///   with 18 generally considered visually lossless.
+    /// </remarks>
+    public: int Quality;
+    /// <summary>Numerator of the frame rate stored in the video file</summary>
+    public: std::size_t FrameRateNumerator;
+    /// <summary>Denominator of the frame rate stored in the video file</summary>
+    public: std::size_t FrameRateDenominator;
+
+  };
+
+  // ------------------------------------------------------------------------------------------- //
+
+} // namespace Nuclex::FrameFixer::Rendering
+
+#endif // NUCLEX_FRAMEFIXER_RENDERING_VIDEOSETTINGS_H
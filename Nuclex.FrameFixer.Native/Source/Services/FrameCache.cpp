@@ -0,0 +1,233 @@
+#pragma region Apache License 2.0
+/*
+Nuclex Frame Fixer
+Copyright (C) 2024 Markus Ewald / Nuclex Development Labs
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#pragma endregion // Apache License 2.0
+
+// If the application is compiled as a DLL, this ensures symbols are exported
+#define NUCLEX_FRAMEFIXER_SOURCE 1
+
+#include "./FrameCache.h"
+#include "../Model/Movie.h"
+
+namespace Nuclex::FrameFixer::Services {
+
+  // ------------------------------------------------------------------------------------------- //
+
+  const std::size_t FrameCache::DefaultCapacityInBytes = std::size_t(1024) * 1024 * 1024;
+
+  // ------------------------------------------------------------------------------------------- //
+
+  FrameCache::FrameCache(std::size_t capacityInBytes /* = DefaultCapacityInBytes */) :
+    mutex(),
+    frameDirectory(),
+    entries(),
+    entryLookup(),
+    memoryBudget(),
+    capacityInBytes(capacityInBytes),
+    usedBytes(0),
+    hitCount(0),
+    missCount(0),
+    readByteCount(0) {}
+
+  // ------------------------------------------------------------------------------------------- //
+
+  FrameCache::~FrameCache() {}
+
+  // ------------------------------------------------------------------------------------------- //
+
+  void FrameCache::SetCapacity(std::size_t capacityInBytes) {
+    std::unique_lock<std::mutex> cacheLock(this->mutex);
+    this->capacityInBytes = capacityInBytes;
+    evictToCapacity();
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  void FrameCache::SetMemoryBudget(
+    const std::shared_ptr<Rendering::FrameMemoryBudget> &memoryBudget
+  ) {
+    std::unique_lock<std::mutex> cacheLock(this->mutex);
+    this->memoryBudget = memoryBudget;
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  QImage FrameCache::GetFrame(
+    const Movie &movie,
+    std::size_t frameIndex,
+    QImage::Format format /* = QImage::Format_Invalid */
+  ) {
+    Key key { frameIndex, format };
+
+    // Check if the image is in the cache already. If the cache still holds frames
+    // from another movie, throw those out since their indices mean nothing anymore.
+    {
+      std::unique_lock<std::mutex> cacheLock(this->mutex);
+      if(this->frameDirectory != movie.FrameDirectory) {
+        this->entries.clear();
+        this->entryLookup.clear();
+        this->usedBytes = 0;
+        this->frameDirectory = movie.FrameDirectory;
+      }
+
+      QImage image;
+      if(tryGet(key, image)) {
+        ++this->hitCount;
+        return image;
+      }
+
+      ++this->missCount;
+    }
+
+    // The image was not cached, so decode it. This happens without holding the lock
+    // so that other threads can use the cache while we're waiting on disk and decoder.
+    QImage image;
+    std::uint64_t fileSize = 0;
+    if(format == QImage::Format_Invalid) {
+      fileSize = movie.GetEncodedFrameSize(frameIndex);
+      image = movie.LoadFrame(frameIndex);
+    } else {
+      image = GetFrame(movie, frameIndex).convertToFormat(format);
+    }
+
+    {
+      std::unique_lock<std::mutex> cacheLock(this->mutex);
+      this->readByteCount += fileSize;
+      if(this->frameDirectory == movie.FrameDirectory) {
+        insert(key, image);
+      }
+    }
+
+    return image;
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  void FrameCache::Clear() {
+    std::unique_lock<std::mutex> cacheLock(this->mutex);
+    this->entries.clear();
+    this->entryLookup.clear();
+    this->usedBytes = 0;
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  std::uint64_t FrameCache::GetHitCount() const {
+    std::unique_lock<std::mutex> cacheLock(this->mutex);
+    return this->hitCount;
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  std::uint64_t FrameCache::GetMissCount() const {
+    std::unique_lock<std::mutex> cacheLock(this->mutex);
+    return this->missCount;
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  std::uint64_t FrameCache::GetReadByteCount() const {
+    std::unique_lock<std::mutex> cacheLock(this->mutex);
+    return this->readByteCount;
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  double FrameCache::GetHitRate() const {
+    std::unique_lock<std::mutex> cacheLock(this->mutex);
+
+    std::uint64_t requestCount = this->hitCount + this->missCount;
+    if(requestCount == 0) {
+      return 0.0;
+    } else {
+      return static_cast<double>(this->hitCount) / static_cast<double>(requestCount);
+    }
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  bool FrameCache::tryGet(const Key &key, QImage &image) {
+    auto iterator = this->entryLookup.find(key);
+    if(iterator == this->entryLookup.end()) {
+      return false;
+    }
+
+    // Move the entry to the front of the list, making it the most recently used one
+    this->entries.splice(this->entries.begin(), this->entries, iterator->second);
+    image = iterator->second->Image;
+    return true;
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  void FrameCache::insert(const Key &key, const QImage &image) {
+    if(image.isNull()) {
+      return; // Don't cache failed loads, the file may appear later
+    }
+
+    // Another thread may have decoded the same frame in the meantime
+    auto iterator = this->entryLookup.find(key);
+    if(iterator != this->entryLookup.end()) {
+      this->usedBytes -= static_cast<std::size_t>(iterator->second->Image.sizeInBytes());
+      this->entries.erase(iterator->second);
+      this->entryLookup.erase(iterator);
+    }
+
+    // If the render pipeline needs the memory, make room by evicting older images,
+    // but don't go as far as blocking the thread that wants to cache the image
+    std::size_t imageByteCount = static_cast<std::size_t>(image.sizeInBytes());
+    Rendering::FrameMemoryBudget::Reservation memoryReservation;
+    if(static_cast<bool>(this->memoryBudget)) {
+      while(!this->memoryBudget->TryAcquire(imageByteCount, memoryReservation)) {
+        if(this->entries.empty()) {
+          return;
+        }
+
+        evictLeastRecentlyUsed();
+      }
+    }
+
+    Entry &entry = this->entries.emplace_front();
+    entry.FrameKey = key;
+    entry.Image = image;
+    entry.MemoryReservation = std::move(memoryReservation);
+    this->entryLookup.emplace(key, this->entries.begin());
+    this->usedBytes += imageByteCount;
+
+    evictToCapacity();
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  void FrameCache::evictToCapacity() {
+    while((this->usedBytes > this->capacityInBytes) && !this->entries.empty()) {
+      evictLeastRecentlyUsed();
+    }
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  void FrameCache::evictLeastRecentlyUsed() {
+    const Entry &leastRecentlyUsed = this->entries.back();
+    this->usedBytes -= static_cast<std::size_t>(leastRecentlyUsed.Image.sizeInBytes());
+    this->entryLookup.erase(leastRecentlyUsed.FrameKey);
+    this->entries.pop_back();
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+} // namespace Nuclex::FrameFixer::Services
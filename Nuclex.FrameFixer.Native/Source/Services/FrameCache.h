@@ -0,0 +1,215 @@
+#pragma region Apache License 2.0
+/*
+Nuclex Frame Fixer
+Copyright (C) 2024 Markus Ewald / Nuclex Development Labs
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#pragma endregion // Apache License 2.0
+
+#ifndef NUCLEX_FRAMEFIXER_SERVICES_FRAMECACHE_H
+#define NUCLEX_FRAMEFIXER_SERVICES_FRAMECACHE_H
+
+#include "Nuclex/FrameFixer/Config.h"
+#include "../Rendering/FrameMemoryBudget.h"
+
+#include <cstddef> // for std::size_t
+#include <cstdint> // for std::uint64_t
+#include <string> // for std::string
+#include <list> // for std::list
+#include <memory> // for std::shared_ptr
+#include <unordered_map> // for std::unordered_map
+#include <mutex> // for std::mutex
+
+#include <QImage>
+
+namespace Nuclex::FrameFixer {
+
+  // ------------------------------------------------------------------------------------------- //
+
+  class Movie;
+
+  // ------------------------------------------------------------------------------------------- //
+
+}
+
+namespace Nuclex::FrameFixer::Services {
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Keeps recently decoded frames in memory so they don't get decoded again</summary>
+  /// <remarks>
+  ///   <para>
+  ///     The same input frame is often needed several times in short succession: as next
+  ///     frame for the deinterlacer and then as the current frame, as the replacement or
+  ///     interpolation source of other frames, when previewing the frame before an inserted
+  ///     interpolated frame or when the user clicks back and forth between frames in the UI.
+  ///     All of these go through this cache, so a frame is only decoded once as long
+  ///     as it stays in memory.
+  ///   </para>
+  ///   <para>
+  ///     Frames are identified by their index and the pixel format they were requested in.
+  ///     The cache is limited by the number of bytes all cached images occupy and evicts
+  ///     the least recently used images when it is full. The cache is bound to one movie
+  ///     at a time and clears itself if frames of a different movie are requested.
+  ///   </para>
+  ///   <para>
+  ///     All methods are thread-safe. Images are returned as implicitly shared QImages,
+  ///     so modifying a returned image makes Qt detach it and leaves the cache untouched.
+  ///   </para>
+  /// </remarks>
+  class FrameCache {
+
+    /// <summary>Initializes a new frame cache</summary>
+    /// <param name="capacityInBytes">Number of bytes the cached images may occupy</param>
+    public: FrameCache(std::size_t capacityInBytes = DefaultCapacityInBytes);
+    /// <summary>Frees all resources owned by the frame cache</summary>
+    public: ~FrameCache();
+
+    /// <summary>Number of bytes the cache is allowed to occupy by default</summary>
+    public: static const std::size_t DefaultCapacityInBytes;
+
+    /// <summary>Changes the number of bytes the cached images may occupy</summary>
+    /// <param name="capacityInBytes">Number of bytes the cached images may occupy</param>
+    public: void SetCapacity(std::size_t capacityInBytes);
+
+    /// <summary>Selects a budget the cached images are counted against</summary>
+    /// <param name="memoryBudget">Budget shared with the render pipeline, can be empty</param>
+    /// <remarks>
+    ///   In addition to its own capacity, the cache then gives way to the render pipeline:
+    ///   if a newly decoded image does not fit into the budget, the least recently used
+    ///   images are evicted until it does. If the cache is empty and the image still
+    ///   does not fit, it is returned without being cached. Images that are already
+    ///   cached keep being counted against the budget they were cached under.
+    /// </remarks>
+    public: void SetMemoryBudget(const std::shared_ptr<Rendering::FrameMemoryBudget> &memoryBudget);
+
+    /// <summary>Provides the image of a frame, decoding it if it is not cached</summary>
+    /// <param name="movie">Movie whose frame will be provided</param>
+    /// <param name="frameIndex">Index of the frame that will be provided</param>
+    /// <param name="format">
+    ///   Pixel format the image should be in. If Format_Invalid is specified, the image
+    ///   will be provided in the format the image file was decoded to.
+    /// </param>
+    /// <returns>The image of the requested frame</returns>
+    public: QImage GetFrame(
+      const Movie &movie,
+      std::size_t frameIndex,
+      QImage::Format format = QImage::Format_Invalid
+    );
+
+    /// <summary>Drops all images that are currently in the cache</summary>
+    public: void Clear();
+
+    /// <summary>Counts how many requests could be served from the cache</summary>
+    /// <returns>The number of requests that were served from the cache</returns>
+    public: std::uint64_t GetHitCount() const;
+
+    /// <summary>Counts how many requests needed to decode the frame</summary>
+    /// <returns>The number of requests that could not be served from the cache</returns>
+    public: std::uint64_t GetMissCount() const;
+
+    /// <summary>Counts the bytes of all image files the cache has loaded</summary>
+    /// <returns>The total size of the files that were loaded from disk</returns>
+    public: std::uint64_t GetReadByteCount() const;
+
+    /// <summary>Calculates the ratio of requests that were served from the cache</summary>
+    /// <returns>The hit rate in a range from 0.0 (all misses) to 1.0 (all hits)</returns>
+    public: double GetHitRate() const;
+
+    /// <summary>Identifies a frame in a specific pixel format</summary>
+    private: struct Key {
+
+      /// <summary>Index of the frame in the movie</summary>
+      public: std::size_t FrameIndex;
+      /// <summary>Pixel format of the cached image</summary>
+      public: QImage::Format Format;
+
+      /// <summary>Checks whether this key is equal to another key</summary>
+      /// <param name="other">Other key that will be compared against this one</param>
+      /// <returns>True if both keys identify the same image</returns>
+      public: bool operator ==(const Key &other) const {
+        return (this->FrameIndex == other.FrameIndex) && (this->Format == other.Format);
+      }
+
+    };
+
+    /// <summary>Calculates hash codes for cache keys</summary>
+    private: struct KeyHash {
+
+      /// <summary>Calculates the hash code of the specified key</summary>
+      /// <param name="key">Key whose hash code will be calculated</param>
+      /// <returns>The hash code of the specified key</returns>
+      public: std::size_t operator()(const Key &key) const {
+        return (key.FrameIndex << 6) ^ static_cast<std::size_t>(key.Format);
+      }
+
+    };
+
+    /// <summary>Image stored in the cache together with its key</summary>
+    private: struct Entry {
+
+      /// <summary>Frame index and pixel format the image is stored under</summary>
+      public: Key FrameKey;
+      /// <summary>Image that is being cached</summary>
+      public: QImage Image;
+      /// <summary>Memory reserved for the image, empty without a budget</summary>
+      public: Rendering::FrameMemoryBudget::Reservation MemoryReservation;
+
+    };
+
+    /// <summary>Looks up an image in the cache and marks it as recently used</summary>
+    /// <param name="key">Key of the image that will be looked up</param>
+    /// <param name="image">Receives the image if it was found</param>
+    /// <returns>True if the image was found in the cache</returns>
+    private: bool tryGet(const Key &key, QImage &image);
+
+    /// <summary>Adds an image to the cache, evicting older images if needed</summary>
+    /// <param name="key">Key under which the image will be stored</param>
+    /// <param name="image">Image that will be stored</param>
+    private: void insert(const Key &key, const QImage &image);
+
+    /// <summary>Evicts the least recently used images until the cache is within budget</summary>
+    private: void evictToCapacity();
+
+    /// <summary>Evicts the least recently used image, the cache must not be empty</summary>
+    private: void evictLeastRecentlyUsed();
+
+    /// <summary>Must be held while accessing the cache's state</summary>
+    private: mutable std::mutex mutex;
+    /// <summary>Directory of the movie whose frames are currently cached</summary>
+    private: std::string frameDirectory;
+    /// <summary>Cached images, ordered from most recently to least recently used</summary>
+    private: std::list<Entry> entries;
+    /// <summary>Looks up the position of a cached image in the entry list</summary>
+    private: std::unordered_map<Key, std::list<Entry>::iterator, KeyHash> entryLookup;
+    /// <summary>Budget the cached images are counted against, can be empty</summary>
+    private: std::shared_ptr<Rendering::FrameMemoryBudget> memoryBudget;
+    /// <summary>Number of bytes the cache is allowed to occupy</summary>
+    private: std::size_t capacityInBytes;
+    /// <summary>Number of bytes currently occupied by cached images</summary>
+    private: std::size_t usedBytes;
+    /// <summary>Number of requests that were served from the cache</summary>
+    private: std::uint64_t hitCount;
+    /// <summary>Number of requests that required decoding the frame</summary>
+    private: std::uint64_t missCount;
+    /// <summary>Total size of the image files that were loaded from disk</summary>
+    private: std::uint64_t readByteCount;
+
+  };
+
+  // ------------------------------------------------------------------------------------------- //
+
+} // namespace Nuclex::FrameFixer::Services
+
+#endif // NUCLEX_FRAMEFIXER_SERVICES_FRAMECACHE_H
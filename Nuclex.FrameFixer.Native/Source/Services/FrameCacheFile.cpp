@@ -0,0 +1,403 @@
+#pragma region Apache License 2.0
+/*
+Nuclex Frame Fixer
+Copyright (C) 2024 Markus Ewald / Nuclex Development Labs
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#pragma endregion // Apache License 2.0
+
+// If the application is compiled as a DLL, this ensures symbols are exported
+#define NUCLEX_FRAMEFIXER_SOURCE 1
+
+#include "./FrameCacheFile.h"
+
+#include <QFile>
+
+#include <stdexcept> // for std::runtime_error
+#include <algorithm> // for std::copy_n()
+#include <atomic> // for std::atomic_thread_fence()
+#include <cstring> // for std::memcmp(), std::memcpy()
+
+#if defined(NUCLEX_FRAMEFIXER_WINDOWS)
+  #define WIN32_LEAN_AND_MEAN
+  #define NOMINMAX
+  #include <windows.h> // for ::DeviceIoControl()
+  #include <winioctl.h> // for FSCTL_SET_SPARSE
+  #include <io.h> // for ::_get_osfhandle()
+#endif
+
+namespace {
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Identifies a frame cache file</summary>
+  const char FileSignature[8] = { 'N', 'X', 'F', 'F', 'C', 'A', 'C', 'H' };
+
+  /// <summary>Version of the file layout, increased whenever it changes</summary>
+  const std::uint32_t FileVersion = 2;
+
+  /// <summary>Offset of the stamp table from the start of the file</summary>
+  const std::size_t StampTableOffset = 64;
+
+  /// <summary>Number of bytes each frame takes up in the stamp and format tables</summary>
+  const std::size_t TableBytesPerFrame = sizeof(std::uint64_t) + sizeof(std::uint32_t);
+
+  /// <summary>Alignment of each row of pixels, enough for any SIMD instruction set</summary>
+  const std::size_t RowAlignment = 64;
+
+  /// <summary>Alignment of each frame, matching the page size of common systems</summary>
+  const std::size_t FrameAlignment = 4096;
+
+  /// <summary>Number of bytes per pixel in QImage::Format_RGBA64</summary>
+  const std::size_t BytesPerPixel = 8;
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Header at the start of each frame cache file</summary>
+  struct FileHeader {
+
+    /// <summary>Must contain the file signature</summary>
+    public: char Signature[8];
+    /// <summary>Version of the file layout</summary>
+    public: std::uint32_t Version;
+    /// <summary>Width of the stored frames in pixels</summary>
+    public: std::uint32_t Width;
+    /// <summary>Height of the stored frames in pixels</summary>
+    public: std::uint32_t Height;
+    /// <summary>Number of bytes from the start of one row to the start of the next</summary>
+    public: std::uint32_t BytesPerLine;
+    /// <summary>Number of frames the file has room for</summary>
+    public: std::uint64_t FrameCount;
+    /// <summary>Number of bytes from the start of one frame to the start of the next</summary>
+    public: std::uint64_t FrameByteCount;
+    /// <summary>Offset of the first frame from the start of the file</summary>
+    public: std::uint64_t FirstFrameOffset;
+
+  };
+
+  static_assert(sizeof(FileHeader) <= StampTableOffset, "Header must fit before stamp table");
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Rounds a number up to the next multiple of the specified alignment</summary>
+  /// <param name="value">Value that will be rounded up</param>
+  /// <param name="alignment">Alignment the value will be rounded to</param>
+  /// <returns>The smallest multiple of the alignment that is not less than the value</returns>
+  std::size_t alignUp(std::size_t value, std::size_t alignment) {
+    return (value + alignment - 1) / alignment * alignment;
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Determines the format a stored frame will be handed out in</summary>
+  /// <param name="sourceFormat">Format the frame had when it was stored</param>
+  /// <returns>The format that reproduces the stored frame's pixels exactly</returns>
+  /// <remarks>
+  ///   Palette and monochrome images would have to be quantized again, so those are
+  ///   handed out with 8 bit channels, which is what the renderer turns them into anyway.
+  /// </remarks>
+  QImage::Format getRestoredFormat(QImage::Format sourceFormat) {
+    switch(sourceFormat) {
+      case QImage::Format_Invalid:
+      case QImage::Format_Mono:
+      case QImage::Format_MonoLSB:
+      case QImage::Format_Indexed8: { return QImage::Format_ARGB32; }
+      default: { return sourceFormat; }
+    }
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+} // anonymous namespace
+
+namespace Nuclex::FrameFixer::Services {
+
+  // ------------------------------------------------------------------------------------------- //
+
+  FrameCacheFile::FrameCacheFile(const std::string &path, std::size_t frameCount) :
+    path(path),
+    frameCount(frameCount),
+    mutex(),
+    file(),
+    mappedMemory(nullptr),
+    sourceStamps(nullptr),
+    sourceFormats(nullptr),
+    width(0),
+    height(0),
+    bytesPerLine(0),
+    frameByteCount(0),
+    firstFrameOffset(0) {
+    openExisting();
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  FrameCacheFile::~FrameCacheFile() {
+    if(static_cast<bool>(this->file)) {
+      if(this->mappedMemory != nullptr) {
+        this->file->unmap(this->mappedMemory);
+      }
+      this->file->close();
+    }
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  std::size_t FrameCacheFile::CountStoredFrames() const {
+    std::unique_lock<std::mutex> fileLock(this->mutex);
+    if(this->sourceStamps == nullptr) {
+      return 0;
+    }
+
+    std::size_t storedFrameCount = 0;
+    for(std::size_t index = 0; index < this->frameCount; ++index) {
+      if(this->sourceStamps[index] != 0) {
+        ++storedFrameCount;
+      }
+    }
+
+    return storedFrameCount;
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  bool FrameCacheFile::TryGetFrame(
+    std::size_t frameIndex, std::uint64_t sourceStamp, QImage &image
+  ) const {
+    if(frameIndex >= this->frameCount) {
+      return false;
+    }
+
+    const unsigned char *frameMemory;
+    QImage::Format format;
+    {
+      std::unique_lock<std::mutex> fileLock(this->mutex);
+      if(this->sourceStamps == nullptr) {
+        return false;
+      }
+      if(this->sourceStamps[frameIndex] != sourceStamp) {
+        return false;
+      }
+
+      frameMemory = (
+        this->mappedMemory + this->firstFrameOffset + (frameIndex * this->frameByteCount)
+      );
+      format = getRestoredFormat(static_cast<QImage::Format>(this->sourceFormats[frameIndex]));
+    }
+
+    // RGBX64 only differs from RGBA64 in that its alpha channel is always opaque,
+    // so frames in either format can be handed out as they are stored
+    QImage::Format viewFormat = QImage::Format_RGBA64;
+    if(format == QImage::Format_RGBX64) {
+      viewFormat = QImage::Format_RGBX64;
+    }
+
+    // The image points straight into the mapped file. It holds a reference to this
+    // instance that is released by Qt when the last copy of the image is destroyed.
+    image = QImage(
+      frameMemory,
+      this->width,
+      this->height,
+      static_cast<qsizetype>(this->bytesPerLine),
+      viewFormat,
+      &FrameCacheFile::releaseFrameView,
+      new std::shared_ptr<const FrameCacheFile>(shared_from_this())
+    );
+
+    // Frames from sources in other formats are converted back, so a frame comes out
+    // the same whether it was just decoded or read from the file. Going from 8 to
+    // 16 bits and back is lossless.
+    if(format != viewFormat) {
+      image = image.convertToFormat(format);
+    }
+
+    return true;
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  bool FrameCacheFile::StoreFrame(
+    std::size_t frameIndex, std::uint64_t sourceStamp, const QImage &image
+  ) {
+    if((frameIndex >= this->frameCount) || image.isNull() || (sourceStamp == 0)) {
+      return false;
+    }
+
+    unsigned char *frameMemory;
+    {
+      std::unique_lock<std::mutex> fileLock(this->mutex);
+      if(this->mappedMemory == nullptr) {
+        create(image.width(), image.height());
+      } else if((image.width() != this->width) || (image.height() != this->height)) {
+        return false;
+      }
+
+      // Clear the stamp while the pixels are being written, so a crash or another
+      // thread never sees a frame that is only half there
+      this->sourceStamps[frameIndex] = 0;
+      frameMemory = (
+        this->mappedMemory + this->firstFrameOffset + (frameIndex * this->frameByteCount)
+      );
+    }
+
+    QImage convertedImage;
+    const QImage *sourceImage = &image;
+    if(image.format() != QImage::Format_RGBA64) {
+      convertedImage = image.convertToFormat(QImage::Format_RGBA64);
+      sourceImage = &convertedImage;
+    }
+
+    std::size_t lineLength = static_cast<std::size_t>(this->width) * BytesPerPixel;
+    for(int lineIndex = 0; lineIndex < this->height; ++lineIndex) {
+      std::copy_n(sourceImage->constScanLine(lineIndex), lineLength, frameMemory);
+      frameMemory += this->bytesPerLine;
+    }
+
+    std::atomic_thread_fence(std::memory_order_release);
+    {
+      std::unique_lock<std::mutex> fileLock(this->mutex);
+      this->sourceFormats[frameIndex] = static_cast<std::uint32_t>(image.format());
+      this->sourceStamps[frameIndex] = sourceStamp;
+    }
+
+    return true;
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  bool FrameCacheFile::openExisting() {
+    std::unique_ptr<QFile> existingFile = std::make_unique<QFile>(
+      QString::fromStdString(this->path)
+    );
+    if(!existingFile->exists()) {
+      return false;
+    }
+    if(!existingFile->open(QIODevice::OpenModeFlag::ReadWrite)) {
+      return false;
+    }
+
+    // Only use the file if it was written for the same movie layout. Otherwise,
+    // it will be overwritten as soon as the first frame is stored.
+    FileHeader header;
+    qint64 readByteCount = existingFile->read(reinterpret_cast<char *>(&header), sizeof(header));
+    if(readByteCount != static_cast<qint64>(sizeof(header))) {
+      return false;
+    }
+    bool isUsable = (
+      (std::memcmp(header.Signature, FileSignature, sizeof(FileSignature)) == 0) &&
+      (header.Version == FileVersion) &&
+      (header.FrameCount == this->frameCount) &&
+      (header.Width > 0) &&
+      (header.Height > 0) &&
+      (header.BytesPerLine >= header.Width * BytesPerPixel) &&
+      (header.FrameByteCount >= std::uint64_t(header.BytesPerLine) * header.Height) &&
+      (header.FirstFrameOffset >= StampTableOffset + this->frameCount * TableBytesPerFrame)
+    );
+    std::uint64_t expectedSize = (
+      header.FirstFrameOffset + header.FrameCount * header.FrameByteCount
+    );
+    if(!isUsable || (static_cast<std::uint64_t>(existingFile->size()) != expectedSize)) {
+      return false;
+    }
+
+    unsigned char *memory = existingFile->map(0, existingFile->size());
+    if(memory == nullptr) {
+      return false;
+    }
+
+    this->width = static_cast<int>(header.Width);
+    this->height = static_cast<int>(header.Height);
+    this->bytesPerLine = static_cast<std::size_t>(header.BytesPerLine);
+    this->frameByteCount = static_cast<std::size_t>(header.FrameByteCount);
+    this->firstFrameOffset = static_cast<std::size_t>(header.FirstFrameOffset);
+    this->mappedMemory = memory;
+    this->sourceStamps = reinterpret_cast<std::uint64_t *>(memory + StampTableOffset);
+    this->sourceFormats = reinterpret_cast<std::uint32_t *>(
+      this->sourceStamps + this->frameCount
+    );
+    this->file = std::move(existingFile);
+    return true;
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  void FrameCacheFile::create(int width, int height) {
+    this->width = width;
+    this->height = height;
+    this->bytesPerLine = alignUp(static_cast<std::size_t>(width) * BytesPerPixel, RowAlignment);
+    this->frameByteCount = alignUp(
+      this->bytesPerLine * static_cast<std::size_t>(height), FrameAlignment
+    );
+    this->firstFrameOffset = alignUp(
+      StampTableOffset + this->frameCount * TableBytesPerFrame, FrameAlignment
+    );
+
+    this->file = std::make_unique<QFile>(QString::fromStdString(this->path));
+    if(!this->file->open(QIODevice::OpenModeFlag::ReadWrite)) {
+      throw std::runtime_error(u8"Could not create frame cache file " + this->path);
+    }
+
+    // Truncating the file first clears all stamps. The file is extended without writing
+    // to it, which leaves a sparse file on Linux file systems, taking up only the space of
+    // the frames stored so far. NTFS files are not sparse unless marked as such, otherwise
+    // Windows would allocate the whole file up front. If the file system has no sparse
+    // files (FAT32, exFAT), the marking fails and the space is allocated after all.
+#if defined(NUCLEX_FRAMEFIXER_WINDOWS)
+    {
+      ::HANDLE fileHandle = reinterpret_cast<::HANDLE>(::_get_osfhandle(this->file->handle()));
+      if(fileHandle != INVALID_HANDLE_VALUE) {
+        ::DWORD returnedByteCount = 0;
+        ::DeviceIoControl(
+          fileHandle, FSCTL_SET_SPARSE, nullptr, 0, nullptr, 0, &returnedByteCount, nullptr
+        );
+      }
+    }
+#endif
+    qint64 fileSize = static_cast<qint64>(
+      this->firstFrameOffset + this->frameCount * this->frameByteCount
+    );
+    if(!this->file->resize(0) || !this->file->resize(fileSize)) {
+      throw std::runtime_error(u8"Could not allocate space for frame cache file " + this->path);
+    }
+
+    this->mappedMemory = this->file->map(0, fileSize);
+    if(this->mappedMemory == nullptr) {
+      throw std::runtime_error(u8"Could not map frame cache file " + this->path);
+    }
+    this->sourceStamps = reinterpret_cast<std::uint64_t *>(this->mappedMemory + StampTableOffset);
+    this->sourceFormats = reinterpret_cast<std::uint32_t *>(
+      this->sourceStamps + this->frameCount
+    );
+
+    FileHeader header;
+    std::memcpy(header.Signature, FileSignature, sizeof(FileSignature));
+    header.Version = FileVersion;
+    header.Width = static_cast<std::uint32_t>(width);
+    header.Height = static_cast<std::uint32_t>(height);
+    header.BytesPerLine = static_cast<std::uint32_t>(this->bytesPerLine);
+    header.FrameCount = static_cast<std::uint64_t>(this->frameCount);
+    header.FrameByteCount = static_cast<std::uint64_t>(this->frameByteCount);
+    header.FirstFrameOffset = static_cast<std::uint64_t>(this->firstFrameOffset);
+    std::memcpy(this->mappedMemory, &header, sizeof(header));
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  void FrameCacheFile::releaseFrameView(void *fileReference) {
+    delete reinterpret_cast<std::shared_ptr<const FrameCacheFile> *>(fileReference);
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+} // namespace Nuclex::FrameFixer::Services
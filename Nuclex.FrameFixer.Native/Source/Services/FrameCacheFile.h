@@ -0,0 +1,150 @@
+#pragma region Apache License 2.0
+/*
+Nuclex Frame Fixer
+Copyright (C) 2024 Markus Ewald / Nuclex Development Labs
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#pragma endregion // Apache License 2.0
+
+#ifndef NUCLEX_FRAMEFIXER_SERVICES_FRAMECACHEFILE_H
+#define NUCLEX_FRAMEFIXER_SERVICES_FRAMECACHEFILE_H
+
+#include "Nuclex/FrameFixer/Config.h"
+
+#include <cstddef> // for std::size_t
+#include <cstdint> // for std::uint64_t
+#include <string> // for std::string
+#include <memory> // for std::shared_ptr, std::unique_ptr, std::enable_shared_from_this
+#include <mutex> // for std::mutex
+
+#include <QImage>
+
+class QFile;
+
+namespace Nuclex::FrameFixer::Services {
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Memory-mapped file that stores decoded frames for fast random access</summary>
+  /// <remarks>
+  ///   <para>
+  ///     Loading a frame from a PNG file means a full zlib decode, and decoding a frame of
+  ///     a video means seeking and decoding a whole group of pictures. This file stores each
+  ///     frame after its first decode, so all later accesses (scrubbing in the user interface,
+  ///     repeated renders of the same project) merely read pages from the disk.
+  ///   </para>
+  ///   <para>
+  ///     The file starts with a header and a table holding a stamp for each frame that
+  ///     identifies the state of the frame's source (zero if the frame has not been stored),
+  ///     followed by a table of the QImage formats the frames were stored from. All frames
+  ///     follow in QImage::Format_RGBA64 with a fixed stride, so the position of any frame
+  ///     is known without a lookup. Rows are padded to 64 bytes and frames to whole pages.
+  ///     The file is created when the first frame is stored, since only then are
+  ///     the dimensions of the frames known.
+  ///   </para>
+  ///   <para>
+  ///     Frames are returned in the format they were stored from, so they look the same
+  ///     whether they come from the file or from their source. Frames with 16 bit channels
+  ///     are QImages that point directly into the mapped file, so reading them neither
+  ///     decodes nor copies. They keep the file mapped until they are destroyed, modifying
+  ///     one makes Qt detach it. Frames with 8 bit channels are converted back into a new
+  ///     image. All methods are thread-safe. Create instances through std::make_shared()
+  ///     since the images keep the file alive.
+  ///   </para>
+  /// </remarks>
+  class FrameCacheFile : public std::enable_shared_from_this<FrameCacheFile> {
+
+    /// <summary>Opens or prepares a frame cache file</summary>
+    /// <param name="path">Path of the frame cache file</param>
+    /// <param name="frameCount">Number of frames in the movie</param>
+    /// <remarks>
+    ///   If the file exists but was written for a different number of frames, it will
+    ///   be discarded and created anew when the first frame is stored.
+    /// </remarks>
+    public: FrameCacheFile(const std::string &path, std::size_t frameCount);
+    /// <summary>Unmaps and closes the frame cache file</summary>
+    public: ~FrameCacheFile();
+
+    /// <summary>Counts the frames that have been stored in the file</summary>
+    /// <returns>The number of frames that can be read from the file</returns>
+    public: std::size_t CountStoredFrames() const;
+
+    /// <summary>Tries to fetch a frame from the file</summary>
+    /// <param name="frameIndex">Index of the frame that will be fetched</param>
+    /// <param name="sourceStamp">Stamp identifying the current state of the frame's source</param>
+    /// <param name="image">
+    ///   Receives the frame in the format it was stored from, pointing into the file
+    ///   if that format has 16 bit channels
+    /// </param>
+    /// <returns>
+    ///   True if the frame was stored in the file and its source has not changed since
+    /// </returns>
+    public: bool TryGetFrame(
+      std::size_t frameIndex, std::uint64_t sourceStamp, QImage &image
+    ) const;
+
+    /// <summary>Stores a decoded frame in the file</summary>
+    /// <param name="frameIndex">Index of the frame that will be stored</param>
+    /// <param name="sourceStamp">Stamp identifying the current state of the frame's source</param>
+    /// <param name="image">Decoded image of the frame</param>
+    /// <returns>
+    ///   True if the frame was stored, false if its dimensions do not match the file
+    /// </returns>
+    public: bool StoreFrame(std::size_t frameIndex, std::uint64_t sourceStamp, const QImage &image);
+
+    /// <summary>Checks the existing file and maps it into memory if it is usable</summary>
+    /// <returns>True if the file existed and has been mapped</returns>
+    private: bool openExisting();
+
+    /// <summary>Creates the file for frames of the specified dimensions and maps it</summary>
+    /// <param name="width">Width of the frames in pixels</param>
+    /// <param name="height">Height of the frames in pixels</param>
+    private: void create(int width, int height);
+
+    /// <summary>Called by Qt when an image pointing into the file is destroyed</summary>
+    /// <param name="fileReference">Heap-allocated shared pointer keeping the file alive</param>
+    private: static void releaseFrameView(void *fileReference);
+
+    /// <summary>Path of the frame cache file</summary>
+    private: std::string path;
+    /// <summary>Number of frames the file has room for</summary>
+    private: std::size_t frameCount;
+    /// <summary>Must be held while accessing the stamp table or creating the file</summary>
+    private: mutable std::mutex mutex;
+    /// <summary>The opened frame cache file, if it has been opened or created</summary>
+    private: std::unique_ptr<QFile> file;
+    /// <summary>Start of the memory the file has been mapped to</summary>
+    private: unsigned char *mappedMemory;
+    /// <summary>Stamps identifying the source state of each stored frame</summary>
+    private: std::uint64_t *sourceStamps;
+    /// <summary>QImage formats the stored frames had before they were stored</summary>
+    private: std::uint32_t *sourceFormats;
+    /// <summary>Width of the stored frames in pixels</summary>
+    private: int width;
+    /// <summary>Height of the stored frames in pixels</summary>
+    private: int height;
+    /// <summary>Number of bytes from the start of one row to the start of the next</summary>
+    private: std::size_t bytesPerLine;
+    /// <summary>Number of bytes from the start of one frame to the start of the next</summary>
+    private: std::size_t frameByteCount;
+    /// <summary>Offset of the first frame from the start of the file</summary>
+    private: std::size_t firstFrameOffset;
+
+  };
+
+  // ------------------------------------------------------------------------------------------- //
+
+} // namespace Nuclex::FrameFixer::Services
+
+#endif // NUCLEX_FRAMEFIXER_SERVICES_FRAMECACHEFILE_H
@@ -23,6 +23,7 @@ limitations under the License.
 #include "./ServicesRoot.h"
 #include "./DeinterlacerRepository.h"
 #include "./InterpolatorRepository.h"
+#include "./FrameCache.h"
 
 #include <string> // for std::string
 
@@ -46,7 +47,8 @@ namespace Nuclex::FrameFixer::Services {
 
   ServicesRoot::ServicesRoot() :
     deinterlacers(std::make_shared<DeinterlacerRepository>()),
-    interpolators(std::make_shared<InterpolatorRepository>()) {}
+    interpolators(std::make_shared<InterpolatorRepository>()),
+    decodedFrames(std::make_shared<FrameCache>()) {}
 
   // ------------------------------------------------------------------------------------------- //
 
@@ -30,6 +30,7 @@ namespace Nuclex::FrameFixer::Services {
 
   class DeinterlacerRepository;
   class InterpolatorRepository;
+  class FrameCache;
 
   // ------------------------------------------------------------------------------------------- //
 
@@ -61,10 +62,18 @@ namespace Nuclex::FrameFixer::Services {
       return this->interpolators;
     }
 
+    /// <summary>Accesses the cache holding recently decoded input frames</summary>
+    /// <returns>The application's decoded frame cache</returns>
+    public: const std::shared_ptr<FrameCache> &DecodedFrames() const {
+      return this->decodedFrames;
+    }
+
     /// <summary>Manages the deinterlacers available for use by the application<?summary>
     private: std::shared_ptr<DeinterlacerRepository> deinterlacers;
     /// <summary>Manages the interpolators available for use by the application</summary>
     private: std::shared_ptr<InterpolatorRepository> interpolators;
+    /// <summary>Keeps recently decoded input frames around for reuse</summary>
+    private: std::shared_ptr<FrameCache> decodedFrames;
 
   };
 
@@ -0,0 +1,466 @@
+#pragma region Apache License 2.0
+/*
+Nuclex Frame Fixer
+Copyright (C) 2024 Markus Ewald / Nuclex Development Labs
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#pragma endregion // Apache License 2.0
+
+// If the application is compiled as a DLL, this ensures symbols are exported
+#define NUCLEX_FRAMEFIXER_SOURCE 1
+
+#include "../../Source/Algorithm/Averager.h"
+#include "../../Source/Rendering/FrameBuffer.h"
+#include "../../Source/Platform/CpuFeatures.h"
+
+#include <algorithm> // for std::sort(), std::copy_n()
+#include <cmath> // for std::lrint()
+#include <cstdint> // for std::uint8_t, std::uint16_t, std::uint32_t
+#include <stdexcept> // for std::invalid_argument
+#include <vector> // for std::vector
+
+#include <gtest/gtest.h>
+
+namespace {
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Enables or disables AVX2 and restores the default when going out of scope</summary>
+  class Avx2Scope {
+
+    /// <summary>Switches the AVX2 code paths on or off</summary>
+    /// <param name="enabled">Whether the AVX2 code paths may be used</param>
+    public: Avx2Scope(bool enabled) {
+      Nuclex::FrameFixer::Platform::CpuFeatures::SetAvx2Enabled(enabled);
+    }
+
+    /// <summary>Switches the AVX2 code paths back on</summary>
+    public: ~Avx2Scope() {
+      Nuclex::FrameFixer::Platform::CpuFeatures::SetAvx2Enabled(true);
+    }
+
+  };
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Fills a frame with noise, dropouts and sparkles</summary>
+  /// <param name="frame">Frame that will be filled</param>
+  /// <param name="seed">Value from which the noise is derived</param>
+  void fillWithNoise(Nuclex::FrameFixer::Rendering::FrameBuffer &frame, std::uint32_t seed) {
+    bool sixteenBitChannels = frame.HasSixteenBitChannels();
+    std::size_t valueCount = frame.GetRowLength() / (sixteenBitChannels ? 2 : 1);
+    std::uint32_t maximum = sixteenBitChannels ? 65535 : 255;
+
+    for(std::size_t planeIndex = 0; planeIndex < frame.GetPlaneCount(); ++planeIndex) {
+      for(int lineIndex = 0; lineIndex < frame.GetHeight(); ++lineIndex) {
+        std::uint8_t *row = frame.GetRow(lineIndex, planeIndex);
+        for(std::size_t index = 0; index < valueCount; ++index) {
+          seed = seed * 1664525U + 1013904223U;
+
+          // Mostly values from a narrow band so there are plenty of ties,
+          // with the occasional black dropout or white sparkle
+          std::uint32_t value;
+          switch((seed >> 28) & 7) {
+            case 0: { value = 0; break; }
+            case 1: { value = maximum; break; }
+            default: { value = (maximum / 4) + ((seed >> 8) % (maximum / 2)); break; }
+          }
+
+          if(sixteenBitChannels) {
+            reinterpret_cast<std::uint16_t *>(row)[index] = static_cast<std::uint16_t>(value);
+          } else {
+            row[index] = static_cast<std::uint8_t>(value);
+          }
+        }
+      }
+    }
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Creates a copy of a frame</summary>
+  /// <param name="frame">Frame that will be copied</param>
+  /// <returns>A new frame with the same pixels</returns>
+  Nuclex::FrameFixer::Rendering::FrameBuffer copyFrame(
+    const Nuclex::FrameFixer::Rendering::FrameBuffer &frame
+  ) {
+    Nuclex::FrameFixer::Rendering::FrameBuffer copy(
+      frame.GetWidth(), frame.GetHeight(), frame.GetFormat(), frame.GetLayout()
+    );
+    for(std::size_t planeIndex = 0; planeIndex < frame.GetPlaneCount(); ++planeIndex) {
+      for(int lineIndex = 0; lineIndex < frame.GetHeight(); ++lineIndex) {
+        std::copy_n(
+          frame.GetRow(lineIndex, planeIndex),
+          frame.GetRowLength(),
+          copy.GetRow(lineIndex, planeIndex)
+        );
+      }
+    }
+
+    return copy;
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Reads a channel value from a row</summary>
+  /// <param name="row">Row the channel value will be read from</param>
+  /// <param name="index">Index of the channel value in the row</param>
+  /// <param name="sixteenBitChannels">Whether the channels are 16 bits wide</param>
+  /// <returns>The channel value</returns>
+  std::uint32_t getValue(const std::uint8_t *row, std::size_t index, bool sixteenBitChannels) {
+    if(sixteenBitChannels) {
+      return reinterpret_cast<const std::uint16_t *>(row)[index];
+    } else {
+      return row[index];
+    }
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Combines frames and compares the result to sorting each channel's values</summary>
+  /// <param name="mode">Whether the median or trimmed mean will be checked</param>
+  /// <param name="format">Pixel format of the frames</param>
+  /// <param name="layout">Whether the frames are interleaved or planar</param>
+  /// <param name="width">Width of the frames in pixels</param>
+  /// <param name="frameCount">Number of frames that will be combined</param>
+  /// <param name="threadCount">Number of threads that will work on the frames</param>
+  void checkAgainstSortedValues(
+    Nuclex::FrameFixer::AverageMode mode,
+    Nuclex::FrameFixer::Rendering::FramePixelFormat format,
+    Nuclex::FrameFixer::Rendering::FrameLayout layout,
+    int width, std::size_t frameCount, std::size_t threadCount = 1
+  ) {
+    using Nuclex::FrameFixer::Rendering::FrameBuffer;
+
+    const int height = 3;
+    FrameBuffer image(width, height, format, layout);
+    fillWithNoise(image, static_cast<std::uint32_t>(frameCount));
+    FrameBuffer originalImage = copyFrame(image);
+
+    std::vector<FrameBuffer> otherImages;
+    for(std::size_t index = 1; index < frameCount; ++index) {
+      otherImages.emplace_back(width, height, format, layout);
+      fillWithNoise(otherImages.back(), static_cast<std::uint32_t>(frameCount * 100 + index));
+    }
+
+    Nuclex::FrameFixer::Averager::Average(image, otherImages, mode, threadCount);
+
+    // The median is the middle value or the mean of the two middle values, the trimmed
+    // mean drops a quarter of the values (rounded to nearest) at either end
+    std::size_t firstIndex, endIndex;
+    if(mode == Nuclex::FrameFixer::AverageMode::Median) {
+      firstIndex = (frameCount - 1) / 2;
+      endIndex = frameCount / 2 + 1;
+    } else {
+      firstIndex = (frameCount + 1) / 4;
+      endIndex = frameCount - firstIndex;
+    }
+    float reciprocal = 1.0f / static_cast<float>(endIndex - firstIndex);
+
+    bool sixteenBitChannels = image.HasSixteenBitChannels();
+    std::size_t valueCount = image.GetRowLength() / (sixteenBitChannels ? 2 : 1);
+    std::vector<std::uint32_t> values(frameCount);
+    for(std::size_t planeIndex = 0; planeIndex < image.GetPlaneCount(); ++planeIndex) {
+      for(int lineIndex = 0; lineIndex < height; ++lineIndex) {
+        for(std::size_t index = 0; index < valueCount; ++index) {
+          values[0] = getValue(
+            originalImage.GetRow(lineIndex, planeIndex), index, sixteenBitChannels
+          );
+          for(std::size_t frameIndex = 1; frameIndex < frameCount; ++frameIndex) {
+            values[frameIndex] = getValue(
+              otherImages[frameIndex - 1].GetRow(lineIndex, planeIndex),
+              index, sixteenBitChannels
+            );
+          }
+          std::sort(values.begin(), values.end());
+
+          std::uint32_t sum = 0;
+          for(std::size_t valueIndex = firstIndex; valueIndex < endIndex; ++valueIndex) {
+            sum += values[valueIndex];
+          }
+          std::uint32_t expected = static_cast<std::uint32_t>(
+            std::lrint(static_cast<float>(sum) * reciprocal)
+          );
+
+          ASSERT_EQ(
+            getValue(image.GetRow(lineIndex, planeIndex), index, sixteenBitChannels), expected
+          ) << u8"plane " << planeIndex << u8", row " << lineIndex << u8", value " << index;
+        }
+      }
+    }
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Averages frames and compares the result to a plain per-channel mean</summary>
+  /// <param name="format">Pixel format of the frames</param>
+  /// <param name="layout">Whether the frames are interleaved or planar</param>
+  /// <param name="width">Width of the frames in pixels</param>
+  /// <param name="frameCount">Number of frames that will be averaged</param>
+  /// <param name="imageWeight">Number of frames the first frame stands for</param>
+  /// <param name="threadCount">Number of threads that will work on the frames</param>
+  void checkAgainstPlainMean(
+    Nuclex::FrameFixer::Rendering::FramePixelFormat format,
+    Nuclex::FrameFixer::Rendering::FrameLayout layout,
+    int width, std::size_t frameCount, std::size_t imageWeight, std::size_t threadCount = 1
+  ) {
+    using Nuclex::FrameFixer::Rendering::FrameBuffer;
+
+    const int height = 3;
+    FrameBuffer image(width, height, format, layout);
+    fillWithNoise(image, static_cast<std::uint32_t>(frameCount * 7 + imageWeight));
+    FrameBuffer originalImage = copyFrame(image);
+
+    std::vector<FrameBuffer> otherImages;
+    for(std::size_t index = 1; index < frameCount; ++index) {
+      otherImages.emplace_back(width, height, format, layout);
+      fillWithNoise(otherImages.back(), static_cast<std::uint32_t>(frameCount * 100 + index));
+    }
+
+    // Only the weighted overload takes a weight, only the mode overload takes threads
+    if(imageWeight == 1) {
+      Nuclex::FrameFixer::Averager::Average(
+        image, otherImages, Nuclex::FrameFixer::AverageMode::Mean, threadCount
+      );
+    } else {
+      Nuclex::FrameFixer::Averager::Average(image, otherImages, imageWeight);
+    }
+
+    // The sum is divided by the total weight and rounded to the nearest value
+    float reciprocal = 1.0f / static_cast<float>(frameCount - 1 + imageWeight);
+
+    bool sixteenBitChannels = image.HasSixteenBitChannels();
+    std::size_t valueCount = image.GetRowLength() / (sixteenBitChannels ? 2 : 1);
+    for(std::size_t planeIndex = 0; planeIndex < image.GetPlaneCount(); ++planeIndex) {
+      for(int lineIndex = 0; lineIndex < height; ++lineIndex) {
+        for(std::size_t index = 0; index < valueCount; ++index) {
+          std::uint32_t sum = static_cast<std::uint32_t>(imageWeight) * getValue(
+            originalImage.GetRow(lineIndex, planeIndex), index, sixteenBitChannels
+          );
+          for(std::size_t frameIndex = 1; frameIndex < frameCount; ++frameIndex) {
+            sum += getValue(
+              otherImages[frameIndex - 1].GetRow(lineIndex, planeIndex),
+              index, sixteenBitChannels
+            );
+          }
+          std::uint32_t expected = static_cast<std::uint32_t>(
+            std::lrint(static_cast<float>(sum) * reciprocal)
+          );
+
+          ASSERT_EQ(
+            getValue(image.GetRow(lineIndex, planeIndex), index, sixteenBitChannels), expected
+          ) << u8"plane " << planeIndex << u8", row " << lineIndex << u8", value " << index;
+        }
+      }
+    }
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Runs a check for 8 and 16 bit channels, both layouts and all code paths</summary>
+  /// <param name="check">Check that will be run for each combination</param>
+  template<typename TCheck>
+  void checkAllVariants(TCheck check) {
+    using Nuclex::FrameFixer::Rendering::FrameLayout;
+    using Nuclex::FrameFixer::Rendering::FramePixelFormat;
+
+    for(bool useAvx2 : { false, true }) {
+      Avx2Scope avx2Scope(useAvx2);
+      if(useAvx2 && !Nuclex::FrameFixer::Platform::CpuFeatures::HasAvx2()) {
+        continue;
+      }
+
+      for(FramePixelFormat format : { FramePixelFormat::Argb32, FramePixelFormat::Rgba64 }) {
+        for(FrameLayout layout : { FrameLayout::Interleaved, FrameLayout::Planar }) {
+          SCOPED_TRACE(
+            testing::Message() <<
+            (useAvx2 ? u8"AVX2, " : u8"SSE2, ") <<
+            ((format == FramePixelFormat::Rgba64) ? u8"16 bit, " : u8"8 bit, ") <<
+            ((layout == FrameLayout::Planar) ? u8"planar" : u8"interleaved")
+          );
+          check(format, layout);
+        }
+      }
+    }
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+} // anonymous namespace
+
+namespace Nuclex::FrameFixer {
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(AveragerTest, MeanMatchesPlainAverageForEveryRowLength) {
+    checkAllVariants(
+      [](Rendering::FramePixelFormat format, Rendering::FrameLayout layout) {
+        // Each loop of the accumulation and division ends with every possible number
+        // of leftover channels, 3 and 6 frames give averages that need rounding
+        for(int width = 1; width <= 33; ++width) {
+          SCOPED_TRACE(testing::Message() << width << u8" pixels wide");
+          checkAgainstPlainMean(format, layout, width, 3, 1);
+          checkAgainstPlainMean(format, layout, width, 6, 1);
+        }
+      }
+    );
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(AveragerTest, MeanMatchesPlainAverageForWeightedFrames) {
+    checkAllVariants(
+      [](Rendering::FramePixelFormat format, Rendering::FrameLayout layout) {
+        // Weighted frames skip the SSE2 accumulation and need to agree with it
+        for(std::size_t imageWeight : { 2, 3, 7, 100 }) {
+          SCOPED_TRACE(testing::Message() << u8"weight " << imageWeight);
+          for(int width : { 1, 4, 5, 17, 33 }) {
+            SCOPED_TRACE(testing::Message() << width << u8" pixels wide");
+            checkAgainstPlainMean(format, layout, width, 4, imageWeight);
+          }
+        }
+      }
+    );
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(AveragerTest, MeanCanUseSeveralThreads) {
+    checkAllVariants(
+      [](Rendering::FramePixelFormat format, Rendering::FrameLayout layout) {
+        checkAgainstPlainMean(format, layout, 29, 5, 1, 3);
+      }
+    );
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(AveragerTest, MeanOfImagesRoundsToNearest) {
+    QImage image(1, 1, QImage::Format_ARGB32);
+    std::vector<QImage> otherImages;
+    otherImages.emplace_back(1, 1, QImage::Format_ARGB32);
+    otherImages.emplace_back(1, 1, QImage::Format_ARGB32);
+
+    // Sums of 31, 32 and 0 over three frames: 10.33, 10.67 and 0, 765 for a full alpha
+    reinterpret_cast<QRgb *>(image.scanLine(0))[0] = qRgba(10, 10, 0, 255);
+    reinterpret_cast<QRgb *>(otherImages[0].scanLine(0))[0] = qRgba(10, 11, 0, 255);
+    reinterpret_cast<QRgb *>(otherImages[1].scanLine(0))[0] = qRgba(11, 11, 0, 255);
+
+    Averager::Average(image, otherImages);
+
+    EXPECT_EQ(reinterpret_cast<const QRgb *>(image.constScanLine(0))[0], qRgba(10, 11, 0, 255));
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(AveragerTest, MedianMatchesSortedValuesForAllRunLengths) {
+    checkAllVariants(
+      [](Rendering::FramePixelFormat format, Rendering::FrameLayout layout) {
+        // 37 pixels leave channels over for the narrower vectors and the plain loop
+        for(std::size_t frameCount = 1; frameCount <= 40; ++frameCount) {
+          SCOPED_TRACE(testing::Message() << frameCount << u8" frames");
+          checkAgainstSortedValues(AverageMode::Median, format, layout, 37, frameCount);
+        }
+      }
+    );
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(AveragerTest, TrimmedMeanMatchesSortedValuesForAllRunLengths) {
+    checkAllVariants(
+      [](Rendering::FramePixelFormat format, Rendering::FrameLayout layout) {
+        for(std::size_t frameCount = 1; frameCount <= 40; ++frameCount) {
+          SCOPED_TRACE(testing::Message() << frameCount << u8" frames");
+          checkAgainstSortedValues(AverageMode::TrimmedMean, format, layout, 37, frameCount);
+        }
+      }
+    );
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(AveragerTest, SelectionHandlesEveryRowLength) {
+    checkAllVariants(
+      [](Rendering::FramePixelFormat format, Rendering::FrameLayout layout) {
+        // Up to twice the widest vector plus one, so each loop ends with every possible
+        // number of leftover channels (in planar frames, one channel per pixel)
+        for(int width = 1; width <= 33; ++width) {
+          SCOPED_TRACE(testing::Message() << width << u8" pixels wide");
+          checkAgainstSortedValues(AverageMode::Median, format, layout, width, 4);
+          checkAgainstSortedValues(AverageMode::TrimmedMean, format, layout, width, 7);
+        }
+      }
+    );
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(AveragerTest, SelectionCanUseSeveralThreads) {
+    checkAllVariants(
+      [](Rendering::FramePixelFormat format, Rendering::FrameLayout layout) {
+        checkAgainstSortedValues(AverageMode::Median, format, layout, 29, 5, 3);
+        checkAgainstSortedValues(AverageMode::TrimmedMean, format, layout, 29, 9, 3);
+      }
+    );
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(AveragerTest, MedianIgnoresDropoutsInImages) {
+    QImage image(3, 1, QImage::Format_ARGB32);
+    std::vector<QImage> otherImages;
+    for(std::size_t index = 0; index < 4; ++index) {
+      otherImages.emplace_back(3, 1, QImage::Format_ARGB32);
+    }
+
+    // One dropout and one sparkle per pixel, the other three frames agree (roughly)
+    const QRgb columns[5][3] = {
+      { qRgba(10, 20, 30, 255), qRgba(0, 0, 0, 255), qRgba(90, 90, 90, 255) },
+      { qRgba(0, 0, 0, 255), qRgba(40, 50, 60, 255), qRgba(91, 91, 91, 255) },
+      { qRgba(11, 21, 31, 255), qRgba(255, 255, 255, 255), qRgba(0, 0, 0, 255) },
+      { qRgba(255, 255, 255, 255), qRgba(41, 51, 61, 255), qRgba(255, 255, 255, 255) },
+      { qRgba(12, 22, 32, 255), qRgba(42, 52, 62, 255), qRgba(92, 92, 92, 255) }
+    };
+    for(int x = 0; x < 3; ++x) {
+      reinterpret_cast<QRgb *>(image.scanLine(0))[x] = columns[0][x];
+      for(std::size_t index = 0; index < otherImages.size(); ++index) {
+        reinterpret_cast<QRgb *>(otherImages[index].scanLine(0))[x] = columns[index + 1][x];
+      }
+    }
+
+    Averager::Average(image, otherImages, AverageMode::Median);
+
+    const QRgb *pixels = reinterpret_cast<const QRgb *>(image.constScanLine(0));
+    EXPECT_EQ(pixels[0], qRgba(11, 21, 31, 255));
+    EXPECT_EQ(pixels[1], qRgba(41, 51, 61, 255));
+    EXPECT_EQ(pixels[2], qRgba(91, 91, 91, 255));
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(AveragerTest, MismatchedFramesAreRejected) {
+    Rendering::FrameBuffer image(8, 2, Rendering::FramePixelFormat::Rgba64);
+    std::vector<Rendering::FrameBuffer> otherImages;
+    otherImages.emplace_back(8, 2, Rendering::FramePixelFormat::Argb32);
+
+    EXPECT_THROW(
+      Averager::Average(image, otherImages, AverageMode::Median),
+      std::invalid_argument
+    );
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+} // namespace Nuclex::FrameFixer
@@ -0,0 +1,269 @@
+#pragma region Apache License 2.0
+/*
+Nuclex Frame Fixer
+Copyright (C) 2024 Markus Ewald / Nuclex Development Labs
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#pragma endregion // Apache License 2.0
+
+// If the application is compiled as a DLL, this ensures symbols are exported
+#define NUCLEX_FRAMEFIXER_SOURCE 1
+
+#include "../../Source/Algorithm/Matrix2D.h"
+#include "../../Source/Platform/CpuFeatures.h"
+
+#include <cstddef> // for std::ptrdiff_t
+#include <cstdint> // for std::uint8_t, std::uint32_t, std::uintptr_t
+#include <stdexcept> // for std::invalid_argument
+#include <utility> // for std::move()
+
+#include <gtest/gtest.h>
+
+namespace {
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Enables or disables AVX2 and restores the default when going out of scope</summary>
+  class Avx2Scope {
+
+    /// <summary>Switches the AVX2 code paths on or off</summary>
+    /// <param name="enabled">Whether the AVX2 code paths may be used</param>
+    public: Avx2Scope(bool enabled) {
+      Nuclex::FrameFixer::Platform::CpuFeatures::SetAvx2Enabled(enabled);
+    }
+
+    /// <summary>Switches the AVX2 code paths back on</summary>
+    public: ~Avx2Scope() {
+      Nuclex::FrameFixer::Platform::CpuFeatures::SetAvx2Enabled(true);
+    }
+
+  };
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Element whose size does not divide the row alignment</summary>
+  struct ThreeBytes {
+
+    /// <summary>Bytes making up the element</summary>
+    public: std::uint8_t Bytes[3];
+
+  };
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Checks whether an address lies on a row alignment boundary</summary>
+  /// <param name="address">Address that will be checked</param>
+  /// <returns>True if the address is aligned like a matrix row should be</returns>
+  bool isRowAligned(const void *address) {
+    return (
+      (reinterpret_cast<std::uintptr_t>(address) %
+      Nuclex::FrameFixer::Algorithm::Matrix2D<float>::RowAlignment) == 0
+    );
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Fills all planes of a float matrix with values unique to each element</summary>
+  /// <param name="matrix">Matrix that will be filled</param>
+  /// <param name="offset">Value added to all elements</param>
+  void fillWithPattern(Nuclex::FrameFixer::Algorithm::Matrix2D<float> &matrix, float offset) {
+    for(std::size_t plane = 0; plane < matrix.GetPlaneCount(); ++plane) {
+      for(std::size_t row = 0; row < matrix.GetHeight(); ++row) {
+        for(std::size_t column = 0; column < matrix.GetWidth(); ++column) {
+          matrix.At(column, row, plane) = offset + static_cast<float>(
+            plane * 1000 + row * 100 + column
+          );
+        }
+      }
+    }
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+} // anonymous namespace
+
+namespace Nuclex::FrameFixer::Algorithm {
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(Matrix2DTest, RowsAreAlignedAndPadded) {
+    for(std::size_t width = 1; width <= 33; ++width) {
+      Matrix2D<float> matrix(width, 3, 2);
+
+      EXPECT_EQ(matrix.GetWidth(), width);
+      EXPECT_EQ(matrix.GetHeight(), 3U);
+      EXPECT_EQ(matrix.GetPlaneCount(), 2U);
+      EXPECT_GE(matrix.GetStride(), width);
+      EXPECT_EQ((matrix.GetStride() * sizeof(float)) % Matrix2D<float>::RowAlignment, 0U);
+      EXPECT_LT(matrix.GetStride() * sizeof(float), width * sizeof(float) + 64);
+
+      for(std::size_t plane = 0; plane < 2; ++plane) {
+        for(std::size_t row = 0; row < 3; ++row) {
+          EXPECT_TRUE(isRowAligned(matrix.GetRow(row, plane)))
+            << u8"width " << width << u8", plane " << plane << u8", row " << row;
+        }
+      }
+    }
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(Matrix2DTest, StrideIsMeasuredInElements) {
+    EXPECT_EQ(Matrix2D<float>(16, 1).GetStride(), 16U);
+    EXPECT_EQ(Matrix2D<float>(17, 1).GetStride(), 32U);
+    EXPECT_EQ(Matrix2D<std::uint8_t>(65, 1).GetStride(), 128U);
+    EXPECT_EQ(Matrix2D<double>(1, 1).GetStride(), 8U);
+
+    // Rows of elements that don't divide the alignment are still padded to cover it
+    Matrix2D<ThreeBytes> odd(5, 2);
+    EXPECT_EQ(odd.GetStride(), 22U);
+    EXPECT_EQ(odd.GetRow(1) - odd.GetRow(0), 22);
+    EXPECT_TRUE(isRowAligned(odd.GetRow(0)));
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(Matrix2DTest, ElementsAreAddressedByColumnRowAndPlane) {
+    Matrix2D<std::uint32_t> matrix(5, 4, 3);
+    EXPECT_EQ(&matrix.At(0, 0, 0), matrix.GetRow(0));
+    EXPECT_EQ(&matrix.At(3, 2, 0), matrix.GetRow(2) + 3);
+    EXPECT_EQ(&matrix.At(3, 2, 1), matrix.GetRow(2, 1) + 3);
+    EXPECT_EQ(matrix.GetRow(1) - matrix.GetRow(0), static_cast<std::ptrdiff_t>(matrix.GetStride()));
+    EXPECT_EQ(
+      matrix.GetRow(0, 1) - matrix.GetRow(0, 0),
+      static_cast<std::ptrdiff_t>(matrix.GetStride() * 4)
+    );
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(Matrix2DTest, NewMatrixIsZeroed) {
+    Matrix2D<float> matrix(7, 3, 2);
+    for(std::size_t plane = 0; plane < 2; ++plane) {
+      for(std::size_t row = 0; row < 3; ++row) {
+        for(std::size_t column = 0; column < matrix.GetStride(); ++column) {
+          EXPECT_EQ(matrix.GetRow(row, plane)[column], 0.0f);
+        }
+      }
+    }
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(Matrix2DTest, FillSetsEveryElementInAllPlanes) {
+    for(bool useAvx2 : { false, true }) {
+      Avx2Scope avx2Scope(useAvx2);
+
+      // 13 columns leave elements over for the 8 and 4 wide loops and the plain one
+      Matrix2D<float> matrix(13, 3, 2);
+      matrix.Fill(1.5f);
+      Matrix2D<std::uint32_t> integers(13, 3, 2);
+      integers.Fill(42);
+
+      for(std::size_t plane = 0; plane < 2; ++plane) {
+        for(std::size_t row = 0; row < 3; ++row) {
+          for(std::size_t column = 0; column < matrix.GetStride(); ++column) {
+            EXPECT_EQ(matrix.GetRow(row, plane)[column], 1.5f);
+          }
+          for(std::size_t column = 0; column < integers.GetStride(); ++column) {
+            EXPECT_EQ(integers.GetRow(row, plane)[column], 42U);
+          }
+        }
+      }
+    }
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(Matrix2DTest, CopyDuplicatesElements) {
+    Matrix2D<float> original(13, 3, 2);
+    fillWithPattern(original, 0.0f);
+
+    Matrix2D<float> copy(original);
+    ASSERT_EQ(copy.GetWidth(), 13U);
+    ASSERT_EQ(copy.GetHeight(), 3U);
+    ASSERT_EQ(copy.GetPlaneCount(), 2U);
+    ASSERT_EQ(copy.GetStride(), original.GetStride());
+    EXPECT_NE(copy.GetRow(0), original.GetRow(0));
+    EXPECT_TRUE(isRowAligned(copy.GetRow(0)));
+
+    copy.At(4, 1, 1) = -1.0f;
+    EXPECT_EQ(original.At(4, 1, 1), 1104.0f);
+
+    for(std::size_t plane = 0; plane < 2; ++plane) {
+      for(std::size_t row = 0; row < 3; ++row) {
+        for(std::size_t column = 0; column < 13; ++column) {
+          if((plane != 1) || (row != 1) || (column != 4)) {
+            EXPECT_EQ(copy.At(column, row, plane), original.At(column, row, plane));
+          }
+        }
+      }
+    }
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(Matrix2DTest, MoveTakesOverElements) {
+    Matrix2D<float> original(13, 3);
+    fillWithPattern(original, 0.0f);
+    const float *elements = original.GetRow(0);
+
+    Matrix2D<float> moved(std::move(original));
+    EXPECT_EQ(moved.GetRow(0), elements);
+    EXPECT_EQ(moved.At(12, 2), 212.0f);
+    EXPECT_EQ(original.GetWidth(), 0U);
+    EXPECT_EQ(original.GetHeight(), 0U);
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(Matrix2DTest, ArithmeticIsAppliedElementWise) {
+    for(bool useAvx2 : { false, true }) {
+      Avx2Scope avx2Scope(useAvx2);
+
+      Matrix2D<float> matrix(13, 3, 2), other(13, 3, 2);
+      fillWithPattern(matrix, 1.0f);
+      fillWithPattern(other, 0.0f);
+
+      matrix.Add(other);
+      matrix.Multiply(other);
+      matrix.Multiply(0.5f);
+      matrix.Divide(4.0f);
+
+      for(std::size_t plane = 0; plane < 2; ++plane) {
+        for(std::size_t row = 0; row < 3; ++row) {
+          for(std::size_t column = 0; column < 13; ++column) {
+            float value = other.At(column, row, plane);
+            EXPECT_EQ(matrix.At(column, row, plane), (value + 1.0f + value) * value * 0.5f / 4.0f)
+              << u8"plane " << plane << u8", row " << row << u8", column " << column;
+          }
+        }
+      }
+    }
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(Matrix2DTest, MatricesOfDifferentSizesCantBeCombined) {
+    Matrix2D<float> matrix(13, 3, 2);
+    EXPECT_THROW(matrix.Add(Matrix2D<float>(12, 3, 2)), std::invalid_argument);
+    EXPECT_THROW(matrix.Multiply(Matrix2D<float>(13, 3, 1)), std::invalid_argument);
+
+    Matrix2D<std::uint32_t> integers(4, 4);
+    EXPECT_THROW(integers.Add(Matrix2D<std::uint32_t>(4, 5)), std::invalid_argument);
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+} // namespace Nuclex::FrameFixer::Algorithm
@@ -0,0 +1,323 @@
+#pragma region Apache License 2.0
+/*
+Nuclex Frame Fixer
+Copyright (C) 2024 Markus Ewald / Nuclex Development Labs
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#pragma endregion // Apache License 2.0
+
+// If the application is compiled as a DLL, this ensures symbols are exported
+#define NUCLEX_FRAMEFIXER_SOURCE 1
+
+#include "../../Source/Algorithm/SobelOperator.h"
+#include "../../Source/Rendering/FrameBuffer.h"
+#include "../../Source/Platform/CpuFeatures.h"
+
+#include <algorithm> // for std::clamp()
+#include <cstdint> // for std::uint8_t, std::uint16_t, std::uint32_t
+#include <stdexcept> // for std::invalid_argument
+#include <vector> // for std::vector
+
+#include <gtest/gtest.h>
+
+namespace {
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Kernel that picks up horizontal changes in brightness</summary>
+  const float HorizontalSobelKernel[3][3] = {
+    { -1.0f, 0.0f, +1.0f },
+    { -2.0f, 0.0f, +2.0f },
+    { -1.0f, 0.0f, +1.0f }
+  };
+
+  /// <summary>Kernel that picks up vertical changes in brightness</summary>
+  const float VerticalSobelKernel[3][3] = {
+    { -1.0f, -2.0f, -1.0f },
+    {  0.0f,  0.0f,  0.0f },
+    { +1.0f, +2.0f, +1.0f }
+  };
+
+  /// <summary>Largest difference tolerated between the reference and the operator</summary>
+  /// <remarks>
+  ///   The vectorized code sums up the kernel in a different order than the reference.
+  /// </remarks>
+  const float Tolerance = 0.00001f;
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Enables or disables AVX2 and restores the default when going out of scope</summary>
+  class Avx2Scope {
+
+    /// <summary>Switches the AVX2 code paths on or off</summary>
+    /// <param name="enabled">Whether the AVX2 code paths may be used</param>
+    public: Avx2Scope(bool enabled) {
+      Nuclex::FrameFixer::Platform::CpuFeatures::SetAvx2Enabled(enabled);
+    }
+
+    /// <summary>Switches the AVX2 code paths back on</summary>
+    public: ~Avx2Scope() {
+      Nuclex::FrameFixer::Platform::CpuFeatures::SetAvx2Enabled(true);
+    }
+
+  };
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Color channels of a frame, normalized to the range 0.0 to 1.0</summary>
+  struct ChannelValues {
+
+    /// <summary>Initializes new channel values for a frame of the specified size</summary>
+    /// <param name="width">Width of the frame in pixels</param>
+    /// <param name="height">Height of the frame in pixels</param>
+    public: ChannelValues(int width, int height) :
+      Width(width),
+      Height(height),
+      Values(static_cast<std::size_t>(width) * height * 3) {}
+
+    /// <summary>Looks up a channel value, repeating the border outside of the frame</summary>
+    /// <param name="x">X coordinate of the pixel</param>
+    /// <param name="y">Y coordinate of the pixel</param>
+    /// <param name="channel">Channel (0: red, 1: green, 2: blue, 3: luma)</param>
+    /// <returns>The value of the channel</returns>
+    public: float Get(int x, int y, std::size_t channel) const {
+      x = std::clamp(x, 0, this->Width - 1);
+      y = std::clamp(y, 0, this->Height - 1);
+      if(channel == 3) {
+        return Get(x, y, 0) * 0.2126f + Get(x, y, 1) * 0.7152f + Get(x, y, 2) * 0.0722f;
+      }
+
+      std::size_t index = static_cast<std::size_t>(y) * this->Width + x;
+      return this->Values[index * 3 + channel];
+    }
+
+    /// <summary>Width of the frame in pixels</summary>
+    public: int Width;
+    /// <summary>Height of the frame in pixels</summary>
+    public: int Height;
+    /// <summary>Red, green and blue value of each pixel, row by row</summary>
+    public: std::vector<float> Values;
+
+  };
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Fills a frame with noise and records the normalized channel values</summary>
+  /// <param name="frame">Frame that will be filled</param>
+  /// <returns>The normalized red, green and blue values of each pixel</returns>
+  ChannelValues fillWithNoise(Nuclex::FrameFixer::Rendering::FrameBuffer &frame) {
+    using Nuclex::FrameFixer::Rendering::FrameLayout;
+
+    ChannelValues values(frame.GetWidth(), frame.GetHeight());
+    bool sixteenBitChannels = frame.HasSixteenBitChannels();
+    bool isPlanar = (frame.GetLayout() == FrameLayout::Planar);
+    std::uint32_t maximum = sixteenBitChannels ? 65535 : 255;
+
+    std::uint32_t seed = 12345;
+    for(int y = 0; y < frame.GetHeight(); ++y) {
+      for(int x = 0; x < frame.GetWidth(); ++x) {
+        for(std::size_t channel = 0; channel < 4; ++channel) {
+          seed = seed * 1664525U + 1013904223U;
+          std::uint32_t value = (seed >> 8) % (maximum + 1);
+          if(channel < 3) {
+            std::size_t index = static_cast<std::size_t>(y) * frame.GetWidth() + x;
+            values.Values[index * 3 + channel] = (
+              static_cast<float>(value) / static_cast<float>(maximum)
+            );
+          }
+
+          // Planar frames and 16 bit channels are in R, G, B, A order, 8 bit interleaved
+          // frames are QRgb values (0xAARRGGBB), so stored as B, G, R, A in memory
+          std::size_t offset;
+          if(isPlanar) {
+            offset = static_cast<std::size_t>(x);
+          } else if(sixteenBitChannels) {
+            offset = static_cast<std::size_t>(x) * 4 + channel;
+          } else {
+            offset = static_cast<std::size_t>(x) * 4 + ((channel < 3) ? (2 - channel) : 3);
+          }
+
+          std::uint8_t *row = frame.GetRow(y, isPlanar ? channel : 0);
+          if(sixteenBitChannels) {
+            reinterpret_cast<std::uint16_t *>(row)[offset] = static_cast<std::uint16_t>(value);
+          } else {
+            row[offset] = static_cast<std::uint8_t>(value);
+          }
+        }
+      }
+    }
+
+    return values;
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Convolves one channel around a pixel with a 3x3 kernel</summary>
+  /// <param name="values">Channel values of the frame</param>
+  /// <param name="kernel">Kernel the channel will be convolved with</param>
+  /// <param name="x">X coordinate of the pixel</param>
+  /// <param name="y">Y coordinate of the pixel</param>
+  /// <param name="channel">Channel (0: red, 1: green, 2: blue, 3: luma)</param>
+  /// <returns>The sum of the weighted neighbouring values</returns>
+  float convolve(
+    const ChannelValues &values, const float (&kernel)[3][3], int x, int y, std::size_t channel
+  ) {
+    float sum = 0.0f;
+    for(int kernelY = 0; kernelY < 3; ++kernelY) {
+      for(int kernelX = 0; kernelX < 3; ++kernelX) {
+        sum += kernel[kernelY][kernelX] * values.Get(x + kernelX - 1, y + kernelY - 1, channel);
+      }
+    }
+
+    return sum;
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Compares the gradients in a matrix to convolving the channels directly</summary>
+  /// <param name="values">Channel values of the frame</param>
+  /// <param name="gradients">Gradients calculated by the Sobel operator</param>
+  /// <param name="channels">Channels whose gradients are stored in the matrix</param>
+  void checkAgainstConvolution(
+    const ChannelValues &values,
+    const Nuclex::FrameFixer::Algorithm::Matrix2D<float> &gradients,
+    const std::vector<std::size_t> &channels
+  ) {
+    for(std::size_t index = 0; index < channels.size(); ++index) {
+      for(int y = 0; y < values.Height; ++y) {
+        for(int x = 0; x < values.Width; ++x) {
+          ASSERT_NEAR(
+            gradients.At(x, y, index * 2),
+            convolve(values, HorizontalSobelKernel, x, y, channels[index]),
+            Tolerance
+          ) << u8"horizontal, channel " << channels[index] << u8" at " << x << u8", " << y;
+          ASSERT_NEAR(
+            gradients.At(x, y, index * 2 + 1),
+            convolve(values, VerticalSobelKernel, x, y, channels[index]),
+            Tolerance
+          ) << u8"vertical, channel " << channels[index] << u8" at " << x << u8", " << y;
+        }
+      }
+    }
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Runs a check for 8 and 16 bit channels, both layouts and all code paths</summary>
+  /// <param name="check">Check that will be run for each combination</param>
+  template<typename TCheck>
+  void checkAllVariants(TCheck check) {
+    using Nuclex::FrameFixer::Rendering::FrameLayout;
+    using Nuclex::FrameFixer::Rendering::FramePixelFormat;
+
+    for(bool useAvx2 : { false, true }) {
+      Avx2Scope avx2Scope(useAvx2);
+      if(useAvx2 && !Nuclex::FrameFixer::Platform::CpuFeatures::HasAvx2()) {
+        continue;
+      }
+
+      for(FramePixelFormat format : { FramePixelFormat::Argb32, FramePixelFormat::Rgba64 }) {
+        for(FrameLayout layout : { FrameLayout::Interleaved, FrameLayout::Planar }) {
+          SCOPED_TRACE(
+            testing::Message() <<
+            (useAvx2 ? u8"AVX2, " : u8"SSE2, ") <<
+            ((format == FramePixelFormat::Rgba64) ? u8"16 bit, " : u8"8 bit, ") <<
+            ((layout == FrameLayout::Planar) ? u8"planar" : u8"interleaved")
+          );
+          check(format, layout);
+        }
+      }
+    }
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+} // anonymous namespace
+
+namespace Nuclex::FrameFixer::Algorithm {
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(SobelOperatorTest, LumaGradientsMatchConvolution) {
+    checkAllVariants(
+      [](Rendering::FramePixelFormat format, Rendering::FrameLayout layout) {
+        // 13 pixels leave values over for the 8 and 4 wide loops and the plain one
+        for(int width : { 1, 2, 13 }) {
+          Rendering::FrameBuffer frame(width, 5, format, layout);
+          ChannelValues values = fillWithNoise(frame);
+
+          Matrix2D<float> gradients(width, 5, 2);
+          SobelOperator::CalculateLumaGradients(frame, gradients);
+          checkAgainstConvolution(values, gradients, { 3 });
+        }
+      }
+    );
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(SobelOperatorTest, RgbGradientsMatchConvolution) {
+    checkAllVariants(
+      [](Rendering::FramePixelFormat format, Rendering::FrameLayout layout) {
+        for(int width : { 1, 2, 13 }) {
+          Rendering::FrameBuffer frame(width, 5, format, layout);
+          ChannelValues values = fillWithNoise(frame);
+
+          Matrix2D<float> gradients(width, 5, 6);
+          SobelOperator::CalculateRgbGradients(frame, gradients);
+          checkAgainstConvolution(values, gradients, { 0, 1, 2 });
+        }
+      }
+    );
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(SobelOperatorTest, VerticalEdgeHasOnlyHorizontalGradient) {
+    Rendering::FrameBuffer frame(6, 3, Rendering::FramePixelFormat::Argb32);
+    for(int y = 0; y < 3; ++y) {
+      std::uint32_t *pixels = reinterpret_cast<std::uint32_t *>(frame.GetRow(y));
+      for(int x = 0; x < 6; ++x) {
+        pixels[x] = (x < 3) ? 0xFF000000U : 0xFFFFFFFFU;
+      }
+    }
+
+    Matrix2D<float> gradients(6, 3, 2);
+    SobelOperator::CalculateLumaGradients(frame, gradients);
+
+    // Luma weights add up to 1, so black to white gives 1 + 2 + 1 next to the edge
+    for(std::size_t y = 0; y < 3; ++y) {
+      for(std::size_t x = 0; x < 6; ++x) {
+        float expected = ((x == 2) || (x == 3)) ? 4.0f : 0.0f;
+        EXPECT_NEAR(gradients.At(x, y, 0), expected, Tolerance) << x << u8", " << y;
+        EXPECT_NEAR(gradients.At(x, y, 1), 0.0f, Tolerance) << x << u8", " << y;
+      }
+    }
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(SobelOperatorTest, MismatchedMatrixIsRejected) {
+    Rendering::FrameBuffer frame(8, 4, Rendering::FramePixelFormat::Argb32);
+
+    Matrix2D<float> wrongSize(8, 5, 2);
+    EXPECT_THROW(SobelOperator::CalculateLumaGradients(frame, wrongSize), std::invalid_argument);
+
+    Matrix2D<float> tooFewPlanes(8, 4, 2);
+    EXPECT_THROW(SobelOperator::CalculateRgbGradients(frame, tooFewPlanes), std::invalid_argument);
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+} // namespace Nuclex::FrameFixer::Algorithm
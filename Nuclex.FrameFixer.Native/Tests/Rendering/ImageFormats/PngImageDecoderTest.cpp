@@ -0,0 +1,662 @@
+#pragma region Apache License 2.0
+/*
+Nuclex Frame Fixer
+Copyright (C) 2024 Markus Ewald / Nuclex Development Labs
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#pragma endregion // Apache License 2.0
+
+// If the application is compiled as a DLL, this ensures symbols are exported
+#define NUCLEX_FRAMEFIXER_SOURCE 1
+
+#include "../../../Source/Rendering/ImageFormats/PngImageDecoder.h"
+#include "../../../Source/Rendering/ImageFormats/PngImageEncoder.h"
+
+#include <zlib.h> // for compress2(), crc32()
+
+#include <cstdint> // for std::uint8_t, std::uint16_t, std::uint32_t
+#include <cstdlib> // for std::abs()
+#include <cstring> // for std::memcpy()
+#include <vector> // for std::vector
+
+#include <gtest/gtest.h>
+
+namespace {
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Color type of PNG files holding grayscale pixels</summary>
+  const std::uint8_t GrayscaleColorType = 0;
+  /// <summary>Color type of PNG files holding palette indices</summary>
+  const std::uint8_t PaletteColorType = 3;
+  /// <summary>Color type of PNG files holding grayscale pixels with alpha</summary>
+  const std::uint8_t GrayscaleAlphaColorType = 4;
+
+  /// <summary>All row filters the encoder can be told to use</summary>
+  const Nuclex::FrameFixer::Rendering::ImageFormats::PngFilter AllFilters[] = {
+    Nuclex::FrameFixer::Rendering::ImageFormats::PngFilter::None,
+    Nuclex::FrameFixer::Rendering::ImageFormats::PngFilter::Sub,
+    Nuclex::FrameFixer::Rendering::ImageFormats::PngFilter::Up,
+    Nuclex::FrameFixer::Rendering::ImageFormats::PngFilter::Average,
+    Nuclex::FrameFixer::Rendering::ImageFormats::PngFilter::Paeth,
+    Nuclex::FrameFixer::Rendering::ImageFormats::PngFilter::Adaptive
+  };
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Produces a repeatable sequence of pseudo-random numbers</summary>
+  class NoiseGenerator {
+
+    /// <summary>Initializes a new noise generator</summary>
+    /// <param name="seed">Value from which the sequence of numbers is derived</param>
+    public: NoiseGenerator(std::uint32_t seed) : state(seed) {}
+
+    /// <summary>Returns the next number in the sequence</summary>
+    /// <returns>The next pseudo-random number</returns>
+    public: std::uint32_t Next() {
+      this->state = this->state * 1664525U + 1013904223U;
+      return this->state >> 8;
+    }
+
+    /// <summary>Current state of the linear congruential generator</summary>
+    private: std::uint32_t state;
+
+  };
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Creates an image with a mix of gradients and noise in it</summary>
+  /// <param name="width">Width the image will have in pixels</param>
+  /// <param name="height">Height the image will have in pixels</param>
+  /// <param name="format">
+  ///   Pixel format of the image, either QImage::Format_RGBA64 or QImage::Format_ARGB32
+  /// </param>
+  /// <returns>The new image</returns>
+  QImage createTestImage(int width, int height, QImage::Format format) {
+    QImage image(width, height, format);
+    NoiseGenerator noise(static_cast<std::uint32_t>(width * 31 + height));
+
+    // Smooth areas exercise the filters that predict from neighbouring pixels,
+    // the noisy right half produces bytes that match no prediction at all
+    for(int y = 0; y < height; ++y) {
+      for(int x = 0; x < width; ++x) {
+        std::uint16_t red, green, blue, alpha;
+        if(x < width / 2) {
+          red = static_cast<std::uint16_t>(x * 65535 / width);
+          green = static_cast<std::uint16_t>(y * 65535 / height);
+          blue = static_cast<std::uint16_t>((x + y) * 32767 / (width + height));
+          alpha = static_cast<std::uint16_t>(65535 - (x * 4099));
+        } else {
+          red = static_cast<std::uint16_t>(noise.Next());
+          green = static_cast<std::uint16_t>(noise.Next());
+          blue = static_cast<std::uint16_t>(noise.Next());
+          alpha = static_cast<std::uint16_t>(noise.Next());
+        }
+
+        if(format == QImage::Format_RGBA64) {
+          QRgba64 *row = reinterpret_cast<QRgba64 *>(image.scanLine(y));
+          row[x] = QRgba64::fromRgba64(red, green, blue, alpha);
+        } else {
+          QRgb *row = reinterpret_cast<QRgb *>(image.scanLine(y));
+          row[x] = qRgba(red >> 8, green >> 8, blue >> 8, alpha >> 8);
+        }
+      }
+    }
+
+    return image;
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Checks whether two images have the same size, format and pixels</summary>
+  /// <param name="actual">Image that was produced by the code being tested</param>
+  /// <param name="expected">Image holding the pixels that should have been produced</param>
+  void expectSameImage(const QImage &actual, const QImage &expected) {
+    ASSERT_EQ(actual.width(), expected.width());
+    ASSERT_EQ(actual.height(), expected.height());
+    ASSERT_EQ(actual.format(), expected.format());
+
+    std::size_t rowLength = static_cast<std::size_t>(actual.width()) * (actual.depth() / 8);
+    for(int y = 0; y < actual.height(); ++y) {
+      const std::uint8_t *actualRow = actual.constScanLine(y);
+      const std::uint8_t *expectedRow = expected.constScanLine(y);
+      for(std::size_t index = 0; index < rowLength; ++index) {
+        ASSERT_EQ(actualRow[index], expectedRow[index]) << u8"row " << y << u8", byte " << index;
+      }
+    }
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Checks that QImage reads a PNG file with the same pixels as the decoder</summary>
+  /// <param name="contents">Contents of the PNG file</param>
+  /// <param name="decoded">Image the PNG file was decoded into by the decoder</param>
+  void expectSameAsQImage(const std::vector<std::uint8_t> &contents, const QImage &decoded) {
+    QImage reference;
+    ASSERT_TRUE(
+      reference.loadFromData(contents.data(), static_cast<int>(contents.size()), u8"PNG")
+    );
+    expectSameImage(decoded, reference.convertToFormat(decoded.format()));
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Writes a 32 bit integer in big endian byte order</summary>
+  /// <param name="target">Buffer the integer will be appended to</param>
+  /// <param name="value">Integer that will be appended</param>
+  void appendBigEndian(std::vector<std::uint8_t> &target, std::uint32_t value) {
+    target.push_back(static_cast<std::uint8_t>(value >> 24));
+    target.push_back(static_cast<std::uint8_t>(value >> 16));
+    target.push_back(static_cast<std::uint8_t>(value >> 8));
+    target.push_back(static_cast<std::uint8_t>(value));
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Appends a chunk with its length and CRC to a PNG file</summary>
+  /// <param name="target">Contents of the PNG file the chunk will be appended to</param>
+  /// <param name="type">Four-letter type of the chunk</param>
+  /// <param name="data">Data that will be stored in the chunk</param>
+  void appendChunk(
+    std::vector<std::uint8_t> &target, const char *type, const std::vector<std::uint8_t> &data
+  ) {
+    appendBigEndian(target, static_cast<std::uint32_t>(data.size()));
+
+    std::size_t typeOffset = target.size();
+    target.insert(target.end(), type, type + 4);
+    target.insert(target.end(), data.begin(), data.end());
+
+    uLong checksum = ::crc32(
+      ::crc32(0, nullptr, 0), target.data() + typeOffset, static_cast<uInt>(data.size() + 4)
+    );
+    appendBigEndian(target, static_cast<std::uint32_t>(checksum));
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Applies one of the five PNG filters to a row of samples</summary>
+  /// <param name="filterType">PNG filter type from 0 (none) to 4 (Paeth)</param>
+  /// <param name="row">Unfiltered row of samples</param>
+  /// <param name="priorRow">Unfiltered prior row or all zeros for the first row</param>
+  /// <param name="bytesPerPixel">Number of bytes each pixel takes up</param>
+  /// <param name="target">Buffer the filter type and filtered row are appended to</param>
+  void appendFilteredRow(
+    int filterType,
+    const std::vector<std::uint8_t> &row, const std::vector<std::uint8_t> &priorRow,
+    std::size_t bytesPerPixel, std::vector<std::uint8_t> &target
+  ) {
+    target.push_back(static_cast<std::uint8_t>(filterType));
+    for(std::size_t index = 0; index < row.size(); ++index) {
+      int left = (index >= bytesPerPixel) ? row[index - bytesPerPixel] : 0;
+      int above = priorRow[index];
+      int aboveLeft = (index >= bytesPerPixel) ? priorRow[index - bytesPerPixel] : 0;
+
+      int prediction;
+      switch(filterType) {
+        case 1: { prediction = left; break; }
+        case 2: { prediction = above; break; }
+        case 3: { prediction = (left + above) / 2; break; }
+        case 4: {
+          int estimate = left + above - aboveLeft;
+          int leftDistance = std::abs(estimate - left);
+          int aboveDistance = std::abs(estimate - above);
+          int aboveLeftDistance = std::abs(estimate - aboveLeft);
+          if((leftDistance <= aboveDistance) && (leftDistance <= aboveLeftDistance)) {
+            prediction = left;
+          } else if(aboveDistance <= aboveLeftDistance) {
+            prediction = above;
+          } else {
+            prediction = aboveLeft;
+          }
+          break;
+        }
+        default: { prediction = 0; break; }
+      }
+
+      target.push_back(static_cast<std::uint8_t>(row[index] - prediction));
+    }
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Describes a PNG file that will be put together by hand</summary>
+  struct HandBuiltPng {
+
+    /// <summary>Width of the image in pixels</summary>
+    public: int Width;
+    /// <summary>Height of the image in pixels</summary>
+    public: int Height;
+    /// <summary>Number of bits per sample, either 8 or 16</summary>
+    public: std::uint8_t BitDepth;
+    /// <summary>PNG color type of the image</summary>
+    public: std::uint8_t ColorType;
+    /// <summary>Unfiltered samples of all rows in the image, in big endian byte order</summary>
+    public: std::vector<std::uint8_t> Samples;
+    /// <summary>RGB triplets of the palette, empty if the image has no palette</summary>
+    public: std::vector<std::uint8_t> Palette;
+    /// <summary>Alpha values of the palette entries, empty if the image has no tRNS chunk</summary>
+    public: std::vector<std::uint8_t> Transparency;
+
+    /// <summary>Returns the number of bytes each pixel takes up</summary>
+    /// <returns>The number of bytes in one pixel</returns>
+    public: std::size_t GetBytesPerPixel() const {
+      std::size_t channelCount = (this->ColorType == GrayscaleAlphaColorType) ? 2 : 1;
+      return channelCount * (this->BitDepth / 8);
+    }
+
+  };
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Compresses the rows of a hand-built PNG file, cycling through all filters</summary>
+  /// <param name="png">Description of the PNG file whose rows will be compressed</param>
+  /// <returns>The zlib stream holding the filtered rows</returns>
+  std::vector<std::uint8_t> compressImageData(const HandBuiltPng &png) {
+    std::size_t bytesPerPixel = png.GetBytesPerPixel();
+    std::size_t rowLength = static_cast<std::size_t>(png.Width) * bytesPerPixel;
+
+    std::vector<std::uint8_t> filtered;
+    std::vector<std::uint8_t> priorRow(rowLength, 0);
+    for(int y = 0; y < png.Height; ++y) {
+      std::vector<std::uint8_t> row(
+        png.Samples.begin() + (rowLength * y), png.Samples.begin() + (rowLength * (y + 1))
+      );
+      appendFilteredRow(y % 5, row, priorRow, bytesPerPixel, filtered);
+      priorRow.swap(row);
+    }
+
+    uLongf compressedLength = ::compressBound(static_cast<uLong>(filtered.size()));
+    std::vector<std::uint8_t> compressed(compressedLength);
+    int result = ::compress2(
+      compressed.data(), &compressedLength,
+      filtered.data(), static_cast<uLong>(filtered.size()),
+      Z_BEST_SPEED
+    );
+    EXPECT_EQ(result, Z_OK);
+    compressed.resize(compressedLength);
+
+    return compressed;
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Puts a PNG file together from its description and image data</summary>
+  /// <param name="png">Description of the PNG file that will be put together</param>
+  /// <param name="imageData">zlib stream that will be stored in the IDAT chunks</param>
+  /// <param name="withEnd">Whether the file will be terminated by an IEND chunk</param>
+  /// <returns>The contents of the PNG file</returns>
+  std::vector<std::uint8_t> assemblePng(
+    const HandBuiltPng &png, const std::vector<std::uint8_t> &imageData, bool withEnd = true
+  ) {
+    static const std::uint8_t signature[] = { 137, 80, 78, 71, 13, 10, 26, 10 };
+    std::vector<std::uint8_t> contents(signature, signature + sizeof(signature));
+
+    std::vector<std::uint8_t> header;
+    appendBigEndian(header, static_cast<std::uint32_t>(png.Width));
+    appendBigEndian(header, static_cast<std::uint32_t>(png.Height));
+    header.push_back(png.BitDepth);
+    header.push_back(png.ColorType);
+    header.push_back(0); // Deflate compression
+    header.push_back(0); // Adaptive filtering
+    header.push_back(0); // Not interlaced
+    appendChunk(contents, u8"IHDR", header);
+
+    if(!png.Palette.empty()) {
+      appendChunk(contents, u8"PLTE", png.Palette);
+    }
+    if(!png.Transparency.empty()) {
+      appendChunk(contents, u8"tRNS", png.Transparency);
+    }
+
+    // Split the image data across two chunks so the decoder has to pick up
+    // the zlib stream where it left off in the middle of a row
+    std::size_t splitOffset = imageData.size() / 2;
+    appendChunk(
+      contents, u8"IDAT",
+      std::vector<std::uint8_t>(imageData.begin(), imageData.begin() + splitOffset)
+    );
+    appendChunk(
+      contents, u8"IDAT",
+      std::vector<std::uint8_t>(imageData.begin() + splitOffset, imageData.end())
+    );
+
+    if(withEnd) {
+      appendChunk(contents, u8"IEND", std::vector<std::uint8_t>());
+    }
+
+    return contents;
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Describes a 16 bit grayscale image with alpha channel</summary>
+  /// <param name="width">Width of the image in pixels</param>
+  /// <param name="height">Height of the image in pixels</param>
+  /// <returns>The description of the PNG file</returns>
+  HandBuiltPng describeGrayscaleAlphaPng(int width, int height) {
+    HandBuiltPng png = HandBuiltPng();
+    png.Width = width;
+    png.Height = height;
+    png.BitDepth = 16;
+    png.ColorType = GrayscaleAlphaColorType;
+
+    NoiseGenerator noise(1234);
+    png.Samples.resize(static_cast<std::size_t>(width) * height * 4);
+    for(std::uint8_t &sample : png.Samples) {
+      sample = static_cast<std::uint8_t>(noise.Next());
+    }
+
+    return png;
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Decodes a PNG file and checks it against the expected pixels and QImage</summary>
+  /// <param name="contents">Contents of the PNG file that will be decoded</param>
+  /// <param name="expected">Image holding the pixels the decoder should produce</param>
+  void expectDecodedAs(const std::vector<std::uint8_t> &contents, const QImage &expected) {
+    using Nuclex::FrameFixer::Rendering::ImageFormats::PngImageDecoder;
+
+    PngImageDecoder decoder;
+    QImage decoded;
+    ASSERT_TRUE(decoder.TryDecode(contents.data(), contents.size(), decoded));
+
+    expectSameImage(decoded, expected);
+    expectSameAsQImage(contents, decoded);
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+} // anonymous namespace
+
+namespace Nuclex::FrameFixer::Rendering::ImageFormats {
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(PngImageDecoderTest, RecognizesPngPaths) {
+    EXPECT_TRUE(PngImageDecoder::IsPngPath(u8"frames/00001.png"));
+    EXPECT_TRUE(PngImageDecoder::IsPngPath(u8"FRAME.PNG"));
+    EXPECT_FALSE(PngImageDecoder::IsPngPath(u8"frames/00001.tif"));
+    EXPECT_FALSE(PngImageDecoder::IsPngPath(u8"png"));
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(PngImageDecoderTest, SixteenBitImagesSurviveRoundTripWithEveryFilter) {
+    QImage source = createTestImage(67, 23, QImage::Format_RGBA64);
+    QImage opaqueSource = source.convertToFormat(QImage::Format_RGBX64);
+
+    PngImageDecoder decoder;
+    for(PngFilter filter : AllFilters) {
+      std::vector<std::uint8_t> contents = PngImageEncoder(6, filter).Encode(source);
+
+      QImage decoded;
+      ASSERT_TRUE(decoder.TryDecode(contents.data(), contents.size(), decoded));
+      EXPECT_EQ(decoded.format(), QImage::Format_RGBA64);
+      expectSameImage(decoded, source);
+      expectSameAsQImage(contents, decoded);
+
+      contents = PngImageEncoder(1, filter).Encode(opaqueSource);
+      ASSERT_TRUE(decoder.TryDecode(contents.data(), contents.size(), decoded));
+      EXPECT_EQ(decoded.format(), QImage::Format_RGBX64);
+      expectSameImage(decoded, opaqueSource);
+      expectSameAsQImage(contents, decoded);
+    }
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(PngImageDecoderTest, EightBitImagesSurviveRoundTripWithEveryFilter) {
+    QImage source = createTestImage(67, 23, QImage::Format_ARGB32);
+    QImage opaqueSource = source.convertToFormat(QImage::Format_RGB32);
+
+    PngImageDecoder decoder;
+    for(PngFilter filter : AllFilters) {
+      std::vector<std::uint8_t> contents = PngImageEncoder(6, filter).Encode(source);
+
+      QImage decoded;
+      ASSERT_TRUE(decoder.TryDecode(contents.data(), contents.size(), decoded));
+      EXPECT_EQ(decoded.format(), QImage::Format_ARGB32);
+      expectSameImage(decoded, source);
+      expectSameAsQImage(contents, decoded);
+
+      contents = PngImageEncoder(1, filter).Encode(opaqueSource);
+      ASSERT_TRUE(decoder.TryDecode(contents.data(), contents.size(), decoded));
+      EXPECT_EQ(decoded.format(), QImage::Format_RGB32);
+      expectSameImage(decoded, opaqueSource);
+      expectSameAsQImage(contents, decoded);
+    }
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(PngImageDecoderTest, DecodesIntoReusedImage) {
+    QImage first = createTestImage(40, 10, QImage::Format_RGBA64);
+    QImage second = first.convertToFormat(QImage::Format_RGBX64).convertToFormat(
+      QImage::Format_RGBA64
+    );
+
+    PngImageDecoder decoder;
+    QImage decoded;
+    std::vector<std::uint8_t> contents = PngImageEncoder(1, PngFilter::Up).Encode(first);
+    ASSERT_TRUE(decoder.TryDecode(contents.data(), contents.size(), decoded));
+    const std::uint8_t *pixels = decoded.constBits();
+
+    contents = PngImageEncoder(1, PngFilter::Up).Encode(second);
+    ASSERT_TRUE(decoder.TryDecode(contents.data(), contents.size(), decoded));
+    EXPECT_EQ(decoded.constBits(), pixels);
+    expectSameImage(decoded, second);
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(PngImageDecoderTest, DecodesGrayscaleImages) {
+    for(std::uint8_t bitDepth : { std::uint8_t(8), std::uint8_t(16) }) {
+      HandBuiltPng png = HandBuiltPng();
+      png.Width = 37;
+      png.Height = 11;
+      png.BitDepth = bitDepth;
+      png.ColorType = GrayscaleColorType;
+
+      QImage expected(
+        png.Width, png.Height,
+        (bitDepth == 16) ? QImage::Format_RGBX64 : QImage::Format_RGB32
+      );
+      NoiseGenerator noise(bitDepth);
+      for(int y = 0; y < png.Height; ++y) {
+        for(int x = 0; x < png.Width; ++x) {
+          std::uint16_t gray = static_cast<std::uint16_t>(noise.Next());
+          if(bitDepth == 16) {
+            png.Samples.push_back(static_cast<std::uint8_t>(gray >> 8));
+            png.Samples.push_back(static_cast<std::uint8_t>(gray));
+            reinterpret_cast<QRgba64 *>(expected.scanLine(y))[x] = (
+              QRgba64::fromRgba64(gray, gray, gray, 65535)
+            );
+          } else {
+            std::uint8_t gray8 = static_cast<std::uint8_t>(gray);
+            png.Samples.push_back(gray8);
+            reinterpret_cast<QRgb *>(expected.scanLine(y))[x] = qRgb(gray8, gray8, gray8);
+          }
+        }
+      }
+
+      expectDecodedAs(assemblePng(png, compressImageData(png)), expected);
+    }
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(PngImageDecoderTest, DecodesGrayscaleImagesWithAlpha) {
+    for(std::uint8_t bitDepth : { std::uint8_t(8), std::uint8_t(16) }) {
+      HandBuiltPng png = HandBuiltPng();
+      png.Width = 29;
+      png.Height = 13;
+      png.BitDepth = bitDepth;
+      png.ColorType = GrayscaleAlphaColorType;
+
+      QImage expected(
+        png.Width, png.Height,
+        (bitDepth == 16) ? QImage::Format_RGBA64 : QImage::Format_ARGB32
+      );
+      NoiseGenerator noise(bitDepth + 1);
+      for(int y = 0; y < png.Height; ++y) {
+        for(int x = 0; x < png.Width; ++x) {
+          std::uint16_t gray = static_cast<std::uint16_t>(noise.Next());
+          std::uint16_t alpha = static_cast<std::uint16_t>(noise.Next());
+          if(bitDepth == 16) {
+            png.Samples.push_back(static_cast<std::uint8_t>(gray >> 8));
+            png.Samples.push_back(static_cast<std::uint8_t>(gray));
+            png.Samples.push_back(static_cast<std::uint8_t>(alpha >> 8));
+            png.Samples.push_back(static_cast<std::uint8_t>(alpha));
+            reinterpret_cast<QRgba64 *>(expected.scanLine(y))[x] = (
+              QRgba64::fromRgba64(gray, gray, gray, alpha)
+            );
+          } else {
+            std::uint8_t gray8 = static_cast<std::uint8_t>(gray);
+            std::uint8_t alpha8 = static_cast<std::uint8_t>(alpha);
+            png.Samples.push_back(gray8);
+            png.Samples.push_back(alpha8);
+            reinterpret_cast<QRgb *>(expected.scanLine(y))[x] = (
+              qRgba(gray8, gray8, gray8, alpha8)
+            );
+          }
+        }
+      }
+
+      expectDecodedAs(assemblePng(png, compressImageData(png)), expected);
+    }
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(PngImageDecoderTest, DecodesPaletteImagesWithTransparency) {
+    HandBuiltPng png = HandBuiltPng();
+    png.Width = 41;
+    png.Height = 9;
+    png.BitDepth = 8;
+    png.ColorType = PaletteColorType;
+
+    // Only part of the palette has alpha values, the remaining entries are opaque
+    const std::size_t colorCount = 200;
+    const std::size_t alphaCount = 120;
+    NoiseGenerator noise(77);
+    for(std::size_t index = 0; index < colorCount * 3; ++index) {
+      png.Palette.push_back(static_cast<std::uint8_t>(noise.Next()));
+    }
+    for(std::size_t index = 0; index < alphaCount; ++index) {
+      png.Transparency.push_back(static_cast<std::uint8_t>(noise.Next()));
+    }
+
+    QImage expected(png.Width, png.Height, QImage::Format_ARGB32);
+    for(int y = 0; y < png.Height; ++y) {
+      for(int x = 0; x < png.Width; ++x) {
+        std::size_t index = noise.Next() % colorCount;
+        png.Samples.push_back(static_cast<std::uint8_t>(index));
+
+        const std::uint8_t *color = png.Palette.data() + index * 3;
+        int alpha = (index < alphaCount) ? png.Transparency[index] : 255;
+        reinterpret_cast<QRgb *>(expected.scanLine(y))[x] = (
+          qRgba(color[0], color[1], color[2], alpha)
+        );
+      }
+    }
+
+    expectDecodedAs(assemblePng(png, compressImageData(png)), expected);
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(PngImageDecoderTest, DecodesHandBuiltFileWithIntactStream) {
+    HandBuiltPng png = describeGrayscaleAlphaPng(19, 7);
+    std::vector<std::uint8_t> contents = assemblePng(png, compressImageData(png));
+
+    PngImageDecoder decoder;
+    QImage decoded;
+    EXPECT_TRUE(decoder.TryDecode(contents.data(), contents.size(), decoded));
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(PngImageDecoderTest, RejectsImageDataWithTruncatedChecksum) {
+    HandBuiltPng png = describeGrayscaleAlphaPng(19, 7);
+    std::vector<std::uint8_t> imageData = compressImageData(png);
+
+    // All rows are still there, only (part of) the Adler-32 trailer is missing
+    PngImageDecoder decoder;
+    for(std::size_t cutByteCount = 1; cutByteCount <= 4; ++cutByteCount) {
+      std::vector<std::uint8_t> truncated(imageData.begin(), imageData.end() - cutByteCount);
+      std::vector<std::uint8_t> contents = assemblePng(png, truncated);
+
+      QImage decoded;
+      EXPECT_FALSE(decoder.TryDecode(contents.data(), contents.size(), decoded));
+    }
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(PngImageDecoderTest, RejectsImageDataWithWrongChecksum) {
+    HandBuiltPng png = describeGrayscaleAlphaPng(19, 7);
+    std::vector<std::uint8_t> imageData = compressImageData(png);
+    imageData.back() ^= 0x5A;
+
+    std::vector<std::uint8_t> contents = assemblePng(png, imageData);
+
+    PngImageDecoder decoder;
+    QImage decoded;
+    EXPECT_FALSE(decoder.TryDecode(contents.data(), contents.size(), decoded));
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(PngImageDecoderTest, RejectsFileWithoutEndChunk) {
+    HandBuiltPng png = describeGrayscaleAlphaPng(19, 7);
+    std::vector<std::uint8_t> contents = assemblePng(png, compressImageData(png), false);
+
+    PngImageDecoder decoder;
+    QImage decoded;
+    EXPECT_FALSE(decoder.TryDecode(contents.data(), contents.size(), decoded));
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(PngImageDecoderTest, RejectsChunksWithWrongChecksum) {
+    HandBuiltPng png = describeGrayscaleAlphaPng(19, 7);
+    std::vector<std::uint8_t> contents = assemblePng(png, compressImageData(png));
+
+    // The image width in the header, right behind the signature, length and chunk type
+    contents[8 + 4 + 4 + 3] ^= 0x01;
+
+    PngImageDecoder decoder;
+    QImage decoded;
+    EXPECT_FALSE(decoder.TryDecode(contents.data(), contents.size(), decoded));
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(PngImageDecoderTest, LeavesColorKeyTransparencyToQImage) {
+    HandBuiltPng png = describeGrayscaleAlphaPng(19, 7);
+    png.ColorType = GrayscaleColorType;
+    png.Samples.resize(png.Samples.size() / 2);
+    png.Transparency = { 0x12, 0x34 };
+
+    std::vector<std::uint8_t> contents = assemblePng(png, compressImageData(png));
+
+    PngImageDecoder decoder;
+    QImage decoded;
+    EXPECT_FALSE(decoder.TryDecode(contents.data(), contents.size(), decoded));
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+} // namespace Nuclex::FrameFixer::Rendering::ImageFormats
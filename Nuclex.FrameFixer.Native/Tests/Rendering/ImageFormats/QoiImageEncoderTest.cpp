@@ -0,0 +1,296 @@
+#pragma region Apache License 2.0
+/*
+Nuclex Frame Fixer
+Copyright (C) 2024 Markus Ewald / Nuclex Development Labs
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#pragma endregion // Apache License 2.0
+
+// If the application is compiled as a DLL, this ensures symbols are exported
+#define NUCLEX_FRAMEFIXER_SOURCE 1
+
+#include "../../../Source/Rendering/ImageFormats/QoiImageEncoder.h"
+
+#include <cstdint> // for std::uint8_t, std::uint16_t, std::uint32_t
+#include <vector> // for std::vector
+
+#include <gtest/gtest.h>
+
+namespace {
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Pixels and header fields read back from a QOI file</summary>
+  struct DecodedQoiImage {
+
+    /// <summary>Width of the image in pixels</summary>
+    public: std::uint32_t Width;
+    /// <summary>Height of the image in pixels</summary>
+    public: std::uint32_t Height;
+    /// <summary>Number of channels stated in the header, 3 or 4</summary>
+    public: std::uint8_t ChannelCount;
+    /// <summary>Red, green, blue and alpha of each pixel, row by row</summary>
+    public: std::vector<std::uint8_t> Pixels;
+
+  };
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Reads a 32 bit big endian integer</summary>
+  /// <param name="bytes">Bytes from which the integer will be read</param>
+  /// <returns>The integer</returns>
+  std::uint32_t readBigEndian(const std::uint8_t *bytes) {
+    return (
+      (std::uint32_t(bytes[0]) << 24) | (std::uint32_t(bytes[1]) << 16) |
+      (std::uint32_t(bytes[2]) << 8) | std::uint32_t(bytes[3])
+    );
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Decodes a QOI file the way the format specification describes it</summary>
+  /// <param name="contents">Contents of the QOI file</param>
+  /// <returns>The decoded image</returns>
+  DecodedQoiImage decodeQoi(const std::vector<std::uint8_t> &contents) {
+    DecodedQoiImage image = DecodedQoiImage();
+    EXPECT_GE(contents.size(), 22U);
+    if(contents.size() < 22) {
+      return image;
+    }
+
+    EXPECT_EQ(contents[0], 'q');
+    EXPECT_EQ(contents[1], 'o');
+    EXPECT_EQ(contents[2], 'i');
+    EXPECT_EQ(contents[3], 'f');
+    image.Width = readBigEndian(contents.data() + 4);
+    image.Height = readBigEndian(contents.data() + 8);
+    image.ChannelCount = contents[12];
+    EXPECT_EQ(contents[13], 0U); // sRGB with linear alpha
+
+    std::uint8_t recentColors[64][4] = {};
+    std::uint8_t pixel[4] = { 0, 0, 0, 255 };
+    std::size_t runLength = 0;
+    std::size_t position = 14;
+    std::size_t endPosition = contents.size() - 8;
+
+    std::size_t pixelCount = static_cast<std::size_t>(image.Width) * image.Height;
+    image.Pixels.reserve(pixelCount * 4);
+    for(std::size_t index = 0; index < pixelCount; ++index) {
+      if(runLength > 0) {
+        --runLength;
+      } else if(position < endPosition) {
+        std::uint8_t tag = contents[position++];
+        if(tag == 0xFE) {
+          pixel[0] = contents[position++];
+          pixel[1] = contents[position++];
+          pixel[2] = contents[position++];
+        } else if(tag == 0xFF) {
+          pixel[0] = contents[position++];
+          pixel[1] = contents[position++];
+          pixel[2] = contents[position++];
+          pixel[3] = contents[position++];
+        } else if((tag & 0xC0) == 0x00) {
+          for(std::size_t channel = 0; channel < 4; ++channel) {
+            pixel[channel] = recentColors[tag][channel];
+          }
+        } else if((tag & 0xC0) == 0x40) {
+          pixel[0] += ((tag >> 4) & 3) - 2;
+          pixel[1] += ((tag >> 2) & 3) - 2;
+          pixel[2] += (tag & 3) - 2;
+        } else if((tag & 0xC0) == 0x80) {
+          std::uint8_t second = contents[position++];
+          int greenDifference = (tag & 0x3F) - 32;
+          pixel[0] += greenDifference - 8 + ((second >> 4) & 0x0F);
+          pixel[1] += greenDifference;
+          pixel[2] += greenDifference - 8 + (second & 0x0F);
+        } else {
+          runLength = (tag & 0x3F);
+        }
+
+        std::size_t slot = (pixel[0] * 3 + pixel[1] * 5 + pixel[2] * 7 + pixel[3] * 11) % 64;
+        for(std::size_t channel = 0; channel < 4; ++channel) {
+          recentColors[slot][channel] = pixel[channel];
+        }
+      }
+
+      image.Pixels.insert(image.Pixels.end(), pixel, pixel + 4);
+    }
+
+    // Every byte up to the end marker must have been used, the end marker must follow
+    EXPECT_EQ(position, endPosition);
+    EXPECT_EQ(runLength, 0U);
+    const std::uint8_t endMarker[8] = { 0, 0, 0, 0, 0, 0, 0, 1 };
+    for(std::size_t index = 0; index < 8; ++index) {
+      EXPECT_EQ(contents[endPosition + index], endMarker[index]);
+    }
+
+    return image;
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Creates an image that makes the encoder use each of its operations</summary>
+  /// <param name="width">Width the image will have in pixels</param>
+  /// <param name="height">Height the image will have in pixels</param>
+  /// <param name="format">Pixel format the image will have</param>
+  /// <returns>The new image</returns>
+  QImage createTestImage(int width, int height, QImage::Format format) {
+    QImage image(width, height, format);
+    std::uint32_t seed = static_cast<std::uint32_t>(width * 31 + height);
+
+    // Flat rows produce runs that are longer than a single run operation and continue
+    // into the next row, gradients produce small and luma differences, a few repeating
+    // colors are found in the recently seen colors and noise needs full pixels
+    for(int y = 0; y < height; ++y) {
+      for(int x = 0; x < width; ++x) {
+        int red, green, blue, alpha = 255;
+        switch(y % 4) {
+          case 0: { red = 10; green = 20; blue = 30; break; }
+          case 1: { red = x; green = x * 2; blue = 128 + x * 3 / 2; break; }
+          case 2: {
+            red = (x % 3) * 80;
+            green = 40;
+            blue = 255 - (x % 3) * 80;
+            break;
+          }
+          default: {
+            seed = seed * 1664525U + 1013904223U;
+            red = (seed >> 8) & 0xFF;
+            green = (seed >> 16) & 0xFF;
+            blue = (seed >> 24) & 0xFF;
+            alpha = (x % 5 == 0) ? ((seed >> 4) & 0xFF) : 255;
+            break;
+          }
+        }
+
+        if(format == QImage::Format_RGBA64) {
+          QRgba64 *row = reinterpret_cast<QRgba64 *>(image.scanLine(y));
+          row[x] = QRgba64::fromRgba64(
+            static_cast<std::uint16_t>((red & 0xFF) * 257 + (x & 0x7F)),
+            static_cast<std::uint16_t>((green & 0xFF) * 257),
+            static_cast<std::uint16_t>((blue & 0xFF) * 257),
+            static_cast<std::uint16_t>(alpha * 257)
+          );
+        } else {
+          QRgb *row = reinterpret_cast<QRgb *>(image.scanLine(y));
+          row[x] = qRgba(red & 0xFF, green & 0xFF, blue & 0xFF, alpha);
+        }
+      }
+    }
+
+    return image;
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Checks that a decoded image has the same pixels as an 8 bit RGBA image</summary>
+  /// <param name="decoded">Image decoded from the QOI file</param>
+  /// <param name="expected">Image in QImage::Format_RGBA8888 or Format_RGBX8888</param>
+  void expectSamePixels(const DecodedQoiImage &decoded, const QImage &expected) {
+    ASSERT_EQ(decoded.Width, static_cast<std::uint32_t>(expected.width()));
+    ASSERT_EQ(decoded.Height, static_cast<std::uint32_t>(expected.height()));
+
+    std::size_t width = static_cast<std::size_t>(expected.width());
+    for(int y = 0; y < expected.height(); ++y) {
+      const std::uint8_t *row = expected.constScanLine(y);
+      for(std::size_t x = 0; x < width; ++x) {
+        for(std::size_t channel = 0; channel < 4; ++channel) {
+          std::uint8_t value = row[x * 4 + channel];
+          if((channel == 3) && (expected.format() == QImage::Format_RGBX8888)) {
+            value = 255;
+          }
+          ASSERT_EQ(decoded.Pixels[(y * width + x) * 4 + channel], value)
+            << u8"pixel " << x << u8", " << y << u8", channel " << channel;
+        }
+      }
+    }
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+} // anonymous namespace
+
+namespace Nuclex::FrameFixer::Rendering::ImageFormats {
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(QoiImageEncoderTest, ProducesExpectedBytesForSmallImage) {
+    QImage image(3, 1, QImage::Format_RGB32);
+    QRgb *row = reinterpret_cast<QRgb *>(image.scanLine(0));
+    row[0] = qRgb(0, 0, 0);
+    row[1] = qRgb(1, 1, 1);
+    row[2] = qRgb(200, 10, 10);
+
+    // The first pixel repeats the implicit black one before the image, the second is
+    // a small difference and the third is too far away for anything but a full pixel
+    const std::uint8_t expected[] = {
+      'q', 'o', 'i', 'f', 0, 0, 0, 3, 0, 0, 0, 1, 3, 0,
+      0xC0,
+      0x7F,
+      0xFE, 200, 10, 10,
+      0, 0, 0, 0, 0, 0, 0, 1
+    };
+
+    std::vector<std::uint8_t> contents = QoiImageEncoder().Encode(image);
+    EXPECT_EQ(contents, std::vector<std::uint8_t>(expected, expected + sizeof(expected)));
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(QoiImageEncoderTest, SplitsLongRuns) {
+    QImage image(100, 2, QImage::Format_RGB32);
+    image.fill(qRgb(0, 0, 0));
+
+    // 200 pixels repeating the implicit black one are three full runs of 62 and one of 14
+    std::vector<std::uint8_t> contents = QoiImageEncoder().Encode(image);
+    ASSERT_EQ(contents.size(), 14U + 4U + 8U);
+    EXPECT_EQ(contents[14], 0xFD);
+    EXPECT_EQ(contents[15], 0xFD);
+    EXPECT_EQ(contents[16], 0xFD);
+    EXPECT_EQ(contents[17], 0xC0 | 13);
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(QoiImageEncoderTest, OpaqueImagesSurviveRoundTrip) {
+    QImage image = createTestImage(100, 9, QImage::Format_RGB32);
+
+    DecodedQoiImage decoded = decodeQoi(QoiImageEncoder().Encode(image));
+    EXPECT_EQ(decoded.ChannelCount, 3U);
+    expectSamePixels(decoded, image.convertToFormat(QImage::Format_RGBX8888));
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(QoiImageEncoderTest, TranslucentImagesSurviveRoundTrip) {
+    QImage image = createTestImage(100, 9, QImage::Format_ARGB32);
+
+    DecodedQoiImage decoded = decodeQoi(QoiImageEncoder().Encode(image));
+    EXPECT_EQ(decoded.ChannelCount, 4U);
+    expectSamePixels(decoded, image.convertToFormat(QImage::Format_RGBA8888));
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(QoiImageEncoderTest, SixteenBitImagesAreReducedToEightBits) {
+    QImage image = createTestImage(37, 8, QImage::Format_RGBA64);
+
+    DecodedQoiImage decoded = decodeQoi(QoiImageEncoder().Encode(image));
+    EXPECT_EQ(decoded.ChannelCount, 4U);
+    expectSamePixels(decoded, image.convertToFormat(QImage::Format_RGBA8888));
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+} // namespace Nuclex::FrameFixer::Rendering::ImageFormats
@@ -0,0 +1,313 @@
+#pragma region Apache License 2.0
+/*
+Nuclex Frame Fixer
+Copyright (C) 2024 Markus Ewald / Nuclex Development Labs
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#pragma endregion // Apache License 2.0
+
+// If the application is compiled as a DLL, this ensures symbols are exported
+#define NUCLEX_FRAMEFIXER_SOURCE 1
+
+#include "../../../Source/Rendering/ImageFormats/TiffImageEncoder.h"
+
+#include <cstdint> // for std::uint8_t, std::uint16_t, std::uint32_t
+#include <map> // for std::map
+#include <vector> // for std::vector
+
+#include <gtest/gtest.h>
+
+namespace {
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Data type of TIFF tag values that are 16 bit integers</summary>
+  const std::uint16_t TiffShort = 3;
+
+  /// <summary>Data type of TIFF tag values that are 32 bit integers</summary>
+  const std::uint16_t TiffLong = 4;
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Reads the fields of a baseline TIFF file in its own byte order</summary>
+  class TiffReader {
+
+    /// <summary>Entry in a TIFF image file directory</summary>
+    public: struct Entry {
+
+      /// <summary>Data type of the entry's values</summary>
+      public: std::uint16_t Type;
+      /// <summary>Number of values stored in the entry</summary>
+      public: std::uint32_t Count;
+      /// <summary>Position of the field holding the value or the values' offset</summary>
+      public: std::size_t FieldPosition;
+
+    };
+
+    /// <summary>Initializes a new TIFF reader and reads the first image file directory</summary>
+    /// <param name="contents">Contents of the TIFF file</param>
+    public: TiffReader(const std::vector<std::uint8_t> &contents) :
+      contents(contents),
+      isBigEndian(false),
+      entries() {
+      if(contents.size() < 8) {
+        ADD_FAILURE() << u8"File is too short for a TIFF header";
+        return;
+      }
+
+      if((contents[0] == 'M') && (contents[1] == 'M')) {
+        this->isBigEndian = true;
+      } else {
+        EXPECT_EQ(contents[0], 'I');
+        EXPECT_EQ(contents[1], 'I');
+      }
+      EXPECT_EQ(Read16(2), 42U);
+
+      std::size_t directoryPosition = Read32(4);
+      std::size_t entryCount = Read16(directoryPosition);
+      std::uint16_t previousTag = 0;
+      for(std::size_t index = 0; index < entryCount; ++index) {
+        std::size_t position = directoryPosition + 2 + index * 12;
+        std::uint16_t tag = Read16(position);
+        EXPECT_GT(tag, previousTag) << u8"tags must appear in ascending order";
+        previousTag = tag;
+
+        this->entries[tag] = Entry { Read16(position + 2), Read32(position + 4), position + 8 };
+      }
+      EXPECT_EQ(Read32(directoryPosition + 2 + entryCount * 12), 0U);
+    }
+
+    /// <summary>Reads a 16 bit integer in the file's byte order</summary>
+    /// <param name="position">Position of the integer in the file</param>
+    /// <returns>The integer</returns>
+    public: std::uint16_t Read16(std::size_t position) const {
+      if(position + 2 > this->contents.size()) {
+        ADD_FAILURE() << u8"Read past the end of the file at " << position;
+        return 0;
+      }
+
+      const std::uint8_t *bytes = this->contents.data() + position;
+      if(this->isBigEndian) {
+        return static_cast<std::uint16_t>((bytes[0] << 8) | bytes[1]);
+      } else {
+        return static_cast<std::uint16_t>((bytes[1] << 8) | bytes[0]);
+      }
+    }
+
+    /// <summary>Reads a 32 bit integer in the file's byte order</summary>
+    /// <param name="position">Position of the integer in the file</param>
+    /// <returns>The integer</returns>
+    public: std::uint32_t Read32(std::size_t position) const {
+      std::uint32_t first = Read16(position);
+      std::uint32_t second = Read16(position + 2);
+      return this->isBigEndian ? ((first << 16) | second) : ((second << 16) | first);
+    }
+
+    /// <summary>Reads one of the values of a directory entry</summary>
+    /// <param name="tag">Tag of the directory entry</param>
+    /// <param name="index">Index of the value that will be read</param>
+    /// <returns>The value</returns>
+    public: std::uint32_t GetValue(std::uint16_t tag, std::size_t index = 0) const {
+      std::map<std::uint16_t, Entry>::const_iterator iterator = this->entries.find(tag);
+      if(iterator == this->entries.end()) {
+        ADD_FAILURE() << u8"Missing tag " << tag;
+        return 0;
+      }
+
+      const Entry &entry = iterator->second;
+      EXPECT_LT(index, entry.Count);
+      std::size_t valueSize = (entry.Type == TiffShort) ? 2 : 4;
+      EXPECT_TRUE((entry.Type == TiffShort) || (entry.Type == TiffLong));
+
+      // Values that don't fit into the 4 byte field are stored elsewhere, with
+      // the field holding their offset as a 32 bit integer
+      std::size_t position = entry.FieldPosition;
+      if(valueSize * entry.Count > 4) {
+        position = Read32(entry.FieldPosition);
+      }
+      position += index * valueSize;
+
+      return (valueSize == 2) ? Read16(position) : Read32(position);
+    }
+
+    /// <summary>Checks whether the first image file directory contains a tag</summary>
+    /// <param name="tag">Tag that will be looked for</param>
+    /// <returns>True if the tag is present</returns>
+    public: bool HasTag(std::uint16_t tag) const {
+      return (this->entries.find(tag) != this->entries.end());
+    }
+
+    /// <summary>Contents of the TIFF file</summary>
+    private: const std::vector<std::uint8_t> &contents;
+    /// <summary>Whether the file is stored in big endian byte order</summary>
+    private: bool isBigEndian;
+    /// <summary>Entries of the first image file directory by their tags</summary>
+    private: std::map<std::uint16_t, Entry> entries;
+
+  };
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Creates an image with noise and varying opacity in it</summary>
+  /// <param name="width">Width the image will have in pixels</param>
+  /// <param name="height">Height the image will have in pixels</param>
+  /// <param name="format">Pixel format the image will have</param>
+  /// <returns>The new image</returns>
+  QImage createTestImage(int width, int height, QImage::Format format) {
+    QImage image(width, height, format);
+    std::uint32_t seed = static_cast<std::uint32_t>(width * 31 + height);
+
+    for(int y = 0; y < height; ++y) {
+      for(int x = 0; x < width; ++x) {
+        std::uint16_t channels[4];
+        for(std::size_t channel = 0; channel < 4; ++channel) {
+          seed = seed * 1664525U + 1013904223U;
+          channels[channel] = static_cast<std::uint16_t>(seed >> 12);
+        }
+
+        if((format == QImage::Format_RGBA64) || (format == QImage::Format_RGBX64)) {
+          QRgba64 *row = reinterpret_cast<QRgba64 *>(image.scanLine(y));
+          row[x] = QRgba64::fromRgba64(
+            channels[0], channels[1], channels[2],
+            (format == QImage::Format_RGBX64) ? 0xFFFF : channels[3]
+          );
+        } else {
+          QRgb *row = reinterpret_cast<QRgb *>(image.scanLine(y));
+          row[x] = qRgba(channels[0] >> 8, channels[1] >> 8, channels[2] >> 8, channels[3] >> 8);
+        }
+      }
+    }
+
+    return image;
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Encodes an image and checks the TIFF file's fields and pixels</summary>
+  /// <param name="image">Image that will be encoded and checked</param>
+  /// <param name="expectedBitsPerSample">Number of bits each channel should be stored with</param>
+  /// <param name="expectAlpha">Whether the file should contain an alpha channel</param>
+  void checkRoundTrip(const QImage &image, std::uint32_t expectedBitsPerSample, bool expectAlpha) {
+    std::vector<std::uint8_t> contents = (
+      Nuclex::FrameFixer::Rendering::ImageFormats::TiffImageEncoder().Encode(image)
+    );
+    TiffReader reader(contents);
+
+    std::uint32_t channelCount = expectAlpha ? 4 : 3;
+    std::uint32_t width = static_cast<std::uint32_t>(image.width());
+    std::uint32_t height = static_cast<std::uint32_t>(image.height());
+    EXPECT_EQ(reader.GetValue(256), width);
+    EXPECT_EQ(reader.GetValue(257), height);
+    for(std::size_t channel = 0; channel < channelCount; ++channel) {
+      EXPECT_EQ(reader.GetValue(258, channel), expectedBitsPerSample) << u8"channel " << channel;
+    }
+    EXPECT_EQ(reader.GetValue(259), 1U); // Compression: none
+    EXPECT_EQ(reader.GetValue(262), 2U); // PhotometricInterpretation: RGB
+    EXPECT_EQ(reader.GetValue(277), channelCount); // SamplesPerPixel
+    EXPECT_EQ(reader.GetValue(278), height); // RowsPerStrip
+    EXPECT_EQ(reader.GetValue(284), 1U); // PlanarConfiguration: chunky
+    if(expectAlpha) {
+      EXPECT_EQ(reader.GetValue(338), 2U); // ExtraSamples: straight alpha
+    } else {
+      EXPECT_FALSE(reader.HasTag(338));
+    }
+
+    std::size_t bytesPerChannel = expectedBitsPerSample / 8;
+    std::size_t pixelOffset = reader.GetValue(273);
+    std::size_t pixelByteCount = reader.GetValue(279);
+    ASSERT_EQ(pixelByteCount, width * height * channelCount * bytesPerChannel);
+    ASSERT_EQ(pixelOffset + pixelByteCount, contents.size());
+
+    for(int y = 0; y < image.height(); ++y) {
+      for(int x = 0; x < image.width(); ++x) {
+        QRgba64 color = image.pixelColor64(x, y);
+        std::uint32_t expected[4] = { color.red(), color.green(), color.blue(), color.alpha() };
+        if(bytesPerChannel == 1) {
+          QRgb color32 = image.pixel(x, y);
+          expected[0] = qRed(color32);
+          expected[1] = qGreen(color32);
+          expected[2] = qBlue(color32);
+          expected[3] = qAlpha(color32);
+        }
+
+        std::size_t position = pixelOffset + (
+          (static_cast<std::size_t>(y) * width + x) * channelCount * bytesPerChannel
+        );
+        for(std::size_t channel = 0; channel < channelCount; ++channel) {
+          std::uint32_t value;
+          if(bytesPerChannel == 1) {
+            value = contents[position + channel];
+          } else {
+            value = reader.Read16(position + channel * 2);
+          }
+          ASSERT_EQ(value, expected[channel])
+            << u8"pixel " << x << u8", " << y << u8", channel " << channel;
+        }
+      }
+    }
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+} // anonymous namespace
+
+namespace Nuclex::FrameFixer::Rendering::ImageFormats {
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(TiffImageEncoderTest, SixteenBitImagesWithAlphaSurviveRoundTrip) {
+    checkRoundTrip(createTestImage(13, 7, QImage::Format_RGBA64), 16, true);
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(TiffImageEncoderTest, OpaqueSixteenBitImagesSurviveRoundTrip) {
+    checkRoundTrip(createTestImage(13, 7, QImage::Format_RGBX64), 16, false);
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(TiffImageEncoderTest, EightBitImagesWithAlphaSurviveRoundTrip) {
+    checkRoundTrip(createTestImage(13, 7, QImage::Format_ARGB32), 8, true);
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(TiffImageEncoderTest, OpaqueEightBitImagesSurviveRoundTrip) {
+    checkRoundTrip(createTestImage(13, 7, QImage::Format_RGB32), 8, false);
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(TiffImageEncoderTest, BitsPerSampleOffsetIsFullInteger) {
+    std::vector<std::uint8_t> contents = TiffImageEncoder().Encode(
+      createTestImage(2, 2, QImage::Format_RGB32)
+    );
+    TiffReader reader(contents);
+
+    // Three shorts don't fit into the field, so it must hold their offset as a 32 bit
+    // integer. Written as a short, it would only be right in little endian files.
+    std::size_t directoryPosition = reader.Read32(4);
+    std::size_t bitsPerSampleField = directoryPosition + 2 + 2 * 12 + 8;
+    ASSERT_EQ(reader.Read16(directoryPosition + 2 + 2 * 12), 258U);
+    std::uint32_t offset = reader.Read32(bitsPerSampleField);
+    ASSERT_LE(offset + 6U, contents.size());
+    EXPECT_EQ(reader.Read16(offset), 8U);
+    EXPECT_EQ(reader.Read16(offset + 2), 8U);
+    EXPECT_EQ(reader.Read16(offset + 4), 8U);
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+} // namespace Nuclex::FrameFixer::Rendering::ImageFormats
@@ -0,0 +1,550 @@
+#pragma region Apache License 2.0
+/*
+Nuclex Frame Fixer
+Copyright (C) 2024 Markus Ewald / Nuclex Development Labs
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#pragma endregion // Apache License 2.0
+
+// If the application is compiled as a DLL, this ensures symbols are exported
+#define NUCLEX_FRAMEFIXER_SOURCE 1
+
+#include "../../Source/Rendering/PixelConversion.h"
+#include "../../Source/Platform/CpuFeatures.h"
+
+#include <QImage> // for QRgba64, QRgb
+
+#include <cstdint> // for std::uint8_t, std::uint16_t, std::uint32_t
+#include <cstdlib> // for std::abs()
+#include <vector> // for std::vector
+
+#include <gtest/gtest.h>
+
+namespace {
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Value written behind the end of each output to detect overruns</summary>
+  const std::uint16_t Sentinel = 0xDEAD;
+
+  /// <summary>Largest number of pixels the tested kernels process in one iteration</summary>
+  /// <remarks>
+  ///   Testing every pixel count up to twice this number plus one runs the AVX2 and SSE2
+  ///   loops once and twice, each followed by every possible number of leftover pixels.
+  /// </remarks>
+  const std::size_t WidestVector = 16;
+
+  /// <summary>Number of pixels in the long row each check is run on at the end</summary>
+  /// <remarks>
+  ///   Differences in rounding between the code paths only show up for a small fraction
+  ///   of all colors, so a long row of noise is needed to reliably catch them.
+  /// </remarks>
+  const std::size_t LongRowPixelCount = 65537;
+
+  /// <summary>Channel values at which rounding and clamping change their results</summary>
+  const std::uint16_t InterestingValues[] = {
+    0, 1, 127, 128, 129, 255, 256, 257, 383, 384, 385, 4095, 4096, 4097,
+    32767, 32768, 32896, 60160, 60415, 61440, 65279, 65407, 65408, 65534, 65535
+  };
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Enables or disables AVX2 and restores the default when going out of scope</summary>
+  class Avx2Scope {
+
+    /// <summary>Switches the AVX2 code paths on or off</summary>
+    /// <param name="enabled">Whether the AVX2 code paths may be used</param>
+    public: Avx2Scope(bool enabled) {
+      Nuclex::FrameFixer::Platform::CpuFeatures::SetAvx2Enabled(enabled);
+    }
+
+    /// <summary>Switches the AVX2 code paths back on</summary>
+    public: ~Avx2Scope() {
+      Nuclex::FrameFixer::Platform::CpuFeatures::SetAvx2Enabled(true);
+    }
+
+  };
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Produces channel values that mix the interesting values with noise</summary>
+  /// <param name="count">Number of channel values that will be produced</param>
+  /// <param name="seed">Value from which the noise is derived</param>
+  /// <returns>The produced channel values</returns>
+  std::vector<std::uint16_t> makeChannelValues(std::size_t count, std::uint32_t seed) {
+    const std::size_t interestingCount = (
+      sizeof(InterestingValues) / sizeof(InterestingValues[0])
+    );
+
+    std::vector<std::uint16_t> values(count);
+    for(std::size_t index = 0; index < count; ++index) {
+      seed = seed * 1664525U + 1013904223U;
+      if((seed & 0x100000) != 0) {
+        values[index] = InterestingValues[(seed >> 8) % interestingCount];
+      } else {
+        values[index] = static_cast<std::uint16_t>(seed >> 12);
+      }
+    }
+
+    return values;
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Runs a check once on the SSE2 code path and once on the AVX2 code path</summary>
+  /// <param name="check">Check that will be run for each pixel count</param>
+  /// <remarks>
+  ///   The AVX2 code path is skipped if the CPU does not support it. Either way, the plain
+  ///   loops handling the leftover pixels are run for all pixel counts. Afterwards, the check
+  ///   is run once more on a long row.
+  /// </remarks>
+  template<typename TCheck>
+  void checkAllCodePaths(TCheck check) {
+    for(bool useAvx2 : { false, true }) {
+      Avx2Scope avx2Scope(useAvx2);
+      if(useAvx2 && !Nuclex::FrameFixer::Platform::CpuFeatures::HasAvx2()) {
+        continue;
+      }
+
+      for(std::size_t pixelCount = 0; pixelCount <= WidestVector * 2 + 1; ++pixelCount) {
+        SCOPED_TRACE(
+          testing::Message() <<
+          (useAvx2 ? u8"AVX2" : u8"SSE2") << u8" with " << pixelCount << u8" pixels"
+        );
+        check(pixelCount);
+      }
+
+      SCOPED_TRACE(testing::Message() << (useAvx2 ? u8"AVX2" : u8"SSE2") << u8" long row");
+      check(LongRowPixelCount);
+    }
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Calculates the YUV value of an RGB pixel the way the plain loop does</summary>
+  /// <param name="pixel">Pixel with four 16 bit channels</param>
+  /// <param name="yuv">Receives the luma, Cb and Cr values of the pixel</param>
+  void referenceRgbToYuv(const std::uint16_t *pixel, std::uint16_t yuv[3]) {
+    const float lumaScale = 56064.0f / 65535.0f;
+    const float chromaScale = 57344.0f / 65535.0f;
+    const float kr = 0.2126f, kg = 0.7152f, kb = 0.0722f;
+
+    float red = static_cast<float>(pixel[0]);
+    float green = static_cast<float>(pixel[1]);
+    float blue = static_cast<float>(pixel[2]);
+
+    float y = (
+      (red * (kr * lumaScale) + green * (kg * lumaScale)) +
+      (blue * (kb * lumaScale) + 4096.5f)
+    );
+    float cb = (
+      (
+        red * (-kr / (2.0f * (1.0f - kb)) * chromaScale) +
+        green * (-kg / (2.0f * (1.0f - kb)) * chromaScale)
+      ) +
+      (blue * (0.5f * chromaScale) + 32768.5f)
+    );
+    float cr = (
+      (
+        red * (0.5f * chromaScale) +
+        green * (-kg / (2.0f * (1.0f - kr)) * chromaScale)
+      ) +
+      (blue * (-kb / (2.0f * (1.0f - kr)) * chromaScale) + 32768.5f)
+    );
+
+    yuv[0] = static_cast<std::uint16_t>(y);
+    yuv[1] = static_cast<std::uint16_t>(cb);
+    yuv[2] = static_cast<std::uint16_t>(cr);
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Calculates the RGB value of a YUV pixel the way the plain loop does</summary>
+  /// <param name="luma">Luma value of the pixel</param>
+  /// <param name="blueDifference">Cb value of the pixel</param>
+  /// <param name="redDifference">Cr value of the pixel</param>
+  /// <param name="pixel">Receives the four 16 bit channels of the pixel</param>
+  void referenceYuvToRgb(
+    std::uint16_t luma, std::uint16_t blueDifference, std::uint16_t redDifference,
+    std::uint16_t pixel[4]
+  ) {
+    const float lumaScale = 56064.0f / 65535.0f;
+    const float chromaScale = 57344.0f / 65535.0f;
+    const float kr = 0.2126f, kg = 0.7152f, kb = 0.0722f;
+
+    float y = (static_cast<float>(luma) - 4096.0f) * (1.0f / lumaScale);
+    float cb = static_cast<float>(blueDifference) - 32768.0f;
+    float cr = static_cast<float>(redDifference) - 32768.0f;
+
+    float rgb[3] = {
+      y + cr * (2.0f * (1.0f - kr) / chromaScale),
+      y + cb * (-2.0f * kb * (1.0f - kb) / kg / chromaScale) +
+        cr * (-2.0f * kr * (1.0f - kr) / kg / chromaScale),
+      y + cb * (2.0f * (1.0f - kb) / chromaScale)
+    };
+    for(std::size_t index = 0; index < 3; ++index) {
+      float rounded = rgb[index] + 0.5f;
+      if(rounded <= 0.0f) {
+        pixel[index] = 0;
+      } else if(rounded >= 65535.0f) {
+        pixel[index] = 65535;
+      } else {
+        pixel[index] = static_cast<std::uint16_t>(rounded);
+      }
+    }
+    pixel[3] = 65535;
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+} // anonymous namespace
+
+namespace Nuclex::FrameFixer::Rendering {
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(PixelConversionTest, Rgba64ToRgb48DropsAlphaChannel) {
+    checkAllCodePaths(
+      [](std::size_t pixelCount) {
+        std::vector<std::uint16_t> source = makeChannelValues(pixelCount * 4, 1);
+        std::vector<std::uint16_t> target(pixelCount * 3 + 1, Sentinel);
+
+        PixelConversion::Rgba64ToRgb48(source.data(), target.data(), pixelCount);
+
+        for(std::size_t index = 0; index < pixelCount; ++index) {
+          ASSERT_EQ(target[index * 3], source[index * 4]);
+          ASSERT_EQ(target[index * 3 + 1], source[index * 4 + 1]);
+          ASSERT_EQ(target[index * 3 + 2], source[index * 4 + 2]);
+        }
+        EXPECT_EQ(target.back(), Sentinel);
+      }
+    );
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(PixelConversionTest, Rgba64ToYuv444p16MatchesPlainFormula) {
+    checkAllCodePaths(
+      [](std::size_t pixelCount) {
+        std::vector<std::uint16_t> source = makeChannelValues(pixelCount * 4, 2);
+        std::vector<std::uint16_t> luma(pixelCount + 1, Sentinel);
+        std::vector<std::uint16_t> blueDifference(pixelCount + 1, Sentinel);
+        std::vector<std::uint16_t> redDifference(pixelCount + 1, Sentinel);
+
+        PixelConversion::Rgba64ToYuv444p16(
+          source.data(), luma.data(), blueDifference.data(), redDifference.data(), pixelCount
+        );
+
+        for(std::size_t index = 0; index < pixelCount; ++index) {
+          std::uint16_t expected[3];
+          referenceRgbToYuv(source.data() + index * 4, expected);
+          ASSERT_EQ(luma[index], expected[0]);
+          ASSERT_EQ(blueDifference[index], expected[1]);
+          ASSERT_EQ(redDifference[index], expected[2]);
+        }
+        EXPECT_EQ(luma.back(), Sentinel);
+        EXPECT_EQ(blueDifference.back(), Sentinel);
+        EXPECT_EQ(redDifference.back(), Sentinel);
+      }
+    );
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(PixelConversionTest, Yuv444p16ToRgba64MatchesPlainFormula) {
+    checkAllCodePaths(
+      [](std::size_t pixelCount) {
+        std::vector<std::uint16_t> luma = makeChannelValues(pixelCount, 3);
+        std::vector<std::uint16_t> blueDifference = makeChannelValues(pixelCount, 4);
+        std::vector<std::uint16_t> redDifference = makeChannelValues(pixelCount, 5);
+        std::vector<std::uint16_t> target(pixelCount * 4 + 1, Sentinel);
+
+        PixelConversion::Yuv444p16ToRgba64(
+          luma.data(), blueDifference.data(), redDifference.data(), target.data(), pixelCount
+        );
+
+        for(std::size_t index = 0; index < pixelCount; ++index) {
+          std::uint16_t expected[4];
+          referenceYuvToRgb(luma[index], blueDifference[index], redDifference[index], expected);
+          for(std::size_t channel = 0; channel < 4; ++channel) {
+            ASSERT_EQ(target[index * 4 + channel], expected[channel]);
+          }
+        }
+        EXPECT_EQ(target.back(), Sentinel);
+      }
+    );
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(PixelConversionTest, Rgba64ToYuv444p16PlainLoopMatchesSimd) {
+    std::vector<std::uint16_t> source = makeChannelValues(LongRowPixelCount * 4, 18);
+    std::vector<std::uint16_t> simdYuv(LongRowPixelCount * 3);
+    std::vector<std::uint16_t> plainYuv(LongRowPixelCount * 3);
+
+    PixelConversion::Rgba64ToYuv444p16(
+      source.data(),
+      simdYuv.data(),
+      simdYuv.data() + LongRowPixelCount,
+      simdYuv.data() + LongRowPixelCount * 2,
+      LongRowPixelCount
+    );
+
+    // Converting one pixel at a time never enters the SIMD loops
+    for(std::size_t index = 0; index < LongRowPixelCount; ++index) {
+      PixelConversion::Rgba64ToYuv444p16(
+        source.data() + index * 4,
+        plainYuv.data() + index,
+        plainYuv.data() + LongRowPixelCount + index,
+        plainYuv.data() + LongRowPixelCount * 2 + index,
+        1
+      );
+    }
+
+    for(std::size_t index = 0; index < LongRowPixelCount * 3; ++index) {
+      ASSERT_EQ(plainYuv[index], simdYuv[index]) << u8"value " << index;
+    }
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(PixelConversionTest, Yuv444p16ToRgba64PlainLoopMatchesSimd) {
+    std::vector<std::uint16_t> yuv = makeChannelValues(LongRowPixelCount * 3, 19);
+    std::vector<std::uint16_t> simdPixels(LongRowPixelCount * 4);
+    std::vector<std::uint16_t> plainPixels(LongRowPixelCount * 4);
+
+    PixelConversion::Yuv444p16ToRgba64(
+      yuv.data(),
+      yuv.data() + LongRowPixelCount,
+      yuv.data() + LongRowPixelCount * 2,
+      simdPixels.data(),
+      LongRowPixelCount
+    );
+
+    // Converting one pixel at a time never enters the SIMD loops
+    for(std::size_t index = 0; index < LongRowPixelCount; ++index) {
+      PixelConversion::Yuv444p16ToRgba64(
+        yuv.data() + index,
+        yuv.data() + LongRowPixelCount + index,
+        yuv.data() + LongRowPixelCount * 2 + index,
+        plainPixels.data() + index * 4,
+        1
+      );
+    }
+
+    for(std::size_t index = 0; index < LongRowPixelCount * 4; ++index) {
+      ASSERT_EQ(plainPixels[index], simdPixels[index]) << u8"value " << index;
+    }
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(PixelConversionTest, YuvConversionsRoundTripClosely) {
+    checkAllCodePaths(
+      [](std::size_t pixelCount) {
+        std::vector<std::uint16_t> source = makeChannelValues(pixelCount * 4, 6);
+        std::vector<std::uint16_t> luma(pixelCount);
+        std::vector<std::uint16_t> blueDifference(pixelCount);
+        std::vector<std::uint16_t> redDifference(pixelCount);
+        std::vector<std::uint16_t> target(pixelCount * 4);
+
+        PixelConversion::Rgba64ToYuv444p16(
+          source.data(), luma.data(), blueDifference.data(), redDifference.data(), pixelCount
+        );
+        PixelConversion::Yuv444p16ToRgba64(
+          luma.data(), blueDifference.data(), redDifference.data(), target.data(), pixelCount
+        );
+
+        // Limited range has fewer levels than full range 16 bit, so each step in YUV
+        // is a little more than one step in RGB and a few steps of error add up
+        for(std::size_t index = 0; index < pixelCount; ++index) {
+          for(std::size_t channel = 0; channel < 3; ++channel) {
+            int difference = (
+              static_cast<int>(target[index * 4 + channel]) -
+              static_cast<int>(source[index * 4 + channel])
+            );
+            ASSERT_LE(std::abs(difference), 4);
+          }
+          ASSERT_EQ(target[index * 4 + 3], 65535);
+        }
+      }
+    );
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(PixelConversionTest, Gbrap16ToRgba64InterleavesChannels) {
+    checkAllCodePaths(
+      [](std::size_t pixelCount) {
+        std::vector<std::uint16_t> green = makeChannelValues(pixelCount, 7);
+        std::vector<std::uint16_t> blue = makeChannelValues(pixelCount, 8);
+        std::vector<std::uint16_t> red = makeChannelValues(pixelCount, 9);
+        std::vector<std::uint16_t> alpha = makeChannelValues(pixelCount, 10);
+        std::vector<std::uint16_t> target(pixelCount * 4 + 1, Sentinel);
+
+        PixelConversion::Gbrap16ToRgba64(
+          green.data(), blue.data(), red.data(), alpha.data(), target.data(), pixelCount
+        );
+
+        for(std::size_t index = 0; index < pixelCount; ++index) {
+          ASSERT_EQ(target[index * 4], red[index]);
+          ASSERT_EQ(target[index * 4 + 1], green[index]);
+          ASSERT_EQ(target[index * 4 + 2], blue[index]);
+          ASSERT_EQ(target[index * 4 + 3], alpha[index]);
+        }
+        EXPECT_EQ(target.back(), Sentinel);
+      }
+    );
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(PixelConversionTest, Gbrap8ToRgba64ExpandsLikeQt) {
+    checkAllCodePaths(
+      [](std::size_t pixelCount) {
+        std::vector<std::uint8_t> channels[4];
+        for(std::size_t channel = 0; channel < 4; ++channel) {
+          std::vector<std::uint16_t> values = makeChannelValues(pixelCount, 11 + channel);
+          for(std::uint16_t value : values) {
+            channels[channel].push_back(static_cast<std::uint8_t>(value >> 3));
+          }
+        }
+        const std::vector<std::uint8_t> &green = channels[0];
+        const std::vector<std::uint8_t> &blue = channels[1];
+        const std::vector<std::uint8_t> &red = channels[2];
+        const std::vector<std::uint8_t> &alpha = channels[3];
+        std::vector<std::uint16_t> target(pixelCount * 4 + 1, Sentinel);
+
+        PixelConversion::Gbrap8ToRgba64(
+          green.data(), blue.data(), red.data(), alpha.data(), target.data(), pixelCount
+        );
+
+        for(std::size_t index = 0; index < pixelCount; ++index) {
+          QRgba64 expected = QRgba64::fromRgba(red[index], green[index], blue[index], alpha[index]);
+          ASSERT_EQ(target[index * 4], expected.red());
+          ASSERT_EQ(target[index * 4 + 1], expected.green());
+          ASSERT_EQ(target[index * 4 + 2], expected.blue());
+          ASSERT_EQ(target[index * 4 + 3], expected.alpha());
+        }
+        EXPECT_EQ(target.back(), Sentinel);
+      }
+    );
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(PixelConversionTest, Rgba64ToGbrap16SplitsChannels) {
+    checkAllCodePaths(
+      [](std::size_t pixelCount) {
+        std::vector<std::uint16_t> source = makeChannelValues(pixelCount * 4, 15);
+        std::vector<std::uint16_t> green(pixelCount + 1, Sentinel);
+        std::vector<std::uint16_t> blue(pixelCount + 1, Sentinel);
+        std::vector<std::uint16_t> red(pixelCount + 1, Sentinel);
+        std::vector<std::uint16_t> alpha(pixelCount + 1, Sentinel);
+
+        PixelConversion::Rgba64ToGbrap16(
+          source.data(), green.data(), blue.data(), red.data(), alpha.data(), pixelCount
+        );
+
+        for(std::size_t index = 0; index < pixelCount; ++index) {
+          ASSERT_EQ(red[index], source[index * 4]);
+          ASSERT_EQ(green[index], source[index * 4 + 1]);
+          ASSERT_EQ(blue[index], source[index * 4 + 2]);
+          ASSERT_EQ(alpha[index], source[index * 4 + 3]);
+        }
+        EXPECT_EQ(green.back(), Sentinel);
+        EXPECT_EQ(blue.back(), Sentinel);
+        EXPECT_EQ(red.back(), Sentinel);
+        EXPECT_EQ(alpha.back(), Sentinel);
+      }
+    );
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(PixelConversionTest, Rgba64ToArgb32RoundsLikeQt) {
+    checkAllCodePaths(
+      [](std::size_t pixelCount) {
+        std::vector<std::uint16_t> source = makeChannelValues(pixelCount * 4, 16);
+        std::vector<std::uint32_t> target(pixelCount + 1, Sentinel);
+
+        PixelConversion::Rgba64ToArgb32(source.data(), target.data(), pixelCount);
+
+        for(std::size_t index = 0; index < pixelCount; ++index) {
+          const std::uint16_t *pixel = source.data() + index * 4;
+          QRgb expected = QRgba64::fromRgba64(pixel[0], pixel[1], pixel[2], pixel[3]).toArgb32();
+          ASSERT_EQ(target[index], expected);
+        }
+        EXPECT_EQ(target.back(), Sentinel);
+      }
+    );
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(PixelConversionTest, Rgba64ToArgb32RoundsEveryValueLikeQt) {
+    for(bool useAvx2 : { false, true }) {
+      Avx2Scope avx2Scope(useAvx2);
+
+      // Every possible 16 bit value once in each channel, rotated between the channels
+      std::vector<std::uint16_t> source(65536 * 4);
+      for(std::size_t index = 0; index < 65536; ++index) {
+        source[index * 4] = static_cast<std::uint16_t>(index);
+        source[index * 4 + 1] = static_cast<std::uint16_t>(index + 16384);
+        source[index * 4 + 2] = static_cast<std::uint16_t>(index + 32768);
+        source[index * 4 + 3] = static_cast<std::uint16_t>(index + 49152);
+      }
+      std::vector<std::uint32_t> target(65536);
+
+      PixelConversion::Rgba64ToArgb32(source.data(), target.data(), 65536);
+
+      for(std::size_t index = 0; index < 65536; ++index) {
+        const std::uint16_t *pixel = source.data() + index * 4;
+        QRgb expected = QRgba64::fromRgba64(pixel[0], pixel[1], pixel[2], pixel[3]).toArgb32();
+        ASSERT_EQ(target[index], expected) << u8"pixel " << index;
+      }
+    }
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(PixelConversionTest, Argb32ToRgba64ExpandsLikeQt) {
+    checkAllCodePaths(
+      [](std::size_t pixelCount) {
+        std::vector<std::uint16_t> values = makeChannelValues(pixelCount * 2, 17);
+        std::vector<std::uint32_t> source(pixelCount);
+        for(std::size_t index = 0; index < pixelCount; ++index) {
+          source[index] = (
+            (static_cast<std::uint32_t>(values[index * 2]) << 16) | values[index * 2 + 1]
+          );
+        }
+        std::vector<std::uint16_t> target(pixelCount * 4 + 1, Sentinel);
+
+        PixelConversion::Argb32ToRgba64(source.data(), target.data(), pixelCount);
+
+        for(std::size_t index = 0; index < pixelCount; ++index) {
+          QRgba64 expected = QRgba64::fromArgb32(source[index]);
+          ASSERT_EQ(target[index * 4], expected.red());
+          ASSERT_EQ(target[index * 4 + 1], expected.green());
+          ASSERT_EQ(target[index * 4 + 2], expected.blue());
+          ASSERT_EQ(target[index * 4 + 3], expected.alpha());
+        }
+        EXPECT_EQ(target.back(), Sentinel);
+      }
+    );
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+} // namespace Nuclex::FrameFixer::Rendering
@@ -0,0 +1,232 @@
+#pragma region Apache License 2.0
+/*
+Nuclex Frame Fixer
+Copyright (C) 2024 Markus Ewald / Nuclex Development Labs
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#pragma endregion // Apache License 2.0
+
+// If the application is compiled as a DLL, this ensures symbols are exported
+#define NUCLEX_FRAMEFIXER_SOURCE 1
+
+#include "../../Source/Rendering/RenderManifest.h"
+#include "../../Source/Rendering/RenderPlan.h"
+#include "../../Source/Model/Movie.h"
+
+#include <cstddef> // for std::size_t
+#include <filesystem> // for std::filesystem::temp_directory_path()
+#include <fstream> // for std::ofstream
+#include <memory> // for std::unique_ptr
+#include <optional> // for std::optional
+#include <string> // for std::string
+#include <system_error> // for std::error_code
+#include <utility> // for std::pair
+#include <vector> // for std::vector
+
+#include <gtest/gtest.h>
+
+namespace {
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Number of frames in the movies the tests render</summary>
+  const std::size_t FrameCount = 200;
+
+  /// <summary>Settings description the fingerprints are calculated with</summary>
+  const std::string Settings(u8"deinterlacer=yadif-libav");
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Creates a directory that is deleted again when going out of scope</summary>
+  class TemporaryDirectory {
+
+    /// <summary>Creates a new, empty directory in the system's temporary directory</summary>
+    /// <param name="name">Name the directory will have</param>
+    public: TemporaryDirectory(const std::string &name) :
+      path(std::filesystem::temp_directory_path() / name) {
+      std::filesystem::remove_all(this->path);
+      std::filesystem::create_directories(this->path);
+    }
+
+    /// <summary>Deletes the directory and everything in it</summary>
+    public: ~TemporaryDirectory() {
+      std::error_code errorCode;
+      std::filesystem::remove_all(this->path, errorCode);
+    }
+
+    /// <summary>Returns the path of the directory</summary>
+    /// <returns>The absolute path of the directory</returns>
+    public: std::string GetPath() const { return this->path.string(); }
+
+    /// <summary>Path of the directory</summary>
+    private: std::filesystem::path path;
+
+  };
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Creates a movie in which every frame is tagged for deinterlacing</summary>
+  /// <param name="frameDirectory">Directory the movie's frame images are in</param>
+  /// <returns>The new movie</returns>
+  Nuclex::FrameFixer::Movie makeInterlacedMovie(const std::string &frameDirectory) {
+    Nuclex::FrameFixer::Movie movie;
+    movie.FrameDirectory = frameDirectory;
+    for(std::size_t index = 0; index < FrameCount; ++index) {
+      std::string filename(u8"frame-");
+      filename.append(std::to_string(index));
+      filename.append(u8".png");
+
+      Nuclex::FrameFixer::Frame &frame = movie.Frames.emplace_back(filename);
+      frame.Index = index;
+      frame.Action = Nuclex::FrameFixer::FrameAction::TopFieldFirst;
+    }
+
+    return movie;
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Compiles the plan a render with a prior-frame deinterlacer would use</summary>
+  /// <param name="movie">Movie that will be rendered</param>
+  /// <returns>The render plan for the movie</returns>
+  Nuclex::FrameFixer::Rendering::RenderPlan makePlan(const Nuclex::FrameFixer::Movie &movie) {
+    return Nuclex::FrameFixer::Rendering::RenderPlan(
+      movie, false, false, std::optional<std::pair<std::size_t, std::size_t>>(), true
+    );
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Fingerprints a render of the movie and records all its output frames</summary>
+  /// <param name="manifest">Manifest the output frames will be recorded in</param>
+  /// <param name="movie">Movie that is being rendered</param>
+  void recordFullRender(
+    Nuclex::FrameFixer::Rendering::RenderManifest &manifest,
+    const Nuclex::FrameFixer::Movie &movie
+  ) {
+    Nuclex::FrameFixer::Rendering::RenderPlan plan = makePlan(movie);
+    manifest.CalculateFingerprints(movie, plan, Settings);
+    for(std::size_t index = 1; index < plan.GetEndOutputFrameIndex(); ++index) {
+      manifest.Record(index);
+    }
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Lists the output frames that would have to be rendered again</summary>
+  /// <param name="manifest">Manifest holding the fingerprints of a prior render</param>
+  /// <param name="outputPath">Existing file that stands in for each output frame</param>
+  /// <returns>The indices of all output frames that are not up to date</returns>
+  std::vector<std::size_t> getOutdatedFrames(
+    const Nuclex::FrameFixer::Rendering::RenderManifest &manifest, const std::string &outputPath
+  ) {
+    std::vector<std::size_t> outdatedFrames;
+    for(std::size_t index = 1; index <= FrameCount; ++index) {
+      if(!manifest.IsUpToDate(index, outputPath)) {
+        outdatedFrames.push_back(index);
+      }
+    }
+
+    return outdatedFrames;
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+} // anonymous namespace
+
+namespace Nuclex::FrameFixer::Rendering {
+
+  // ------------------------------------------------------------------------------------------- //
+
+  class RenderManifestTest : public testing::Test {
+
+    /// <summary>Creates the output directory and a file standing in for output frames</summary>
+    protected: void SetUp() override {
+      this->outputDirectory = std::make_unique<TemporaryDirectory>(
+        u8"NuclexFrameFixerRenderManifestTest"
+      );
+      this->outputPath = this->outputDirectory->GetPath() + u8"/frame.png";
+      std::ofstream(this->outputPath) << u8"placeholder";
+    }
+
+    /// <summary>Deletes the output directory again</summary>
+    protected: void TearDown() override {
+      this->outputDirectory.reset();
+    }
+
+    /// <summary>Directory the manifest is written to</summary>
+    protected: std::unique_ptr<TemporaryDirectory> outputDirectory;
+    /// <summary>Existing file that stands in for each output frame</summary>
+    protected: std::string outputPath;
+
+  };
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST_F(RenderManifestTest, UnchangedMovieIsUpToDate) {
+    Movie movie = makeInterlacedMovie(this->outputDirectory->GetPath());
+
+    RenderManifest manifest(this->outputDirectory->GetPath());
+    recordFullRender(manifest, movie);
+
+    RenderPlan plan = makePlan(movie);
+    manifest.CalculateFingerprints(movie, plan, Settings);
+    EXPECT_TRUE(getOutdatedFrames(manifest, this->outputPath).empty());
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST_F(RenderManifestTest, ChangedSettingsOutdateAllFrames) {
+    Movie movie = makeInterlacedMovie(this->outputDirectory->GetPath());
+
+    RenderManifest manifest(this->outputDirectory->GetPath());
+    recordFullRender(manifest, movie);
+
+    RenderPlan plan = makePlan(movie);
+    manifest.CalculateFingerprints(movie, plan, u8"deinterlacer=bwdif-libav");
+    EXPECT_EQ(getOutdatedFrames(manifest, this->outputPath).size(), FrameCount);
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST_F(RenderManifestTest, EditedTagOnlyOutdatesFramesWithinWarmUpWindow) {
+    Movie movie = makeInterlacedMovie(this->outputDirectory->GetPath());
+
+    RenderManifest manifest(this->outputDirectory->GetPath());
+    recordFullRender(manifest, movie);
+
+    // Every frame is deinterlaced with a deinterlacer that looks at the prior frame,
+    // so without a bound, the edit would outdate every frame after it
+    const std::size_t editedFrameIndex = 50;
+    movie.Frames[editedFrameIndex].Action = FrameAction::BottomFieldFirst;
+
+    RenderPlan plan = makePlan(movie);
+    manifest.CalculateFingerprints(movie, plan, Settings);
+    std::vector<std::size_t> outdatedFrames = getOutdatedFrames(manifest, this->outputPath);
+
+    // The frame before the edit looks at the edited frame as its next frame, the edited
+    // frame itself and those warming up from before it are outdated, nothing else.
+    // Output frames are numbered from 1, so input frame N produces output frame N + 1.
+    ASSERT_FALSE(outdatedFrames.empty());
+    EXPECT_EQ(outdatedFrames.front(), editedFrameIndex);
+    EXPECT_EQ(outdatedFrames.back(), editedFrameIndex + 1 + RenderPlan::WarmUpOperationCount);
+    EXPECT_EQ(outdatedFrames.size(), RenderPlan::WarmUpOperationCount + 2);
+    for(std::size_t index = 1; index < outdatedFrames.size(); ++index) {
+      EXPECT_EQ(outdatedFrames[index], outdatedFrames[index - 1] + 1);
+    }
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+} // namespace Nuclex::FrameFixer::Rendering
@@ -0,0 +1,103 @@
+#pragma region Apache License 2.0
+/*
+Nuclex Frame Fixer
+Copyright (C) 2024 Markus Ewald / Nuclex Development Labs
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#pragma endregion // Apache License 2.0
+
+// If the application is compiled as a DLL, this ensures symbols are exported
+#define NUCLEX_FRAMEFIXER_SOURCE 1
+
+#include "../../Source/Rendering/RenderPlan.h"
+#include "../../Source/Model/Movie.h"
+
+#include <cstddef> // for std::size_t
+#include <optional> // for std::optional
+#include <string> // for std::string
+#include <utility> // for std::pair
+
+#include <gtest/gtest.h>
+
+namespace {
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Creates a progressive movie with the specified number of frames</summary>
+  /// <param name="frameCount">Number of frames the movie will have</param>
+  /// <returns>The new movie</returns>
+  Nuclex::FrameFixer::Movie makeProgressiveMovie(std::size_t frameCount) {
+    Nuclex::FrameFixer::Movie movie;
+    for(std::size_t index = 0; index < frameCount; ++index) {
+      std::string filename(u8"frame-");
+      filename.append(std::to_string(index));
+      filename.append(u8".png");
+
+      Nuclex::FrameFixer::Frame &frame = movie.Frames.emplace_back(filename);
+      frame.Index = index;
+      frame.Action = Nuclex::FrameFixer::FrameAction::Progressive;
+    }
+
+    return movie;
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  /// <summary>Compiles the plan for a render of the whole movie</summary>
+  /// <param name="movie">Movie that will be rendered</param>
+  /// <returns>The render plan for the movie</returns>
+  Nuclex::FrameFixer::Rendering::RenderPlan makePlan(const Nuclex::FrameFixer::Movie &movie) {
+    return Nuclex::FrameFixer::Rendering::RenderPlan(
+      movie, false, false, std::optional<std::pair<std::size_t, std::size_t>>(), false
+    );
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+} // anonymous namespace
+
+namespace Nuclex::FrameFixer::Rendering {
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(RenderPlanTest, InterpolatedFrameIsInsertedBetweenFrames) {
+    Movie movie = makeProgressiveMovie(4);
+    movie.Frames[1].AlsoInsertInterpolatedAfter = true;
+
+    RenderPlan plan = makePlan(movie);
+
+    const RenderOperation &operation = plan.GetOperation(plan.FindFirstOperationOfInputFrame(1));
+    EXPECT_TRUE(operation.InsertInterpolatedAfter);
+    EXPECT_EQ(plan.GetEndOutputFrameIndex(), 6U);
+    EXPECT_EQ(plan.GetFirstOutputFrameIndex(plan.FindFirstOperationOfInputFrame(2)), 4U);
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+  TEST(RenderPlanTest, NoInterpolatedFrameIsInsertedAfterLastFrame) {
+    Movie movie = makeProgressiveMovie(4);
+    movie.Frames[3].AlsoInsertInterpolatedAfter = true;
+
+    RenderPlan plan = makePlan(movie);
+
+    // There is no frame after the last one to interpolate towards
+    const RenderOperation &operation = plan.GetOperation(plan.FindFirstOperationOfInputFrame(3));
+    EXPECT_FALSE(operation.InsertInterpolatedAfter);
+    EXPECT_EQ(plan.GetEndOutputFrameIndex(), 5U);
+    EXPECT_EQ(plan.FindOperationOfOutputFrame(5), plan.GetOperationCount());
+  }
+
+  // ------------------------------------------------------------------------------------------- //
+
+} // namespace Nuclex::FrameFixer::Rendering